@@ -0,0 +1,430 @@
+/******************************************************************************
+* File Name: body_source.c
+*
+* Description: This file contains the body sources. A request body that is
+* mapped in memory, such as a file in the internal flash or in the QSPI flash
+* in XIP mode, is passed to the TLS stream where it lies, so that mbedTLS
+* encrypts it straight from the flash. Other bodies are read or generated
+* into one transmit buffer, piece by piece, as they are sent.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Serial flash library header file */
+#include "cy_serial_flash_qspi.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "tls_stream.h"
+#include "flash_download.h"
+#include "body_source.h"
+#include "request_scheduler.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Arguments of an upload run by the request scheduler. */
+typedef struct
+{
+    const body_source_t *source;
+    const char *path;
+    const char *content_type;
+    body_source_stats_t *stats;
+} upload_job_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Connection and buffers of body_source_upload(). */
+static tls_stream_t upload_stream;
+static uint8_t tx_buffer[BODY_SOURCE_BUFFER_SIZE];
+static char response_buffer[BODY_SOURCE_RESPONSE_SIZE + 1];
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static cy_rslt_t upload(void *arg);
+static cy_rslt_t read_piece(const body_source_t *source, uint32_t offset, uint8_t *buffer, uint32_t length);
+static cy_rslt_t read_status(body_source_stats_t *stats);
+static size_t copy_from_memory(uint32_t offset, uint8_t *buffer, size_t size, void *arg);
+
+/*******************************************************************************
+ * Function Name: body_source_mapped
+ *******************************************************************************
+ * Summary:
+ *  Sets up a body that is mapped in memory. It is sent without a copy.
+ *
+ * Parameters:
+ *  source - Source to set up.
+ *  data - First byte of the body, in RAM or in a flash mapped in memory.
+ *  length - Length of the body.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void body_source_mapped(body_source_t *source, const void *data, uint32_t length)
+{
+    memset(source, 0, sizeof(*source));
+    source->kind = BODY_SOURCE_MAPPED;
+    source->data = (const uint8_t *)data;
+    source->length = length;
+}
+
+/*******************************************************************************
+ * Function Name: body_source_qspi
+ *******************************************************************************
+ * Summary:
+ *  Sets up a body stored in the external flash. When the flash is in XIP
+ *  mode, the body is sent from its memory mapping, otherwise, it is read
+ *  into the transmit buffer piece by piece.
+ *
+ * Parameters:
+ *  source - Source to set up.
+ *  flash_addr - Address of the body in the external flash.
+ *  length - Length of the body.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void body_source_qspi(body_source_t *source, uint32_t flash_addr, uint32_t length)
+{
+#if BODY_SOURCE_QSPI_MAPPED
+    body_source_mapped(source, (const void *)(CY_XIP_BASE + flash_addr), length);
+#else
+    memset(source, 0, sizeof(*source));
+    source->kind = BODY_SOURCE_QSPI;
+    source->flash_addr = flash_addr;
+    source->length = length;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: body_source_generator
+ *******************************************************************************
+ * Summary:
+ *  Sets up a body produced by a callback into the transmit buffer as it is
+ *  sent.
+ *
+ * Parameters:
+ *  source - Source to set up.
+ *  read - Called for each piece of the body, in order.
+ *  arg - Argument passed to the callback.
+ *  length - Length of the body.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void body_source_generator(body_source_t *source, body_source_read_t read, void *arg, uint32_t length)
+{
+    memset(source, 0, sizeof(*source));
+    source->kind = BODY_SOURCE_GENERATOR;
+    source->read = read;
+    source->arg = arg;
+    source->length = length;
+}
+
+/*******************************************************************************
+ * Function Name: body_source_upload
+ *******************************************************************************
+ * Summary:
+ *  POSTs a body to the server on a new TLS connection. A mapped body is
+ *  written to the TLS stream in BODY_SOURCE_MAX_WRITE pieces from where it
+ *  lies. Other bodies are read into the transmit buffer, the first piece
+ *  behind the request head, so that the head does not take a record of its
+ *  own. The upload is run from the bulk lane of the request scheduler, so
+ *  urgent requests are sent first and the uploads are made one at a time.
+ *
+ * Parameters:
+ *  source - Body to send.
+ *  path - Resource path.
+ *  content_type - Media type of the body.
+ *  stats - Filled with the upload statistics. Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the server answered with a 2xx
+ *  status, otherwise, it returns a secure sockets, serial flash, or
+ *  CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+cy_rslt_t body_source_upload(const body_source_t *source, const char *path, const char *content_type,
+                             body_source_stats_t *stats)
+{
+    upload_job_t job;
+
+    job.source = source;
+    job.path = path;
+    job.content_type = content_type;
+    job.stats = stats;
+
+    return request_scheduler_run(path, REQUEST_LANE_BULK, upload, &job);
+}
+
+/*******************************************************************************
+ * Function Name: body_source_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Uploads BODY_SOURCE_BENCH_SIZE bytes three times: the internal flash
+ *  copied into RAM piece by piece, as a file is read into a buffer, the
+ *  external flash through the QSPI source, and the internal flash from its
+ *  memory mapping. Prints the bytes copied and the throughput of each.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void body_source_benchmark(void)
+{
+    static const char *const names[] = { "RAM copy", BODY_SOURCE_QSPI_MAPPED ? "QSPI XIP" : "QSPI read", "mapped" };
+    body_source_t sources[3];
+    body_source_stats_t stats;
+
+    body_source_generator(&sources[0], copy_from_memory, (void *)CY_FLASH_BASE, BODY_SOURCE_BENCH_SIZE);
+    body_source_qspi(&sources[1], FLASH_DOWNLOAD_FLASH_ADDRESS, BODY_SOURCE_BENCH_SIZE);
+    body_source_mapped(&sources[2], (const void *)CY_FLASH_BASE, BODY_SOURCE_BENCH_SIZE);
+
+    APP_INFO(("%lu KB uploaded to %s from each source\n", (unsigned long)(BODY_SOURCE_BENCH_SIZE / 1024u),
+              BODY_SOURCE_BENCH_PATH));
+    printf("\n  %-10s %10s %7s %8s %8s\n", "source", "copied B", "writes", "ms", "KB/s");
+
+    for (uint32_t i = 0; i < (sizeof(sources) / sizeof(sources[0])); i++)
+    {
+        if (CY_RSLT_SUCCESS != body_source_upload(&sources[i], BODY_SOURCE_BENCH_PATH, "application/octet-stream",
+                                                  &stats))
+        {
+            return;
+        }
+
+        printf("  %-10s %10lu %7lu %8lu %8lu\n", names[i], (unsigned long)stats.copied_bytes,
+               (unsigned long)stats.writes, (unsigned long)stats.elapsed_ms,
+               (unsigned long)(stats.throughput_bps / 1024u));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: upload
+ *******************************************************************************
+ * Summary:
+ *  Sends the upload of body_source_upload() from the scheduler task.
+ *
+ *******************************************************************************/
+static cy_rslt_t upload(void *arg)
+{
+    upload_job_t *job = (upload_job_t *)arg;
+    const body_source_t *source = job->source;
+    const char *path = job->path;
+    body_source_stats_t *stats = job->stats;
+    body_source_stats_t local_stats;
+    cy_rslt_t result;
+    TickType_t start_ticks = xTaskGetTickCount();
+    uint32_t used;
+    uint32_t length;
+    uint32_t offset = 0;
+    int head_len;
+
+    if (NULL == stats)
+    {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    head_len = snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                        "POST %s HTTP/1.1\r\n"
+                        "Host: %s:%u\r\n"
+                        "Content-Type: %s\r\n"
+                        "Content-Length: %lu\r\n"
+                        "Connection: close\r\n"
+                        "\r\n",
+                        path, HTTPS_SERVER_HOST, HTTPS_PORT, job->content_type, (unsigned long)source->length);
+    if ((head_len < 0) || ((uint32_t)head_len >= sizeof(tx_buffer)))
+    {
+        ERR_INFO(("The request head for %s does not fit in %u bytes.\n", path, BODY_SOURCE_BUFFER_SIZE));
+        return CY_RSLT_TYPE_ERROR;
+    }
+    used = (uint32_t)head_len;
+
+    result = tls_stream_connect(&upload_stream, HTTPS_SERVER_HOST, HTTPS_PORT, TRANSPORT_SEND_RECV_TIMEOUT_MS);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    if (BODY_SOURCE_MAPPED == source->kind)
+    {
+        result = tls_stream_send(&upload_stream, tx_buffer, used);
+        stats->writes++;
+
+        while ((CY_RSLT_SUCCESS == result) && (offset < source->length))
+        {
+            length = source->length - offset;
+            length = (length < BODY_SOURCE_MAX_WRITE) ? length : BODY_SOURCE_MAX_WRITE;
+
+            result = tls_stream_send(&upload_stream, &source->data[offset], length);
+            stats->writes++;
+            offset += length;
+        }
+    }
+    else
+    {
+        do
+        {
+            length = source->length - offset;
+            length = (length < (sizeof(tx_buffer) - used)) ? length : (sizeof(tx_buffer) - used);
+
+            result = read_piece(source, offset, &tx_buffer[used], length);
+            if (CY_RSLT_SUCCESS == result)
+            {
+                stats->copied_bytes += length;
+                result = tls_stream_send(&upload_stream, tx_buffer, used + length);
+                stats->writes++;
+            }
+            offset += length;
+            used = 0;
+        } while ((CY_RSLT_SUCCESS == result) && (offset < source->length));
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        stats->body_bytes = source->length;
+        result = read_status(stats);
+    }
+
+    tls_stream_close(&upload_stream);
+
+    stats->elapsed_ms = TICKS_TO_MS(xTaskGetTickCount() - start_ticks);
+    if (stats->elapsed_ms > 0)
+    {
+        stats->throughput_bps = (uint32_t)(((uint64_t)stats->body_bytes * 1000u) / stats->elapsed_ms);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to upload %lu bytes to %s: 0x%08lx\n", (unsigned long)source->length, path,
+                  (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: read_piece
+ *******************************************************************************
+ * Summary:
+ *  Reads a piece of a body that is not mapped into the transmit buffer.
+ *
+ *******************************************************************************/
+static cy_rslt_t read_piece(const body_source_t *source, uint32_t offset, uint8_t *buffer, uint32_t length)
+{
+    if (BODY_SOURCE_QSPI == source->kind)
+    {
+        return cy_serial_flash_qspi_read(source->flash_addr + offset, length, buffer);
+    }
+
+    return (length == source->read(offset, buffer, length, source->arg)) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: read_status
+ *******************************************************************************
+ * Summary:
+ *  Receives the response head until its status line is complete and reads
+ *  the status code. The rest of the response is dropped with the
+ *  connection.
+ *
+ *******************************************************************************/
+static cy_rslt_t read_status(body_source_stats_t *stats)
+{
+    uint32_t length = 0;
+    uint32_t received;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    char *line_end = NULL;
+
+    while ((CY_RSLT_SUCCESS == result) && (NULL == line_end) && (length < BODY_SOURCE_RESPONSE_SIZE))
+    {
+        received = 0;
+        result = tls_stream_recv(&upload_stream, &response_buffer[length], BODY_SOURCE_RESPONSE_SIZE - length,
+                                 &received);
+        length += received;
+        response_buffer[length] = '\0';
+        line_end = strstr(response_buffer, "\r\n");
+    }
+
+    if ((NULL == line_end) || (0 != strncmp(response_buffer, "HTTP/1.", sizeof("HTTP/1.") - 1)))
+    {
+        return (CY_RSLT_SUCCESS != result) ? result : CY_RSLT_TYPE_ERROR;
+    }
+
+    stats->status_code = (uint16_t)strtoul(&response_buffer[sizeof("HTTP/1.x") - 1], NULL, 10);
+
+    return ((stats->status_code >= 200u) && (stats->status_code < 300u)) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: copy_from_memory
+ *******************************************************************************
+ * Summary:
+ *  Generator of the benchmark that copies the body from memory, like a
+ *  caller that stages its payload in RAM.
+ *
+ *******************************************************************************/
+static size_t copy_from_memory(uint32_t offset, uint8_t *buffer, size_t size, void *arg)
+{
+    memcpy(buffer, (const uint8_t *)arg + offset, size);
+
+    return size;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,140 @@
+/******************************************************************************
+* File Name: body_source.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the body sources, which send request bodies that live in
+* flash or are generated as they are sent, without staging them in RAM.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef BODY_SOURCE_H_
+#define BODY_SOURCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Set when the external flash is mapped for execute in place, so that a QSPI
+ * source is read through its memory mapping instead of copied out.
+ */
+#if defined(CY_ENABLE_XIP_PROGRAM)
+#define BODY_SOURCE_QSPI_MAPPED                  (1)
+#else
+#define BODY_SOURCE_QSPI_MAPPED                  (0)
+#endif
+
+/* Largest write to the TLS stream from a mapped source: the largest TLS
+ * record, so that mbedTLS encrypts each write straight from the source into
+ * one record.
+ */
+#define BODY_SOURCE_MAX_WRITE                    (16 * 1024)
+
+/* Buffer that the sources that are not mapped are read into, and that holds
+ * the request head.
+ */
+#define BODY_SOURCE_BUFFER_SIZE                  (4 * 1024)
+
+/* Status line and headers of the response kept to read the status code. */
+#define BODY_SOURCE_RESPONSE_SIZE                (512)
+
+/* "Zero-copy upload" menu option: bytes of the internal flash uploaded from
+ * a RAM copy, through the QSPI reads, and from the mapped flash. The QSPI
+ * source is the asset stored by the "download to flash" menu option.
+ */
+#define BODY_SOURCE_BENCH_PATH                   "/upload"
+#define BODY_SOURCE_BENCH_SIZE                   (256u * 1024u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    BODY_SOURCE_MAPPED = 0,      /* Memory-mapped: RAM, internal flash, or QSPI in XIP mode. */
+    BODY_SOURCE_QSPI,            /* External flash read through the serial flash driver. */
+    BODY_SOURCE_GENERATOR,       /* Produced by a callback as it is sent. */
+} body_source_kind_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Copies up to size bytes of the body, starting at offset, to buffer.
+ * Returns the number of bytes copied, 0 on error.
+ */
+typedef size_t (*body_source_read_t)(uint32_t offset, uint8_t *buffer, size_t size, void *arg);
+
+/* Body of a request, set up with one of the body_source_* functions. */
+typedef struct
+{
+    body_source_kind_t kind;
+    uint32_t length;
+    const uint8_t *data;         /* BODY_SOURCE_MAPPED */
+    uint32_t flash_addr;         /* BODY_SOURCE_QSPI */
+    body_source_read_t read;     /* BODY_SOURCE_GENERATOR */
+    void *arg;
+} body_source_t;
+
+/* Statistics of one upload. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t body_bytes;         /* Body bytes sent. */
+    uint32_t copied_bytes;       /* Body bytes copied into RAM before encryption. */
+    uint32_t writes;             /* Writes to the TLS stream, the head included. */
+    uint32_t elapsed_ms;         /* Connection, request, and response. */
+    uint32_t throughput_bps;     /* body_bytes over elapsed_ms, in bytes/s. */
+    uint16_t status_code;
+} body_source_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void body_source_mapped(body_source_t *source, const void *data, uint32_t length);
+void body_source_qspi(body_source_t *source, uint32_t flash_addr, uint32_t length);
+void body_source_generator(body_source_t *source, body_source_read_t read, void *arg, uint32_t length);
+cy_rslt_t body_source_upload(const body_source_t *source, const char *path, const char *content_type,
+                             body_source_stats_t *stats);
+void body_source_benchmark(void);
+
+#endif /* BODY_SOURCE_H_ */
+
+
+/* [] END OF FILE */
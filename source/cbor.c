@@ -0,0 +1,928 @@
+/******************************************************************************
+* File Name: cbor.c
+*
+* Description: This file contains the CBOR (RFC 8949) encoder and decoder used
+* for the compact request and response bodies. The decoder is a pull parser:
+* each call returns the next item, and returns CBOR_NEED_MORE without
+* consuming anything when the input ends inside that item, so it can be fed
+* from a stream.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <string.h>
+
+#include "cbor.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CBOR_MAJOR_UINT                  (0u)
+#define CBOR_MAJOR_NEGINT                (1u)
+#define CBOR_MAJOR_BYTES                 (2u)
+#define CBOR_MAJOR_TEXT                  (3u)
+#define CBOR_MAJOR_ARRAY                 (4u)
+#define CBOR_MAJOR_MAP                   (5u)
+#define CBOR_MAJOR_TAG                   (6u)
+#define CBOR_MAJOR_SIMPLE                (7u)
+
+#define CBOR_INFO_UINT8                  (24u)
+#define CBOR_INFO_UINT16                 (25u)
+#define CBOR_INFO_UINT32                 (26u)
+#define CBOR_INFO_UINT64                 (27u)
+#define CBOR_INFO_INDEFINITE             (31u)
+
+#define CBOR_SIMPLE_FALSE                (20u)
+#define CBOR_SIMPLE_TRUE                 (21u)
+#define CBOR_SIMPLE_NULL                 (22u)
+#define CBOR_SIMPLE_UNDEFINED            (23u)
+
+/* Marks a nesting level whose item count is not known. */
+#define CBOR_COUNT_INDEFINITE            (UINT64_MAX)
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void encoder_write(cbor_encoder_t *enc, const uint8_t *data, size_t length);
+static void encode_head(cbor_encoder_t *enc, uint8_t major, uint64_t value);
+static bool float_to_half(float value, uint16_t *half);
+static float half_to_float(uint16_t half);
+
+/*******************************************************************************
+ * Function Name: cbor_encoder_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up an encoder on a caller buffer. Without a flush function, the whole
+ *  encoding must fit in the buffer.
+ *
+ * Parameters:
+ *  enc - Encoder to set up.
+ *  buffer - Output buffer.
+ *  size - Size of the output buffer.
+ *  flush - Called with the buffer content whenever the buffer is full and by
+ *          cbor_encoder_finish(). Can be NULL.
+ *  flush_arg - Argument passed to the flush function.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encoder_init(cbor_encoder_t *enc, uint8_t *buffer, size_t size,
+                       cbor_flush_t flush, void *flush_arg)
+{
+    enc->buffer = buffer;
+    enc->size = size;
+    enc->length = 0;
+    enc->total = 0;
+    enc->flush = flush;
+    enc->flush_arg = flush_arg;
+    enc->status = ((NULL == buffer) || (0 == size)) ? CBOR_ERR_OVERFLOW : CBOR_OK;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encoder_finish
+ *******************************************************************************
+ * Summary:
+ *  Flushes the bytes left in the buffer, if the encoder has a flush function,
+ *  and returns the status of the whole encoding.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *
+ * Return:
+ *  cbor_status_t: CBOR_OK, or the first error of the encoding.
+ *
+ *******************************************************************************/
+cbor_status_t cbor_encoder_finish(cbor_encoder_t *enc)
+{
+    if ((CBOR_OK == enc->status) && (NULL != enc->flush) && (enc->length > 0))
+    {
+        if (!enc->flush(enc->buffer, enc->length, enc->flush_arg))
+        {
+            enc->status = CBOR_ERR_OVERFLOW;
+        }
+        enc->length = 0;
+    }
+
+    return enc->status;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_uint
+ *******************************************************************************
+ * Summary:
+ *  Encodes an unsigned integer in the shortest form.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  value - Value to encode.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_uint(cbor_encoder_t *enc, uint64_t value)
+{
+    encode_head(enc, CBOR_MAJOR_UINT, value);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_int
+ *******************************************************************************
+ * Summary:
+ *  Encodes a signed integer in the shortest form.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  value - Value to encode.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_int(cbor_encoder_t *enc, int64_t value)
+{
+    if (value < 0)
+    {
+        /* -1 - value, computed without overflowing for INT64_MIN. */
+        encode_head(enc, CBOR_MAJOR_NEGINT, ~(uint64_t)value);
+    }
+    else
+    {
+        encode_head(enc, CBOR_MAJOR_UINT, (uint64_t)value);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_bytes
+ *******************************************************************************
+ * Summary:
+ *  Encodes a definite-length byte string.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  data - String content.
+ *  length - Length of the string.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_bytes(cbor_encoder_t *enc, const uint8_t *data, size_t length)
+{
+    encode_head(enc, CBOR_MAJOR_BYTES, length);
+    encoder_write(enc, data, length);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_text
+ *******************************************************************************
+ * Summary:
+ *  Encodes a definite-length UTF-8 text string.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  text - String content.
+ *  length - Length of the string in bytes.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_text(cbor_encoder_t *enc, const char *text, size_t length)
+{
+    encode_head(enc, CBOR_MAJOR_TEXT, length);
+    encoder_write(enc, (const uint8_t *)text, length);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_cstr
+ *******************************************************************************
+ * Summary:
+ *  Encodes a NUL-terminated string as a text string.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  text - NUL-terminated string.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_cstr(cbor_encoder_t *enc, const char *text)
+{
+    cbor_encode_text(enc, text, strlen(text));
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_array
+ *******************************************************************************
+ * Summary:
+ *  Starts an array. The next count items are its elements.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  count - Number of elements.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_array(cbor_encoder_t *enc, size_t count)
+{
+    encode_head(enc, CBOR_MAJOR_ARRAY, count);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_map
+ *******************************************************************************
+ * Summary:
+ *  Starts a map. The next 2 * pairs items are its keys and values.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  pairs - Number of key/value pairs.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_map(cbor_encoder_t *enc, size_t pairs)
+{
+    encode_head(enc, CBOR_MAJOR_MAP, pairs);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_tag
+ *******************************************************************************
+ * Summary:
+ *  Encodes a tag. The next item is the tagged content.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  tag - Tag number.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_tag(cbor_encoder_t *enc, uint64_t tag)
+{
+    encode_head(enc, CBOR_MAJOR_TAG, tag);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_bool
+ *******************************************************************************
+ * Summary:
+ *  Encodes true or false.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  value - Value to encode.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_bool(cbor_encoder_t *enc, bool value)
+{
+    encode_head(enc, CBOR_MAJOR_SIMPLE, value ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_null
+ *******************************************************************************
+ * Summary:
+ *  Encodes null.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_null(cbor_encoder_t *enc)
+{
+    encode_head(enc, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_NULL);
+}
+
+/*******************************************************************************
+ * Function Name: cbor_encode_float
+ *******************************************************************************
+ * Summary:
+ *  Encodes a float as a half-precision float when that is exact, otherwise as
+ *  a single-precision float.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  value - Value to encode.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_encode_float(cbor_encoder_t *enc, float value)
+{
+    uint8_t head[5];
+    uint16_t half;
+    uint32_t bits;
+
+    if (float_to_half(value, &half))
+    {
+        head[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_INFO_UINT16;
+        head[1] = (uint8_t)(half >> 8);
+        head[2] = (uint8_t)half;
+        encoder_write(enc, head, 3);
+    }
+    else
+    {
+        memcpy(&bits, &value, sizeof(bits));
+        head[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_INFO_UINT32;
+        head[1] = (uint8_t)(bits >> 24);
+        head[2] = (uint8_t)(bits >> 16);
+        head[3] = (uint8_t)(bits >> 8);
+        head[4] = (uint8_t)bits;
+        encoder_write(enc, head, 5);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cbor_decoder_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up a decoder on an input buffer.
+ *
+ * Parameters:
+ *  dec - Decoder to set up.
+ *  data - CBOR input.
+ *  length - Length of the input.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void cbor_decoder_init(cbor_decoder_t *dec, const uint8_t *data, size_t length)
+{
+    dec->data = data;
+    dec->length = length;
+    dec->offset = 0;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_decode_next
+ *******************************************************************************
+ * Summary:
+ *  Decodes the next item. For arrays, maps, and tags only the head is
+ *  consumed; their content is returned by the following calls. A definite
+ *  string is returned whole, pointing into the input. An indefinite string
+ *  is returned as a head followed by its chunks and a break.
+ *
+ * Parameters:
+ *  dec - Decoder.
+ *  item - Filled with the item.
+ *
+ * Return:
+ *  cbor_status_t: CBOR_OK if an item was decoded, CBOR_NEED_MORE if the input
+ *  ends inside the item, or CBOR_ERR_MALFORMED.
+ *
+ *******************************************************************************/
+cbor_status_t cbor_decode_next(cbor_decoder_t *dec, cbor_item_t *item)
+{
+    const uint8_t *p = dec->data + dec->offset;
+    size_t available = dec->length - dec->offset;
+    size_t head = 1;
+    size_t size;
+    size_t index;
+    uint8_t major;
+    uint8_t info;
+    uint64_t value = 0;
+    uint32_t bits;
+    double number;
+
+    if (0 == available)
+    {
+        return CBOR_NEED_MORE;
+    }
+
+    major = p[0] >> 5;
+    info = p[0] & 0x1Fu;
+
+    memset(item, 0, sizeof(*item));
+
+    if (info < CBOR_INFO_UINT8)
+    {
+        value = info;
+    }
+    else if (info <= CBOR_INFO_UINT64)
+    {
+        size = (size_t)1u << (info - CBOR_INFO_UINT8);
+        if (available < (1u + size))
+        {
+            return CBOR_NEED_MORE;
+        }
+        for (index = 1; index <= size; index++)
+        {
+            value = (value << 8) | p[index];
+        }
+        head += size;
+    }
+    else if (CBOR_INFO_INDEFINITE == info)
+    {
+        if ((CBOR_MAJOR_UINT == major) || (CBOR_MAJOR_NEGINT == major) || (CBOR_MAJOR_TAG == major))
+        {
+            return CBOR_ERR_MALFORMED;
+        }
+        item->indefinite = true;
+    }
+    else
+    {
+        return CBOR_ERR_MALFORMED;
+    }
+
+    item->value = value;
+
+    switch (major)
+    {
+        case CBOR_MAJOR_UINT:
+            item->type = CBOR_TYPE_UINT;
+            break;
+
+        case CBOR_MAJOR_NEGINT:
+            item->type = CBOR_TYPE_NEGINT;
+            break;
+
+        case CBOR_MAJOR_BYTES:
+        case CBOR_MAJOR_TEXT:
+            item->type = (CBOR_MAJOR_BYTES == major) ? CBOR_TYPE_BYTES : CBOR_TYPE_TEXT;
+            if (!item->indefinite)
+            {
+                if (value > (uint64_t)(available - head))
+                {
+                    return CBOR_NEED_MORE;
+                }
+                item->data = p + head;
+                head += (size_t)value;
+            }
+            break;
+
+        case CBOR_MAJOR_ARRAY:
+            item->type = CBOR_TYPE_ARRAY;
+            break;
+
+        case CBOR_MAJOR_MAP:
+            item->type = CBOR_TYPE_MAP;
+            break;
+
+        case CBOR_MAJOR_TAG:
+            item->type = CBOR_TYPE_TAG;
+            break;
+
+        default:
+            item->indefinite = false;
+            if (CBOR_INFO_INDEFINITE == info)
+            {
+                item->type = CBOR_TYPE_BREAK;
+            }
+            else if (CBOR_INFO_UINT16 == info)
+            {
+                item->type = CBOR_TYPE_FLOAT;
+                item->number = half_to_float((uint16_t)value);
+            }
+            else if (CBOR_INFO_UINT32 == info)
+            {
+                bits = (uint32_t)value;
+                item->type = CBOR_TYPE_FLOAT;
+                memcpy(&item->number, &bits, sizeof(bits));
+            }
+            else if (CBOR_INFO_UINT64 == info)
+            {
+                item->type = CBOR_TYPE_FLOAT;
+                memcpy(&number, &value, sizeof(number));
+                item->number = (float)number;
+            }
+            else if (CBOR_SIMPLE_FALSE == value)
+            {
+                item->type = CBOR_TYPE_FALSE;
+            }
+            else if (CBOR_SIMPLE_TRUE == value)
+            {
+                item->type = CBOR_TYPE_TRUE;
+            }
+            else if (CBOR_SIMPLE_NULL == value)
+            {
+                item->type = CBOR_TYPE_NULL;
+            }
+            else if (CBOR_SIMPLE_UNDEFINED == value)
+            {
+                item->type = CBOR_TYPE_UNDEFINED;
+            }
+            else
+            {
+                item->type = CBOR_TYPE_SIMPLE;
+            }
+            break;
+    }
+
+    dec->offset += head;
+
+    return CBOR_OK;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_decode_skip
+ *******************************************************************************
+ * Summary:
+ *  Consumes the next complete data item, including all nested items. On any
+ *  status other than CBOR_OK the decoder is left where it was.
+ *
+ * Parameters:
+ *  dec - Decoder.
+ *
+ * Return:
+ *  cbor_status_t: CBOR_OK, CBOR_NEED_MORE, CBOR_ERR_MALFORMED, or
+ *  CBOR_ERR_NESTING.
+ *
+ *******************************************************************************/
+cbor_status_t cbor_decode_skip(cbor_decoder_t *dec)
+{
+    uint64_t outer[CBOR_MAX_NESTING];
+    uint64_t remaining = 1;
+    uint32_t depth = 0;
+    size_t start = dec->offset;
+    cbor_status_t status = CBOR_OK;
+    cbor_item_t item;
+    bool container;
+
+    do
+    {
+        status = cbor_decode_next(dec, &item);
+        if (CBOR_OK != status)
+        {
+            break;
+        }
+
+        if (CBOR_TYPE_BREAK == item.type)
+        {
+            if ((0 == depth) || (CBOR_COUNT_INDEFINITE != remaining))
+            {
+                status = CBOR_ERR_MALFORMED;
+                break;
+            }
+            remaining = 0;
+        }
+        else
+        {
+            if (CBOR_COUNT_INDEFINITE != remaining)
+            {
+                remaining--;
+            }
+
+            container = (CBOR_TYPE_ARRAY == item.type) || (CBOR_TYPE_MAP == item.type) ||
+                        (item.indefinite && ((CBOR_TYPE_BYTES == item.type) || (CBOR_TYPE_TEXT == item.type)));
+
+            if (CBOR_TYPE_TAG == item.type)
+            {
+                /* The tagged content is one more item at this level. */
+                if (CBOR_COUNT_INDEFINITE != remaining)
+                {
+                    remaining++;
+                }
+            }
+            else if (container && (item.indefinite || (0 != item.value)))
+            {
+                if (depth >= CBOR_MAX_NESTING)
+                {
+                    status = CBOR_ERR_NESTING;
+                    break;
+                }
+                outer[depth++] = remaining;
+
+                if (item.indefinite)
+                {
+                    remaining = CBOR_COUNT_INDEFINITE;
+                }
+                else
+                {
+                    remaining = (CBOR_TYPE_MAP == item.type) ? (2u * item.value) : item.value;
+                }
+            }
+        }
+
+        while ((0 == remaining) && (depth > 0))
+        {
+            remaining = outer[--depth];
+        }
+    } while ((0 != remaining) || (0 != depth));
+
+    if (CBOR_OK != status)
+    {
+        dec->offset = start;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_item_get_int
+ *******************************************************************************
+ * Summary:
+ *  Returns the value of an integer item as a signed integer.
+ *
+ * Parameters:
+ *  item - Decoded item.
+ *  value - Filled with the value.
+ *
+ * Return:
+ *  bool: true if the item is an integer that fits in int64_t.
+ *
+ *******************************************************************************/
+bool cbor_item_get_int(const cbor_item_t *item, int64_t *value)
+{
+    if (item->value > (uint64_t)INT64_MAX)
+    {
+        return false;
+    }
+
+    if (CBOR_TYPE_UINT == item->type)
+    {
+        *value = (int64_t)item->value;
+        return true;
+    }
+
+    if (CBOR_TYPE_NEGINT == item->type)
+    {
+        *value = -1 - (int64_t)item->value;
+        return true;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_item_text_equals
+ *******************************************************************************
+ * Summary:
+ *  Compares a definite text string item with a NUL-terminated string.
+ *
+ * Parameters:
+ *  item - Decoded item.
+ *  text - String to compare with.
+ *
+ * Return:
+ *  bool: true if the item is a text string equal to text.
+ *
+ *******************************************************************************/
+bool cbor_item_text_equals(const cbor_item_t *item, const char *text)
+{
+    size_t length = strlen(text);
+
+    return (CBOR_TYPE_TEXT == item->type) && !item->indefinite &&
+           (item->value == length) && (0 == memcmp(item->data, text, length));
+}
+
+/*******************************************************************************
+ * Function Name: encoder_write
+ *******************************************************************************
+ * Summary:
+ *  Appends bytes to the encoder buffer, flushing it whenever it is full.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  data - Bytes to append.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void encoder_write(cbor_encoder_t *enc, const uint8_t *data, size_t length)
+{
+    size_t chunk;
+
+    while ((CBOR_OK == enc->status) && (length > 0))
+    {
+        if (enc->length == enc->size)
+        {
+            if ((NULL == enc->flush) || !enc->flush(enc->buffer, enc->length, enc->flush_arg))
+            {
+                enc->status = CBOR_ERR_OVERFLOW;
+                return;
+            }
+            enc->length = 0;
+        }
+
+        chunk = enc->size - enc->length;
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+
+        memcpy(&enc->buffer[enc->length], data, chunk);
+        enc->length += chunk;
+        enc->total += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: encode_head
+ *******************************************************************************
+ * Summary:
+ *  Encodes the initial byte of an item and its argument in the shortest form.
+ *
+ * Parameters:
+ *  enc - Encoder.
+ *  major - Major type.
+ *  value - Argument: value, length, or count.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void encode_head(cbor_encoder_t *enc, uint8_t major, uint64_t value)
+{
+    uint8_t head[9];
+    size_t size;
+    size_t index;
+
+    if (value < CBOR_INFO_UINT8)
+    {
+        head[0] = (uint8_t)((major << 5) | value);
+        encoder_write(enc, head, 1);
+        return;
+    }
+
+    if (value <= UINT8_MAX)
+    {
+        head[0] = (uint8_t)((major << 5) | CBOR_INFO_UINT8);
+        size = 1;
+    }
+    else if (value <= UINT16_MAX)
+    {
+        head[0] = (uint8_t)((major << 5) | CBOR_INFO_UINT16);
+        size = 2;
+    }
+    else if (value <= UINT32_MAX)
+    {
+        head[0] = (uint8_t)((major << 5) | CBOR_INFO_UINT32);
+        size = 4;
+    }
+    else
+    {
+        head[0] = (uint8_t)((major << 5) | CBOR_INFO_UINT64);
+        size = 8;
+    }
+
+    for (index = size; index > 0; index--)
+    {
+        head[index] = (uint8_t)value;
+        value >>= 8;
+    }
+
+    encoder_write(enc, head, size + 1);
+}
+
+/*******************************************************************************
+ * Function Name: float_to_half
+ *******************************************************************************
+ * Summary:
+ *  Converts a float to IEEE 754 half precision if the conversion is exact.
+ *
+ * Parameters:
+ *  value - Value to convert.
+ *  half - Filled with the half-precision bits.
+ *
+ * Return:
+ *  bool: true if the half-precision value is exactly equal to value.
+ *
+ *******************************************************************************/
+static bool float_to_half(float value, uint16_t *half)
+{
+    uint32_t bits;
+    uint16_t sign;
+    int32_t exponent;
+    uint32_t mantissa;
+    uint32_t shift;
+
+    memcpy(&bits, &value, sizeof(bits));
+    sign = (uint16_t)((bits >> 16) & 0x8000u);
+    exponent = (int32_t)((bits >> 23) & 0xFFu) - 127;
+    mantissa = bits & 0x7FFFFFu;
+
+    if (0 == (bits & 0x7FFFFFFFu))
+    {
+        *half = sign;
+        return true;
+    }
+
+    if (128 == exponent)
+    {
+        /* Infinity, or NaN which is always encoded as the canonical quiet NaN. */
+        *half = sign | 0x7C00u | ((0 != mantissa) ? 0x0200u : 0u);
+        return true;
+    }
+
+    if ((exponent >= -14) && (exponent <= 15))
+    {
+        if (0 != (mantissa & 0x1FFFu))
+        {
+            return false;
+        }
+        *half = sign | (uint16_t)((uint32_t)(exponent + 15) << 10) | (uint16_t)(mantissa >> 13);
+        return true;
+    }
+
+    if ((exponent >= -24) && (exponent < -14))
+    {
+        /* Subnormal half: value = m * 2^-24 with m < 1024. */
+        mantissa |= 0x800000u;
+        shift = (uint32_t)(-(exponent + 1));
+        if (0 != (mantissa & ((1u << shift) - 1u)))
+        {
+            return false;
+        }
+        *half = sign | (uint16_t)(mantissa >> shift);
+        return true;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: half_to_float
+ *******************************************************************************
+ * Summary:
+ *  Converts an IEEE 754 half-precision value to a float.
+ *
+ * Parameters:
+ *  half - Half-precision bits.
+ *
+ * Return:
+ *  float: The converted value.
+ *
+ *******************************************************************************/
+static float half_to_float(uint16_t half)
+{
+    uint32_t sign = ((uint32_t)half & 0x8000u) << 16;
+    uint32_t exponent = ((uint32_t)half >> 10) & 0x1Fu;
+    uint32_t mantissa = (uint32_t)half & 0x3FFu;
+    uint32_t bits;
+    float value;
+
+    if (0 == exponent)
+    {
+        /* Zero or subnormal: mantissa * 2^-24. */
+        value = (float)mantissa * (1.0f / 16777216.0f);
+        return (0 != sign) ? -value : value;
+    }
+
+    if (31u == exponent)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+/* [] END OF FILE */
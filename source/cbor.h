@@ -0,0 +1,152 @@
+/******************************************************************************
+* File Name: cbor.h
+*
+* Description: This file contains the API of the CBOR (RFC 8949) encoder and
+* decoder. Neither allocates memory: the encoder writes into a caller buffer,
+* optionally flushing it through a callback, and the decoder returns items
+* that point into the input.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef CBOR_H_
+#define CBOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CBOR_CONTENT_TYPE                        "application/cbor"
+
+/* Deepest nesting of arrays and maps that cbor_decode_skip() can step over. */
+#define CBOR_MAX_NESTING                         (8)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    CBOR_OK,
+    CBOR_NEED_MORE,          /* The input ends inside the next item. */
+    CBOR_ERR_MALFORMED,      /* The input is not well-formed CBOR. */
+    CBOR_ERR_OVERFLOW,       /* The encoder buffer is full and cannot be flushed. */
+    CBOR_ERR_NESTING,        /* Nesting deeper than CBOR_MAX_NESTING. */
+} cbor_status_t;
+
+typedef enum
+{
+    CBOR_TYPE_UINT,
+    CBOR_TYPE_NEGINT,        /* The value is -1 - item.value. */
+    CBOR_TYPE_BYTES,
+    CBOR_TYPE_TEXT,
+    CBOR_TYPE_ARRAY,
+    CBOR_TYPE_MAP,           /* item.value is the number of pairs. */
+    CBOR_TYPE_TAG,
+    CBOR_TYPE_FALSE,
+    CBOR_TYPE_TRUE,
+    CBOR_TYPE_NULL,
+    CBOR_TYPE_UNDEFINED,
+    CBOR_TYPE_SIMPLE,
+    CBOR_TYPE_FLOAT,
+    CBOR_TYPE_BREAK,         /* End of an indefinite-length item. */
+} cbor_type_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Writes out a full encoder buffer. Returns false to abort the encoding. */
+typedef bool (*cbor_flush_t)(const uint8_t *data, size_t length, void *arg);
+
+typedef struct
+{
+    uint8_t *buffer;
+    size_t size;
+    size_t length;           /* Bytes in the buffer not yet flushed. */
+    size_t total;            /* Bytes encoded since the encoder was set up. */
+    cbor_flush_t flush;
+    void *flush_arg;
+    cbor_status_t status;    /* First error, if any; later calls do nothing. */
+} cbor_encoder_t;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t length;
+    size_t offset;           /* Bytes of the input consumed so far. */
+} cbor_decoder_t;
+
+typedef struct
+{
+    cbor_type_t type;
+    uint64_t value;          /* Integer, length, count, tag, or simple value. */
+    bool indefinite;         /* Length or count is not known up front. */
+    const uint8_t *data;     /* Content of a definite byte or text string. */
+    float number;            /* Value of a half, single, or double float. */
+} cbor_item_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void cbor_encoder_init(cbor_encoder_t *enc, uint8_t *buffer, size_t size,
+                       cbor_flush_t flush, void *flush_arg);
+cbor_status_t cbor_encoder_finish(cbor_encoder_t *enc);
+void cbor_encode_uint(cbor_encoder_t *enc, uint64_t value);
+void cbor_encode_int(cbor_encoder_t *enc, int64_t value);
+void cbor_encode_bytes(cbor_encoder_t *enc, const uint8_t *data, size_t length);
+void cbor_encode_text(cbor_encoder_t *enc, const char *text, size_t length);
+void cbor_encode_cstr(cbor_encoder_t *enc, const char *text);
+void cbor_encode_array(cbor_encoder_t *enc, size_t count);
+void cbor_encode_map(cbor_encoder_t *enc, size_t pairs);
+void cbor_encode_tag(cbor_encoder_t *enc, uint64_t tag);
+void cbor_encode_bool(cbor_encoder_t *enc, bool value);
+void cbor_encode_null(cbor_encoder_t *enc);
+void cbor_encode_float(cbor_encoder_t *enc, float value);
+
+void cbor_decoder_init(cbor_decoder_t *dec, const uint8_t *data, size_t length);
+cbor_status_t cbor_decode_next(cbor_decoder_t *dec, cbor_item_t *item);
+cbor_status_t cbor_decode_skip(cbor_decoder_t *dec);
+bool cbor_item_get_int(const cbor_item_t *item, int64_t *value);
+bool cbor_item_text_equals(const cbor_item_t *item, const char *text);
+
+#endif /* CBOR_H_ */
+
+
+/* [] END OF FILE */
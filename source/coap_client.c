@@ -0,0 +1,1437 @@
+/******************************************************************************
+* File Name: coap_client.c
+*
+* Description: This file contains the CoAP client (RFC 7252) over the DTLS
+* transport. It sends confirmable and non-confirmable requests with
+* retransmission, transfers large bodies block-wise (RFC 7959), and observes
+* resources (RFC 7641). Requests of the HTTPS request API can be sent
+* through it as an alternative transport.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+/* Wi-Fi connection manager header files */
+#include "cy_wcm.h"
+
+#include "mbedtls/ctr_drbg.h"
+
+#include "secure_http_client.h"
+#include "coap_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define COAP_VERSION                     (1u)
+
+/* Message types. */
+#define COAP_TYPE_CON                    (0u)
+#define COAP_TYPE_NON                    (1u)
+#define COAP_TYPE_ACK                    (2u)
+#define COAP_TYPE_RST                    (3u)
+
+/* Option numbers. */
+#define COAP_OPTION_OBSERVE              (6u)
+#define COAP_OPTION_URI_PATH             (11u)
+#define COAP_OPTION_CONTENT_FORMAT       (12u)
+#define COAP_OPTION_BLOCK2               (23u)
+#define COAP_OPTION_BLOCK1               (27u)
+#define COAP_OPTION_SIZE1                (60u)
+
+#define COAP_HEADER_SIZE                 (4u)
+#define COAP_MAX_TOKEN_LENGTH            (8u)
+#define COAP_PAYLOAD_MARKER              (0xFFu)
+
+/* Option delta and length nibbles followed by extended bytes. */
+#define COAP_NIBBLE_EXTEND_8             (13u)
+#define COAP_NIBBLE_EXTEND_16            (14u)
+#define COAP_NIBBLE_RESERVED             (15u)
+
+/* Block option value: NUM << 4 | M << 3 | SZX. */
+#define BLOCK_VALUE(num, more, szx)      (((uint32_t)(num) << 4) | ((more) ? 0x08u : 0u) | (szx))
+#define BLOCK_NUM(value)                 ((value) >> 4)
+#define BLOCK_MORE(value)                (0u != ((value) & 0x08u))
+#define BLOCK_SZX(value)                 ((value) & 0x07u)
+#define BLOCK_SIZE(szx)                  (16u << (szx))
+
+/* Observe: register and deregister, and the freshness rules (RFC 7641, 3.4). */
+#define OBSERVE_REGISTER                 (0u)
+#define OBSERVE_DEREGISTER               (1u)
+#define OBSERVE_HALF_RANGE               (1uL << 23)
+#define OBSERVE_FRESHNESS_MS             (128000u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* A parsed message. payload points into the receive buffer. */
+typedef struct
+{
+    uint8_t type;
+    uint8_t code;
+    uint16_t message_id;
+    uint8_t token[COAP_MAX_TOKEN_LENGTH];
+    uint8_t token_length;
+    bool has_observe;
+    uint32_t observe;
+    bool has_block1;
+    uint32_t block1;
+    bool has_block2;
+    uint32_t block2;
+    uint16_t content_format;
+    const uint8_t *payload;
+    uint32_t length;
+} coap_message_t;
+
+/* Options of a request other than its path and content format. */
+typedef struct
+{
+    bool has_observe;
+    uint32_t observe;
+    bool has_block2;
+    uint32_t block2;
+    bool has_block1;
+    uint32_t block1;
+    uint32_t size1;              /* 0 to omit. */
+} request_options_t;
+
+/* Serializes a message into the transmit buffer. */
+typedef struct
+{
+    uint8_t *buffer;
+    uint32_t length;
+    uint16_t last_option;
+    bool overflow;
+} message_writer_t;
+
+/* Response collected for https_send_request(). */
+typedef struct
+{
+    uint32_t length;
+    bool truncated;
+} https_collect_t;
+
+/* Totals of a demo exchange. */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t parts;
+    uint8_t code;
+} demo_counts_t;
+
+/* Content formats of the media types of the HTTPS request API. */
+typedef struct
+{
+    const char *media_type;
+    uint16_t content_format;
+} media_type_map_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Client of https_send_request() and of the demo, and its mutex. */
+static coap_client_t coap_client;
+static SemaphoreHandle_t coap_mutex;
+
+static uint8_t https_response_body[COAP_HTTPS_RESPONSE_SIZE];
+
+static const media_type_map_t media_types[] =
+{
+    { "text/plain", COAP_FORMAT_TEXT },
+    { "application/octet-stream", COAP_FORMAT_OCTET_STREAM },
+    { "application/json", COAP_FORMAT_JSON },
+    { "application/cbor", COAP_FORMAT_CBOR },
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static uint32_t build_request(coap_client_t *client, const coap_request_t *request, uint8_t type,
+                              uint32_t token, const request_options_t *options,
+                              const uint8_t *payload, uint32_t length);
+static void write_option(message_writer_t *writer, uint16_t number, const uint8_t *value, uint32_t length);
+static void write_uint_option(message_writer_t *writer, uint16_t number, uint32_t value);
+static uint32_t option_nibble(uint32_t value, uint8_t *extended, uint32_t *extended_length);
+static bool parse_message(const uint8_t *data, uint32_t length, coap_message_t *message);
+static uint32_t read_uint(const uint8_t *value, uint32_t length);
+static cy_rslt_t exchange(coap_client_t *client, uint32_t length, bool confirmable, uint32_t token,
+                          coap_message_t *response);
+static cy_rslt_t send_empty(coap_client_t *client, uint8_t type, uint16_t message_id);
+static bool token_matches(const coap_message_t *message, uint32_t token);
+static bool deliver(const coap_message_t *message, coap_response_cb_t callback, void *arg);
+static uint32_t next_random(coap_client_t *client);
+static uint16_t content_format_of(const char *media_type);
+static uint16_t http_status_of(uint8_t code);
+static bool collect_https_response(const coap_response_t *response, void *arg);
+static bool count_demo_response(const coap_response_t *response, void *arg);
+static bool print_notification(const coap_response_t *response, void *arg);
+static void https_demo_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+
+/*******************************************************************************
+ * Function Name: coap_client_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the mutex of the shared CoAP client. The DTLS association is
+ *  made on the first request.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the client is ready, otherwise,
+ *  CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t coap_client_init(void)
+{
+    if (NULL != coap_mutex)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    coap_mutex = xSemaphoreCreateMutex();
+    if (NULL == coap_mutex)
+    {
+        ERR_INFO(("Failed to create the CoAP client mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: coap_connect
+ *******************************************************************************
+ * Summary:
+ *  Makes the DTLS association with the CoAP server, rejoining the Wi-Fi AP
+ *  first if the link was lost. The message ID and token are started at
+ *  random values on the first connection.
+ *
+ * Parameters:
+ *  client - Client, zeroed before its first connection.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if connected, otherwise, the error of
+ *  the WCM or of the DTLS transport.
+ *
+ *******************************************************************************/
+cy_rslt_t coap_connect(coap_client_t *client)
+{
+    cy_rslt_t result;
+
+    if (client->transport.connected)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    if (!cy_wcm_is_connected_to_ap())
+    {
+        result = wifi_connect();
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+    }
+
+    result = dtls_transport_connect(&client->transport, COAP_SERVER_HOST, COAP_SERVER_PORT);
+    if ((CY_RSLT_SUCCESS == result) && (0u == client->token))
+    {
+        client->message_id = (uint16_t)next_random(client);
+        client->token = next_random(client) | 1u;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: coap_request
+ *******************************************************************************
+ * Summary:
+ *  Sends a request and passes its response to a callback. A payload longer
+ *  than one block is sent block-wise with Block1, adopting a smaller block
+ *  size if the server asks for one. A response to a GET sent block-wise is
+ *  fetched with Block2 and passed to the callback block by block. A
+ *  non-confirmable request without a callback is not waited for.
+ *
+ * Parameters:
+ *  client - Client.
+ *  request - Request.
+ *  callback - Called with each part of the response. Can be NULL.
+ *  arg - Argument passed to the callback.
+ *  code - Receives the response code, 0 if no response was waited for.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a response arrived, whatever its
+ *  code, otherwise, the error of the transport,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT, or CY_RSLT_TYPE_ERROR if the
+ *  server reset the request.
+ *
+ *******************************************************************************/
+cy_rslt_t coap_request(coap_client_t *client, const coap_request_t *request,
+                       coap_response_cb_t callback, void *arg, uint8_t *code)
+{
+    cy_rslt_t result;
+    coap_message_t response;
+    request_options_t options;
+    coap_request_t next_block;
+    uint32_t szx = COAP_BLOCK_SZX;
+    uint32_t offset = 0;
+    uint32_t chunk;
+    uint32_t length;
+    uint32_t token;
+    bool block1 = (request->length > BLOCK_SIZE(COAP_BLOCK_SZX));
+    bool more;
+    bool confirmable = block1 || request->confirmable;
+
+    *code = 0;
+
+    result = coap_connect(client);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    token = client->token++;
+    client->stats.requests++;
+
+    for (;;)
+    {
+        memset(&options, 0, sizeof(options));
+        chunk = request->length - offset;
+        more = false;
+
+        if (block1)
+        {
+            if (chunk > BLOCK_SIZE(szx))
+            {
+                chunk = BLOCK_SIZE(szx);
+                more = true;
+            }
+            options.has_block1 = true;
+            options.block1 = BLOCK_VALUE(offset / BLOCK_SIZE(szx), more, szx);
+            options.size1 = (0u == offset) ? request->length : 0u;
+        }
+
+        length = build_request(client, request, confirmable ? COAP_TYPE_CON : COAP_TYPE_NON, token, &options,
+                               &request->payload[offset], chunk);
+        if (0u == length)
+        {
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        if (!confirmable && (NULL == callback))
+        {
+            return dtls_transport_send(&client->transport, client->tx_buffer, length);
+        }
+
+        result = exchange(client, length, confirmable, token, &response);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        if (!more || (COAP_CODE_CONTINUE != response.code))
+        {
+            break;
+        }
+
+        /* The server may ask for smaller blocks; the bytes sent are a multiple of them. */
+        offset += chunk;
+        if (response.has_block1 && (BLOCK_SZX(response.block1) < szx))
+        {
+            szx = BLOCK_SZX(response.block1);
+        }
+    }
+
+    /* Block-wise response: the next blocks are requested with the same token. */
+    next_block = *request;
+    next_block.payload = NULL;
+    next_block.length = 0;
+
+    while (deliver(&response, callback, arg) && response.has_block2 && BLOCK_MORE(response.block2) &&
+           (COAP_METHOD_GET == request->method))
+    {
+        memset(&options, 0, sizeof(options));
+        options.has_block2 = true;
+        options.block2 = BLOCK_VALUE(BLOCK_NUM(response.block2) + 1u, false, BLOCK_SZX(response.block2));
+
+        length = build_request(client, &next_block, COAP_TYPE_CON, token, &options, NULL, 0);
+        result = (0u == length) ? CY_RSLT_TYPE_ERROR : exchange(client, length, true, token, &response);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+    }
+
+    *code = response.code;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: coap_observe
+ *******************************************************************************
+ * Summary:
+ *  Registers as an observer of a resource and passes its representation and
+ *  then each notification to a callback, until the callback returns false
+ *  or the duration ends. Confirmable notifications are acknowledged, and
+ *  notifications older than the last one delivered are dropped. The
+ *  observation is then cancelled with a deregistering GET.
+ *
+ * Parameters:
+ *  client - Client.
+ *  path - Resource to observe.
+ *  callback - Called with the representation and each notification.
+ *  arg - Argument passed to the callback.
+ *  duration_ms - Time to observe.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the resource was observed or the
+ *  server answered without Observe, otherwise, the error of the
+ *  registration or the transport.
+ *
+ *******************************************************************************/
+cy_rslt_t coap_observe(coap_client_t *client, const char *path, coap_response_cb_t callback,
+                       void *arg, uint32_t duration_ms)
+{
+    cy_rslt_t result;
+    coap_message_t message;
+    coap_request_t request;
+    request_options_t options;
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t last_ticks;
+    uint32_t elapsed_ms;
+    uint32_t received;
+    uint32_t length;
+    uint32_t token;
+    uint32_t last_observe;
+    bool fresh;
+    bool observing;
+
+    memset(&request, 0, sizeof(request));
+    request.method = COAP_METHOD_GET;
+    request.path = path;
+    request.content_format = COAP_FORMAT_NONE;
+    request.confirmable = true;
+
+    result = coap_connect(client);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    token = client->token++;
+    client->stats.requests++;
+
+    memset(&options, 0, sizeof(options));
+    options.has_observe = true;
+    options.observe = OBSERVE_REGISTER;
+
+    length = build_request(client, &request, COAP_TYPE_CON, token, &options, NULL, 0);
+    result = (0u == length) ? CY_RSLT_TYPE_ERROR : exchange(client, length, true, token, &message);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    observing = deliver(&message, callback, arg) && message.has_observe;
+    last_observe = message.observe;
+    last_ticks = xTaskGetTickCount();
+
+    while (observing)
+    {
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+        if (elapsed_ms >= duration_ms)
+        {
+            break;
+        }
+
+        result = dtls_transport_recv(&client->transport, client->rx_buffer, sizeof(client->rx_buffer),
+                                     duration_ms - elapsed_ms, &received);
+        if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            continue;
+        }
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        if (!parse_message(client->rx_buffer, received, &message) || (COAP_TYPE_ACK == message.type) ||
+            (COAP_TYPE_RST == message.type))
+        {
+            continue;
+        }
+
+        if (!token_matches(&message, token) || !message.has_observe)
+        {
+            if (COAP_TYPE_CON == message.type)
+            {
+                (void)send_empty(client, COAP_TYPE_RST, message.message_id);
+            }
+            continue;
+        }
+
+        if (COAP_TYPE_CON == message.type)
+        {
+            (void)send_empty(client, COAP_TYPE_ACK, message.message_id);
+        }
+
+        fresh = ((last_observe < message.observe) && ((message.observe - last_observe) < OBSERVE_HALF_RANGE)) ||
+                ((last_observe > message.observe) && ((last_observe - message.observe) > OBSERVE_HALF_RANGE)) ||
+                ((uint32_t)(xTaskGetTickCount() - last_ticks) * portTICK_PERIOD_MS > OBSERVE_FRESHNESS_MS);
+        if (!fresh)
+        {
+            continue;
+        }
+
+        last_observe = message.observe;
+        last_ticks = xTaskGetTickCount();
+        client->stats.notifications++;
+        observing = deliver(&message, callback, arg);
+    }
+
+    /* Deregister so the server stops sending notifications. */
+    options.observe = OBSERVE_DEREGISTER;
+    length = build_request(client, &request, COAP_TYPE_CON, token, &options, NULL, 0);
+    if (0u != length)
+    {
+        (void)exchange(client, length, true, token, &message);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: coap_close
+ *******************************************************************************
+ * Summary:
+ *  Closes the DTLS association.
+ *
+ * Parameters:
+ *  client - Client.
+ *  keep_session - Keep the DTLS session to resume it on the next request.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void coap_close(coap_client_t *client, bool keep_session)
+{
+    dtls_transport_close(&client->transport, keep_session);
+}
+
+/*******************************************************************************
+ * Function Name: coap_send_https_request
+ *******************************************************************************
+ * Summary:
+ *  Sends a request of the HTTPS request API as a confirmable CoAP request
+ *  on the shared client, for requests with REQUEST_TRANSPORT_COAP. The
+ *  media type becomes a Content-Format, and the response is collected and
+ *  passed to the response callback as an HTTP response with the equivalent
+ *  status code and no headers; the callback gets a NULL client handle.
+ *  Safe to call from any task.
+ *
+ * Parameters:
+ *  request - Request to send. HEAD is not supported.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a response arrived, otherwise,
+ *  the error of coap_request() or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t coap_send_https_request(const https_request_t *request)
+{
+    cy_rslt_t result;
+    cy_http_client_response_t response;
+    coap_request_t coap;
+    https_collect_t collect;
+    uint8_t code;
+
+    memset(&coap, 0, sizeof(coap));
+    coap.path = request->path;
+    coap.content_format = (NULL == request->content_type) ? COAP_FORMAT_NONE :
+                          content_format_of(request->content_type);
+    coap.payload = request->body;
+    coap.length = request->body_len;
+    coap.confirmable = true;
+
+    switch (request->method)
+    {
+        case CY_HTTP_CLIENT_METHOD_GET:
+            coap.method = COAP_METHOD_GET;
+            break;
+        case CY_HTTP_CLIENT_METHOD_POST:
+            coap.method = COAP_METHOD_POST;
+            break;
+        case CY_HTTP_CLIENT_METHOD_PUT:
+            coap.method = COAP_METHOD_PUT;
+            break;
+        default:
+            ERR_INFO(("The request method %d has no CoAP equivalent.\n", (int)request->method));
+            return CY_RSLT_TYPE_ERROR;
+    }
+
+    memset(&collect, 0, sizeof(collect));
+
+    xSemaphoreTake(coap_mutex, portMAX_DELAY);
+
+    result = coap_request(&coap_client, &coap, collect_https_response, &collect, &code);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        /* The next request makes a new association, resuming the session. */
+        coap_close(&coap_client, true);
+    }
+    else
+    {
+        memset(&response, 0, sizeof(response));
+        response.status_code = http_status_of(code);
+        response.body = https_response_body;
+        response.body_len = collect.length;
+        response.buffer = https_response_body;
+        response.buffer_len = sizeof(https_response_body);
+
+        if (collect.truncated)
+        {
+            ERR_INFO(("The CoAP response was cut to %u bytes.\n", COAP_HTTPS_RESPONSE_SIZE));
+        }
+
+        if (NULL != request->response_cb)
+        {
+            request->response_cb(NULL, &response, request->cb_arg);
+        }
+        else
+        {
+            TEST_INFO(("Received CoAP response %u.%02u from %s\n"
+                       "Response Body   :\n %.*s\n",
+                       (unsigned int)(code >> 5), (unsigned int)(code & 0x1Fu), request->path,
+                       (int)collect.length, https_response_body));
+        }
+    }
+
+    xSemaphoreGive(coap_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: coap_demo
+ *******************************************************************************
+ * Summary:
+ *  Compares the delivery of one COAP_DEMO_REPORT_SIZE byte report after a
+ *  wake, when no connection is open:
+ *  - HTTPS POST on a new TCP and TLS connection.
+ *  - CoAP confirmable POST after a full DTLS handshake.
+ *  - CoAP confirmable POST after a resumed DTLS handshake, the case after a
+ *    wake when the session was kept in retained RAM.
+ *  - CoAP non-confirmable POST after a resumed handshake.
+ *  The time to deliver runs from the start of the connection to the
+ *  acknowledgement, which is also the time the radio has to stay awake for
+ *  the report. The datagrams and bytes of the CoAP exchanges are printed.
+ *  It then fetches COAP_DEMO_BLOCK_PATH block-wise and observes
+ *  COAP_DEMO_OBSERVE_PATH for COAP_DEMO_OBSERVE_MS.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void coap_demo(void)
+{
+    static const char *names[] = { "CoAP CON full", "CoAP CON resumed", "CoAP NON resumed" };
+    static uint8_t report[COAP_DEMO_REPORT_SIZE];
+    https_request_t https = {0};
+    coap_request_t request;
+    dtls_transport_stats_t before;
+    dtls_transport_stats_t *stats = &coap_client.transport.stats;
+    demo_counts_t counts;
+    TickType_t start_ticks;
+    cy_rslt_t result;
+    uint16_t status = 0;
+    uint8_t code;
+
+    for (uint32_t i = 0; i < sizeof(report); i++)
+    {
+        report[i] = (uint8_t)('a' + (i % 26u));
+    }
+
+    APP_INFO(("One %u byte report after a wake, to %s\n", COAP_DEMO_REPORT_SIZE, COAP_DEMO_REPORT_PATH));
+    printf("\n  %-18s %12s %12s %14s %14s\n", "transport", "handshake ms", "deliver ms", "datagrams o/i", "bytes o/i");
+
+    https.method = CY_HTTP_CLIENT_METHOD_POST;
+    https.path = COAP_DEMO_REPORT_PATH;
+    https.content_type = "text/plain";
+    https.body = report;
+    https.body_len = sizeof(report);
+    https.response_cb = https_demo_response;
+    https.cb_arg = &status;
+    https.quiet = true;
+
+    https_disconnect();
+    start_ticks = xTaskGetTickCount();
+    result = https_send_request(&https);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        printf("  %-18s %12s %12lu %14s %14s   status %u\n", "HTTPS POST", "-",
+               (unsigned long)((uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS), "-", "-",
+               status);
+    }
+    else
+    {
+        ERR_INFO(("The HTTPS POST failed: 0x%08lx\n", (unsigned long)result));
+    }
+
+    memset(&request, 0, sizeof(request));
+    request.method = COAP_METHOD_POST;
+    request.path = COAP_DEMO_REPORT_PATH;
+    request.content_format = COAP_FORMAT_TEXT;
+    request.payload = report;
+    request.length = sizeof(report);
+
+    xSemaphoreTake(coap_mutex, portMAX_DELAY);
+
+    for (uint32_t mode = 0; mode < (sizeof(names) / sizeof(names[0])); mode++)
+    {
+        coap_close(&coap_client, 0u != mode);
+        request.confirmable = (2u != mode);
+        before = *stats;
+
+        start_ticks = xTaskGetTickCount();
+        result = coap_request(&coap_client, &request, NULL, NULL, &code);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("%s failed: 0x%08lx\n", names[mode], (unsigned long)result));
+            coap_close(&coap_client, true);
+            continue;
+        }
+
+        printf("  %-18s %12lu %12lu %8lu/%-5lu %8lu/%-5lu   code %u.%02u\n", names[mode],
+               (unsigned long)stats->handshake_ms,
+               (unsigned long)((uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS),
+               (unsigned long)(stats->datagrams_sent - before.datagrams_sent),
+               (unsigned long)(stats->datagrams_received - before.datagrams_received),
+               (unsigned long)(stats->bytes_sent - before.bytes_sent),
+               (unsigned long)(stats->bytes_received - before.bytes_received),
+               (unsigned int)(code >> 5), (unsigned int)(code & 0x1Fu));
+    }
+    printf("  The non-confirmable report is not acknowledged; its time ends when it is sent.\n");
+
+    memset(&counts, 0, sizeof(counts));
+    memset(&request, 0, sizeof(request));
+    request.method = COAP_METHOD_GET;
+    request.path = COAP_DEMO_BLOCK_PATH;
+    request.content_format = COAP_FORMAT_NONE;
+    request.confirmable = true;
+
+    start_ticks = xTaskGetTickCount();
+    result = coap_request(&coap_client, &request, count_demo_response, &counts, &code);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        APP_INFO(("GET %s: code %u.%02u, %lu bytes in %lu blocks, %lu ms\n", COAP_DEMO_BLOCK_PATH,
+                  (unsigned int)(code >> 5), (unsigned int)(code & 0x1Fu), (unsigned long)counts.bytes,
+                  (unsigned long)counts.parts,
+                  (unsigned long)((uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS)));
+    }
+    else
+    {
+        ERR_INFO(("GET %s failed: 0x%08lx\n", COAP_DEMO_BLOCK_PATH, (unsigned long)result));
+    }
+
+    APP_INFO(("Observing %s for %lu s\n", COAP_DEMO_OBSERVE_PATH, (unsigned long)(COAP_DEMO_OBSERVE_MS / 1000u)));
+    result = coap_observe(&coap_client, COAP_DEMO_OBSERVE_PATH, print_notification, NULL, COAP_DEMO_OBSERVE_MS);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Observing %s failed: 0x%08lx\n", COAP_DEMO_OBSERVE_PATH, (unsigned long)result));
+        coap_close(&coap_client, true);
+    }
+    APP_INFO(("%lu requests, %lu retransmissions, %lu timeouts, %lu notifications\n",
+              (unsigned long)coap_client.stats.requests, (unsigned long)coap_client.stats.retransmissions,
+              (unsigned long)coap_client.stats.timeouts, (unsigned long)coap_client.stats.notifications));
+
+    xSemaphoreGive(coap_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: build_request
+ *******************************************************************************
+ * Summary:
+ *  Serializes a request with a new message ID into the transmit buffer.
+ *  Options are written in ascending order, as the encoding requires.
+ *
+ * Return:
+ *  uint32_t: Length of the message, 0 if it does not fit.
+ *
+ *******************************************************************************/
+static uint32_t build_request(coap_client_t *client, const coap_request_t *request, uint8_t type,
+                              uint32_t token, const request_options_t *options,
+                              const uint8_t *payload, uint32_t length)
+{
+    message_writer_t writer;
+    uint16_t message_id = client->message_id++;
+    const char *segment = request->path;
+    uint32_t segment_length;
+    uint8_t *header = client->tx_buffer;
+
+    header[0] = (uint8_t)((COAP_VERSION << 6) | (type << 4) | COAP_TOKEN_LENGTH);
+    header[1] = request->method;
+    header[2] = (uint8_t)(message_id >> 8);
+    header[3] = (uint8_t)message_id;
+    header[4] = (uint8_t)(token >> 24);
+    header[5] = (uint8_t)(token >> 16);
+    header[6] = (uint8_t)(token >> 8);
+    header[7] = (uint8_t)token;
+
+    writer.buffer = client->tx_buffer;
+    writer.length = COAP_HEADER_SIZE + COAP_TOKEN_LENGTH;
+    writer.last_option = 0;
+    writer.overflow = false;
+
+    if (options->has_observe)
+    {
+        write_uint_option(&writer, COAP_OPTION_OBSERVE, options->observe);
+    }
+
+    /* One Uri-Path option per segment of the path. */
+    while ('\0' != *segment)
+    {
+        while ('/' == *segment)
+        {
+            segment++;
+        }
+        segment_length = strcspn(segment, "/?");
+        if (0u != segment_length)
+        {
+            write_option(&writer, COAP_OPTION_URI_PATH, (const uint8_t *)segment, segment_length);
+        }
+        segment += segment_length;
+        if ('?' == *segment)
+        {
+            break;
+        }
+    }
+
+    if ((0u != length) && (COAP_FORMAT_NONE != request->content_format))
+    {
+        write_uint_option(&writer, COAP_OPTION_CONTENT_FORMAT, request->content_format);
+    }
+    if (options->has_block2)
+    {
+        write_uint_option(&writer, COAP_OPTION_BLOCK2, options->block2);
+    }
+    if (options->has_block1)
+    {
+        write_uint_option(&writer, COAP_OPTION_BLOCK1, options->block1);
+    }
+    if (0u != options->size1)
+    {
+        write_uint_option(&writer, COAP_OPTION_SIZE1, options->size1);
+    }
+
+    if (0u != length)
+    {
+        if ((writer.length + 1u + length) > sizeof(client->tx_buffer))
+        {
+            writer.overflow = true;
+        }
+        else
+        {
+            writer.buffer[writer.length++] = COAP_PAYLOAD_MARKER;
+            memcpy(&writer.buffer[writer.length], payload, length);
+            writer.length += length;
+        }
+    }
+
+    if (writer.overflow)
+    {
+        ERR_INFO(("The CoAP request for %s does not fit in %u bytes.\n", request->path, COAP_MAX_MESSAGE_SIZE));
+        return 0;
+    }
+
+    return writer.length;
+}
+
+/*******************************************************************************
+ * Function Name: write_option
+ *******************************************************************************
+ * Summary:
+ *  Writes an option as a delta from the previous option number and a
+ *  length, each with its extended bytes, followed by the value.
+ *
+ *******************************************************************************/
+static void write_option(message_writer_t *writer, uint16_t number, const uint8_t *value, uint32_t length)
+{
+    uint8_t delta_extended[2];
+    uint8_t length_extended[2];
+    uint32_t delta_extended_length;
+    uint32_t length_extended_length;
+    uint32_t delta_nibble = option_nibble(number - writer->last_option, delta_extended, &delta_extended_length);
+    uint32_t length_nibble = option_nibble(length, length_extended, &length_extended_length);
+
+    if ((writer->length + 1u + delta_extended_length + length_extended_length + length) > COAP_MAX_MESSAGE_SIZE)
+    {
+        writer->overflow = true;
+        return;
+    }
+
+    writer->buffer[writer->length++] = (uint8_t)((delta_nibble << 4) | length_nibble);
+    memcpy(&writer->buffer[writer->length], delta_extended, delta_extended_length);
+    writer->length += delta_extended_length;
+    memcpy(&writer->buffer[writer->length], length_extended, length_extended_length);
+    writer->length += length_extended_length;
+    memcpy(&writer->buffer[writer->length], value, length);
+    writer->length += length;
+
+    writer->last_option = number;
+}
+
+/*******************************************************************************
+ * Function Name: write_uint_option
+ *******************************************************************************
+ * Summary:
+ *  Writes an unsigned integer option in the fewest bytes; 0 has no bytes.
+ *
+ *******************************************************************************/
+static void write_uint_option(message_writer_t *writer, uint16_t number, uint32_t value)
+{
+    uint8_t bytes[4];
+    uint32_t length = 0;
+
+    for (uint32_t shift = 32u; shift > 0u; shift -= 8u)
+    {
+        uint8_t byte = (uint8_t)(value >> (shift - 8u));
+
+        if ((0u != length) || (0u != byte))
+        {
+            bytes[length++] = byte;
+        }
+    }
+
+    write_option(writer, number, bytes, length);
+}
+
+/*******************************************************************************
+ * Function Name: option_nibble
+ *******************************************************************************
+ * Summary:
+ *  Encodes an option delta or length as a nibble and extended bytes.
+ *
+ *******************************************************************************/
+static uint32_t option_nibble(uint32_t value, uint8_t *extended, uint32_t *extended_length)
+{
+    if (value < COAP_NIBBLE_EXTEND_8)
+    {
+        *extended_length = 0;
+        return value;
+    }
+
+    if (value < 269u)
+    {
+        extended[0] = (uint8_t)(value - 13u);
+        *extended_length = 1;
+        return COAP_NIBBLE_EXTEND_8;
+    }
+
+    value -= 269u;
+    extended[0] = (uint8_t)(value >> 8);
+    extended[1] = (uint8_t)value;
+    *extended_length = 2;
+
+    return COAP_NIBBLE_EXTEND_16;
+}
+
+/*******************************************************************************
+ * Function Name: parse_message
+ *******************************************************************************
+ * Summary:
+ *  Parses a received message and the options the client uses. Unknown
+ *  options are skipped.
+ *
+ * Return:
+ *  bool: false if the message is malformed.
+ *
+ *******************************************************************************/
+static bool parse_message(const uint8_t *data, uint32_t length, coap_message_t *message)
+{
+    uint32_t index;
+    uint32_t number = 0;
+    uint32_t delta;
+    uint32_t option_length;
+    uint32_t value;
+
+    if ((length < COAP_HEADER_SIZE) || (COAP_VERSION != (data[0] >> 6)))
+    {
+        return false;
+    }
+
+    memset(message, 0, sizeof(*message));
+    message->type = (data[0] >> 4) & 0x03u;
+    message->token_length = data[0] & 0x0Fu;
+    message->code = data[1];
+    message->message_id = (uint16_t)(((uint16_t)data[2] << 8) | data[3]);
+    message->content_format = COAP_FORMAT_NONE;
+
+    if ((message->token_length > COAP_MAX_TOKEN_LENGTH) ||
+        ((COAP_HEADER_SIZE + message->token_length) > length))
+    {
+        return false;
+    }
+    memcpy(message->token, &data[COAP_HEADER_SIZE], message->token_length);
+    index = COAP_HEADER_SIZE + message->token_length;
+
+    while (index < length)
+    {
+        if (COAP_PAYLOAD_MARKER == data[index])
+        {
+            index++;
+            if (index == length)
+            {
+                /* A marker must be followed by a payload. */
+                return false;
+            }
+            message->payload = &data[index];
+            message->length = length - index;
+            break;
+        }
+
+        delta = data[index] >> 4;
+        option_length = data[index] & 0x0Fu;
+        index++;
+
+        for (uint32_t field = 0; field < 2u; field++)
+        {
+            uint32_t *nibble = (0u == field) ? &delta : &option_length;
+
+            if (COAP_NIBBLE_EXTEND_8 == *nibble)
+            {
+                if (index + 1u > length)
+                {
+                    return false;
+                }
+                *nibble = 13u + data[index];
+                index += 1u;
+            }
+            else if (COAP_NIBBLE_EXTEND_16 == *nibble)
+            {
+                if (index + 2u > length)
+                {
+                    return false;
+                }
+                *nibble = 269u + (((uint32_t)data[index] << 8) | data[index + 1u]);
+                index += 2u;
+            }
+            else if (COAP_NIBBLE_RESERVED == *nibble)
+            {
+                return false;
+            }
+        }
+
+        if ((index + option_length) > length)
+        {
+            return false;
+        }
+
+        number += delta;
+        value = read_uint(&data[index], option_length);
+
+        switch (number)
+        {
+            case COAP_OPTION_OBSERVE:
+                message->has_observe = true;
+                message->observe = value;
+                break;
+            case COAP_OPTION_CONTENT_FORMAT:
+                message->content_format = (uint16_t)value;
+                break;
+            case COAP_OPTION_BLOCK2:
+                message->has_block2 = true;
+                message->block2 = value;
+                break;
+            case COAP_OPTION_BLOCK1:
+                message->has_block1 = true;
+                message->block1 = value;
+                break;
+            default:
+                break;
+        }
+
+        index += option_length;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_uint
+ *******************************************************************************
+ * Summary:
+ *  Reads an unsigned integer option value of up to 4 bytes.
+ *
+ *******************************************************************************/
+static uint32_t read_uint(const uint8_t *value, uint32_t length)
+{
+    uint32_t result = 0;
+
+    for (uint32_t i = 0; (i < length) && (i < 4u); i++)
+    {
+        result = (result << 8) | value[i];
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: exchange
+ *******************************************************************************
+ * Summary:
+ *  Sends the request in the transmit buffer and waits for its response. A
+ *  confirmable request is retransmitted with exponential backoff until it
+ *  is acknowledged. After an empty acknowledgement the separate response is
+ *  awaited and acknowledged. Unexpected confirmable messages are reset.
+ *
+ *******************************************************************************/
+static cy_rslt_t exchange(coap_client_t *client, uint32_t length, bool confirmable, uint32_t token,
+                          coap_message_t *response)
+{
+    cy_rslt_t result;
+    uint16_t message_id = (uint16_t)(((uint16_t)client->tx_buffer[2] << 8) | client->tx_buffer[3]);
+    uint32_t timeout_ms = COAP_ACK_TIMEOUT_MS + (next_random(client) % ((COAP_ACK_TIMEOUT_MS / 2u) + 1u));
+    uint32_t wait_ms = confirmable ? timeout_ms : COAP_RESPONSE_TIMEOUT_MS;
+    uint32_t retransmissions = 0;
+    uint32_t elapsed_ms;
+    uint32_t received;
+    TickType_t start_ticks;
+    bool acknowledged = !confirmable;
+
+    result = dtls_transport_send(&client->transport, client->tx_buffer, length);
+    start_ticks = xTaskGetTickCount();
+
+    while (CY_RSLT_SUCCESS == result)
+    {
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+        if (elapsed_ms >= wait_ms)
+        {
+            if (acknowledged || (retransmissions >= COAP_MAX_RETRANSMIT))
+            {
+                client->stats.timeouts++;
+                return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+            }
+
+            retransmissions++;
+            client->stats.retransmissions++;
+            timeout_ms *= 2u;
+            wait_ms = timeout_ms;
+            result = dtls_transport_send(&client->transport, client->tx_buffer, length);
+            start_ticks = xTaskGetTickCount();
+            continue;
+        }
+
+        result = dtls_transport_recv(&client->transport, client->rx_buffer, sizeof(client->rx_buffer),
+                                     wait_ms - elapsed_ms, &received);
+        if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            result = CY_RSLT_SUCCESS;
+            continue;
+        }
+        if ((CY_RSLT_SUCCESS != result) || !parse_message(client->rx_buffer, received, response))
+        {
+            continue;
+        }
+
+        if (((COAP_TYPE_ACK == response->type) || (COAP_TYPE_RST == response->type)) &&
+            (response->message_id == message_id))
+        {
+            if (COAP_TYPE_RST == response->type)
+            {
+                ERR_INFO(("The CoAP server reset the request.\n"));
+                return CY_RSLT_TYPE_ERROR;
+            }
+
+            acknowledged = true;
+            if (0u == response->code)
+            {
+                /* Empty ACK: the response follows separately. */
+                wait_ms = COAP_RESPONSE_TIMEOUT_MS;
+                start_ticks = xTaskGetTickCount();
+                continue;
+            }
+        }
+
+        if (token_matches(response, token) && ((response->code >> 5) >= 2u) &&
+            ((COAP_TYPE_ACK != response->type) || (response->message_id == message_id)))
+        {
+            if (COAP_TYPE_CON == response->type)
+            {
+                result = send_empty(client, COAP_TYPE_ACK, response->message_id);
+            }
+            return result;
+        }
+
+        if (COAP_TYPE_CON == response->type)
+        {
+            result = send_empty(client, COAP_TYPE_RST, response->message_id);
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: send_empty
+ *******************************************************************************
+ * Summary:
+ *  Sends an empty ACK or RST. The transmit buffer, which holds the request
+ *  for retransmission, is not used.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_empty(coap_client_t *client, uint8_t type, uint16_t message_id)
+{
+    uint8_t message[COAP_HEADER_SIZE];
+
+    message[0] = (uint8_t)((COAP_VERSION << 6) | (type << 4));
+    message[1] = 0;
+    message[2] = (uint8_t)(message_id >> 8);
+    message[3] = (uint8_t)message_id;
+
+    return dtls_transport_send(&client->transport, message, sizeof(message));
+}
+
+/*******************************************************************************
+ * Function Name: token_matches
+ *******************************************************************************
+ * Summary:
+ *  Checks whether a message carries a request token.
+ *
+ *******************************************************************************/
+static bool token_matches(const coap_message_t *message, uint32_t token)
+{
+    return (COAP_TOKEN_LENGTH == message->token_length) &&
+           (message->token[0] == (uint8_t)(token >> 24)) && (message->token[1] == (uint8_t)(token >> 16)) &&
+           (message->token[2] == (uint8_t)(token >> 8)) && (message->token[3] == (uint8_t)token);
+}
+
+/*******************************************************************************
+ * Function Name: deliver
+ *******************************************************************************
+ * Summary:
+ *  Passes a response or a block of it to the callback.
+ *
+ * Return:
+ *  bool: false if the callback asked to stop.
+ *
+ *******************************************************************************/
+static bool deliver(const coap_message_t *message, coap_response_cb_t callback, void *arg)
+{
+    coap_response_t response;
+
+    if (NULL == callback)
+    {
+        return true;
+    }
+
+    response.code = message->code;
+    response.content_format = message->content_format;
+    response.payload = message->payload;
+    response.length = message->length;
+    response.offset = message->has_block2 ? (BLOCK_NUM(message->block2) * BLOCK_SIZE(BLOCK_SZX(message->block2))) : 0u;
+    response.more = message->has_block2 && BLOCK_MORE(message->block2);
+    response.notification = message->has_observe;
+    response.observe = message->observe;
+
+    return callback(&response, arg);
+}
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *  Returns a random value from the generator of the DTLS transport, which is
+ *  seeded once the transport has connected.
+ *
+ *******************************************************************************/
+static uint32_t next_random(coap_client_t *client)
+{
+    uint32_t value = 0;
+
+    (void)mbedtls_ctr_drbg_random(&client->transport.drbg, (unsigned char *)&value, sizeof(value));
+
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: content_format_of
+ *******************************************************************************
+ * Summary:
+ *  Returns the Content-Format of a media type, ignoring its parameters.
+ *
+ *******************************************************************************/
+static uint16_t content_format_of(const char *media_type)
+{
+    size_t length = strcspn(media_type, " ;");
+
+    for (uint32_t i = 0; i < (sizeof(media_types) / sizeof(media_types[0])); i++)
+    {
+        if ((strlen(media_types[i].media_type) == length) &&
+            (0 == strncmp(media_types[i].media_type, media_type, length)))
+        {
+            return media_types[i].content_format;
+        }
+    }
+
+    return COAP_FORMAT_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: http_status_of
+ *******************************************************************************
+ * Summary:
+ *  Maps a CoAP response code to the equivalent HTTP status (RFC 8075, 7).
+ *  Error codes map to the HTTP status with the same digits.
+ *
+ *******************************************************************************/
+static uint16_t http_status_of(uint8_t code)
+{
+    uint16_t code_class = code >> 5;
+    uint16_t detail = code & 0x1Fu;
+
+    if (2u != code_class)
+    {
+        return (uint16_t)((code_class * 100u) + detail);
+    }
+
+    switch (detail)
+    {
+        case 1u:
+            return 201u;    /* Created */
+        case 3u:
+            return 304u;    /* Valid */
+        case 4u:
+            return 204u;    /* Changed */
+        default:
+            return 200u;    /* Deleted, Content */
+    }
+}
+
+/*******************************************************************************
+ * Function Name: collect_https_response
+ *******************************************************************************
+ * Summary:
+ *  Copies the blocks of a response for https_send_request().
+ *
+ *******************************************************************************/
+static bool collect_https_response(const coap_response_t *response, void *arg)
+{
+    https_collect_t *collect = (https_collect_t *)arg;
+    uint32_t length = response->length;
+
+    if (response->offset >= sizeof(https_response_body))
+    {
+        collect->truncated = true;
+        return false;
+    }
+
+    if (length > (sizeof(https_response_body) - response->offset))
+    {
+        length = sizeof(https_response_body) - response->offset;
+        collect->truncated = true;
+    }
+
+    memcpy(&https_response_body[response->offset], response->payload, length);
+    collect->length = response->offset + length;
+
+    return !collect->truncated;
+}
+
+/*******************************************************************************
+ * Function Name: count_demo_response
+ *******************************************************************************
+ * Summary:
+ *  Counts the blocks and bytes of the block-wise demo response.
+ *
+ *******************************************************************************/
+static bool count_demo_response(const coap_response_t *response, void *arg)
+{
+    demo_counts_t *counts = (demo_counts_t *)arg;
+
+    counts->bytes += response->length;
+    counts->parts++;
+    counts->code = response->code;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: print_notification
+ *******************************************************************************
+ * Summary:
+ *  Prints the representation of an observed resource.
+ *
+ *******************************************************************************/
+static bool print_notification(const coap_response_t *response, void *arg)
+{
+    (void)arg;
+
+    printf("  %s %lu: %.*s\n", response->notification ? "notification" : "response",
+           (unsigned long)response->observe, (int)response->length, (const char *)response->payload);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: https_demo_response
+ *******************************************************************************
+ * Summary:
+ *  Keeps the status of the HTTPS report.
+ *
+ *******************************************************************************/
+static void https_demo_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    (void)handle;
+
+    *(uint16_t *)arg = response->status_code;
+}
+
+/* [] END OF FILE */
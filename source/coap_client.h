@@ -0,0 +1,181 @@
+/******************************************************************************
+* File Name: coap_client.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the CoAP client.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef COAP_CLIENT_H_
+#define COAP_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "dtls_transport.h"
+#include "secure_http_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* CoAP server, reached over DTLS with the credentials of secure_keys.h. A
+ * local stand-in is "coap-server -k <key> -c <cert> -C <root CA> -n -v 7"
+ * (libcoap) on the HTTPS server host.
+ */
+#define COAP_SERVER_HOST                         HTTPS_SERVER_HOST
+#define COAP_SERVER_PORT                         (5684u)
+
+/* Size of the datagrams handled. Messages larger than one block are sent
+ * and received block-wise.
+ */
+#define COAP_MAX_MESSAGE_SIZE                    (1152u)
+
+/* Block size exponent: blocks of 16 << COAP_BLOCK_SZX bytes (RFC 7959). */
+#define COAP_BLOCK_SZX                           (6u)
+
+/* Transmission parameters of confirmable messages (RFC 7252, 4.8). The
+ * first timeout is ACK_TIMEOUT times a random factor between 1 and 1.5 and
+ * doubles on each retransmission.
+ */
+#define COAP_ACK_TIMEOUT_MS                      (2000u)
+#define COAP_MAX_RETRANSMIT                      (4u)
+
+/* Wait for a separate response after an empty ACK, and for the response to
+ * a non-confirmable request.
+ */
+#define COAP_RESPONSE_TIMEOUT_MS                 (10000u)
+
+#define COAP_TOKEN_LENGTH                        (4u)
+
+/* Response collected for the requests sent through https_send_request(). */
+#define COAP_HTTPS_RESPONSE_SIZE                 (2048u)
+
+/* "CoAP over DTLS" menu option: the report sent after each simulated wake,
+ * the block-wise resource fetched, and the observed resource.
+ */
+#define COAP_DEMO_REPORT_PATH                    "/report"
+#define COAP_DEMO_REPORT_SIZE                    (100u)
+#define COAP_DEMO_BLOCK_PATH                     "/large"
+#define COAP_DEMO_OBSERVE_PATH                   "/config"
+#define COAP_DEMO_OBSERVE_MS                     (30000u)
+
+/* Request methods and response codes: class << 5 | detail. */
+#define COAP_CODE(class, detail)                 ((uint8_t)(((class) << 5) | (detail)))
+#define COAP_METHOD_GET                          COAP_CODE(0, 1)
+#define COAP_METHOD_POST                         COAP_CODE(0, 2)
+#define COAP_METHOD_PUT                          COAP_CODE(0, 3)
+#define COAP_METHOD_DELETE                       COAP_CODE(0, 4)
+#define COAP_CODE_CONTINUE                       COAP_CODE(2, 31)
+
+/* Content formats (RFC 7252, 12.3). COAP_FORMAT_NONE omits the option. */
+#define COAP_FORMAT_TEXT                         (0u)
+#define COAP_FORMAT_OCTET_STREAM                 (42u)
+#define COAP_FORMAT_JSON                         (50u)
+#define COAP_FORMAT_CBOR                         (60u)
+#define COAP_FORMAT_NONE                         (0xFFFFu)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef struct
+{
+    uint8_t method;              /* COAP_METHOD_GET, ... */
+    const char *path;
+    uint16_t content_format;
+    const uint8_t *payload;
+    uint32_t length;
+    bool confirmable;            /* A request sent block-wise is always confirmable. */
+} coap_request_t;
+
+/* Part of a response passed to the callback. payload points into the
+ * receive buffer and is valid only during the callback. A response sent
+ * block-wise arrives in several parts, the last with more cleared.
+ */
+typedef struct
+{
+    uint8_t code;
+    uint16_t content_format;
+    const uint8_t *payload;
+    uint32_t length;
+    uint32_t offset;             /* Offset of the payload in the representation. */
+    bool more;
+    bool notification;           /* Observe notification, with its sequence number. */
+    uint32_t observe;
+} coap_response_t;
+
+/* Returns false to stop receiving: the remaining blocks are not requested,
+ * or the observation is cancelled.
+ */
+typedef bool (*coap_response_cb_t)(const coap_response_t *response, void *arg);
+
+/* Counters of the client. */
+typedef struct
+{
+    uint32_t requests;
+    uint32_t retransmissions;
+    uint32_t timeouts;
+    uint32_t notifications;
+} coap_stats_t;
+
+typedef struct
+{
+    dtls_transport_t transport;
+    uint16_t message_id;
+    uint32_t token;
+    coap_stats_t stats;
+    uint8_t tx_buffer[COAP_MAX_MESSAGE_SIZE];
+    uint8_t rx_buffer[COAP_MAX_MESSAGE_SIZE];
+} coap_client_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t coap_client_init(void);
+cy_rslt_t coap_connect(coap_client_t *client);
+cy_rslt_t coap_request(coap_client_t *client, const coap_request_t *request,
+                       coap_response_cb_t callback, void *arg, uint8_t *code);
+cy_rslt_t coap_observe(coap_client_t *client, const char *path, coap_response_cb_t callback,
+                       void *arg, uint32_t duration_ms);
+void coap_close(coap_client_t *client, bool keep_session);
+cy_rslt_t coap_send_https_request(const https_request_t *request);
+void coap_demo(void);
+
+#endif /* COAP_CLIENT_H_ */
+
+
+/* [] END OF FILE */
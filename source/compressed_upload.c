@@ -0,0 +1,756 @@
+/******************************************************************************
+* File Name: compressed_upload.c
+*
+* Description: This file contains the compressed request bodies for bulk
+* uploads. The body is pulled from a source in small chunks and compressed
+* as it is read, so memory use is fixed: the compressor state and the
+* buffer of the compressed body. The level is picked per upload from a
+* CPU-versus-airtime policy using the cost measured on earlier uploads.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <timers.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "compressed_upload.h"
+#include "request_scheduler.h"
+#include "http_pipeline.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define NUM_LEVELS                       (DEFLATER_MAX_LEVEL + 1u)
+#define PERMILLE                         (1000u)
+
+/* Cycles per byte are kept in 1/16 cycle. */
+#define CYCLES_FRACTION_BITS             (4u)
+
+/* Weight of a new measurement in the running estimates, 1/4. */
+#define ESTIMATE_SHIFT                   (2u)
+
+/* Content coding named in the requests. */
+#define CONTENT_ENCODING                 ((DEFLATER_FORMAT_GZIP == COMPRESSED_UPLOAD_FORMAT) ? "gzip" : "deflate")
+
+/* Longest header lines added to an upload request. */
+#define UPLOAD_HEADERS_SIZE              (128u)
+
+/* Length of each line of the demo log. */
+#define DEMO_LINE_LENGTH                 (64u)
+
+/* Uploads made by the demo with the balanced policy. The first ones measure
+ * the levels the other policies have not tried.
+ */
+#define DEMO_BALANCED_RUNS               (4u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Running estimate of the cost of a level. */
+typedef struct
+{
+    uint32_t cycles_per_byte;        /* In 1/16 cycle. */
+    uint32_t ratio_permille;         /* Compressed size per 1000 bytes of input. */
+    uint32_t samples;
+} level_estimate_t;
+
+/* Upload run by the scheduler task. */
+typedef struct
+{
+    cy_http_client_method_t method;
+    const char *path;
+    const char *content_type;
+    compressed_upload_source_t source;
+    void *arg;
+    compressed_upload_stats_t *stats;
+    uint32_t output_cycles;          /* Cycles spent writing the compressor output. */
+    cy_rslt_t result;                /* Result of the last write. */
+} upload_job_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Protects the compressor, the connection, the buffers, and the estimates. */
+static SemaphoreHandle_t upload_mutex;
+
+/* Closes the connection COMPRESSED_UPLOAD_IDLE_CLOSE_MS after the last upload. */
+static TimerHandle_t idle_timer;
+static TickType_t last_upload_ticks;
+
+static deflater_t upload_deflater;
+static http_pipeline_t upload_pipeline;
+static uint8_t source_chunk[COMPRESSED_UPLOAD_CHUNK_SIZE];
+
+static level_estimate_t level_estimates[NUM_LEVELS];
+static uint32_t link_bytes_per_sec = COMPRESSED_UPLOAD_LINK_PRIOR_BPS;
+
+/* Set when the server has answered a compressed upload with 415. */
+static bool encoding_rejected;
+
+static const uint8_t balanced_levels[] = COMPRESSED_UPLOAD_BALANCED_LEVELS;
+
+static const char *const policy_names[] =
+{
+    "none", "min-cpu", "balanced", "min-airtime"
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t send_upload(void *arg);
+static cy_rslt_t write_body(void *arg);
+static bool write_output(const uint8_t *data, size_t length, void *arg);
+static void handle_response(const http_pipeline_event_t *event, void *arg);
+static uint32_t level_cost(uint32_t level);
+static void update_estimates(const compressed_upload_stats_t *stats);
+static uint32_t running_average(uint32_t average, uint32_t sample, uint32_t samples);
+static size_t demo_log_source(uint32_t offset, uint8_t *buffer, size_t size, void *arg);
+static void idle_timer_callback(TimerHandle_t timer);
+static cy_rslt_t close_idle_connection(void *arg);
+
+/*******************************************************************************
+ * Function Name: compressed_upload_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the mutex of the upload buffers and the timer that closes the idle
+ *  connection, and starts the cycle counter used to measure the compressor.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the uploads are ready, otherwise,
+ *  it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t compressed_upload_init(void)
+{
+    if (NULL != upload_mutex)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    upload_mutex = xSemaphoreCreateMutex();
+    if (NULL == upload_mutex)
+    {
+        ERR_INFO(("Failed to create the compressed upload mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    idle_timer = xTimerCreate("Upload Idle", pdMS_TO_TICKS(COMPRESSED_UPLOAD_IDLE_CLOSE_MS), pdFALSE, NULL,
+                              idle_timer_callback);
+    if (NULL == idle_timer)
+    {
+        ERR_INFO(("Failed to create the compressed upload idle timer.\n"));
+        vSemaphoreDelete(upload_mutex);
+        upload_mutex = NULL;
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    http_pipeline_init(&upload_pipeline, 1);
+
+    /* Sending uncompressed costs no CPU and one byte per byte. */
+    level_estimates[0].ratio_permille = PERMILLE;
+    level_estimates[0].samples = 1;
+
+    cycle_counter_enable();
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: compressed_upload_select_level
+ *******************************************************************************
+ * Summary:
+ *  Picks the compression level of the next upload. UPLOAD_POLICY_BALANCED
+ *  first tries each level of COMPRESSED_UPLOAD_BALANCED_LEVELS once. After
+ *  that it picks the level with the lowest cost per byte: the measured CPU
+ *  time plus the airtime of the measured output size at the measured upload
+ *  throughput, weighted by COMPRESSED_UPLOAD_AIRTIME_WEIGHT.
+ *
+ * Parameters:
+ *  policy - Trade-off between CPU time and airtime.
+ *
+ * Return:
+ *  uint32_t: Compression level, 0 to send uncompressed.
+ *
+ *******************************************************************************/
+uint32_t compressed_upload_select_level(upload_policy_t policy)
+{
+    uint32_t best_level = 0;
+    uint32_t best_cost = UINT32_MAX;
+    uint32_t cost;
+    uint32_t level;
+
+    if (encoding_rejected)
+    {
+        return 0;
+    }
+
+    switch (policy)
+    {
+        case UPLOAD_POLICY_MIN_CPU:
+            return DEFLATER_MIN_LEVEL;
+
+        case UPLOAD_POLICY_MIN_AIRTIME:
+            return DEFLATER_MAX_LEVEL;
+
+        case UPLOAD_POLICY_BALANCED:
+            break;
+
+        case UPLOAD_POLICY_NONE:
+        default:
+            return 0;
+    }
+
+    for (uint32_t i = 0; i < sizeof(balanced_levels); i++)
+    {
+        level = balanced_levels[i];
+
+        if (0u == level_estimates[level].samples)
+        {
+            return level;
+        }
+
+        cost = level_cost(level);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_level = level;
+        }
+    }
+
+    return best_level;
+}
+
+/*******************************************************************************
+ * Function Name: compressed_upload_send
+ *******************************************************************************
+ * Summary:
+ *  Sends a request whose body is read from a source and compressed with the
+ *  level picked by the policy, in a lane of the request scheduler.
+ *  The body is compressed piece by piece while it is sent with chunked
+ *  Transfer-Encoding, so its size is not limited by a buffer. The
+ *  compressed body is sent with a Content-Encoding header. If the server
+ *  answers with 415 Unsupported Media Type, the body is read again and sent
+ *  uncompressed, and the later uploads are sent uncompressed too. The
+ *  connection is kept open for COMPRESSED_UPLOAD_IDLE_CLOSE_MS after the
+ *  upload, so that a following upload reuses it, and then closed, so that
+ *  it does not keep the radio awake.
+ *
+ * Parameters:
+ *  method - HTTP method, POST or PUT.
+ *  path - Resource path.
+ *  content_type - Media type of the uncompressed body.
+ *  source - Reads the body.
+ *  arg - Argument passed to the source.
+ *  policy - Trade-off between CPU time and airtime.
+ *  lane - Lane of the upload, REQUEST_LANE_BULK unless it must not wait for
+ *  bulk transfers.
+ *  stats - Filled with the result of the upload. Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a response is received, otherwise,
+ *  the error of the TLS stream, or CY_RSLT_TYPE_ERROR for another method or
+ *  a malformed response.
+ *
+ *******************************************************************************/
+cy_rslt_t compressed_upload_send(cy_http_client_method_t method, const char *path, const char *content_type,
+                                 compressed_upload_source_t source, void *arg, upload_policy_t policy,
+                                 request_lane_t lane, compressed_upload_stats_t *stats)
+{
+    cy_rslt_t result;
+    compressed_upload_stats_t upload;
+    upload_job_t job;
+    TickType_t start_ticks;
+
+    if ((CY_HTTP_CLIENT_METHOD_POST != method) && (CY_HTTP_CLIENT_METHOD_PUT != method))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    xSemaphoreTake(upload_mutex, portMAX_DELAY);
+
+    start_ticks = xTaskGetTickCount();
+    memset(&upload, 0, sizeof(upload));
+    upload.level = compressed_upload_select_level(policy);
+
+    memset(&job, 0, sizeof(job));
+    job.method = method;
+    job.path = path;
+    job.content_type = content_type;
+    job.source = source;
+    job.arg = arg;
+    job.stats = &upload;
+
+    /* The totals of the pipeline, so that the bytes of a resent body count. */
+    upload.tx_bytes = upload_pipeline.tx_bytes;
+    upload.rx_bytes = upload_pipeline.rx_bytes;
+    upload.connections = upload_pipeline.connections;
+
+    while (true)
+    {
+        result = request_scheduler_run(path, lane, send_upload, &job);
+
+        if ((CY_RSLT_SUCCESS == result) && (HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE == upload.status_code) &&
+            (upload.level > 0u))
+        {
+            APP_INFO(("The server does not accept %s bodies, sending uncompressed\n", CONTENT_ENCODING));
+            encoding_rejected = true;
+            upload.level = 0;
+            continue;
+        }
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            update_estimates(&upload);
+        }
+        break;
+    }
+
+    upload.tx_bytes = upload_pipeline.tx_bytes - upload.tx_bytes;
+    upload.rx_bytes = upload_pipeline.rx_bytes - upload.rx_bytes;
+    upload.connections = upload_pipeline.connections - upload.connections;
+
+    last_upload_ticks = xTaskGetTickCount();
+    (void)xTimerReset(idle_timer, 0);
+
+    upload.elapsed_ms = (uint32_t)(last_upload_ticks - start_ticks) * portTICK_PERIOD_MS;
+
+    xSemaphoreGive(upload_mutex);
+
+    if (NULL != stats)
+    {
+        *stats = upload;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: compressed_upload_demo
+ *******************************************************************************
+ * Summary:
+ *  Uploads a generated log with each policy and prints the compression
+ *  ratio, the compressor cycles per byte, and the upload times. The
+ *  balanced policy runs DEMO_BALANCED_RUNS times, so its last runs use the
+ *  level it has settled on.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void compressed_upload_demo(void)
+{
+    static const upload_policy_t runs[] =
+    {
+        UPLOAD_POLICY_NONE, UPLOAD_POLICY_MIN_CPU, UPLOAD_POLICY_MIN_AIRTIME,
+    };
+    compressed_upload_stats_t stats;
+    upload_policy_t policy;
+    cy_rslt_t result;
+    uint32_t num_runs = (sizeof(runs) / sizeof(runs[0])) + DEMO_BALANCED_RUNS;
+
+    APP_INFO(("Uploading a %u byte log to %s\n",
+              (unsigned int)(COMPRESSED_UPLOAD_DEMO_LINES * DEMO_LINE_LENGTH), COMPRESSED_UPLOAD_DEMO_PATH));
+
+    printf("\n  %-11s %5s %6s %6s %6s %9s %7s %8s\n",
+           "policy", "level", "raw B", "wire B", "ratio", "cycles/B", "send ms", "total ms");
+
+    for (uint32_t run = 0; run < num_runs; run++)
+    {
+        policy = (run < (sizeof(runs) / sizeof(runs[0]))) ? runs[run] : UPLOAD_POLICY_BALANCED;
+
+        result = compressed_upload_send(CY_HTTP_CLIENT_METHOD_POST, COMPRESSED_UPLOAD_DEMO_PATH,
+                                        COMPRESSED_UPLOAD_DEMO_CONTENT_TYPE, demo_log_source, NULL,
+                                        policy, REQUEST_LANE_BULK, &stats);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("The %s upload failed.\n", policy_names[policy]));
+            return;
+        }
+
+        printf("  %-11s %5lu %6lu %6lu %5lu%% %9lu %7lu %8lu\n", policy_names[policy],
+               (unsigned long)stats.level, (unsigned long)stats.raw_bytes, (unsigned long)stats.wire_bytes,
+               (unsigned long)((stats.wire_bytes * 100u) / ((0u != stats.raw_bytes) ? stats.raw_bytes : 1u)),
+               (unsigned long)(stats.compress_cycles / ((0u != stats.raw_bytes) ? stats.raw_bytes : 1u)),
+               (unsigned long)stats.send_ms, (unsigned long)stats.elapsed_ms);
+    }
+
+    printf("  Upload throughput estimate: %lu bytes/s, balanced level: %lu\n",
+           (unsigned long)link_bytes_per_sec, (unsigned long)compressed_upload_select_level(UPLOAD_POLICY_BALANCED));
+}
+
+/*******************************************************************************
+ * Function Name: idle_timer_callback
+ *******************************************************************************
+ * Summary:
+ *  Leaves the close of the idle connection to the scheduler task, since the
+ *  timer task has no stack for TLS. If the lane is full, tries again after
+ *  another window.
+ *
+ *******************************************************************************/
+static void idle_timer_callback(TimerHandle_t timer)
+{
+    if (CY_RSLT_SUCCESS != request_scheduler_post(NULL, REQUEST_LANE_BULK, close_idle_connection, NULL))
+    {
+        (void)xTimerReset(timer, 0);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: close_idle_connection
+ *******************************************************************************
+ * Summary:
+ *  Closes the connection if no upload was made in the last
+ *  COMPRESSED_UPLOAD_IDLE_CLOSE_MS. Runs in the scheduler task, so it does
+ *  not wait for the mutex: an upload holding it waits for this task, and
+ *  restarts the timer when it is done.
+ *
+ *******************************************************************************/
+static cy_rslt_t close_idle_connection(void *arg)
+{
+    (void)arg;
+
+    if (pdTRUE == xSemaphoreTake(upload_mutex, 0))
+    {
+        if ((uint32_t)(xTaskGetTickCount() - last_upload_ticks) * portTICK_PERIOD_MS >=
+            COMPRESSED_UPLOAD_IDLE_CLOSE_MS)
+        {
+            http_pipeline_close(&upload_pipeline);
+        }
+        xSemaphoreGive(upload_mutex);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: send_upload
+ *******************************************************************************
+ * Summary:
+ *  Sends an upload from the scheduler task. The time spent compressing is
+ *  taken out of the send time, since it is interleaved with the writes.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_upload(void *arg)
+{
+    upload_job_t *job = (upload_job_t *)arg;
+    compressed_upload_stats_t *stats = job->stats;
+    http_pipeline_request_t request = {0};
+    char headers[UPLOAD_HEADERS_SIZE];
+    TickType_t send_ticks = xTaskGetTickCount();
+    uint32_t cycles_per_ms = SystemCoreClock / 1000u;
+    uint32_t compress_ms;
+    uint32_t elapsed_ms;
+    cy_rslt_t result;
+    int length;
+
+    length = snprintf(headers, sizeof(headers), "Content-Type: %s\r\n%s%s%s", job->content_type,
+                      (stats->level > 0u) ? "Content-Encoding: " : "",
+                      (stats->level > 0u) ? CONTENT_ENCODING : "",
+                      (stats->level > 0u) ? "\r\n" : "");
+    if ((length < 0) || ((uint32_t)length >= sizeof(headers)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    request.method = (CY_HTTP_CLIENT_METHOD_PUT == job->method) ? "PUT" : "POST";
+    request.path = job->path;
+    request.headers = headers;
+    request.body = write_body;
+    request.body_arg = job;
+
+    stats->status_code = 0;
+    result = http_pipeline_request(&upload_pipeline, &request, handle_response, job);
+
+    elapsed_ms = (uint32_t)(xTaskGetTickCount() - send_ticks) * portTICK_PERIOD_MS;
+    compress_ms = stats->compress_cycles / ((0u != cycles_per_ms) ? cycles_per_ms : 1u);
+    stats->send_ms = (elapsed_ms > compress_ms) ? (elapsed_ms - compress_ms) : 0u;
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: write_body
+ *******************************************************************************
+ * Summary:
+ *  Reads the body from the source and writes it to the request, compressed
+ *  or as is for level 0. Only COMPRESSED_UPLOAD_CHUNK_SIZE bytes of input
+ *  and one chunk of output are held at a time.
+ *
+ *******************************************************************************/
+static cy_rslt_t write_body(void *arg)
+{
+    upload_job_t *job = (upload_job_t *)arg;
+    compressed_upload_stats_t *stats = job->stats;
+    uint32_t level = stats->level;
+    uint32_t offset = 0;
+    uint32_t start;
+    size_t length;
+
+    stats->raw_bytes = 0;
+    stats->wire_bytes = 0;
+    stats->compress_cycles = 0;
+    job->output_cycles = 0;
+    job->result = CY_RSLT_SUCCESS;
+
+    if (level > 0u)
+    {
+        start = cycle_counter_get();
+        (void)deflater_init(&upload_deflater, COMPRESSED_UPLOAD_FORMAT, level, write_output, job);
+        stats->compress_cycles += cycle_counter_get() - start;
+    }
+
+    while (CY_RSLT_SUCCESS == job->result)
+    {
+        length = job->source(offset, source_chunk, sizeof(source_chunk), job->arg);
+        if (0u == length)
+        {
+            break;
+        }
+        offset += (uint32_t)length;
+
+        if (level > 0u)
+        {
+            start = cycle_counter_get();
+            (void)deflater_write(&upload_deflater, source_chunk, length);
+            stats->compress_cycles += cycle_counter_get() - start;
+        }
+        else
+        {
+            (void)write_output(source_chunk, length, job);
+        }
+    }
+
+    if ((level > 0u) && (CY_RSLT_SUCCESS == job->result))
+    {
+        start = cycle_counter_get();
+        (void)deflater_finish(&upload_deflater);
+        stats->compress_cycles += cycle_counter_get() - start;
+    }
+
+    /* The compressor's time includes the writes of its output. */
+    if (level > 0u)
+    {
+        stats->compress_cycles = (stats->compress_cycles > job->output_cycles) ?
+                                 (stats->compress_cycles - job->output_cycles) : 0u;
+    }
+
+    stats->raw_bytes = offset;
+
+    return job->result;
+}
+
+/*******************************************************************************
+ * Function Name: write_output
+ *******************************************************************************
+ * Summary:
+ *  Writes body bytes to the request as a chunk.
+ *
+ * Return:
+ *  bool: false if the write failed.
+ *
+ *******************************************************************************/
+static bool write_output(const uint8_t *data, size_t length, void *arg)
+{
+    upload_job_t *job = (upload_job_t *)arg;
+    uint32_t start = cycle_counter_get();
+
+    job->result = http_pipeline_write_chunk(&upload_pipeline, data, (uint32_t)length);
+    job->output_cycles += cycle_counter_get() - start;
+    job->stats->wire_bytes += (uint32_t)length;
+
+    return (CY_RSLT_SUCCESS == job->result);
+}
+
+/*******************************************************************************
+ * Function Name: handle_response
+ *******************************************************************************
+ * Summary:
+ *  Records the status code of an upload and prints the response.
+ *
+ *******************************************************************************/
+static void handle_response(const http_pipeline_event_t *event, void *arg)
+{
+    upload_job_t *job = (upload_job_t *)arg;
+
+    job->stats->status_code = event->status_code;
+
+    if (0u == event->offset)
+    {
+        printf("\n Response Status : %u\n", event->status_code);
+        printf(" Response Body   :\n ");
+    }
+    if (0u != event->length)
+    {
+        printf("%.*s", (int)event->length, event->data);
+    }
+    if (event->complete)
+    {
+        printf("\n");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: level_cost
+ *******************************************************************************
+ * Summary:
+ *  Estimates the cost of sending one kilobyte of input at a level, in
+ *  microseconds of CPU time plus weighted microseconds of airtime.
+ *
+ *******************************************************************************/
+static uint32_t level_cost(uint32_t level)
+{
+    const level_estimate_t *estimate = &level_estimates[level];
+    uint32_t cpu_mhz = SystemCoreClock / 1000000u;
+    uint64_t cpu_us;
+    uint64_t air_us;
+
+    cpu_us = ((uint64_t)estimate->cycles_per_byte * 1024u) / ((uint64_t)cpu_mhz << CYCLES_FRACTION_BITS);
+    air_us = ((uint64_t)estimate->ratio_permille * 1024u * 1000u) / link_bytes_per_sec;
+
+    return (uint32_t)(cpu_us + (air_us * COMPRESSED_UPLOAD_AIRTIME_WEIGHT));
+}
+
+/*******************************************************************************
+ * Function Name: update_estimates
+ *******************************************************************************
+ * Summary:
+ *  Adds the measurements of a successful upload to the running estimates of
+ *  its level and of the upload throughput.
+ *
+ *******************************************************************************/
+static void update_estimates(const compressed_upload_stats_t *stats)
+{
+    level_estimate_t *estimate = &level_estimates[stats->level];
+    uint32_t cycles_per_byte;
+    uint32_t ratio;
+
+    if ((stats->wire_bytes >= COMPRESSED_UPLOAD_MIN_LINK_SAMPLE) && (stats->send_ms > 0u))
+    {
+        link_bytes_per_sec = running_average(link_bytes_per_sec,
+                                             (stats->wire_bytes * 1000u) / stats->send_ms, 1u);
+    }
+
+    if ((0u == stats->level) || (0u == stats->raw_bytes))
+    {
+        return;
+    }
+
+    cycles_per_byte = (uint32_t)(((uint64_t)stats->compress_cycles << CYCLES_FRACTION_BITS) / stats->raw_bytes);
+    ratio = (uint32_t)(((uint64_t)stats->wire_bytes * PERMILLE) / stats->raw_bytes);
+
+    estimate->cycles_per_byte = running_average(estimate->cycles_per_byte, cycles_per_byte, estimate->samples);
+    estimate->ratio_permille = running_average(estimate->ratio_permille, ratio, estimate->samples);
+    estimate->samples++;
+}
+
+/*******************************************************************************
+ * Function Name: running_average
+ *******************************************************************************
+ * Summary:
+ *  Returns the sample if it is the first one, otherwise moves the average a
+ *  quarter of the way towards the sample.
+ *
+ *******************************************************************************/
+static uint32_t running_average(uint32_t average, uint32_t sample, uint32_t samples)
+{
+    if (0u == samples)
+    {
+        return sample;
+    }
+
+    return average - (average >> ESTIMATE_SHIFT) + (sample >> ESTIMATE_SHIFT);
+}
+
+/*******************************************************************************
+ * Function Name: demo_log_source
+ *******************************************************************************
+ * Summary:
+ *  Generates the demo log: COMPRESSED_UPLOAD_DEMO_LINES lines of
+ *  DEMO_LINE_LENGTH bytes, so any offset can be generated again.
+ *
+ *******************************************************************************/
+static size_t demo_log_source(uint32_t offset, uint8_t *buffer, size_t size, void *arg)
+{
+    static const char *const modules[] = { "wifi", "sensor", "http", "power" };
+    char line[DEMO_LINE_LENGTH + 1];
+    uint32_t index;
+    uint32_t column;
+    uint32_t noise;
+    size_t copied = 0;
+    int length;
+
+    (void)arg;
+
+    while ((copied < size) && (offset < (COMPRESSED_UPLOAD_DEMO_LINES * DEMO_LINE_LENGTH)))
+    {
+        index = offset / DEMO_LINE_LENGTH;
+        column = offset % DEMO_LINE_LENGTH;
+        noise = (index * 2654435761u) >> 24;
+
+        length = snprintf(line, sizeof(line), "%08lu I %-6s rssi=-%02lu dBm retries=%lu heap=%lu",
+                          (unsigned long)(index * 250u), modules[index % 4u], (unsigned long)(40u + (noise % 30u)),
+                          (unsigned long)(noise % 4u), (unsigned long)(81920u - ((noise % 16u) * 64u)));
+        memset(&line[length], ' ', DEMO_LINE_LENGTH - 1u - (uint32_t)length);
+        line[DEMO_LINE_LENGTH - 1u] = '\n';
+
+        while ((copied < size) && (column < DEMO_LINE_LENGTH))
+        {
+            buffer[copied++] = (uint8_t)line[column++];
+            offset++;
+        }
+    }
+
+    return copied;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: compressed_upload.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the compressed request bodies for bulk uploads.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef COMPRESSED_UPLOAD_H_
+#define COMPRESSED_UPLOAD_H_
+
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+#include "deflater.h"
+#include "request_scheduler.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Content coding of compressed bodies: DEFLATER_FORMAT_GZIP for "gzip" or
+ * DEFLATER_FORMAT_ZLIB for "deflate".
+ */
+#define COMPRESSED_UPLOAD_FORMAT                 DEFLATER_FORMAT_GZIP
+
+/* Bytes read from the source and passed to the compressor at a time. */
+#define COMPRESSED_UPLOAD_CHUNK_SIZE             (256)
+
+/* Levels tried by UPLOAD_POLICY_BALANCED. Level 0 sends the body
+ * uncompressed.
+ */
+#define COMPRESSED_UPLOAD_BALANCED_LEVELS        { 0, 1, 4, 6, 9 }
+
+/* Cost of one microsecond of airtime relative to one microsecond of CPU
+ * time, used by UPLOAD_POLICY_BALANCED. The radio draws several times the
+ * current of the CPU while it transmits and the channel is shared, so
+ * airtime is weighted higher.
+ */
+#define COMPRESSED_UPLOAD_AIRTIME_WEIGHT         (4)
+
+/* Upload throughput assumed until an upload of at least
+ * COMPRESSED_UPLOAD_MIN_LINK_SAMPLE bytes has been measured. Smaller uploads
+ * are dominated by latency and do not update the estimate.
+ */
+#define COMPRESSED_UPLOAD_LINK_PRIOR_BPS         (125000u)
+#define COMPRESSED_UPLOAD_MIN_LINK_SAMPLE        (1024u)
+
+/* Time the connection of the uploads is kept open after an upload, so that
+ * the next upload within the window skips the TLS handshake. When it
+ * expires the connection is closed, which releases its Wi-Fi power
+ * reference.
+ */
+#define COMPRESSED_UPLOAD_IDLE_CLOSE_MS          (10000u)
+
+/* Log uploaded by the "compressed upload" menu option. */
+#define COMPRESSED_UPLOAD_DEMO_PATH              "/logs"
+#define COMPRESSED_UPLOAD_DEMO_CONTENT_TYPE      "text/plain"
+#define COMPRESSED_UPLOAD_DEMO_LINES             (120)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+/* Trade-off between CPU time and airtime used to pick the level. */
+typedef enum
+{
+    UPLOAD_POLICY_NONE,              /* Send uncompressed. */
+    UPLOAD_POLICY_MIN_CPU,           /* Fastest level. */
+    UPLOAD_POLICY_BALANCED,          /* Level with the lowest measured cost. */
+    UPLOAD_POLICY_MIN_AIRTIME,       /* Smallest output. */
+} upload_policy_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Copies up to size bytes of the body, starting at offset, to buffer.
+ * Returns the number of bytes copied, 0 at the end of the body. A body may
+ * be read twice if the server rejects the compressed upload.
+ */
+typedef size_t (*compressed_upload_source_t)(uint32_t offset, uint8_t *buffer, size_t size, void *arg);
+
+/* Result of one upload. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t level;              /* Compression level, 0 if sent uncompressed. */
+    uint32_t raw_bytes;          /* Body bytes read from the source. */
+    uint32_t wire_bytes;         /* Body bytes sent, without the chunk framing. */
+    uint32_t compress_cycles;    /* CPU cycles spent in the compressor. */
+    uint32_t send_ms;            /* Time spent in the HTTP request, compression excluded. */
+    uint32_t elapsed_ms;         /* Time of the whole upload. */
+    uint32_t status_code;        /* HTTP status of the response. */
+    uint32_t tx_bytes;           /* Bytes of the requests, headers and framing included. */
+    uint32_t rx_bytes;           /* Bytes of the responses. */
+    uint32_t connections;        /* Connections opened, 0 if a warm one was reused. */
+} compressed_upload_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t compressed_upload_init(void);
+uint32_t compressed_upload_select_level(upload_policy_t policy);
+cy_rslt_t compressed_upload_send(cy_http_client_method_t method, const char *path, const char *content_type,
+                                 compressed_upload_source_t source, void *arg, upload_policy_t policy,
+                                 request_lane_t lane, compressed_upload_stats_t *stats);
+void compressed_upload_demo(void);
+
+#endif /* COMPRESSED_UPLOAD_H_ */
+
+
+/* [] END OF FILE */
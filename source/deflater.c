@@ -0,0 +1,858 @@
+/******************************************************************************
+* File Name: deflater.c
+*
+* Description: This file contains the streaming deflate compressor (RFC 1951)
+* with the zlib (RFC 1950) and gzip (RFC 1952) wrappers. The compressor uses
+* LZ77 with hash chains over a fixed window and the fixed Huffman code, so
+* its memory use does not depend on the amount of data. Levels 1 to 3 use
+* greedy matching and levels 4 to 9 use lazy matching with longer chains, as
+* in zlib.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <string.h>
+
+#include "deflater.h"
+#include "inflater.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define MIN_MATCH                        (3u)
+#define MAX_MATCH                        (258u)
+
+/* Bytes kept ahead of the current position so a match of any length can be
+ * compared without checking the end of the data.
+ */
+#define MIN_LOOKAHEAD                    (MAX_MATCH + MIN_MATCH + 1u)
+#define MAX_DIST                         (DEFLATER_WINDOW_SIZE - MIN_LOOKAHEAD)
+
+/* Matches of 3 bytes further back than this cost more than the literals. */
+#define TOO_FAR                          (4096u)
+
+#define NIL                              (0u)
+#define WINDOW_MASK                      (DEFLATER_WINDOW_SIZE - 1u)
+
+#define END_OF_BLOCK                     (256u)
+#define BLOCK_FIXED                      (1u)
+
+#define ZLIB_METHOD_DEFLATE              (8u)
+#define ADLER_MOD                        (65521u)
+#define ADLER_BLOCK                      (5552u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef struct
+{
+    uint16_t good_length;            /* Shorten the search above this match length. */
+    uint16_t max_lazy;               /* Greedy levels: unused. Lazy levels: skip the lazy search above this length. */
+    uint16_t nice_length;            /* Stop the search at this match length. */
+    uint16_t max_chain;              /* Maximum chain entries searched. */
+} level_config_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Search parameters of levels 1 to 9, from zlib. */
+static const level_config_t level_config[DEFLATER_MAX_LEVEL] =
+{
+    {  4,   4,   8,    4 },
+    {  4,   5,  16,    8 },
+    {  4,   6,  32,   32 },
+    {  4,   4,  16,   16 },
+    {  8,  16,  32,   32 },
+    {  8,  16, 128,  128 },
+    {  8,  32, 128,  256 },
+    { 32, 128, 258, 1024 },
+    { 32, 258, 258, 4096 },
+};
+
+#define LAST_GREEDY_LEVEL                (3u)
+
+/* Bit-reversed values of 0..15. */
+static const uint8_t reverse_nibble[16] =
+{
+    0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void compress_greedy(deflater_t *def, bool flush);
+static void compress_lazy(deflater_t *def, bool flush);
+static uint32_t fill_window(deflater_t *def, const uint8_t *data, size_t length);
+static void slide_window(deflater_t *def);
+static uint32_t insert_string(deflater_t *def, uint32_t position);
+static uint32_t longest_match(deflater_t *def, uint32_t cur_match);
+static void emit_literal(deflater_t *def, uint32_t value);
+static void emit_match(deflater_t *def, uint32_t distance, uint32_t length);
+static void put_code(deflater_t *def, uint32_t code, uint32_t length);
+static void put_bits(deflater_t *def, uint32_t value, uint32_t count);
+static void put_byte(deflater_t *def, uint8_t value);
+static void flush_bits(deflater_t *def);
+static void flush_output(deflater_t *def);
+static uint32_t bit_length(uint32_t value);
+static uint32_t adler32(uint32_t adler, const uint8_t *data, size_t length);
+
+/*******************************************************************************
+ * Function Name: deflater_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up a compressor for one stream and writes the stream header.
+ *
+ * Parameters:
+ *  def - Compressor to set up.
+ *  format - Wrapper of the compressed data.
+ *  level - Compression level, DEFLATER_MIN_LEVEL to DEFLATER_MAX_LEVEL.
+ *  output - Called with the compressed data.
+ *  arg - Argument passed to the output callback.
+ *
+ * Return:
+ *  deflater_status_t: DEFLATER_OK, DEFLATER_STOPPED if the output callback
+ *  refused the header, or DEFLATER_ERR_PARAM for an invalid level.
+ *
+ *******************************************************************************/
+deflater_status_t deflater_init(deflater_t *def, deflater_format_t format, uint32_t level,
+                                deflater_output_t output, void *arg)
+{
+    const level_config_t *config;
+    uint32_t cmf;
+    uint32_t flg;
+
+    memset(def->head, 0, sizeof(def->head));
+    memset(def->prev, 0, sizeof(def->prev));
+    def->format = format;
+    def->finished = false;
+    def->strstart = 0;
+    def->lookahead = 0;
+    def->match_start = 0;
+    def->match_length = MIN_MATCH - 1u;
+    def->prev_length = MIN_MATCH - 1u;
+    def->prev_match = 0;
+    def->match_available = false;
+    def->bit_buf = 0;
+    def->bit_count = 0;
+    def->out_len = 0;
+    def->output = output;
+    def->output_arg = arg;
+    def->check = (DEFLATER_FORMAT_GZIP == format) ? 0u : 1u;
+    def->total_in = 0;
+    def->total_out = 0;
+
+    if ((level < DEFLATER_MIN_LEVEL) || (level > DEFLATER_MAX_LEVEL))
+    {
+        def->status = DEFLATER_ERR_PARAM;
+        return def->status;
+    }
+
+    def->status = DEFLATER_OK;
+    config = &level_config[level - 1u];
+    def->good_length = config->good_length;
+    def->max_lazy = (level > LAST_GREEDY_LEVEL) ? config->max_lazy : 0u;
+    def->nice_length = config->nice_length;
+    def->max_chain = config->max_chain;
+
+    if (DEFLATER_FORMAT_GZIP == format)
+    {
+        /* ID1 ID2 CM FLG MTIME(4) XFL OS: no name, no time, unknown OS. */
+        static const uint8_t gzip_header[10] = { 0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF };
+
+        for (uint32_t i = 0; i < sizeof(gzip_header); i++)
+        {
+            put_byte(def, gzip_header[i]);
+        }
+    }
+    else
+    {
+        cmf = ((DEFLATER_WINDOW_BITS - 8u) << 4) | ZLIB_METHOD_DEFLATE;
+        flg = (31u - ((cmf << 8) % 31u)) % 31u;
+        put_byte(def, (uint8_t)cmf);
+        put_byte(def, (uint8_t)flg);
+    }
+
+    /* The data goes in one fixed-code block, closed by deflater_finish(). */
+    put_bits(def, BLOCK_FIXED << 1, 3);
+
+    return def->status;
+}
+
+/*******************************************************************************
+ * Function Name: deflater_write
+ *******************************************************************************
+ * Summary:
+ *  Compresses the next chunk of data. Up to MIN_LOOKAHEAD bytes are held
+ *  back until more data arrives or the stream is finished.
+ *
+ * Parameters:
+ *  def - Compressor.
+ *  data - Next bytes of the uncompressed data.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  deflater_status_t: DEFLATER_OK, or the reason the compressor stopped.
+ *
+ *******************************************************************************/
+deflater_status_t deflater_write(deflater_t *def, const uint8_t *data, size_t length)
+{
+    uint32_t copied;
+
+    if (def->finished && (DEFLATER_OK == def->status))
+    {
+        def->status = DEFLATER_ERR_PARAM;
+    }
+
+    if (DEFLATER_FORMAT_GZIP == def->format)
+    {
+        def->check = inflater_crc32(def->check, data, length);
+    }
+    else
+    {
+        def->check = adler32(def->check, data, length);
+    }
+    def->total_in += (uint32_t)length;
+
+    while ((DEFLATER_OK == def->status) && (length > 0))
+    {
+        copied = fill_window(def, data, length);
+        data += copied;
+        length -= copied;
+
+        if (def->lookahead >= MIN_LOOKAHEAD)
+        {
+            if (0u == def->max_lazy)
+            {
+                compress_greedy(def, false);
+            }
+            else
+            {
+                compress_lazy(def, false);
+            }
+        }
+    }
+
+    return def->status;
+}
+
+/*******************************************************************************
+ * Function Name: deflater_finish
+ *******************************************************************************
+ * Summary:
+ *  Compresses the held-back data, ends the stream, and writes the trailer.
+ *  All the compressed data has been passed to the output callback when the
+ *  function returns.
+ *
+ * Parameters:
+ *  def - Compressor.
+ *
+ * Return:
+ *  deflater_status_t: DEFLATER_OK, or the reason the compressor stopped.
+ *
+ *******************************************************************************/
+deflater_status_t deflater_finish(deflater_t *def)
+{
+    if ((DEFLATER_OK != def->status) || def->finished)
+    {
+        return def->status;
+    }
+
+    if (0u == def->max_lazy)
+    {
+        compress_greedy(def, true);
+    }
+    else
+    {
+        compress_lazy(def, true);
+    }
+
+    /* End the data block, then add an empty final block. */
+    put_code(def, 0, 7);
+    put_bits(def, 1u | (BLOCK_FIXED << 1), 3);
+    put_code(def, 0, 7);
+    flush_bits(def);
+
+    if (DEFLATER_FORMAT_GZIP == def->format)
+    {
+        for (uint32_t i = 0; i < 32u; i += 8u)
+        {
+            put_byte(def, (uint8_t)(def->check >> i));
+        }
+        for (uint32_t i = 0; i < 32u; i += 8u)
+        {
+            put_byte(def, (uint8_t)(def->total_in >> i));
+        }
+    }
+    else
+    {
+        for (uint32_t i = 32u; i > 0; i -= 8u)
+        {
+            put_byte(def, (uint8_t)(def->check >> (i - 8u)));
+        }
+    }
+
+    flush_output(def);
+    def->finished = true;
+
+    return def->status;
+}
+
+/*******************************************************************************
+ * Function Name: compress_greedy
+ *******************************************************************************
+ * Summary:
+ *  Emits the longest match at each position, or a literal if there is none.
+ *  Used by the fast levels.
+ *
+ * Parameters:
+ *  def - Compressor.
+ *  flush - true to compress all the data in the window, false to stop when
+ *  fewer than MIN_LOOKAHEAD bytes are left.
+ *
+ *******************************************************************************/
+static void compress_greedy(deflater_t *def, bool flush)
+{
+    uint32_t hash_head;
+    uint32_t length;
+
+    while (DEFLATER_OK == def->status)
+    {
+        if ((def->lookahead < MIN_LOOKAHEAD) && (!flush || (0u == def->lookahead)))
+        {
+            break;
+        }
+
+        hash_head = NIL;
+        if (def->lookahead >= MIN_MATCH)
+        {
+            hash_head = insert_string(def, def->strstart);
+        }
+
+        def->match_length = MIN_MATCH - 1u;
+        if ((NIL != hash_head) && ((def->strstart - hash_head) <= MAX_DIST))
+        {
+            def->prev_length = MIN_MATCH - 1u;
+            def->match_length = longest_match(def, hash_head);
+        }
+
+        if (def->match_length >= MIN_MATCH)
+        {
+            length = def->match_length;
+            emit_match(def, def->strstart - def->match_start, length);
+            def->lookahead -= length;
+
+            /* Index the rest of the match so later data can refer to it. */
+            while (--length > 0)
+            {
+                def->strstart++;
+                if ((def->lookahead + length) > MIN_MATCH)
+                {
+                    (void)insert_string(def, def->strstart);
+                }
+            }
+            def->strstart++;
+        }
+        else
+        {
+            emit_literal(def, def->window[def->strstart]);
+            def->lookahead--;
+            def->strstart++;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: compress_lazy
+ *******************************************************************************
+ * Summary:
+ *  Defers each match by one position and takes the match at the next
+ *  position instead if it is longer. Used by the default and best levels.
+ *
+ * Parameters:
+ *  def - Compressor.
+ *  flush - true to compress all the data in the window, false to stop when
+ *  fewer than MIN_LOOKAHEAD bytes are left.
+ *
+ *******************************************************************************/
+static void compress_lazy(deflater_t *def, bool flush)
+{
+    uint32_t hash_head;
+    uint32_t max_insert;
+
+    while (DEFLATER_OK == def->status)
+    {
+        if ((def->lookahead < MIN_LOOKAHEAD) && (!flush || (0u == def->lookahead)))
+        {
+            break;
+        }
+
+        hash_head = NIL;
+        if (def->lookahead >= MIN_MATCH)
+        {
+            hash_head = insert_string(def, def->strstart);
+        }
+
+        def->prev_length = def->match_length;
+        def->prev_match = def->match_start;
+        def->match_length = MIN_MATCH - 1u;
+
+        if ((NIL != hash_head) && (def->prev_length < def->max_lazy) &&
+            ((def->strstart - hash_head) <= MAX_DIST))
+        {
+            def->match_length = longest_match(def, hash_head);
+
+            if ((MIN_MATCH == def->match_length) && ((def->strstart - def->match_start) > TOO_FAR))
+            {
+                def->match_length = MIN_MATCH - 1u;
+            }
+        }
+
+        if ((def->prev_length >= MIN_MATCH) && (def->match_length <= def->prev_length))
+        {
+            /* The match at the previous position is at least as long. */
+            max_insert = def->strstart + def->lookahead - MIN_MATCH;
+            emit_match(def, def->strstart - 1u - def->prev_match, def->prev_length);
+
+            def->lookahead -= def->prev_length - 1u;
+            def->prev_length -= 2u;
+            do
+            {
+                if (++def->strstart <= max_insert)
+                {
+                    (void)insert_string(def, def->strstart);
+                }
+            } while (--def->prev_length != 0u);
+
+            def->match_available = false;
+            def->match_length = MIN_MATCH - 1u;
+            def->strstart++;
+        }
+        else if (def->match_available)
+        {
+            emit_literal(def, def->window[def->strstart - 1u]);
+            def->strstart++;
+            def->lookahead--;
+        }
+        else
+        {
+            def->match_available = true;
+            def->strstart++;
+            def->lookahead--;
+        }
+    }
+
+    if (flush && def->match_available)
+    {
+        emit_literal(def, def->window[def->strstart - 1u]);
+        def->match_available = false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fill_window
+ *******************************************************************************
+ * Summary:
+ *  Copies data after the lookahead, sliding the window first when the
+ *  current position has reached its upper half.
+ *
+ * Return:
+ *  uint32_t: Number of bytes copied.
+ *
+ *******************************************************************************/
+static uint32_t fill_window(deflater_t *def, const uint8_t *data, size_t length)
+{
+    uint32_t end;
+    uint32_t space;
+
+    if (def->strstart >= (DEFLATER_WINDOW_SIZE + MAX_DIST))
+    {
+        slide_window(def);
+    }
+
+    end = def->strstart + def->lookahead;
+    space = (2u * DEFLATER_WINDOW_SIZE) - end;
+    if (space > length)
+    {
+        space = (uint32_t)length;
+    }
+
+    memcpy(&def->window[end], data, space);
+    def->lookahead += space;
+
+    return space;
+}
+
+/*******************************************************************************
+ * Function Name: slide_window
+ *******************************************************************************
+ * Summary:
+ *  Moves the upper half of the window down and drops the chain entries that
+ *  pointed into the lower half.
+ *
+ *******************************************************************************/
+static void slide_window(deflater_t *def)
+{
+    memcpy(def->window, &def->window[DEFLATER_WINDOW_SIZE], DEFLATER_WINDOW_SIZE);
+    def->match_start -= DEFLATER_WINDOW_SIZE;
+    def->prev_match -= DEFLATER_WINDOW_SIZE;
+    def->strstart -= DEFLATER_WINDOW_SIZE;
+
+    for (uint32_t i = 0; i < DEFLATER_HASH_SIZE; i++)
+    {
+        def->head[i] = (def->head[i] >= DEFLATER_WINDOW_SIZE) ?
+                       (uint16_t)(def->head[i] - DEFLATER_WINDOW_SIZE) : NIL;
+    }
+
+    for (uint32_t i = 0; i < DEFLATER_WINDOW_SIZE; i++)
+    {
+        def->prev[i] = (def->prev[i] >= DEFLATER_WINDOW_SIZE) ?
+                       (uint16_t)(def->prev[i] - DEFLATER_WINDOW_SIZE) : NIL;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: insert_string
+ *******************************************************************************
+ * Summary:
+ *  Adds the 3 bytes at a position to the hash chains.
+ *
+ * Return:
+ *  uint32_t: Previous position with the same hash, or NIL.
+ *
+ *******************************************************************************/
+static uint32_t insert_string(deflater_t *def, uint32_t position)
+{
+    const uint8_t *p = &def->window[position];
+    uint32_t hash;
+    uint32_t head;
+
+    hash = ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)) * 2654435761u;
+    hash >>= 32u - DEFLATER_HASH_BITS;
+
+    head = def->head[hash];
+    def->prev[position & WINDOW_MASK] = (uint16_t)head;
+    def->head[hash] = (uint16_t)position;
+
+    return head;
+}
+
+/*******************************************************************************
+ * Function Name: longest_match
+ *******************************************************************************
+ * Summary:
+ *  Follows the hash chain from a position and finds the longest match with
+ *  the data at the current position that is longer than prev_length. Sets
+ *  match_start when it finds one.
+ *
+ * Return:
+ *  uint32_t: Length of the best match, at most the lookahead.
+ *
+ *******************************************************************************/
+static uint32_t longest_match(deflater_t *def, uint32_t cur_match)
+{
+    const uint8_t *scan = &def->window[def->strstart];
+    const uint8_t *match;
+    uint32_t chain = def->max_chain;
+    uint32_t best_length = def->prev_length;
+    uint32_t max_length = (def->lookahead < MAX_MATCH) ? def->lookahead : MAX_MATCH;
+    uint32_t nice_length = (def->nice_length < max_length) ? def->nice_length : max_length;
+    uint32_t limit = (def->strstart > MAX_DIST) ? (def->strstart - MAX_DIST) : NIL;
+    uint32_t length;
+
+    if (best_length >= def->good_length)
+    {
+        chain >>= 2;
+    }
+
+    if (best_length >= max_length)
+    {
+        return max_length;
+    }
+
+    do
+    {
+        match = &def->window[cur_match];
+
+        if ((match[best_length] != scan[best_length]) || (match[0] != scan[0]) || (match[1] != scan[1]))
+        {
+            continue;
+        }
+
+        length = 2u;
+        while ((length < max_length) && (match[length] == scan[length]))
+        {
+            length++;
+        }
+
+        if (length > best_length)
+        {
+            def->match_start = cur_match;
+            best_length = length;
+            if (length >= nice_length)
+            {
+                break;
+            }
+        }
+    } while (((cur_match = def->prev[cur_match & WINDOW_MASK]) > limit) && (--chain != 0u));
+
+    return best_length;
+}
+
+/*******************************************************************************
+ * Function Name: emit_literal
+ *******************************************************************************
+ * Summary:
+ *  Writes the fixed code of a literal byte.
+ *
+ *******************************************************************************/
+static void emit_literal(deflater_t *def, uint32_t value)
+{
+    if (value < 144u)
+    {
+        put_code(def, 0x30u + value, 8);
+    }
+    else
+    {
+        put_code(def, 0x190u + (value - 144u), 9);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: emit_match
+ *******************************************************************************
+ * Summary:
+ *  Writes the fixed codes and extra bits of a length and distance pair.
+ *
+ *******************************************************************************/
+static void emit_match(deflater_t *def, uint32_t distance, uint32_t length)
+{
+    uint32_t value = length - MIN_MATCH;
+    uint32_t symbol;
+    uint32_t extra_bits;
+    uint32_t bits;
+
+    /* Length symbols 257..285: eight without extra bits, then four per
+     * number of extra bits, and 285 for 258.
+     */
+    if (value < 8u)
+    {
+        symbol = value;
+        extra_bits = 0;
+    }
+    else if (value == (MAX_MATCH - MIN_MATCH))
+    {
+        symbol = 28u;
+        extra_bits = 0;
+    }
+    else
+    {
+        bits = bit_length(value);
+        extra_bits = bits - 3u;
+        symbol = (4u * (bits - 2u)) + ((value >> extra_bits) & 3u);
+    }
+
+    symbol += END_OF_BLOCK + 1u;
+    if (symbol < 280u)
+    {
+        put_code(def, symbol - END_OF_BLOCK, 7);
+    }
+    else
+    {
+        put_code(def, 0xC0u + (symbol - 280u), 8);
+    }
+    put_bits(def, value & ((1u << extra_bits) - 1u), extra_bits);
+
+    /* Distance symbols 0..29: four without extra bits, then two per number
+     * of extra bits.
+     */
+    value = distance - 1u;
+    if (value < 4u)
+    {
+        symbol = value;
+        extra_bits = 0;
+    }
+    else
+    {
+        bits = bit_length(value);
+        extra_bits = bits - 2u;
+        symbol = (2u * (bits - 1u)) + ((value >> extra_bits) & 1u);
+    }
+    put_code(def, symbol, 5);
+    put_bits(def, value & ((1u << extra_bits) - 1u), extra_bits);
+}
+
+/*******************************************************************************
+ * Function Name: put_code
+ *******************************************************************************
+ * Summary:
+ *  Writes a Huffman code, which is sent most significant bit first.
+ *
+ *******************************************************************************/
+static void put_code(deflater_t *def, uint32_t code, uint32_t length)
+{
+    uint32_t reversed = ((uint32_t)reverse_nibble[code & 0x0Fu] << 12) |
+                        ((uint32_t)reverse_nibble[(code >> 4) & 0x0Fu] << 8) |
+                        ((uint32_t)reverse_nibble[(code >> 8) & 0x0Fu] << 4) |
+                        (uint32_t)reverse_nibble[(code >> 12) & 0x0Fu];
+
+    put_bits(def, reversed >> (16u - length), length);
+}
+
+/*******************************************************************************
+ * Function Name: put_bits
+ *******************************************************************************
+ * Summary:
+ *  Writes up to 16 bits, least significant bit first.
+ *
+ *******************************************************************************/
+static void put_bits(deflater_t *def, uint32_t value, uint32_t count)
+{
+    def->bit_buf |= value << def->bit_count;
+    def->bit_count += count;
+
+    while (def->bit_count >= 8u)
+    {
+        put_byte(def, (uint8_t)def->bit_buf);
+        def->bit_buf >>= 8;
+        def->bit_count -= 8u;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: put_byte
+ *******************************************************************************
+ * Summary:
+ *  Adds a byte to the output buffer.
+ *
+ *******************************************************************************/
+static void put_byte(deflater_t *def, uint8_t value)
+{
+    def->out[def->out_len++] = value;
+
+    if (def->out_len == DEFLATER_OUT_SIZE)
+    {
+        flush_output(def);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush_bits
+ *******************************************************************************
+ * Summary:
+ *  Pads the last partial byte with zero bits.
+ *
+ *******************************************************************************/
+static void flush_bits(deflater_t *def)
+{
+    if (def->bit_count > 0u)
+    {
+        put_byte(def, (uint8_t)def->bit_buf);
+    }
+    def->bit_buf = 0;
+    def->bit_count = 0;
+}
+
+/*******************************************************************************
+ * Function Name: flush_output
+ *******************************************************************************
+ * Summary:
+ *  Passes the output buffer to the output callback.
+ *
+ *******************************************************************************/
+static void flush_output(deflater_t *def)
+{
+    if ((def->out_len > 0u) && (DEFLATER_OK == def->status))
+    {
+        if (!def->output(def->out, def->out_len, def->output_arg))
+        {
+            def->status = DEFLATER_STOPPED;
+        }
+        def->total_out += def->out_len;
+    }
+    def->out_len = 0;
+}
+
+/*******************************************************************************
+ * Function Name: bit_length
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of bits needed for a non-zero value.
+ *
+ *******************************************************************************/
+static uint32_t bit_length(uint32_t value)
+{
+    uint32_t bits = 0;
+
+    while (0u != value)
+    {
+        bits++;
+        value >>= 1;
+    }
+
+    return bits;
+}
+
+/*******************************************************************************
+ * Function Name: adler32
+ *******************************************************************************
+ * Summary:
+ *  Updates an Adler-32 as used by zlib. Start with 1.
+ *
+ *******************************************************************************/
+static uint32_t adler32(uint32_t adler, const uint8_t *data, size_t length)
+{
+    uint32_t a = adler & 0xFFFFu;
+    uint32_t b = adler >> 16;
+    size_t block;
+
+    while (length > 0)
+    {
+        block = (length < ADLER_BLOCK) ? length : ADLER_BLOCK;
+        length -= block;
+
+        while (block-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+
+    return (b << 16) | a;
+}
+
+/* [] END OF FILE */
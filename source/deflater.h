@@ -0,0 +1,147 @@
+/******************************************************************************
+* File Name: deflater.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the streaming deflate compressor for request bodies.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef DEFLATER_H_
+#define DEFLATER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Size of the match window, as a power of two. The compressor holds twice the
+ * window plus the hash chains: about 20 KB for 12 bits.
+ */
+#define DEFLATER_WINDOW_BITS                     (12)
+#define DEFLATER_WINDOW_SIZE                     (1u << DEFLATER_WINDOW_BITS)
+
+/* Size of the hash table of 3-byte prefixes, as a power of two. */
+#define DEFLATER_HASH_BITS                       (11)
+#define DEFLATER_HASH_SIZE                       (1u << DEFLATER_HASH_BITS)
+
+/* Bytes collected before the output callback is called. */
+#define DEFLATER_OUT_SIZE                        (128)
+
+#define DEFLATER_MIN_LEVEL                       (1)
+#define DEFLATER_MAX_LEVEL                       (9)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    DEFLATER_FORMAT_ZLIB,            /* HTTP "deflate" (RFC 1950). */
+    DEFLATER_FORMAT_GZIP,            /* HTTP "gzip" (RFC 1952). */
+} deflater_format_t;
+
+typedef enum
+{
+    DEFLATER_OK,
+    DEFLATER_STOPPED,                /* The output callback refused the data. */
+    DEFLATER_ERR_PARAM,              /* Invalid level, or write after finish. */
+} deflater_status_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Called with compressed data, in order. Returning false stops the
+ * compressor.
+ */
+typedef bool (*deflater_output_t)(const uint8_t *data, size_t length, void *arg);
+
+/* Compressor state. The window, hash table, and chains are part of the
+ * structure, so the memory use is fixed at build time.
+ */
+typedef struct
+{
+    deflater_format_t format;
+    deflater_status_t status;
+    bool finished;
+
+    /* Search parameters of the level. */
+    uint16_t good_length;
+    uint16_t max_lazy;
+    uint16_t nice_length;
+    uint16_t max_chain;
+
+    /* LZ77 state. */
+    uint8_t window[2 * DEFLATER_WINDOW_SIZE];
+    uint16_t head[DEFLATER_HASH_SIZE];
+    uint16_t prev[DEFLATER_WINDOW_SIZE];
+    uint32_t strstart;
+    uint32_t lookahead;
+    uint32_t match_start;
+    uint32_t match_length;
+    uint32_t prev_length;
+    uint32_t prev_match;
+    bool match_available;
+
+    /* Output. */
+    uint32_t bit_buf;
+    uint32_t bit_count;
+    uint8_t out[DEFLATER_OUT_SIZE];
+    uint32_t out_len;
+    deflater_output_t output;
+    void *output_arg;
+
+    /* Check value and length of the uncompressed data. */
+    uint32_t check;
+    uint32_t total_in;
+    uint32_t total_out;
+} deflater_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+deflater_status_t deflater_init(deflater_t *def, deflater_format_t format, uint32_t level,
+                                deflater_output_t output, void *arg);
+deflater_status_t deflater_write(deflater_t *def, const uint8_t *data, size_t length);
+deflater_status_t deflater_finish(deflater_t *def);
+
+#endif /* DEFLATER_H_ */
+
+
+/* [] END OF FILE */
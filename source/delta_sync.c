@@ -0,0 +1,1036 @@
+/******************************************************************************
+* File Name: delta_sync.c
+*
+* Description: This file contains the delta sync. The local copy of a resource
+* in the external flash is hashed block by block and compared with the
+* block-hash manifest published by the server. Only the blocks that differ
+* are fetched with HTTP Range requests, and they are patched into the copy
+* one erase sector at a time.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_serial_flash_qspi.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* mbedTLS header file for the SHA-256 digest */
+#include "mbedtls/sha256.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "flash_download.h"
+#include "xorshift.h"
+#include "delta_sync.h"
+#include "wifi_power.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define DELTA_SYNC_BUFFER_LENGTH         (DELTA_SYNC_FETCH_SIZE + DELTA_SYNC_HEADER_SPACE)
+#define DELTA_SYNC_MAX_PATH_LEN          (64)
+
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+#define BLOCK_CHANGED(block)             (0u != (changed_map[(block) / 8u] & (1u << ((block) % 8u))))
+
+/* Manifest of the resource synced by the benchmark. */
+#define BENCH_BLOCKS                     (DELTA_SYNC_BENCH_SIZE / DELTA_SYNC_BENCH_BLOCK_SIZE)
+#define BENCH_MANIFEST_LENGTH            (sizeof(manifest_header_t) + (BENCH_BLOCKS * DELTA_SYNC_BLOCK_HASH_LEN))
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Header of the block-hash manifest. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t block_size;
+    uint32_t total_len;
+    uint8_t  sha256[FLASH_DOWNLOAD_SHA256_LEN];
+} manifest_header_t;
+
+/* Piece of the manifest or of the resource returned by a fetch. */
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t length;
+    uint32_t total_len;          /* Length of the manifest or of the resource. */
+    uint32_t wire_len;           /* Response bytes, headers included. */
+} fetch_result_t;
+
+/* Fetches length bytes at offset of the manifest or of the resource. */
+typedef cy_rslt_t (*fetch_cb_t)(void *arg, bool manifest, uint32_t offset, uint32_t length,
+                                fetch_result_t *result);
+
+/* Resource on the HTTPS server. */
+typedef struct
+{
+    cy_http_client_t handle;
+    const char *path;
+    char manifest_path[DELTA_SYNC_MAX_PATH_LEN + sizeof(DELTA_SYNC_MANIFEST_SUFFIX)];
+} http_source_t;
+
+/* State of a sync. */
+typedef struct
+{
+    fetch_cb_t fetch;
+    void *arg;
+    uint32_t flash_addr;
+    uint32_t sector_size;
+    manifest_header_t header;
+    uint32_t parsed;             /* Manifest bytes parsed so far. */
+    uint32_t entry_len;          /* Bytes of the block hash being received. */
+    uint8_t entry[DELTA_SYNC_BLOCK_HASH_LEN];
+    delta_sync_stats_t *stats;
+} sync_job_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Receive buffer of the Range requests. */
+static uint8_t fetch_buffer[DELTA_SYNC_BUFFER_LENGTH];
+
+/* Flash pieces being hashed or copied. */
+static uint8_t copy_buffer[DELTA_SYNC_COPY_SIZE];
+
+/* One bit per block, set if the block differs from the manifest. */
+static uint8_t changed_map[DELTA_SYNC_MAX_BLOCKS / 8u];
+
+/* Benchmark origin: the manifest of the edited resource and the blocks that
+ * carry an edit in the current round.
+ */
+static uint8_t bench_manifest[BENCH_MANIFEST_LENGTH];
+static uint8_t bench_edited[BENCH_BLOCKS / 8u];
+static uint32_t bench_round;
+static uint32_t random_state = 0x2F6B3A91u;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static cy_rslt_t run_sync(fetch_cb_t fetch, void *arg, uint32_t flash_addr, delta_sync_stats_t *stats,
+                          uint8_t *sha256);
+static cy_rslt_t fetch_manifest(sync_job_t *job);
+static cy_rslt_t parse_manifest(sync_job_t *job, const uint8_t *data, uint32_t length);
+static cy_rslt_t check_manifest(sync_job_t *job);
+static cy_rslt_t patch_sector(sync_job_t *job, uint32_t sector);
+static cy_rslt_t fetch_blocks(sync_job_t *job, uint32_t block, uint32_t count, uint32_t dest);
+static cy_rslt_t hash_flash(uint32_t addr, uint32_t length, uint8_t *digest);
+static cy_rslt_t copy_flash(uint32_t dest, uint32_t src, uint32_t length);
+static cy_rslt_t fetch_http(void *arg, bool manifest, uint32_t offset, uint32_t length,
+                            fetch_result_t *result);
+static cy_rslt_t fetch_bench(void *arg, bool manifest, uint32_t offset, uint32_t length,
+                             fetch_result_t *result);
+static void bench_fill(uint8_t *dest, uint32_t offset, uint32_t length, bool edited);
+static cy_rslt_t bench_write_base(void);
+static void bench_prepare(uint32_t permille);
+static uint32_t bench_mix(uint32_t value);
+
+/*******************************************************************************
+ * Function Name: delta_sync
+ *******************************************************************************
+ * Summary:
+ *  Brings the copy of a resource in the external flash up to date with the
+ *  server. The block-hash manifest at the resource path followed by
+ *  DELTA_SYNC_MANIFEST_SUFFIX is compared with the hashes of the local
+ *  blocks, only the blocks that differ are fetched with Range requests, and
+ *  the copy is checked against the digest of the whole resource at the end.
+ *  The caller must own the HTTP client.
+ *
+ *  A sync that is interrupted leaves some blocks outdated or erased. Their
+ *  hashes differ from the manifest, so the next sync fetches them again.
+ *  The validity header of the copy is erased before the first block is
+ *  patched and written again only once the whole copy matches.
+ *
+ * Parameters:
+ *  handle - Connected HTTP client instance.
+ *  path - Resource path on the server.
+ *  flash_addr - Address of the local copy in the external flash. Must be
+ *               aligned to the erase sector size.
+ *  stats - Filled with the statistics of the sync.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the local copy matches the manifest,
+ *  otherwise, it returns an HTTP client, serial flash, or CY_RSLT_TYPE_ERROR
+ *  error code.
+ *
+ *******************************************************************************/
+cy_rslt_t delta_sync(cy_http_client_t handle, const char *path, uint32_t flash_addr,
+                     delta_sync_stats_t *stats)
+{
+    cy_rslt_t result;
+    http_source_t source;
+    uint8_t sha256[FLASH_DOWNLOAD_SHA256_LEN];
+
+    if ((NULL == path) || (NULL == stats) || (strlen(path) > DELTA_SYNC_MAX_PATH_LEN))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    source.handle = handle;
+    source.path = path;
+    snprintf(source.manifest_path, sizeof(source.manifest_path), "%s%s", path, DELTA_SYNC_MANIFEST_SUFFIX);
+
+    /* The copy is patched in place, so it is invalid until checked again. */
+    result = flash_download_invalidate();
+    if (CY_RSLT_SUCCESS == result)
+    {
+        wifi_power_begin();
+        result = run_sync(fetch_http, &source, flash_addr, stats, sha256);
+        wifi_power_end();
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flash_download_mark_valid(flash_addr, stats->total_len, sha256);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: delta_sync_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the blocks fetched, the bytes received, and the time of a sync.
+ *
+ * Parameters:
+ *  stats - Statistics filled by delta_sync().
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void delta_sync_print_stats(const delta_sync_stats_t *stats)
+{
+    printf("\r\n Delta sync of %lu bytes in %lu-byte blocks\r\n",
+           (unsigned long)stats->total_len, (unsigned long)stats->block_size);
+    printf("  changed blocks     %lu of %lu\r\n",
+           (unsigned long)stats->changed_blocks, (unsigned long)stats->num_blocks);
+    printf("  Range requests     %lu\r\n", (unsigned long)stats->requests);
+    printf("  bytes received     %lu (manifest %lu, blocks %lu)\r\n", (unsigned long)stats->received_bytes,
+           (unsigned long)stats->manifest_bytes, (unsigned long)stats->block_bytes);
+    printf("  sectors patched    %lu (%lu through the scratch sector)\r\n",
+           (unsigned long)stats->sectors_patched, (unsigned long)stats->sectors_copied);
+    printf("  time               %lu ms (hash %lu, network %lu, flash %lu)\r\n",
+           (unsigned long)stats->elapsed_ms, (unsigned long)stats->hash_ms,
+           (unsigned long)stats->network_ms, (unsigned long)stats->flash_ms);
+}
+
+/*******************************************************************************
+ * Function Name: delta_sync_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Syncs a resource of DELTA_SYNC_BENCH_SIZE bytes in the external flash
+ *  with versions in which each rate of DELTA_SYNC_BENCH_RATES of the blocks
+ *  was edited, served by a simulated origin. The local copy is rewritten
+ *  before every round. Prints the bytes received and the update time of
+ *  every rate next to those of a full download. The transfers are timed on
+ *  the simulated link, and the hashing and flash work is measured.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void delta_sync_benchmark(void)
+{
+    static const uint32_t rates[] = DELTA_SYNC_BENCH_RATES;
+    delta_sync_stats_t stats;
+    cy_rslt_t result;
+    TickType_t start;
+    uint32_t write_ms = 0;
+    uint32_t full_requests;
+    uint32_t full_bytes;
+    uint32_t full_link_ms;
+    uint32_t link_ms;
+    uint32_t sector_size = (uint32_t)cy_serial_flash_qspi_get_erase_size(DELTA_SYNC_BENCH_ADDRESS);
+
+    /* A full download receives every chunk while the previous one is
+     * programmed, so it takes the longer of the link and the flash writes.
+     */
+    full_requests = (DELTA_SYNC_BENCH_SIZE + FLASH_DOWNLOAD_CHUNK_SIZE - 1u) / FLASH_DOWNLOAD_CHUNK_SIZE;
+    full_bytes = DELTA_SYNC_BENCH_SIZE + (full_requests * DELTA_SYNC_SIM_RESPONSE_HEAD);
+    full_link_ms = (full_requests * DELTA_SYNC_SIM_RTT_MS) + ((full_bytes * 8u) / DELTA_SYNC_SIM_LINK_KBPS);
+
+    APP_INFO(("Delta sync of a %lu KB resource in %lu-byte blocks, %lu kbit/s link, %lu ms RTT\n",
+              (unsigned long)(DELTA_SYNC_BENCH_SIZE / 1024u), (unsigned long)DELTA_SYNC_BENCH_BLOCK_SIZE,
+              (unsigned long)DELTA_SYNC_SIM_LINK_KBPS, (unsigned long)DELTA_SYNC_SIM_RTT_MS));
+    printf("  change  blocks  requests  received  sectors  update ms (hash/flash/link)\n");
+
+    for (uint32_t i = 0; i < (sizeof(rates) / sizeof(rates[0])); i++)
+    {
+        start = xTaskGetTickCount();
+        result = bench_write_base();
+        write_ms = TICKS_TO_MS(xTaskGetTickCount() - start);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to write the benchmark resource. Error=%ld\n", (unsigned long)result));
+            return;
+        }
+
+        bench_prepare(rates[i]);
+
+        result = run_sync(fetch_bench, NULL, DELTA_SYNC_BENCH_ADDRESS, &stats, NULL);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Delta sync failed at %lu permille. Error=%ld\n",
+                      (unsigned long)rates[i], (unsigned long)result));
+            return;
+        }
+
+        link_ms = (stats.requests * DELTA_SYNC_SIM_RTT_MS) + ((stats.received_bytes * 8u) / DELTA_SYNC_SIM_LINK_KBPS);
+        printf("  %3lu.%lu%%  %6lu  %8lu  %8lu  %7lu  %9lu (%lu/%lu/%lu)\n",
+               (unsigned long)(rates[i] / 10u), (unsigned long)(rates[i] % 10u),
+               (unsigned long)stats.changed_blocks, (unsigned long)stats.requests,
+               (unsigned long)stats.received_bytes, (unsigned long)stats.sectors_patched,
+               (unsigned long)(stats.elapsed_ms - stats.network_ms + link_ms),
+               (unsigned long)stats.hash_ms, (unsigned long)stats.flash_ms, (unsigned long)link_ms);
+    }
+
+    printf("   full   %6lu  %8lu  %8lu  %7lu  %9lu (-/%lu/%lu)\n",
+           (unsigned long)BENCH_BLOCKS, (unsigned long)full_requests, (unsigned long)full_bytes,
+           (unsigned long)((DELTA_SYNC_BENCH_SIZE + sector_size - 1u) / sector_size),
+           (unsigned long)((write_ms > full_link_ms) ? write_ms : full_link_ms),
+           (unsigned long)write_ms, (unsigned long)full_link_ms);
+}
+
+/*******************************************************************************
+ * Function Name: run_sync
+ *******************************************************************************
+ * Summary:
+ *  Syncs the local copy at flash_addr with the resource behind the fetch
+ *  function: compares the block hashes while the manifest is received,
+ *  patches the sectors that hold changed blocks, and checks the digest of
+ *  the whole resource, which is copied to sha256 unless it is NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the sync.
+ *
+ *******************************************************************************/
+static cy_rslt_t run_sync(fetch_cb_t fetch, void *arg, uint32_t flash_addr, delta_sync_stats_t *stats,
+                          uint8_t *sha256)
+{
+    cy_rslt_t result;
+    sync_job_t job;
+    uint8_t digest[FLASH_DOWNLOAD_SHA256_LEN];
+    uint32_t num_sectors;
+    TickType_t start;
+    TickType_t ticks;
+
+    memset(stats, 0, sizeof(*stats));
+    memset(&job, 0, sizeof(job));
+    memset(changed_map, 0, sizeof(changed_map));
+
+    job.fetch = fetch;
+    job.arg = arg;
+    job.flash_addr = flash_addr;
+    job.stats = stats;
+    job.sector_size = (uint32_t)cy_serial_flash_qspi_get_erase_size(flash_addr);
+
+    if ((0 == job.sector_size) || (0 != (flash_addr % job.sector_size)))
+    {
+        ERR_INFO(("Flash address 0x%08lx is not sector aligned.\n", (unsigned long)flash_addr));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    start = xTaskGetTickCount();
+
+    result = fetch_manifest(&job);
+
+    num_sectors = (stats->total_len + job.sector_size - 1u) / job.sector_size;
+    for (uint32_t sector = 0; (CY_RSLT_SUCCESS == result) && (sector < num_sectors); sector++)
+    {
+        result = patch_sector(&job, sector);
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        ticks = xTaskGetTickCount();
+        result = hash_flash(flash_addr, stats->total_len, digest);
+        stats->hash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+
+        if ((CY_RSLT_SUCCESS == result) && (0 != memcmp(digest, job.header.sha256, sizeof(digest))))
+        {
+            ERR_INFO(("SHA-256 mismatch after the delta sync, a full download is needed.\n"));
+            result = CY_RSLT_TYPE_ERROR;
+        }
+        else if ((CY_RSLT_SUCCESS == result) && (NULL != sha256))
+        {
+            memcpy(sha256, digest, sizeof(digest));
+        }
+    }
+
+    stats->elapsed_ms = TICKS_TO_MS(xTaskGetTickCount() - start);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: fetch_manifest
+ *******************************************************************************
+ * Summary:
+ *  Receives the manifest in pieces of DELTA_SYNC_FETCH_SIZE and parses each
+ *  piece as it arrives, so the manifest is never held in RAM as a whole.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the requests and of the parsing.
+ *
+ *******************************************************************************/
+static cy_rslt_t fetch_manifest(sync_job_t *job)
+{
+    cy_rslt_t result;
+    fetch_result_t piece;
+    uint32_t offset = 0;
+    uint32_t total = 0;
+    TickType_t ticks;
+
+    do
+    {
+        ticks = xTaskGetTickCount();
+        result = job->fetch(job->arg, true, offset, DELTA_SYNC_FETCH_SIZE, &piece);
+        job->stats->network_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        job->stats->requests++;
+        job->stats->received_bytes += piece.wire_len;
+
+        if (0 == offset)
+        {
+            total = piece.total_len;
+        }
+
+        if ((0 == piece.length) || ((offset + piece.length) > total))
+        {
+            ERR_INFO(("Unexpected manifest length %lu at offset %lu.\n",
+                      (unsigned long)piece.length, (unsigned long)offset));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        result = parse_manifest(job, piece.data, piece.length);
+        offset += piece.length;
+    } while ((CY_RSLT_SUCCESS == result) && (offset < total));
+
+    job->stats->manifest_bytes = offset;
+
+    if ((CY_RSLT_SUCCESS == result) &&
+        ((job->parsed < sizeof(manifest_header_t)) ||
+         (job->parsed != (sizeof(manifest_header_t) + (job->stats->num_blocks * DELTA_SYNC_BLOCK_HASH_LEN)))))
+    {
+        ERR_INFO(("The block-hash manifest is truncated.\n"));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: parse_manifest
+ *******************************************************************************
+ * Summary:
+ *  Parses a piece of the manifest. Every block hash is compared with the
+ *  hash of the same block of the local copy as soon as it is complete, and
+ *  the block is marked when they differ.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, or an error for an invalid manifest or
+ *  a failed flash read.
+ *
+ *******************************************************************************/
+static cy_rslt_t parse_manifest(sync_job_t *job, const uint8_t *data, uint32_t length)
+{
+    cy_rslt_t result;
+    uint8_t digest[FLASH_DOWNLOAD_SHA256_LEN];
+    uint32_t take;
+    uint32_t block;
+    uint32_t offset;
+    uint32_t block_len;
+    TickType_t ticks;
+
+    while (length > 0)
+    {
+        if (job->parsed < sizeof(manifest_header_t))
+        {
+            take = sizeof(manifest_header_t) - job->parsed;
+            take = (take > length) ? length : take;
+            memcpy((uint8_t *)&job->header + job->parsed, data, take);
+            job->parsed += take;
+            data += take;
+            length -= take;
+
+            if ((sizeof(manifest_header_t) == job->parsed) && (CY_RSLT_SUCCESS != check_manifest(job)))
+            {
+                return CY_RSLT_TYPE_ERROR;
+            }
+            continue;
+        }
+
+        block = (job->parsed - sizeof(manifest_header_t)) / DELTA_SYNC_BLOCK_HASH_LEN;
+        if (block >= job->stats->num_blocks)
+        {
+            ERR_INFO(("The block-hash manifest is longer than its header says.\n"));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        take = DELTA_SYNC_BLOCK_HASH_LEN - job->entry_len;
+        take = (take > length) ? length : take;
+        memcpy(&job->entry[job->entry_len], data, take);
+        job->entry_len += take;
+        job->parsed += take;
+        data += take;
+        length -= take;
+
+        if (DELTA_SYNC_BLOCK_HASH_LEN == job->entry_len)
+        {
+            job->entry_len = 0;
+            offset = block * job->header.block_size;
+            block_len = job->header.total_len - offset;
+            block_len = (block_len > job->header.block_size) ? job->header.block_size : block_len;
+
+            ticks = xTaskGetTickCount();
+            result = hash_flash(job->flash_addr + offset, block_len, digest);
+            job->stats->hash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+            if (CY_RSLT_SUCCESS != result)
+            {
+                return result;
+            }
+
+            if (0 != memcmp(digest, job->entry, DELTA_SYNC_BLOCK_HASH_LEN))
+            {
+                changed_map[block / 8u] |= (uint8_t)(1u << (block % 8u));
+                job->stats->changed_blocks++;
+            }
+        }
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: check_manifest
+ *******************************************************************************
+ * Summary:
+ *  Checks the manifest header against the limits of the sync and of the
+ *  flash area of the local copy.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the resource can be synced,
+ *  otherwise, it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+static cy_rslt_t check_manifest(sync_job_t *job)
+{
+    const manifest_header_t *header = &job->header;
+    uint32_t capacity;
+    uint32_t num_blocks;
+
+    capacity = (job->flash_addr < DELTA_SYNC_SCRATCH_ADDRESS) ? (DELTA_SYNC_SCRATCH_ADDRESS - job->flash_addr) : 0u;
+
+    if ((DELTA_SYNC_MANIFEST_MAGIC != header->magic) ||
+        (header->block_size < DELTA_SYNC_MIN_BLOCK_SIZE) || (header->block_size > DELTA_SYNC_FETCH_SIZE) ||
+        (0 != (job->sector_size % header->block_size)) ||
+        (0 == header->total_len) || (header->total_len > capacity))
+    {
+        ERR_INFO(("Invalid block-hash manifest: block size %lu, length %lu.\n",
+                  (unsigned long)header->block_size, (unsigned long)header->total_len));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    num_blocks = (header->total_len + header->block_size - 1u) / header->block_size;
+    if (num_blocks > DELTA_SYNC_MAX_BLOCKS)
+    {
+        ERR_INFO(("The manifest has %lu blocks, more than %lu.\n",
+                  (unsigned long)num_blocks, (unsigned long)DELTA_SYNC_MAX_BLOCKS));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    job->stats->total_len = header->total_len;
+    job->stats->block_size = header->block_size;
+    job->stats->num_blocks = num_blocks;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: patch_sector
+ *******************************************************************************
+ * Summary:
+ *  Writes the changed blocks of an erase sector of the local copy. A sector
+ *  in which every block changed is erased and written in place. Any other
+ *  sector is rebuilt in the scratch sector from its unchanged blocks and the
+ *  fetched ones, and then copied back. Runs of adjacent changed blocks are
+ *  fetched with one request.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the requests and of the flash operations.
+ *
+ *******************************************************************************/
+static cy_rslt_t patch_sector(sync_job_t *job, uint32_t sector)
+{
+    cy_rslt_t result;
+    delta_sync_stats_t *stats = job->stats;
+    uint32_t block_size = job->header.block_size;
+    uint32_t first = sector * (job->sector_size / block_size);
+    uint32_t end = first + (job->sector_size / block_size);
+    uint32_t max_run = DELTA_SYNC_FETCH_SIZE / block_size;
+    uint32_t sector_addr = job->flash_addr + (sector * job->sector_size);
+    uint32_t target;
+    uint32_t changed = 0;
+    uint32_t block;
+    uint32_t run;
+    TickType_t ticks;
+
+    end = (end > stats->num_blocks) ? stats->num_blocks : end;
+
+    for (block = first; block < end; block++)
+    {
+        if (BLOCK_CHANGED(block))
+        {
+            changed++;
+        }
+    }
+
+    if (0u == changed)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    target = (changed == (end - first)) ? sector_addr : DELTA_SYNC_SCRATCH_ADDRESS;
+
+    ticks = xTaskGetTickCount();
+    result = cy_serial_flash_qspi_erase(target, job->sector_size);
+    stats->flash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+
+    block = first;
+    while ((CY_RSLT_SUCCESS == result) && (block < end))
+    {
+        if (BLOCK_CHANGED(block))
+        {
+            for (run = 1; (run < max_run) && ((block + run) < end) && BLOCK_CHANGED(block + run); run++)
+            {
+            }
+
+            result = fetch_blocks(job, block, run, target + ((block - first) * block_size));
+            block += run;
+        }
+        else
+        {
+            ticks = xTaskGetTickCount();
+            result = copy_flash(target + ((block - first) * block_size),
+                                sector_addr + ((block - first) * block_size), block_size);
+            stats->flash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+            block++;
+        }
+    }
+
+    if ((CY_RSLT_SUCCESS == result) && (target != sector_addr))
+    {
+        ticks = xTaskGetTickCount();
+        result = cy_serial_flash_qspi_erase(sector_addr, job->sector_size);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = copy_flash(sector_addr, DELTA_SYNC_SCRATCH_ADDRESS, (end - first) * block_size);
+        }
+        stats->flash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+        stats->sectors_copied++;
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        stats->sectors_patched++;
+    }
+    else
+    {
+        ERR_INFO(("Failed to patch the sector at 0x%08lx. Error=%ld\n",
+                  (unsigned long)sector_addr, (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: fetch_blocks
+ *******************************************************************************
+ * Summary:
+ *  Fetches a run of changed blocks with one request and programs them at the
+ *  given flash address, which must be erased.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the request and of the flash write.
+ *
+ *******************************************************************************/
+static cy_rslt_t fetch_blocks(sync_job_t *job, uint32_t block, uint32_t count, uint32_t dest)
+{
+    cy_rslt_t result;
+    fetch_result_t piece;
+    uint32_t offset = block * job->header.block_size;
+    uint32_t length = count * job->header.block_size;
+    TickType_t ticks;
+
+    length = ((offset + length) > job->header.total_len) ? (job->header.total_len - offset) : length;
+
+    ticks = xTaskGetTickCount();
+    result = job->fetch(job->arg, false, offset, length, &piece);
+    job->stats->network_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    job->stats->requests++;
+    job->stats->received_bytes += piece.wire_len;
+
+    if (piece.length != length)
+    {
+        ERR_INFO(("Unexpected length %lu of the blocks at offset %lu.\n",
+                  (unsigned long)piece.length, (unsigned long)offset));
+        return CY_RSLT_TYPE_ERROR;
+    }
+    job->stats->block_bytes += length;
+
+    ticks = xTaskGetTickCount();
+    result = cy_serial_flash_qspi_write(dest, length, piece.data);
+    job->stats->flash_ms += TICKS_TO_MS(xTaskGetTickCount() - ticks);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: hash_flash
+ *******************************************************************************
+ * Summary:
+ *  Computes the SHA-256 digest of an area of the external flash.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the flash reads.
+ *
+ *******************************************************************************/
+static cy_rslt_t hash_flash(uint32_t addr, uint32_t length, uint8_t *digest)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    mbedtls_sha256_context sha_ctx;
+    uint32_t done;
+    uint32_t piece;
+
+    mbedtls_sha256_init(&sha_ctx);
+    mbedtls_sha256_starts_ret(&sha_ctx, 0);
+
+    for (done = 0; (CY_RSLT_SUCCESS == result) && (done < length); done += piece)
+    {
+        piece = length - done;
+        piece = (piece > DELTA_SYNC_COPY_SIZE) ? DELTA_SYNC_COPY_SIZE : piece;
+        result = cy_serial_flash_qspi_read(addr + done, piece, copy_buffer);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            mbedtls_sha256_update_ret(&sha_ctx, copy_buffer, piece);
+        }
+    }
+
+    mbedtls_sha256_finish_ret(&sha_ctx, digest);
+    mbedtls_sha256_free(&sha_ctx);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: copy_flash
+ *******************************************************************************
+ * Summary:
+ *  Copies an area of the external flash to another one, which must be
+ *  erased.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the flash reads and writes.
+ *
+ *******************************************************************************/
+static cy_rslt_t copy_flash(uint32_t dest, uint32_t src, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t done;
+    uint32_t piece;
+
+    for (done = 0; (CY_RSLT_SUCCESS == result) && (done < length); done += piece)
+    {
+        piece = length - done;
+        piece = (piece > DELTA_SYNC_COPY_SIZE) ? DELTA_SYNC_COPY_SIZE : piece;
+        result = cy_serial_flash_qspi_read(src + done, piece, copy_buffer);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = cy_serial_flash_qspi_write(dest + done, piece, copy_buffer);
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: fetch_http
+ *******************************************************************************
+ * Summary:
+ *  Fetch function of a resource on the HTTPS server. Each piece is one Range
+ *  request received into the fetch buffer.
+ *
+ *******************************************************************************/
+static cy_rslt_t fetch_http(void *arg, bool manifest, uint32_t offset, uint32_t length,
+                            fetch_result_t *result)
+{
+    http_source_t *source = (http_source_t *)arg;
+    cy_http_client_response_t response;
+    cy_http_client_header_t accept;
+    cy_rslt_t status;
+
+    accept.field = "Accept";
+    accept.field_len = sizeof("Accept") - 1;
+    accept.value = "application/octet-stream";
+    accept.value_len = sizeof("application/octet-stream") - 1;
+
+    status = https_get_range(source->handle, manifest ? source->manifest_path : source->path,
+                             &accept, NUM_HTTP_HEADERS, fetch_buffer, sizeof(fetch_buffer),
+                             offset, length, &response);
+    if (CY_RSLT_SUCCESS != status)
+    {
+        return status;
+    }
+
+    result->data = response.body;
+    result->length = (uint32_t)response.body_len;
+    result->total_len = (HTTP_STATUS_OK == response.status_code) ?
+                        (uint32_t)response.body_len : https_content_range_total(source->handle, &response);
+    result->wire_len = (uint32_t)(response.headers_len + response.body_len);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: fetch_bench
+ *******************************************************************************
+ * Summary:
+ *  Fetch function of the simulated origin of the benchmark. The manifest
+ *  comes from bench_manifest and the blocks are generated with their edits.
+ *
+ *******************************************************************************/
+static cy_rslt_t fetch_bench(void *arg, bool manifest, uint32_t offset, uint32_t length,
+                             fetch_result_t *result)
+{
+    if (manifest)
+    {
+        if (offset >= sizeof(bench_manifest))
+        {
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        length = (length > (sizeof(bench_manifest) - offset)) ? (sizeof(bench_manifest) - offset) : length;
+        result->data = &bench_manifest[offset];
+        result->total_len = sizeof(bench_manifest);
+    }
+    else
+    {
+        if ((length > DELTA_SYNC_FETCH_SIZE) || ((offset + length) > DELTA_SYNC_BENCH_SIZE))
+        {
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        bench_fill(fetch_buffer, offset, length, true);
+        result->data = fetch_buffer;
+        result->total_len = DELTA_SYNC_BENCH_SIZE;
+    }
+
+    result->length = length;
+    result->wire_len = length + DELTA_SYNC_SIM_RESPONSE_HEAD;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: bench_fill
+ *******************************************************************************
+ * Summary:
+ *  Generates a piece of the benchmark resource. Every edited block of the
+ *  round differs from the base resource in DELTA_SYNC_BENCH_EDIT_LEN bytes
+ *  at a position that depends on the block and the round.
+ *
+ *******************************************************************************/
+static void bench_fill(uint8_t *dest, uint32_t offset, uint32_t length, bool edited)
+{
+    uint32_t position;
+    uint32_t block;
+    uint32_t in_block;
+    uint32_t edit_start;
+    uint32_t word;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        position = offset + i;
+        block = position / DELTA_SYNC_BENCH_BLOCK_SIZE;
+        in_block = position % DELTA_SYNC_BENCH_BLOCK_SIZE;
+        word = position / 4u;
+
+        if (edited && (0u != (bench_edited[block / 8u] & (1u << (block % 8u)))))
+        {
+            edit_start = bench_mix(block ^ (bench_round << 16)) %
+                         (DELTA_SYNC_BENCH_BLOCK_SIZE - DELTA_SYNC_BENCH_EDIT_LEN);
+            if ((in_block >= edit_start) && (in_block < (edit_start + DELTA_SYNC_BENCH_EDIT_LEN)))
+            {
+                word ^= bench_round * 0x9E3779B9u;
+            }
+        }
+
+        dest[i] = (uint8_t)(bench_mix(word) >> (8u * (position % 4u)));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: bench_write_base
+ *******************************************************************************
+ * Summary:
+ *  Writes the base benchmark resource, without edits, as the local copy.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the flash operations.
+ *
+ *******************************************************************************/
+static cy_rslt_t bench_write_base(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t sector_size = (uint32_t)cy_serial_flash_qspi_get_erase_size(DELTA_SYNC_BENCH_ADDRESS);
+    uint32_t done;
+    uint32_t piece;
+
+    for (done = 0; (CY_RSLT_SUCCESS == result) && (done < DELTA_SYNC_BENCH_SIZE); done += sector_size)
+    {
+        result = cy_serial_flash_qspi_erase(DELTA_SYNC_BENCH_ADDRESS + done, sector_size);
+    }
+
+    for (done = 0; (CY_RSLT_SUCCESS == result) && (done < DELTA_SYNC_BENCH_SIZE); done += piece)
+    {
+        piece = DELTA_SYNC_BENCH_SIZE - done;
+        piece = (piece > DELTA_SYNC_FETCH_SIZE) ? DELTA_SYNC_FETCH_SIZE : piece;
+        bench_fill(fetch_buffer, done, piece, false);
+        result = cy_serial_flash_qspi_write(DELTA_SYNC_BENCH_ADDRESS + done, piece, fetch_buffer);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: bench_prepare
+ *******************************************************************************
+ * Summary:
+ *  Starts a benchmark round: picks the given share of the blocks, in
+ *  permille, to carry an edit, and publishes the manifest of the edited
+ *  resource.
+ *
+ *******************************************************************************/
+static void bench_prepare(uint32_t permille)
+{
+    mbedtls_sha256_context whole_ctx;
+    mbedtls_sha256_context block_ctx;
+    manifest_header_t header;
+    uint8_t digest[FLASH_DOWNLOAD_SHA256_LEN];
+    uint32_t count = ((BENCH_BLOCKS * permille) + 500u) / 1000u;
+    uint32_t block;
+
+    bench_round++;
+    memset(bench_edited, 0, sizeof(bench_edited));
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        do
+        {
+            block = xorshift_next(&random_state) % BENCH_BLOCKS;
+        } while (0u != (bench_edited[block / 8u] & (1u << (block % 8u))));
+
+        bench_edited[block / 8u] |= (uint8_t)(1u << (block % 8u));
+    }
+
+    mbedtls_sha256_init(&whole_ctx);
+    mbedtls_sha256_starts_ret(&whole_ctx, 0);
+
+    for (block = 0; block < BENCH_BLOCKS; block++)
+    {
+        bench_fill(fetch_buffer, block * DELTA_SYNC_BENCH_BLOCK_SIZE, DELTA_SYNC_BENCH_BLOCK_SIZE, true);
+        mbedtls_sha256_update_ret(&whole_ctx, fetch_buffer, DELTA_SYNC_BENCH_BLOCK_SIZE);
+
+        mbedtls_sha256_init(&block_ctx);
+        mbedtls_sha256_starts_ret(&block_ctx, 0);
+        mbedtls_sha256_update_ret(&block_ctx, fetch_buffer, DELTA_SYNC_BENCH_BLOCK_SIZE);
+        mbedtls_sha256_finish_ret(&block_ctx, digest);
+        mbedtls_sha256_free(&block_ctx);
+
+        memcpy(&bench_manifest[sizeof(header) + (block * DELTA_SYNC_BLOCK_HASH_LEN)], digest,
+               DELTA_SYNC_BLOCK_HASH_LEN);
+    }
+
+    header.magic = DELTA_SYNC_MANIFEST_MAGIC;
+    header.block_size = DELTA_SYNC_BENCH_BLOCK_SIZE;
+    header.total_len = DELTA_SYNC_BENCH_SIZE;
+    mbedtls_sha256_finish_ret(&whole_ctx, header.sha256);
+    mbedtls_sha256_free(&whole_ctx);
+
+    memcpy(bench_manifest, &header, sizeof(header));
+}
+
+/*******************************************************************************
+ * Function Name: bench_mix
+ *******************************************************************************
+ * Summary:
+ *  Returns a well-mixed value of its argument. The mixing is a bijection, so
+ *  different words of the resource never generate the same bytes.
+ *
+ *******************************************************************************/
+static uint32_t bench_mix(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
+
+    return value;
+}
+
+/* [] END OF FILE */
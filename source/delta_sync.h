@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name: delta_sync.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the delta sync, which updates a resource stored in the
+* external flash by fetching only the blocks that changed on the server.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef DELTA_SYNC_H_
+#define DELTA_SYNC_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* The block-hash manifest of a resource is published next to it, at the
+ * resource path followed by this suffix. It holds a header with the block
+ * size, the resource length, and the SHA-256 digest of the whole resource,
+ * followed by the first DELTA_SYNC_BLOCK_HASH_LEN bytes of the SHA-256 digest
+ * of every block. All the fields are little endian.
+ */
+#define DELTA_SYNC_MANIFEST_SUFFIX               ".blocks"
+#define DELTA_SYNC_MANIFEST_MAGIC                (0x314D4842UL)
+#define DELTA_SYNC_BLOCK_HASH_LEN                (16)
+
+/* Limits on the manifest. The block size must divide the erase sector size,
+ * so a block never straddles two sectors. Blocks as large as the erase
+ * sector avoid the copy through the scratch sector on hybrid-sector parts.
+ */
+#define DELTA_SYNC_MIN_BLOCK_SIZE                (512u)
+#define DELTA_SYNC_MAX_BLOCKS                    (4096u)
+
+/* Body of one Range request. Adjacent changed blocks are fetched together
+ * up to this size. The buffer also holds the response headers.
+ */
+#define DELTA_SYNC_FETCH_SIZE                    (8 * 1024)
+#define DELTA_SYNC_HEADER_SPACE                  (1024)
+
+/* Piece of the flash read at once to hash or copy it. */
+#define DELTA_SYNC_COPY_SIZE                     (1024)
+
+/* Erase sector used to rebuild a sector in which only some blocks changed.
+ * It sits in the last 256 KB before the offline queue, and the resources
+ * synced must end before it.
+ */
+#define DELTA_SYNC_SCRATCH_ADDRESS               (0x00FC0000UL)
+
+/* "Delta sync" menu option: a resource of the given size is written to the
+ * flash, and then synced with versions of it in which the given share of the
+ * blocks, in permille, carries a small edit. The origin is simulated and the
+ * transfers are timed on a link of the given rate and round trip time.
+ */
+#define DELTA_SYNC_BENCH_ADDRESS                 (0x00E00000UL)
+#define DELTA_SYNC_BENCH_SIZE                    (1024u * 1024u)
+#define DELTA_SYNC_BENCH_BLOCK_SIZE              (4096u)
+#define DELTA_SYNC_BENCH_EDIT_LEN                (64u)
+#define DELTA_SYNC_BENCH_RATES                   { 10u, 100u, 500u }
+#define DELTA_SYNC_SIM_LINK_KBPS                 (2000u)
+#define DELTA_SYNC_SIM_RTT_MS                    (50u)
+#define DELTA_SYNC_SIM_RESPONSE_HEAD             (200u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Statistics of a single sync. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t total_len;          /* Length of the resource on the server. */
+    uint32_t block_size;
+    uint32_t num_blocks;
+    uint32_t changed_blocks;     /* Blocks whose hash differed from the local copy. */
+    uint32_t requests;           /* Range requests, those of the manifest included. */
+    uint32_t manifest_bytes;
+    uint32_t block_bytes;        /* Bytes of the changed blocks received. */
+    uint32_t received_bytes;     /* All the response bytes, headers included. */
+    uint32_t sectors_patched;    /* Erase sectors rewritten. */
+    uint32_t sectors_copied;     /* Sectors rewritten through the scratch sector. */
+    uint32_t hash_ms;            /* Hashing of the local copy, before and after. */
+    uint32_t network_ms;         /* Waiting for the responses. */
+    uint32_t flash_ms;           /* Erasing, programming, and copying. */
+    uint32_t elapsed_ms;
+} delta_sync_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t delta_sync(cy_http_client_t handle, const char *path, uint32_t flash_addr,
+                     delta_sync_stats_t *stats);
+void delta_sync_print_stats(const delta_sync_stats_t *stats);
+void delta_sync_benchmark(void);
+
+#endif /* DELTA_SYNC_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,589 @@
+/******************************************************************************
+* File Name: dtls_transport.c
+*
+* Description: This file contains the DTLS 1.2 transport. mbedtls runs the
+* DTLS protocol over a UDP socket of the secure sockets library, with the
+* credentials of secure_keys.h. The session is kept after a close, so the
+* next connection resumes it with an abbreviated handshake.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "secure_keys.h"
+#include "dtls_transport.h"
+#include "wifi_power.h"
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Returned by the socket callbacks when the socket fails. */
+#define DTLS_SOCKET_ERROR                (MBEDTLS_ERR_SSL_INTERNAL_ERROR)
+
+/* Personalization of the random generator. */
+#define DTLS_DRBG_PERSONALIZATION        "dtls_transport"
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char client_certificate[] = keyCLIENT_CERTIFICATE_PEM;
+static const char client_private_key[] = keyCLIENT_PRIVATE_KEY_PEM;
+static const char server_root_ca[] = keySERVER_ROOTCA_PEM;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t setup_config(dtls_transport_t *transport);
+static cy_rslt_t set_socket_timeout(dtls_transport_t *transport, uint32_t timeout_ms);
+static int socket_send(void *ctx, const unsigned char *buffer, size_t length);
+static int socket_recv(void *ctx, unsigned char *buffer, size_t length, uint32_t timeout_ms);
+static void timer_set(void *ctx, uint32_t intermediate_ms, uint32_t final_ms);
+static int timer_get(void *ctx);
+
+/*******************************************************************************
+ * Function Name: dtls_transport_connect
+ *******************************************************************************
+ * Summary:
+ *  Resolves the server and completes a DTLS handshake with it. The server
+ *  certificate is verified against the root CA. When a session was kept
+ *  from the previous connection it is offered for resumption, which skips
+ *  the certificates and the key exchange. The credentials are parsed on the
+ *  first connection only. The radio is kept awake during the handshake, and
+ *  then only while a record is sent or awaited, so an idle association lets
+ *  it save power.
+ *
+ * Parameters:
+ *  transport - Transport, zeroed before its first connection.
+ *  host - Host name or address of the server.
+ *  port - UDP port of the server.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the handshake completed, otherwise,
+ *  the error of the secure sockets library or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t dtls_transport_connect(dtls_transport_t *transport, const char *host, uint16_t port)
+{
+    cy_rslt_t result;
+    TickType_t start_ticks = xTaskGetTickCount();
+    int ret;
+
+    if (transport->connected)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    if (!transport->initialized)
+    {
+        result = setup_config(transport);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+    }
+    else
+    {
+        (void)mbedtls_ssl_session_reset(&transport->ssl);
+    }
+
+    wifi_power_begin();
+
+    memset(&transport->peer, 0, sizeof(transport->peer));
+    result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &transport->peer.ip_address);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to resolve %s: 0x%08lx\n", host, (unsigned long)result));
+        wifi_power_end();
+        return result;
+    }
+    transport->peer.port = port;
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP,
+                              &transport->socket);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to create a UDP socket: 0x%08lx\n", (unsigned long)result));
+        wifi_power_end();
+        return result;
+    }
+    transport->timeout_ms = 0;
+
+    transport->stats.resumed = transport->has_session;
+    if (transport->has_session)
+    {
+        (void)mbedtls_ssl_set_session(&transport->ssl, &transport->session);
+    }
+
+    do
+    {
+        ret = mbedtls_ssl_handshake(&transport->ssl);
+    } while ((MBEDTLS_ERR_SSL_WANT_READ == ret) || (MBEDTLS_ERR_SSL_WANT_WRITE == ret));
+
+    wifi_power_end();
+
+    if (0 != ret)
+    {
+        ERR_INFO(("The DTLS handshake with %s:%u failed: -0x%04x\n", host, port, (unsigned int)-ret));
+        (void)cy_socket_delete(transport->socket);
+        transport->socket = NULL;
+
+        /* A session the server no longer knows is not offered again. */
+        if (transport->has_session)
+        {
+            mbedtls_ssl_session_free(&transport->session);
+            transport->has_session = false;
+        }
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (transport->has_session)
+    {
+        mbedtls_ssl_session_free(&transport->session);
+    }
+    mbedtls_ssl_session_init(&transport->session);
+    transport->has_session = (0 == mbedtls_ssl_get_session(&transport->ssl, &transport->session));
+
+    transport->connected = true;
+    transport->stats.handshake_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dtls_transport_send
+ *******************************************************************************
+ * Summary:
+ *  Sends data as one DTLS record in one datagram.
+ *
+ * Parameters:
+ *  transport - Connected transport.
+ *  data - Data to send.
+ *  length - Number of bytes, at most the record size of mbedtls.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the datagram was sent, otherwise,
+ *  CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t dtls_transport_send(dtls_transport_t *transport, const uint8_t *data, uint32_t length)
+{
+    int ret;
+
+    if (!transport->connected)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    wifi_power_begin();
+    do
+    {
+        ret = mbedtls_ssl_write(&transport->ssl, data, length);
+    } while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+    wifi_power_end();
+
+    if (ret != (int)length)
+    {
+        ERR_INFO(("DTLS write failed: -0x%04x\n", (unsigned int)-ret));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dtls_transport_recv
+ *******************************************************************************
+ * Summary:
+ *  Receives the data of one DTLS record.
+ *
+ * Parameters:
+ *  transport - Connected transport.
+ *  buffer - Receives the data.
+ *  size - Size of the buffer.
+ *  timeout_ms - Longest time to wait.
+ *  received - Number of bytes received.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT
+ *  if nothing arrived in time, CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED if the
+ *  server closed the association, or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t dtls_transport_recv(dtls_transport_t *transport, uint8_t *buffer, uint32_t size,
+                              uint32_t timeout_ms, uint32_t *received)
+{
+    int ret;
+
+    *received = 0;
+
+    if (!transport->connected)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    mbedtls_ssl_conf_read_timeout(&transport->config, timeout_ms);
+
+    wifi_power_begin();
+    do
+    {
+        ret = mbedtls_ssl_read(&transport->ssl, buffer, size);
+    } while ((MBEDTLS_ERR_SSL_WANT_READ == ret) || (MBEDTLS_ERR_SSL_WANT_WRITE == ret));
+    wifi_power_end();
+
+    if (ret > 0)
+    {
+        *received = (uint32_t)ret;
+        return CY_RSLT_SUCCESS;
+    }
+
+    if (MBEDTLS_ERR_SSL_TIMEOUT == ret)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+    }
+
+    if ((MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY == ret) || (0 == ret))
+    {
+        transport->connected = false;
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    ERR_INFO(("DTLS read failed: -0x%04x\n", (unsigned int)-ret));
+    return CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: dtls_transport_close
+ *******************************************************************************
+ * Summary:
+ *  Sends the close notification and deletes the socket. The credentials
+ *  stay parsed for the next connection.
+ *
+ * Parameters:
+ *  transport - Transport.
+ *  keep_session - Keep the session to resume it on the next connection.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void dtls_transport_close(dtls_transport_t *transport, bool keep_session)
+{
+    if (transport->connected)
+    {
+        (void)mbedtls_ssl_close_notify(&transport->ssl);
+        transport->connected = false;
+    }
+
+    if (NULL != transport->socket)
+    {
+        (void)cy_socket_delete(transport->socket);
+        transport->socket = NULL;
+    }
+
+    if (!keep_session && transport->has_session)
+    {
+        mbedtls_ssl_session_free(&transport->session);
+        transport->has_session = false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: setup_config
+ *******************************************************************************
+ * Summary:
+ *  Seeds the random generator, parses the credentials, and configures the
+ *  DTLS client with mutual authentication.
+ *
+ *******************************************************************************/
+static cy_rslt_t setup_config(dtls_transport_t *transport)
+{
+    int ret;
+
+    mbedtls_ssl_init(&transport->ssl);
+    mbedtls_ssl_config_init(&transport->config);
+    mbedtls_ctr_drbg_init(&transport->drbg);
+    mbedtls_entropy_init(&transport->entropy);
+    mbedtls_x509_crt_init(&transport->root_ca);
+    mbedtls_x509_crt_init(&transport->certificate);
+    mbedtls_pk_init(&transport->private_key);
+
+    /* The PEM buffers include their terminating NUL, as mbedtls requires. */
+    ret = mbedtls_ctr_drbg_seed(&transport->drbg, mbedtls_entropy_func, &transport->entropy,
+                                (const unsigned char *)DTLS_DRBG_PERSONALIZATION,
+                                sizeof(DTLS_DRBG_PERSONALIZATION) - 1u);
+    if (0 == ret)
+    {
+        ret = mbedtls_x509_crt_parse(&transport->root_ca, (const unsigned char *)server_root_ca,
+                                     sizeof(server_root_ca));
+    }
+    if (0 == ret)
+    {
+        ret = mbedtls_x509_crt_parse(&transport->certificate, (const unsigned char *)client_certificate,
+                                     sizeof(client_certificate));
+    }
+    if (0 == ret)
+    {
+        ret = mbedtls_pk_parse_key(&transport->private_key, (const unsigned char *)client_private_key,
+                                   sizeof(client_private_key), NULL, 0);
+    }
+    if (0 == ret)
+    {
+        ret = mbedtls_ssl_config_defaults(&transport->config, MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_DATAGRAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (0 == ret)
+    {
+        mbedtls_ssl_conf_authmode(&transport->config, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&transport->config, &transport->root_ca, NULL);
+        mbedtls_ssl_conf_rng(&transport->config, mbedtls_ctr_drbg_random, &transport->drbg);
+        mbedtls_ssl_conf_handshake_timeout(&transport->config, DTLS_HANDSHAKE_TIMEOUT_MIN_MS,
+                                           DTLS_HANDSHAKE_TIMEOUT_MAX_MS);
+        ret = mbedtls_ssl_conf_own_cert(&transport->config, &transport->certificate, &transport->private_key);
+    }
+    if (0 == ret)
+    {
+        ret = mbedtls_ssl_setup(&transport->ssl, &transport->config);
+    }
+
+    if (0 != ret)
+    {
+        ERR_INFO(("Failed to set up DTLS: -0x%04x\n", (unsigned int)-ret));
+        mbedtls_ssl_free(&transport->ssl);
+        mbedtls_ssl_config_free(&transport->config);
+        mbedtls_ctr_drbg_free(&transport->drbg);
+        mbedtls_entropy_free(&transport->entropy);
+        mbedtls_x509_crt_free(&transport->root_ca);
+        mbedtls_x509_crt_free(&transport->certificate);
+        mbedtls_pk_free(&transport->private_key);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_set_bio(&transport->ssl, transport, socket_send, NULL, socket_recv);
+    mbedtls_ssl_set_timer_cb(&transport->ssl, transport, timer_set, timer_get);
+    transport->initialized = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: set_socket_timeout
+ *******************************************************************************
+ * Summary:
+ *  Sets the receive timeout of the socket if it changed.
+ *
+ *******************************************************************************/
+static cy_rslt_t set_socket_timeout(dtls_transport_t *transport, uint32_t timeout_ms)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (timeout_ms != transport->timeout_ms)
+    {
+        result = cy_socket_setsockopt(transport->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO,
+                                      &timeout_ms, sizeof(timeout_ms));
+        if (CY_RSLT_SUCCESS == result)
+        {
+            transport->timeout_ms = timeout_ms;
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: socket_send
+ *******************************************************************************
+ * Summary:
+ *  Sends a datagram of mbedtls to the server.
+ *
+ *******************************************************************************/
+static int socket_send(void *ctx, const unsigned char *buffer, size_t length)
+{
+    dtls_transport_t *transport = (dtls_transport_t *)ctx;
+    uint32_t sent = 0;
+
+    if (CY_RSLT_SUCCESS != cy_socket_sendto(transport->socket, buffer, (uint32_t)length, CY_SOCKET_FLAGS_NONE,
+                                            &transport->peer, sizeof(transport->peer), &sent))
+    {
+        return DTLS_SOCKET_ERROR;
+    }
+
+    transport->stats.datagrams_sent++;
+    transport->stats.bytes_sent += sent;
+
+    return (int)sent;
+}
+
+/*******************************************************************************
+ * Function Name: socket_recv
+ *******************************************************************************
+ * Summary:
+ *  Receives a datagram from the server for mbedtls. Datagrams from other
+ *  addresses are dropped. A timeout of 0 waits forever.
+ *
+ *******************************************************************************/
+static int socket_recv(void *ctx, unsigned char *buffer, size_t length, uint32_t timeout_ms)
+{
+    dtls_transport_t *transport = (dtls_transport_t *)ctx;
+    cy_socket_sockaddr_t source;
+    uint32_t source_length;
+    uint32_t received;
+    cy_rslt_t result;
+
+    if (CY_RSLT_SUCCESS != set_socket_timeout(transport, (0u == timeout_ms) ? CY_SOCKET_NEVER_TIMEOUT : timeout_ms))
+    {
+        return DTLS_SOCKET_ERROR;
+    }
+
+    do
+    {
+        source_length = sizeof(source);
+        received = 0;
+        result = cy_socket_recvfrom(transport->socket, buffer, (uint32_t)length, CY_SOCKET_FLAGS_NONE,
+                                    &source, &source_length, &received);
+        if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            return MBEDTLS_ERR_SSL_TIMEOUT;
+        }
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return DTLS_SOCKET_ERROR;
+        }
+    } while ((source.port != transport->peer.port) ||
+             (source.ip_address.ip.v4 != transport->peer.ip_address.ip.v4));
+
+    transport->stats.datagrams_received++;
+    transport->stats.bytes_received += received;
+
+    return (int)received;
+}
+
+/*******************************************************************************
+ * Function Name: timer_set
+ *******************************************************************************
+ * Summary:
+ *  Starts the retransmission timer of mbedtls, or stops it when the final
+ *  delay is 0.
+ *
+ *******************************************************************************/
+static void timer_set(void *ctx, uint32_t intermediate_ms, uint32_t final_ms)
+{
+    dtls_transport_t *transport = (dtls_transport_t *)ctx;
+
+    transport->timer_start = xTaskGetTickCount();
+    transport->timer_intermediate_ms = intermediate_ms;
+    transport->timer_final_ms = final_ms;
+}
+
+/*******************************************************************************
+ * Function Name: timer_get
+ *******************************************************************************
+ * Summary:
+ *  Returns -1 if the timer is stopped, 0 before the intermediate delay, 1
+ *  after it, and 2 after the final delay.
+ *
+ *******************************************************************************/
+static int timer_get(void *ctx)
+{
+    dtls_transport_t *transport = (dtls_transport_t *)ctx;
+    uint32_t elapsed_ms;
+
+    if (0u == transport->timer_final_ms)
+    {
+        return -1;
+    }
+
+    elapsed_ms = (uint32_t)(xTaskGetTickCount() - transport->timer_start) * portTICK_PERIOD_MS;
+
+    if (elapsed_ms >= transport->timer_final_ms)
+    {
+        return 2;
+    }
+
+    return (elapsed_ms >= transport->timer_intermediate_ms) ? 1 : 0;
+}
+
+#else /* MBEDTLS_SSL_PROTO_DTLS */
+
+/* DTLS is not enabled in the mbedtls configuration, for example because
+ * configs/mbedtls_user_config.h is not on the include path.
+ */
+cy_rslt_t dtls_transport_connect(dtls_transport_t *transport, const char *host, uint16_t port)
+{
+    (void)transport;
+    ERR_INFO(("DTLS to %s:%u needs MBEDTLS_SSL_PROTO_DTLS, see configs/mbedtls_user_config.h.\n", host, port));
+    return CY_RSLT_TYPE_ERROR;
+}
+
+cy_rslt_t dtls_transport_send(dtls_transport_t *transport, const uint8_t *data, uint32_t length)
+{
+    (void)transport;
+    (void)data;
+    (void)length;
+    return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+}
+
+cy_rslt_t dtls_transport_recv(dtls_transport_t *transport, uint8_t *buffer, uint32_t size,
+                              uint32_t timeout_ms, uint32_t *received)
+{
+    (void)transport;
+    (void)buffer;
+    (void)size;
+    (void)timeout_ms;
+    *received = 0;
+    return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+}
+
+void dtls_transport_close(dtls_transport_t *transport, bool keep_session)
+{
+    (void)transport;
+    (void)keep_session;
+}
+
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
+/* [] END OF FILE */
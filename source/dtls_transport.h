@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name: dtls_transport.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the DTLS 1.2 transport.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef DTLS_TRANSPORT_H_
+#define DTLS_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "cy_secure_sockets.h"
+#include "FreeRTOS.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Retransmission timeout of the handshake flights: the first wait, doubled
+ * after each retransmission up to the maximum (RFC 6347, 4.2.4.1).
+ */
+#define DTLS_HANDSHAKE_TIMEOUT_MIN_MS            (1000u)
+#define DTLS_HANDSHAKE_TIMEOUT_MAX_MS            (16000u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Counters of a transport. Datagrams and bytes include the handshakes. */
+typedef struct
+{
+    uint32_t datagrams_sent;
+    uint32_t datagrams_received;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t handshake_ms;       /* Last handshake. */
+    bool resumed;                /* The last handshake offered a saved session. */
+} dtls_transport_stats_t;
+
+/* A DTLS association with one server over a UDP socket. The session of the
+ * last handshake is kept for resumption after dtls_transport_close().
+ */
+typedef struct
+{
+    cy_socket_t socket;
+    cy_socket_sockaddr_t peer;
+    bool connected;
+    bool initialized;
+    uint32_t timeout_ms;
+
+    /* Retransmission timer of mbedtls. */
+    TickType_t timer_start;
+    uint32_t timer_intermediate_ms;
+    uint32_t timer_final_ms;
+
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config config;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_entropy_context entropy;
+    mbedtls_x509_crt root_ca;
+    mbedtls_x509_crt certificate;
+    mbedtls_pk_context private_key;
+
+    mbedtls_ssl_session session;
+    bool has_session;
+
+    dtls_transport_stats_t stats;
+} dtls_transport_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t dtls_transport_connect(dtls_transport_t *transport, const char *host, uint16_t port);
+cy_rslt_t dtls_transport_send(dtls_transport_t *transport, const uint8_t *data, uint32_t length);
+cy_rslt_t dtls_transport_recv(dtls_transport_t *transport, uint8_t *buffer, uint32_t size,
+                              uint32_t timeout_ms, uint32_t *received);
+void dtls_transport_close(dtls_transport_t *transport, bool keep_session);
+
+#endif /* DTLS_TRANSPORT_H_ */
+
+
+/* [] END OF FILE */
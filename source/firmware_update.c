@@ -0,0 +1,1014 @@
+/******************************************************************************
+* File Name: firmware_update.c
+*
+* Description: This file contains the firmware update. A bsdiff patch of the
+* running image is downloaded with the HTTPS client and applied as it
+* arrives: the new image is written to the secondary slot in the external
+* flash and hashed on the way, with memory that does not depend on the size
+* of the image or of the patch.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_serial_flash_qspi.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* mbedTLS header file for the SHA-256 digest */
+#include "mbedtls/sha256.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "flash_download.h"
+#include "inflater.h"
+#include "deflater.h"
+#include "cycle_counter.h"
+#include "xorshift.h"
+#include "firmware_update.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define PATCH_CONTROL_LENGTH             (12u)
+
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+#define CYCLES_TO_MS(cycles)             ((uint32_t)((cycles) / (SystemCoreClock / 1000u)))
+
+/* Piece of the benchmark patch or image generated at once. */
+#define BENCH_PIECE_SIZE                 (1024u)
+
+/* Fields of the MCUboot image trailer, counted back from the end of the
+ * slot. A permanent swap is requested, since the new image does not
+ * confirm itself after a test swap and would be reverted.
+ */
+#define TRAILER_END                      (FIRMWARE_UPDATE_SLOT_ADDRESS + FIRMWARE_UPDATE_SLOT_SIZE)
+#define TRAILER_MAGIC_LENGTH             (16u)
+#define TRAILER_MAGIC_ADDRESS            (TRAILER_END - TRAILER_MAGIC_LENGTH)
+#define TRAILER_IMAGE_OK_ADDRESS         (TRAILER_MAGIC_ADDRESS - FIRMWARE_UPDATE_TRAILER_ALIGN)
+#define TRAILER_COPY_DONE_ADDRESS        (TRAILER_IMAGE_OK_ADDRESS - FIRMWARE_UPDATE_TRAILER_ALIGN)
+#define TRAILER_SWAP_INFO_ADDRESS        (TRAILER_COPY_DONE_ADDRESS - FIRMWARE_UPDATE_TRAILER_ALIGN)
+#define TRAILER_SWAP_TYPE_PERM           (0x03u)
+#define TRAILER_FLAG_SET                 (0x01u)
+#define TRAILER_ERASED                   (0xFFu)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    PATCH_HEADER,
+    PATCH_CONTROL,
+    PATCH_DIFF,
+    PATCH_EXTRA,
+    PATCH_DONE,
+    PATCH_FAILED,
+} patch_state_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Header of a patch. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t old_size;
+    uint32_t new_size;
+    uint8_t  old_sha256[FIRMWARE_UPDATE_SHA256_LEN];
+    uint8_t  new_sha256[FIRMWARE_UPDATE_SHA256_LEN];
+} patch_header_t;
+
+/* State of the patch being applied. */
+typedef struct
+{
+    patch_state_t state;
+    const uint8_t *old_image;
+    patch_header_t header;
+    uint8_t control[PATCH_CONTROL_LENGTH];
+    uint32_t fill;               /* Bytes of the header or of the control received. */
+    uint32_t diff_left;
+    uint32_t extra_left;
+    int32_t seek;
+    uint32_t old_pos;
+    uint32_t new_pos;
+    uint32_t erased_until;
+    uint64_t flash_cycles;
+    uint8_t program[FIRMWARE_UPDATE_PROGRAM_SIZE];
+    uint32_t program_len;
+    mbedtls_sha256_context sha_ctx;
+    firmware_update_stats_t *stats;
+} patch_applier_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static patch_applier_t applier;
+
+/* Magic of an MCUboot image trailer, as four little-endian words. */
+static const uint32_t trailer_magic[TRAILER_MAGIC_LENGTH / sizeof(uint32_t)] =
+{
+    0xF395C277UL, 0x7FEFD260UL, 0x0F505235UL, 0x8079B62CUL
+};
+
+/* Benchmark: the encoder standing in for the server, the decoder of the
+ * device, and the changes that make the new image.
+ */
+static deflater_t bench_deflater;
+static inflater_t bench_inflater;
+static uint8_t bench_window[FIRMWARE_UPDATE_BENCH_WINDOW_SIZE];
+static uint8_t bench_piece[BENCH_PIECE_SIZE];
+static uint32_t bench_insert_at;
+static uint32_t bench_edits[FIRMWARE_UPDATE_BENCH_EDITS];
+static uint32_t bench_encoded;
+static uint64_t bench_device_cycles;
+static uint32_t random_state = 0x1B873593u;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void patch_start(const uint8_t *old_image, firmware_update_stats_t *stats);
+static bool patch_feed(const uint8_t *data, size_t length);
+static cy_rslt_t patch_finish(void);
+static cy_rslt_t write_trailer_field(uint32_t addr, uint8_t value);
+static cy_rslt_t request_swap(void);
+static bool check_header(void);
+static bool start_record(void);
+static void end_record(void);
+static bool emit_byte(uint8_t value);
+static bool flush_program(void);
+static void fail_patch(const char *reason);
+static bool feed_body(const uint8_t *data, uint32_t length, void *arg);
+static bool feed_decoded(const uint8_t *data, size_t length, void *arg);
+static bool decode_bench_patch(const uint8_t *data, size_t length, void *arg);
+static bool count_encoded(const uint8_t *data, size_t length, void *arg);
+static bool bench_encode(const uint8_t *data, uint32_t length);
+static uint8_t bench_new_byte(uint32_t position);
+static void bench_fill_new(uint8_t *dest, uint32_t position, uint32_t length);
+static void bench_put_control(uint32_t diff_len, uint32_t extra_len, int32_t seek);
+static void bench_put_diff(uint32_t new_pos, uint32_t old_pos, uint32_t length);
+static uint32_t bench_mix(uint32_t value);
+
+/*******************************************************************************
+ * Function Name: firmware_update_apply
+ *******************************************************************************
+ * Summary:
+ *  Downloads a patch of the running image and applies it into the secondary
+ *  slot as it arrives. The patch is checked against the digest of the
+ *  running image before anything is written, and the new image against the
+ *  digest in the patch once the last byte is written. The image trailer of
+ *  the slot is erased before the image is written and, once the digest
+ *  matched, written with a permanent swap request, so the bootloader
+ *  installs the image at the next reset.
+ *
+ * Parameters:
+ *  path - Patch path on the server.
+ *  stats - Filled with the statistics of the update.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the new image is staged in the
+ *  secondary slot and its swap is requested, otherwise, it returns an HTTP client, serial flash, or
+ *  CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+cy_rslt_t firmware_update_apply(const char *path, firmware_update_stats_t *stats)
+{
+    cy_rslt_t result;
+    cy_rslt_t finish_result;
+    https_stream_stats_t stream_stats;
+    TickType_t start;
+
+    if ((NULL == path) || (NULL == stats))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    start = xTaskGetTickCount();
+    patch_start((const uint8_t *)FIRMWARE_UPDATE_PRIMARY_ADDRESS, stats);
+
+    result = https_stream_get(path, "application/octet-stream", true, NULL, feed_body, NULL, &stream_stats);
+
+    finish_result = patch_finish();
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = finish_result;
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = request_swap();
+    }
+
+    stats->requests = stream_stats.requests;
+    stats->wire_bytes = stream_stats.wire_bytes;
+    stats->elapsed_ms = TICKS_TO_MS(xTaskGetTickCount() - start);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: firmware_update_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the sizes, the time, and the digest of an update.
+ *
+ * Parameters:
+ *  stats - Statistics filled by firmware_update_apply().
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void firmware_update_print_stats(const firmware_update_stats_t *stats)
+{
+    printf("\r\n Patch of %lu bytes (%lu decoded) in %lu requests, %lu records\r\n",
+           (unsigned long)stats->wire_bytes, (unsigned long)stats->patch_bytes,
+           (unsigned long)stats->requests, (unsigned long)stats->records);
+    printf(" New image of %lu bytes in %lu ms, %lu ms of them in the flash\r\n",
+           (unsigned long)stats->image_bytes, (unsigned long)stats->elapsed_ms, (unsigned long)stats->flash_ms);
+    printf(" SHA-256 ");
+    for (uint32_t i = 0; i < FIRMWARE_UPDATE_SHA256_LEN; i++)
+    {
+        printf("%02x", stats->sha256[i]);
+    }
+    printf("\r\n");
+}
+
+/*******************************************************************************
+ * Function Name: firmware_update_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Makes a new image from the first FIRMWARE_UPDATE_BENCH_IMAGE_SIZE bytes
+ *  of the running image, encodes its patch as the server would, and applies
+ *  it into the secondary slot through the decoder. Prints the size and the
+ *  update time of the patch next to those of the full image. Transfers are
+ *  timed on the simulated link, and the decoding, patching, and flash work
+ *  is measured.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void firmware_update_benchmark(void)
+{
+    const uint8_t *old_image = (const uint8_t *)FIRMWARE_UPDATE_PRIMARY_ADDRESS;
+    firmware_update_stats_t stats;
+    patch_header_t header;
+    mbedtls_sha256_context sha_ctx;
+    cy_rslt_t result;
+    uint32_t new_size = FIRMWARE_UPDATE_BENCH_IMAGE_SIZE + FIRMWARE_UPDATE_BENCH_INSERT_LEN;
+    uint32_t piece;
+    uint32_t done;
+    uint32_t full_requests;
+    uint32_t full_link_ms;
+    uint32_t full_encoded;
+    uint32_t patch_requests;
+    uint32_t patch_link_ms;
+    uint32_t device_ms;
+
+    /* New code goes in at 40% of the image, and a few constants change. */
+    bench_insert_at = ((FIRMWARE_UPDATE_BENCH_IMAGE_SIZE * 2u) / 5u) & ~3u;
+    for (uint32_t i = 0; i < FIRMWARE_UPDATE_BENCH_EDITS; i++)
+    {
+        bench_edits[i] = (xorshift_next(&random_state) % FIRMWARE_UPDATE_BENCH_IMAGE_SIZE) & ~3u;
+    }
+
+    header.magic = FIRMWARE_UPDATE_PATCH_MAGIC;
+    header.old_size = FIRMWARE_UPDATE_BENCH_IMAGE_SIZE;
+    header.new_size = new_size;
+
+    mbedtls_sha256_init(&sha_ctx);
+    mbedtls_sha256_starts_ret(&sha_ctx, 0);
+    mbedtls_sha256_update_ret(&sha_ctx, old_image, FIRMWARE_UPDATE_BENCH_IMAGE_SIZE);
+    mbedtls_sha256_finish_ret(&sha_ctx, header.old_sha256);
+    mbedtls_sha256_free(&sha_ctx);
+
+    mbedtls_sha256_init(&sha_ctx);
+    mbedtls_sha256_starts_ret(&sha_ctx, 0);
+    for (done = 0; done < new_size; done += piece)
+    {
+        piece = ((new_size - done) > BENCH_PIECE_SIZE) ? BENCH_PIECE_SIZE : (new_size - done);
+        bench_fill_new(bench_piece, done, piece);
+        mbedtls_sha256_update_ret(&sha_ctx, bench_piece, piece);
+    }
+    mbedtls_sha256_finish_ret(&sha_ctx, header.new_sha256);
+    mbedtls_sha256_free(&sha_ctx);
+
+    /* The patch is two records: the start of the image with the inserted
+     * code as extra bytes, and the rest of the image.
+     */
+    bench_encoded = 0;
+    bench_device_cycles = 0;
+    patch_start(old_image, &stats);
+    (void)inflater_init(&bench_inflater, INFLATER_FORMAT_GZIP, bench_window, sizeof(bench_window),
+                        feed_decoded, NULL);
+    (void)deflater_init(&bench_deflater, DEFLATER_FORMAT_GZIP, FIRMWARE_UPDATE_BENCH_LEVEL,
+                        decode_bench_patch, NULL);
+
+    (void)bench_encode((const uint8_t *)&header, sizeof(header));
+    bench_put_control(bench_insert_at, FIRMWARE_UPDATE_BENCH_INSERT_LEN, 0);
+    bench_put_diff(0, 0, bench_insert_at);
+    for (done = 0; done < FIRMWARE_UPDATE_BENCH_INSERT_LEN; done += piece)
+    {
+        piece = FIRMWARE_UPDATE_BENCH_INSERT_LEN - done;
+        piece = (piece > BENCH_PIECE_SIZE) ? BENCH_PIECE_SIZE : piece;
+        bench_fill_new(bench_piece, bench_insert_at + done, piece);
+        (void)bench_encode(bench_piece, piece);
+    }
+    bench_put_control(FIRMWARE_UPDATE_BENCH_IMAGE_SIZE - bench_insert_at, 0, 0);
+    bench_put_diff(bench_insert_at + FIRMWARE_UPDATE_BENCH_INSERT_LEN, bench_insert_at,
+                   FIRMWARE_UPDATE_BENCH_IMAGE_SIZE - bench_insert_at);
+    (void)deflater_finish(&bench_deflater);
+
+    result = (INFLATER_DONE == inflater_finish(&bench_inflater)) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+    if (CY_RSLT_SUCCESS != patch_finish())
+    {
+        result = CY_RSLT_TYPE_ERROR;
+    }
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("The benchmark patch did not produce the new image.\n"));
+        return;
+    }
+    stats.wire_bytes = bench_encoded;
+    device_ms = CYCLES_TO_MS(bench_device_cycles);
+
+    /* Size of the full image if the server compressed it as well. */
+    bench_encoded = 0;
+    (void)deflater_init(&bench_deflater, DEFLATER_FORMAT_GZIP, FIRMWARE_UPDATE_BENCH_LEVEL, count_encoded, NULL);
+    for (done = 0; done < new_size; done += piece)
+    {
+        piece = ((new_size - done) > BENCH_PIECE_SIZE) ? BENCH_PIECE_SIZE : (new_size - done);
+        bench_fill_new(bench_piece, done, piece);
+        (void)deflater_write(&bench_deflater, bench_piece, piece);
+    }
+    (void)deflater_finish(&bench_deflater);
+    full_encoded = bench_encoded;
+
+    /* The full image comes in FLASH_DOWNLOAD_CHUNK_SIZE pieces, programmed
+     * while the next one is received. The patch comes in one response of
+     * https_stream_get() and is applied as it is decoded.
+     */
+    full_requests = (new_size + FLASH_DOWNLOAD_CHUNK_SIZE - 1u) / FLASH_DOWNLOAD_CHUNK_SIZE;
+    full_link_ms = (full_requests * FIRMWARE_UPDATE_SIM_RTT_MS) + ((new_size * 8u) / FIRMWARE_UPDATE_SIM_LINK_KBPS);
+    patch_requests = 1u;
+    patch_link_ms = (patch_requests * FIRMWARE_UPDATE_SIM_RTT_MS) +
+                    ((stats.wire_bytes * 8u) / FIRMWARE_UPDATE_SIM_LINK_KBPS);
+
+    APP_INFO(("Update of a %lu KB image with %lu bytes of new code and %lu changed constants\n",
+              (unsigned long)(FIRMWARE_UPDATE_BENCH_IMAGE_SIZE / 1024u),
+              (unsigned long)FIRMWARE_UPDATE_BENCH_INSERT_LEN, (unsigned long)FIRMWARE_UPDATE_BENCH_EDITS));
+    printf("  %lu kbit/s link, %lu ms RTT\n",
+           (unsigned long)FIRMWARE_UPDATE_SIM_LINK_KBPS, (unsigned long)FIRMWARE_UPDATE_SIM_RTT_MS);
+    printf("                 bytes  requests  update ms\n");
+    printf("  full image  %8lu  %8lu  %9lu (link %lu, flash %lu)\n",
+           (unsigned long)new_size, (unsigned long)full_requests,
+           (unsigned long)((full_link_ms > stats.flash_ms) ? full_link_ms : stats.flash_ms),
+           (unsigned long)full_link_ms, (unsigned long)stats.flash_ms);
+    printf("  full, gzip  %8lu\n", (unsigned long)full_encoded);
+    printf("  patch       %8lu  %8lu  %9lu (link %lu, device %lu)\n",
+           (unsigned long)stats.wire_bytes, (unsigned long)patch_requests,
+           (unsigned long)(patch_link_ms + device_ms), (unsigned long)patch_link_ms, (unsigned long)device_ms);
+    printf("  patch is %lu%% of the image, %lu records, %lu bytes decoded\n",
+           (unsigned long)((100u * stats.wire_bytes) / new_size), (unsigned long)stats.records,
+           (unsigned long)stats.patch_bytes);
+}
+
+/*******************************************************************************
+ * Function Name: patch_start
+ *******************************************************************************
+ * Summary:
+ *  Resets the applier for a new patch of the given old image, and erases the
+ *  image trailer of the secondary slot.
+ *
+ *******************************************************************************/
+static void patch_start(const uint8_t *old_image, firmware_update_stats_t *stats)
+{
+    uint32_t trailer = FIRMWARE_UPDATE_SLOT_ADDRESS + FIRMWARE_UPDATE_MAX_IMAGE_SIZE;
+    uint32_t sector;
+
+    memset(stats, 0, sizeof(*stats));
+    memset(&applier, 0, sizeof(applier));
+
+    applier.state = PATCH_HEADER;
+    applier.old_image = old_image;
+    applier.erased_until = FIRMWARE_UPDATE_SLOT_ADDRESS;
+    applier.stats = stats;
+
+    mbedtls_sha256_init(&applier.sha_ctx);
+    mbedtls_sha256_starts_ret(&applier.sha_ctx, 0);
+
+    cycle_counter_enable();
+
+    /* A swap requested for an earlier image must not install this one
+     * while it is incomplete.
+     */
+    sector = trailer - (trailer % cy_serial_flash_qspi_get_erase_size(trailer));
+    if (CY_RSLT_SUCCESS != cy_serial_flash_qspi_erase(sector, cy_serial_flash_qspi_get_erase_size(trailer)))
+    {
+        fail_patch("the image trailer could not be erased");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: patch_feed
+ *******************************************************************************
+ * Summary:
+ *  Applies the next bytes of the patch. The bytes may end anywhere in the
+ *  header, a control, or the data of a record.
+ *
+ * Return:
+ *  bool: false if the patch is invalid or the flash failed.
+ *
+ *******************************************************************************/
+static bool patch_feed(const uint8_t *data, size_t length)
+{
+    uint32_t take;
+
+    applier.stats->patch_bytes += (uint32_t)length;
+
+    while ((length > 0) && (PATCH_FAILED != applier.state))
+    {
+        switch (applier.state)
+        {
+            case PATCH_HEADER:
+            {
+                take = (uint32_t)sizeof(patch_header_t) - applier.fill;
+                take = (take > length) ? (uint32_t)length : take;
+                memcpy((uint8_t *)&applier.header + applier.fill, data, take);
+                applier.fill += take;
+
+                if ((sizeof(patch_header_t) == applier.fill) && check_header())
+                {
+                    applier.fill = 0;
+                    applier.state = PATCH_CONTROL;
+                }
+                break;
+            }
+            case PATCH_CONTROL:
+            {
+                take = PATCH_CONTROL_LENGTH - applier.fill;
+                take = (take > length) ? (uint32_t)length : take;
+                memcpy(&applier.control[applier.fill], data, take);
+                applier.fill += take;
+
+                if ((PATCH_CONTROL_LENGTH == applier.fill) && start_record())
+                {
+                    applier.fill = 0;
+                }
+                break;
+            }
+            case PATCH_DIFF:
+            {
+                take = (applier.diff_left > length) ? (uint32_t)length : applier.diff_left;
+                for (uint32_t i = 0; (i < take) && (PATCH_FAILED != applier.state); i++)
+                {
+                    (void)emit_byte((uint8_t)(applier.old_image[applier.old_pos + i] + data[i]));
+                }
+                applier.old_pos += take;
+                applier.diff_left -= take;
+
+                if (0u == applier.diff_left)
+                {
+                    applier.state = PATCH_EXTRA;
+                    if (0u == applier.extra_left)
+                    {
+                        end_record();
+                    }
+                }
+                break;
+            }
+            case PATCH_EXTRA:
+            {
+                take = (applier.extra_left > length) ? (uint32_t)length : applier.extra_left;
+                for (uint32_t i = 0; (i < take) && (PATCH_FAILED != applier.state); i++)
+                {
+                    (void)emit_byte(data[i]);
+                }
+                applier.extra_left -= take;
+
+                if (0u == applier.extra_left)
+                {
+                    end_record();
+                }
+                break;
+            }
+            default:
+            {
+                fail_patch("data after the end of the patch");
+                take = 0;
+                break;
+            }
+        }
+
+        data += take;
+        length -= take;
+    }
+
+    return (PATCH_FAILED != applier.state);
+}
+
+/*******************************************************************************
+ * Function Name: patch_finish
+ *******************************************************************************
+ * Summary:
+ *  Programs the last bytes of the new image and checks its digest.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the whole patch was applied and the
+ *  digest matches, otherwise, it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+static cy_rslt_t patch_finish(void)
+{
+    if ((PATCH_DONE != applier.state) && (PATCH_FAILED != applier.state))
+    {
+        fail_patch("the patch is truncated");
+    }
+
+    if ((PATCH_DONE == applier.state) && (applier.program_len > 0u))
+    {
+        (void)flush_program();
+    }
+
+    mbedtls_sha256_finish_ret(&applier.sha_ctx, applier.stats->sha256);
+    mbedtls_sha256_free(&applier.sha_ctx);
+    applier.stats->flash_ms = CYCLES_TO_MS(applier.flash_cycles);
+
+    if ((PATCH_DONE == applier.state) &&
+        (0 != memcmp(applier.stats->sha256, applier.header.new_sha256, FIRMWARE_UPDATE_SHA256_LEN)))
+    {
+        fail_patch("SHA-256 mismatch of the new image");
+    }
+
+    return (PATCH_DONE == applier.state) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: request_swap
+ *******************************************************************************
+ * Summary:
+ *  Writes the image trailer of the secondary slot as MCUboot's
+ *  boot_set_pending() does for a permanent swap: the swap type, the image
+ *  ok flag, and the magic last, so that an interrupted write requests
+ *  nothing.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, otherwise, a serial flash error code.
+ *
+ *******************************************************************************/
+static cy_rslt_t request_swap(void)
+{
+    cy_rslt_t result;
+
+    result = write_trailer_field(TRAILER_SWAP_INFO_ADDRESS, TRAILER_SWAP_TYPE_PERM);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = write_trailer_field(TRAILER_IMAGE_OK_ADDRESS, TRAILER_FLAG_SET);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_serial_flash_qspi_write(TRAILER_MAGIC_ADDRESS, TRAILER_MAGIC_LENGTH,
+                                            (const uint8_t *)trailer_magic);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to write the image trailer. Error=%ld\n", (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: write_trailer_field
+ *******************************************************************************
+ * Summary:
+ *  Writes a one-byte field of the image trailer, padded with the erased
+ *  value to FIRMWARE_UPDATE_TRAILER_ALIGN bytes.
+ *
+ *******************************************************************************/
+static cy_rslt_t write_trailer_field(uint32_t addr, uint8_t value)
+{
+    uint8_t field[FIRMWARE_UPDATE_TRAILER_ALIGN];
+
+    memset(field, TRAILER_ERASED, sizeof(field));
+    field[0] = value;
+
+    return cy_serial_flash_qspi_write(addr, sizeof(field), field);
+}
+
+/*******************************************************************************
+ * Function Name: check_header
+ *******************************************************************************
+ * Summary:
+ *  Checks the sizes in the patch header and that the patch was made from
+ *  the old image.
+ *
+ * Return:
+ *  bool: true if the patch applies to the old image.
+ *
+ *******************************************************************************/
+static bool check_header(void)
+{
+    const patch_header_t *header = &applier.header;
+    mbedtls_sha256_context sha_ctx;
+    uint8_t digest[FIRMWARE_UPDATE_SHA256_LEN];
+
+    if ((FIRMWARE_UPDATE_PATCH_MAGIC != header->magic) ||
+        (0u == header->new_size) || (header->new_size > FIRMWARE_UPDATE_MAX_IMAGE_SIZE) ||
+        (header->old_size > FIRMWARE_UPDATE_SLOT_SIZE))
+    {
+        fail_patch("invalid header");
+        return false;
+    }
+
+    mbedtls_sha256_init(&sha_ctx);
+    mbedtls_sha256_starts_ret(&sha_ctx, 0);
+    mbedtls_sha256_update_ret(&sha_ctx, applier.old_image, header->old_size);
+    mbedtls_sha256_finish_ret(&sha_ctx, digest);
+    mbedtls_sha256_free(&sha_ctx);
+
+    if (0 != memcmp(digest, header->old_sha256, FIRMWARE_UPDATE_SHA256_LEN))
+    {
+        fail_patch("it was made for another image");
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: start_record
+ *******************************************************************************
+ * Summary:
+ *  Reads the control of a record and checks that the record stays inside
+ *  the old and the new image.
+ *
+ * Return:
+ *  bool: true if the record is valid.
+ *
+ *******************************************************************************/
+static bool start_record(void)
+{
+    uint32_t new_left = applier.header.new_size - applier.new_pos;
+
+    memcpy(&applier.diff_left, &applier.control[0], sizeof(uint32_t));
+    memcpy(&applier.extra_left, &applier.control[4], sizeof(uint32_t));
+    memcpy(&applier.seek, &applier.control[8], sizeof(int32_t));
+
+    if ((applier.diff_left > new_left) || (applier.extra_left > (new_left - applier.diff_left)) ||
+        (applier.diff_left > (applier.header.old_size - applier.old_pos)))
+    {
+        fail_patch("a record reaches past the end of an image");
+        return false;
+    }
+
+    applier.stats->records++;
+    applier.state = PATCH_DIFF;
+    if (0u == applier.diff_left)
+    {
+        applier.state = PATCH_EXTRA;
+        if (0u == applier.extra_left)
+        {
+            end_record();
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: end_record
+ *******************************************************************************
+ * Summary:
+ *  Moves in the old image by the seek of the record, and ends the patch
+ *  when the new image is complete.
+ *
+ *******************************************************************************/
+static void end_record(void)
+{
+    int64_t old_pos = (int64_t)applier.old_pos + applier.seek;
+
+    if ((old_pos < 0) || (old_pos > (int64_t)applier.header.old_size))
+    {
+        fail_patch("a seek leaves the old image");
+        return;
+    }
+
+    applier.old_pos = (uint32_t)old_pos;
+    applier.state = (applier.new_pos == applier.header.new_size) ? PATCH_DONE : PATCH_CONTROL;
+}
+
+/*******************************************************************************
+ * Function Name: emit_byte
+ *******************************************************************************
+ * Summary:
+ *  Adds a byte to the new image, programming the collected bytes when the
+ *  program buffer is full.
+ *
+ * Return:
+ *  bool: false if the flash failed.
+ *
+ *******************************************************************************/
+static bool emit_byte(uint8_t value)
+{
+    applier.program[applier.program_len++] = value;
+    applier.new_pos++;
+
+    if (FIRMWARE_UPDATE_PROGRAM_SIZE == applier.program_len)
+    {
+        return flush_program();
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: flush_program
+ *******************************************************************************
+ * Summary:
+ *  Programs the collected bytes into the secondary slot, erasing the sectors
+ *  ahead of them first, and adds them to the digest.
+ *
+ * Return:
+ *  bool: false if the flash failed.
+ *
+ *******************************************************************************/
+static bool flush_program(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t addr = FIRMWARE_UPDATE_SLOT_ADDRESS + applier.stats->image_bytes;
+    size_t sector_size;
+    uint32_t start = cycle_counter_get();
+
+    while ((CY_RSLT_SUCCESS == result) && (applier.erased_until < (addr + applier.program_len)))
+    {
+        sector_size = cy_serial_flash_qspi_get_erase_size(applier.erased_until);
+        result = cy_serial_flash_qspi_erase(applier.erased_until, sector_size);
+        applier.erased_until += sector_size;
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_serial_flash_qspi_write(addr, applier.program_len, applier.program);
+    }
+
+    applier.flash_cycles += cycle_counter_get() - start;
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Flash write failed at 0x%08lx. Error=%ld\n", (unsigned long)addr, (unsigned long)result));
+        applier.state = PATCH_FAILED;
+        return false;
+    }
+
+    mbedtls_sha256_update_ret(&applier.sha_ctx, applier.program, applier.program_len);
+    applier.stats->image_bytes += applier.program_len;
+    applier.program_len = 0;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: fail_patch
+ *******************************************************************************
+ * Summary:
+ *  Stops the patch with the reason.
+ *
+ *******************************************************************************/
+static void fail_patch(const char *reason)
+{
+    ERR_INFO(("Firmware patch rejected: %s.\n", reason));
+    applier.state = PATCH_FAILED;
+}
+
+/*******************************************************************************
+ * Function Name: feed_body
+ *******************************************************************************
+ * Summary:
+ *  Body callback of https_stream_get(). Passes the decoded patch to the
+ *  applier.
+ *
+ *******************************************************************************/
+static bool feed_body(const uint8_t *data, uint32_t length, void *arg)
+{
+    return patch_feed(data, length);
+}
+
+/*******************************************************************************
+ * Function Name: feed_decoded
+ *******************************************************************************
+ * Summary:
+ *  Output callback of the benchmark decoder. Passes the decoded patch to the
+ *  applier.
+ *
+ *******************************************************************************/
+static bool feed_decoded(const uint8_t *data, size_t length, void *arg)
+{
+    return patch_feed(data, length);
+}
+
+/*******************************************************************************
+ * Function Name: decode_bench_patch
+ *******************************************************************************
+ * Summary:
+ *  Output callback of the benchmark encoder. Counts the encoded patch as it
+ *  would be received, and decodes it as the device would.
+ *
+ *******************************************************************************/
+static bool decode_bench_patch(const uint8_t *data, size_t length, void *arg)
+{
+    inflater_status_t status;
+    uint32_t start = cycle_counter_get();
+
+    bench_encoded += (uint32_t)length;
+    status = inflater_feed(&bench_inflater, data, length);
+    bench_device_cycles += cycle_counter_get() - start;
+
+    return (INFLATER_OK == status) || (INFLATER_DONE == status);
+}
+
+/*******************************************************************************
+ * Function Name: count_encoded
+ *******************************************************************************
+ * Summary:
+ *  Output callback of the benchmark encoder that only counts the bytes.
+ *
+ *******************************************************************************/
+static bool count_encoded(const uint8_t *data, size_t length, void *arg)
+{
+    bench_encoded += (uint32_t)length;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: bench_encode
+ *******************************************************************************
+ * Summary:
+ *  Adds bytes to the benchmark patch.
+ *
+ *******************************************************************************/
+static bool bench_encode(const uint8_t *data, uint32_t length)
+{
+    return (DEFLATER_OK == deflater_write(&bench_deflater, data, length));
+}
+
+/*******************************************************************************
+ * Function Name: bench_new_byte
+ *******************************************************************************
+ * Summary:
+ *  Returns a byte of the benchmark new image: the old image with the new
+ *  code inserted, the pointers to the code after it moved, and the changed
+ *  constants.
+ *
+ *******************************************************************************/
+static uint8_t bench_new_byte(uint32_t position)
+{
+    const uint8_t *old_image = (const uint8_t *)FIRMWARE_UPDATE_PRIMARY_ADDRESS;
+    uint32_t source;
+    uint32_t word;
+
+    if ((position >= bench_insert_at) && (position < (bench_insert_at + FIRMWARE_UPDATE_BENCH_INSERT_LEN)))
+    {
+        return (uint8_t)bench_mix(position ^ 0x5BD1E995u);
+    }
+
+    source = (position < bench_insert_at) ? position : (position - FIRMWARE_UPDATE_BENCH_INSERT_LEN);
+    memcpy(&word, &old_image[source & ~3u], sizeof(word));
+
+    if ((word >= (FIRMWARE_UPDATE_PRIMARY_ADDRESS + bench_insert_at)) &&
+        (word < (FIRMWARE_UPDATE_PRIMARY_ADDRESS + FIRMWARE_UPDATE_BENCH_IMAGE_SIZE)))
+    {
+        word += FIRMWARE_UPDATE_BENCH_INSERT_LEN;
+    }
+
+    for (uint32_t i = 0; i < FIRMWARE_UPDATE_BENCH_EDITS; i++)
+    {
+        if (bench_edits[i] == (source & ~3u))
+        {
+            word ^= bench_mix(source);
+        }
+    }
+
+    return (uint8_t)(word >> (8u * (source % 4u)));
+}
+
+/*******************************************************************************
+ * Function Name: bench_fill_new
+ *******************************************************************************
+ * Summary:
+ *  Generates a piece of the benchmark new image.
+ *
+ *******************************************************************************/
+static void bench_fill_new(uint8_t *dest, uint32_t position, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        dest[i] = bench_new_byte(position + i);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: bench_put_control
+ *******************************************************************************
+ * Summary:
+ *  Adds the control of a record to the benchmark patch.
+ *
+ *******************************************************************************/
+static void bench_put_control(uint32_t diff_len, uint32_t extra_len, int32_t seek)
+{
+    uint8_t control[PATCH_CONTROL_LENGTH];
+
+    memcpy(&control[0], &diff_len, sizeof(uint32_t));
+    memcpy(&control[4], &extra_len, sizeof(uint32_t));
+    memcpy(&control[8], &seek, sizeof(int32_t));
+
+    (void)bench_encode(control, sizeof(control));
+}
+
+/*******************************************************************************
+ * Function Name: bench_put_diff
+ *******************************************************************************
+ * Summary:
+ *  Adds to the benchmark patch the difference between a part of the new
+ *  image and the old one. It is zero except where the images differ.
+ *
+ *******************************************************************************/
+static void bench_put_diff(uint32_t new_pos, uint32_t old_pos, uint32_t length)
+{
+    const uint8_t *old_image = (const uint8_t *)FIRMWARE_UPDATE_PRIMARY_ADDRESS;
+    uint32_t done;
+    uint32_t piece;
+
+    for (done = 0; done < length; done += piece)
+    {
+        piece = ((length - done) > BENCH_PIECE_SIZE) ? BENCH_PIECE_SIZE : (length - done);
+        for (uint32_t i = 0; i < piece; i++)
+        {
+            bench_piece[i] = (uint8_t)(bench_new_byte(new_pos + done + i) - old_image[old_pos + done + i]);
+        }
+        (void)bench_encode(bench_piece, piece);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: bench_mix
+ *******************************************************************************
+ * Summary:
+ *  Returns a well-mixed value of its argument.
+ *
+ *******************************************************************************/
+static uint32_t bench_mix(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
+
+    return value;
+}
+
+/* [] END OF FILE */
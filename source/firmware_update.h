@@ -0,0 +1,132 @@
+/******************************************************************************
+* File Name: firmware_update.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the firmware update, which applies a binary diff of the
+* running image, streamed from the HTTPS server, into the secondary slot.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef FIRMWARE_UPDATE_H_
+#define FIRMWARE_UPDATE_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Running image, the base of the diffs, in the memory-mapped internal flash. */
+#define FIRMWARE_UPDATE_PRIMARY_ADDRESS          (0x10000000UL)
+
+/* Secondary slot of the swap selected by CY_SECURE_POLICY_NAME, where the
+ * new image is staged. policy_single_CM0_CM4_smif_swap places the UPGRADE
+ * resource of the CM4 image at 0x18000000 in the XIP map of the external
+ * flash, that is at its offset 0, with the size of the BOOT resource at
+ * FIRMWARE_UPDATE_PRIMARY_ADDRESS.
+ */
+#define FIRMWARE_UPDATE_SLOT_ADDRESS             (0x00000000UL)
+#define FIRMWARE_UPDATE_SLOT_SIZE                (0x001C0000UL)
+
+/* MCUboot image trailer at the end of the slot: the swap status, then the
+ * swap size, swap info, copy done, and image ok fields, each padded to
+ * FIRMWARE_UPDATE_TRAILER_ALIGN bytes, and the 16-byte magic last. The new
+ * image must end before it.
+ */
+#define FIRMWARE_UPDATE_TRAILER_SIZE             (0x1000UL)
+#define FIRMWARE_UPDATE_TRAILER_ALIGN            (8u)
+#define FIRMWARE_UPDATE_MAX_IMAGE_SIZE           (FIRMWARE_UPDATE_SLOT_SIZE - FIRMWARE_UPDATE_TRAILER_SIZE)
+
+/* Patches on the server, gzip-encoded. A patch starts with a header holding
+ * the sizes and the SHA-256 digests of the image it applies to and of the
+ * image it produces. Then come bsdiff records: a control of three 32-bit
+ * little-endian fields (diff length, extra length, signed seek of the old
+ * image), diff length bytes added to the old image, and extra length bytes
+ * copied as they are.
+ */
+#define FIRMWARE_UPDATE_PATCH_PATH               "/firmware.patch"
+#define FIRMWARE_UPDATE_PATCH_MAGIC              (0x31504446UL)
+
+/* New image bytes collected before they are programmed. */
+#define FIRMWARE_UPDATE_PROGRAM_SIZE             (512)
+
+/* Length of a SHA-256 digest in bytes. */
+#define FIRMWARE_UPDATE_SHA256_LEN               (32)
+
+/* "Firmware update" menu option: the first part of the running image is the
+ * old image, and the new image inserts new code in it, moves the pointers
+ * past the insertion accordingly, and changes a few constants. The patch is
+ * compressed and decoded on the device like a downloaded one. Transfers are
+ * timed on a link of the given rate and round trip time.
+ */
+#define FIRMWARE_UPDATE_BENCH_IMAGE_SIZE         (512u * 1024u)
+#define FIRMWARE_UPDATE_BENCH_INSERT_LEN         (1536u)
+#define FIRMWARE_UPDATE_BENCH_EDITS              (16u)
+#define FIRMWARE_UPDATE_BENCH_LEVEL              (6u)
+#define FIRMWARE_UPDATE_BENCH_WINDOW_SIZE        (4096u)
+#define FIRMWARE_UPDATE_SIM_LINK_KBPS            (2000u)
+#define FIRMWARE_UPDATE_SIM_RTT_MS               (50u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Statistics of an update. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t wire_bytes;         /* Patch bytes received, as encoded by the server. */
+    uint32_t patch_bytes;        /* Patch bytes after decoding. */
+    uint32_t image_bytes;        /* New image bytes written to the secondary slot. */
+    uint32_t records;            /* bsdiff records applied. */
+    uint32_t requests;           /* Requests sent. */
+    uint32_t flash_ms;           /* Erasing and programming the secondary slot. */
+    uint32_t elapsed_ms;
+    uint8_t  sha256[FIRMWARE_UPDATE_SHA256_LEN]; /* Digest of the new image. */
+} firmware_update_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t firmware_update_apply(const char *path, firmware_update_stats_t *stats);
+void firmware_update_print_stats(const firmware_update_stats_t *stats);
+void firmware_update_benchmark(void);
+
+#endif /* FIRMWARE_UPDATE_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,606 @@
+/******************************************************************************
+* File Name: flash_download.c
+*
+* Description: This file contains the pipeline that streams an HTTP resource
+* into the external QSPI NOR flash. The resource is fetched in chunks with HTTP
+* Range requests into two buffers, so that the network receive of one chunk
+* overlaps the erase and program of the previous chunk by the flash writer task.
+* A running SHA-256 digest of the body is computed as the chunks arrive.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+
+/* Serial flash library header file */
+#include "cy_serial_flash_qspi.h"
+
+/* Standard C header files */
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "flash_download.h"
+#include "stream_digest.h"
+#include "wifi_power.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define FLASH_DOWNLOAD_BUFFER_LENGTH     (FLASH_DOWNLOAD_CHUNK_SIZE + FLASH_DOWNLOAD_HEADER_SPACE)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Chunk handed over from the HTTPS client task to the flash writer task. */
+typedef struct
+{
+    const uint8_t *body;
+    uint32_t length;
+    uint32_t flash_addr;
+} flash_chunk_t;
+
+/* Validity header stored at FLASH_DOWNLOAD_HEADER_ADDRESS. An erased header
+ * reads as all ones and has no magic.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t flash_addr;
+    uint32_t length;
+    uint8_t  sha256[FLASH_DOWNLOAD_SHA256_LEN];
+} flash_header_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Chunk buffers. Each holds the response headers followed by the body. */
+static uint8_t chunk_buffer[FLASH_DOWNLOAD_NUM_BUFFERS][FLASH_DOWNLOAD_BUFFER_LENGTH];
+
+/* Chunks waiting to be programmed and the count of buffers free for receive. */
+static QueueHandle_t chunk_queue;
+static SemaphoreHandle_t free_buffers;
+
+static TaskHandle_t flash_writer_task_handle;
+
+/* Result of the last erase or program operation done by the writer task. */
+static volatile cy_rslt_t writer_result;
+
+/* End of the flash area erased so far by the active download. */
+static uint32_t erased_until;
+
+/* Ticks spent by the writer task in erase and program of the active download. */
+static volatile TickType_t flash_busy_ticks;
+
+/* Digest of the active download. */
+static stream_digest_t download_digest;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void flash_writer_task(void *arg);
+static cy_rslt_t flash_write_chunk(const flash_chunk_t *chunk);
+static void wait_for_writer_idle(void);
+
+/*******************************************************************************
+ * Function Name: flash_download_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the queue, the semaphore, and the flash writer task used by the
+ *  download pipeline. The external flash must already be initialized.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the pipeline is ready, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t flash_download_init(void)
+{
+    if (NULL != flash_writer_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    chunk_queue = xQueueCreate(FLASH_DOWNLOAD_NUM_BUFFERS, sizeof(flash_chunk_t));
+    free_buffers = xSemaphoreCreateCounting(FLASH_DOWNLOAD_NUM_BUFFERS, FLASH_DOWNLOAD_NUM_BUFFERS);
+
+    if ((NULL == chunk_queue) || (NULL == free_buffers))
+    {
+        ERR_INFO(("Failed to create the flash download queue.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (pdPASS != xTaskCreate(flash_writer_task, "Flash Writer", FLASH_DOWNLOAD_WRITER_TASK_STACK_SIZE,
+                              NULL, FLASH_DOWNLOAD_WRITER_TASK_PRIORITY, &flash_writer_task_handle))
+    {
+        ERR_INFO(("Failed to create the flash writer task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: flash_download
+ *******************************************************************************
+ * Summary:
+ *  Downloads the resource at the given path into the external flash. Each
+ *  chunk is received into a free buffer, added to the running SHA-256 digest,
+ *  and queued to the flash writer task. The next chunk is requested while the
+ *  writer erases and programs the previous one.
+ *
+ *  The validity header is erased before the first chunk is programmed and
+ *  written only after the digest matched, so a corrupted or interrupted
+ *  download leaves a copy that flash_download_is_valid() rejects.
+ *
+ * Parameters:
+ *  handle - Connected HTTP client instance.
+ *  path - Resource path on the server.
+ *  flash_addr - Destination address in the external flash, in the region of
+ *               FLASH_DOWNLOAD_REGION_SIZE bytes at
+ *               FLASH_DOWNLOAD_FLASH_ADDRESS. Must be aligned to the
+ *               erase sector size.
+ *  expected_sha256 - Expected digest of the resource, or NULL to check the
+ *                    Repr-Digest or Digest header of the response if any.
+ *  stats - Filled with the download statistics and the computed digest.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the resource is stored and its digest
+ *  matches, otherwise, it returns an HTTP client, serial flash, or
+ *  CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+cy_rslt_t flash_download(cy_http_client_t handle, const char *path, uint32_t flash_addr,
+                         const uint8_t *expected_sha256, flash_download_stats_t *stats)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    cy_http_client_response_t response;
+    uint8_t header_sha256[FLASH_DOWNLOAD_SHA256_LEN];
+    flash_chunk_t chunk;
+    uint32_t buffer_index = 0;
+    uint32_t offset = 0;
+    uint32_t total_size = 0;
+    TickType_t start_ticks;
+    TickType_t network_ticks = 0;
+    TickType_t chunk_ticks;
+    uint32_t busy_ms;
+    cy_http_client_header_t accept;
+
+    if ((NULL == flash_writer_task_handle) || (NULL == path) || (NULL == stats))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if ((flash_addr < FLASH_DOWNLOAD_FLASH_ADDRESS) || (flash_addr >= FLASH_DOWNLOAD_REGION_END))
+    {
+        ERR_INFO(("Flash address 0x%08lx is outside the download region.\n", (unsigned long)flash_addr));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (0 != (flash_addr % cy_serial_flash_qspi_get_erase_size(flash_addr)))
+    {
+        ERR_INFO(("Flash address 0x%08lx is not sector aligned.\n", (unsigned long)flash_addr));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    result = flash_download_invalidate();
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    writer_result = CY_RSLT_SUCCESS;
+    erased_until = flash_addr;
+    flash_busy_ticks = 0;
+
+    accept.field = "Accept";
+    accept.field_len = sizeof("Accept") - 1;
+    accept.value = "application/octet-stream";
+    accept.value_len = sizeof("application/octet-stream") - 1;
+
+    stream_digest_start(&download_digest, STREAM_DIGEST_DEFAULT_ENGINE);
+
+    /* The radio is kept awake for the whole transfer, not just each request. */
+    wifi_power_begin();
+    start_ticks = xTaskGetTickCount();
+
+    do
+    {
+        /* Wait until the writer has released a buffer. */
+        xSemaphoreTake(free_buffers, portMAX_DELAY);
+        chunk_ticks = xTaskGetTickCount();
+
+        if (CY_RSLT_SUCCESS != writer_result)
+        {
+            xSemaphoreGive(free_buffers);
+            result = writer_result;
+            break;
+        }
+
+        result = https_get_range(handle, path, &accept, NUM_HTTP_HEADERS, chunk_buffer[buffer_index],
+                                 FLASH_DOWNLOAD_BUFFER_LENGTH, offset, FLASH_DOWNLOAD_CHUNK_SIZE, &response);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            xSemaphoreGive(free_buffers);
+            break;
+        }
+
+        if (0 == offset)
+        {
+            /* The first response tells the size of the whole resource. A server
+             * that ignores the Range header returns it in one piece.
+             */
+            total_size = (HTTP_STATUS_OK == response.status_code) ?
+                         (uint32_t)response.body_len : https_content_range_total(handle, &response);
+
+            if ((0 == total_size) || (total_size > (FLASH_DOWNLOAD_REGION_END - flash_addr)) ||
+                ((flash_addr + total_size) > (uint32_t)cy_serial_flash_qspi_get_size()))
+            {
+                ERR_INFO(("Invalid resource size %lu, the region holds %lu bytes.\n",
+                          (unsigned long)total_size, (unsigned long)(FLASH_DOWNLOAD_REGION_END - flash_addr)));
+                xSemaphoreGive(free_buffers);
+                result = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+
+            if ((NULL == expected_sha256) && stream_digest_read_header(handle, &response, header_sha256))
+            {
+                expected_sha256 = header_sha256;
+            }
+        }
+
+        if ((0 == response.body_len) || ((offset + response.body_len) > total_size))
+        {
+            ERR_INFO(("Unexpected chunk length %lu at offset %lu.\n",
+                      (unsigned long)response.body_len, (unsigned long)offset));
+            xSemaphoreGive(free_buffers);
+            result = CY_RSLT_TYPE_ERROR;
+            break;
+        }
+
+        /* Hash the chunk here, while the writer is busy with the previous one. */
+        stream_digest_update(&download_digest, response.body, (uint32_t)response.body_len);
+
+        chunk.body = response.body;
+        chunk.length = (uint32_t)response.body_len;
+        chunk.flash_addr = flash_addr + offset;
+        xQueueSend(chunk_queue, &chunk, portMAX_DELAY);
+
+        network_ticks += xTaskGetTickCount() - chunk_ticks;
+        offset += chunk.length;
+        stats->num_chunks++;
+        buffer_index = (buffer_index + 1) % FLASH_DOWNLOAD_NUM_BUFFERS;
+    } while (offset < total_size);
+
+    wifi_power_end();
+
+    /* Let the writer finish the chunks that are still queued. */
+    wait_for_writer_idle();
+
+    if ((CY_RSLT_SUCCESS == result) && (CY_RSLT_SUCCESS != writer_result))
+    {
+        result = writer_result;
+    }
+
+    stats->elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+    stats->network_busy_ms = (uint32_t)network_ticks * portTICK_PERIOD_MS;
+    stats->flash_busy_ms = (uint32_t)flash_busy_ticks * portTICK_PERIOD_MS;
+    stats->total_bytes = offset;
+
+    /* Either side is idle only while it waits for the other, so the time both
+     * were busy is the part of their sum that exceeds the wall-clock time.
+     */
+    busy_ms = stats->network_busy_ms + stats->flash_busy_ms;
+    stats->overlap_ms = (busy_ms > stats->elapsed_ms) ? (busy_ms - stats->elapsed_ms) : 0;
+    if (stats->flash_busy_ms > 0)
+    {
+        stats->overlap_percent = (stats->overlap_ms * 100u) / stats->flash_busy_ms;
+    }
+    if (stats->elapsed_ms > 0)
+    {
+        stats->throughput_bps = (uint32_t)(((uint64_t)offset * 1000u) / stats->elapsed_ms);
+    }
+
+    stream_digest_finish(&download_digest, stats->sha256);
+    stats->digest_cycles = download_digest.cycles;
+
+    if ((CY_RSLT_SUCCESS == result) && (NULL != expected_sha256) &&
+        (0 != memcmp(expected_sha256, stats->sha256, FLASH_DOWNLOAD_SHA256_LEN)))
+    {
+        ERR_INFO(("SHA-256 mismatch, the downloaded image is corrupted.\n"));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+    else
+    {
+        stats->verified = (CY_RSLT_SUCCESS == result) && (NULL != expected_sha256);
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flash_download_mark_valid(flash_addr, offset, stats->sha256);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: flash_download_invalidate
+ *******************************************************************************
+ * Summary:
+ *  Erases the validity header, so that the copy in the external flash is
+ *  not used until flash_download_mark_valid() is called. Must be called
+ *  before the copy is modified.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Result of the serial flash erase.
+ *
+ *******************************************************************************/
+cy_rslt_t flash_download_invalidate(void)
+{
+    cy_rslt_t result;
+
+    result = cy_serial_flash_qspi_erase(FLASH_DOWNLOAD_HEADER_ADDRESS,
+                                        cy_serial_flash_qspi_get_erase_size(FLASH_DOWNLOAD_HEADER_ADDRESS));
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to erase the flash download header. Error=%ld\n", (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: flash_download_mark_valid
+ *******************************************************************************
+ * Summary:
+ *  Writes the validity header of a copy whose content was checked. The
+ *  header must have been erased by flash_download_invalidate().
+ *
+ * Parameters:
+ *  flash_addr - Address of the copy in the external flash.
+ *  length - Length of the copy in bytes.
+ *  sha256 - SHA-256 digest of the copy.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the serial flash write.
+ *
+ *******************************************************************************/
+cy_rslt_t flash_download_mark_valid(uint32_t flash_addr, uint32_t length, const uint8_t *sha256)
+{
+    cy_rslt_t result;
+    flash_header_t header;
+
+    header.magic = FLASH_DOWNLOAD_HEADER_MAGIC;
+    header.flash_addr = flash_addr;
+    header.length = length;
+    memcpy(header.sha256, sha256, sizeof(header.sha256));
+
+    result = cy_serial_flash_qspi_write(FLASH_DOWNLOAD_HEADER_ADDRESS, sizeof(header), (const uint8_t *)&header);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to write the flash download header. Error=%ld\n", (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: flash_download_is_valid
+ *******************************************************************************
+ * Summary:
+ *  Tells whether the copy at the given address was completely written and
+ *  its digest checked, according to the validity header.
+ *
+ * Parameters:
+ *  flash_addr - Address of the copy in the external flash.
+ *  length - Filled with the length of a valid copy. Can be NULL.
+ *
+ * Return:
+ *  bool: true if the copy can be used.
+ *
+ *******************************************************************************/
+bool flash_download_is_valid(uint32_t flash_addr, uint32_t *length)
+{
+    flash_header_t header;
+
+    if ((CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(FLASH_DOWNLOAD_HEADER_ADDRESS, sizeof(header),
+                                                      (uint8_t *)&header)) ||
+        (FLASH_DOWNLOAD_HEADER_MAGIC != header.magic) || (flash_addr != header.flash_addr))
+    {
+        return false;
+    }
+
+    if (NULL != length)
+    {
+        *length = header.length;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: flash_download_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the throughput, the overlap ratio, and the digest of a download.
+ *
+ * Parameters:
+ *  stats - Statistics filled by flash_download().
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void flash_download_print_stats(const flash_download_stats_t *stats)
+{
+    uint32_t index;
+
+    APP_INFO(("Downloaded %lu bytes in %lu chunks in %lu ms (%lu bytes/s)\n",
+              (unsigned long)stats->total_bytes, (unsigned long)stats->num_chunks,
+              (unsigned long)stats->elapsed_ms, (unsigned long)stats->throughput_bps));
+    APP_INFO(("Network busy: %lu ms, flash busy: %lu ms, overlap: %lu ms (%lu%% of flash time)\n",
+              (unsigned long)stats->network_busy_ms, (unsigned long)stats->flash_busy_ms,
+              (unsigned long)stats->overlap_ms, (unsigned long)stats->overlap_percent));
+    APP_INFO(("SHA-256: "));
+    for (index = 0; index < FLASH_DOWNLOAD_SHA256_LEN; index++)
+    {
+        printf("%02x", stats->sha256[index]);
+    }
+    printf(" (%s, %lu cycles)\n", stats->verified ? "verified" : "not verified",
+           (unsigned long)stats->digest_cycles);
+}
+
+/*******************************************************************************
+ * Function Name: flash_writer_task
+ *******************************************************************************
+ * Summary:
+ *  Erases and programs the chunks queued by flash_download() and returns each
+ *  buffer to the pool once its content is in the flash. After an error, the
+ *  remaining chunks of the download are discarded.
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void flash_writer_task(void *arg)
+{
+    flash_chunk_t chunk;
+    TickType_t start_ticks;
+
+    (void)arg;
+
+    while (true)
+    {
+        xQueueReceive(chunk_queue, &chunk, portMAX_DELAY);
+
+        if (CY_RSLT_SUCCESS == writer_result)
+        {
+            start_ticks = xTaskGetTickCount();
+            writer_result = flash_write_chunk(&chunk);
+            flash_busy_ticks += xTaskGetTickCount() - start_ticks;
+        }
+
+        xSemaphoreGive(free_buffers);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flash_write_chunk
+ *******************************************************************************
+ * Summary:
+ *  Erases the sectors that the chunk extends into and programs the chunk.
+ *  Sectors are erased on first use, so only the area actually covered by the
+ *  resource is erased.
+ *
+ * Parameters:
+ *  chunk - Chunk to program.
+ *
+ * Return:
+ *  cy_rslt_t: Result of the serial flash operations.
+ *
+ *******************************************************************************/
+static cy_rslt_t flash_write_chunk(const flash_chunk_t *chunk)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t chunk_end = chunk->flash_addr + chunk->length;
+    size_t sector_size;
+
+    while ((CY_RSLT_SUCCESS == result) && (erased_until < chunk_end))
+    {
+        sector_size = cy_serial_flash_qspi_get_erase_size(erased_until);
+        result = cy_serial_flash_qspi_erase(erased_until, sector_size);
+        erased_until += sector_size;
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_serial_flash_qspi_write(chunk->flash_addr, chunk->length, chunk->body);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Flash write failed at 0x%08lx. Error=%ld\n",
+                  (unsigned long)chunk->flash_addr, (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: wait_for_writer_idle
+ *******************************************************************************
+ * Summary:
+ *  Blocks until the writer task has released every chunk buffer.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void wait_for_writer_idle(void)
+{
+    uint32_t index;
+
+    for (index = 0; index < FLASH_DOWNLOAD_NUM_BUFFERS; index++)
+    {
+        xSemaphoreTake(free_buffers, portMAX_DELAY);
+    }
+
+    for (index = 0; index < FLASH_DOWNLOAD_NUM_BUFFERS; index++)
+    {
+        xSemaphoreGive(free_buffers);
+    }
+}
+
+/* [] END OF FILE */
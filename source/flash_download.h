@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name: flash_download.h
+*
+* Description: This file contains the configuration parameters and the API of
+* the pipeline that streams an HTTP resource into the external QSPI NOR flash.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef FLASH_DOWNLOAD_H_
+#define FLASH_DOWNLOAD_H_
+
+#include <stdbool.h>
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Size of the body requested with every HTTP Range request. Larger chunks
+ * amortize the request round trip; two chunks are held in RAM at any time.
+ */
+#define FLASH_DOWNLOAD_CHUNK_SIZE                (16 * 1024)
+
+/* Space reserved in each chunk buffer for the response status line and headers
+ * that the HTTP client stores ahead of the body.
+ */
+#define FLASH_DOWNLOAD_HEADER_SPACE              (1024)
+
+/* Number of chunk buffers. Two buffers let the network receive of one chunk
+ * overlap the erase and program of the previous one.
+ */
+#define FLASH_DOWNLOAD_NUM_BUFFERS               (2)
+
+/* Resource fetched by the "download to flash" menu option and its location in
+ * the external flash. The region must not overlap the Wi-Fi firmware on kits
+ * that execute it in place from the QSPI flash.
+ */
+#define FLASH_DOWNLOAD_PATH                      "/asset.bin"
+#define FLASH_DOWNLOAD_FLASH_ADDRESS             (0x00200000UL)
+
+/* Space of the downloaded copy. It ends at DELTA_SYNC_BENCH_ADDRESS, below
+ * the delta sync, offline queue, response cache, firmware update, and
+ * validity header regions, so a larger resource is rejected before any of
+ * its chunks is programmed.
+ */
+#define FLASH_DOWNLOAD_REGION_SIZE               (0x00C00000UL)
+#define FLASH_DOWNLOAD_REGION_END                (FLASH_DOWNLOAD_FLASH_ADDRESS + FLASH_DOWNLOAD_REGION_SIZE)
+
+/* Validity header of the copy at FLASH_DOWNLOAD_FLASH_ADDRESS, in an erase
+ * sector of its own after the response cache. The header is erased
+ * before the copy is modified and written last, once the digest of the new
+ * content matched, so a copy without a valid header must not be used.
+ */
+#define FLASH_DOWNLOAD_HEADER_ADDRESS            (0x01600000UL)
+#define FLASH_DOWNLOAD_HEADER_MAGIC              (0x44565346UL)
+
+/* Flash writer task parameters. The writer runs above the HTTPS client task
+ * so that a completed chunk is programmed as soon as it is received.
+ */
+#define FLASH_DOWNLOAD_WRITER_TASK_STACK_SIZE    (1024)
+#define FLASH_DOWNLOAD_WRITER_TASK_PRIORITY      (2)
+
+/* Length of a SHA-256 digest in bytes. */
+#define FLASH_DOWNLOAD_SHA256_LEN                (32)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Statistics of a single download. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t total_bytes;        /* Bytes written to the flash. */
+    uint32_t num_chunks;         /* Number of Range requests issued. */
+    uint32_t elapsed_ms;         /* Wall-clock time of the whole download. */
+    uint32_t network_busy_ms;    /* Time spent receiving and hashing chunks. */
+    uint32_t flash_busy_ms;      /* Time spent erasing and programming. */
+    uint32_t overlap_ms;         /* Time during which both were busy. */
+    uint32_t throughput_bps;     /* total_bytes over elapsed_ms, in bytes/s. */
+    uint32_t overlap_percent;    /* Share of the flash time hidden by the network. */
+    uint8_t  sha256[FLASH_DOWNLOAD_SHA256_LEN]; /* Digest of the received body. */
+    uint32_t digest_cycles;      /* CPU cycles spent hashing the body. */
+    bool     verified;           /* The digest matched the expected or header one. */
+} flash_download_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t flash_download_init(void);
+cy_rslt_t flash_download(cy_http_client_t handle, const char *path, uint32_t flash_addr,
+                         const uint8_t *expected_sha256, flash_download_stats_t *stats);
+cy_rslt_t flash_download_invalidate(void);
+cy_rslt_t flash_download_mark_valid(uint32_t flash_addr, uint32_t length, const uint8_t *sha256);
+bool flash_download_is_valid(uint32_t flash_addr, uint32_t *length);
+void flash_download_print_stats(const flash_download_stats_t *stats);
+
+#endif /* FLASH_DOWNLOAD_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1808 @@
+/******************************************************************************
+* File Name: http2_client.c
+*
+* Description: This file contains the HTTP/2 client (RFC 9113). GET requests
+* are sent as concurrent streams of one TLS connection negotiated with ALPN.
+* Headers are coded with HPACK (RFC 7541) using only the static table, and
+* the receive windows are sized for the RAM of the MCU.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "secure_http_client.h"
+#include "http_pipeline.h"
+#include "http2_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define FRAME_HEADER_SIZE                (9u)
+
+/* Frame types. */
+#define FRAME_DATA                       (0x0u)
+#define FRAME_HEADERS                    (0x1u)
+#define FRAME_PRIORITY                   (0x2u)
+#define FRAME_RST_STREAM                 (0x3u)
+#define FRAME_SETTINGS                   (0x4u)
+#define FRAME_PUSH_PROMISE               (0x5u)
+#define FRAME_PING                       (0x6u)
+#define FRAME_GOAWAY                     (0x7u)
+#define FRAME_WINDOW_UPDATE              (0x8u)
+#define FRAME_CONTINUATION               (0x9u)
+
+/* Frame flags. */
+#define FLAG_END_STREAM                  (0x01u)
+#define FLAG_ACK                         (0x01u)
+#define FLAG_END_HEADERS                 (0x04u)
+#define FLAG_PADDED                      (0x08u)
+#define FLAG_PRIORITY                    (0x20u)
+
+/* Settings. */
+#define SETTINGS_HEADER_TABLE_SIZE       (0x1u)
+#define SETTINGS_ENABLE_PUSH             (0x2u)
+#define SETTINGS_MAX_CONCURRENT_STREAMS  (0x3u)
+#define SETTINGS_INITIAL_WINDOW_SIZE     (0x4u)
+#define SETTINGS_MAX_HEADER_LIST_SIZE    (0x6u)
+#define SETTINGS_ENTRY_SIZE              (6u)
+
+/* Error codes. */
+#define ERROR_NONE                       (0x0u)
+#define ERROR_PROTOCOL                   (0x1u)
+#define ERROR_INTERNAL                   (0x2u)
+#define ERROR_FRAME_SIZE                 (0x6u)
+#define ERROR_REFUSED_STREAM             (0x7u)
+#define ERROR_COMPRESSION                (0x9u)
+
+/* The largest frame the server may send without a SETTINGS_MAX_FRAME_SIZE,
+ * and the connection window, which can only be raised from its default.
+ */
+#define MAX_FRAME_SIZE                   (16384u)
+#define CONNECTION_WINDOW_SIZE           (65535u)
+
+/* HPACK static table indexes used in requests. */
+#define HPACK_AUTHORITY                  (1u)
+#define HPACK_METHOD_GET                 (2u)
+#define HPACK_PATH                       (4u)
+#define HPACK_SCHEME_HTTPS               (7u)
+
+/* HPACK field representations: first bits and integer prefix. */
+#define HPACK_INDEXED                    (0x80u)
+#define HPACK_INCREMENTAL                (0x40u)
+#define HPACK_SIZE_UPDATE                (0x20u)
+#define HPACK_HUFFMAN                    (0x80u)
+#define HPACK_LONGEST_CODE               (30u)
+
+#define CONNECTION_PREFACE               "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define CONNECTION_PREFACE_SIZE          (sizeof(CONNECTION_PREFACE) - 1u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Entry of the HPACK static table. */
+typedef struct
+{
+    const char *name;
+    const char *value;
+} hpack_field_t;
+
+/* Totals of the benchmark responses. */
+typedef struct
+{
+    uint32_t responses;
+    uint32_t body_bytes;
+    uint32_t errors;
+} bench_counts_t;
+
+/* An HTTP/1.1 connection of the benchmark, served by its own task. */
+typedef struct
+{
+    http_pipeline_t pipeline;
+    const char *const *paths;
+    uint32_t count;
+    bench_counts_t counts;
+    cy_rslt_t result;
+} http1_worker_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* HPACK static table (RFC 7541, Appendix A). Index 1 is the first entry. */
+static const hpack_field_t hpack_static_table[] =
+{
+    { ":authority", "" }, { ":method", "GET" }, { ":method", "POST" }, { ":path", "/" },
+    { ":path", "/index.html" }, { ":scheme", "http" }, { ":scheme", "https" }, { ":status", "200" },
+    { ":status", "204" }, { ":status", "206" }, { ":status", "304" }, { ":status", "400" },
+    { ":status", "404" }, { ":status", "500" }, { "accept-charset", "" }, { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" }, { "accept-ranges", "" }, { "accept", "" }, { "access-control-allow-origin", "" },
+    { "age", "" }, { "allow", "" }, { "authorization", "" }, { "cache-control", "" },
+    { "content-disposition", "" }, { "content-encoding", "" }, { "content-language", "" }, { "content-length", "" },
+    { "content-location", "" }, { "content-range", "" }, { "content-type", "" }, { "cookie", "" },
+    { "date", "" }, { "etag", "" }, { "expect", "" }, { "expires", "" },
+    { "from", "" }, { "host", "" }, { "if-match", "" }, { "if-modified-since", "" },
+    { "if-none-match", "" }, { "if-range", "" }, { "if-unmodified-since", "" }, { "last-modified", "" },
+    { "link", "" }, { "location", "" }, { "max-forwards", "" }, { "proxy-authenticate", "" },
+    { "proxy-authorization", "" }, { "range", "" }, { "referer", "" }, { "refresh", "" },
+    { "retry-after", "" }, { "server", "" }, { "set-cookie", "" }, { "strict-transport-security", "" },
+    { "transfer-encoding", "" }, { "user-agent", "" }, { "vary", "" }, { "via", "" },
+    { "www-authenticate", "" },
+};
+
+/* The HPACK Huffman code (RFC 7541, Appendix B) is canonical, so it is
+ * decoded from the number of codes of each length and the symbols in code
+ * order. EOS, the last code, is not listed.
+ */
+static const uint8_t huffman_counts[HPACK_LONGEST_CODE + 1u] =
+{
+    0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 4
+};
+
+static const uint8_t huffman_symbols[256] =
+{
+     48,  49,  50,  97,  99, 101, 105, 111, 115, 116,  32,  37,  45,  46,  47,  51,
+     52,  53,  54,  55,  56,  57,  61,  65,  95,  98, 100, 102, 103, 104, 108, 109,
+    110, 112, 114, 117,  58,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+     77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  89, 106, 107, 113, 118,
+    119, 120, 121, 122,  38,  42,  44,  59,  88,  90,  33,  34,  40,  41,  63,  39,
+     43, 124,  35,  62,   0,  36,  64,  91,  93, 126,  94, 125,  60,  96, 123,  92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+    179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+    163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233,   1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+    158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239,   9, 142,
+    144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+    212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+      2,   3,   4,   5,   6,   7,   8,  11,  12,  14,  15,  16,  17,  18,  19,  20,
+     21,  23,  24,  25,  26,  27,  28,  29,  30,  31, 127, 220, 249,  10,  13,  22,
+};
+
+static http2_client_t bench_client;
+static http1_worker_t http1_workers[HTTP2_MAX_STREAMS];
+static SemaphoreHandle_t bench_ready;
+static SemaphoreHandle_t bench_start;
+static SemaphoreHandle_t bench_done;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t open_connection(http2_client_t *client);
+static void drop_connection(http2_client_t *client);
+static cy_rslt_t open_streams(http2_client_t *client);
+static cy_rslt_t start_stream(http2_client_t *client, http2_stream_t *stream, uint32_t index);
+static uint32_t parse_frames(http2_client_t *client, const uint8_t *data, uint32_t length);
+static uint32_t start_frame(http2_client_t *client);
+static uint32_t receive_data(http2_client_t *client, const uint8_t *data, uint32_t length);
+static uint32_t end_frame(http2_client_t *client);
+static uint32_t end_data_frame(http2_client_t *client, http2_stream_t *stream);
+static uint32_t end_header_block(http2_client_t *client);
+static uint32_t receive_settings(http2_client_t *client);
+static uint32_t receive_goaway(http2_client_t *client);
+static http2_stream_t *find_stream(http2_client_t *client, uint32_t id);
+static void complete_stream(http2_client_t *client, http2_stream_t *stream);
+static void restart_stream(http2_client_t *client, http2_stream_t *stream);
+static cy_rslt_t queue_frame(http2_client_t *client, uint8_t type, uint8_t flags, uint32_t stream_id,
+                             const uint8_t *payload, uint32_t length);
+static cy_rslt_t queue_window_update(http2_client_t *client, uint32_t stream_id, uint32_t increment);
+static cy_rslt_t flush(http2_client_t *client);
+static uint32_t hpack_write_integer(uint8_t *buffer, uint8_t first, uint32_t prefix_bits, uint32_t value);
+static uint32_t hpack_write_literal(uint8_t *buffer, uint32_t name_index, const char *value);
+static bool hpack_decode_block(const uint8_t *block, uint32_t length, uint16_t *status_code);
+static bool hpack_read_integer(const uint8_t *block, uint32_t length, uint32_t *index,
+                               uint32_t prefix_bits, uint32_t *value);
+static bool hpack_read_string(const uint8_t *block, uint32_t length, uint32_t *index,
+                              char *text, uint32_t size, uint32_t *text_length);
+static bool huffman_decode(const uint8_t *data, uint32_t length, char *text, uint32_t size, uint32_t *text_length);
+static void write_u32(uint8_t *buffer, uint32_t value);
+static uint32_t read_u32(const uint8_t *buffer);
+static uint32_t allocated_heap(void);
+static void http1_worker_task(void *arg);
+static void count_http2_response(const http2_event_t *event, void *arg);
+static void count_http1_response(const http_pipeline_event_t *event, void *arg);
+static void print_bench_row(const char *name, const bench_counts_t *counts, uint32_t elapsed_ms,
+                            uint32_t ram_bytes, uint32_t streams);
+
+/*******************************************************************************
+ * Function Name: http2_client_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up an HTTP/2 client. The connection is opened by the first
+ *  http2_client_get().
+ *
+ * Parameters:
+ *  client - Client to set up.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http2_client_init(http2_client_t *client)
+{
+    memset(client, 0, sizeof(*client));
+}
+
+/*******************************************************************************
+ * Function Name: http2_client_get
+ *******************************************************************************
+ * Summary:
+ *  Gets a list of resources over the client's connection, up to
+ *  HTTP2_MAX_STREAMS at once, each on its own stream, and passes the
+ *  responses to the callback as their frames arrive. A new stream is
+ *  opened as each response completes.
+ *
+ *  Streams refused by the server and streams above the last one the server
+ *  processes when it sends GOAWAY are sent again, on a new connection for
+ *  GOAWAY. When the connection closes, the open streams are sent again on a
+ *  new connection.
+ *
+ * Parameters:
+ *  client - Client.
+ *  paths - Resource paths.
+ *  count - Number of paths.
+ *  callback - Called with the responses.
+ *  arg - Argument passed to the callback.
+ *  stats - Filled with the statistics of the call. Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if all the responses were received,
+ *  otherwise, the error of the TLS stream or CY_RSLT_TYPE_ERROR for a
+ *  protocol error or too many closed connections.
+ *
+ *******************************************************************************/
+cy_rslt_t http2_client_get(http2_client_t *client, const char *const *paths, uint32_t count,
+                           http2_cb_t callback, void *arg, http2_stats_t *stats)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    http2_stats_t call_stats;
+    TickType_t start_ticks = xTaskGetTickCount();
+    uint32_t retries = 0;
+    uint32_t received;
+    uint32_t error;
+    uint8_t goaway[8];
+
+    memset(&call_stats, 0, sizeof(call_stats));
+
+    client->paths = paths;
+    client->count = count;
+    client->started = 0;
+    client->completed = 0;
+    client->callback = callback;
+    client->callback_arg = arg;
+    client->stats = &call_stats;
+
+    while (client->completed < count)
+    {
+        if (!client->stream.connected)
+        {
+            result = open_connection(client);
+            if (CY_RSLT_SUCCESS != result)
+            {
+                break;
+            }
+            call_stats.connections++;
+        }
+
+        result = open_streams(client);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = tls_stream_recv(&client->stream, client->rx_buffer, sizeof(client->rx_buffer), &received);
+        }
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            error = parse_frames(client, client->rx_buffer, received);
+            if (ERROR_NONE != error)
+            {
+                ERR_INFO(("HTTP/2 connection error %lu.\n", (unsigned long)error));
+                write_u32(&goaway[0], client->next_stream_id - 2u);
+                write_u32(&goaway[4], error);
+                client->tx_length = 0;
+                (void)queue_frame(client, FRAME_GOAWAY, 0, 0, goaway, sizeof(goaway));
+                (void)flush(client);
+                drop_connection(client);
+                result = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+
+            result = flush(client);
+            if ((CY_RSLT_SUCCESS == result) && !(client->goaway && (0u == client->active_streams)))
+            {
+                continue;
+            }
+        }
+        else if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            ERR_INFO(("Timed out waiting for the HTTP/2 responses.\n"));
+            drop_connection(client);
+            break;
+        }
+
+        /* The connection closed, or the server is going away and has
+         * finished the streams it accepted: continue on a new connection.
+         */
+        result = CY_RSLT_SUCCESS;
+        drop_connection(client);
+
+        if (client->completed >= count)
+        {
+            break;
+        }
+
+        if (0u == client->responses_on_connection)
+        {
+            if (++retries > HTTP2_MAX_RETRIES)
+            {
+                ERR_INFO(("The server closed %u connections without a response.\n", HTTP2_MAX_RETRIES + 1u));
+                result = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+        }
+        else
+        {
+            retries = 0;
+        }
+    }
+
+    /* Streams left over by a failure are not sent again by the next call. */
+    if (CY_RSLT_SUCCESS != result)
+    {
+        memset(client->streams, 0, sizeof(client->streams));
+        client->active_streams = 0;
+    }
+
+    call_stats.responses = client->completed;
+    call_stats.elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+    client->stats = NULL;
+
+    if (NULL != stats)
+    {
+        *stats = call_stats;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: http2_client_close
+ *******************************************************************************
+ * Summary:
+ *  Sends GOAWAY and closes the connection of a client.
+ *
+ * Parameters:
+ *  client - Client.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http2_client_close(http2_client_t *client)
+{
+    uint8_t goaway[8];
+
+    if (client->stream.connected)
+    {
+        write_u32(&goaway[0], 0);
+        write_u32(&goaway[4], ERROR_NONE);
+        client->tx_length = 0;
+        (void)queue_frame(client, FRAME_GOAWAY, 0, 0, goaway, sizeof(goaway));
+        (void)flush(client);
+    }
+
+    drop_connection(client);
+    memset(client->streams, 0, sizeof(client->streams));
+    client->active_streams = 0;
+}
+
+/*******************************************************************************
+ * Function Name: http2_client_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Gets HTTP2_BENCH_PATH HTTP2_BENCH_REQUESTS times over HTTP2_MAX_STREAMS
+ *  concurrent streams of one HTTP/2 connection, and then over as many
+ *  HTTP/1.1 connections, each served by its own task. Connections are
+ *  opened before the measurement. Prints the throughput and the RAM per
+ *  concurrent request: the heap taken by the open connections, which is
+ *  mostly the TLS context of each, and by the tasks, plus the state of the
+ *  clients.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http2_client_benchmark(void)
+{
+    static const char *paths[HTTP2_BENCH_REQUESTS];
+    const char *warmup_path = HTTP2_BENCH_PATH;
+    http2_stats_t stats;
+    bench_counts_t counts;
+    TickType_t start_ticks;
+    cy_rslt_t result;
+    uint32_t heap_before;
+    uint32_t heap_connected;
+    uint32_t workers = 0;
+    uint32_t elapsed_ms;
+
+    for (uint32_t i = 0; i < HTTP2_BENCH_REQUESTS; i++)
+    {
+        paths[i] = HTTP2_BENCH_PATH;
+    }
+
+    APP_INFO(("%u GET requests of %s, %u at a time\n", HTTP2_BENCH_REQUESTS, HTTP2_BENCH_PATH, HTTP2_MAX_STREAMS));
+    printf("\n  %-18s %9s %8s %6s %11s %9s %12s\n",
+           "transport", "responses", "body B", "ms", "requests/s", "RAM B", "RAM/request");
+
+    /* HTTP/2: one connection, concurrent streams. */
+    http2_client_init(&bench_client);
+    memset(&counts, 0, sizeof(counts));
+    heap_before = allocated_heap();
+
+    result = http2_client_get(&bench_client, &warmup_path, 1, count_http2_response, &counts, NULL);
+    heap_connected = allocated_heap();
+    if (CY_RSLT_SUCCESS == result)
+    {
+        memset(&counts, 0, sizeof(counts));
+        result = http2_client_get(&bench_client, paths, HTTP2_BENCH_REQUESTS, count_http2_response, &counts, &stats);
+    }
+    http2_client_close(&bench_client);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        print_bench_row("HTTP/2 streams", &counts, stats.elapsed_ms,
+                        (heap_connected - heap_before) + (uint32_t)sizeof(http2_client_t), stats.max_streams);
+        if (0u != stats.resets)
+        {
+            ERR_INFO(("%lu streams were reset by the server.\n", (unsigned long)stats.resets));
+        }
+    }
+    else
+    {
+        ERR_INFO(("The HTTP/2 requests failed: 0x%08lx\n", (unsigned long)result));
+    }
+
+    /* HTTP/1.1: one connection and one task per concurrent request. */
+    bench_ready = xSemaphoreCreateCounting(HTTP2_MAX_STREAMS, 0);
+    bench_start = xSemaphoreCreateCounting(HTTP2_MAX_STREAMS, 0);
+    bench_done = xSemaphoreCreateCounting(HTTP2_MAX_STREAMS, 0);
+    if ((NULL == bench_ready) || (NULL == bench_start) || (NULL == bench_done))
+    {
+        ERR_INFO(("Failed to create the benchmark semaphores.\n"));
+    }
+    else
+    {
+        heap_before = allocated_heap();
+
+        for (uint32_t i = 0; i < HTTP2_MAX_STREAMS; i++)
+        {
+            memset(&http1_workers[i], 0, sizeof(http1_workers[i]));
+            http1_workers[i].paths = &paths[(HTTP2_BENCH_REQUESTS * i) / HTTP2_MAX_STREAMS];
+            http1_workers[i].count = ((HTTP2_BENCH_REQUESTS * (i + 1u)) / HTTP2_MAX_STREAMS) -
+                                     ((HTTP2_BENCH_REQUESTS * i) / HTTP2_MAX_STREAMS);
+
+            if (pdPASS != xTaskCreate(http1_worker_task, "HTTP/1.1 Bench", HTTP2_BENCH_TASK_STACK_SIZE,
+                                      &http1_workers[i], HTTP2_BENCH_TASK_PRIORITY, NULL))
+            {
+                ERR_INFO(("Failed to create the task of HTTP/1.1 connection %lu.\n", (unsigned long)i));
+                break;
+            }
+            workers++;
+        }
+
+        /* All connections are open before the measurement starts. */
+        for (uint32_t i = 0; i < workers; i++)
+        {
+            xSemaphoreTake(bench_ready, portMAX_DELAY);
+        }
+        heap_connected = allocated_heap();
+
+        start_ticks = xTaskGetTickCount();
+        for (uint32_t i = 0; i < workers; i++)
+        {
+            xSemaphoreGive(bench_start);
+        }
+        for (uint32_t i = 0; i < workers; i++)
+        {
+            xSemaphoreTake(bench_done, portMAX_DELAY);
+        }
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+
+        memset(&counts, 0, sizeof(counts));
+        result = (HTTP2_MAX_STREAMS == workers) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+        for (uint32_t i = 0; i < workers; i++)
+        {
+            counts.responses += http1_workers[i].counts.responses;
+            counts.body_bytes += http1_workers[i].counts.body_bytes;
+            counts.errors += http1_workers[i].counts.errors;
+            if (CY_RSLT_SUCCESS != http1_workers[i].result)
+            {
+                ERR_INFO(("HTTP/1.1 connection %lu failed: 0x%08lx\n", (unsigned long)i,
+                          (unsigned long)http1_workers[i].result));
+                result = http1_workers[i].result;
+            }
+        }
+
+        if ((CY_RSLT_SUCCESS == result) || (0u != counts.responses))
+        {
+            print_bench_row("HTTP/1.1 conns", &counts, elapsed_ms,
+                            (heap_connected - heap_before) + (workers * (uint32_t)sizeof(http1_worker_t)), workers);
+        }
+        printf("  The HTTP/1.1 RAM includes the stack of the task of each connection.\n");
+    }
+
+    if (NULL != bench_ready)
+    {
+        vSemaphoreDelete(bench_ready);
+    }
+    if (NULL != bench_start)
+    {
+        vSemaphoreDelete(bench_start);
+    }
+    if (NULL != bench_done)
+    {
+        vSemaphoreDelete(bench_done);
+    }
+    bench_ready = NULL;
+    bench_start = NULL;
+    bench_done = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: open_connection
+ *******************************************************************************
+ * Summary:
+ *  Opens the TLS connection with ALPN "h2" and sends the connection preface
+ *  with the client's SETTINGS: no dynamic HPACK table, no server push, and
+ *  the stream window sized for the MCU.
+ *
+ *******************************************************************************/
+static cy_rslt_t open_connection(http2_client_t *client)
+{
+    static const uint16_t settings_ids[] =
+    {
+        SETTINGS_HEADER_TABLE_SIZE, SETTINGS_ENABLE_PUSH, SETTINGS_INITIAL_WINDOW_SIZE, SETTINGS_MAX_HEADER_LIST_SIZE
+    };
+    static const uint32_t settings_values[] =
+    {
+        0u, 0u, HTTP2_STREAM_WINDOW_SIZE, HTTP2_FRAME_BUFFER_SIZE
+    };
+    uint8_t settings[sizeof(settings_ids) / sizeof(settings_ids[0]) * SETTINGS_ENTRY_SIZE];
+    cy_rslt_t result;
+
+    result = tls_stream_connect_alpn(&client->stream, HTTPS_SERVER_HOST, HTTPS_PORT,
+                                     TRANSPORT_SEND_RECV_TIMEOUT_MS, HTTP2_ALPN);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    client->ready = true;
+    client->server_settings = false;
+    client->goaway = false;
+    client->next_stream_id = 1;
+    client->max_streams = HTTP2_MAX_STREAMS;
+    client->unacknowledged = 0;
+    client->responses_on_connection = 0;
+    client->header_length = 0;
+    client->block_length = 0;
+    client->block_stream_id = 0;
+    client->tx_length = 0;
+
+    for (uint32_t i = 0; i < (sizeof(settings_ids) / sizeof(settings_ids[0])); i++)
+    {
+        settings[i * SETTINGS_ENTRY_SIZE] = (uint8_t)(settings_ids[i] >> 8);
+        settings[(i * SETTINGS_ENTRY_SIZE) + 1u] = (uint8_t)settings_ids[i];
+        write_u32(&settings[(i * SETTINGS_ENTRY_SIZE) + 2u], settings_values[i]);
+    }
+
+    memcpy(client->tx_buffer, CONNECTION_PREFACE, CONNECTION_PREFACE_SIZE);
+    client->tx_length = CONNECTION_PREFACE_SIZE;
+
+    result = queue_frame(client, FRAME_SETTINGS, 0, 0, settings, sizeof(settings));
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flush(client);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: drop_connection
+ *******************************************************************************
+ * Summary:
+ *  Closes the TLS connection. The open streams are sent again on the next
+ *  connection.
+ *
+ *******************************************************************************/
+static void drop_connection(http2_client_t *client)
+{
+    tls_stream_close(&client->stream);
+    client->ready = false;
+
+    for (uint32_t i = 0; i < HTTP2_MAX_STREAMS; i++)
+    {
+        if (0u != client->streams[i].id)
+        {
+            restart_stream(client, &client->streams[i]);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: open_streams
+ *******************************************************************************
+ * Summary:
+ *  Starts streams up to the limit: first the requests to send again, then
+ *  the next requests. No stream is started after GOAWAY.
+ *
+ *******************************************************************************/
+static cy_rslt_t open_streams(http2_client_t *client)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    http2_stream_t *stream;
+
+    for (uint32_t i = 0; (i < HTTP2_MAX_STREAMS) && (CY_RSLT_SUCCESS == result); i++)
+    {
+        stream = &client->streams[i];
+        if (stream->pending && !client->goaway && (client->active_streams < client->max_streams))
+        {
+            result = start_stream(client, stream, stream->index);
+        }
+    }
+
+    for (uint32_t i = 0; (i < HTTP2_MAX_STREAMS) && (CY_RSLT_SUCCESS == result); i++)
+    {
+        stream = &client->streams[i];
+        if ((0u == stream->id) && !stream->pending && !client->goaway &&
+            (client->active_streams < client->max_streams) && (client->started < client->count))
+        {
+            result = start_stream(client, stream, client->started++);
+        }
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flush(client);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: start_stream
+ *******************************************************************************
+ * Summary:
+ *  Queues the HEADERS frame of a GET request on a new stream. The method,
+ *  scheme, and a path of "/" are indexed fields of the static table; the
+ *  other path and the authority are literals, not Huffman coded.
+ *
+ *******************************************************************************/
+static cy_rslt_t start_stream(http2_client_t *client, http2_stream_t *stream, uint32_t index)
+{
+    uint8_t block[HTTP2_TX_BUFFER_SIZE - FRAME_HEADER_SIZE];
+    const char *path = client->paths[index];
+    uint32_t length = 0;
+    cy_rslt_t result;
+
+    if ((strlen(path) + strlen(HTTPS_SERVER_HOST) + 16u) > sizeof(block))
+    {
+        ERR_INFO(("The request for %s does not fit in %u bytes.\n", path, HTTP2_TX_BUFFER_SIZE));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    block[length++] = HPACK_INDEXED | HPACK_METHOD_GET;
+    block[length++] = HPACK_INDEXED | HPACK_SCHEME_HTTPS;
+    if (0 == strcmp(path, "/"))
+    {
+        block[length++] = HPACK_INDEXED | HPACK_PATH;
+    }
+    else
+    {
+        length += hpack_write_literal(&block[length], HPACK_PATH, path);
+    }
+    length += hpack_write_literal(&block[length], HPACK_AUTHORITY, HTTPS_SERVER_HOST);
+
+    result = queue_frame(client, FRAME_HEADERS, FLAG_END_HEADERS | FLAG_END_STREAM, client->next_stream_id,
+                         block, length);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->id = client->next_stream_id;
+    stream->index = index;
+    client->next_stream_id += 2u;
+    client->active_streams++;
+
+    if ((NULL != client->stats) && (client->active_streams > client->stats->max_streams))
+    {
+        client->stats->max_streams = client->active_streams;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: parse_frames
+ *******************************************************************************
+ * Summary:
+ *  Parses received bytes, which can span any number of frames. DATA
+ *  payloads are passed on as they arrive; other payloads are collected in
+ *  the frame buffer.
+ *
+ * Return:
+ *  uint32_t: ERROR_NONE, or the error code of a connection error.
+ *
+ *******************************************************************************/
+static uint32_t parse_frames(http2_client_t *client, const uint8_t *data, uint32_t length)
+{
+    uint32_t error = ERROR_NONE;
+    uint32_t take;
+
+    while ((length > 0u) && (ERROR_NONE == error))
+    {
+        if (client->header_length < FRAME_HEADER_SIZE)
+        {
+            take = FRAME_HEADER_SIZE - client->header_length;
+            take = (take < length) ? take : length;
+            memcpy(&client->header[client->header_length], data, take);
+            client->header_length += take;
+            data += take;
+            length -= take;
+
+            if (FRAME_HEADER_SIZE == client->header_length)
+            {
+                error = start_frame(client);
+                if ((ERROR_NONE == error) && (0u == client->frame_length))
+                {
+                    error = end_frame(client);
+                }
+            }
+            continue;
+        }
+
+        take = client->frame_length - client->frame_received;
+        take = (take < length) ? take : length;
+
+        if (FRAME_DATA == client->frame_type)
+        {
+            error = receive_data(client, data, take);
+        }
+        else
+        {
+            /* A CONTINUATION is appended to the header block. */
+            memcpy(&client->frame[client->block_length + client->frame_received], data, take);
+        }
+
+        client->frame_received += take;
+        data += take;
+        length -= take;
+
+        if ((ERROR_NONE == error) && (client->frame_received == client->frame_length))
+        {
+            error = end_frame(client);
+        }
+    }
+
+    return error;
+}
+
+/*******************************************************************************
+ * Function Name: start_frame
+ *******************************************************************************
+ * Summary:
+ *  Checks a frame header. The first frame must be the server's SETTINGS,
+ *  and a header block must continue with CONTINUATION frames of its stream.
+ *
+ *******************************************************************************/
+static uint32_t start_frame(http2_client_t *client)
+{
+    client->frame_length = ((uint32_t)client->header[0] << 16) | ((uint32_t)client->header[1] << 8) |
+                           client->header[2];
+    client->frame_type = client->header[3];
+    client->frame_flags = client->header[4];
+    client->frame_stream_id = read_u32(&client->header[5]) & 0x7FFFFFFFu;
+    client->frame_received = 0;
+    client->padding = 0;
+
+    if (!client->server_settings && (FRAME_SETTINGS != client->frame_type))
+    {
+        ERR_INFO(("The server did not answer with HTTP/2.\n"));
+        return ERROR_PROTOCOL;
+    }
+
+    if (client->frame_length > MAX_FRAME_SIZE)
+    {
+        return ERROR_FRAME_SIZE;
+    }
+
+    if ((0u != client->block_stream_id) !=
+        ((FRAME_CONTINUATION == client->frame_type) && (client->frame_stream_id == client->block_stream_id)))
+    {
+        return ERROR_PROTOCOL;
+    }
+
+    if ((FRAME_DATA != client->frame_type) &&
+        ((client->block_length + client->frame_length) > sizeof(client->frame)))
+    {
+        ERR_INFO(("An HTTP/2 frame of type %u does not fit in %u bytes.\n", client->frame_type,
+                  HTTP2_FRAME_BUFFER_SIZE));
+        return ERROR_INTERNAL;
+    }
+
+    return ERROR_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: receive_data
+ *******************************************************************************
+ * Summary:
+ *  Passes the data of a DATA frame to the callback, without its padding.
+ *  Data of streams that are no longer open is dropped.
+ *
+ *******************************************************************************/
+static uint32_t receive_data(http2_client_t *client, const uint8_t *data, uint32_t length)
+{
+    http2_stream_t *stream;
+    http2_event_t event;
+    uint32_t position = client->frame_received;
+    uint32_t end;
+
+    if ((0u != (client->frame_flags & FLAG_PADDED)) && (0u == position) && (length > 0u))
+    {
+        client->padding = data[0];
+        if ((client->padding + 1u) > client->frame_length)
+        {
+            return ERROR_PROTOCOL;
+        }
+        data++;
+        length--;
+        position++;
+    }
+
+    end = client->frame_length - client->padding;
+    if (position >= end)
+    {
+        return ERROR_NONE;
+    }
+    if (length > (end - position))
+    {
+        length = end - position;
+    }
+
+    stream = find_stream(client, client->frame_stream_id);
+    if ((NULL == stream) || (0u == length) || (NULL == client->callback))
+    {
+        return ERROR_NONE;
+    }
+
+    event.index = stream->index;
+    event.status_code = stream->status_code;
+    event.offset = stream->offset;
+    event.data = data;
+    event.length = length;
+    event.complete = false;
+    client->callback(&event, client->callback_arg);
+
+    stream->offset += length;
+
+    return ERROR_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: end_frame
+ *******************************************************************************
+ * Summary:
+ *  Acts on a frame once it has been received in full.
+ *
+ *******************************************************************************/
+static uint32_t end_frame(http2_client_t *client)
+{
+    uint32_t error = ERROR_NONE;
+    uint32_t start = 0;
+    uint32_t padding = 0;
+    http2_stream_t *stream = find_stream(client, client->frame_stream_id);
+
+    client->header_length = 0;
+
+    switch (client->frame_type)
+    {
+        case FRAME_DATA:
+            error = (0u == client->frame_stream_id) ? ERROR_PROTOCOL : end_data_frame(client, stream);
+            break;
+
+        case FRAME_HEADERS:
+            if (0u == client->frame_stream_id)
+            {
+                return ERROR_PROTOCOL;
+            }
+            if (0u != (client->frame_flags & FLAG_PADDED))
+            {
+                padding = (client->frame_length > 0u) ? client->frame[0] : 0u;
+                start = 1u;
+            }
+            if (0u != (client->frame_flags & FLAG_PRIORITY))
+            {
+                start += 5u;
+            }
+            if ((start + padding) > client->frame_length)
+            {
+                return ERROR_PROTOCOL;
+            }
+            client->block_length = client->frame_length - start - padding;
+            memmove(client->frame, &client->frame[start], client->block_length);
+            client->block_stream_id = client->frame_stream_id;
+            client->block_end_stream = (0u != (client->frame_flags & FLAG_END_STREAM));
+            if (0u != (client->frame_flags & FLAG_END_HEADERS))
+            {
+                error = end_header_block(client);
+            }
+            break;
+
+        case FRAME_CONTINUATION:
+            client->block_length += client->frame_length;
+            if (0u != (client->frame_flags & FLAG_END_HEADERS))
+            {
+                error = end_header_block(client);
+            }
+            break;
+
+        case FRAME_RST_STREAM:
+            if (4u != client->frame_length)
+            {
+                return ERROR_FRAME_SIZE;
+            }
+            if (NULL == stream)
+            {
+                break;
+            }
+            if (ERROR_REFUSED_STREAM == read_u32(client->frame))
+            {
+                /* Not processed: send it again once a stream closes. */
+                if (client->active_streams > 1u)
+                {
+                    client->max_streams = client->active_streams - 1u;
+                }
+                restart_stream(client, stream);
+            }
+            else
+            {
+                ERR_INFO(("HTTP/2 stream %lu was reset with error %lu.\n", (unsigned long)stream->id,
+                          (unsigned long)read_u32(client->frame)));
+                client->stats->resets++;
+                stream->status_code = 0;
+                complete_stream(client, stream);
+            }
+            break;
+
+        case FRAME_SETTINGS:
+            error = receive_settings(client);
+            break;
+
+        case FRAME_PUSH_PROMISE:
+            /* Push is disabled in the client's SETTINGS. */
+            error = ERROR_PROTOCOL;
+            break;
+
+        case FRAME_PING:
+            if (8u != client->frame_length)
+            {
+                return ERROR_FRAME_SIZE;
+            }
+            if (0u == (client->frame_flags & FLAG_ACK))
+            {
+                error = (CY_RSLT_SUCCESS == queue_frame(client, FRAME_PING, FLAG_ACK, 0, client->frame, 8u)) ?
+                        ERROR_NONE : ERROR_INTERNAL;
+            }
+            break;
+
+        case FRAME_GOAWAY:
+            error = receive_goaway(client);
+            break;
+
+        case FRAME_WINDOW_UPDATE:
+            /* The client sends no DATA, so its send windows do not matter. */
+            error = (4u == client->frame_length) ? ERROR_NONE : ERROR_FRAME_SIZE;
+            break;
+
+        default:
+            /* PRIORITY and unknown frames are ignored. */
+            break;
+    }
+
+    return error;
+}
+
+/*******************************************************************************
+ * Function Name: end_data_frame
+ *******************************************************************************
+ * Summary:
+ *  Counts a DATA frame, padding included, against the receive windows and
+ *  returns half a window at a time with WINDOW_UPDATE. Completes the stream
+ *  on END_STREAM.
+ *
+ *******************************************************************************/
+static uint32_t end_data_frame(http2_client_t *client, http2_stream_t *stream)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    client->unacknowledged += client->frame_length;
+    if (client->unacknowledged >= (CONNECTION_WINDOW_SIZE / 2u))
+    {
+        result = queue_window_update(client, 0, client->unacknowledged);
+        client->unacknowledged = 0;
+    }
+
+    if (NULL == stream)
+    {
+        return (CY_RSLT_SUCCESS == result) ? ERROR_NONE : ERROR_INTERNAL;
+    }
+
+    if (0u != (client->frame_flags & FLAG_END_STREAM))
+    {
+        complete_stream(client, stream);
+    }
+    else
+    {
+        stream->unacknowledged += client->frame_length;
+        if ((CY_RSLT_SUCCESS == result) && (stream->unacknowledged >= (HTTP2_STREAM_WINDOW_SIZE / 2u)))
+        {
+            result = queue_window_update(client, stream->id, stream->unacknowledged);
+            stream->unacknowledged = 0;
+        }
+    }
+
+    return (CY_RSLT_SUCCESS == result) ? ERROR_NONE : ERROR_INTERNAL;
+}
+
+/*******************************************************************************
+ * Function Name: end_header_block
+ *******************************************************************************
+ * Summary:
+ *  Decodes a complete header block. The status of an interim 1xx response
+ *  and trailers are not kept.
+ *
+ *******************************************************************************/
+static uint32_t end_header_block(http2_client_t *client)
+{
+    http2_stream_t *stream = find_stream(client, client->block_stream_id);
+    uint16_t status_code = 0;
+    bool decoded = hpack_decode_block(client->frame, client->block_length, &status_code);
+
+    client->block_length = 0;
+    client->block_stream_id = 0;
+
+    if (!decoded)
+    {
+        return ERROR_COMPRESSION;
+    }
+
+    if (NULL == stream)
+    {
+        return ERROR_NONE;
+    }
+
+    if ((0u == stream->status_code) && (status_code >= 200u))
+    {
+        stream->status_code = status_code;
+    }
+
+    if (client->block_end_stream)
+    {
+        complete_stream(client, stream);
+    }
+
+    return ERROR_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: receive_settings
+ *******************************************************************************
+ * Summary:
+ *  Applies the server's SETTINGS and acknowledges them. Only the limit on
+ *  concurrent streams affects the client.
+ *
+ *******************************************************************************/
+static uint32_t receive_settings(http2_client_t *client)
+{
+    uint32_t value;
+
+    if (0u != client->frame_stream_id)
+    {
+        return ERROR_PROTOCOL;
+    }
+
+    if (0u != (client->frame_flags & FLAG_ACK))
+    {
+        return (0u == client->frame_length) ? ERROR_NONE : ERROR_FRAME_SIZE;
+    }
+
+    if (0u != (client->frame_length % SETTINGS_ENTRY_SIZE))
+    {
+        return ERROR_FRAME_SIZE;
+    }
+
+    for (uint32_t i = 0; i < client->frame_length; i += SETTINGS_ENTRY_SIZE)
+    {
+        value = read_u32(&client->frame[i + 2u]);
+        if ((SETTINGS_MAX_CONCURRENT_STREAMS == (((uint32_t)client->frame[i] << 8) | client->frame[i + 1u])) &&
+            (value < HTTP2_MAX_STREAMS))
+        {
+            client->max_streams = value;
+        }
+    }
+
+    client->server_settings = true;
+
+    return (CY_RSLT_SUCCESS == queue_frame(client, FRAME_SETTINGS, FLAG_ACK, 0, NULL, 0)) ?
+           ERROR_NONE : ERROR_INTERNAL;
+}
+
+/*******************************************************************************
+ * Function Name: receive_goaway
+ *******************************************************************************
+ * Summary:
+ *  Stops opening streams on the connection. The streams above the last one
+ *  the server processes are sent again on a new connection.
+ *
+ *******************************************************************************/
+static uint32_t receive_goaway(http2_client_t *client)
+{
+    uint32_t last_stream_id;
+    uint32_t error;
+
+    if ((0u != client->frame_stream_id) || (client->frame_length < 8u))
+    {
+        return (client->frame_length < 8u) ? ERROR_FRAME_SIZE : ERROR_PROTOCOL;
+    }
+
+    last_stream_id = read_u32(client->frame) & 0x7FFFFFFFu;
+    error = read_u32(&client->frame[4]);
+    client->goaway = true;
+
+    if (ERROR_NONE != error)
+    {
+        ERR_INFO(("The server sent GOAWAY with error %lu.\n", (unsigned long)error));
+    }
+
+    for (uint32_t i = 0; i < HTTP2_MAX_STREAMS; i++)
+    {
+        if (client->streams[i].id > last_stream_id)
+        {
+            restart_stream(client, &client->streams[i]);
+        }
+    }
+
+    return ERROR_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: find_stream
+ *******************************************************************************
+ * Summary:
+ *  Returns the open stream with an ID, or NULL.
+ *
+ *******************************************************************************/
+static http2_stream_t *find_stream(http2_client_t *client, uint32_t id)
+{
+    if (0u == id)
+    {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < HTTP2_MAX_STREAMS; i++)
+    {
+        if (id == client->streams[i].id)
+        {
+            return &client->streams[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: complete_stream
+ *******************************************************************************
+ * Summary:
+ *  Passes the end of a response to the callback and frees its stream.
+ *
+ *******************************************************************************/
+static void complete_stream(http2_client_t *client, http2_stream_t *stream)
+{
+    http2_event_t event;
+
+    if (NULL != client->callback)
+    {
+        event.index = stream->index;
+        event.status_code = stream->status_code;
+        event.offset = stream->offset;
+        event.data = NULL;
+        event.length = 0;
+        event.complete = true;
+        client->callback(&event, client->callback_arg);
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    client->active_streams--;
+    client->completed++;
+    client->responses_on_connection++;
+}
+
+/*******************************************************************************
+ * Function Name: restart_stream
+ *******************************************************************************
+ * Summary:
+ *  Closes a stream whose request is to be sent again.
+ *
+ *******************************************************************************/
+static void restart_stream(http2_client_t *client, http2_stream_t *stream)
+{
+    uint32_t index = stream->index;
+
+    memset(stream, 0, sizeof(*stream));
+    stream->index = index;
+    stream->pending = true;
+    client->active_streams--;
+}
+
+/*******************************************************************************
+ * Function Name: queue_frame
+ *******************************************************************************
+ * Summary:
+ *  Adds a frame to the transmit buffer, sending the buffer first if the
+ *  frame does not fit.
+ *
+ *******************************************************************************/
+static cy_rslt_t queue_frame(http2_client_t *client, uint8_t type, uint8_t flags, uint32_t stream_id,
+                             const uint8_t *payload, uint32_t length)
+{
+    cy_rslt_t result;
+    uint8_t *header;
+
+    if ((client->tx_length + FRAME_HEADER_SIZE + length) > sizeof(client->tx_buffer))
+    {
+        result = flush(client);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+    }
+
+    header = &client->tx_buffer[client->tx_length];
+    header[0] = (uint8_t)(length >> 16);
+    header[1] = (uint8_t)(length >> 8);
+    header[2] = (uint8_t)length;
+    header[3] = type;
+    header[4] = flags;
+    write_u32(&header[5], stream_id);
+    if (0u != length)
+    {
+        memcpy(&header[FRAME_HEADER_SIZE], payload, length);
+    }
+    client->tx_length += FRAME_HEADER_SIZE + length;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: queue_window_update
+ *******************************************************************************
+ * Summary:
+ *  Queues a WINDOW_UPDATE for the connection (stream 0) or a stream.
+ *
+ *******************************************************************************/
+static cy_rslt_t queue_window_update(http2_client_t *client, uint32_t stream_id, uint32_t increment)
+{
+    uint8_t payload[4];
+
+    write_u32(payload, increment);
+    if (NULL != client->stats)
+    {
+        client->stats->window_updates++;
+    }
+
+    return queue_frame(client, FRAME_WINDOW_UPDATE, 0, stream_id, payload, sizeof(payload));
+}
+
+/*******************************************************************************
+ * Function Name: flush
+ *******************************************************************************
+ * Summary:
+ *  Sends the frames in the transmit buffer in one write.
+ *
+ *******************************************************************************/
+static cy_rslt_t flush(http2_client_t *client)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (0u != client->tx_length)
+    {
+        result = tls_stream_send(&client->stream, client->tx_buffer, client->tx_length);
+        client->tx_length = 0;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: hpack_write_integer
+ *******************************************************************************
+ * Summary:
+ *  Writes an HPACK integer with a prefix of some bits after the first bits
+ *  of a representation.
+ *
+ *******************************************************************************/
+static uint32_t hpack_write_integer(uint8_t *buffer, uint8_t first, uint32_t prefix_bits, uint32_t value)
+{
+    uint32_t limit = (1u << prefix_bits) - 1u;
+    uint32_t length = 0;
+
+    if (value < limit)
+    {
+        buffer[length++] = (uint8_t)(first | value);
+        return length;
+    }
+
+    buffer[length++] = (uint8_t)(first | limit);
+    value -= limit;
+    while (value >= 0x80u)
+    {
+        buffer[length++] = (uint8_t)((value & 0x7Fu) | 0x80u);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: hpack_write_literal
+ *******************************************************************************
+ * Summary:
+ *  Writes a literal field without indexing, with the name from the static
+ *  table and the value as a raw string.
+ *
+ *******************************************************************************/
+static uint32_t hpack_write_literal(uint8_t *buffer, uint32_t name_index, const char *value)
+{
+    uint32_t value_length = (uint32_t)strlen(value);
+    uint32_t length;
+
+    length = hpack_write_integer(buffer, 0x00u, 4u, name_index);
+    length += hpack_write_integer(&buffer[length], 0x00u, 7u, value_length);
+    memcpy(&buffer[length], value, value_length);
+
+    return length + value_length;
+}
+
+/*******************************************************************************
+ * Function Name: hpack_decode_block
+ *******************************************************************************
+ * Summary:
+ *  Decodes a header block and returns its :status. The client announces a
+ *  dynamic table of size 0, so the server can only index the static table,
+ *  its literals are never stored, and a size update can only be to 0.
+ *
+ * Return:
+ *  bool: false if the block is malformed.
+ *
+ *******************************************************************************/
+static bool hpack_decode_block(const uint8_t *block, uint32_t length, uint16_t *status_code)
+{
+    char name[HTTP2_MAX_HEADER_VALUE];
+    char value[HTTP2_MAX_HEADER_VALUE];
+    const char *field_name;
+    const char *field_value;
+    uint32_t index = 0;
+    uint32_t table_index;
+    uint32_t name_length;
+    uint32_t value_length;
+    uint8_t first;
+
+    while (index < length)
+    {
+        first = block[index];
+
+        if (0u != (first & HPACK_INDEXED))
+        {
+            if (!hpack_read_integer(block, length, &index, 7u, &table_index) || (0u == table_index) ||
+                (table_index > (sizeof(hpack_static_table) / sizeof(hpack_static_table[0]))))
+            {
+                return false;
+            }
+            field_name = hpack_static_table[table_index - 1u].name;
+            field_value = hpack_static_table[table_index - 1u].value;
+            value_length = (uint32_t)strlen(field_value);
+        }
+        else if ((first & 0xE0u) == HPACK_SIZE_UPDATE)
+        {
+            if (!hpack_read_integer(block, length, &index, 5u, &table_index) || (0u != table_index))
+            {
+                return false;
+            }
+            continue;
+        }
+        else
+        {
+            /* A literal, with incremental indexing (6-bit prefix) or without
+             * indexing (4-bit prefix); none is stored.
+             */
+            if (!hpack_read_integer(block, length, &index, (0u != (first & HPACK_INCREMENTAL)) ? 6u : 4u,
+                                    &table_index) ||
+                (table_index > (sizeof(hpack_static_table) / sizeof(hpack_static_table[0]))))
+            {
+                return false;
+            }
+
+            if (0u == table_index)
+            {
+                if (!hpack_read_string(block, length, &index, name, sizeof(name) - 1u, &name_length))
+                {
+                    return false;
+                }
+                name[name_length] = '\0';
+                field_name = name;
+            }
+            else
+            {
+                field_name = hpack_static_table[table_index - 1u].name;
+            }
+
+            if (!hpack_read_string(block, length, &index, value, sizeof(value) - 1u, &value_length))
+            {
+                return false;
+            }
+            value[value_length] = '\0';
+            field_value = value;
+        }
+
+        if ((0 == strcmp(field_name, ":status")) && (3u == value_length))
+        {
+            *status_code = (uint16_t)(((field_value[0] - '0') * 100) + ((field_value[1] - '0') * 10) +
+                                      (field_value[2] - '0'));
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: hpack_read_integer
+ *******************************************************************************
+ * Summary:
+ *  Reads an HPACK integer with a prefix of some bits.
+ *
+ *******************************************************************************/
+static bool hpack_read_integer(const uint8_t *block, uint32_t length, uint32_t *index,
+                               uint32_t prefix_bits, uint32_t *value)
+{
+    uint32_t limit = (1u << prefix_bits) - 1u;
+    uint32_t shift = 0;
+    uint8_t byte;
+
+    *value = block[(*index)++] & limit;
+    if (*value < limit)
+    {
+        return true;
+    }
+
+    do
+    {
+        if ((*index >= length) || (shift > 21u))
+        {
+            return false;
+        }
+        byte = block[(*index)++];
+        *value += (uint32_t)(byte & 0x7Fu) << shift;
+        shift += 7u;
+    } while (0u != (byte & 0x80u));
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: hpack_read_string
+ *******************************************************************************
+ * Summary:
+ *  Reads a raw or Huffman coded string, keeping at most size characters.
+ *
+ *******************************************************************************/
+static bool hpack_read_string(const uint8_t *block, uint32_t length, uint32_t *index,
+                              char *text, uint32_t size, uint32_t *text_length)
+{
+    uint32_t string_length;
+    bool huffman;
+
+    if (*index >= length)
+    {
+        return false;
+    }
+
+    huffman = (0u != (block[*index] & HPACK_HUFFMAN));
+    if (!hpack_read_integer(block, length, index, 7u, &string_length) || (string_length > (length - *index)))
+    {
+        return false;
+    }
+
+    if (huffman)
+    {
+        if (!huffman_decode(&block[*index], string_length, text, size, text_length))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        *text_length = (string_length < size) ? string_length : size;
+        memcpy(text, &block[*index], *text_length);
+    }
+
+    *index += string_length;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: huffman_decode
+ *******************************************************************************
+ * Summary:
+ *  Decodes a Huffman coded string one bit at a time with the canonical
+ *  code. The padding must be fewer than 8 one bits, and EOS must not
+ *  appear.
+ *
+ *******************************************************************************/
+static bool huffman_decode(const uint8_t *data, uint32_t length, char *text, uint32_t size, uint32_t *text_length)
+{
+    uint32_t code = 0;
+    uint32_t first = 0;
+    uint32_t index = 0;
+    uint32_t bits = 0;
+    uint32_t written = 0;
+    uint32_t bit;
+    bool ones = true;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        for (uint32_t shift = 8u; shift > 0u; shift--)
+        {
+            bit = (data[i] >> (shift - 1u)) & 1u;
+            code |= bit;
+            ones = ones && (0u != bit);
+            bits++;
+
+            if ((code - first) < huffman_counts[bits])
+            {
+                index += code - first;
+                if (index >= sizeof(huffman_symbols))
+                {
+                    return false;
+                }
+                if (written < size)
+                {
+                    text[written] = (char)huffman_symbols[index];
+                }
+                written++;
+                code = 0;
+                first = 0;
+                index = 0;
+                bits = 0;
+                ones = true;
+                continue;
+            }
+
+            if (HPACK_LONGEST_CODE == bits)
+            {
+                return false;
+            }
+            index += huffman_counts[bits];
+            first = (first + huffman_counts[bits]) << 1;
+            code <<= 1;
+        }
+    }
+
+    *text_length = (written < size) ? written : size;
+
+    return (bits < 8u) && ones;
+}
+
+/*******************************************************************************
+ * Function Name: write_u32
+ *******************************************************************************
+ * Summary:
+ *  Writes a 32-bit value in network byte order.
+ *
+ *******************************************************************************/
+static void write_u32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)(value >> 24);
+    buffer[1] = (uint8_t)(value >> 16);
+    buffer[2] = (uint8_t)(value >> 8);
+    buffer[3] = (uint8_t)value;
+}
+
+/*******************************************************************************
+ * Function Name: read_u32
+ *******************************************************************************
+ * Summary:
+ *  Reads a 32-bit value in network byte order.
+ *
+ *******************************************************************************/
+static uint32_t read_u32(const uint8_t *buffer)
+{
+    return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+/*******************************************************************************
+ * Function Name: allocated_heap
+ *******************************************************************************
+ * Summary:
+ *  Returns the bytes allocated from the heap, which FreeRTOS (heap_3),
+ *  mbedTLS, and the secure sockets all allocate from.
+ *
+ *******************************************************************************/
+static uint32_t allocated_heap(void)
+{
+    struct mallinfo info = mallinfo();
+
+    return (uint32_t)info.uordblks;
+}
+
+/*******************************************************************************
+ * Function Name: http1_worker_task
+ *******************************************************************************
+ * Summary:
+ *  Serves one HTTP/1.1 connection of the benchmark: opens it, waits for the
+ *  start, and gets its share of the requests one at a time.
+ *
+ *******************************************************************************/
+static void http1_worker_task(void *arg)
+{
+    http1_worker_t *worker = (http1_worker_t *)arg;
+    const char *warmup_path = HTTP2_BENCH_PATH;
+    bench_counts_t warmup;
+
+    memset(&warmup, 0, sizeof(warmup));
+    http_pipeline_init(&worker->pipeline, 1);
+    worker->result = http_pipeline_get(&worker->pipeline, &warmup_path, 1, count_http1_response, &warmup, NULL);
+
+    xSemaphoreGive(bench_ready);
+    xSemaphoreTake(bench_start, portMAX_DELAY);
+
+    if (CY_RSLT_SUCCESS == worker->result)
+    {
+        worker->result = http_pipeline_get(&worker->pipeline, worker->paths, worker->count,
+                                           count_http1_response, &worker->counts, NULL);
+    }
+    http_pipeline_close(&worker->pipeline);
+
+    xSemaphoreGive(bench_done);
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+ * Function Name: count_http2_response
+ *******************************************************************************
+ * Summary:
+ *  Counts the responses and body bytes of the HTTP/2 benchmark.
+ *
+ *******************************************************************************/
+static void count_http2_response(const http2_event_t *event, void *arg)
+{
+    bench_counts_t *counts = (bench_counts_t *)arg;
+
+    if (!event->complete)
+    {
+        counts->body_bytes += event->length;
+        return;
+    }
+
+    counts->responses++;
+    if (HTTP_STATUS_OK != event->status_code)
+    {
+        counts->errors++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: count_http1_response
+ *******************************************************************************
+ * Summary:
+ *  Counts the responses and body bytes of an HTTP/1.1 connection.
+ *
+ *******************************************************************************/
+static void count_http1_response(const http_pipeline_event_t *event, void *arg)
+{
+    bench_counts_t *counts = (bench_counts_t *)arg;
+
+    if (!event->complete)
+    {
+        counts->body_bytes += event->length;
+        return;
+    }
+
+    counts->responses++;
+    if (HTTP_STATUS_OK != event->status_code)
+    {
+        counts->errors++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: print_bench_row
+ *******************************************************************************
+ * Summary:
+ *  Prints the results of one transport of the benchmark.
+ *
+ *******************************************************************************/
+static void print_bench_row(const char *name, const bench_counts_t *counts, uint32_t elapsed_ms,
+                            uint32_t ram_bytes, uint32_t streams)
+{
+    if (0u == elapsed_ms)
+    {
+        elapsed_ms = 1;
+    }
+    if (0u == streams)
+    {
+        streams = 1;
+    }
+
+    printf("  %-18s %9lu %8lu %6lu %11lu %9lu %12lu\n", name, (unsigned long)counts->responses,
+           (unsigned long)counts->body_bytes, (unsigned long)elapsed_ms,
+           (unsigned long)((counts->responses * 1000u) / elapsed_ms), (unsigned long)ram_bytes,
+           (unsigned long)(ram_bytes / streams));
+
+    if (0u != counts->errors)
+    {
+        ERR_INFO(("%lu responses had an error status.\n", (unsigned long)counts->errors));
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,204 @@
+/******************************************************************************
+* File Name: http2_client.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the HTTP/2 client, which multiplexes concurrent GET requests
+* as streams of one TLS connection.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef HTTP2_CLIENT_H_
+#define HTTP2_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "tls_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Protocol offered with ALPN. Only HTTP/2 is offered, so a server without it
+ * fails the handshake or answers with something other than its SETTINGS,
+ * and the request fails instead of falling back.
+ */
+#define HTTP2_ALPN                               "h2"
+
+/* Streams open at once. The server's SETTINGS_MAX_CONCURRENT_STREAMS
+ * lowers it.
+ */
+#define HTTP2_MAX_STREAMS                        (4)
+
+/* Receive window of each stream, sent as SETTINGS_INITIAL_WINDOW_SIZE. The
+ * body is passed to the callback as it arrives, so the window does not need
+ * RAM of its own; it bounds what the streams together can have in flight to
+ * HTTP2_MAX_STREAMS times this, which should fit in the TCP receive window
+ * (TCP_WND in lwipopts.h) so that one stream cannot stall the others. The
+ * window is returned with WINDOW_UPDATE once half of it is consumed.
+ */
+#define HTTP2_STREAM_WINDOW_SIZE                 (4096u)
+
+/* Buffer of the frames other than DATA, which holds a whole header block
+ * with its CONTINUATION frames. Also sent as SETTINGS_MAX_HEADER_LIST_SIZE.
+ * A larger header block closes the connection.
+ */
+#define HTTP2_FRAME_BUFFER_SIZE                  (1024)
+
+/* Receive and transmit buffers of the connection. DATA payloads are passed
+ * to the callback straight from the receive buffer.
+ */
+#define HTTP2_RX_BUFFER_SIZE                     (1024)
+#define HTTP2_TX_BUFFER_SIZE                     (512)
+
+/* Longest header value that is decoded. Longer values are skipped. */
+#define HTTP2_MAX_HEADER_VALUE                   (64)
+
+/* Times the open streams are sent again on a new connection when a
+ * connection closes before any response is complete.
+ */
+#define HTTP2_MAX_RETRIES                        (2)
+
+/* "HTTP/2 benchmark" menu option: requests made over HTTP2_MAX_STREAMS
+ * streams of one connection and over as many HTTP/1.1 connections, each
+ * served by its own task.
+ */
+#define HTTP2_BENCH_REQUESTS                     (20)
+#define HTTP2_BENCH_PATH                         "/"
+#define HTTP2_BENCH_TASK_STACK_SIZE              (4 * 1024)
+#define HTTP2_BENCH_TASK_PRIORITY                (1)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Part of a response passed to the callback. The responses of concurrent
+ * streams are interleaved; the body of each one is passed in order, in one
+ * or more calls, the last of which has complete set. A stream reset by the
+ * server completes with status_code 0. If the connection closes during a
+ * response, the request is sent again and the body restarts at offset 0.
+ */
+typedef struct
+{
+    uint32_t index;              /* Position of the request in the paths. */
+    uint16_t status_code;
+    uint32_t offset;             /* Offset of data in the body. */
+    const uint8_t *data;
+    uint32_t length;
+    bool complete;               /* Last call for this response. */
+} http2_event_t;
+
+typedef void (*http2_cb_t)(const http2_event_t *event, void *arg);
+
+/* Statistics of one http2_client_get() call. */
+typedef struct
+{
+    uint32_t responses;          /* Responses completed. */
+    uint32_t connections;        /* Connections opened. */
+    uint32_t resets;             /* Streams reset by the server. */
+    uint32_t window_updates;     /* WINDOW_UPDATE frames sent. */
+    uint32_t max_streams;        /* Most streams open at once. */
+    uint32_t elapsed_ms;
+} http2_stats_t;
+
+/* A request stream. */
+typedef struct
+{
+    uint32_t id;                 /* 0 when the slot is free. */
+    uint32_t index;
+    bool pending;                /* To be sent again on a new stream. */
+    bool ended;                  /* END_STREAM received. */
+    uint16_t status_code;
+    uint32_t offset;
+    uint32_t unacknowledged;     /* Bytes received since the last WINDOW_UPDATE. */
+} http2_stream_t;
+
+/* A connection and the state of its frame parser. */
+typedef struct
+{
+    tls_stream_t stream;
+    bool ready;                  /* Connection preface sent. */
+    bool server_settings;        /* First SETTINGS of the server received. */
+    bool goaway;
+    uint32_t next_stream_id;
+    uint32_t max_streams;
+    uint32_t active_streams;
+    uint32_t unacknowledged;     /* Connection bytes since the last WINDOW_UPDATE. */
+    http2_stream_t streams[HTTP2_MAX_STREAMS];
+
+    /* Requests of the current http2_client_get() call. */
+    const char *const *paths;
+    uint32_t count;
+    uint32_t started;
+    uint32_t completed;
+    uint32_t responses_on_connection;
+    http2_cb_t callback;
+    void *callback_arg;
+    http2_stats_t *stats;
+
+    /* Frame parser. */
+    uint8_t header[9];
+    uint32_t header_length;
+    uint32_t frame_length;
+    uint32_t frame_received;
+    uint8_t frame_type;
+    uint8_t frame_flags;
+    uint32_t frame_stream_id;
+    uint32_t padding;            /* Padding at the end of a DATA frame. */
+    uint32_t block_length;       /* Header block collected in frame. */
+    uint32_t block_stream_id;    /* Stream of an unfinished header block, 0 if none. */
+    bool block_end_stream;
+    uint8_t frame[HTTP2_FRAME_BUFFER_SIZE];
+
+    uint8_t rx_buffer[HTTP2_RX_BUFFER_SIZE];
+    uint8_t tx_buffer[HTTP2_TX_BUFFER_SIZE];
+    uint32_t tx_length;
+} http2_client_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void http2_client_init(http2_client_t *client);
+cy_rslt_t http2_client_get(http2_client_t *client, const char *const *paths, uint32_t count,
+                           http2_cb_t callback, void *arg, http2_stats_t *stats);
+void http2_client_close(http2_client_t *client);
+void http2_client_benchmark(void);
+
+#endif /* HTTP2_CLIENT_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1341 @@
+/******************************************************************************
+* File Name: http_pipeline.c
+*
+* Description: This file contains the pipelined HTTP/1.1 GET requests. Up
+* to a depth of requests are written back to back on one TLS connection and
+* the responses are parsed from the stream in order, so independent GETs
+* share round trips instead of costing one each. Responses with
+* Content-Length, chunked bodies, and bodies delimited by the end of the
+* connection are supported. Requests left without a response when the
+* server closes the connection are sent again on a new one; only GET is
+* pipelined, so this is safe.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "secure_http_client.h"
+#include "http_pipeline.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Parser states. */
+#define S_STATUS_LINE                    (0u)
+#define S_HEADER_LINE                    (1u)
+#define S_BODY                           (2u)
+#define S_BODY_TO_CLOSE                  (3u)
+#define S_CHUNK_SIZE                     (4u)
+#define S_CHUNK_DATA                     (5u)
+#define S_CHUNK_END                      (6u)
+#define S_TRAILER                        (7u)
+#define S_CLOSED                         (8u)
+
+/* Framing of the chunks of a request body. The size is written with a
+ * fixed number of digits, in space reserved before the data.
+ */
+#define CHUNK_SIZE_DIGITS                (4u)
+#define CHUNK_HEAD_LENGTH                (CHUNK_SIZE_DIGITS + 2u)
+#define CHUNK_TAIL_LENGTH                (2u)
+#define LAST_CHUNK                       "0\r\n\r\n"
+
+#define HTTP_STATUS_NO_CONTENT           (204u)
+#define HTTP_STATUS_NOT_MODIFIED         (304u)
+#define HTTP_STATUS_SWITCHING_PROTOCOLS  (101u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Totals of the benchmark responses. */
+typedef struct
+{
+    uint32_t responses;
+    uint32_t body_bytes;
+    uint32_t errors;
+} bench_counts_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static http_pipeline_t bench_pipeline;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t send_requests(http_pipeline_t *pipeline);
+static cy_rslt_t send_request(http_pipeline_t *pipeline, const http_pipeline_request_t *request);
+static cy_rslt_t receive_response(http_pipeline_t *pipeline);
+static void end_chunk(http_pipeline_t *pipeline);
+static cy_rslt_t flush_tx(http_pipeline_t *pipeline);
+static bool parse_responses(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length);
+static uint32_t take_line(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length, bool *complete);
+static bool parse_line(http_pipeline_t *pipeline);
+static bool parse_status_line(http_pipeline_t *pipeline);
+static void parse_header_line(http_pipeline_t *pipeline);
+static bool end_of_headers(http_pipeline_t *pipeline);
+static bool parse_chunk_size(http_pipeline_t *pipeline);
+static void deliver_body(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length);
+static void complete_response(http_pipeline_t *pipeline);
+static void start_response(http_pipeline_t *pipeline);
+static bool contains_token(const char *value, const char *token);
+static void count_bench_response(const http_pipeline_event_t *event, void *arg);
+
+/*******************************************************************************
+ * Function Name: http_pipeline_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up a pipeline. The connection is opened by the first request.
+ *
+ * Parameters:
+ *  pipeline - Pipeline to set up.
+ *  depth - Maximum number of outstanding requests, 1 to
+ *  HTTP_PIPELINE_MAX_DEPTH. 1 sends each request after the previous
+ *  response.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_pipeline_init(http_pipeline_t *pipeline, uint32_t depth)
+{
+    memset(pipeline, 0, sizeof(*pipeline));
+
+    if (depth < 1u)
+    {
+        depth = 1u;
+    }
+    else if (depth > HTTP_PIPELINE_MAX_DEPTH)
+    {
+        depth = HTTP_PIPELINE_MAX_DEPTH;
+    }
+
+    pipeline->max_depth = depth;
+    pipeline->depth = depth;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_get
+ *******************************************************************************
+ * Summary:
+ *  Gets a list of resources over the pipeline's connection and passes the
+ *  responses to the callback in the order of the paths. Up to the depth of
+ *  the pipeline, requests are written before their responses are read.
+ *
+ *  When the server closes the connection, after a response with
+ *  "Connection: close" or at any other point, the requests without a
+ *  complete response are sent again on a new connection. If the server
+ *  closed between two responses, the depth is lowered to the number of
+ *  responses it gave on the connection, so a server that closes after every
+ *  response is not sent requests that it drops.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *  paths - Resource paths.
+ *  count - Number of paths.
+ *  callback - Called with the responses.
+ *  arg - Argument passed to the callback.
+ *  stats - Filled with the statistics of the call. Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if all the responses were received,
+ *  otherwise, the error of the TLS stream or CY_RSLT_TYPE_ERROR for a
+ *  malformed response or too many closed connections.
+ *
+ *******************************************************************************/
+cy_rslt_t http_pipeline_get(http_pipeline_t *pipeline, const char *const *paths, uint32_t count,
+                            http_pipeline_cb_t callback, void *arg, http_pipeline_stats_t *stats)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    http_pipeline_stats_t call_stats;
+    TickType_t start_ticks = xTaskGetTickCount();
+    uint32_t retries = 0;
+    uint32_t received;
+    bool closed_between;
+
+    memset(&call_stats, 0, sizeof(call_stats));
+
+    pipeline->paths = paths;
+    pipeline->count = count;
+    pipeline->sent = 0;
+    pipeline->next_response = 0;
+    pipeline->callback = callback;
+    pipeline->header_cb = NULL;
+    pipeline->callback_arg = arg;
+    pipeline->stopped = false;
+
+    while (pipeline->next_response < count)
+    {
+        if (!pipeline->stream.connected)
+        {
+            result = tls_stream_connect(&pipeline->stream, HTTPS_SERVER_HOST, HTTPS_PORT,
+                                        TRANSPORT_SEND_RECV_TIMEOUT_MS);
+            if (CY_RSLT_SUCCESS != result)
+            {
+                break;
+            }
+
+            call_stats.connections++;
+            pipeline->connections++;
+            pipeline->sent = pipeline->next_response;
+            pipeline->responses_on_connection = 0;
+            start_response(pipeline);
+        }
+
+        result = send_requests(pipeline);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = tls_stream_recv(&pipeline->stream, pipeline->rx_buffer, sizeof(pipeline->rx_buffer), &received);
+        }
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            pipeline->rx_bytes += received;
+            if (!parse_responses(pipeline, pipeline->rx_buffer, received))
+            {
+                ERR_INFO(("Malformed response to request %lu of the pipeline.\n",
+                          (unsigned long)pipeline->next_response));
+                tls_stream_close(&pipeline->stream);
+                result = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+
+            if (S_CLOSED != pipeline->state)
+            {
+                continue;
+            }
+
+            /* The server announced that it closes the connection. */
+            tls_stream_close(&pipeline->stream);
+        }
+        else if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            ERR_INFO(("Timed out waiting for response %lu of the pipeline.\n",
+                      (unsigned long)pipeline->next_response));
+            tls_stream_close(&pipeline->stream);
+            break;
+        }
+        else if (S_BODY_TO_CLOSE == pipeline->state)
+        {
+            /* The end of the connection ends this body. */
+            complete_response(pipeline);
+        }
+
+        /* A close between responses is the server limiting the requests per
+         * connection. A close within a response is a failure.
+         */
+        closed_between = (S_CLOSED == pipeline->state) ||
+                         ((S_STATUS_LINE == pipeline->state) && (0u == pipeline->line_length));
+        result = CY_RSLT_SUCCESS;
+        tls_stream_close(&pipeline->stream);
+
+        if (pipeline->next_response >= count)
+        {
+            break;
+        }
+
+        if (0u == pipeline->responses_on_connection)
+        {
+            if (++retries > HTTP_PIPELINE_MAX_RETRIES)
+            {
+                ERR_INFO(("The server closed %u connections without a response.\n", HTTP_PIPELINE_MAX_RETRIES + 1u));
+                result = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+        }
+        else
+        {
+            retries = 0;
+            if (closed_between && (pipeline->responses_on_connection < pipeline->depth))
+            {
+                pipeline->depth = pipeline->responses_on_connection;
+            }
+        }
+
+        call_stats.resent += pipeline->sent - pipeline->next_response;
+    }
+
+    call_stats.responses = pipeline->next_response;
+    call_stats.elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+
+    if (NULL != stats)
+    {
+        *stats = call_stats;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_request
+ *******************************************************************************
+ * Summary:
+ *  Sends one request over the pipeline's connection and passes its response
+ *  to the callback as it arrives. A body is sent with chunked
+ *  Transfer-Encoding while the body function produces it, so its length
+ *  does not need to be known and it is never held whole in memory. When a
+ *  connection kept from an earlier request turns out to be closed before
+ *  any byte of the response arrived, the request is sent again on a new
+ *  connection; a request that timed out is not. Since no byte reached the
+ *  callbacks, a response is never assembled from two connections.
+ *
+ *  The callback can end the transfer early with http_pipeline_stop(). The
+ *  rest of the response is then dropped with the connection.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *  request - Request to send.
+ *  callback - Called with the response.
+ *  arg - Argument passed to the callback and to the header callback of the
+ *        request.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the response was received or the
+ *  transfer was stopped,
+ *  otherwise, the error of the TLS stream or of the body function, or
+ *  CY_RSLT_TYPE_ERROR for a malformed response.
+ *
+ *******************************************************************************/
+cy_rslt_t http_pipeline_request(http_pipeline_t *pipeline, const http_pipeline_request_t *request,
+                                http_pipeline_cb_t callback, void *arg)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    bool reused;
+
+    pipeline->paths = NULL;
+    pipeline->count = 1;
+    pipeline->callback = callback;
+    pipeline->header_cb = request->header_cb;
+    pipeline->callback_arg = arg;
+    pipeline->stopped = false;
+
+    for (uint32_t attempt = 0; attempt < 2u; attempt++)
+    {
+        reused = pipeline->stream.connected;
+        if (!reused)
+        {
+            result = tls_stream_connect(&pipeline->stream, HTTPS_SERVER_HOST, HTTPS_PORT,
+                                        TRANSPORT_SEND_RECV_TIMEOUT_MS);
+            if (CY_RSLT_SUCCESS != result)
+            {
+                break;
+            }
+            pipeline->connections++;
+        }
+
+        pipeline->sent = 0;
+        pipeline->next_response = 0;
+        pipeline->responses_on_connection = 0;
+        start_response(pipeline);
+
+        result = send_request(pipeline, request);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            pipeline->sent = 1;
+            result = receive_response(pipeline);
+        }
+
+        if ((CY_RSLT_SUCCESS == result) || !reused || (CY_RSLT_TYPE_ERROR == result) ||
+            (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result) ||
+            (S_STATUS_LINE != pipeline->state) || (0u != pipeline->line_length))
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_write_chunk
+ *******************************************************************************
+ * Summary:
+ *  Appends bytes to the body of the request being sent, from the body
+ *  function of http_pipeline_request(). The bytes are framed as chunks of
+ *  up to the transmit buffer, each sent in one write with the request head
+ *  or the end of the previous chunk.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *  data - Body bytes.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the bytes were taken, otherwise,
+ *  the error of the TLS stream.
+ *
+ *******************************************************************************/
+cy_rslt_t http_pipeline_write_chunk(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t used;
+
+    while ((CY_RSLT_SUCCESS == result) && (length > 0u))
+    {
+        if (!pipeline->in_chunk)
+        {
+            if ((pipeline->tx_length + CHUNK_HEAD_LENGTH + CHUNK_TAIL_LENGTH) >= sizeof(pipeline->tx_buffer))
+            {
+                result = flush_tx(pipeline);
+                if (CY_RSLT_SUCCESS != result)
+                {
+                    break;
+                }
+            }
+
+            pipeline->chunk_start = pipeline->tx_length;
+            pipeline->tx_length += CHUNK_HEAD_LENGTH;
+            pipeline->in_chunk = true;
+        }
+
+        used = sizeof(pipeline->tx_buffer) - CHUNK_TAIL_LENGTH - pipeline->tx_length;
+        used = (length < used) ? length : used;
+        memcpy(&pipeline->tx_buffer[pipeline->tx_length], data, used);
+        pipeline->tx_length += used;
+        data += used;
+        length -= used;
+
+        if ((pipeline->tx_length + CHUNK_TAIL_LENGTH) >= sizeof(pipeline->tx_buffer))
+        {
+            end_chunk(pipeline);
+            result = flush_tx(pipeline);
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_stop
+ *******************************************************************************
+ * Summary:
+ *  Ends the response of http_pipeline_request() being received, from its
+ *  callback. No further body bytes are passed, and the connection is closed
+ *  when the callback returns, so the rest of the body is not downloaded.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_pipeline_stop(http_pipeline_t *pipeline)
+{
+    pipeline->stopped = true;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_close
+ *******************************************************************************
+ * Summary:
+ *  Closes the connection of a pipeline and restores its depth.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_pipeline_close(http_pipeline_t *pipeline)
+{
+    tls_stream_close(&pipeline->stream);
+    pipeline->depth = pipeline->max_depth;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_expect_response
+ *******************************************************************************
+ * Summary:
+ *  Prepares the parser for one response to a request that the caller sent
+ *  on the pipeline's stream itself, for a response that is received by the
+ *  caller with http_pipeline_parse(), such as an event stream that stays
+ *  open for longer than one receive.
+ *
+ * Parameters:
+ *  pipeline - Pipeline whose stream carries the response.
+ *  callback - Called with the response, as for http_pipeline_request().
+ *  header_cb - Called with each header line. Can be NULL.
+ *  arg - Argument passed to both callbacks.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_pipeline_expect_response(http_pipeline_t *pipeline, http_pipeline_cb_t callback,
+                                   http_pipeline_header_cb_t header_cb, void *arg)
+{
+    pipeline->paths = NULL;
+    pipeline->count = 1;
+    pipeline->sent = 1;
+    pipeline->next_response = 0;
+    pipeline->responses_on_connection = 0;
+    pipeline->callback = callback;
+    pipeline->header_cb = header_cb;
+    pipeline->callback_arg = arg;
+    pipeline->stopped = false;
+    start_response(pipeline);
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_parse
+ *******************************************************************************
+ * Summary:
+ *  Passes received bytes of the response prepared with
+ *  http_pipeline_expect_response() to the parser, which calls the
+ *  callbacks. Bytes after the end of the response are not valid.
+ *
+ * Parameters:
+ *  pipeline - Pipeline.
+ *  data - Received bytes.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  bool: false if the bytes are not a valid response.
+ *
+ *******************************************************************************/
+bool http_pipeline_parse(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length)
+{
+    pipeline->rx_bytes += length;
+
+    return parse_responses(pipeline, data, length);
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_equals_token
+ *******************************************************************************
+ * Summary:
+ *  Compares a header name or value with a lowercase token, ignoring the case
+ *  of the text. For the header callbacks.
+ *
+ * Parameters:
+ *  text - Text to compare.
+ *  length - Length of the text.
+ *  token - Lowercase token.
+ *
+ * Return:
+ *  bool: true if the text is the token.
+ *
+ *******************************************************************************/
+bool http_pipeline_equals_token(const char *text, size_t length, const char *token)
+{
+    size_t index;
+
+    if (length != strlen(token))
+    {
+        return false;
+    }
+
+    for (index = 0; index < length; index++)
+    {
+        if (tolower((unsigned char)text[index]) != token[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: http_pipeline_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Gets HTTP_PIPELINE_BENCH_PATH HTTP_PIPELINE_BENCH_REQUESTS times, first
+ *  one request at a time and then pipelined, on a connection opened before
+ *  the measurement, and prints the requests per second of both.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_pipeline_benchmark(void)
+{
+    static const char *paths[HTTP_PIPELINE_BENCH_REQUESTS];
+    static const uint32_t depths[] = { 1, HTTP_PIPELINE_MAX_DEPTH };
+    const char *warmup_path = HTTP_PIPELINE_BENCH_PATH;
+    http_pipeline_stats_t stats;
+    bench_counts_t counts;
+    cy_rslt_t result;
+
+    for (uint32_t i = 0; i < HTTP_PIPELINE_BENCH_REQUESTS; i++)
+    {
+        paths[i] = HTTP_PIPELINE_BENCH_PATH;
+    }
+
+    APP_INFO(("%u GET requests of %s\n", HTTP_PIPELINE_BENCH_REQUESTS, HTTP_PIPELINE_BENCH_PATH));
+    printf("\n  %5s %9s %8s %6s %11s %11s %7s\n",
+           "depth", "responses", "body B", "ms", "ms/request", "requests/s", "resent");
+
+    for (uint32_t d = 0; d < (sizeof(depths) / sizeof(depths[0])); d++)
+    {
+        http_pipeline_init(&bench_pipeline, depths[d]);
+        memset(&counts, 0, sizeof(counts));
+
+        /* Open the connection outside the measurement. */
+        result = http_pipeline_get(&bench_pipeline, &warmup_path, 1, count_bench_response, &counts, NULL);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            memset(&counts, 0, sizeof(counts));
+            result = http_pipeline_get(&bench_pipeline, paths, HTTP_PIPELINE_BENCH_REQUESTS,
+                                       count_bench_response, &counts, &stats);
+        }
+        http_pipeline_close(&bench_pipeline);
+
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("The pipeline of depth %lu failed: 0x%08lx\n", (unsigned long)depths[d], (unsigned long)result));
+            return;
+        }
+
+        if (0u == stats.elapsed_ms)
+        {
+            stats.elapsed_ms = 1;
+        }
+
+        printf("  %5lu %9lu %8lu %6lu %11lu %11lu %7lu\n", (unsigned long)depths[d],
+               (unsigned long)counts.responses, (unsigned long)counts.body_bytes,
+               (unsigned long)stats.elapsed_ms, (unsigned long)(stats.elapsed_ms / HTTP_PIPELINE_BENCH_REQUESTS),
+               (unsigned long)((counts.responses * 1000u) / stats.elapsed_ms), (unsigned long)stats.resent);
+
+        if (0u != counts.errors)
+        {
+            ERR_INFO(("%lu responses had an error status.\n", (unsigned long)counts.errors));
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: send_requests
+ *******************************************************************************
+ * Summary:
+ *  Writes the next requests until the depth of the pipeline is reached. The
+ *  requests are collected in the transmit buffer and sent together.
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS, the error of the TLS stream, or
+ *  CY_RSLT_TYPE_ERROR if a request does not fit in the transmit buffer.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_requests(http_pipeline_t *pipeline)
+{
+    cy_rslt_t result;
+    uint32_t tx_length;
+    int length;
+
+    while ((pipeline->sent < pipeline->count) && ((pipeline->sent - pipeline->next_response) < pipeline->depth))
+    {
+        tx_length = 0;
+
+        while ((pipeline->sent < pipeline->count) &&
+               ((pipeline->sent - pipeline->next_response) < pipeline->depth))
+        {
+            length = snprintf(&pipeline->tx_buffer[tx_length], sizeof(pipeline->tx_buffer) - tx_length,
+                              "GET %s HTTP/1.1\r\nHost: %s:%u\r\n\r\n",
+                              pipeline->paths[pipeline->sent], HTTPS_SERVER_HOST, HTTPS_PORT);
+
+            if ((length < 0) || ((uint32_t)length >= (sizeof(pipeline->tx_buffer) - tx_length)))
+            {
+                if (0u == tx_length)
+                {
+                    ERR_INFO(("The request for %s does not fit in %u bytes.\n",
+                              pipeline->paths[pipeline->sent], HTTP_PIPELINE_TX_BUFFER_SIZE));
+                    return CY_RSLT_TYPE_ERROR;
+                }
+                break;
+            }
+
+            tx_length += (uint32_t)length;
+            pipeline->sent++;
+        }
+
+        result = tls_stream_send(&pipeline->stream, pipeline->tx_buffer, tx_length);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+        pipeline->tx_bytes += tx_length;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: send_request
+ *******************************************************************************
+ * Summary:
+ *  Writes the head of a request and its body, if any. The connection is
+ *  closed on failure, since a part of the request may have been sent.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_request(http_pipeline_t *pipeline, const http_pipeline_request_t *request)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    int length;
+
+    length = snprintf(pipeline->tx_buffer, sizeof(pipeline->tx_buffer),
+                      "%s %s HTTP/1.1\r\nHost: %s:%u\r\n%s%s\r\n",
+                      request->method, request->path, HTTPS_SERVER_HOST, HTTPS_PORT,
+                      (NULL != request->headers) ? request->headers : "",
+                      (NULL != request->body) ? "Transfer-Encoding: chunked\r\n" : "");
+    if ((length < 0) || ((uint32_t)length >= sizeof(pipeline->tx_buffer)))
+    {
+        ERR_INFO(("The request for %s does not fit in %u bytes.\n", request->path, HTTP_PIPELINE_TX_BUFFER_SIZE));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    pipeline->tx_length = (uint32_t)length;
+    pipeline->in_chunk = false;
+
+    if (NULL != request->body)
+    {
+        result = request->body(request->body_arg);
+        if ((CY_RSLT_SUCCESS == result) && pipeline->in_chunk)
+        {
+            end_chunk(pipeline);
+        }
+        if ((CY_RSLT_SUCCESS == result) &&
+            ((pipeline->tx_length + sizeof(LAST_CHUNK) - 1u) > sizeof(pipeline->tx_buffer)))
+        {
+            result = flush_tx(pipeline);
+        }
+        if (CY_RSLT_SUCCESS == result)
+        {
+            memcpy(&pipeline->tx_buffer[pipeline->tx_length], LAST_CHUNK, sizeof(LAST_CHUNK) - 1u);
+            pipeline->tx_length += sizeof(LAST_CHUNK) - 1u;
+        }
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flush_tx(pipeline);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        tls_stream_close(&pipeline->stream);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: receive_response
+ *******************************************************************************
+ * Summary:
+ *  Reads and parses the response to the request sent by
+ *  http_pipeline_request(). The connection is closed when the response
+ *  says so, when it fails, or when the callback stops the transfer.
+ *
+ *******************************************************************************/
+static cy_rslt_t receive_response(http_pipeline_t *pipeline)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t received;
+
+    while ((pipeline->next_response < pipeline->sent) && !pipeline->stopped)
+    {
+        result = tls_stream_recv(&pipeline->stream, pipeline->rx_buffer, sizeof(pipeline->rx_buffer), &received);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            if ((CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT != result) && (S_BODY_TO_CLOSE == pipeline->state))
+            {
+                /* The end of the connection ends this body. */
+                complete_response(pipeline);
+                result = CY_RSLT_SUCCESS;
+            }
+            break;
+        }
+        pipeline->rx_bytes += received;
+
+        if (!parse_responses(pipeline, pipeline->rx_buffer, received))
+        {
+            ERR_INFO(("Malformed response to the request.\n"));
+            result = CY_RSLT_TYPE_ERROR;
+            break;
+        }
+    }
+
+    if ((CY_RSLT_SUCCESS != result) || (S_CLOSED == pipeline->state) || pipeline->stopped)
+    {
+        tls_stream_close(&pipeline->stream);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: end_chunk
+ *******************************************************************************
+ * Summary:
+ *  Writes the size of the chunk being framed in the space reserved before
+ *  its data, and the line ending after it.
+ *
+ *******************************************************************************/
+static void end_chunk(http_pipeline_t *pipeline)
+{
+    char head[CHUNK_HEAD_LENGTH + 1u];
+
+    (void)snprintf(head, sizeof(head), "%0*lx\r\n", (int)CHUNK_SIZE_DIGITS,
+                   (unsigned long)(pipeline->tx_length - pipeline->chunk_start - CHUNK_HEAD_LENGTH));
+    memcpy(&pipeline->tx_buffer[pipeline->chunk_start], head, CHUNK_HEAD_LENGTH);
+    memcpy(&pipeline->tx_buffer[pipeline->tx_length], "\r\n", CHUNK_TAIL_LENGTH);
+    pipeline->tx_length += CHUNK_TAIL_LENGTH;
+    pipeline->in_chunk = false;
+}
+
+/*******************************************************************************
+ * Function Name: flush_tx
+ *******************************************************************************
+ * Summary:
+ *  Sends the bytes in the transmit buffer.
+ *
+ *******************************************************************************/
+static cy_rslt_t flush_tx(http_pipeline_t *pipeline)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (0u != pipeline->tx_length)
+    {
+        result = tls_stream_send(&pipeline->stream, pipeline->tx_buffer, pipeline->tx_length);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            pipeline->tx_bytes += pipeline->tx_length;
+        }
+        pipeline->tx_length = 0;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: parse_responses
+ *******************************************************************************
+ * Summary:
+ *  Parses received bytes, which can span any number of responses.
+ *
+ * Return:
+ *  bool: false if the bytes are not a valid response, or if a response
+ *  arrives for which no request is outstanding.
+ *
+ *******************************************************************************/
+static bool parse_responses(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length)
+{
+    uint32_t used;
+    bool complete;
+
+    while ((length > 0u) && (S_CLOSED != pipeline->state) && !pipeline->stopped)
+    {
+        switch (pipeline->state)
+        {
+            case S_BODY:
+            case S_CHUNK_DATA:
+            {
+                used = (length < pipeline->remaining) ? length : pipeline->remaining;
+                deliver_body(pipeline, data, used);
+                pipeline->remaining -= used;
+
+                if (0u == pipeline->remaining)
+                {
+                    if (S_BODY == pipeline->state)
+                    {
+                        complete_response(pipeline);
+                    }
+                    else
+                    {
+                        pipeline->state = S_CHUNK_END;
+                    }
+                }
+                break;
+            }
+
+            case S_BODY_TO_CLOSE:
+            {
+                used = length;
+                deliver_body(pipeline, data, used);
+                break;
+            }
+
+            default:
+            {
+                if ((S_STATUS_LINE == pipeline->state) && (pipeline->next_response >= pipeline->sent))
+                {
+                    return false;
+                }
+
+                used = take_line(pipeline, data, length, &complete);
+                if (complete && !parse_line(pipeline))
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        data += used;
+        length -= used;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: take_line
+ *******************************************************************************
+ * Summary:
+ *  Appends bytes to the line buffer up to and including the next line feed.
+ *  The line ending is not stored, and bytes beyond HTTP_PIPELINE_MAX_LINE
+ *  are dropped.
+ *
+ * Return:
+ *  uint32_t: Number of bytes consumed.
+ *
+ *******************************************************************************/
+static uint32_t take_line(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length, bool *complete)
+{
+    uint32_t used = 0;
+
+    *complete = false;
+
+    while (used < length)
+    {
+        char c = (char)data[used++];
+
+        if ('\n' == c)
+        {
+            if ((pipeline->line_length > 0u) && ('\r' == pipeline->line[pipeline->line_length - 1u]))
+            {
+                pipeline->line_length--;
+            }
+            pipeline->line[pipeline->line_length] = '\0';
+            *complete = true;
+            break;
+        }
+
+        if (pipeline->line_length < HTTP_PIPELINE_MAX_LINE)
+        {
+            pipeline->line[pipeline->line_length++] = c;
+        }
+    }
+
+    return used;
+}
+
+/*******************************************************************************
+ * Function Name: parse_line
+ *******************************************************************************
+ * Summary:
+ *  Handles a complete line in the current state.
+ *
+ * Return:
+ *  bool: false if the line is not valid.
+ *
+ *******************************************************************************/
+static bool parse_line(http_pipeline_t *pipeline)
+{
+    bool valid = true;
+    bool empty = (0u == pipeline->line_length);
+
+    switch (pipeline->state)
+    {
+        case S_STATUS_LINE:
+            /* Empty lines before a status line are tolerated (RFC 9112). */
+            valid = empty || parse_status_line(pipeline);
+            break;
+
+        case S_HEADER_LINE:
+            if (empty)
+            {
+                valid = end_of_headers(pipeline);
+            }
+            else
+            {
+                parse_header_line(pipeline);
+            }
+            break;
+
+        case S_CHUNK_SIZE:
+            valid = parse_chunk_size(pipeline);
+            break;
+
+        case S_CHUNK_END:
+            valid = empty;
+            pipeline->state = S_CHUNK_SIZE;
+            break;
+
+        case S_TRAILER:
+            if (empty)
+            {
+                complete_response(pipeline);
+            }
+            break;
+
+        default:
+            valid = false;
+            break;
+    }
+
+    pipeline->line_length = 0;
+
+    return valid;
+}
+
+/*******************************************************************************
+ * Function Name: parse_status_line
+ *******************************************************************************
+ * Summary:
+ *  Reads the version and status code. HTTP/1.0 responses close the
+ *  connection unless they say otherwise.
+ *
+ *******************************************************************************/
+static bool parse_status_line(http_pipeline_t *pipeline)
+{
+    const char *line = pipeline->line;
+
+    if ((pipeline->line_length < 12u) || (0 != strncmp(line, "HTTP/1.", 7)) || (' ' != line[8]) ||
+        !isdigit((unsigned char)line[9]) || !isdigit((unsigned char)line[10]) || !isdigit((unsigned char)line[11]))
+    {
+        return false;
+    }
+
+    pipeline->status_code = (uint16_t)(((line[9] - '0') * 100) + ((line[10] - '0') * 10) + (line[11] - '0'));
+    pipeline->has_length = false;
+    pipeline->chunked = false;
+    pipeline->close = ('0' == line[7]);
+    pipeline->content_length = 0;
+    pipeline->state = S_HEADER_LINE;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_header_line
+ *******************************************************************************
+ * Summary:
+ *  Reads the headers that frame the response: Content-Length,
+ *  Transfer-Encoding, and Connection. Every header is also passed to the
+ *  header callback of the request, if any.
+ *
+ *******************************************************************************/
+static void parse_header_line(http_pipeline_t *pipeline)
+{
+    char *value = strchr(pipeline->line, ':');
+    uint32_t length = 0;
+
+    if (NULL == value)
+    {
+        return;
+    }
+
+    *value++ = '\0';
+    while ((' ' == *value) || ('\t' == *value))
+    {
+        value++;
+    }
+
+    if (http_pipeline_equals_token(pipeline->line, strlen(pipeline->line), "content-length"))
+    {
+        while (isdigit((unsigned char)*value))
+        {
+            length = (length * 10u) + (uint32_t)(*value++ - '0');
+        }
+        pipeline->content_length = length;
+        pipeline->has_length = true;
+    }
+    else if (http_pipeline_equals_token(pipeline->line, strlen(pipeline->line), "transfer-encoding"))
+    {
+        pipeline->chunked = contains_token(value, "chunked");
+    }
+    else if (http_pipeline_equals_token(pipeline->line, strlen(pipeline->line), "connection"))
+    {
+        if (contains_token(value, "close"))
+        {
+            pipeline->close = true;
+        }
+        else if (contains_token(value, "keep-alive"))
+        {
+            pipeline->close = false;
+        }
+    }
+
+    if (NULL != pipeline->header_cb)
+    {
+        pipeline->header_cb(pipeline->line, value, pipeline->callback_arg);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: end_of_headers
+ *******************************************************************************
+ * Summary:
+ *  Works out how the body of the response is delimited (RFC 9112, 6.3).
+ *
+ *******************************************************************************/
+static bool end_of_headers(http_pipeline_t *pipeline)
+{
+    uint16_t status = pipeline->status_code;
+
+    if ((status < 200u) && (HTTP_STATUS_SWITCHING_PROTOCOLS != status))
+    {
+        /* Interim response: the final response to the same request follows. */
+        pipeline->state = S_STATUS_LINE;
+        return true;
+    }
+
+    if (HTTP_STATUS_SWITCHING_PROTOCOLS == status)
+    {
+        /* The stream is no longer HTTP/1.1 after this response. */
+        pipeline->close = true;
+        complete_response(pipeline);
+    }
+    else if ((HTTP_STATUS_NO_CONTENT == status) || (HTTP_STATUS_NOT_MODIFIED == status))
+    {
+        complete_response(pipeline);
+    }
+    else if (pipeline->chunked)
+    {
+        pipeline->state = S_CHUNK_SIZE;
+    }
+    else if (pipeline->has_length)
+    {
+        pipeline->remaining = pipeline->content_length;
+        pipeline->state = S_BODY;
+        if (0u == pipeline->remaining)
+        {
+            complete_response(pipeline);
+        }
+    }
+    else
+    {
+        pipeline->close = true;
+        pipeline->state = S_BODY_TO_CLOSE;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_chunk_size
+ *******************************************************************************
+ * Summary:
+ *  Reads the hexadecimal size of the next chunk. Chunk extensions are
+ *  ignored. A size of 0 starts the trailer.
+ *
+ *******************************************************************************/
+static bool parse_chunk_size(http_pipeline_t *pipeline)
+{
+    const char *digit = pipeline->line;
+    uint32_t size = 0;
+    uint32_t digits = 0;
+
+    while (isxdigit((unsigned char)*digit))
+    {
+        if (++digits > 8u)
+        {
+            return false;
+        }
+        size = (size << 4) | (uint32_t)(isdigit((unsigned char)*digit) ? (*digit - '0') :
+                                        ((tolower((unsigned char)*digit) - 'a') + 10));
+        digit++;
+    }
+
+    if (0u == digits)
+    {
+        return false;
+    }
+
+    if (0u == size)
+    {
+        pipeline->state = S_TRAILER;
+    }
+    else
+    {
+        pipeline->remaining = size;
+        pipeline->state = S_CHUNK_DATA;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: deliver_body
+ *******************************************************************************
+ * Summary:
+ *  Passes body bytes of the current response to the callback.
+ *
+ *******************************************************************************/
+static void deliver_body(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length)
+{
+    http_pipeline_event_t event;
+
+    if (0u == length)
+    {
+        return;
+    }
+
+    event.index = pipeline->next_response;
+    event.status_code = pipeline->status_code;
+    event.offset = pipeline->body_offset;
+    event.data = data;
+    event.length = length;
+    event.complete = false;
+
+    pipeline->callback(&event, pipeline->callback_arg);
+    pipeline->body_offset += length;
+}
+
+/*******************************************************************************
+ * Function Name: complete_response
+ *******************************************************************************
+ * Summary:
+ *  Reports the end of the current response and moves to the next one. If
+ *  the response closes the connection, the rest of the stream is ignored.
+ *
+ *******************************************************************************/
+static void complete_response(http_pipeline_t *pipeline)
+{
+    http_pipeline_event_t event;
+    bool close = pipeline->close;
+
+    event.index = pipeline->next_response;
+    event.status_code = pipeline->status_code;
+    event.offset = pipeline->body_offset;
+    event.data = NULL;
+    event.length = 0;
+    event.complete = true;
+
+    pipeline->callback(&event, pipeline->callback_arg);
+
+    pipeline->next_response++;
+    pipeline->responses_on_connection++;
+    start_response(pipeline);
+
+    if (close)
+    {
+        pipeline->state = S_CLOSED;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: start_response
+ *******************************************************************************
+ * Summary:
+ *  Resets the parser for the next response.
+ *
+ *******************************************************************************/
+static void start_response(http_pipeline_t *pipeline)
+{
+    pipeline->state = S_STATUS_LINE;
+    pipeline->line_length = 0;
+    pipeline->status_code = 0;
+    pipeline->has_length = false;
+    pipeline->chunked = false;
+    pipeline->close = false;
+    pipeline->content_length = 0;
+    pipeline->remaining = 0;
+    pipeline->body_offset = 0;
+}
+
+/*******************************************************************************
+ * Function Name: contains_token
+ *******************************************************************************
+ * Summary:
+ *  Checks whether a comma-separated header value contains a lowercase token,
+ *  ignoring case.
+ *
+ *******************************************************************************/
+static bool contains_token(const char *value, const char *token)
+{
+    size_t length;
+
+    while ('\0' != *value)
+    {
+        while ((' ' == *value) || ('\t' == *value) || (',' == *value))
+        {
+            value++;
+        }
+
+        length = strcspn(value, " \t,;");
+        if (http_pipeline_equals_token(value, length, token))
+        {
+            return true;
+        }
+
+        value += length;
+        value += strcspn(value, ",");
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: count_bench_response
+ *******************************************************************************
+ * Summary:
+ *  Counts the responses and body bytes of the benchmark.
+ *
+ *******************************************************************************/
+static void count_bench_response(const http_pipeline_event_t *event, void *arg)
+{
+    bench_counts_t *counts = (bench_counts_t *)arg;
+
+    if (!event->complete)
+    {
+        counts->body_bytes += event->length;
+        return;
+    }
+
+    counts->responses++;
+    if (HTTP_STATUS_OK != event->status_code)
+    {
+        counts->errors++;
+    }
+}
+
+/* [] END OF FILE */
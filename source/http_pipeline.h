@@ -0,0 +1,203 @@
+/******************************************************************************
+* File Name: http_pipeline.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the pipelined HTTP/1.1 GET requests.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef HTTP_PIPELINE_H_
+#define HTTP_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "tls_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Requests written before the first response is read. The depth is lowered
+ * until http_pipeline_close() if the server closes connections between
+ * responses with requests outstanding.
+ */
+#define HTTP_PIPELINE_MAX_DEPTH                  (8)
+
+/* Receive and transmit buffers of a pipeline. */
+#define HTTP_PIPELINE_RX_BUFFER_SIZE             (1024)
+#define HTTP_PIPELINE_TX_BUFFER_SIZE             (1024)
+
+/* Longest status line, header line, or chunk size line that is parsed. The
+ * rest of a longer line is skipped.
+ */
+#define HTTP_PIPELINE_MAX_LINE                   (128)
+
+/* Times the outstanding requests are sent again on a new connection when a
+ * connection closes before any response is complete.
+ */
+#define HTTP_PIPELINE_MAX_RETRIES                (2)
+
+/* Requests of the "pipelining benchmark" menu option. To measure at a given
+ * round-trip time, add the delay on the server, for example with
+ * "tc qdisc add dev <if> root netem delay 50ms", and run the option at 20,
+ * 50, and 150 ms.
+ */
+#define HTTP_PIPELINE_BENCH_REQUESTS             (20)
+#define HTTP_PIPELINE_BENCH_PATH                 "/"
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Part of a response passed to the callback. The body of each response is
+ * passed in order, in one or more calls, the last of which has complete set.
+ * If the connection closes during a response, the request is sent again and
+ * the body restarts at offset 0.
+ */
+typedef struct
+{
+    uint32_t index;              /* Position of the request in the paths. */
+    uint16_t status_code;
+    uint32_t offset;             /* Offset of data in the body. */
+    const uint8_t *data;
+    uint32_t length;
+    bool complete;               /* Last call for this response. */
+} http_pipeline_event_t;
+
+typedef void (*http_pipeline_cb_t)(const http_pipeline_event_t *event, void *arg);
+
+/* Writes the body of a request with http_pipeline_write_chunk(). Called
+ * again if the request is sent again on a new connection.
+ */
+typedef cy_rslt_t (*http_pipeline_body_t)(void *arg);
+
+/* Called with each header line of the response, before its body. The name
+ * and value are only valid during the call.
+ */
+typedef void (*http_pipeline_header_cb_t)(const char *name, const char *value, void *arg);
+
+/* Request sent with http_pipeline_request(). */
+typedef struct
+{
+    const char *method;          /* For example "POST". */
+    const char *path;
+    const char *headers;         /* Further header lines, each ending with CRLF. Can be NULL. */
+    http_pipeline_body_t body;   /* Writes a chunked body, NULL for no body. */
+    void *body_arg;
+    http_pipeline_header_cb_t header_cb; /* Gets the response headers, NULL to skip them. */
+} http_pipeline_request_t;
+
+/* Statistics of one http_pipeline_get() call. */
+typedef struct
+{
+    uint32_t responses;          /* Responses completed. */
+    uint32_t connections;        /* Connections opened. */
+    uint32_t resent;             /* Requests sent again after a connection closed. */
+    uint32_t elapsed_ms;
+} http_pipeline_stats_t;
+
+/* A persistent connection and the state of its response parser. */
+typedef struct
+{
+    tls_stream_t stream;
+    uint32_t max_depth;
+    uint32_t depth;
+
+    /* Requests of the current http_pipeline_get() call. */
+    const char *const *paths;
+    uint32_t count;
+    uint32_t sent;
+    uint32_t next_response;
+    uint32_t responses_on_connection;
+    http_pipeline_cb_t callback;
+    http_pipeline_header_cb_t header_cb;
+    void *callback_arg;
+    bool stopped;                /* Set by http_pipeline_stop(). */
+
+    /* Totals since http_pipeline_init(), for callers that measure the bytes
+     * on the wire. TLS framing and handshakes are not included.
+     */
+    uint32_t tx_bytes;           /* Bytes written to the TLS stream. */
+    uint32_t rx_bytes;           /* Bytes read from the TLS stream. */
+    uint32_t connections;        /* Connections opened, one TLS handshake each. */
+
+    /* Response parser. */
+    uint32_t state;
+    char line[HTTP_PIPELINE_MAX_LINE + 1];
+    uint32_t line_length;
+    uint16_t status_code;
+    bool has_length;
+    bool chunked;
+    bool close;
+    uint32_t content_length;
+    uint32_t remaining;
+    uint32_t body_offset;
+
+    /* Request being written. A chunk is framed in the transmit buffer and
+     * sent when the buffer is full.
+     */
+    uint32_t tx_length;
+    uint32_t chunk_start;
+    bool in_chunk;
+
+    uint8_t rx_buffer[HTTP_PIPELINE_RX_BUFFER_SIZE];
+    char tx_buffer[HTTP_PIPELINE_TX_BUFFER_SIZE];
+} http_pipeline_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void http_pipeline_init(http_pipeline_t *pipeline, uint32_t depth);
+cy_rslt_t http_pipeline_get(http_pipeline_t *pipeline, const char *const *paths, uint32_t count,
+                            http_pipeline_cb_t callback, void *arg, http_pipeline_stats_t *stats);
+cy_rslt_t http_pipeline_request(http_pipeline_t *pipeline, const http_pipeline_request_t *request,
+                                http_pipeline_cb_t callback, void *arg);
+cy_rslt_t http_pipeline_write_chunk(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length);
+void http_pipeline_stop(http_pipeline_t *pipeline);
+void http_pipeline_close(http_pipeline_t *pipeline);
+void http_pipeline_expect_response(http_pipeline_t *pipeline, http_pipeline_cb_t callback,
+                                   http_pipeline_header_cb_t header_cb, void *arg);
+bool http_pipeline_parse(http_pipeline_t *pipeline, const uint8_t *data, uint32_t length);
+bool http_pipeline_equals_token(const char *text, size_t length, const char *token);
+void http_pipeline_benchmark(void);
+
+#endif /* HTTP_PIPELINE_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1298 @@
+/******************************************************************************
+* File Name: inflater.c
+*
+* Description: This file contains the streaming deflate decoder (RFC 1951)
+* with the zlib (RFC 1950) and gzip (RFC 1952) wrappers. Compressed input is
+* fed in chunks of any size. The decoded data goes through a caller-supplied
+* window of 4 to 32 KB and is passed to a callback. The decoder uses no
+* heap.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <string.h>
+
+#include "inflater.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Decoder states. Each state resumes where the previous inflater_feed()
+ * call ran out of input.
+ */
+#define S_WRAPPER                        (0u)
+#define S_GZIP_HEADER                    (1u)
+#define S_GZIP_EXTRA_LEN                 (2u)
+#define S_GZIP_EXTRA                     (3u)
+#define S_GZIP_NAME                      (4u)
+#define S_GZIP_COMMENT                   (5u)
+#define S_GZIP_HCRC                      (6u)
+#define S_BLOCK_HEADER                   (7u)
+#define S_STORED_LEN                     (8u)
+#define S_STORED_NLEN                    (9u)
+#define S_STORED_COPY                    (10u)
+#define S_TABLE_COUNTS                   (11u)
+#define S_CODELEN_LENS                   (12u)
+#define S_CODE_LENS                      (13u)
+#define S_CODES                          (14u)
+#define S_LEN_EXTRA                      (15u)
+#define S_DIST                           (16u)
+#define S_DIST_EXTRA                     (17u)
+#define S_TRAILER                        (18u)
+#define S_DONE                           (19u)
+
+/* gzip header flags. */
+#define GZIP_FHCRC                       (0x02u)
+#define GZIP_FEXTRA                      (0x04u)
+#define GZIP_FNAME                       (0x08u)
+#define GZIP_FCOMMENT                    (0x10u)
+#define GZIP_FRESERVED                   (0xE0u)
+
+#define GZIP_HEADER_SIZE                 (10u)
+#define GZIP_TRAILER_SIZE                (8u)
+#define ZLIB_TRAILER_SIZE                (4u)
+
+#define NUM_CODELEN_CODES                (19u)
+#define MAX_LITLEN_LENGTHS               (286u)
+#define END_OF_BLOCK                     (256)
+
+#define ADLER_MOD                        (65521u)
+#define ADLER_BLOCK                      (5552u)
+
+#define MIN_WINDOW_SIZE                  (256u)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Base lengths and extra bits of length symbols 257..285. */
+static const uint16_t length_base[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/* Base distances and extra bits of distance symbols 0..29. */
+static const uint16_t dist_base[30] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* Order in which the code length code lengths are sent. */
+static const uint8_t codelen_order[NUM_CODELEN_CODES] =
+{
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/* CRC-32 (IEEE 802.3, reflected) of every nibble value. */
+static const uint32_t crc32_nibble_table[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool step(inflater_t *inf);
+static bool read_gzip_header(inflater_t *inf);
+static void next_gzip_state(inflater_t *inf);
+static bool read_zlib_header(inflater_t *inf);
+static bool read_block_header(inflater_t *inf);
+static bool read_stored(inflater_t *inf);
+static bool read_table_counts(inflater_t *inf);
+static bool read_codelen_lengths(inflater_t *inf);
+static bool read_code_lengths(inflater_t *inf);
+static bool decode_codes(inflater_t *inf);
+static bool copy_match(inflater_t *inf, uint32_t distance);
+static bool read_trailer(inflater_t *inf);
+static void end_block(inflater_t *inf);
+static void fill_bits(inflater_t *inf);
+static bool need_bits(inflater_t *inf, uint32_t count);
+static uint32_t get_bits(inflater_t *inf, uint32_t count);
+static int decode_symbol(inflater_t *inf, const inflater_huffman_t *huffman, int *symbol);
+static int build_huffman(inflater_huffman_t *huffman, const uint8_t *lengths, uint32_t num_symbols);
+static void build_fixed_tables(inflater_t *inf);
+static void put_byte(inflater_t *inf, uint8_t value);
+static void flush_window(inflater_t *inf);
+static uint32_t adler32(uint32_t adler, const uint8_t *data, size_t length);
+static void fail(inflater_t *inf, inflater_status_t status);
+
+/*******************************************************************************
+ * Function Name: inflater_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up a decoder for one compressed stream. The window must be at least
+ *  as large as the window the stream was compressed with, which is 32 KB for
+ *  most servers unless they are configured otherwise.
+ *
+ * Parameters:
+ *  inf - Decoder to set up.
+ *  format - Wrapper of the compressed data.
+ *  window - Output window.
+ *  window_size - Size of the window, a power of two up to 32 KB.
+ *  output - Called with the decoded data.
+ *  arg - Argument passed to the output callback.
+ *
+ * Return:
+ *  inflater_status_t: INFLATER_OK, or INFLATER_ERR_PARAM for an invalid
+ *  window size.
+ *
+ *******************************************************************************/
+inflater_status_t inflater_init(inflater_t *inf, inflater_format_t format, uint8_t *window,
+                                size_t window_size, inflater_output_t output, void *arg)
+{
+    memset(inf, 0, sizeof(*inf));
+
+    if ((NULL == window) || (window_size < MIN_WINDOW_SIZE) || (window_size > INFLATER_MAX_WINDOW_SIZE) ||
+        (0 != (window_size & (window_size - 1u))))
+    {
+        inf->status = INFLATER_ERR_PARAM;
+        return inf->status;
+    }
+
+    inf->format = format;
+    inf->status = INFLATER_OK;
+    inf->state = S_WRAPPER;
+    inf->window = window;
+    inf->window_mask = (uint32_t)window_size - 1u;
+    inf->output = output;
+    inf->output_arg = arg;
+    inf->check = (INFLATER_FORMAT_GZIP == format) ? 0u : 1u;
+
+    return inf->status;
+}
+
+/*******************************************************************************
+ * Function Name: inflater_feed
+ *******************************************************************************
+ * Summary:
+ *  Decodes the next chunk of compressed data. The data decoded from the
+ *  chunk is passed to the output callback before the function returns.
+ *
+ * Parameters:
+ *  inf - Decoder.
+ *  data - Next bytes of the compressed stream.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  inflater_status_t: INFLATER_OK if more input is needed, INFLATER_DONE at
+ *  the end of the stream, otherwise the reason the decoder stopped.
+ *
+ *******************************************************************************/
+inflater_status_t inflater_feed(inflater_t *inf, const uint8_t *data, size_t length)
+{
+    if (INFLATER_OK != inf->status)
+    {
+        return inf->status;
+    }
+
+    inf->in = data;
+    inf->in_left = length;
+
+    while ((INFLATER_OK == inf->status) && step(inf))
+    {
+    }
+
+    if ((INFLATER_OK == inf->status) || (INFLATER_DONE == inf->status))
+    {
+        flush_window(inf);
+    }
+
+    inf->in = NULL;
+    inf->in_left = 0;
+
+    return inf->status;
+}
+
+/*******************************************************************************
+ * Function Name: inflater_finish
+ *******************************************************************************
+ * Summary:
+ *  Ends the input.
+ *
+ * Parameters:
+ *  inf - Decoder.
+ *
+ * Return:
+ *  inflater_status_t: INFLATER_DONE if the stream was complete,
+ *  INFLATER_ERR_TRUNCATED if it was cut short, or the earlier error.
+ *
+ *******************************************************************************/
+inflater_status_t inflater_finish(inflater_t *inf)
+{
+    if (INFLATER_OK == inf->status)
+    {
+        inf->status = INFLATER_ERR_TRUNCATED;
+    }
+
+    return inf->status;
+}
+
+/*******************************************************************************
+ * Function Name: inflater_crc32
+ *******************************************************************************
+ * Summary:
+ *  Updates a CRC-32 as used by gzip. Start with 0.
+ *
+ * Parameters:
+ *  crc - CRC of the preceding data.
+ *  data - Next data.
+ *  length - Length of the data.
+ *
+ * Return:
+ *  uint32_t: CRC of the preceding and the next data.
+ *
+ *******************************************************************************/
+uint32_t inflater_crc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+    crc = ~crc;
+
+    while (length-- > 0)
+    {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0Fu];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0Fu];
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: step
+ *******************************************************************************
+ * Summary:
+ *  Runs the current state.
+ *
+ * Parameters:
+ *  inf - Decoder.
+ *
+ * Return:
+ *  bool: false if the input ran out before the state completed.
+ *
+ *******************************************************************************/
+static bool step(inflater_t *inf)
+{
+    switch (inf->state)
+    {
+        case S_WRAPPER:
+            if (INFLATER_FORMAT_GZIP == inf->format)
+            {
+                inf->state = S_GZIP_HEADER;
+            }
+            else if (INFLATER_FORMAT_RAW == inf->format)
+            {
+                inf->state = S_BLOCK_HEADER;
+            }
+            else
+            {
+                return read_zlib_header(inf);
+            }
+            return true;
+
+        case S_GZIP_HEADER:
+        case S_GZIP_EXTRA_LEN:
+        case S_GZIP_EXTRA:
+        case S_GZIP_NAME:
+        case S_GZIP_COMMENT:
+        case S_GZIP_HCRC:
+            return read_gzip_header(inf);
+
+        case S_BLOCK_HEADER:
+            return read_block_header(inf);
+
+        case S_STORED_LEN:
+        case S_STORED_NLEN:
+        case S_STORED_COPY:
+            return read_stored(inf);
+
+        case S_TABLE_COUNTS:
+            return read_table_counts(inf);
+
+        case S_CODELEN_LENS:
+            return read_codelen_lengths(inf);
+
+        case S_CODE_LENS:
+            return read_code_lengths(inf);
+
+        case S_CODES:
+        case S_LEN_EXTRA:
+        case S_DIST:
+        case S_DIST_EXTRA:
+            return decode_codes(inf);
+
+        case S_TRAILER:
+            return read_trailer(inf);
+
+        default:
+            inf->status = INFLATER_DONE;
+            return false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: read_gzip_header
+ *******************************************************************************
+ * Summary:
+ *  Parses the gzip member header and skips its optional fields.
+ *
+ *******************************************************************************/
+static bool read_gzip_header(inflater_t *inf)
+{
+    uint32_t value;
+
+    switch (inf->state)
+    {
+        case S_GZIP_HEADER:
+            while (inf->header_pos < GZIP_HEADER_SIZE)
+            {
+                if (!need_bits(inf, 8))
+                {
+                    return false;
+                }
+                value = get_bits(inf, 8);
+
+                if (((0u == inf->header_pos) && (0x1Fu != value)) ||
+                    ((1u == inf->header_pos) && (0x8Bu != value)) ||
+                    ((2u == inf->header_pos) && (8u != value)) ||
+                    ((3u == inf->header_pos) && (0u != (value & GZIP_FRESERVED))))
+                {
+                    fail(inf, INFLATER_ERR_DATA);
+                    return false;
+                }
+
+                if (3u == inf->header_pos)
+                {
+                    inf->header_flags = (uint8_t)value;
+                }
+                inf->header_pos++;
+            }
+            break;
+
+        case S_GZIP_EXTRA_LEN:
+            if (!need_bits(inf, 16))
+            {
+                return false;
+            }
+            inf->header_pos = get_bits(inf, 16);
+            inf->state = S_GZIP_EXTRA;
+            return true;
+
+        case S_GZIP_EXTRA:
+            while (inf->header_pos > 0)
+            {
+                if (!need_bits(inf, 8))
+                {
+                    return false;
+                }
+                (void)get_bits(inf, 8);
+                inf->header_pos--;
+            }
+            break;
+
+        case S_GZIP_NAME:
+        case S_GZIP_COMMENT:
+            do
+            {
+                if (!need_bits(inf, 8))
+                {
+                    return false;
+                }
+            } while (0u != get_bits(inf, 8));
+            break;
+
+        default:
+            if (!need_bits(inf, 16))
+            {
+                return false;
+            }
+            (void)get_bits(inf, 16);
+            break;
+    }
+
+    next_gzip_state(inf);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: next_gzip_state
+ *******************************************************************************
+ * Summary:
+ *  Moves to the next optional gzip header field that is present, or to the
+ *  first block.
+ *
+ *******************************************************************************/
+static void next_gzip_state(inflater_t *inf)
+{
+    if (0u != (inf->header_flags & GZIP_FEXTRA))
+    {
+        inf->header_flags &= (uint8_t)~GZIP_FEXTRA;
+        inf->state = S_GZIP_EXTRA_LEN;
+    }
+    else if (0u != (inf->header_flags & GZIP_FNAME))
+    {
+        inf->header_flags &= (uint8_t)~GZIP_FNAME;
+        inf->state = S_GZIP_NAME;
+    }
+    else if (0u != (inf->header_flags & GZIP_FCOMMENT))
+    {
+        inf->header_flags &= (uint8_t)~GZIP_FCOMMENT;
+        inf->state = S_GZIP_COMMENT;
+    }
+    else if (0u != (inf->header_flags & GZIP_FHCRC))
+    {
+        inf->header_flags &= (uint8_t)~GZIP_FHCRC;
+        inf->state = S_GZIP_HCRC;
+    }
+    else
+    {
+        inf->header_pos = 0;
+        inf->state = S_BLOCK_HEADER;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: read_zlib_header
+ *******************************************************************************
+ * Summary:
+ *  Parses the zlib header. For INFLATER_FORMAT_DEFLATE, data without a valid
+ *  zlib header is decoded as raw deflate.
+ *
+ *******************************************************************************/
+static bool read_zlib_header(inflater_t *inf)
+{
+    uint32_t cmf;
+    uint32_t flg;
+
+    if (!need_bits(inf, 16))
+    {
+        return false;
+    }
+
+    cmf = inf->bit_buf & 0xFFu;
+    flg = (inf->bit_buf >> 8) & 0xFFu;
+
+    if ((8u == (cmf & 0x0Fu)) && ((cmf >> 4) <= 7u) && (0u == (((cmf << 8) | flg) % 31u)) &&
+        (0u == (flg & 0x20u)))
+    {
+        (void)get_bits(inf, 16);
+        inf->format = INFLATER_FORMAT_ZLIB;
+    }
+    else if (INFLATER_FORMAT_DEFLATE == inf->format)
+    {
+        inf->format = INFLATER_FORMAT_RAW;
+    }
+    else
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    inf->state = S_BLOCK_HEADER;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_block_header
+ *******************************************************************************
+ * Summary:
+ *  Reads the final-block flag and the block type.
+ *
+ *******************************************************************************/
+static bool read_block_header(inflater_t *inf)
+{
+    if (!need_bits(inf, 3))
+    {
+        return false;
+    }
+
+    inf->last_block = (0u != get_bits(inf, 1));
+
+    switch (get_bits(inf, 2))
+    {
+        case 0:
+            /* Stored blocks start at a byte boundary. */
+            (void)get_bits(inf, inf->bit_count & 7u);
+            inf->state = S_STORED_LEN;
+            break;
+
+        case 1:
+            build_fixed_tables(inf);
+            inf->state = S_CODES;
+            break;
+
+        case 2:
+            inf->state = S_TABLE_COUNTS;
+            break;
+
+        default:
+            fail(inf, INFLATER_ERR_DATA);
+            return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_stored
+ *******************************************************************************
+ * Summary:
+ *  Reads the length of a stored block and copies its content.
+ *
+ *******************************************************************************/
+static bool read_stored(inflater_t *inf)
+{
+    if (S_STORED_LEN == inf->state)
+    {
+        if (!need_bits(inf, 16))
+        {
+            return false;
+        }
+        inf->copy_length = get_bits(inf, 16);
+        inf->state = S_STORED_NLEN;
+    }
+
+    if (S_STORED_NLEN == inf->state)
+    {
+        if (!need_bits(inf, 16))
+        {
+            return false;
+        }
+        if ((inf->copy_length ^ 0xFFFFu) != get_bits(inf, 16))
+        {
+            fail(inf, INFLATER_ERR_DATA);
+            return false;
+        }
+        inf->state = S_STORED_COPY;
+    }
+
+    while (inf->copy_length > 0)
+    {
+        if (!need_bits(inf, 8))
+        {
+            return false;
+        }
+        put_byte(inf, (uint8_t)get_bits(inf, 8));
+        inf->copy_length--;
+
+        if (INFLATER_OK != inf->status)
+        {
+            return false;
+        }
+    }
+
+    end_block(inf);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_table_counts
+ *******************************************************************************
+ * Summary:
+ *  Reads the code counts of a dynamic block.
+ *
+ *******************************************************************************/
+static bool read_table_counts(inflater_t *inf)
+{
+    if (!need_bits(inf, 14))
+    {
+        return false;
+    }
+
+    inf->num_litlen = (uint16_t)(get_bits(inf, 5) + 257u);
+    inf->num_dist = (uint16_t)(get_bits(inf, 5) + 1u);
+    inf->num_codelen = (uint16_t)(get_bits(inf, 4) + 4u);
+
+    if ((inf->num_litlen > MAX_LITLEN_LENGTHS) || (inf->num_dist > INFLATER_MAX_DIST_CODES))
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    inf->index = 0;
+    inf->state = S_CODELEN_LENS;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_codelen_lengths
+ *******************************************************************************
+ * Summary:
+ *  Reads the code length code of a dynamic block. The code is kept in the
+ *  literal/length table until the code lengths are decoded.
+ *
+ *******************************************************************************/
+static bool read_codelen_lengths(inflater_t *inf)
+{
+    while (inf->index < inf->num_codelen)
+    {
+        if (!need_bits(inf, 3))
+        {
+            return false;
+        }
+        inf->lengths[codelen_order[inf->index++]] = (uint8_t)get_bits(inf, 3);
+    }
+
+    while (inf->index < NUM_CODELEN_CODES)
+    {
+        inf->lengths[codelen_order[inf->index++]] = 0;
+    }
+
+    if (0 != build_huffman(&inf->litlen, inf->lengths, NUM_CODELEN_CODES))
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    inf->index = 0;
+    inf->symbol = -1;
+    inf->state = S_CODE_LENS;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: read_code_lengths
+ *******************************************************************************
+ * Summary:
+ *  Decodes the literal/length and distance code lengths of a dynamic block
+ *  and builds both codes.
+ *
+ *******************************************************************************/
+static bool read_code_lengths(inflater_t *inf)
+{
+    uint32_t total = (uint32_t)inf->num_litlen + inf->num_dist;
+    uint32_t repeat;
+    uint8_t length;
+    int symbol;
+    int result;
+
+    while (inf->index < total)
+    {
+        if (inf->symbol < 0)
+        {
+            result = decode_symbol(inf, &inf->litlen, &symbol);
+            if (result <= 0)
+            {
+                if (result < 0)
+                {
+                    fail(inf, INFLATER_ERR_DATA);
+                }
+                return false;
+            }
+
+            if (symbol < 16)
+            {
+                inf->lengths[inf->index++] = (uint8_t)symbol;
+                continue;
+            }
+            inf->symbol = (int16_t)symbol;
+        }
+
+        if (16 == inf->symbol)
+        {
+            if (!need_bits(inf, 2))
+            {
+                return false;
+            }
+            if (0u == inf->index)
+            {
+                fail(inf, INFLATER_ERR_DATA);
+                return false;
+            }
+            length = inf->lengths[inf->index - 1u];
+            repeat = 3u + get_bits(inf, 2);
+        }
+        else if (17 == inf->symbol)
+        {
+            if (!need_bits(inf, 3))
+            {
+                return false;
+            }
+            length = 0;
+            repeat = 3u + get_bits(inf, 3);
+        }
+        else
+        {
+            if (!need_bits(inf, 7))
+            {
+                return false;
+            }
+            length = 0;
+            repeat = 11u + get_bits(inf, 7);
+        }
+
+        if ((inf->index + repeat) > total)
+        {
+            fail(inf, INFLATER_ERR_DATA);
+            return false;
+        }
+
+        while (repeat-- > 0)
+        {
+            inf->lengths[inf->index++] = length;
+        }
+        inf->symbol = -1;
+    }
+
+    if (0u == inf->lengths[END_OF_BLOCK])
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    /* Incomplete codes are only allowed for a single code. */
+    result = build_huffman(&inf->litlen, inf->lengths, inf->num_litlen);
+    if ((result < 0) || ((result > 0) && (1u != (inf->num_litlen - inf->litlen.count[0]))))
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    result = build_huffman(&inf->dist, &inf->lengths[inf->num_litlen], inf->num_dist);
+    if ((result < 0) || ((result > 0) && (1u != (inf->num_dist - inf->dist.count[0]))))
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    inf->state = S_CODES;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: decode_codes
+ *******************************************************************************
+ * Summary:
+ *  Decodes the literals and matches of a compressed block.
+ *
+ *******************************************************************************/
+static bool decode_codes(inflater_t *inf)
+{
+    uint32_t distance;
+    int symbol;
+    int result;
+
+    while (INFLATER_OK == inf->status)
+    {
+        switch (inf->state)
+        {
+            case S_CODES:
+                result = decode_symbol(inf, &inf->litlen, &symbol);
+                if (result <= 0)
+                {
+                    if (result < 0)
+                    {
+                        fail(inf, INFLATER_ERR_DATA);
+                    }
+                    return false;
+                }
+
+                if (symbol < END_OF_BLOCK)
+                {
+                    put_byte(inf, (uint8_t)symbol);
+                    break;
+                }
+
+                if (END_OF_BLOCK == symbol)
+                {
+                    end_block(inf);
+                    return true;
+                }
+
+                symbol -= (END_OF_BLOCK + 1);
+                if (symbol >= (int)(sizeof(length_base) / sizeof(length_base[0])))
+                {
+                    fail(inf, INFLATER_ERR_DATA);
+                    return false;
+                }
+                inf->symbol = (int16_t)symbol;
+                inf->state = S_LEN_EXTRA;
+                /* Fall through */
+
+            case S_LEN_EXTRA:
+                if (!need_bits(inf, length_extra[inf->symbol]))
+                {
+                    return false;
+                }
+                inf->copy_length = length_base[inf->symbol] + get_bits(inf, length_extra[inf->symbol]);
+                inf->state = S_DIST;
+                /* Fall through */
+
+            case S_DIST:
+                result = decode_symbol(inf, &inf->dist, &symbol);
+                if (result <= 0)
+                {
+                    if (result < 0)
+                    {
+                        fail(inf, INFLATER_ERR_DATA);
+                    }
+                    return false;
+                }
+                if (symbol >= INFLATER_MAX_DIST_CODES)
+                {
+                    fail(inf, INFLATER_ERR_DATA);
+                    return false;
+                }
+                inf->symbol = (int16_t)symbol;
+                inf->state = S_DIST_EXTRA;
+                /* Fall through */
+
+            default:
+                if (!need_bits(inf, dist_extra[inf->symbol]))
+                {
+                    return false;
+                }
+                distance = dist_base[inf->symbol] + get_bits(inf, dist_extra[inf->symbol]);
+                inf->state = S_CODES;
+
+                if (!copy_match(inf, distance))
+                {
+                    return false;
+                }
+                break;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: copy_match
+ *******************************************************************************
+ * Summary:
+ *  Copies copy_length bytes from distance bytes back in the window.
+ *
+ *******************************************************************************/
+static bool copy_match(inflater_t *inf, uint32_t distance)
+{
+    if (distance > inf->total_out)
+    {
+        fail(inf, INFLATER_ERR_DATA);
+        return false;
+    }
+
+    if (distance > (inf->window_mask + 1u))
+    {
+        fail(inf, INFLATER_ERR_WINDOW);
+        return false;
+    }
+
+    while ((inf->copy_length > 0) && (INFLATER_OK == inf->status))
+    {
+        put_byte(inf, inf->window[(inf->window_pos - distance) & inf->window_mask]);
+        inf->copy_length--;
+    }
+
+    return (INFLATER_OK == inf->status);
+}
+
+/*******************************************************************************
+ * Function Name: read_trailer
+ *******************************************************************************
+ * Summary:
+ *  Reads the gzip or zlib trailer and compares it with the decoded data.
+ *
+ *******************************************************************************/
+static bool read_trailer(inflater_t *inf)
+{
+    uint32_t size = (INFLATER_FORMAT_GZIP == inf->format) ? GZIP_TRAILER_SIZE : ZLIB_TRAILER_SIZE;
+    uint32_t expected;
+    bool match;
+
+    while (inf->header_pos < size)
+    {
+        if (!need_bits(inf, 8))
+        {
+            return false;
+        }
+        inf->trailer[inf->header_pos++] = (uint8_t)get_bits(inf, 8);
+    }
+
+    /* The check value covers all decoded data. */
+    flush_window(inf);
+    if (INFLATER_OK != inf->status)
+    {
+        return false;
+    }
+
+    if (INFLATER_FORMAT_GZIP == inf->format)
+    {
+        expected = (uint32_t)inf->trailer[0] | ((uint32_t)inf->trailer[1] << 8) |
+                   ((uint32_t)inf->trailer[2] << 16) | ((uint32_t)inf->trailer[3] << 24);
+        match = (expected == inf->check);
+        expected = (uint32_t)inf->trailer[4] | ((uint32_t)inf->trailer[5] << 8) |
+                   ((uint32_t)inf->trailer[6] << 16) | ((uint32_t)inf->trailer[7] << 24);
+        match = match && (expected == inf->total_out);
+    }
+    else
+    {
+        expected = ((uint32_t)inf->trailer[0] << 24) | ((uint32_t)inf->trailer[1] << 16) |
+                   ((uint32_t)inf->trailer[2] << 8) | (uint32_t)inf->trailer[3];
+        match = (expected == inf->check);
+    }
+
+    if (!match)
+    {
+        fail(inf, INFLATER_ERR_CHECK);
+        return false;
+    }
+
+    inf->state = S_DONE;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: end_block
+ *******************************************************************************
+ * Summary:
+ *  Moves to the next block, or to the trailer after the final block.
+ *
+ *******************************************************************************/
+static void end_block(inflater_t *inf)
+{
+    if (!inf->last_block)
+    {
+        inf->state = S_BLOCK_HEADER;
+        return;
+    }
+
+    /* The trailer starts at a byte boundary. */
+    (void)get_bits(inf, inf->bit_count & 7u);
+    inf->header_pos = 0;
+    inf->state = (INFLATER_FORMAT_RAW == inf->format) ? S_DONE : S_TRAILER;
+}
+
+/*******************************************************************************
+ * Function Name: fill_bits
+ *******************************************************************************
+ * Summary:
+ *  Moves input bytes into the bit buffer while there is room.
+ *
+ *******************************************************************************/
+static void fill_bits(inflater_t *inf)
+{
+    while ((inf->bit_count <= 24u) && (inf->in_left > 0))
+    {
+        inf->bit_buf |= (uint32_t)(*inf->in++) << inf->bit_count;
+        inf->bit_count += 8u;
+        inf->in_left--;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: need_bits
+ *******************************************************************************
+ * Summary:
+ *  Returns true if the bit buffer holds at least count bits, at most 24.
+ *
+ *******************************************************************************/
+static bool need_bits(inflater_t *inf, uint32_t count)
+{
+    if (inf->bit_count < count)
+    {
+        fill_bits(inf);
+    }
+
+    return (inf->bit_count >= count);
+}
+
+/*******************************************************************************
+ * Function Name: get_bits
+ *******************************************************************************
+ * Summary:
+ *  Removes count bits from the bit buffer, least significant bit first.
+ *
+ *******************************************************************************/
+static uint32_t get_bits(inflater_t *inf, uint32_t count)
+{
+    uint32_t value = inf->bit_buf & ((1UL << count) - 1u);
+
+    inf->bit_buf = (count < 32u) ? (inf->bit_buf >> count) : 0u;
+    inf->bit_count -= count;
+
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: decode_symbol
+ *******************************************************************************
+ * Summary:
+ *  Decodes one symbol of a canonical Huffman code, one bit at a time. No bit
+ *  is consumed unless a complete code is in the bit buffer.
+ *
+ * Return:
+ *  int: 1 if a symbol was decoded, 0 if more input is needed, -1 if the bits
+ *  are not a code.
+ *
+ *******************************************************************************/
+static int decode_symbol(inflater_t *inf, const inflater_huffman_t *huffman, int *symbol)
+{
+    uint32_t bits;
+    uint32_t length;
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    int count;
+
+    fill_bits(inf);
+    bits = inf->bit_buf;
+
+    for (length = 1; length <= INFLATER_MAX_BITS; length++)
+    {
+        if (length > inf->bit_count)
+        {
+            return 0;
+        }
+
+        code |= (int)(bits & 1u);
+        bits >>= 1;
+        count = huffman->count[length];
+
+        if ((code - count) < first)
+        {
+            *symbol = huffman->symbol[index + (code - first)];
+            (void)get_bits(inf, length);
+            return 1;
+        }
+
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: build_huffman
+ *******************************************************************************
+ * Summary:
+ *  Builds a canonical Huffman code from the code length of every symbol.
+ *
+ * Return:
+ *  int: 0 for a complete code, a positive value for an incomplete code, or
+ *  a negative value for an over-subscribed code.
+ *
+ *******************************************************************************/
+static int build_huffman(inflater_huffman_t *huffman, const uint8_t *lengths, uint32_t num_symbols)
+{
+    uint16_t offsets[INFLATER_MAX_BITS + 1];
+    uint32_t symbol;
+    uint32_t length;
+    int left = 1;
+
+    memset(huffman->count, 0, sizeof(huffman->count));
+    for (symbol = 0; symbol < num_symbols; symbol++)
+    {
+        huffman->count[lengths[symbol]]++;
+    }
+
+    if (huffman->count[0] == num_symbols)
+    {
+        return 0;
+    }
+
+    for (length = 1; length <= INFLATER_MAX_BITS; length++)
+    {
+        left = (left << 1) - huffman->count[length];
+        if (left < 0)
+        {
+            return left;
+        }
+    }
+
+    offsets[1] = 0;
+    for (length = 1; length < INFLATER_MAX_BITS; length++)
+    {
+        offsets[length + 1] = offsets[length] + huffman->count[length];
+    }
+
+    for (symbol = 0; symbol < num_symbols; symbol++)
+    {
+        if (0u != lengths[symbol])
+        {
+            huffman->symbol[offsets[lengths[symbol]]++] = (uint16_t)symbol;
+        }
+    }
+
+    return left;
+}
+
+/*******************************************************************************
+ * Function Name: build_fixed_tables
+ *******************************************************************************
+ * Summary:
+ *  Builds the fixed literal/length and distance codes of block type 1.
+ *
+ *******************************************************************************/
+static void build_fixed_tables(inflater_t *inf)
+{
+    uint32_t symbol;
+
+    for (symbol = 0; symbol < INFLATER_MAX_LITLEN_CODES; symbol++)
+    {
+        inf->lengths[symbol] = (symbol < 144u) ? 8u : ((symbol < 256u) ? 9u : ((symbol < 280u) ? 7u : 8u));
+    }
+    (void)build_huffman(&inf->litlen, inf->lengths, INFLATER_MAX_LITLEN_CODES);
+
+    for (symbol = 0; symbol < INFLATER_MAX_DIST_CODES; symbol++)
+    {
+        inf->lengths[symbol] = 5u;
+    }
+    (void)build_huffman(&inf->dist, inf->lengths, INFLATER_MAX_DIST_CODES);
+}
+
+/*******************************************************************************
+ * Function Name: put_byte
+ *******************************************************************************
+ * Summary:
+ *  Appends a decoded byte to the window and passes the window on when it
+ *  wraps.
+ *
+ *******************************************************************************/
+static void put_byte(inflater_t *inf, uint8_t value)
+{
+    inf->window[inf->window_pos++] = value;
+    inf->total_out++;
+
+    if (inf->window_pos > inf->window_mask)
+    {
+        flush_window(inf);
+        inf->window_pos = 0;
+        inf->flushed_pos = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush_window
+ *******************************************************************************
+ * Summary:
+ *  Updates the check value with the bytes decoded since the last flush and
+ *  passes them to the output callback.
+ *
+ *******************************************************************************/
+static void flush_window(inflater_t *inf)
+{
+    const uint8_t *data = &inf->window[inf->flushed_pos];
+    size_t length = inf->window_pos - inf->flushed_pos;
+
+    if (0 == length)
+    {
+        return;
+    }
+
+    if (INFLATER_FORMAT_GZIP == inf->format)
+    {
+        inf->check = inflater_crc32(inf->check, data, length);
+    }
+    else if (INFLATER_FORMAT_RAW != inf->format)
+    {
+        inf->check = adler32(inf->check, data, length);
+    }
+
+    inf->flushed_pos = inf->window_pos;
+
+    if ((NULL != inf->output) && !inf->output(data, length, inf->output_arg))
+    {
+        fail(inf, INFLATER_STOPPED);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: adler32
+ *******************************************************************************
+ * Summary:
+ *  Updates an Adler-32 as used by zlib. Start with 1.
+ *
+ *******************************************************************************/
+static uint32_t adler32(uint32_t adler, const uint8_t *data, size_t length)
+{
+    uint32_t a = adler & 0xFFFFu;
+    uint32_t b = adler >> 16;
+    size_t block;
+
+    while (length > 0)
+    {
+        block = (length < ADLER_BLOCK) ? length : ADLER_BLOCK;
+        length -= block;
+
+        while (block-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+
+    return (b << 16) | a;
+}
+
+/*******************************************************************************
+ * Function Name: fail
+ *******************************************************************************
+ * Summary:
+ *  Stops the decoder. The first reason is kept.
+ *
+ *******************************************************************************/
+static void fail(inflater_t *inf, inflater_status_t status)
+{
+    if (INFLATER_OK == inf->status)
+    {
+        inf->status = status;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,155 @@
+/******************************************************************************
+* File Name: inflater.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the streaming deflate decoder for gzip and deflate encoded
+* response bodies.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef INFLATER_H_
+#define INFLATER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Limits of the deflate format (RFC 1951). */
+#define INFLATER_MAX_BITS                        (15)
+#define INFLATER_MAX_LITLEN_CODES                (288)
+#define INFLATER_MAX_DIST_CODES                  (30)
+#define INFLATER_MAX_WINDOW_SIZE                 (32 * 1024)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    INFLATER_FORMAT_RAW,             /* Raw deflate data. */
+    INFLATER_FORMAT_ZLIB,            /* zlib wrapper (RFC 1950). */
+    INFLATER_FORMAT_GZIP,            /* gzip wrapper (RFC 1952). */
+    INFLATER_FORMAT_DEFLATE,         /* HTTP "deflate": zlib, or raw deflate from servers that omit the wrapper. */
+} inflater_format_t;
+
+typedef enum
+{
+    INFLATER_OK,                     /* More input is needed. */
+    INFLATER_DONE,                   /* The stream ended and its check value matched. */
+    INFLATER_STOPPED,                /* The output callback stopped the decoder. */
+    INFLATER_ERR_DATA,               /* The input is not valid compressed data. */
+    INFLATER_ERR_WINDOW,             /* A match reaches further back than the window. */
+    INFLATER_ERR_CHECK,              /* The CRC-32, Adler-32, or length does not match. */
+    INFLATER_ERR_TRUNCATED,          /* The input ended inside the stream. */
+    INFLATER_ERR_PARAM,              /* The window size is not a power of two. */
+} inflater_status_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Called with decoded data, in order. Returning false stops the decoder. */
+typedef bool (*inflater_output_t)(const uint8_t *data, size_t length, void *arg);
+
+/* Canonical Huffman code: number of codes of each length and the symbols
+ * ordered by code.
+ */
+typedef struct
+{
+    uint16_t count[INFLATER_MAX_BITS + 1];
+    uint16_t symbol[INFLATER_MAX_LITLEN_CODES];
+} inflater_huffman_t;
+
+/* Decoder state. Allocated by the caller together with the window. */
+typedef struct
+{
+    inflater_format_t format;
+    inflater_status_t status;
+    uint8_t state;
+    bool last_block;
+
+    /* Input of the current inflater_feed() call and the bit buffer. */
+    const uint8_t *in;
+    size_t in_left;
+    uint32_t bit_buf;
+    uint32_t bit_count;
+
+    /* Output window. Decoded data is passed to the callback whenever the
+     * window wraps and at the end of every inflater_feed() call.
+     */
+    uint8_t *window;
+    uint32_t window_mask;
+    uint32_t window_pos;
+    uint32_t flushed_pos;
+    uint32_t total_out;
+    inflater_output_t output;
+    void *output_arg;
+
+    /* Block decoding. */
+    inflater_huffman_t litlen;
+    inflater_huffman_t dist;
+    uint8_t lengths[INFLATER_MAX_LITLEN_CODES + INFLATER_MAX_DIST_CODES];
+    uint16_t num_litlen;
+    uint16_t num_dist;
+    uint16_t num_codelen;
+    uint16_t index;
+    int16_t symbol;
+    uint32_t copy_length;
+
+    /* Wrapper. */
+    uint8_t header_flags;
+    uint32_t header_pos;
+    uint32_t check;
+    uint8_t trailer[8];
+} inflater_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+inflater_status_t inflater_init(inflater_t *inf, inflater_format_t format, uint8_t *window,
+                                size_t window_size, inflater_output_t output, void *arg);
+inflater_status_t inflater_feed(inflater_t *inf, const uint8_t *data, size_t length);
+inflater_status_t inflater_finish(inflater_t *inf);
+uint32_t inflater_crc32(uint32_t crc, const uint8_t *data, size_t length);
+
+#endif /* INFLATER_H_ */
+
+
+/* [] END OF FILE */
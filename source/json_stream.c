@@ -0,0 +1,1065 @@
+/******************************************************************************
+* File Name: json_stream.c
+*
+* Description: This file contains the streaming JSON parser. It is a push
+* parser: body chunks are fed as they arrive, and every value is reported to a
+* callback together with its path, so fields can be extracted without holding
+* the document in RAM.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <string.h>
+
+#include "json_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Parser states. */
+#define PS_VALUE                         (0u)    /* A value. */
+#define PS_VALUE_OR_END                  (1u)    /* A value or ']' after '['. */
+#define PS_KEY_OR_END                    (2u)    /* A key or '}' after '{'. */
+#define PS_KEY                           (3u)    /* A key after ','. */
+#define PS_COLON                         (4u)
+#define PS_COMMA_OR_END                  (5u)
+#define PS_DONE                          (6u)    /* Only white space may follow. */
+#define PS_STRING                        (7u)
+#define PS_ESCAPE                        (8u)
+#define PS_UNICODE                       (9u)
+#define PS_NUMBER                        (10u)
+#define PS_LITERAL                       (11u)
+
+#define IS_OBJECT(parser)                (0u != ((parser)->objects & (1u << (parser)->depth)))
+
+#define UNICODE_REPLACEMENT              (0xFFFDu)
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool process_char(json_stream_t *parser, uint8_t c);
+static void structural_char(json_stream_t *parser, uint8_t c);
+static void begin_value(json_stream_t *parser, uint8_t c);
+static void end_value(json_stream_t *parser);
+static void push_container(json_stream_t *parser, bool object);
+static void end_container(json_stream_t *parser, bool object);
+static void string_char(json_stream_t *parser, uint8_t c);
+static void escape_char(json_stream_t *parser, uint8_t c);
+static void unicode_char(json_stream_t *parser, uint8_t c);
+static void end_string(json_stream_t *parser);
+static void end_number(json_stream_t *parser);
+static void start_token(json_stream_t *parser, bool is_key);
+static void token_add(json_stream_t *parser, uint8_t c);
+static void token_add_code_point(json_stream_t *parser, uint32_t code_point);
+static void flush_surrogate(json_stream_t *parser);
+static void path_append(json_stream_t *parser, const char *text, size_t length);
+static void path_truncate(json_stream_t *parser, uint16_t length);
+static void emit(json_stream_t *parser, json_event_t event, const char *value, size_t length);
+static void fail(json_stream_t *parser, json_stream_status_t status);
+static bool number_is_valid(const char *text, size_t length);
+static bool parse_int32(const char *text, size_t length, int32_t *value);
+
+/*******************************************************************************
+ * Function Name: json_stream_init
+ *******************************************************************************
+ * Summary:
+ *  Sets up a parser for one document.
+ *
+ * Parameters:
+ *  parser - Parser to set up.
+ *  callback - Called for every value.
+ *  arg - Argument passed to the callback.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void json_stream_init(json_stream_t *parser, json_stream_cb_t callback, void *arg)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->callback = callback;
+    parser->callback_arg = arg;
+    parser->status = JSON_STREAM_OK;
+    parser->state = PS_VALUE;
+}
+
+/*******************************************************************************
+ * Function Name: json_stream_feed
+ *******************************************************************************
+ * Summary:
+ *  Parses the next chunk of the document. A chunk can end anywhere, also
+ *  inside a string, number, or escape sequence.
+ *
+ * Parameters:
+ *  parser - Parser.
+ *  data - Next bytes of the document.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  json_stream_status_t: JSON_STREAM_OK to continue feeding, otherwise the
+ *  reason the parser stopped. The status is kept for the later calls.
+ *
+ *******************************************************************************/
+json_stream_status_t json_stream_feed(json_stream_t *parser, const uint8_t *data, size_t length)
+{
+    size_t index = 0;
+
+    while ((JSON_STREAM_OK == parser->status) && (index < length))
+    {
+        /* A number only ends at the next character, which is then processed
+         * again in the state that follows the number.
+         */
+        if (process_char(parser, data[index]))
+        {
+            index++;
+            parser->offset++;
+        }
+    }
+
+    return parser->status;
+}
+
+/*******************************************************************************
+ * Function Name: json_stream_finish
+ *******************************************************************************
+ * Summary:
+ *  Ends the document. A number at the top level is only complete here.
+ *
+ * Parameters:
+ *  parser - Parser.
+ *
+ * Return:
+ *  json_stream_status_t: JSON_STREAM_OK if a complete document was parsed,
+ *  JSON_STREAM_ERR_INCOMPLETE if it was cut short, or the earlier status.
+ *
+ *******************************************************************************/
+json_stream_status_t json_stream_finish(json_stream_t *parser)
+{
+    if ((JSON_STREAM_OK == parser->status) && (PS_NUMBER == parser->state))
+    {
+        end_number(parser);
+    }
+
+    if ((JSON_STREAM_OK == parser->status) && (PS_DONE != parser->state))
+    {
+        parser->status = JSON_STREAM_ERR_INCOMPLETE;
+    }
+
+    return parser->status;
+}
+
+/*******************************************************************************
+ * Function Name: json_path_matches
+ *******************************************************************************
+ * Summary:
+ *  Compares a path with a pattern in which "[*]" matches any array index.
+ *
+ * Parameters:
+ *  pattern - Pattern, for example "servers[*].host".
+ *  path - Path reported by the parser.
+ *
+ * Return:
+ *  bool: true if the path matches the pattern.
+ *
+ *******************************************************************************/
+bool json_path_matches(const char *pattern, const char *path)
+{
+    while (('\0' != *pattern) && ('\0' != *path))
+    {
+        if ((0 == strncmp(pattern, "[*]", 3)) && ('[' == *path))
+        {
+            pattern += 3;
+            while (('\0' != *path) && (']' != *path))
+            {
+                path++;
+            }
+            if ('\0' == *path)
+            {
+                return false;
+            }
+            path++;
+            continue;
+        }
+
+        if (*pattern != *path)
+        {
+            return false;
+        }
+        pattern++;
+        path++;
+    }
+
+    return (*pattern == *path);
+}
+
+/*******************************************************************************
+ * Function Name: json_extract_cb
+ *******************************************************************************
+ * Summary:
+ *  Parser callback that stores the values of a list of fields. Values whose
+ *  type does not match the field are ignored.
+ *
+ * Parameters:
+ *  event - Parser event.
+ *  path - Path of the value.
+ *  value - Value text.
+ *  length - Length of the value text.
+ *  arg - json_extract_t with the fields.
+ *
+ * Return:
+ *  bool: false to stop the parser once every field is found, if the
+ *  extraction asks for it.
+ *
+ *******************************************************************************/
+bool json_extract_cb(json_event_t event, const char *path, const char *value, size_t length, void *arg)
+{
+    json_extract_t *extract = (json_extract_t *)arg;
+    json_field_t *field;
+    bool all_found = true;
+    uint32_t index;
+
+    for (index = 0; index < extract->count; index++)
+    {
+        field = &extract->fields[index];
+
+        if (!field->found && json_path_matches(field->path, path))
+        {
+            switch (field->type)
+            {
+                case JSON_FIELD_STRING:
+                    if ((JSON_EVENT_STRING == event) && (field->size > 0))
+                    {
+                        if (length >= field->size)
+                        {
+                            length = field->size - 1u;
+                        }
+                        memcpy(field->value, value, length);
+                        ((char *)field->value)[length] = '\0';
+                        field->found = true;
+                    }
+                    break;
+
+                case JSON_FIELD_INT:
+                    field->found = (JSON_EVENT_NUMBER == event) &&
+                                   parse_int32(value, length, (int32_t *)field->value);
+                    break;
+
+                case JSON_FIELD_BOOL:
+                    if ((JSON_EVENT_TRUE == event) || (JSON_EVENT_FALSE == event))
+                    {
+                        *(bool *)field->value = (JSON_EVENT_TRUE == event);
+                        field->found = true;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        all_found &= field->found;
+    }
+
+    return !(extract->stop_when_found && all_found);
+}
+
+/*******************************************************************************
+ * Function Name: process_char
+ *******************************************************************************
+ * Summary:
+ *  Advances the parser by one input character.
+ *
+ * Parameters:
+ *  parser - Parser.
+ *  c - Input character.
+ *
+ * Return:
+ *  bool: false if the character ended a number and must be processed again.
+ *
+ *******************************************************************************/
+static bool process_char(json_stream_t *parser, uint8_t c)
+{
+    switch (parser->state)
+    {
+        case PS_STRING:
+            string_char(parser, c);
+            break;
+
+        case PS_ESCAPE:
+            escape_char(parser, c);
+            break;
+
+        case PS_UNICODE:
+            unicode_char(parser, c);
+            break;
+
+        case PS_NUMBER:
+            if (((c >= '0') && (c <= '9')) || ('-' == c) || ('+' == c) ||
+                ('.' == c) || ('e' == c) || ('E' == c))
+            {
+                token_add(parser, c);
+                break;
+            }
+            end_number(parser);
+            return false;
+
+        case PS_LITERAL:
+            if (c != (uint8_t)parser->literal[parser->literal_pos])
+            {
+                fail(parser, JSON_STREAM_ERR_SYNTAX);
+                break;
+            }
+            if ('\0' == parser->literal[++parser->literal_pos])
+            {
+                emit(parser, ('t' == parser->literal[0]) ? JSON_EVENT_TRUE :
+                             (('f' == parser->literal[0]) ? JSON_EVENT_FALSE : JSON_EVENT_NULL),
+                     parser->literal, parser->literal_pos);
+                end_value(parser);
+            }
+            break;
+
+        default:
+            structural_char(parser, c);
+            break;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: structural_char
+ *******************************************************************************
+ * Summary:
+ *  Handles a character between values: white space, punctuation, and the
+ *  first character of a value.
+ *
+ *******************************************************************************/
+static void structural_char(json_stream_t *parser, uint8_t c)
+{
+    bool object;
+
+    if ((' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c))
+    {
+        return;
+    }
+
+    switch (parser->state)
+    {
+        case PS_VALUE_OR_END:
+            if (']' == c)
+            {
+                end_container(parser, false);
+                return;
+            }
+            /* Fall through */
+
+        case PS_VALUE:
+            begin_value(parser, c);
+            return;
+
+        case PS_KEY_OR_END:
+            if ('}' == c)
+            {
+                end_container(parser, true);
+                return;
+            }
+            /* Fall through */
+
+        case PS_KEY:
+            if ('"' == c)
+            {
+                start_token(parser, true);
+                parser->state = PS_STRING;
+                return;
+            }
+            break;
+
+        case PS_COLON:
+            if (':' == c)
+            {
+                parser->state = PS_VALUE;
+                return;
+            }
+            break;
+
+        case PS_COMMA_OR_END:
+            object = IS_OBJECT(parser);
+            if (',' == c)
+            {
+                parser->state = object ? PS_KEY : PS_VALUE;
+                return;
+            }
+            if (c == (object ? '}' : ']'))
+            {
+                end_container(parser, object);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    fail(parser, JSON_STREAM_ERR_SYNTAX);
+}
+
+/*******************************************************************************
+ * Function Name: begin_value
+ *******************************************************************************
+ * Summary:
+ *  Starts the value that begins with the given character. Array elements
+ *  get their index appended to the path first.
+ *
+ *******************************************************************************/
+static void begin_value(json_stream_t *parser, uint8_t c)
+{
+    char segment[12];
+    uint32_t index;
+    size_t length;
+
+    if ((parser->depth > 0) && !IS_OBJECT(parser))
+    {
+        /* "[index]" without snprintf, which is costly per element. */
+        index = parser->index[parser->depth];
+        length = sizeof(segment) - 1u;
+        segment[length] = ']';
+        do
+        {
+            segment[--length] = (char)('0' + (index % 10u));
+            index /= 10u;
+        } while (0u != index);
+        segment[--length] = '[';
+        path_append(parser, &segment[length], sizeof(segment) - length);
+    }
+
+    switch (c)
+    {
+        case '{':
+            emit(parser, JSON_EVENT_OBJECT_START, NULL, 0);
+            push_container(parser, true);
+            break;
+
+        case '[':
+            emit(parser, JSON_EVENT_ARRAY_START, NULL, 0);
+            push_container(parser, false);
+            break;
+
+        case '"':
+            start_token(parser, false);
+            parser->state = PS_STRING;
+            break;
+
+        case 't':
+            parser->literal = "true";
+            parser->literal_pos = 1;
+            parser->state = PS_LITERAL;
+            break;
+
+        case 'f':
+            parser->literal = "false";
+            parser->literal_pos = 1;
+            parser->state = PS_LITERAL;
+            break;
+
+        case 'n':
+            parser->literal = "null";
+            parser->literal_pos = 1;
+            parser->state = PS_LITERAL;
+            break;
+
+        default:
+            if (('-' == c) || ((c >= '0') && (c <= '9')))
+            {
+                start_token(parser, false);
+                token_add(parser, c);
+                parser->state = PS_NUMBER;
+            }
+            else
+            {
+                fail(parser, JSON_STREAM_ERR_SYNTAX);
+            }
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: end_value
+ *******************************************************************************
+ * Summary:
+ *  Returns to the enclosing container after a complete value and removes the
+ *  key or index of the value from the path.
+ *
+ *******************************************************************************/
+static void end_value(json_stream_t *parser)
+{
+    if (0 == parser->depth)
+    {
+        parser->state = PS_DONE;
+        return;
+    }
+
+    if (!IS_OBJECT(parser))
+    {
+        parser->index[parser->depth]++;
+    }
+
+    path_truncate(parser, parser->path_len[parser->depth]);
+    parser->state = PS_COMMA_OR_END;
+}
+
+/*******************************************************************************
+ * Function Name: push_container
+ *******************************************************************************
+ * Summary:
+ *  Enters an object or array whose path is the current path.
+ *
+ *******************************************************************************/
+static void push_container(json_stream_t *parser, bool object)
+{
+    if (parser->depth >= JSON_STREAM_MAX_DEPTH)
+    {
+        fail(parser, JSON_STREAM_ERR_DEPTH);
+        return;
+    }
+
+    parser->depth++;
+    if (object)
+    {
+        parser->objects |= (1u << parser->depth);
+    }
+    else
+    {
+        parser->objects &= ~(1u << parser->depth);
+    }
+    parser->index[parser->depth] = 0;
+    parser->path_len[parser->depth] = parser->path_used;
+    parser->state = object ? PS_KEY_OR_END : PS_VALUE_OR_END;
+}
+
+/*******************************************************************************
+ * Function Name: end_container
+ *******************************************************************************
+ * Summary:
+ *  Leaves the current object or array.
+ *
+ *******************************************************************************/
+static void end_container(json_stream_t *parser, bool object)
+{
+    parser->depth--;
+    emit(parser, object ? JSON_EVENT_OBJECT_END : JSON_EVENT_ARRAY_END, NULL, 0);
+    end_value(parser);
+}
+
+/*******************************************************************************
+ * Function Name: string_char
+ *******************************************************************************
+ * Summary:
+ *  Handles a character inside a string.
+ *
+ *******************************************************************************/
+static void string_char(json_stream_t *parser, uint8_t c)
+{
+    if ('"' == c)
+    {
+        flush_surrogate(parser);
+        end_string(parser);
+    }
+    else if ('\\' == c)
+    {
+        parser->state = PS_ESCAPE;
+    }
+    else if (c < 0x20u)
+    {
+        fail(parser, JSON_STREAM_ERR_SYNTAX);
+    }
+    else
+    {
+        flush_surrogate(parser);
+        token_add(parser, c);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: escape_char
+ *******************************************************************************
+ * Summary:
+ *  Handles the character after a backslash in a string.
+ *
+ *******************************************************************************/
+static void escape_char(json_stream_t *parser, uint8_t c)
+{
+    switch (c)
+    {
+        case '"':
+        case '\\':
+        case '/':
+            break;
+
+        case 'b':
+            c = '\b';
+            break;
+
+        case 'f':
+            c = '\f';
+            break;
+
+        case 'n':
+            c = '\n';
+            break;
+
+        case 'r':
+            c = '\r';
+            break;
+
+        case 't':
+            c = '\t';
+            break;
+
+        case 'u':
+            parser->code_point = 0;
+            parser->hex_digits = 0;
+            parser->state = PS_UNICODE;
+            return;
+
+        default:
+            fail(parser, JSON_STREAM_ERR_SYNTAX);
+            return;
+    }
+
+    flush_surrogate(parser);
+    token_add(parser, c);
+    parser->state = PS_STRING;
+}
+
+/*******************************************************************************
+ * Function Name: unicode_char
+ *******************************************************************************
+ * Summary:
+ *  Handles a hex digit of a \uXXXX escape. Surrogate pairs are combined, and
+ *  unpaired surrogates are replaced with U+FFFD.
+ *
+ *******************************************************************************/
+static void unicode_char(json_stream_t *parser, uint8_t c)
+{
+    uint32_t digit;
+    uint32_t code_point;
+
+    if ((c >= '0') && (c <= '9'))
+    {
+        digit = c - '0';
+    }
+    else if ((c >= 'a') && (c <= 'f'))
+    {
+        digit = (c - 'a') + 10u;
+    }
+    else if ((c >= 'A') && (c <= 'F'))
+    {
+        digit = (c - 'A') + 10u;
+    }
+    else
+    {
+        fail(parser, JSON_STREAM_ERR_SYNTAX);
+        return;
+    }
+
+    parser->code_point = (parser->code_point << 4) | digit;
+    if (++parser->hex_digits < 4u)
+    {
+        return;
+    }
+
+    parser->state = PS_STRING;
+    code_point = parser->code_point;
+
+    if ((code_point >= 0xD800u) && (code_point <= 0xDBFFu))
+    {
+        flush_surrogate(parser);
+        parser->high_surrogate = (uint16_t)code_point;
+        return;
+    }
+
+    if ((code_point >= 0xDC00u) && (code_point <= 0xDFFFu))
+    {
+        if (0u != parser->high_surrogate)
+        {
+            code_point = 0x10000u + (((uint32_t)parser->high_surrogate - 0xD800u) << 10) +
+                         (code_point - 0xDC00u);
+            parser->high_surrogate = 0;
+        }
+        else
+        {
+            code_point = UNICODE_REPLACEMENT;
+        }
+    }
+    else
+    {
+        flush_surrogate(parser);
+    }
+
+    token_add_code_point(parser, code_point);
+}
+
+/*******************************************************************************
+ * Function Name: end_string
+ *******************************************************************************
+ * Summary:
+ *  Completes a key, which is appended to the path, or a string value, which
+ *  is reported.
+ *
+ *******************************************************************************/
+static void end_string(json_stream_t *parser)
+{
+    uint16_t container_len;
+
+    parser->token[parser->token_len] = '\0';
+
+    if (!parser->token_is_key)
+    {
+        emit(parser, JSON_EVENT_STRING, parser->token, parser->token_len);
+        end_value(parser);
+        return;
+    }
+
+    container_len = parser->path_len[parser->depth];
+    path_truncate(parser, container_len);
+    if (container_len > 0)
+    {
+        path_append(parser, ".", 1);
+    }
+    path_append(parser, parser->token,
+                (parser->token_len < JSON_STREAM_MAX_KEY) ? parser->token_len : JSON_STREAM_MAX_KEY);
+    parser->state = PS_COLON;
+}
+
+/*******************************************************************************
+ * Function Name: end_number
+ *******************************************************************************
+ * Summary:
+ *  Validates and reports a number.
+ *
+ *******************************************************************************/
+static void end_number(json_stream_t *parser)
+{
+    parser->token[parser->token_len] = '\0';
+
+    if (parser->token_truncated || !number_is_valid(parser->token, parser->token_len))
+    {
+        fail(parser, JSON_STREAM_ERR_SYNTAX);
+        return;
+    }
+
+    emit(parser, JSON_EVENT_NUMBER, parser->token, parser->token_len);
+    end_value(parser);
+}
+
+/*******************************************************************************
+ * Function Name: start_token
+ *******************************************************************************
+ * Summary:
+ *  Empties the token buffer for a new key, string, or number.
+ *
+ *******************************************************************************/
+static void start_token(json_stream_t *parser, bool is_key)
+{
+    parser->token_len = 0;
+    parser->token_truncated = false;
+    parser->token_is_key = is_key;
+    parser->high_surrogate = 0;
+}
+
+/*******************************************************************************
+ * Function Name: token_add
+ *******************************************************************************
+ * Summary:
+ *  Appends a byte to the token, or marks the token truncated when it is full.
+ *
+ *******************************************************************************/
+static void token_add(json_stream_t *parser, uint8_t c)
+{
+    if (parser->token_len < JSON_STREAM_MAX_TOKEN)
+    {
+        parser->token[parser->token_len++] = (char)c;
+    }
+    else
+    {
+        parser->token_truncated = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: token_add_code_point
+ *******************************************************************************
+ * Summary:
+ *  Appends a code point in UTF-8. A sequence that does not fit is dropped as
+ *  a whole, so a truncated string stays valid UTF-8.
+ *
+ *******************************************************************************/
+static void token_add_code_point(json_stream_t *parser, uint32_t code_point)
+{
+    uint8_t bytes[4];
+    size_t length;
+    size_t index;
+
+    if (code_point < 0x80u)
+    {
+        bytes[0] = (uint8_t)code_point;
+        length = 1;
+    }
+    else if (code_point < 0x800u)
+    {
+        bytes[0] = (uint8_t)(0xC0u | (code_point >> 6));
+        bytes[1] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+        length = 2;
+    }
+    else if (code_point < 0x10000u)
+    {
+        bytes[0] = (uint8_t)(0xE0u | (code_point >> 12));
+        bytes[1] = (uint8_t)(0x80u | ((code_point >> 6) & 0x3Fu));
+        bytes[2] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+        length = 3;
+    }
+    else
+    {
+        bytes[0] = (uint8_t)(0xF0u | (code_point >> 18));
+        bytes[1] = (uint8_t)(0x80u | ((code_point >> 12) & 0x3Fu));
+        bytes[2] = (uint8_t)(0x80u | ((code_point >> 6) & 0x3Fu));
+        bytes[3] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+        length = 4;
+    }
+
+    if ((parser->token_len + length) > JSON_STREAM_MAX_TOKEN)
+    {
+        parser->token_truncated = true;
+        return;
+    }
+
+    for (index = 0; index < length; index++)
+    {
+        parser->token[parser->token_len++] = (char)bytes[index];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush_surrogate
+ *******************************************************************************
+ * Summary:
+ *  Replaces a high surrogate that was not followed by a low one.
+ *
+ *******************************************************************************/
+static void flush_surrogate(json_stream_t *parser)
+{
+    if (0u != parser->high_surrogate)
+    {
+        parser->high_surrogate = 0;
+        token_add_code_point(parser, UNICODE_REPLACEMENT);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: path_append
+ *******************************************************************************
+ * Summary:
+ *  Appends text to the path. JSON_STREAM_MAX_PATH has room for a full-length
+ *  segment at every level, so the path cannot overflow.
+ *
+ *******************************************************************************/
+static void path_append(json_stream_t *parser, const char *text, size_t length)
+{
+    if ((parser->path_used + length) >= sizeof(parser->path))
+    {
+        length = sizeof(parser->path) - 1u - parser->path_used;
+    }
+
+    memcpy(&parser->path[parser->path_used], text, length);
+    parser->path_used += (uint16_t)length;
+    parser->path[parser->path_used] = '\0';
+}
+
+/*******************************************************************************
+ * Function Name: path_truncate
+ *******************************************************************************
+ * Summary:
+ *  Cuts the path back to the given length.
+ *
+ *******************************************************************************/
+static void path_truncate(json_stream_t *parser, uint16_t length)
+{
+    parser->path_used = length;
+    parser->path[length] = '\0';
+}
+
+/*******************************************************************************
+ * Function Name: emit
+ *******************************************************************************
+ * Summary:
+ *  Reports an event to the callback and stops the parser if it asks to.
+ *
+ *******************************************************************************/
+static void emit(json_stream_t *parser, json_event_t event, const char *value, size_t length)
+{
+    if ((NULL != parser->callback) &&
+        !parser->callback(event, parser->path, value, length, parser->callback_arg))
+    {
+        fail(parser, JSON_STREAM_STOPPED);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fail
+ *******************************************************************************
+ * Summary:
+ *  Stops the parser. The first reason is kept.
+ *
+ *******************************************************************************/
+static void fail(json_stream_t *parser, json_stream_status_t status)
+{
+    if (JSON_STREAM_OK == parser->status)
+    {
+        parser->status = status;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: number_is_valid
+ *******************************************************************************
+ * Summary:
+ *  Checks a number against the JSON grammar:
+ *  -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+ *
+ *******************************************************************************/
+static bool number_is_valid(const char *text, size_t length)
+{
+    const char *end = text + length;
+    const char *digits;
+
+    if ((text < end) && ('-' == *text))
+    {
+        text++;
+    }
+
+    if ((text < end) && ('0' == *text))
+    {
+        text++;
+    }
+    else
+    {
+        for (digits = text; (text < end) && (*text >= '0') && (*text <= '9'); text++)
+        {
+        }
+        if (text == digits)
+        {
+            return false;
+        }
+    }
+
+    if ((text < end) && ('.' == *text))
+    {
+        for (digits = ++text; (text < end) && (*text >= '0') && (*text <= '9'); text++)
+        {
+        }
+        if (text == digits)
+        {
+            return false;
+        }
+    }
+
+    if ((text < end) && (('e' == *text) || ('E' == *text)))
+    {
+        text++;
+        if ((text < end) && (('+' == *text) || ('-' == *text)))
+        {
+            text++;
+        }
+        for (digits = text; (text < end) && (*text >= '0') && (*text <= '9'); text++)
+        {
+        }
+        if (text == digits)
+        {
+            return false;
+        }
+    }
+
+    return (text == end);
+}
+
+/*******************************************************************************
+ * Function Name: parse_int32
+ *******************************************************************************
+ * Summary:
+ *  Converts a number without fraction or exponent to an int32_t.
+ *
+ *******************************************************************************/
+static bool parse_int32(const char *text, size_t length, int32_t *value)
+{
+    const char *end = text + length;
+    bool negative = false;
+    int64_t result = 0;
+
+    if ((text < end) && ('-' == *text))
+    {
+        negative = true;
+        text++;
+    }
+
+    if (text == end)
+    {
+        return false;
+    }
+
+    for (; text < end; text++)
+    {
+        if ((*text < '0') || (*text > '9'))
+        {
+            return false;
+        }
+        result = (result * 10) + (*text - '0');
+        if (result > ((int64_t)INT32_MAX + 1))
+        {
+            return false;
+        }
+    }
+
+    result = negative ? -result : result;
+    if (result > INT32_MAX)
+    {
+        return false;
+    }
+
+    *value = (int32_t)result;
+
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,171 @@
+/******************************************************************************
+* File Name: json_stream.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the streaming JSON parser. The parser is fed with body chunks
+* of any size, reports every value with its path, and uses no heap.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef JSON_STREAM_H_
+#define JSON_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Deepest nesting of objects and arrays. */
+#define JSON_STREAM_MAX_DEPTH                    (8)
+
+/* Longest object key kept in a path. Longer keys are truncated. Must be at
+ * least 11 so that any array index segment fits in the same space.
+ */
+#define JSON_STREAM_MAX_KEY                      (31)
+
+/* Longest string or number value. Longer strings are reported truncated. */
+#define JSON_STREAM_MAX_TOKEN                    (128)
+
+/* Space for the path: one segment per nesting level. */
+#define JSON_STREAM_MAX_PATH                     ((JSON_STREAM_MAX_DEPTH * (JSON_STREAM_MAX_KEY + 1)) + 1)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    JSON_STREAM_OK,
+    JSON_STREAM_STOPPED,             /* The callback stopped the parser. */
+    JSON_STREAM_ERR_SYNTAX,          /* The input is not valid JSON. */
+    JSON_STREAM_ERR_DEPTH,           /* Nesting deeper than JSON_STREAM_MAX_DEPTH. */
+    JSON_STREAM_ERR_INCOMPLETE,      /* The input ended inside the document. */
+} json_stream_status_t;
+
+typedef enum
+{
+    JSON_EVENT_OBJECT_START,
+    JSON_EVENT_OBJECT_END,
+    JSON_EVENT_ARRAY_START,
+    JSON_EVENT_ARRAY_END,
+    JSON_EVENT_STRING,
+    JSON_EVENT_NUMBER,
+    JSON_EVENT_TRUE,
+    JSON_EVENT_FALSE,
+    JSON_EVENT_NULL,
+} json_event_t;
+
+typedef enum
+{
+    JSON_FIELD_STRING,               /* value is a char array of size bytes. */
+    JSON_FIELD_INT,                  /* value is an int32_t. */
+    JSON_FIELD_BOOL,                 /* value is a bool. */
+} json_field_type_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Called for every value. path names the value, for example "wifi.ssid" or
+ * "servers[1].port", and is "" for the document itself. Strings are passed
+ * unescaped and NUL-terminated; numbers as their text. Containers are
+ * reported at their start and end with a NULL value. Returning false stops
+ * the parser.
+ */
+typedef bool (*json_stream_cb_t)(json_event_t event, const char *path, const char *value,
+                                 size_t length, void *arg);
+
+/* Parser state. Allocated by the caller, typically on the stack. */
+typedef struct
+{
+    json_stream_cb_t callback;
+    void *callback_arg;
+    json_stream_status_t status;
+    uint8_t state;
+    uint8_t depth;
+    uint32_t objects;                            /* Bit n is set if level n is an object. */
+    uint32_t index[JSON_STREAM_MAX_DEPTH + 1];   /* Next element index of each array. */
+    uint16_t path_len[JSON_STREAM_MAX_DEPTH + 1];/* Path length of each container. */
+    char path[JSON_STREAM_MAX_PATH];
+    uint16_t path_used;
+    char token[JSON_STREAM_MAX_TOKEN + 1];
+    uint16_t token_len;
+    bool token_truncated;
+    bool token_is_key;
+    const char *literal;
+    uint8_t literal_pos;
+    uint32_t code_point;
+    uint8_t hex_digits;
+    uint16_t high_surrogate;
+    uint32_t offset;                             /* Bytes consumed, for error reports. */
+} json_stream_t;
+
+/* Field extracted by json_extract_cb(). path may use "[*]" to match any
+ * array index. The first matching value is stored.
+ */
+typedef struct
+{
+    const char *path;
+    json_field_type_t type;
+    void *value;
+    size_t size;
+    bool found;
+} json_field_t;
+
+/* Argument of json_extract_cb(). */
+typedef struct
+{
+    json_field_t *fields;
+    uint32_t count;
+    bool stop_when_found;            /* Stop the parser once every field is found. */
+} json_extract_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void json_stream_init(json_stream_t *parser, json_stream_cb_t callback, void *arg);
+json_stream_status_t json_stream_feed(json_stream_t *parser, const uint8_t *data, size_t length);
+json_stream_status_t json_stream_finish(json_stream_t *parser);
+bool json_path_matches(const char *pattern, const char *path);
+bool json_extract_cb(json_event_t event, const char *path, const char *value, size_t length, void *arg);
+
+#endif /* JSON_STREAM_H_ */
+
+
+/* [] END OF FILE */
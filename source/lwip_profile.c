@@ -0,0 +1,283 @@
+/******************************************************************************
+* File Name: lwip_profile.c
+*
+* Description: This file contains the lwIP profile benchmark. It reports the
+* options of the profile in the build, the RAM of the pools they size, and
+* the download and upload throughput measured with them, as one row of the
+* matrix of profiles.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* lwIP header files */
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/priv/tcp_priv.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "tls_stream.h"
+#include "body_source.h"
+#include "lwip_profile.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/* Name of the profile when lwipopts.h of this application is not the one in
+ * the build.
+ */
+#ifndef LWIP_PROFILE_NAME
+#define LWIP_PROFILE_NAME                "library defaults"
+#endif
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static tls_stream_t download_stream;
+static uint8_t download_buffer[LWIP_PROFILE_BENCH_BUFFER_SIZE];
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static cy_rslt_t download(uint32_t *body_bytes, uint32_t *elapsed_ms);
+static uint32_t to_kbps(uint32_t bytes, uint32_t elapsed_ms);
+
+/*******************************************************************************
+ * Function Name: lwip_profile_get_ram
+ *******************************************************************************
+ * Summary:
+ *  Computes the RAM of the lwIP pools that the profile sizes. The pools are
+ *  static, except the send buffer, which is taken from the heap while data
+ *  is queued.
+ *
+ * Parameters:
+ *  ram - Filled with the sizes.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void lwip_profile_get_ram(lwip_profile_ram_t *ram)
+{
+    ram->pbuf_pool = PBUF_POOL_SIZE * (LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf)) +
+                                       LWIP_MEM_ALIGN_SIZE(PBUF_POOL_BUFSIZE));
+    ram->tcp_segments = MEMP_NUM_TCP_SEG * LWIP_MEM_ALIGN_SIZE(sizeof(struct tcp_seg));
+    ram->heap = MEM_LIBC_MALLOC ? 0u : MEM_SIZE;
+    ram->send_buffer = TCP_SND_BUF;
+}
+
+/*******************************************************************************
+ * Function Name: lwip_profile_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Prints the options of the profile and the RAM of its pools, then
+ *  downloads LWIP_PROFILE_BENCH_DOWNLOAD_PATH and uploads
+ *  LWIP_PROFILE_BENCH_UPLOAD_SIZE bytes LWIP_PROFILE_BENCH_RUNS times each,
+ *  and prints the mean throughput. The last line is the row of the profile
+ *  in the matrix of profiles.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void lwip_profile_benchmark(void)
+{
+    lwip_profile_ram_t ram;
+    body_source_t source;
+    body_source_stats_t upload_stats;
+    uint32_t ram_total;
+    uint32_t bytes;
+    uint32_t elapsed_ms;
+    uint32_t down_bytes = 0;
+    uint32_t down_ms = 0;
+    uint32_t up_bytes = 0;
+    uint32_t up_ms = 0;
+
+    lwip_profile_get_ram(&ram);
+    ram_total = ram.pbuf_pool + ram.tcp_segments + ram.heap + ram.send_buffer;
+
+    APP_INFO(("lwIP profile %s\n", LWIP_PROFILE_NAME));
+    printf("  TCP_MSS %u, TCP_WND %u, TCP_SND_BUF %u, TCP_SND_QUEUELEN %u\n",
+           (unsigned int)TCP_MSS, (unsigned int)TCP_WND, (unsigned int)TCP_SND_BUF, (unsigned int)TCP_SND_QUEUELEN);
+    printf("  PBUF_POOL_SIZE %u x %u B, MEMP_NUM_TCP_SEG %u, MEM_SIZE %u%s\n",
+           (unsigned int)PBUF_POOL_SIZE, (unsigned int)PBUF_POOL_BUFSIZE, (unsigned int)MEMP_NUM_TCP_SEG,
+           (unsigned int)MEM_SIZE, MEM_LIBC_MALLOC ? " (unused, MEM_LIBC_MALLOC)" : "");
+    printf("  RAM: pbuf pool %lu, segments %lu, heap %lu, send buffer %lu, total %lu bytes\n",
+           (unsigned long)ram.pbuf_pool, (unsigned long)ram.tcp_segments, (unsigned long)ram.heap,
+           (unsigned long)ram.send_buffer, (unsigned long)ram_total);
+
+    body_source_mapped(&source, (const void *)CY_FLASH_BASE, LWIP_PROFILE_BENCH_UPLOAD_SIZE);
+
+    for (uint32_t run = 0; run < LWIP_PROFILE_BENCH_RUNS; run++)
+    {
+        if (CY_RSLT_SUCCESS != download(&bytes, &elapsed_ms))
+        {
+            ERR_INFO(("Failed to download %s.\n", LWIP_PROFILE_BENCH_DOWNLOAD_PATH));
+            return;
+        }
+        down_bytes += bytes;
+        down_ms += elapsed_ms;
+
+        if (CY_RSLT_SUCCESS != body_source_upload(&source, LWIP_PROFILE_BENCH_UPLOAD_PATH,
+                                                  "application/octet-stream", &upload_stats))
+        {
+            return;
+        }
+        up_bytes += upload_stats.body_bytes;
+        up_ms += upload_stats.elapsed_ms;
+
+        printf("  run %lu: download %lu KB/s, upload %lu KB/s\n", (unsigned long)(run + 1u),
+               (unsigned long)to_kbps(bytes, elapsed_ms),
+               (unsigned long)to_kbps(upload_stats.body_bytes, upload_stats.elapsed_ms));
+    }
+
+    printf("\n  %-16s %10s %14s %12s\n", "profile", "RAM B", "download KB/s", "upload KB/s");
+    printf("  %-16s %10lu %14lu %12lu\n", LWIP_PROFILE_NAME, (unsigned long)ram_total,
+           (unsigned long)to_kbps(down_bytes, down_ms), (unsigned long)to_kbps(up_bytes, up_ms));
+}
+
+/*******************************************************************************
+ * Function Name: download
+ *******************************************************************************
+ * Summary:
+ *  Downloads LWIP_PROFILE_BENCH_DOWNLOAD_PATH on a new connection that the
+ *  server closes after the response, and counts the body bytes. The time
+ *  includes the connection, as it does for the upload.
+ *
+ *******************************************************************************/
+static cy_rslt_t download(uint32_t *body_bytes, uint32_t *elapsed_ms)
+{
+    static const char head_end[] = "\r\n\r\n";
+    static const char status_ok[] = "HTTP/1.1 200";
+    char status[sizeof(status_ok) - 1];
+    uint32_t status_len = 0;
+    TickType_t start_ticks = xTaskGetTickCount();
+    uint32_t matched = 0;
+    uint32_t received;
+    bool in_body = false;
+    cy_rslt_t result;
+    int length;
+
+    *body_bytes = 0;
+
+    length = snprintf((char *)download_buffer, sizeof(download_buffer),
+                      "GET %s HTTP/1.1\r\n"
+                      "Host: %s:%u\r\n"
+                      "Connection: close\r\n"
+                      "\r\n",
+                      LWIP_PROFILE_BENCH_DOWNLOAD_PATH, HTTPS_SERVER_HOST, HTTPS_PORT);
+
+    result = tls_stream_connect(&download_stream, HTTPS_SERVER_HOST, HTTPS_PORT, TRANSPORT_SEND_RECV_TIMEOUT_MS);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = tls_stream_send(&download_stream, download_buffer, (uint32_t)length);
+    }
+
+    while (CY_RSLT_SUCCESS == result)
+    {
+        result = tls_stream_recv(&download_stream, download_buffer, sizeof(download_buffer), &received);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            break;
+        }
+
+        if (in_body)
+        {
+            *body_bytes += received;
+            continue;
+        }
+
+        /* The status line is checked, and the body starts after the first
+         * empty line.
+         */
+        for (uint32_t i = 0; (i < received) && (CY_RSLT_SUCCESS == result); i++)
+        {
+            if (in_body)
+            {
+                *body_bytes += received - i;
+                break;
+            }
+
+            if (status_len < sizeof(status))
+            {
+                status[status_len++] = (char)download_buffer[i];
+                if ((sizeof(status) == status_len) && (0 != memcmp(status, status_ok, sizeof(status))))
+                {
+                    ERR_INFO(("Unexpected response to the GET of %s.\n", LWIP_PROFILE_BENCH_DOWNLOAD_PATH));
+                    result = CY_RSLT_TYPE_ERROR;
+                }
+            }
+
+            matched = (download_buffer[i] == (uint8_t)head_end[matched]) ? (matched + 1u) :
+                      (('\r' == download_buffer[i]) ? 1u : 0u);
+            in_body = (matched == (sizeof(head_end) - 1u));
+        }
+    }
+
+    tls_stream_close(&download_stream);
+
+    *elapsed_ms = TICKS_TO_MS(xTaskGetTickCount() - start_ticks);
+
+    return (in_body && (CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED == result)) ? CY_RSLT_SUCCESS : result;
+}
+
+/*******************************************************************************
+ * Function Name: to_kbps
+ *******************************************************************************
+ * Summary:
+ *  Returns a throughput in kilobytes per second.
+ *
+ *******************************************************************************/
+static uint32_t to_kbps(uint32_t bytes, uint32_t elapsed_ms)
+{
+    return (0u != elapsed_ms) ? (uint32_t)(((uint64_t)bytes * 1000u) / ((uint64_t)elapsed_ms * 1024u)) : 0u;
+}
+
+/* [] END OF FILE */
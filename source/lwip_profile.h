@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name: lwip_profile.h
+*
+* Description: This file contains the macros and function prototypes of the
+* lwIP profile benchmark, which measures the throughput and the RAM of the
+* lwIP option profile the application is built with.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef LWIP_PROFILE_H_
+#define LWIP_PROFILE_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* "lwIP profile" menu option: the resource downloaded, and the bytes of the
+ * internal flash uploaded, each LWIP_PROFILE_BENCH_RUNS times.
+ */
+#define LWIP_PROFILE_BENCH_DOWNLOAD_PATH         "/asset.bin"
+#define LWIP_PROFILE_BENCH_UPLOAD_PATH           "/upload"
+#define LWIP_PROFILE_BENCH_UPLOAD_SIZE           (256u * 1024u)
+#define LWIP_PROFILE_BENCH_RUNS                  (3u)
+
+/* Receive buffer of the download. */
+#define LWIP_PROFILE_BENCH_BUFFER_SIZE           (2048)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* RAM of the lwIP pools sized by the profile, in bytes. */
+typedef struct
+{
+    uint32_t pbuf_pool;          /* Receive buffers. */
+    uint32_t tcp_segments;       /* Segment descriptors. */
+    uint32_t heap;               /* lwIP heap, 0 with MEM_LIBC_MALLOC. */
+    uint32_t send_buffer;        /* Data queued by one connection at most. */
+} lwip_profile_ram_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void lwip_profile_get_ram(lwip_profile_ram_t *ram);
+void lwip_profile_benchmark(void);
+
+#endif /* LWIP_PROFILE_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: lwipopts.h
+*
+* Description: This file contains the lwIP options of the application: the
+* defaults of the wifi-core-freertos-lwip-mbedtls library, with the TCP
+* window, send buffer, pbuf pool, and memory pools set by the profile that
+* LWIP_PROFILE selects in the Makefile.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef APP_LWIPOPTS_H_
+#define APP_LWIPOPTS_H_
+
+/* Defaults of the library, which this file shadows on the include path. */
+#include_next <lwipopts.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Profiles. The MSS stays at the Ethernet size of the Wi-Fi link, and the
+ * window and the send buffer are whole segments. Received frames are held in
+ * the pbuf pool until the application reads them, so the pool must cover the
+ * advertised window, and a pool smaller than a burst of the AP drops frames.
+ *
+ *  LWIP_PROFILE_LOW_RAM   Two segments in flight each way. For products that
+ *                         send small requests and keep RAM for the application.
+ *  LWIP_PROFILE_BALANCED  Four segments each way. The default.
+ *  LWIP_PROFILE_BULK      Eight segments each way, for firmware and asset
+ *                         transfers over links with a long round trip.
+ *
+ * MEM_SIZE only matters when lwIP uses its own heap (MEM_LIBC_MALLOC 0).
+ */
+#if defined(LWIP_PROFILE_LOW_RAM)
+#define LWIP_PROFILE_NAME                        "LOW_RAM"
+#define LWIP_PROFILE_SEGMENTS                    (2)
+#define LWIP_PROFILE_PBUF_POOL_SIZE              (8)
+#define LWIP_PROFILE_MEM_SIZE                    (8 * 1024)
+#elif defined(LWIP_PROFILE_BULK)
+#define LWIP_PROFILE_NAME                        "BULK"
+#define LWIP_PROFILE_SEGMENTS                    (8)
+#define LWIP_PROFILE_PBUF_POOL_SIZE              (24)
+#define LWIP_PROFILE_MEM_SIZE                    (32 * 1024)
+#else
+#define LWIP_PROFILE_NAME                        "BALANCED"
+#define LWIP_PROFILE_SEGMENTS                    (4)
+#define LWIP_PROFILE_PBUF_POOL_SIZE              (16)
+#define LWIP_PROFILE_MEM_SIZE                    (16 * 1024)
+#endif
+
+#undef TCP_MSS
+#define TCP_MSS                                  (1460)
+
+#undef TCP_WND
+#define TCP_WND                                  (LWIP_PROFILE_SEGMENTS * TCP_MSS)
+
+#undef TCP_SND_BUF
+#define TCP_SND_BUF                              (LWIP_PROFILE_SEGMENTS * TCP_MSS)
+
+/* lwIP requires at least two queued pbufs per segment of the send buffer,
+ * and a segment descriptor for each queued pbuf, with room for the
+ * unacknowledged segments of a second connection.
+ */
+#undef TCP_SND_QUEUELEN
+#define TCP_SND_QUEUELEN                         (4 * LWIP_PROFILE_SEGMENTS)
+
+#undef MEMP_NUM_TCP_SEG
+#define MEMP_NUM_TCP_SEG                         (2 * TCP_SND_QUEUELEN)
+
+/* The thresholds derive from the values above. They are set again in case
+ * the library defaults fixed them for its own buffer sizes.
+ */
+#undef TCP_SNDLOWAT
+#define TCP_SNDLOWAT                             (TCP_SND_BUF / 2)
+
+/* lwIP rejects a send low-water mark that is not below the send buffer. */
+#if (TCP_SNDLOWAT >= TCP_SND_BUF)
+#error "TCP_SNDLOWAT must be less than TCP_SND_BUF"
+#endif
+
+#undef TCP_SNDQUEUELOWAT
+#define TCP_SNDQUEUELOWAT                        (TCP_SND_QUEUELEN / 2)
+
+#undef TCP_WND_UPDATE_THRESHOLD
+#define TCP_WND_UPDATE_THRESHOLD                 (TCP_WND / 4)
+
+#undef PBUF_POOL_SIZE
+#define PBUF_POOL_SIZE                           (LWIP_PROFILE_PBUF_POOL_SIZE)
+
+#undef MEM_SIZE
+#define MEM_SIZE                                 (LWIP_PROFILE_MEM_SIZE)
+
+/* Frames received from the WLAN, which the "WLAN offload" menu option counts
+ * as host wakeups, and TCP segments sent, which the "Request coalescing" menu
+ * option counts. Only in a build with WLAN_OFFLOAD_COUNT_FRAMES, see the
+ * Makefile, so that the profiles are measured without the counters.
+ */
+#if defined(WLAN_OFFLOAD_COUNT_FRAMES)
+#undef LWIP_STATS
+#define LWIP_STATS                               (1)
+
+#undef LINK_STATS
+#define LINK_STATS                               (1)
+#endif
+
+#endif /* APP_LWIPOPTS_H_ */
+
+
+/* [] END OF FILE */
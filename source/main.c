@@ -53,13 +53,12 @@
 #include "FreeRTOS.h"
 #include <task.h>
 
-/* Include serial flash library and QSPI memory configurations only for the
- * kits that require the Wi-Fi firmware to be loaded in external QSPI NOR flash.
+/* Serial flash library and QSPI memory configurations. The external QSPI NOR
+ * flash holds the downloaded resources on all kits, and the Wi-Fi firmware on
+ * the kits that execute it in place.
  */
-#if defined(CY_ENABLE_XIP_PROGRAM)
 #include "cy_serial_flash_qspi.h"
 #include "cycfg_qspi_memslot.h"
-#endif
 
 /******************************************************************************
 * Macros
@@ -107,14 +106,21 @@ int main(void)
     /* Initialize retarget-io to use the debug UART port */
     cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, CY_RETARGET_IO_BAUDRATE);
 
-    /* Init QSPI and enable XIP to get the Wi-Fi firmware from the QSPI NOR flash */
-    #if defined(CY_ENABLE_XIP_PROGRAM)
-        const uint32_t bus_frequency = 50000000lu;
+    /* Init QSPI for the download pipeline that writes into the QSPI NOR flash */
+    const uint32_t bus_frequency = 50000000lu;
 
-        cy_serial_flash_qspi_init(smifMemConfigs[0], CYBSP_QSPI_D0, CYBSP_QSPI_D1,
-                                      CYBSP_QSPI_D2, CYBSP_QSPI_D3, NC, NC, NC, NC,
-                                      CYBSP_QSPI_SCK, CYBSP_QSPI_SS, bus_frequency);
+    result = cy_serial_flash_qspi_init(smifMemConfigs[0], CYBSP_QSPI_D0, CYBSP_QSPI_D1,
+                                       CYBSP_QSPI_D2, CYBSP_QSPI_D3, NC, NC, NC, NC,
+                                       CYBSP_QSPI_SCK, CYBSP_QSPI_SS, bus_frequency);
 
+    /* QSPI init failed. Stop program execution */
+    if (result != CY_RSLT_SUCCESS)
+    {
+        CY_ASSERT(0);
+    }
+
+    /* Enable XIP to get the Wi-Fi firmware from the QSPI NOR flash */
+    #if defined(CY_ENABLE_XIP_PROGRAM)
         cy_serial_flash_qspi_enable_xip(true);
     #endif
 
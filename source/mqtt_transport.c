@@ -0,0 +1,800 @@
+/******************************************************************************
+* File Name: mqtt_transport.c
+*
+* Description: This file contains the MQTT transport. It connects to the
+* broker with the credentials and the secure-sockets TLS stack of the HTTPS
+* client through the MQTT library, keeps a persistent session, publishes at
+* QoS 0 or 1, and batches small messages into fewer publishes.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "mqtt_transport.h"
+#include "wifi_power.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define HTTP_STATUS_OK                   (200u)
+#define HTTP_STATUS_MULTIPLE_CHOICES     (300u)
+
+/* PUBACK: fixed header and packet identifier. */
+#define MQTT_PUBACK_SIZE                 (4u)
+
+/* Largest benchmark message. */
+#define BENCH_MESSAGE_SIZE               (48u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Result of one benchmark mode. */
+typedef struct
+{
+    const char *name;
+    uint32_t messages;
+    uint32_t elapsed_ms;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+} bench_result_t;
+
+/* Totals of the HTTPS benchmark responses. */
+typedef struct
+{
+    uint32_t errors;
+    uint32_t bytes_received;
+} bench_http_counts_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Serializes the publishes, the batch, and the connection between tasks. */
+static SemaphoreHandle_t mqtt_mutex;
+
+static cy_mqtt_t mqtt_handle;
+static uint8_t mqtt_network_buffer[MQTT_NETWORK_BUFFER_SIZE];
+
+/* Set by the MQTT library task when the broker connection drops. */
+static volatile bool mqtt_connected = false;
+static bool mqtt_session_started = false;
+
+/* Messages waiting to be published together. */
+static uint8_t batch_buffer[MQTT_BATCH_BUFFER_SIZE];
+static uint32_t batch_length;
+static uint32_t batch_messages;
+static cy_mqtt_qos_t batch_qos;
+static TickType_t batch_start_ticks;
+
+static mqtt_transport_stats_t mqtt_stats;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t connect_broker(bool clean_session);
+static cy_rslt_t publish_locked(const char *topic, const uint8_t *payload, uint32_t length, cy_mqtt_qos_t qos);
+static cy_rslt_t flush_locked(void);
+static uint32_t publish_packet_size(uint32_t topic_length, uint32_t payload_length, cy_mqtt_qos_t qos);
+static void mqtt_event_callback(cy_mqtt_t handle, cy_mqtt_event_t event, void *user_data);
+static void print_bench_result(const bench_result_t *result);
+static void bench_http_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+static cy_rslt_t bench_mqtt(bench_result_t *result, cy_mqtt_qos_t qos, bool batched);
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the mutex of the transport and initializes the MQTT library. The
+ *  broker is connected on the first publish.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the transport is ready, otherwise,
+ *  the error of the MQTT library or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t mqtt_transport_init(void)
+{
+    cy_rslt_t result;
+
+    if (NULL != mqtt_mutex)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    mqtt_mutex = xSemaphoreCreateMutex();
+    if (NULL == mqtt_mutex)
+    {
+        ERR_INFO(("Failed to create the MQTT transport mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    result = cy_mqtt_init();
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to initialize the MQTT library: 0x%08lx\n", (unsigned long)result));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_connect
+ *******************************************************************************
+ * Summary:
+ *  Connects to the broker and subscribes to MQTT_COMMAND_TOPIC. Without a
+ *  clean session, the broker keeps the subscription and the QoS 1 messages
+ *  for the device while it is disconnected, and delivers them when it
+ *  reconnects.
+ *
+ * Parameters:
+ *  clean_session - Discard the session stored on the broker.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if connected, otherwise, the error of
+ *  the MQTT library.
+ *
+ *******************************************************************************/
+cy_rslt_t mqtt_transport_connect(bool clean_session)
+{
+    cy_rslt_t result;
+
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+    wifi_power_begin();
+    result = connect_broker(clean_session);
+    wifi_power_end();
+    xSemaphoreGive(mqtt_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_publish
+ *******************************************************************************
+ * Summary:
+ *  Publishes one message, connecting to the broker with the persistent
+ *  session first if needed. A QoS 1 publish returns after its PUBACK. If the
+ *  connection drops during a QoS 1 publish, the message is sent again once
+ *  on a new connection, marked as a duplicate. Safe to call from any task.
+ *
+ * Parameters:
+ *  topic - Topic of the message.
+ *  payload - Message.
+ *  length - Length of the message.
+ *  qos - CY_MQTT_QOS0 or CY_MQTT_QOS1.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the message was published,
+ *  otherwise, the error of the MQTT library.
+ *
+ *******************************************************************************/
+cy_rslt_t mqtt_transport_publish(const char *topic, const uint8_t *payload, uint32_t length, cy_mqtt_qos_t qos)
+{
+    cy_rslt_t result;
+
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+    result = publish_locked(topic, payload, length, qos);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        mqtt_stats.messages++;
+    }
+    xSemaphoreGive(mqtt_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_batch_add
+ *******************************************************************************
+ * Summary:
+ *  Adds a message to the batch of MQTT_TELEMETRY_TOPIC. The batch is
+ *  published, its messages separated by newlines, when it is full, holds
+ *  MQTT_BATCH_MAX_MESSAGES messages, or is older than
+ *  MQTT_BATCH_MAX_DELAY_MS. The batch is published at the highest QoS of
+ *  its messages. Safe to call from any task.
+ *
+ * Parameters:
+ *  message - Message, without newlines.
+ *  length - Length of the message.
+ *  qos - CY_MQTT_QOS0 or CY_MQTT_QOS1.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the message was batched or
+ *  published, otherwise, the error of the publish. The messages of a batch
+ *  that failed to publish are dropped.
+ *
+ *******************************************************************************/
+cy_rslt_t mqtt_transport_batch_add(const uint8_t *message, uint32_t length, cy_mqtt_qos_t qos)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+
+    if (length >= MQTT_BATCH_BUFFER_SIZE)
+    {
+        /* Too long to share a publish; the batch goes first to keep the order. */
+        result = flush_locked();
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = publish_locked(MQTT_TELEMETRY_TOPIC, message, length, qos);
+        }
+        if (CY_RSLT_SUCCESS == result)
+        {
+            mqtt_stats.messages++;
+        }
+        xSemaphoreGive(mqtt_mutex);
+        return result;
+    }
+
+    if ((batch_messages > 0u) && ((batch_length + 1u + length) > MQTT_BATCH_BUFFER_SIZE))
+    {
+        result = flush_locked();
+    }
+
+    if (0u == batch_messages)
+    {
+        batch_length = 0;
+        batch_qos = CY_MQTT_QOS0;
+        batch_start_ticks = xTaskGetTickCount();
+    }
+    else
+    {
+        batch_buffer[batch_length++] = '\n';
+    }
+
+    memcpy(&batch_buffer[batch_length], message, length);
+    batch_length += length;
+    batch_messages++;
+    if (qos > batch_qos)
+    {
+        batch_qos = qos;
+    }
+
+    if ((batch_messages >= MQTT_BATCH_MAX_MESSAGES) ||
+        ((uint32_t)(xTaskGetTickCount() - batch_start_ticks) * portTICK_PERIOD_MS >= MQTT_BATCH_MAX_DELAY_MS))
+    {
+        cy_rslt_t flush_result = flush_locked();
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = flush_result;
+        }
+    }
+
+    xSemaphoreGive(mqtt_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_batch_flush
+ *******************************************************************************
+ * Summary:
+ *  Publishes the batched messages now.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the batch was published or empty,
+ *  otherwise, the error of the publish.
+ *
+ *******************************************************************************/
+cy_rslt_t mqtt_transport_batch_flush(void)
+{
+    cy_rslt_t result;
+
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+    result = flush_locked();
+    xSemaphoreGive(mqtt_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_disconnect
+ *******************************************************************************
+ * Summary:
+ *  Publishes the pending batch and disconnects from the broker. The session
+ *  stays on the broker.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void mqtt_transport_disconnect(void)
+{
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+
+    if (mqtt_connected)
+    {
+        (void)flush_locked();
+        wifi_power_begin();
+        (void)cy_mqtt_disconnect(mqtt_handle);
+        wifi_power_end();
+        mqtt_connected = false;
+        mqtt_session_started = false;
+    }
+
+    xSemaphoreGive(mqtt_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Copies the counters of the transport.
+ *
+ * Parameters:
+ *  stats - Receives the counters.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void mqtt_transport_get_stats(mqtt_transport_stats_t *stats)
+{
+    xSemaphoreTake(mqtt_mutex, portMAX_DELAY);
+    *stats = mqtt_stats;
+    xSemaphoreGive(mqtt_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_transport_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Sends MQTT_BENCH_MESSAGES small JSON messages as HTTPS POST requests,
+ *  MQTT QoS 0 publishes, MQTT QoS 1 publishes, and batched QoS 1 publishes,
+ *  and prints the messages per second and the bytes per message of each.
+ *  Bytes are HTTP or MQTT bytes before TLS, in both directions. The
+ *  connections are opened before the measurements.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void mqtt_transport_benchmark(void)
+{
+    bench_result_t result;
+    bench_http_counts_t counts;
+    https_request_t request = {0};
+    char message[BENCH_MESSAGE_SIZE];
+    TickType_t start_ticks = xTaskGetTickCount();
+    cy_rslt_t status = CY_RSLT_SUCCESS;
+    int length;
+
+    request.method = CY_HTTP_CLIENT_METHOD_POST;
+    request.path = MQTT_BENCH_HTTP_PATH;
+    request.content_type = "application/json";
+    request.response_cb = bench_http_response;
+    request.cb_arg = &counts;
+    request.quiet = true;
+
+    APP_INFO(("%u messages to %s and to the broker %s:%u\n", MQTT_BENCH_MESSAGES, MQTT_BENCH_HTTP_PATH,
+              MQTT_BROKER_HOST, MQTT_BROKER_PORT));
+    printf("\n  %-12s %8s %6s %10s %12s %12s\n", "mode", "messages", "ms", "messages/s", "sent B/msg", "recv B/msg");
+
+    /* HTTPS POST, one request per message, after a request that opens the connection. */
+    memset(&counts, 0, sizeof(counts));
+    memset(&result, 0, sizeof(result));
+    result.name = "HTTPS POST";
+
+    for (uint32_t i = 0; (CY_RSLT_SUCCESS == status) && (i <= MQTT_BENCH_MESSAGES); i++)
+    {
+        length = snprintf(message, sizeof(message), "{\"seq\":%lu,\"temp\":%d}", (unsigned long)i, 20 + (int)(i % 5u));
+        request.body = (const uint8_t *)message;
+        request.body_len = (uint32_t)length;
+
+        if (1u == i)
+        {
+            memset(&counts, 0, sizeof(counts));
+            start_ticks = xTaskGetTickCount();
+        }
+
+        status = https_send_request(&request);
+        if ((CY_RSLT_SUCCESS == status) && (0u != i))
+        {
+            result.messages++;
+            result.bytes_sent += https_last_request_head_len() + (uint32_t)length;
+        }
+    }
+
+    if (CY_RSLT_SUCCESS != status)
+    {
+        ERR_INFO(("The HTTPS POST failed: 0x%08lx\n", (unsigned long)status));
+        return;
+    }
+
+    result.elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+    result.bytes_received = counts.bytes_received;
+    print_bench_result(&result);
+    if (0u != counts.errors)
+    {
+        ERR_INFO(("%lu POST requests had an error status.\n", (unsigned long)counts.errors));
+    }
+
+    status = mqtt_transport_connect(false);
+    if (CY_RSLT_SUCCESS != status)
+    {
+        ERR_INFO(("Failed to connect to the MQTT broker: 0x%08lx\n", (unsigned long)status));
+        return;
+    }
+
+    if ((CY_RSLT_SUCCESS == bench_mqtt(&result, CY_MQTT_QOS0, false)) &&
+        (CY_RSLT_SUCCESS == bench_mqtt(&result, CY_MQTT_QOS1, false)) &&
+        (CY_RSLT_SUCCESS == bench_mqtt(&result, CY_MQTT_QOS1, true)))
+    {
+        printf("  Batches hold up to %u messages; QoS 0 publishes are not acknowledged.\n",
+               MQTT_BATCH_MAX_MESSAGES);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: connect_broker
+ *******************************************************************************
+ * Summary:
+ *  Creates the MQTT instance on first use with the HTTPS client credentials,
+ *  connects, and subscribes to the command topic. Called with the mutex
+ *  taken.
+ *
+ *******************************************************************************/
+static cy_rslt_t connect_broker(bool clean_session)
+{
+    cy_rslt_t result;
+    cy_mqtt_broker_info_t broker_info;
+    cy_mqtt_connect_info_t connect_info;
+    cy_mqtt_subscribe_info_t subscribe_info;
+
+    if (mqtt_connected)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    if (NULL == mqtt_handle)
+    {
+        memset(&broker_info, 0, sizeof(broker_info));
+        broker_info.hostname = MQTT_BROKER_HOST;
+        broker_info.hostname_len = (uint16_t)(sizeof(MQTT_BROKER_HOST) - 1u);
+        broker_info.port = MQTT_BROKER_PORT;
+
+        result = cy_mqtt_create(mqtt_network_buffer, sizeof(mqtt_network_buffer), &security_config,
+                                &broker_info, mqtt_event_callback, NULL, &mqtt_handle);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to create the MQTT instance: 0x%08lx\n", (unsigned long)result));
+            mqtt_handle = NULL;
+            return result;
+        }
+    }
+    else if (mqtt_session_started)
+    {
+        /* The connection dropped; release it before connecting again. */
+        (void)cy_mqtt_disconnect(mqtt_handle);
+        mqtt_session_started = false;
+    }
+
+    memset(&connect_info, 0, sizeof(connect_info));
+    connect_info.client_id = MQTT_CLIENT_ID;
+    connect_info.client_id_len = (uint16_t)(sizeof(MQTT_CLIENT_ID) - 1u);
+    connect_info.keep_alive_sec = MQTT_KEEP_ALIVE_SEC;
+    connect_info.clean_session = clean_session;
+
+    result = cy_mqtt_connect(mqtt_handle, &connect_info);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to connect to the MQTT broker: 0x%08lx\n", (unsigned long)result));
+        return result;
+    }
+
+    mqtt_connected = true;
+    mqtt_session_started = true;
+    mqtt_stats.connections++;
+
+    /* The broker may have lost the session, so the subscription is renewed. */
+    memset(&subscribe_info, 0, sizeof(subscribe_info));
+    subscribe_info.qos = CY_MQTT_QOS1;
+    subscribe_info.topic = MQTT_COMMAND_TOPIC;
+    subscribe_info.topic_len = (uint16_t)(sizeof(MQTT_COMMAND_TOPIC) - 1u);
+
+    result = cy_mqtt_subscribe(mqtt_handle, &subscribe_info, 1);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to subscribe to %s: 0x%08lx\n", MQTT_COMMAND_TOPIC, (unsigned long)result));
+    }
+
+    APP_INFO(("Connected to the MQTT broker %s:%u\n", MQTT_BROKER_HOST, MQTT_BROKER_PORT));
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: publish_locked
+ *******************************************************************************
+ * Summary:
+ *  Publishes one message, connecting first if needed, and sends a QoS 1
+ *  message again once if the connection dropped. Called with the mutex
+ *  taken. The radio is kept awake until the PUBACK; between publishes the
+ *  idle session lets it save power.
+ *
+ *******************************************************************************/
+static cy_rslt_t publish_locked(const char *topic, const uint8_t *payload, uint32_t length, cy_mqtt_qos_t qos)
+{
+    cy_mqtt_publish_info_t publish_info;
+    cy_rslt_t result;
+    uint32_t topic_length = strlen(topic);
+
+    memset(&publish_info, 0, sizeof(publish_info));
+    publish_info.qos = qos;
+    publish_info.topic = topic;
+    publish_info.topic_len = (uint16_t)topic_length;
+    publish_info.payload = (const char *)payload;
+    publish_info.payload_len = length;
+
+    wifi_power_begin();
+
+    for (uint32_t attempt = 0; attempt < 2u; attempt++)
+    {
+        result = connect_broker(false);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            break;
+        }
+
+        result = cy_mqtt_publish(mqtt_handle, &publish_info);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            mqtt_stats.publishes++;
+            mqtt_stats.bytes_sent += publish_packet_size(topic_length, length, qos);
+            if (CY_MQTT_QOS0 != qos)
+            {
+                mqtt_stats.bytes_received += MQTT_PUBACK_SIZE;
+            }
+            break;
+        }
+
+        ERR_INFO(("MQTT publish to %s failed: 0x%08lx\n", topic, (unsigned long)result));
+        mqtt_connected = false;
+
+        if (CY_MQTT_QOS0 == qos)
+        {
+            break;
+        }
+        publish_info.dup = true;
+    }
+
+    wifi_power_end();
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: flush_locked
+ *******************************************************************************
+ * Summary:
+ *  Publishes the batch and empties it. Called with the mutex taken.
+ *
+ *******************************************************************************/
+static cy_rslt_t flush_locked(void)
+{
+    cy_rslt_t result;
+
+    if (0u == batch_messages)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = publish_locked(MQTT_TELEMETRY_TOPIC, batch_buffer, batch_length, batch_qos);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        mqtt_stats.messages += batch_messages;
+    }
+    else
+    {
+        ERR_INFO(("Dropped a batch of %lu MQTT messages.\n", (unsigned long)batch_messages));
+    }
+
+    batch_messages = 0;
+    batch_length = 0;
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: publish_packet_size
+ *******************************************************************************
+ * Summary:
+ *  Returns the size of a PUBLISH packet: fixed header with the variable
+ *  length remaining length, topic, packet identifier for QoS 1, and payload.
+ *
+ *******************************************************************************/
+static uint32_t publish_packet_size(uint32_t topic_length, uint32_t payload_length, cy_mqtt_qos_t qos)
+{
+    uint32_t remaining = 2u + topic_length + ((CY_MQTT_QOS0 != qos) ? 2u : 0u) + payload_length;
+    uint32_t size = 1u + remaining;
+
+    do
+    {
+        size++;
+        remaining >>= 7;
+    } while (remaining > 0u);
+
+    return size;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_callback
+ *******************************************************************************
+ * Summary:
+ *  Handles the events of the MQTT library, in its task: a dropped
+ *  connection is reconnected on the next publish, and commands are printed.
+ *
+ *******************************************************************************/
+static void mqtt_event_callback(cy_mqtt_t handle, cy_mqtt_event_t event, void *user_data)
+{
+    cy_mqtt_publish_info_t *received;
+
+    (void)handle;
+    (void)user_data;
+
+    switch (event.type)
+    {
+        case CY_MQTT_EVENT_TYPE_DISCONNECT:
+            ERR_INFO(("The MQTT connection dropped (reason %d).\n", (int)event.data.reason));
+            mqtt_connected = false;
+            break;
+
+        case CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE:
+            received = &event.data.pub_msg.received_message;
+            mqtt_stats.commands++;
+            APP_INFO(("Command on %.*s: %.*s\n", (int)received->topic_len, received->topic,
+                      (int)received->payload_len, received->payload));
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: bench_mqtt
+ *******************************************************************************
+ * Summary:
+ *  Publishes the benchmark messages at a QoS, one per publish or batched,
+ *  and prints the result.
+ *
+ *******************************************************************************/
+static cy_rslt_t bench_mqtt(bench_result_t *result, cy_mqtt_qos_t qos, bool batched)
+{
+    static const char *names[] = { "MQTT QoS 0", "MQTT QoS 1", "MQTT batched" };
+    mqtt_transport_stats_t before;
+    mqtt_transport_stats_t after;
+    char message[BENCH_MESSAGE_SIZE];
+    TickType_t start_ticks;
+    cy_rslt_t status = CY_RSLT_SUCCESS;
+    int length;
+
+    memset(result, 0, sizeof(*result));
+    result->name = batched ? names[2] : names[qos];
+
+    mqtt_transport_get_stats(&before);
+    start_ticks = xTaskGetTickCount();
+
+    for (uint32_t i = 0; (CY_RSLT_SUCCESS == status) && (i < MQTT_BENCH_MESSAGES); i++)
+    {
+        length = snprintf(message, sizeof(message), "{\"seq\":%lu,\"temp\":%d}", (unsigned long)i, 20 + (int)(i % 5u));
+
+        status = batched ? mqtt_transport_batch_add((const uint8_t *)message, (uint32_t)length, qos) :
+                           mqtt_transport_publish(MQTT_TELEMETRY_TOPIC, (const uint8_t *)message, (uint32_t)length, qos);
+    }
+
+    if ((CY_RSLT_SUCCESS == status) && batched)
+    {
+        status = mqtt_transport_batch_flush();
+    }
+
+    if (CY_RSLT_SUCCESS != status)
+    {
+        ERR_INFO(("%s failed: 0x%08lx\n", result->name, (unsigned long)status));
+        return status;
+    }
+
+    mqtt_transport_get_stats(&after);
+
+    result->elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+    result->messages = after.messages - before.messages;
+    result->bytes_sent = after.bytes_sent - before.bytes_sent;
+    result->bytes_received = after.bytes_received - before.bytes_received;
+    print_bench_result(result);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: print_bench_result
+ *******************************************************************************
+ * Summary:
+ *  Prints a row of the benchmark table.
+ *
+ *******************************************************************************/
+static void print_bench_result(const bench_result_t *result)
+{
+    uint32_t elapsed_ms = (0u == result->elapsed_ms) ? 1u : result->elapsed_ms;
+    uint32_t messages = (0u == result->messages) ? 1u : result->messages;
+
+    printf("  %-12s %8lu %6lu %10lu %12lu %12lu\n", result->name, (unsigned long)result->messages,
+           (unsigned long)result->elapsed_ms, (unsigned long)((result->messages * 1000u) / elapsed_ms),
+           (unsigned long)(result->bytes_sent / messages), (unsigned long)(result->bytes_received / messages));
+}
+
+/*******************************************************************************
+ * Function Name: bench_http_response
+ *******************************************************************************
+ * Summary:
+ *  Counts the bytes and error statuses of the benchmark POST responses.
+ *
+ *******************************************************************************/
+static void bench_http_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    bench_http_counts_t *counts = (bench_http_counts_t *)arg;
+
+    (void)handle;
+
+    counts->bytes_received += (uint32_t)(response->headers_len + response->body_len);
+    if ((response->status_code < HTTP_STATUS_OK) || (response->status_code >= HTTP_STATUS_MULTIPLE_CHOICES))
+    {
+        counts->errors++;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name: mqtt_transport.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the MQTT transport.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef MQTT_TRANSPORT_H_
+#define MQTT_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "cy_mqtt_api.h"
+#include "secure_http_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* MQTT broker. The TLS credentials are those of the HTTPS client, so the
+ * broker needs a server certificate signed by the same root CA. A local
+ * stand-in is mosquitto on the HTTPS server host, with "listener 8883",
+ * "cafile", "certfile", "keyfile" set to the server's files, and
+ * "require_certificate true".
+ */
+#define MQTT_BROKER_HOST                         HTTPS_SERVER_HOST
+#define MQTT_BROKER_PORT                         (8883u)
+
+/* The client ID names the persistent session on the broker, so it must be
+ * unique per device.
+ */
+#define MQTT_CLIENT_ID                           "psoc6-https-client"
+#define MQTT_KEEP_ALIVE_SEC                      (60u)
+
+/* Topics of the telemetry publishes and of the commands received. */
+#define MQTT_TELEMETRY_TOPIC                     "device/telemetry"
+#define MQTT_COMMAND_TOPIC                       "device/commands"
+
+/* Buffer of the MQTT library for packets being received and the headers of
+ * packets being sent. Received messages must fit in it.
+ */
+#define MQTT_NETWORK_BUFFER_SIZE                 (1024u)
+
+/* Batched messages are joined with newlines into one publish of up to this
+ * many bytes or MQTT_BATCH_MAX_MESSAGES messages. A batch older than
+ * MQTT_BATCH_MAX_DELAY_MS is published with the next message added.
+ */
+#define MQTT_BATCH_BUFFER_SIZE                   (512u)
+#define MQTT_BATCH_MAX_MESSAGES                  (10u)
+#define MQTT_BATCH_MAX_DELAY_MS                  (2000u)
+
+/* Messages of the "MQTT benchmark" menu option, and the HTTPS resource their
+ * POST requests are compared with.
+ */
+#define MQTT_BENCH_MESSAGES                      (50u)
+#define MQTT_BENCH_HTTP_PATH                     "/telemetry"
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Counters of the transport. Bytes are MQTT packet bytes, before TLS. */
+typedef struct
+{
+    uint32_t messages;           /* Messages published, batched or not. */
+    uint32_t publishes;          /* PUBLISH packets sent. */
+    uint32_t bytes_sent;
+    uint32_t bytes_received;     /* PUBACK packets of QoS 1 publishes. */
+    uint32_t connections;
+    uint32_t commands;           /* Messages received on MQTT_COMMAND_TOPIC. */
+} mqtt_transport_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t mqtt_transport_init(void);
+cy_rslt_t mqtt_transport_connect(bool clean_session);
+cy_rslt_t mqtt_transport_publish(const char *topic, const uint8_t *payload, uint32_t length, cy_mqtt_qos_t qos);
+cy_rslt_t mqtt_transport_batch_add(const uint8_t *message, uint32_t length, cy_mqtt_qos_t qos);
+cy_rslt_t mqtt_transport_batch_flush(void);
+void mqtt_transport_disconnect(void);
+void mqtt_transport_get_stats(mqtt_transport_stats_t *stats);
+void mqtt_transport_benchmark(void);
+
+#endif /* MQTT_TRANSPORT_H_ */
+
+
+/* [] END OF FILE */
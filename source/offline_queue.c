@@ -0,0 +1,963 @@
+/******************************************************************************
+* File Name: offline_queue.c
+*
+* Description: This file contains the flash-backed store-and-forward queue of
+* HTTP requests. Producers append records to a RAM staging buffer, and the
+* store task programs them into an append-only log of erase sectors in the
+* external flash. Every record carries a CRC-32, so records torn by a power
+* loss are detected when the log is scanned at start-up. The log is replayed
+* in order, in batches read by offline_queue_peek_batch(), once the server is
+* reachable again.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Serial flash library header file */
+#include "cy_serial_flash_qspi.h"
+
+/* Standard C header files */
+#include <stddef.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "offline_queue.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define OFFLINE_RECORD_MAGIC             (0x51C3u)
+#define OFFLINE_RECORD_ERASED_MAGIC      (0xFFFFu)
+
+/* Values of the state byte. A pending record is consumed by programming its
+ * state byte to zero, which needs no erase on NOR flash.
+ */
+#define OFFLINE_RECORD_PENDING           (0xFFu)
+#define OFFLINE_RECORD_CONSUMED          (0x00u)
+
+#define OFFLINE_RECORD_ALIGN(len)        (((len) + 3u) & ~3u)
+#define OFFLINE_RECORD_MAX_LEN           OFFLINE_RECORD_ALIGN(sizeof(offline_record_header_t) + \
+                                             OFFLINE_QUEUE_MAX_PATH_LEN + OFFLINE_QUEUE_MAX_BODY_LEN)
+
+#define CRC32_POLYNOMIAL                 (0xEDB88320UL)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Header of a record in the log. The path and the body follow the header and
+ * the record is padded to a multiple of four bytes.
+ */
+typedef struct
+{
+    uint16_t magic;
+    uint8_t  state;
+    uint8_t  method;
+    uint32_t seq;
+    uint16_t path_len;
+    uint16_t body_len;
+    uint32_t crc;       /* CRC-32 of the record with state 0xFF and crc 0. */
+} offline_record_header_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Geometry of the log. */
+static uint32_t sector_size;
+static uint32_t log_end;
+
+/* Next free byte of the log and the oldest pending record. The queue is empty
+ * when both are equal. The write position never sits on a sector end.
+ */
+static uint32_t write_addr;
+static uint32_t read_addr;
+
+/* Set when the rest of the write sector must not be used, for example after a
+ * torn record was found at start-up.
+ */
+static bool write_sector_closed;
+
+static uint32_t pending_count;
+static uint32_t next_seq;
+
+/* Serializes the log state and the flash operations on the log. */
+static SemaphoreHandle_t log_mutex;
+
+/* Staging buffers filled by the producers. */
+static SemaphoreHandle_t staging_mutex;
+static uint8_t staging_buffer[2][OFFLINE_QUEUE_STAGING_SIZE];
+static uint32_t staging_index;
+static uint32_t staging_len;
+static uint32_t staged_count;
+
+static TaskHandle_t offline_queue_task_handle;
+
+/* Holds the record being read and the batch being replayed. Only used by
+ * one replay at a time.
+ */
+static uint8_t replay_buffer[OFFLINE_RECORD_MAX_LEN];
+static char replay_path[OFFLINE_QUEUE_MAX_PATH_LEN + 1];
+static uint8_t replay_body[OFFLINE_QUEUE_BATCH_SIZE];
+
+/* Records of the last peeked batch, and the read position after them. */
+static uint32_t batch_addr[OFFLINE_QUEUE_BATCH_MAX_RECORDS];
+static uint32_t batch_end;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void offline_queue_task(void *arg);
+static void flush_staging(void);
+static bool batch_accepts(const offline_queue_batch_t *batch, const offline_record_header_t *header,
+                          const uint8_t *record);
+static bool newline_delimited(const offline_record_header_t *header, const uint8_t *record);
+static cy_rslt_t append_record(const uint8_t *record, uint32_t length);
+static void scan_log(void);
+static bool read_valid_header(uint32_t addr, offline_record_header_t *header);
+static bool record_crc_ok(uint32_t addr, const offline_record_header_t *header, uint8_t *buffer);
+static uint32_t skip_to_record(uint32_t addr);
+static uint32_t record_length(const offline_record_header_t *header);
+static uint32_t sector_start(uint32_t addr);
+static uint32_t next_sector_start(uint32_t addr);
+static uint32_t record_crc(const uint8_t *record, uint32_t length);
+
+/*******************************************************************************
+ * Function Name: offline_queue_init
+ *******************************************************************************
+ * Summary:
+ *  Scans the log in the external flash to recover the pending records that
+ *  survived a reset, and starts the store task.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the queue is ready, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t offline_queue_init(void)
+{
+    if (NULL != offline_queue_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    sector_size = (uint32_t)cy_serial_flash_qspi_get_erase_size(OFFLINE_QUEUE_FLASH_ADDRESS);
+    log_end = OFFLINE_QUEUE_FLASH_ADDRESS + (OFFLINE_QUEUE_NUM_SECTORS * sector_size);
+
+    if ((0 == sector_size) || (log_end > (uint32_t)cy_serial_flash_qspi_get_size()))
+    {
+        ERR_INFO(("The offline queue does not fit in the external flash.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    log_mutex = xSemaphoreCreateMutex();
+    staging_mutex = xSemaphoreCreateMutex();
+    if ((NULL == log_mutex) || (NULL == staging_mutex))
+    {
+        ERR_INFO(("Failed to create the offline queue mutexes.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    scan_log();
+    APP_INFO(("Offline queue: %lu pending request(s) recovered from flash\n", (unsigned long)pending_count));
+
+    if (pdPASS != xTaskCreate(offline_queue_task, "Offline Queue", OFFLINE_QUEUE_TASK_STACK_SIZE,
+                              NULL, OFFLINE_QUEUE_TASK_PRIORITY, &offline_queue_task_handle))
+    {
+        ERR_INFO(("Failed to create the offline queue task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: offline_queue_enqueue
+ *******************************************************************************
+ * Summary:
+ *  Appends a request to the RAM staging buffer. The store task programs it
+ *  into the flash within OFFLINE_QUEUE_FLUSH_DELAY_MS, so the call returns
+ *  without waiting for the flash.
+ *
+ * Parameters:
+ *  method - HTTP method of the request.
+ *  path - Resource path, at most OFFLINE_QUEUE_MAX_PATH_LEN characters.
+ *  body - Request body. Can be NULL if body_len is 0.
+ *  body_len - Length of the body, at most OFFLINE_QUEUE_MAX_BODY_LEN bytes.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the request is queued, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t offline_queue_enqueue(cy_http_client_method_t method, const char *path,
+                                const uint8_t *body, uint32_t body_len)
+{
+    offline_record_header_t header;
+    uint32_t path_len;
+    uint32_t length;
+    uint8_t *record;
+
+    if ((NULL == offline_queue_task_handle) || (NULL == path) ||
+        ((NULL == body) && (0 != body_len)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    path_len = (uint32_t)strlen(path);
+    if ((0 == path_len) || (path_len > OFFLINE_QUEUE_MAX_PATH_LEN) || (body_len > OFFLINE_QUEUE_MAX_BODY_LEN))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    length = OFFLINE_RECORD_ALIGN(sizeof(header) + path_len + body_len);
+
+    xSemaphoreTake(staging_mutex, portMAX_DELAY);
+
+    if ((staging_len + length) > OFFLINE_QUEUE_STAGING_SIZE)
+    {
+        xSemaphoreGive(staging_mutex);
+        ERR_INFO(("Offline queue staging buffer is full.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    record = &staging_buffer[staging_index][staging_len];
+
+    header.magic = OFFLINE_RECORD_MAGIC;
+    header.state = OFFLINE_RECORD_PENDING;
+    header.method = (uint8_t)method;
+    header.seq = next_seq++;
+    header.path_len = (uint16_t)path_len;
+    header.body_len = (uint16_t)body_len;
+    header.crc = 0;
+
+    memset(record, 0, length);
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), path, path_len);
+    if (0 != body_len)
+    {
+        memcpy(record + sizeof(header) + path_len, body, body_len);
+    }
+
+    header.crc = record_crc(record, length);
+    memcpy(record + offsetof(offline_record_header_t, crc), &header.crc, sizeof(header.crc));
+
+    staging_len += length;
+    staged_count++;
+
+    xSemaphoreGive(staging_mutex);
+
+    xTaskNotifyGive(offline_queue_task_handle);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: offline_queue_pending
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of queued requests, staged or in flash.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Number of requests waiting to be replayed.
+ *
+ *******************************************************************************/
+uint32_t offline_queue_pending(void)
+{
+    return pending_count + staged_count;
+}
+
+/*******************************************************************************
+ * Function Name: offline_queue_peek_batch
+ *******************************************************************************
+ * Summary:
+ *  Reads the oldest queued records from the flash without removing them.
+ *  Consecutive POST records to the same path whose bodies end with a newline
+ *  are combined into one body, up to OFFLINE_QUEUE_BATCH_MAX_RECORDS records
+ *  and OFFLINE_QUEUE_BATCH_SIZE bytes; any other record is a batch of its
+ *  own. Corrupted records found first are dropped. Records still in RAM are
+ *  left for a later call.
+ *
+ * Parameters:
+ *  batch - Filled with the batch, with records set to 0 if the queue is
+ *  empty.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the queue was read, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t offline_queue_peek_batch(offline_queue_batch_t *batch)
+{
+    offline_record_header_t header;
+    const uint8_t *record;
+    uint32_t addr;
+
+    memset(batch, 0, sizeof(*batch));
+
+    if (NULL == offline_queue_task_handle)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+
+    addr = read_addr;
+    while ((addr != write_addr) && (batch->records < OFFLINE_QUEUE_BATCH_MAX_RECORDS))
+    {
+        if (!read_valid_header(addr, &header) || !record_crc_ok(addr, &header, replay_buffer))
+        {
+            if (0u != batch->records)
+            {
+                break;
+            }
+
+            /* The length of a corrupted record cannot be trusted, so the rest
+             * of its sector is skipped.
+             */
+            ERR_INFO(("Dropping corrupted offline record at 0x%08lx.\n", (unsigned long)addr));
+            if (sector_start(addr) == sector_start(write_addr))
+            {
+                read_addr = write_addr;
+            }
+            else
+            {
+                read_addr = skip_to_record(next_sector_start(addr));
+            }
+            pending_count = ((pending_count > 0) && (read_addr != write_addr)) ? (pending_count - 1) : 0;
+            addr = read_addr;
+            continue;
+        }
+
+        record = replay_buffer + sizeof(header);
+
+        if (OFFLINE_RECORD_CONSUMED == header.state)
+        {
+            if (0u != batch->records)
+            {
+                break;
+            }
+            read_addr = skip_to_record(addr + record_length(&header));
+            addr = read_addr;
+            continue;
+        }
+
+        if (0u == batch->records)
+        {
+            memcpy(replay_path, record, header.path_len);
+            replay_path[header.path_len] = '\0';
+            batch->method = (cy_http_client_method_t)header.method;
+            batch->path = replay_path;
+            batch->body = replay_body;
+        }
+        else if (!batch_accepts(batch, &header, record))
+        {
+            break;
+        }
+
+        memcpy(&replay_body[batch->body_len], record + header.path_len, header.body_len);
+        batch->body_len += header.body_len;
+        batch_addr[batch->records++] = addr;
+        addr = skip_to_record(addr + record_length(&header));
+        batch_end = addr;
+
+        if (!newline_delimited(&header, record))
+        {
+            break;
+        }
+    }
+
+    xSemaphoreGive(log_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: offline_queue_consume_batch
+ *******************************************************************************
+ * Summary:
+ *  Removes the records of the batch returned by the last call to
+ *  offline_queue_peek_batch(), once the server has accepted them. Each
+ *  record is marked consumed in flash, so a reset before this call replays
+ *  the batch again but never loses it.
+ *
+ * Parameters:
+ *  batch - Batch returned by offline_queue_peek_batch().
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void offline_queue_consume_batch(const offline_queue_batch_t *batch)
+{
+    uint8_t consumed = OFFLINE_RECORD_CONSUMED;
+
+    if (0u == batch->records)
+    {
+        return;
+    }
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+
+    for (uint32_t i = 0; i < batch->records; i++)
+    {
+        (void)cy_serial_flash_qspi_write(batch_addr[i] + offsetof(offline_record_header_t, state),
+                                         sizeof(consumed), &consumed);
+    }
+
+    read_addr = batch_end;
+    pending_count = (pending_count > batch->records) ? (pending_count - batch->records) : 0;
+    if (read_addr == write_addr)
+    {
+        pending_count = 0;
+    }
+
+    xSemaphoreGive(log_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: offline_queue_task
+ *******************************************************************************
+ * Summary:
+ *  Programs the staged records into the flash. After the first record arrives
+ *  the task waits OFFLINE_QUEUE_FLUSH_DELAY_MS, so that the records enqueued
+ *  in a burst are written together.
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void offline_queue_task(void *arg)
+{
+    (void)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(OFFLINE_QUEUE_FLUSH_DELAY_MS));
+        flush_staging();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush_staging
+ *******************************************************************************
+ * Summary:
+ *  Swaps the staging buffers and appends the records of the filled one to the
+ *  log. The log mutex is held for the whole flush, so the records reach the
+ *  flash in the order they were enqueued.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void flush_staging(void)
+{
+    offline_record_header_t header;
+    uint8_t *buffer;
+    uint32_t length;
+    uint32_t count;
+    uint32_t offset = 0;
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+
+    xSemaphoreTake(staging_mutex, portMAX_DELAY);
+    buffer = staging_buffer[staging_index];
+    length = staging_len;
+    count = staged_count;
+    staging_index ^= 1u;
+    staging_len = 0;
+    staged_count = 0;
+    xSemaphoreGive(staging_mutex);
+
+    /* The count moves from staged to pending before the records are written,
+     * so offline_queue_pending() never misses them.
+     */
+    pending_count += count;
+
+    while (offset < length)
+    {
+        memcpy(&header, buffer + offset, sizeof(header));
+        if (CY_RSLT_SUCCESS != append_record(buffer + offset, record_length(&header)))
+        {
+            pending_count--;
+        }
+        offset += record_length(&header);
+    }
+
+    xSemaphoreGive(log_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: batch_accepts
+ *******************************************************************************
+ * Summary:
+ *  Checks that a record can be appended to a batch: it is a newline-delimited
+ *  POST to the path of the batch, and its body fits in the batch.
+ *
+ * Parameters:
+ *  batch - Batch being built.
+ *  header - Header of the record.
+ *  record - Path and body of the record.
+ *
+ * Return:
+ *  bool: true if the record can be appended.
+ *
+ *******************************************************************************/
+static bool batch_accepts(const offline_queue_batch_t *batch, const offline_record_header_t *header,
+                          const uint8_t *record)
+{
+    return ((cy_http_client_method_t)header->method == batch->method) &&
+           newline_delimited(header, record) &&
+           (header->path_len == strlen(batch->path)) &&
+           (0 == memcmp(record, batch->path, header->path_len)) &&
+           ((batch->body_len + header->body_len) <= OFFLINE_QUEUE_BATCH_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: newline_delimited
+ *******************************************************************************
+ * Summary:
+ *  Checks that a record is a POST whose body ends with a newline, so that
+ *  its body can be concatenated with those of the following records.
+ *
+ * Parameters:
+ *  header - Header of the record.
+ *  record - Path and body of the record.
+ *
+ * Return:
+ *  bool: true if the record can be batched.
+ *
+ *******************************************************************************/
+static bool newline_delimited(const offline_record_header_t *header, const uint8_t *record)
+{
+    return (CY_HTTP_CLIENT_METHOD_POST == (cy_http_client_method_t)header->method) &&
+           (0u != header->body_len) &&
+           ('\n' == record[header->path_len + header->body_len - 1u]);
+}
+
+/*******************************************************************************
+ * Function Name: append_record
+ *******************************************************************************
+ * Summary:
+ *  Programs one record at the write position. A record never spans two
+ *  sectors; when it does not fit, the log moves to the next sector, which is
+ *  erased first. The sectors are used round robin, so erases are spread evenly
+ *  over the log. Must be called with the log mutex held.
+ *
+ * Parameters:
+ *  record - Serialized record.
+ *  length - Length of the record.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the record is in flash, otherwise, it
+ *  returns a serial flash or CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+static cy_rslt_t append_record(const uint8_t *record, uint32_t length)
+{
+    cy_rslt_t result;
+    uint32_t next_sector;
+    bool empty = (read_addr == write_addr);
+
+    /* The write position is kept strictly inside a sector, so that it can
+     * never be mistaken for the start of the next one.
+     */
+    if (write_sector_closed || ((write_addr + length) >= (sector_start(write_addr) + sector_size)))
+    {
+        next_sector = next_sector_start(write_addr);
+
+        if (!empty && (sector_start(read_addr) == next_sector))
+        {
+            ERR_INFO(("Offline queue is full, dropping request.\n"));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        result = cy_serial_flash_qspi_erase(next_sector, sector_size);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to erase offline queue sector 0x%08lx.\n", (unsigned long)next_sector));
+            write_sector_closed = true;
+            return result;
+        }
+
+        write_addr = next_sector;
+        write_sector_closed = false;
+        if (empty)
+        {
+            read_addr = write_addr;
+        }
+    }
+
+    result = cy_serial_flash_qspi_write(write_addr, length, record);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        /* The area may be partially programmed. Do not reuse it. */
+        ERR_INFO(("Failed to program offline record at 0x%08lx.\n", (unsigned long)write_addr));
+        write_sector_closed = true;
+        return result;
+    }
+
+    write_addr += length;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: scan_log
+ *******************************************************************************
+ * Summary:
+ *  Rebuilds the queue state from the flash. The sector whose first record has
+ *  the highest sequence number holds the newest records; the write position
+ *  is after its last valid record. A record with a bad CRC there was torn by
+ *  a power loss, and the rest of that sector is left unused. The pending
+ *  records are then counted from the oldest sector onwards.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void scan_log(void)
+{
+    offline_record_header_t header;
+    uint32_t sector;
+    uint32_t addr;
+    uint32_t end;
+    uint32_t newest = log_end;
+    uint32_t oldest = log_end;
+    uint32_t newest_seq = 0;
+    uint32_t oldest_seq = 0;
+    uint32_t index;
+    bool found_tail = false;
+
+    for (sector = OFFLINE_QUEUE_FLASH_ADDRESS; sector < log_end; sector += sector_size)
+    {
+        if (read_valid_header(sector, &header) && record_crc_ok(sector, &header, replay_buffer))
+        {
+            if ((log_end == newest) || ((int32_t)(header.seq - newest_seq) > 0))
+            {
+                newest = sector;
+                newest_seq = header.seq;
+            }
+            if ((log_end == oldest) || ((int32_t)(header.seq - oldest_seq) < 0))
+            {
+                oldest = sector;
+                oldest_seq = header.seq;
+            }
+        }
+    }
+
+    pending_count = 0;
+
+    if (log_end == newest)
+    {
+        /* Nothing usable in the log. Start on a freshly erased sector. */
+        write_addr = OFFLINE_QUEUE_FLASH_ADDRESS;
+        read_addr = write_addr;
+        write_sector_closed = true;
+        next_seq = 0;
+        return;
+    }
+
+    /* Find the write position in the newest sector. */
+    addr = newest;
+    end = newest + sector_size;
+    next_seq = newest_seq;
+    write_sector_closed = false;
+    while ((addr + sizeof(header)) < end)
+    {
+        cy_serial_flash_qspi_read(addr, sizeof(header), (uint8_t *)&header);
+        if (OFFLINE_RECORD_ERASED_MAGIC == header.magic)
+        {
+            break;
+        }
+        if (!read_valid_header(addr, &header) || !record_crc_ok(addr, &header, replay_buffer))
+        {
+            write_sector_closed = true;
+            break;
+        }
+        next_seq = header.seq + 1u;
+        addr += record_length(&header);
+    }
+    write_addr = addr;
+
+    /* Walk the sectors from the oldest to the newest and count the records
+     * that were never consumed.
+     */
+    read_addr = write_addr;
+    sector = oldest;
+    for (index = 0; index < OFFLINE_QUEUE_NUM_SECTORS; index++)
+    {
+        addr = sector;
+        end = (sector == newest) ? write_addr : (sector + sector_size);
+
+        while ((addr < end) && read_valid_header(addr, &header))
+        {
+            if (OFFLINE_RECORD_CONSUMED != header.state)
+            {
+                if (!found_tail)
+                {
+                    read_addr = addr;
+                    found_tail = true;
+                }
+                pending_count++;
+            }
+            addr += record_length(&header);
+        }
+
+        if (sector == newest)
+        {
+            break;
+        }
+        sector = next_sector_start(sector);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: read_valid_header
+ *******************************************************************************
+ * Summary:
+ *  Reads a record header and checks that it is plausible: the magic number is
+ *  right and the record lies within its sector.
+ *
+ * Parameters:
+ *  addr - Flash address of the record.
+ *  header - Filled with the header.
+ *
+ * Return:
+ *  bool: true if the header is plausible.
+ *
+ *******************************************************************************/
+static bool read_valid_header(uint32_t addr, offline_record_header_t *header)
+{
+    if ((addr + sizeof(*header)) >= (sector_start(addr) + sector_size))
+    {
+        return false;
+    }
+
+    if (CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(addr, sizeof(*header), (uint8_t *)header))
+    {
+        return false;
+    }
+
+    return (OFFLINE_RECORD_MAGIC == header->magic) &&
+           (0 != header->path_len) && (header->path_len <= OFFLINE_QUEUE_MAX_PATH_LEN) &&
+           (header->body_len <= OFFLINE_QUEUE_MAX_BODY_LEN) &&
+           ((addr + record_length(header)) < (sector_start(addr) + sector_size));
+}
+
+/*******************************************************************************
+ * Function Name: record_crc_ok
+ *******************************************************************************
+ * Summary:
+ *  Reads a whole record into the buffer and verifies its CRC-32.
+ *
+ * Parameters:
+ *  addr - Flash address of the record.
+ *  header - Header of the record, already checked by read_valid_header().
+ *  buffer - Buffer of OFFLINE_RECORD_MAX_LEN bytes.
+ *
+ * Return:
+ *  bool: true if the CRC matches.
+ *
+ *******************************************************************************/
+static bool record_crc_ok(uint32_t addr, const offline_record_header_t *header, uint8_t *buffer)
+{
+    uint32_t length = record_length(header);
+    uint32_t crc = header->crc;
+
+    if (CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(addr, length, buffer))
+    {
+        return false;
+    }
+
+    /* The CRC is computed with the state byte and the CRC field in their
+     * initial values.
+     */
+    buffer[offsetof(offline_record_header_t, state)] = OFFLINE_RECORD_PENDING;
+    memset(buffer + offsetof(offline_record_header_t, crc), 0, sizeof(header->crc));
+
+    return (crc == record_crc(buffer, length));
+}
+
+/*******************************************************************************
+ * Function Name: skip_to_record
+ *******************************************************************************
+ * Summary:
+ *  Returns the first record at or after the given address, moving to the next
+ *  sector at the end of the data in a sector. The search never goes past the
+ *  write position. Must be called with the log mutex held.
+ *
+ * Parameters:
+ *  addr - Address just past a record.
+ *
+ * Return:
+ *  uint32_t: Address of the next record, or the write position if none.
+ *
+ *******************************************************************************/
+static uint32_t skip_to_record(uint32_t addr)
+{
+    offline_record_header_t header;
+    uint32_t index;
+
+    for (index = 0; (index <= OFFLINE_QUEUE_NUM_SECTORS) && (addr != write_addr); index++)
+    {
+        if (read_valid_header(addr, &header))
+        {
+            return addr;
+        }
+
+        /* Past the data of the write sector there is nothing left. */
+        if (sector_start(addr) == sector_start(write_addr))
+        {
+            break;
+        }
+        addr = next_sector_start(addr);
+    }
+
+    return write_addr;
+}
+
+/*******************************************************************************
+ * Function Name: record_length
+ *******************************************************************************
+ * Summary:
+ *  Returns the length of a record including the header and the padding.
+ *
+ * Parameters:
+ *  header - Record header.
+ *
+ * Return:
+ *  uint32_t: Length of the record in the log.
+ *
+ *******************************************************************************/
+static uint32_t record_length(const offline_record_header_t *header)
+{
+    return OFFLINE_RECORD_ALIGN(sizeof(*header) + header->path_len + header->body_len);
+}
+
+/*******************************************************************************
+ * Function Name: sector_start
+ *******************************************************************************
+ * Summary:
+ *  Returns the start of the log sector that contains the address.
+ *
+ * Parameters:
+ *  addr - Address in the log.
+ *
+ * Return:
+ *  uint32_t: Sector start address.
+ *
+ *******************************************************************************/
+static uint32_t sector_start(uint32_t addr)
+{
+    return OFFLINE_QUEUE_FLASH_ADDRESS +
+           (((addr - OFFLINE_QUEUE_FLASH_ADDRESS) / sector_size) * sector_size);
+}
+
+/*******************************************************************************
+ * Function Name: next_sector_start
+ *******************************************************************************
+ * Summary:
+ *  Returns the start of the log sector after the one that contains the
+ *  address, wrapping around at the end of the log.
+ *
+ * Parameters:
+ *  addr - Address in the log.
+ *
+ * Return:
+ *  uint32_t: Start address of the next sector.
+ *
+ *******************************************************************************/
+static uint32_t next_sector_start(uint32_t addr)
+{
+    uint32_t next = sector_start(addr) + sector_size;
+
+    return (next >= log_end) ? OFFLINE_QUEUE_FLASH_ADDRESS : next;
+}
+
+/*******************************************************************************
+ * Function Name: record_crc
+ *******************************************************************************
+ * Summary:
+ *  Computes the CRC-32 (IEEE 802.3) of a record.
+ *
+ * Parameters:
+ *  record - Record bytes.
+ *  length - Length of the record.
+ *
+ * Return:
+ *  uint32_t: CRC-32 of the record.
+ *
+ *******************************************************************************/
+static uint32_t record_crc(const uint8_t *record, uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    uint32_t index;
+    uint32_t bit;
+
+    for (index = 0; index < length; index++)
+    {
+        crc ^= record[index];
+        for (bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: offline_queue.h
+*
+* Description: This file contains the configuration parameters and the API of
+* the flash-backed store-and-forward queue that keeps the HTTP requests which
+* could not be sent while the network or the server was unreachable.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef OFFLINE_QUEUE_H_
+#define OFFLINE_QUEUE_H_
+
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Location of the log in the external flash. The log is a ring of whole erase
+ * sectors placed after the area used by the download pipeline.
+ */
+#define OFFLINE_QUEUE_FLASH_ADDRESS              (0x01000000UL)
+#define OFFLINE_QUEUE_NUM_SECTORS                (4)
+
+/* Largest resource path and body that can be queued. */
+#define OFFLINE_QUEUE_MAX_PATH_LEN               (64)
+#define OFFLINE_QUEUE_MAX_BODY_LEN               (512)
+
+/* RAM staging buffer that producers append to. Two of them are used so that
+ * producers can keep enqueuing while the other one is programmed.
+ */
+#define OFFLINE_QUEUE_STAGING_SIZE               (2048)
+
+/* Consecutive records of newline-delimited bodies posted to the same path,
+ * such as the telemetry records, are replayed in one request of at most
+ * this many records and body bytes.
+ */
+#define OFFLINE_QUEUE_BATCH_MAX_RECORDS          (32)
+#define OFFLINE_QUEUE_BATCH_SIZE                 (2048)
+
+/* Time a record may stay in RAM before the store task programs it. This is
+ * the window in which a power loss can lose enqueued records.
+ */
+#define OFFLINE_QUEUE_FLUSH_DELAY_MS             (100)
+
+/* Store task parameters. */
+#define OFFLINE_QUEUE_TASK_STACK_SIZE            (1024)
+#define OFFLINE_QUEUE_TASK_PRIORITY              (1)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Statistics of a replay of the queue. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t records;            /* Records sent and removed from the queue. */
+    uint32_t requests;           /* Requests sent, each with one or more records. */
+    uint32_t bytes;              /* Path and body bytes replayed. */
+    uint32_t elapsed_ms;         /* Wall-clock time of the replay. */
+    uint32_t records_per_sec;    /* Replay throughput. */
+} offline_queue_stats_t;
+
+/* Oldest queued records, combined into one request. The path and the body
+ * stay valid until the next call to offline_queue_peek_batch().
+ */
+typedef struct
+{
+    cy_http_client_method_t method;
+    const char *path;
+    const uint8_t *body;
+    uint32_t body_len;
+    uint32_t records;            /* 0 when the queue is empty. */
+} offline_queue_batch_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t offline_queue_init(void);
+cy_rslt_t offline_queue_enqueue(cy_http_client_method_t method, const char *path,
+                                const uint8_t *body, uint32_t body_len);
+uint32_t offline_queue_pending(void);
+cy_rslt_t offline_queue_peek_batch(offline_queue_batch_t *batch);
+void offline_queue_consume_batch(const offline_queue_batch_t *batch);
+
+#endif /* OFFLINE_QUEUE_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1070 @@
+/******************************************************************************
+* File Name: payload_codec.c
+*
+* Description: This file contains the encoders and decoders of the sensor
+* sample in CBOR, JSON, and form-urlencoded form, a benchmark comparing them,
+* and the CBOR request that negotiates the media type with the server.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+/* FreeRTOS header file */
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "cy_http_client_api.h"
+#include "secure_http_client.h"
+#include "payload_codec.h"
+#include "cbor.h"
+#include "cycle_counter.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of key/value pairs of an encoded sample. */
+#define PAYLOAD_SAMPLE_FIELDS                    (7u)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Format of the posted samples. Falls back to form encoding once the server
+ * has answered a CBOR request with 415 Unsupported Media Type.
+ */
+static payload_format_t request_format = PAYLOAD_FORMAT_CBOR;
+
+static uint8_t payload_buffer[PAYLOAD_CODEC_BUFFER_SIZE];
+
+static const char *const payload_format_names[PAYLOAD_FORMAT_COUNT] = { "CBOR", "JSON", "form" };
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static size_t encode_cbor(const sensor_sample_t *sample, uint8_t *buffer, size_t size);
+static size_t encode_text(payload_format_t format, const sensor_sample_t *sample, uint8_t *buffer, size_t size);
+static bool decode_cbor(const uint8_t *data, size_t length, sensor_sample_t *sample);
+static bool decode_json(const uint8_t *data, size_t length, sensor_sample_t *sample);
+static bool decode_form(const uint8_t *data, size_t length, sensor_sample_t *sample);
+static bool set_text_field(sensor_sample_t *sample, const char *key, size_t key_len,
+                           const char *value, size_t value_len);
+static bool parse_number(const char *text, size_t length, int64_t *integer, float *number);
+static bool key_equals(const char *key, size_t key_len, const char *name);
+static void format_centi(char *text, size_t size, float value);
+static void simulate_sample(sensor_sample_t *sample, uint32_t seq);
+static void handle_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+static bool media_type_equals(const char *value, size_t length, const char *type);
+static void print_cbor_body(const uint8_t *body, size_t length);
+
+/*******************************************************************************
+ * Function Name: payload_content_type
+ *******************************************************************************
+ * Summary:
+ *  Returns the media type of a payload format.
+ *
+ * Parameters:
+ *  format - Payload format.
+ *
+ * Return:
+ *  const char *: Value of the Content-Type header.
+ *
+ *******************************************************************************/
+const char *payload_content_type(payload_format_t format)
+{
+    switch (format)
+    {
+        case PAYLOAD_FORMAT_CBOR:
+            return CBOR_CONTENT_TYPE;
+
+        case PAYLOAD_FORMAT_JSON:
+            return PAYLOAD_JSON_CONTENT_TYPE;
+
+        default:
+            return HTTP_DEFAULT_CONTENT_TYPE;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_encode
+ *******************************************************************************
+ * Summary:
+ *  Encodes a sample in the given format.
+ *
+ * Parameters:
+ *  format - Payload format.
+ *  sample - Sample to encode.
+ *  buffer - Output buffer.
+ *  size - Size of the output buffer.
+ *
+ * Return:
+ *  size_t: Length of the encoded sample, 0 if it does not fit in the buffer.
+ *
+ *******************************************************************************/
+size_t payload_encode(payload_format_t format, const sensor_sample_t *sample, uint8_t *buffer, size_t size)
+{
+    if (PAYLOAD_FORMAT_CBOR == format)
+    {
+        return encode_cbor(sample, buffer, size);
+    }
+
+    return encode_text(format, sample, buffer, size);
+}
+
+/*******************************************************************************
+ * Function Name: payload_decode
+ *******************************************************************************
+ * Summary:
+ *  Decodes a sample in the given format. Fields missing from the input are
+ *  left unchanged, unknown fields are ignored.
+ *
+ * Parameters:
+ *  format - Payload format.
+ *  data - Encoded sample.
+ *  length - Length of the encoded sample.
+ *  sample - Filled with the decoded fields.
+ *
+ * Return:
+ *  bool: true if the input was decoded.
+ *
+ *******************************************************************************/
+bool payload_decode(payload_format_t format, const uint8_t *data, size_t length, sensor_sample_t *sample)
+{
+    switch (format)
+    {
+        case PAYLOAD_FORMAT_CBOR:
+            return decode_cbor(data, length, sample);
+
+        case PAYLOAD_FORMAT_JSON:
+            return decode_json(data, length, sample);
+
+        default:
+            return decode_form(data, length, sample);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_codec_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Encodes and decodes the same sample PAYLOAD_CODEC_BENCH_ITERATIONS times
+ *  in each format and prints the encoded size and the average CPU cycles.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void payload_codec_benchmark(void)
+{
+    sensor_sample_t sample;
+    sensor_sample_t decoded;
+    payload_format_t format;
+    uint32_t index;
+    uint32_t start;
+    uint32_t encode_cycles;
+    uint32_t decode_cycles;
+    size_t length = 0;
+    bool decoded_ok = true;
+
+    cycle_counter_enable();
+
+    APP_INFO(("Payload encodings, average of %u runs:\n", PAYLOAD_CODEC_BENCH_ITERATIONS));
+
+    for (format = PAYLOAD_FORMAT_CBOR; format < PAYLOAD_FORMAT_COUNT; format++)
+    {
+        simulate_sample(&sample, 0);
+
+        start = cycle_counter_get();
+        for (index = 0; index < PAYLOAD_CODEC_BENCH_ITERATIONS; index++)
+        {
+            sample.seq = index;
+            length = payload_encode(format, &sample, payload_buffer, sizeof(payload_buffer));
+        }
+        encode_cycles = cycle_counter_get() - start;
+
+        memset(&decoded, 0, sizeof(decoded));
+
+        start = cycle_counter_get();
+        for (index = 0; index < PAYLOAD_CODEC_BENCH_ITERATIONS; index++)
+        {
+            decoded_ok &= payload_decode(format, payload_buffer, length, &decoded);
+        }
+        decode_cycles = cycle_counter_get() - start;
+
+        decoded_ok &= (decoded.seq == sample.seq) && (decoded.battery_mv == sample.battery_mv) &&
+                      (0 == strcmp(decoded.device_id, sample.device_id));
+
+        printf("  %-5s %4u bytes %7lu cycles/encode %7lu cycles/decode\n",
+               payload_format_names[format], (unsigned int)length,
+               (unsigned long)(encode_cycles / PAYLOAD_CODEC_BENCH_ITERATIONS),
+               (unsigned long)(decode_cycles / PAYLOAD_CODEC_BENCH_ITERATIONS));
+    }
+
+    if (!decoded_ok)
+    {
+        ERR_INFO(("A decoded sample does not match the encoded one.\n"));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_codec_request
+ *******************************************************************************
+ * Summary:
+ *  Posts a sample to PAYLOAD_CODEC_PATH. The sample is sent as CBOR with an
+ *  Accept header preferring a CBOR response. If the server rejects CBOR, the
+ *  sample is sent again form-encoded and form encoding is kept for the later
+ *  requests.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a response is received, otherwise,
+ *  the error of https_send_request() or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t payload_codec_request(void)
+{
+    static uint32_t seq = 0;
+    cy_rslt_t result;
+    sensor_sample_t sample;
+    https_request_t request = {0};
+    uint16_t status_code;
+    size_t length;
+
+    simulate_sample(&sample, seq++);
+
+    while (true)
+    {
+        length = payload_encode(request_format, &sample, payload_buffer, sizeof(payload_buffer));
+        if (0 == length)
+        {
+            ERR_INFO(("The sample does not fit in %u bytes.\n", PAYLOAD_CODEC_BUFFER_SIZE));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        request.method = CY_HTTP_CLIENT_METHOD_POST;
+        request.path = PAYLOAD_CODEC_PATH;
+        request.content_type = payload_content_type(request_format);
+        request.accept = PAYLOAD_CODEC_ACCEPT;
+        request.body = payload_buffer;
+        request.body_len = (uint32_t)length;
+        request.response_cb = handle_response;
+        request.cb_arg = &status_code;
+
+        status_code = 0;
+        result = https_send_request(&request);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to post the %s sample.\n", payload_format_names[request_format]));
+            return result;
+        }
+
+        APP_INFO(("Posted a %u byte %s sample\n", (unsigned int)length, payload_format_names[request_format]));
+
+        if ((HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE == status_code) && (PAYLOAD_FORMAT_FORM != request_format))
+        {
+            APP_INFO(("The server does not accept %s, falling back to form encoding\n",
+                      payload_format_names[request_format]));
+            request_format = PAYLOAD_FORMAT_FORM;
+            continue;
+        }
+
+        break;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: encode_cbor
+ *******************************************************************************
+ * Summary:
+ *  Encodes a sample as a CBOR map.
+ *
+ * Parameters:
+ *  sample - Sample to encode.
+ *  buffer - Output buffer.
+ *  size - Size of the output buffer.
+ *
+ * Return:
+ *  size_t: Length of the encoded sample, 0 if it does not fit in the buffer.
+ *
+ *******************************************************************************/
+static size_t encode_cbor(const sensor_sample_t *sample, uint8_t *buffer, size_t size)
+{
+    cbor_encoder_t enc;
+
+    cbor_encoder_init(&enc, buffer, size, NULL, NULL);
+
+    cbor_encode_map(&enc, PAYLOAD_SAMPLE_FIELDS);
+    cbor_encode_cstr(&enc, "seq");
+    cbor_encode_uint(&enc, sample->seq);
+    cbor_encode_cstr(&enc, "t");
+    cbor_encode_uint(&enc, sample->timestamp_ms);
+    cbor_encode_cstr(&enc, "temp");
+    cbor_encode_float(&enc, sample->temperature);
+    cbor_encode_cstr(&enc, "hum");
+    cbor_encode_float(&enc, sample->humidity);
+    cbor_encode_cstr(&enc, "bat");
+    cbor_encode_uint(&enc, sample->battery_mv);
+    cbor_encode_cstr(&enc, "alarm");
+    cbor_encode_bool(&enc, sample->alarm);
+    cbor_encode_cstr(&enc, "id");
+    cbor_encode_cstr(&enc, sample->device_id);
+
+    return (CBOR_OK == cbor_encoder_finish(&enc)) ? enc.length : 0;
+}
+
+/*******************************************************************************
+ * Function Name: encode_text
+ *******************************************************************************
+ * Summary:
+ *  Encodes a sample as a JSON object or as form fields. The floats are
+ *  written with two decimals. The device identifier is written as is, so it
+ *  must not need escaping.
+ *
+ * Parameters:
+ *  format - PAYLOAD_FORMAT_JSON or PAYLOAD_FORMAT_FORM.
+ *  sample - Sample to encode.
+ *  buffer - Output buffer.
+ *  size - Size of the output buffer.
+ *
+ * Return:
+ *  size_t: Length of the encoded sample, 0 if it does not fit in the buffer.
+ *
+ *******************************************************************************/
+static size_t encode_text(payload_format_t format, const sensor_sample_t *sample, uint8_t *buffer, size_t size)
+{
+    char temperature[16];
+    char humidity[16];
+    int length;
+
+    format_centi(temperature, sizeof(temperature), sample->temperature);
+    format_centi(humidity, sizeof(humidity), sample->humidity);
+
+    if (PAYLOAD_FORMAT_JSON == format)
+    {
+        length = snprintf((char *)buffer, size,
+                          "{\"seq\":%lu,\"t\":%lu,\"temp\":%s,\"hum\":%s,\"bat\":%u,\"alarm\":%s,\"id\":\"%s\"}",
+                          (unsigned long)sample->seq, (unsigned long)sample->timestamp_ms,
+                          temperature, humidity, (unsigned int)sample->battery_mv,
+                          sample->alarm ? "true" : "false", sample->device_id);
+    }
+    else
+    {
+        length = snprintf((char *)buffer, size,
+                          "seq=%lu&t=%lu&temp=%s&hum=%s&bat=%u&alarm=%u&id=%s",
+                          (unsigned long)sample->seq, (unsigned long)sample->timestamp_ms,
+                          temperature, humidity, (unsigned int)sample->battery_mv,
+                          sample->alarm ? 1u : 0u, sample->device_id);
+    }
+
+    if ((length < 0) || ((size_t)length >= size))
+    {
+        return 0;
+    }
+
+    return (size_t)length;
+}
+
+/*******************************************************************************
+ * Function Name: decode_cbor
+ *******************************************************************************
+ * Summary:
+ *  Decodes a sample from a CBOR map. Values of unknown keys are skipped,
+ *  whatever their type.
+ *
+ * Parameters:
+ *  data - Encoded sample.
+ *  length - Length of the encoded sample.
+ *  sample - Filled with the decoded fields.
+ *
+ * Return:
+ *  bool: true if the input is a well-formed CBOR map.
+ *
+ *******************************************************************************/
+static bool decode_cbor(const uint8_t *data, size_t length, sensor_sample_t *sample)
+{
+    cbor_decoder_t dec;
+    cbor_item_t map;
+    cbor_item_t key;
+    cbor_item_t value;
+    uint64_t pairs;
+    int64_t integer;
+    size_t value_offset;
+    size_t copy_len;
+
+    cbor_decoder_init(&dec, data, length);
+
+    if ((CBOR_OK != cbor_decode_next(&dec, &map)) || (CBOR_TYPE_MAP != map.type))
+    {
+        return false;
+    }
+
+    for (pairs = map.value; map.indefinite || (pairs > 0); pairs--)
+    {
+        if (CBOR_OK != cbor_decode_next(&dec, &key))
+        {
+            return false;
+        }
+
+        if (CBOR_TYPE_BREAK == key.type)
+        {
+            return map.indefinite;
+        }
+
+        value_offset = dec.offset;
+        if (CBOR_OK != cbor_decode_next(&dec, &value))
+        {
+            return false;
+        }
+
+        if ((CBOR_TYPE_ARRAY == value.type) || (CBOR_TYPE_MAP == value.type) ||
+            (CBOR_TYPE_TAG == value.type) || value.indefinite)
+        {
+            /* Nested or chunked values are not part of a sample. */
+            dec.offset = value_offset;
+            if (CBOR_OK != cbor_decode_skip(&dec))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (cbor_item_text_equals(&key, "temp") || cbor_item_text_equals(&key, "hum"))
+        {
+            float number;
+
+            if (CBOR_TYPE_FLOAT == value.type)
+            {
+                number = value.number;
+            }
+            else if (cbor_item_get_int(&value, &integer))
+            {
+                number = (float)integer;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (cbor_item_text_equals(&key, "temp"))
+            {
+                sample->temperature = number;
+            }
+            else
+            {
+                sample->humidity = number;
+            }
+        }
+        else if (cbor_item_text_equals(&key, "alarm"))
+        {
+            if ((CBOR_TYPE_TRUE != value.type) && (CBOR_TYPE_FALSE != value.type))
+            {
+                return false;
+            }
+            sample->alarm = (CBOR_TYPE_TRUE == value.type);
+        }
+        else if (cbor_item_text_equals(&key, "id"))
+        {
+            if (CBOR_TYPE_TEXT != value.type)
+            {
+                return false;
+            }
+            copy_len = (value.value < (sizeof(sample->device_id) - 1u)) ?
+                       (size_t)value.value : (sizeof(sample->device_id) - 1u);
+            memcpy(sample->device_id, value.data, copy_len);
+            sample->device_id[copy_len] = '\0';
+        }
+        else if (cbor_item_text_equals(&key, "seq") || cbor_item_text_equals(&key, "t") ||
+                 cbor_item_text_equals(&key, "bat"))
+        {
+            if ((CBOR_TYPE_UINT != value.type) || (value.value > UINT32_MAX))
+            {
+                return false;
+            }
+
+            if (cbor_item_text_equals(&key, "seq"))
+            {
+                sample->seq = (uint32_t)value.value;
+            }
+            else if (cbor_item_text_equals(&key, "t"))
+            {
+                sample->timestamp_ms = (uint32_t)value.value;
+            }
+            else
+            {
+                sample->battery_mv = (uint16_t)value.value;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: decode_json
+ *******************************************************************************
+ * Summary:
+ *  Decodes a sample from a flat JSON object whose values are numbers, true,
+ *  false, or strings without escapes, as written by encode_text().
+ *
+ * Parameters:
+ *  data - Encoded sample.
+ *  length - Length of the encoded sample.
+ *  sample - Filled with the decoded fields.
+ *
+ * Return:
+ *  bool: true if the input was decoded.
+ *
+ *******************************************************************************/
+static bool decode_json(const uint8_t *data, size_t length, sensor_sample_t *sample)
+{
+    const char *p = (const char *)data;
+    const char *end = p + length;
+    const char *key;
+    const char *value;
+    size_t key_len;
+    size_t value_len;
+
+    while ((p < end) && isspace((unsigned char)*p))
+    {
+        p++;
+    }
+
+    if ((p == end) || ('{' != *p++))
+    {
+        return false;
+    }
+
+    while (p < end)
+    {
+        while ((p < end) && isspace((unsigned char)*p))
+        {
+            p++;
+        }
+
+        if ((p < end) && ('}' == *p))
+        {
+            return true;
+        }
+
+        if ((p == end) || ('"' != *p++))
+        {
+            return false;
+        }
+
+        for (key = p; (p < end) && ('"' != *p); p++)
+        {
+        }
+        if (p == end)
+        {
+            return false;
+        }
+        key_len = (size_t)(p++ - key);
+
+        while ((p < end) && isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if ((p == end) || (':' != *p++))
+        {
+            return false;
+        }
+        while ((p < end) && isspace((unsigned char)*p))
+        {
+            p++;
+        }
+
+        if ((p < end) && ('"' == *p))
+        {
+            for (value = ++p; (p < end) && ('"' != *p); p++)
+            {
+            }
+            if (p == end)
+            {
+                return false;
+            }
+            value_len = (size_t)(p++ - value);
+        }
+        else
+        {
+            for (value = p; (p < end) && (',' != *p) && ('}' != *p) && !isspace((unsigned char)*p); p++)
+            {
+            }
+            value_len = (size_t)(p - value);
+        }
+
+        if (!set_text_field(sample, key, key_len, value, value_len))
+        {
+            return false;
+        }
+
+        while ((p < end) && isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if ((p < end) && (',' == *p))
+        {
+            p++;
+        }
+        else if ((p == end) || ('}' != *p))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: decode_form
+ *******************************************************************************
+ * Summary:
+ *  Decodes a sample from form fields as written by encode_text(). Values are
+ *  not percent-decoded.
+ *
+ * Parameters:
+ *  data - Encoded sample.
+ *  length - Length of the encoded sample.
+ *  sample - Filled with the decoded fields.
+ *
+ * Return:
+ *  bool: true if the input was decoded.
+ *
+ *******************************************************************************/
+static bool decode_form(const uint8_t *data, size_t length, sensor_sample_t *sample)
+{
+    const char *p = (const char *)data;
+    const char *end = p + length;
+    const char *key;
+    const char *value;
+    size_t key_len;
+
+    while (p < end)
+    {
+        for (key = p; (p < end) && ('=' != *p) && ('&' != *p); p++)
+        {
+        }
+        if ((p == end) || ('=' != *p))
+        {
+            return false;
+        }
+        key_len = (size_t)(p++ - key);
+
+        for (value = p; (p < end) && ('&' != *p); p++)
+        {
+        }
+
+        if (!set_text_field(sample, key, key_len, value, (size_t)(p - value)))
+        {
+            return false;
+        }
+
+        if (p < end)
+        {
+            p++;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: set_text_field
+ *******************************************************************************
+ * Summary:
+ *  Stores a field decoded from JSON or form text in a sample.
+ *
+ * Parameters:
+ *  sample - Sample to update.
+ *  key - Field name, not NUL-terminated.
+ *  key_len - Length of the field name.
+ *  value - Field value, not NUL-terminated.
+ *  value_len - Length of the field value.
+ *
+ * Return:
+ *  bool: false if the value is not valid for the field.
+ *
+ *******************************************************************************/
+static bool set_text_field(sensor_sample_t *sample, const char *key, size_t key_len,
+                           const char *value, size_t value_len)
+{
+    int64_t integer;
+    float number;
+
+    if (key_equals(key, key_len, "id"))
+    {
+        if (value_len >= sizeof(sample->device_id))
+        {
+            value_len = sizeof(sample->device_id) - 1u;
+        }
+        memcpy(sample->device_id, value, value_len);
+        sample->device_id[value_len] = '\0';
+        return true;
+    }
+
+    if (key_equals(key, key_len, "alarm"))
+    {
+        if (key_equals(value, value_len, "true") || key_equals(value, value_len, "1"))
+        {
+            sample->alarm = true;
+        }
+        else if (key_equals(value, value_len, "false") || key_equals(value, value_len, "0"))
+        {
+            sample->alarm = false;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    if (!parse_number(value, value_len, &integer, &number))
+    {
+        /* Unknown fields may hold anything. */
+        return !(key_equals(key, key_len, "seq") || key_equals(key, key_len, "t") ||
+                 key_equals(key, key_len, "bat") || key_equals(key, key_len, "temp") ||
+                 key_equals(key, key_len, "hum"));
+    }
+
+    if (key_equals(key, key_len, "temp"))
+    {
+        sample->temperature = number;
+    }
+    else if (key_equals(key, key_len, "hum"))
+    {
+        sample->humidity = number;
+    }
+    else if ((integer < 0) || (integer > (int64_t)UINT32_MAX))
+    {
+        return !(key_equals(key, key_len, "seq") || key_equals(key, key_len, "t") ||
+                 key_equals(key, key_len, "bat"));
+    }
+    else if (key_equals(key, key_len, "seq"))
+    {
+        sample->seq = (uint32_t)integer;
+    }
+    else if (key_equals(key, key_len, "t"))
+    {
+        sample->timestamp_ms = (uint32_t)integer;
+    }
+    else if (key_equals(key, key_len, "bat"))
+    {
+        sample->battery_mv = (uint16_t)integer;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_number
+ *******************************************************************************
+ * Summary:
+ *  Parses a decimal number with an optional sign and fraction.
+ *
+ * Parameters:
+ *  text - Number text, not NUL-terminated.
+ *  length - Length of the text.
+ *  integer - Filled with the integer part.
+ *  number - Filled with the value.
+ *
+ * Return:
+ *  bool: true if the whole text is a number.
+ *
+ *******************************************************************************/
+static bool parse_number(const char *text, size_t length, int64_t *integer, float *number)
+{
+    const char *end = text + length;
+    bool negative = false;
+    int64_t whole = 0;
+    float fraction = 0.0f;
+    float scale = 0.1f;
+
+    if ((text < end) && ('-' == *text))
+    {
+        negative = true;
+        text++;
+    }
+
+    if ((text == end) || !isdigit((unsigned char)*text))
+    {
+        return false;
+    }
+
+    for (; (text < end) && isdigit((unsigned char)*text); text++)
+    {
+        if (whole > (INT64_MAX / 10))
+        {
+            return false;
+        }
+        whole = (whole * 10) + (*text - '0');
+    }
+
+    if ((text < end) && ('.' == *text))
+    {
+        for (text++; (text < end) && isdigit((unsigned char)*text); text++)
+        {
+            fraction += (float)(*text - '0') * scale;
+            scale *= 0.1f;
+        }
+    }
+
+    if (text != end)
+    {
+        return false;
+    }
+
+    *integer = negative ? -whole : whole;
+    *number = negative ? -((float)whole + fraction) : ((float)whole + fraction);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: key_equals
+ *******************************************************************************
+ * Summary:
+ *  Compares a string that is not NUL-terminated with a NUL-terminated one.
+ *
+ *******************************************************************************/
+static bool key_equals(const char *key, size_t key_len, const char *name)
+{
+    return (strlen(name) == key_len) && (0 == memcmp(key, name, key_len));
+}
+
+/*******************************************************************************
+ * Function Name: format_centi
+ *******************************************************************************
+ * Summary:
+ *  Writes a float with two decimals without using the floating point support
+ *  of printf.
+ *
+ * Parameters:
+ *  text - Output string.
+ *  size - Size of the output string.
+ *  value - Value to write.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void format_centi(char *text, size_t size, float value)
+{
+    int32_t centi = (int32_t)((value * 100.0f) + ((value < 0.0f) ? -0.5f : 0.5f));
+    uint32_t magnitude = (centi < 0) ? (uint32_t)(-centi) : (uint32_t)centi;
+
+    snprintf(text, size, "%s%lu.%02lu", (centi < 0) ? "-" : "",
+             (unsigned long)(magnitude / 100u), (unsigned long)(magnitude % 100u));
+}
+
+/*******************************************************************************
+ * Function Name: simulate_sample
+ *******************************************************************************
+ * Summary:
+ *  Fills a sample with simulated sensor readings.
+ *
+ *******************************************************************************/
+static void simulate_sample(sensor_sample_t *sample, uint32_t seq)
+{
+    memset(sample, 0, sizeof(*sample));
+    sample->seq = seq;
+    sample->timestamp_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    sample->temperature = 21.37f + (float)(seq % 10u) * 0.25f;
+    sample->humidity = 45.1f;
+    sample->battery_mv = (uint16_t)(3700u - (seq % 100u));
+    sample->alarm = (0u == (seq % 16u));
+    strncpy(sample->device_id, "psoc6-node-01", sizeof(sample->device_id) - 1u);
+}
+
+/*******************************************************************************
+ * Function Name: handle_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the sample request. Decodes a CBOR response in place
+ *  and prints any other response as text.
+ *
+ * Parameters:
+ *  handle - HTTP client instance.
+ *  response - Response of the request.
+ *  arg - Filled with the status code of the response.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void handle_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    cy_http_client_header_t header;
+
+    *(uint16_t *)arg = response->status_code;
+
+    header.field = "Content-Type";
+    header.field_len = sizeof("Content-Type") - 1;
+    header.value = NULL;
+    header.value_len = 0;
+
+    printf("\n Response Status : %u\n", response->status_code);
+
+    if ((CY_RSLT_SUCCESS == cy_http_client_read_header(handle, response, &header, 1)) &&
+        (NULL != header.value) && media_type_equals(header.value, header.value_len, CBOR_CONTENT_TYPE))
+    {
+        printf(" Response Body (CBOR, %u bytes):\n", (unsigned int)response->body_len);
+        print_cbor_body(response->body, response->body_len);
+    }
+    else
+    {
+        printf(" Response Body   :\n %.*s\n", (int)response->body_len, response->body);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: media_type_equals
+ *******************************************************************************
+ * Summary:
+ *  Compares the media type of a Content-Type value, ignoring its parameters
+ *  and the case.
+ *
+ *******************************************************************************/
+static bool media_type_equals(const char *value, size_t length, const char *type)
+{
+    size_t index;
+
+    while ((length > 0) && (' ' == *value))
+    {
+        value++;
+        length--;
+    }
+
+    for (index = 0; '\0' != type[index]; index++)
+    {
+        if ((index == length) || (tolower((unsigned char)value[index]) != type[index]))
+        {
+            return false;
+        }
+    }
+
+    return (index == length) || (';' == value[index]) || (' ' == value[index]);
+}
+
+/*******************************************************************************
+ * Function Name: print_cbor_body
+ *******************************************************************************
+ * Summary:
+ *  Prints the scalar items of a CBOR body, one per line. Arrays, maps, and
+ *  tags are printed as their head, followed by their content.
+ *
+ * Parameters:
+ *  body - CBOR body.
+ *  length - Length of the body.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void print_cbor_body(const uint8_t *body, size_t length)
+{
+    cbor_decoder_t dec;
+    cbor_item_t item;
+    cbor_status_t status;
+    int64_t integer;
+
+    cbor_decoder_init(&dec, body, length);
+
+    while (CBOR_OK == (status = cbor_decode_next(&dec, &item)))
+    {
+        switch (item.type)
+        {
+            case CBOR_TYPE_UINT:
+            case CBOR_TYPE_NEGINT:
+                if (cbor_item_get_int(&item, &integer))
+                {
+                    printf("  %ld\n", (long)integer);
+                }
+                else
+                {
+                    printf("  <64-bit integer>\n");
+                }
+                break;
+
+            case CBOR_TYPE_TEXT:
+                printf("  \"%.*s\"\n", (int)item.value, (const char *)item.data);
+                break;
+
+            case CBOR_TYPE_BYTES:
+                printf("  <%lu bytes>\n", (unsigned long)item.value);
+                break;
+
+            case CBOR_TYPE_ARRAY:
+                printf("  [%lu]\n", (unsigned long)item.value);
+                break;
+
+            case CBOR_TYPE_MAP:
+                printf("  {%lu}\n", (unsigned long)item.value);
+                break;
+
+            case CBOR_TYPE_FLOAT:
+            {
+                char number[16];
+
+                format_centi(number, sizeof(number), item.number);
+                printf("  %s\n", number);
+                break;
+            }
+
+            case CBOR_TYPE_TRUE:
+            case CBOR_TYPE_FALSE:
+                printf("  %s\n", (CBOR_TYPE_TRUE == item.type) ? "true" : "false");
+                break;
+
+            default:
+                printf("  <simple %lu>\n", (unsigned long)item.value);
+                break;
+        }
+    }
+
+    if ((CBOR_NEED_MORE != status) || (dec.offset != length))
+    {
+        ERR_INFO(("Malformed CBOR at offset %u\n", (unsigned int)dec.offset));
+    }
+}
+
+/* [] END OF FILE */
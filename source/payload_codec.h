@@ -0,0 +1,112 @@
+/******************************************************************************
+* File Name: payload_codec.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the sensor payload encodings: CBOR, JSON, and form-urlencoded.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef PAYLOAD_CODEC_H_
+#define PAYLOAD_CODEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Resource the samples are posted to. */
+#define PAYLOAD_CODEC_PATH                       "/sensor"
+
+/* Response media types, in order of preference. */
+#define PAYLOAD_CODEC_ACCEPT                     "application/cbor, application/json;q=0.5"
+#define PAYLOAD_JSON_CONTENT_TYPE                "application/json"
+
+/* Size of the buffer an encoded sample is built in. */
+#define PAYLOAD_CODEC_BUFFER_SIZE                (256)
+
+/* Longest device identifier, including the terminating NUL. */
+#define PAYLOAD_DEVICE_ID_SIZE                   (16)
+
+/* Number of encodings and decodings timed per format by the benchmark. */
+#define PAYLOAD_CODEC_BENCH_ITERATIONS           (1000)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    PAYLOAD_FORMAT_CBOR,
+    PAYLOAD_FORMAT_JSON,
+    PAYLOAD_FORMAT_FORM,
+    PAYLOAD_FORMAT_COUNT,
+} payload_format_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* One sensor reading. All three formats encode it as a flat map with the keys
+ * "seq", "t", "temp", "hum", "bat", "alarm", and "id".
+ */
+typedef struct
+{
+    uint32_t seq;
+    uint32_t timestamp_ms;
+    float temperature;                       /* Degrees Celsius. */
+    float humidity;                          /* Percent relative humidity. */
+    uint16_t battery_mv;
+    bool alarm;
+    char device_id[PAYLOAD_DEVICE_ID_SIZE];
+} sensor_sample_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+const char *payload_content_type(payload_format_t format);
+size_t payload_encode(payload_format_t format, const sensor_sample_t *sample, uint8_t *buffer, size_t size);
+bool payload_decode(payload_format_t format, const uint8_t *data, size_t length, sensor_sample_t *sample);
+void payload_codec_benchmark(void);
+cy_rslt_t payload_codec_request(void);
+
+#endif /* PAYLOAD_CODEC_H_ */
+
+
+/* [] END OF FILE */
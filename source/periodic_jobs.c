@@ -0,0 +1,574 @@
+/******************************************************************************
+* File Name: periodic_jobs.c
+*
+* Description: This file contains the periodic jobs. A one-shot software
+* timer wakes the job task at the latest time the most urgent job may run,
+* given its slack, and every job due by then runs in the same window, one after
+* the other while the radio and the connection are warm. Between the windows
+* nothing of this module runs, so tickless idle can keep the system in deep
+* sleep until the next one.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <timers.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "wifi_power.h"
+#include "periodic_jobs.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef struct
+{
+    periodic_job_cb_t job;           /* NULL for a free slot. */
+    void *arg;
+    TickType_t period;
+    TickType_t slack;                /* Time the job may run after its due time. */
+    TickType_t due;
+} periodic_job_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static periodic_job_t jobs[PERIODIC_JOBS_MAX];
+
+/* Protects the jobs, the window timer, and the statistics. */
+static SemaphoreHandle_t jobs_mutex;
+
+/* Fires at the start of the next wake window. */
+static TimerHandle_t window_timer;
+
+static TaskHandle_t periodic_jobs_task_handle;
+
+static periodic_jobs_stats_t jobs_stats;
+static TickType_t stats_ticks;
+
+/* Counted by the system power management callback. */
+static volatile uint32_t cpu_wakeups;
+static uint32_t cpu_wakeups_base;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void periodic_jobs_task(void *arg);
+static void window_timer_callback(TimerHandle_t timer);
+static uint32_t take_due_jobs(periodic_job_t *due_jobs);
+static void schedule_window(void);
+static bool count_wakeup(cyhal_syspm_callback_state_t state, cyhal_syspm_callback_mode_t mode, void *arg);
+static void bench_job(void *arg);
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+
+/* Called after each exit of the CPU from sleep or deep sleep. */
+static cyhal_syspm_callback_data_t wakeup_callback_data =
+{
+    .callback = count_wakeup,
+    .states = (cyhal_syspm_callback_state_t)(CYHAL_SYSPM_CB_CPU_SLEEP | CYHAL_SYSPM_CB_CPU_DEEPSLEEP),
+    .ignore_modes = (cyhal_syspm_callback_mode_t)(CYHAL_SYSPM_CHECK_READY | CYHAL_SYSPM_CHECK_FAIL |
+                                                  CYHAL_SYSPM_BEFORE_TRANSITION),
+    .args = NULL,
+    .next = NULL,
+};
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the job task, its window timer, and its mutex, and starts
+ *  counting the wakeups of the CPU.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if jobs can be added, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t periodic_jobs_init(void)
+{
+    if (NULL != periodic_jobs_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    jobs_mutex = xSemaphoreCreateMutex();
+    window_timer = xTimerCreate("Job Window", 1, pdFALSE, NULL, window_timer_callback);
+
+    if ((NULL == jobs_mutex) || (NULL == window_timer))
+    {
+        ERR_INFO(("Failed to create the periodic job objects.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (pdPASS != xTaskCreate(periodic_jobs_task, "Periodic Jobs", PERIODIC_JOBS_TASK_STACK_SIZE, NULL,
+                              PERIODIC_JOBS_TASK_PRIORITY, &periodic_jobs_task_handle))
+    {
+        ERR_INFO(("Failed to create the periodic job task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    cyhal_syspm_register_callback(&wakeup_callback_data);
+    stats_ticks = xTaskGetTickCount();
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_add
+ *******************************************************************************
+ * Summary:
+ *  Adds a job that is due every period_ms, first one period from now. The
+ *  job may run up to slack_ms after its due time, so that it shares the wake
+ *  window of a job due later; it never runs before its due time. A larger
+ *  slack means fewer wakeups and later results.
+ *
+ * Parameters:
+ *  period_ms - Period of the job.
+ *  slack_ms - Delay the job tolerates.
+ *  job - Work of the job.
+ *  arg - Argument passed to the job.
+ *  id - Receives the identifier for periodic_jobs_remove(). Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the job is added, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t periodic_jobs_add(uint32_t period_ms, uint32_t slack_ms, periodic_job_cb_t job, void *arg,
+                            uint32_t *id)
+{
+    cy_rslt_t result = CY_RSLT_TYPE_ERROR;
+
+    if ((NULL == periodic_jobs_task_handle) || (NULL == job) || (0u == pdMS_TO_TICKS(period_ms)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+
+    for (uint32_t i = 0; i < PERIODIC_JOBS_MAX; i++)
+    {
+        if (NULL == jobs[i].job)
+        {
+            jobs[i].job = job;
+            jobs[i].arg = arg;
+            jobs[i].period = pdMS_TO_TICKS(period_ms);
+            jobs[i].slack = pdMS_TO_TICKS(slack_ms);
+            jobs[i].due = xTaskGetTickCount() + jobs[i].period;
+
+            if (NULL != id)
+            {
+                *id = i;
+            }
+
+            schedule_window();
+            result = CY_RSLT_SUCCESS;
+            break;
+        }
+    }
+
+    xSemaphoreGive(jobs_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_remove
+ *******************************************************************************
+ * Summary:
+ *  Removes a job. A run of the job that has started completes.
+ *
+ * Parameters:
+ *  id - Identifier from periodic_jobs_add().
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void periodic_jobs_remove(uint32_t id)
+{
+    if ((NULL == periodic_jobs_task_handle) || (id >= PERIODIC_JOBS_MAX))
+    {
+        return;
+    }
+
+    xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+    jobs[id].job = NULL;
+    schedule_window();
+    xSemaphoreGive(jobs_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns the wake windows, the time they took, and the wakeups of the CPU
+ *  from any source.
+ *
+ * Parameters:
+ *  stats - Filled with the counters.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void periodic_jobs_get_stats(periodic_jobs_stats_t *stats)
+{
+    if (NULL == periodic_jobs_task_handle)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+    *stats = jobs_stats;
+    stats->cpu_wakeups = cpu_wakeups - cpu_wakeups_base;
+    stats->elapsed_ms = TICKS_TO_MS(xTaskGetTickCount() - stats_ticks);
+    xSemaphoreGive(jobs_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_reset_stats
+ *******************************************************************************
+ * Summary:
+ *  Clears the counters.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void periodic_jobs_reset_stats(void)
+{
+    if (NULL == periodic_jobs_task_handle)
+    {
+        return;
+    }
+
+    xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+    memset(&jobs_stats, 0, sizeof(jobs_stats));
+    cpu_wakeups_base = cpu_wakeups;
+    stats_ticks = xTaskGetTickCount();
+    xSemaphoreGive(jobs_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Runs GET jobs with the periods of PERIODIC_JOBS_BENCH_PERIODS_MS for
+ *  PERIODIC_JOBS_BENCH_DURATION_S, first without slack, each job waking the
+ *  system on its own, then with PERIODIC_JOBS_BENCH_SLACK_MS. Prints the
+ *  wake windows, the CPU wakeups, and the active time per hour, and the
+ *  longest delay of a job.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void periodic_jobs_benchmark(void)
+{
+    static const uint32_t periods[] = PERIODIC_JOBS_BENCH_PERIODS_MS;
+    static https_request_t request;
+    uint32_t ids[sizeof(periods) / sizeof(periods[0])];
+    uint32_t count;
+    uint32_t slack_ms;
+    uint32_t active_ms_per_hour;
+    periodic_jobs_stats_t stats;
+
+    if (NULL == periodic_jobs_task_handle)
+    {
+        ERR_INFO(("The periodic jobs are not running.\n"));
+        return;
+    }
+
+    memset(&request, 0, sizeof(request));
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.path = PERIODIC_JOBS_BENCH_PATH;
+    request.response_cb = ignore_response;
+    request.quiet = true;
+
+    APP_INFO(("%u GET jobs, %u s per run\n", (unsigned int)(sizeof(periods) / sizeof(periods[0])),
+              PERIODIC_JOBS_BENCH_DURATION_S));
+    printf("\n  %-9s %10s %11s %12s %6s %13s\n", "slack ms", "windows/h", "CPU wakes/h", "active s/h", "jobs",
+           "max delay ms");
+
+    for (uint32_t run = 0; run < 2u; run++)
+    {
+        slack_ms = (1u == run) ? PERIODIC_JOBS_BENCH_SLACK_MS : 0u;
+
+        periodic_jobs_reset_stats();
+        for (count = 0; count < (sizeof(periods) / sizeof(periods[0])); count++)
+        {
+            if (CY_RSLT_SUCCESS != periodic_jobs_add(periods[count], slack_ms, bench_job, &request, &ids[count]))
+            {
+                break;
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(PERIODIC_JOBS_BENCH_DURATION_S * 1000u));
+
+        while (count > 0u)
+        {
+            periodic_jobs_remove(ids[--count]);
+        }
+        periodic_jobs_get_stats(&stats);
+
+        active_ms_per_hour = (uint32_t)(((uint64_t)stats.active_ms * 3600000u) / stats.elapsed_ms);
+        printf("  %-9lu %10lu %11lu %8lu.%03lu %6lu %13lu\n", (unsigned long)slack_ms,
+               (unsigned long)(((uint64_t)stats.windows * 3600000u) / stats.elapsed_ms),
+               (unsigned long)(((uint64_t)stats.cpu_wakeups * 3600000u) / stats.elapsed_ms),
+               (unsigned long)(active_ms_per_hour / 1000u), (unsigned long)(active_ms_per_hour % 1000u),
+               (unsigned long)stats.jobs_run, (unsigned long)stats.max_delay_ms);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: periodic_jobs_task
+ *******************************************************************************
+ * Summary:
+ *  Runs the jobs that are due when the window timer fires. Jobs that become
+ *  due while the window runs join it. The radio stays active from the first
+ *  job to the last.
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void periodic_jobs_task(void *arg)
+{
+    periodic_job_t due_jobs[PERIODIC_JOBS_MAX];
+    TickType_t start_ticks;
+    uint32_t count;
+    uint32_t run;
+
+    (void)arg;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        start_ticks = xTaskGetTickCount();
+        run = 0;
+
+        while (0u != (count = take_due_jobs(due_jobs)))
+        {
+            if (0u == run)
+            {
+                wifi_power_begin();
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                due_jobs[i].job(due_jobs[i].arg);
+            }
+            run += count;
+        }
+
+        if (run > 0u)
+        {
+            wifi_power_end();
+        }
+
+        xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+        if (run > 0u)
+        {
+            jobs_stats.windows++;
+            jobs_stats.jobs_run += run;
+            jobs_stats.active_ms += TICKS_TO_MS(xTaskGetTickCount() - start_ticks);
+        }
+        schedule_window();
+        xSemaphoreGive(jobs_mutex);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: window_timer_callback
+ *******************************************************************************
+ * Summary:
+ *  Starts a wake window. Runs in the timer task, so the jobs are left to the
+ *  job task.
+ *
+ *******************************************************************************/
+static void window_timer_callback(TimerHandle_t timer)
+{
+    (void)timer;
+
+    xTaskNotifyGive(periodic_jobs_task_handle);
+}
+
+/*******************************************************************************
+ * Function Name: take_due_jobs
+ *******************************************************************************
+ * Summary:
+ *  Copies the jobs that are due and moves them to their next period. A job
+ *  that fell more than a period behind skips the periods it missed.
+ *
+ *******************************************************************************/
+static uint32_t take_due_jobs(periodic_job_t *due_jobs)
+{
+    TickType_t now;
+    uint32_t delay_ms;
+    uint32_t count = 0;
+
+    xSemaphoreTake(jobs_mutex, portMAX_DELAY);
+    now = xTaskGetTickCount();
+
+    for (uint32_t i = 0; i < PERIODIC_JOBS_MAX; i++)
+    {
+        if ((NULL == jobs[i].job) || ((int32_t)(now - jobs[i].due) < 0))
+        {
+            continue;
+        }
+
+        due_jobs[count++] = jobs[i];
+
+        delay_ms = TICKS_TO_MS(now - jobs[i].due);
+        jobs_stats.max_delay_ms = (delay_ms > jobs_stats.max_delay_ms) ? delay_ms : jobs_stats.max_delay_ms;
+
+        jobs[i].due += jobs[i].period;
+        if ((int32_t)(now - jobs[i].due) >= 0)
+        {
+            jobs[i].due = now + jobs[i].period;
+        }
+    }
+
+    xSemaphoreGive(jobs_mutex);
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: schedule_window
+ *******************************************************************************
+ * Summary:
+ *  Sets the window timer to the earliest time a job must run, its due time
+ *  plus its slack, or stops it when there is no job. Called with the jobs
+ *  mutex held.
+ *
+ *******************************************************************************/
+static void schedule_window(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    int32_t remaining;
+    int32_t earliest = INT32_MAX;
+
+    for (uint32_t i = 0; i < PERIODIC_JOBS_MAX; i++)
+    {
+        if (NULL != jobs[i].job)
+        {
+            remaining = (int32_t)(jobs[i].due + jobs[i].slack - now);
+            earliest = (remaining < earliest) ? remaining : earliest;
+        }
+    }
+
+    if (INT32_MAX == earliest)
+    {
+        (void)xTimerStop(window_timer, 0);
+    }
+    else
+    {
+        (void)xTimerChangePeriod(window_timer, (earliest > 0) ? (TickType_t)earliest : 1u, 0);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: count_wakeup
+ *******************************************************************************
+ * Summary:
+ *  Counts an exit of the CPU from sleep or deep sleep.
+ *
+ *******************************************************************************/
+static bool count_wakeup(cyhal_syspm_callback_state_t state, cyhal_syspm_callback_mode_t mode, void *arg)
+{
+    (void)state;
+    (void)mode;
+    (void)arg;
+
+    cpu_wakeups++;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: bench_job
+ *******************************************************************************
+ * Summary:
+ *  Job of the benchmark: sends its request.
+ *
+ *******************************************************************************/
+static void bench_job(void *arg)
+{
+    (void)https_send_request((const https_request_t *)arg);
+}
+
+/*******************************************************************************
+ * Function Name: ignore_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the benchmark requests.
+ *
+ *******************************************************************************/
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+}
+
+/* [] END OF FILE */
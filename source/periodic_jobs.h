@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name: periodic_jobs.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the periodic jobs, which run the periodic network work of the
+* application in shared wake windows so the system can stay in deep sleep
+* between them.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef PERIODIC_JOBS_H_
+#define PERIODIC_JOBS_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define PERIODIC_JOBS_MAX                        (8)
+
+/* Job task parameters. The jobs run in this task, one after the other. */
+#define PERIODIC_JOBS_TASK_STACK_SIZE            (2 * 1024)
+#define PERIODIC_JOBS_TASK_PRIORITY              (1)
+
+/* "Periodic jobs" menu option: GET jobs of these periods run for
+ * PERIODIC_JOBS_BENCH_DURATION_S, without slack and then with
+ * PERIODIC_JOBS_BENCH_SLACK_MS.
+ */
+#define PERIODIC_JOBS_BENCH_PATH                 "/"
+#define PERIODIC_JOBS_BENCH_PERIODS_MS           { 10000u, 15000u, 25000u, 40000u }
+#define PERIODIC_JOBS_BENCH_SLACK_MS             (8000u)
+#define PERIODIC_JOBS_BENCH_DURATION_S           (120u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Runs the work of a job. Called from the job task, so it may block. */
+typedef void (*periodic_job_cb_t)(void *arg);
+
+/* Counters since the last periodic_jobs_reset_stats(). */
+typedef struct
+{
+    uint32_t windows;            /* Wake windows in which jobs ran. */
+    uint32_t jobs_run;
+    uint32_t active_ms;          /* Time from the start to the end of the windows. */
+    uint32_t max_delay_ms;       /* Longest time a job waited past its due time. */
+    uint32_t cpu_wakeups;        /* Exits of the CPU from sleep and deep sleep. */
+    uint32_t elapsed_ms;
+} periodic_jobs_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t periodic_jobs_init(void);
+cy_rslt_t periodic_jobs_add(uint32_t period_ms, uint32_t slack_ms, periodic_job_cb_t job, void *arg,
+                            uint32_t *id);
+void periodic_jobs_remove(uint32_t id);
+void periodic_jobs_get_stats(periodic_jobs_stats_t *stats);
+void periodic_jobs_reset_stats(void);
+void periodic_jobs_benchmark(void);
+
+#endif /* PERIODIC_JOBS_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1132 @@
+/******************************************************************************
+* File Name: request_scheduler.c
+*
+* Description: This file contains the request scheduler. A task sends the
+* HTTPS requests of two lanes, urgent before bulk, taking a token from the
+* bucket of each request's destination. Bulk transfers are sent one chunk at
+* a time, so an urgent request waits for at most one chunk.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "telemetry_batch.h"
+#include "xorshift.h"
+#include "request_scheduler.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Tokens are counted in thousandths, so that a bucket refills every ms. */
+#define TOKEN_UNIT                       (1000u)
+
+#define NO_WAIT                          (0xFFFFFFFFu)
+
+/* Chunk sizes compared by the simulation, the first being unchunked. */
+#define SIM_CHUNK_SIZES                  { REQUEST_SCHEDULER_SIM_BULK_SIZE, 16384u, 4096u, 1024u }
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* A queued request or bulk transfer. The request of a transfer is that of
+ * its next chunk.
+ */
+typedef struct
+{
+    https_request_t request;
+    request_chunk_cb_t next_chunk;   /* NULL for a single request. */
+    uint32_t chunk;
+    request_job_cb_t job;            /* Run instead of sending the request, NULL to send it. */
+    void *job_arg;
+    request_done_cb_t done;
+    void *arg;
+    uint32_t submitted_ms;
+} scheduler_entry_t;
+
+/* Rate limit of a destination. */
+typedef struct
+{
+    char destination[REQUEST_SCHEDULER_DESTINATION_LENGTH];
+    uint32_t rate;               /* Requests per second, 0 for no limit. */
+    uint32_t burst;
+    uint32_t tokens;             /* In TOKEN_UNIT per request. */
+    uint32_t last_ms;
+} token_bucket_t;
+
+/* Lanes and buckets, used by the scheduler task and by the simulation on
+ * its virtual clock. Entries are kept in submission order.
+ */
+typedef struct
+{
+    scheduler_entry_t lanes[REQUEST_LANE_COUNT][REQUEST_SCHEDULER_LANE_DEPTH];
+    uint32_t lane_length[REQUEST_LANE_COUNT];
+    token_bucket_t buckets[REQUEST_SCHEDULER_MAX_DESTINATIONS];
+    uint32_t bucket_count;
+    request_scheduler_stats_t stats;
+} scheduler_t;
+
+/* Transfer waited for by request_scheduler_run(). */
+typedef struct
+{
+    SemaphoreHandle_t done;
+    cy_rslt_t result;
+} job_wait_t;
+
+/* Body of the bulk transfer of the simulation and the benchmark. */
+typedef struct
+{
+    const uint8_t *body;         /* NULL in the simulation. */
+    uint32_t size;
+    uint32_t chunk_size;
+} bulk_source_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static scheduler_t scheduler;
+static SemaphoreHandle_t scheduler_mutex;
+static TaskHandle_t scheduler_task_handle;
+
+/* The simulation runs on its own scheduler, so the task is not disturbed. */
+static scheduler_t sim_scheduler;
+
+/* Results of the simulation and the benchmark. */
+static uint32_t urgent_latency[REQUEST_SCHEDULER_BENCH_MAX_URGENT];
+static volatile uint32_t urgent_completed;
+static volatile uint32_t urgent_failed;
+static volatile bool bulk_completed;
+static uint32_t bulk_latency;
+static cy_rslt_t bulk_result;
+static SemaphoreHandle_t bench_semaphore;
+static uint32_t random_state = 0x2545F491u;
+
+/* Body of the benchmark upload, kept in flash. */
+static const uint8_t bench_body[REQUEST_SCHEDULER_BENCH_BULK_SIZE] = { 0 };
+static const char bench_alarm[] = "{\"alarm\":\"over-temperature\",\"sensor\":3}";
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void scheduler_task(void *arg);
+static cy_rslt_t add_entry(scheduler_t *state, request_lane_t lane, const scheduler_entry_t *entry);
+static scheduler_entry_t *select_entry(scheduler_t *state, uint32_t now_ms, uint32_t *lane,
+                                       uint32_t *index, uint32_t *wait_ms);
+static bool finish_entry(scheduler_t *state, uint32_t lane, uint32_t index, cy_rslt_t result,
+                         scheduler_entry_t *finished);
+static token_bucket_t *find_bucket(scheduler_t *state, const char *path, uint32_t now_ms);
+static uint32_t bucket_wait(token_bucket_t *bucket, uint32_t now_ms);
+static uint32_t now_ms(void);
+static uint32_t next_interval(uint32_t mean_ms);
+static void simulate(uint32_t chunk_size);
+static bool bulk_next_chunk(uint32_t chunk, https_request_t *request, void *arg);
+static void bulk_done(cy_rslt_t result, uint32_t latency_ms, void *arg);
+static void job_done(cy_rslt_t result, uint32_t latency_ms, void *arg);
+static void urgent_done(cy_rslt_t result, uint32_t latency_ms, void *arg);
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+static void print_results(uint32_t chunk_size, uint32_t bulk_size, uint32_t preemptions);
+
+/*******************************************************************************
+ * Function Name: request_scheduler_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the scheduler task and its mutex.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the scheduler is ready, otherwise,
+ *  it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_init(void)
+{
+    if (NULL != scheduler_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    scheduler_mutex = xSemaphoreCreateMutex();
+    if (NULL == scheduler_mutex)
+    {
+        ERR_INFO(("Failed to create the request scheduler mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (pdPASS != xTaskCreate(scheduler_task, "Request Scheduler", REQUEST_SCHEDULER_TASK_STACK_SIZE,
+                              NULL, REQUEST_SCHEDULER_TASK_PRIORITY, &scheduler_task_handle))
+    {
+        ERR_INFO(("Failed to create the request scheduler task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_set_limit
+ *******************************************************************************
+ * Summary:
+ *  Sets the rate limit of a destination. The bucket starts full.
+ *
+ * Parameters:
+ *  destination - First segment of the request paths, for example "/upload".
+ *  rate - Requests per second, 0 for no limit.
+ *  burst - Requests sent at once after a quiet period, at least 1.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the limit is set, otherwise,
+ *  CY_RSLT_TYPE_ERROR if all the buckets are taken by other destinations.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_set_limit(const char *destination, uint32_t rate, uint32_t burst)
+{
+    token_bucket_t *bucket;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+
+    bucket = find_bucket(&scheduler, destination, now_ms());
+    if (0 != strncmp(bucket->destination, destination, sizeof(bucket->destination)))
+    {
+        ERR_INFO(("No token bucket left for %s.\n", destination));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+    else
+    {
+        bucket->rate = rate;
+        bucket->burst = (0u == burst) ? 1u : burst;
+        bucket->tokens = bucket->burst * TOKEN_UNIT;
+    }
+
+    xSemaphoreGive(scheduler_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_submit
+ *******************************************************************************
+ * Summary:
+ *  Queues a request in a lane. The request is copied, but its path, body,
+ *  and other pointers must stay valid until the done callback.
+ *
+ * Parameters:
+ *  request - Request to send.
+ *  lane - Lane of the request.
+ *  done - Called from the scheduler task when the request is complete. Can
+ *  be NULL.
+ *  arg - Argument passed to the done callback.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the request is queued, otherwise,
+ *  CY_RSLT_TYPE_ERROR if the lane is full.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_submit(const https_request_t *request, request_lane_t lane,
+                                   request_done_cb_t done, void *arg)
+{
+    scheduler_entry_t entry;
+    cy_rslt_t result;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.request = *request;
+    entry.done = done;
+    entry.arg = arg;
+
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+    entry.submitted_ms = now_ms();
+    result = add_entry(&scheduler, lane, &entry);
+    xSemaphoreGive(scheduler_mutex);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        xTaskNotifyGive(scheduler_task_handle);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_submit_bulk
+ *******************************************************************************
+ * Summary:
+ *  Queues a bulk transfer in the bulk lane. Its chunks are requested from
+ *  the callback one at a time, and urgent requests are sent between them.
+ *
+ * Parameters:
+ *  next_chunk - Fills the request of each chunk.
+ *  done - Called from the scheduler task when the transfer is complete. Can
+ *  be NULL.
+ *  arg - Argument passed to both callbacks.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the transfer is queued or has no
+ *  chunks, otherwise, CY_RSLT_TYPE_ERROR if the bulk lane is full.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_submit_bulk(request_chunk_cb_t next_chunk, request_done_cb_t done, void *arg)
+{
+    scheduler_entry_t entry;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    bool empty;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.next_chunk = next_chunk;
+    entry.done = done;
+    entry.arg = arg;
+
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+    entry.submitted_ms = now_ms();
+    empty = !next_chunk(0, &entry.request, arg);
+    if (!empty)
+    {
+        result = add_entry(&scheduler, REQUEST_LANE_BULK, &entry);
+    }
+    xSemaphoreGive(scheduler_mutex);
+
+    if (empty)
+    {
+        if (NULL != done)
+        {
+            done(CY_RSLT_SUCCESS, 0, arg);
+        }
+    }
+    else if (CY_RSLT_SUCCESS == result)
+    {
+        xTaskNotifyGive(scheduler_task_handle);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_run
+ *******************************************************************************
+ * Summary:
+ *  Queues a transfer in a lane and waits until the scheduler task has run
+ *  it, so that producers which drive their own connection take their turn
+ *  like the queued requests: a bulk transfer waits for the urgent requests
+ *  and is counted against the rate limit of its destination. Must not be
+ *  called from the scheduler task. Before request_scheduler_init() the
+ *  transfer is run by the caller.
+ *
+ * Parameters:
+ *  path - Resource path of the transfer, which selects its token bucket.
+ *  lane - Lane of the transfer.
+ *  job - Runs the transfer.
+ *  arg - Argument passed to the job.
+ *
+ * Return:
+ *  cy_rslt_t: Returns the result of the job, otherwise, CY_RSLT_TYPE_ERROR
+ *  if the lane is full.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_run(const char *path, request_lane_t lane, request_job_cb_t job, void *arg)
+{
+    scheduler_entry_t entry;
+    job_wait_t wait;
+    cy_rslt_t result;
+
+    if (NULL == scheduler_task_handle)
+    {
+        return job(arg);
+    }
+
+    wait.done = xSemaphoreCreateBinary();
+    if (NULL == wait.done)
+    {
+        ERR_INFO(("Failed to create the request scheduler semaphore.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.request.path = path;
+    entry.job = job;
+    entry.job_arg = arg;
+    entry.done = job_done;
+    entry.arg = &wait;
+
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+    entry.submitted_ms = now_ms();
+    result = add_entry(&scheduler, lane, &entry);
+    xSemaphoreGive(scheduler_mutex);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        xTaskNotifyGive(scheduler_task_handle);
+        (void)xSemaphoreTake(wait.done, portMAX_DELAY);
+        result = wait.result;
+    }
+
+    vSemaphoreDelete(wait.done);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_post
+ *******************************************************************************
+ * Summary:
+ *  Queues a transfer in a lane without waiting for it, for work that must
+ *  not run in the calling task, such as a timer callback. The scheduler
+ *  mutex is only held to add the entry.
+ *
+ * Parameters:
+ *  path - Resource path of the transfer, which selects its token bucket, or
+ *  NULL for work that sends no request and is not rate limited.
+ *  lane - Lane of the transfer.
+ *  job - Runs the transfer in the scheduler task.
+ *  arg - Argument passed to the job.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the transfer is queued, otherwise,
+ *  CY_RSLT_TYPE_ERROR if the lane is full or the scheduler is not running.
+ *
+ *******************************************************************************/
+cy_rslt_t request_scheduler_post(const char *path, request_lane_t lane, request_job_cb_t job, void *arg)
+{
+    scheduler_entry_t entry;
+    cy_rslt_t result;
+
+    if (NULL == scheduler_task_handle)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.request.path = path;
+    entry.job = job;
+    entry.job_arg = arg;
+
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+    entry.submitted_ms = now_ms();
+    result = add_entry(&scheduler, lane, &entry);
+    xSemaphoreGive(scheduler_mutex);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        xTaskNotifyGive(scheduler_task_handle);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns a copy of the scheduler statistics.
+ *
+ * Parameters:
+ *  stats - Filled with the statistics.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void request_scheduler_get_stats(request_scheduler_stats_t *stats)
+{
+    xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+    *stats = scheduler.stats;
+    xSemaphoreGive(scheduler_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_simulate
+ *******************************************************************************
+ * Summary:
+ *  Runs the scheduling of a REQUEST_SCHEDULER_SIM_BULK_SIZE byte upload on
+ *  a simulated link, with urgent alarms arriving at random intervals
+ *  around REQUEST_SCHEDULER_BENCH_INTERVAL_MS while it saturates the link,
+ *  and prints the latency percentiles of the alarms for several chunk
+ *  sizes. Both destinations have the default rate limit.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void request_scheduler_simulate(void)
+{
+    static const uint32_t chunk_sizes[] = SIM_CHUNK_SIZES;
+
+    APP_INFO(("Simulated %lu kbit/s link with %lu ms round trips, %lu byte upload, %lu requests/s limit\n",
+              (unsigned long)REQUEST_SCHEDULER_SIM_LINK_KBPS, (unsigned long)REQUEST_SCHEDULER_SIM_RTT_MS,
+              (unsigned long)REQUEST_SCHEDULER_SIM_BULK_SIZE, (unsigned long)REQUEST_SCHEDULER_DEFAULT_RATE));
+    printf("\n  %8s %8s %8s %7s %6s %6s %6s %6s %8s %9s\n", "chunk B", "bulk ms", "bulk kB/s",
+           "alarms", "p50", "p90", "p99", "max", "preempt", "throttled");
+
+    for (uint32_t i = 0; i < (sizeof(chunk_sizes) / sizeof(chunk_sizes[0])); i++)
+    {
+        simulate(chunk_sizes[i]);
+        print_results(chunk_sizes[i], REQUEST_SCHEDULER_SIM_BULK_SIZE, sim_scheduler.stats.preemptions);
+        printf("%10lu\n", (unsigned long)sim_scheduler.stats.throttled);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: request_scheduler_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Posts a REQUEST_SCHEDULER_BENCH_BULK_SIZE byte upload through the bulk
+ *  lane, first in one request and then in REQUEST_SCHEDULER_BENCH_CHUNK_SIZE
+ *  chunks. While it is sent, urgent alarms are submitted at random
+ *  intervals around REQUEST_SCHEDULER_BENCH_INTERVAL_MS. Prints the latency
+ *  percentiles of the alarms, from submission to response, and the time of
+ *  the upload.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void request_scheduler_benchmark(void)
+{
+    static const uint32_t chunk_sizes[] = { REQUEST_SCHEDULER_BENCH_BULK_SIZE, REQUEST_SCHEDULER_BENCH_CHUNK_SIZE };
+    static bulk_source_t source;
+    https_request_t alarm = {0};
+    request_scheduler_stats_t before;
+    request_scheduler_stats_t after;
+    uint32_t submitted;
+    cy_rslt_t result;
+
+    alarm.method = CY_HTTP_CLIENT_METHOD_POST;
+    alarm.path = REQUEST_SCHEDULER_BENCH_URGENT_PATH;
+    alarm.content_type = "application/json";
+    alarm.body = (const uint8_t *)bench_alarm;
+    alarm.body_len = sizeof(bench_alarm) - 1u;
+    alarm.response_cb = ignore_response;
+    alarm.quiet = true;
+
+    bench_semaphore = xSemaphoreCreateCounting(REQUEST_SCHEDULER_BENCH_MAX_URGENT, 0);
+    if (NULL == bench_semaphore)
+    {
+        ERR_INFO(("Failed to create the benchmark semaphore.\n"));
+        return;
+    }
+
+    APP_INFO(("%lu byte upload to %s with alarms to %s\n", (unsigned long)REQUEST_SCHEDULER_BENCH_BULK_SIZE,
+              REQUEST_SCHEDULER_BENCH_BULK_PATH, REQUEST_SCHEDULER_BENCH_URGENT_PATH));
+    printf("\n  %8s %8s %8s %7s %6s %6s %6s %6s %8s\n", "chunk B", "bulk ms", "bulk kB/s",
+           "alarms", "p50", "p90", "p99", "max", "preempt");
+
+    for (uint32_t i = 0; i < (sizeof(chunk_sizes) / sizeof(chunk_sizes[0])); i++)
+    {
+        source.body = bench_body;
+        source.size = REQUEST_SCHEDULER_BENCH_BULK_SIZE;
+        source.chunk_size = chunk_sizes[i];
+        urgent_completed = 0;
+        urgent_failed = 0;
+        bulk_completed = false;
+        submitted = 0;
+        request_scheduler_get_stats(&before);
+
+        result = request_scheduler_submit_bulk(bulk_next_chunk, bulk_done, &source);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("The bulk lane is full.\n"));
+            break;
+        }
+
+        while (!bulk_completed && (submitted < REQUEST_SCHEDULER_BENCH_MAX_URGENT))
+        {
+            vTaskDelay(pdMS_TO_TICKS(next_interval(REQUEST_SCHEDULER_BENCH_INTERVAL_MS)));
+            if (!bulk_completed &&
+                (CY_RSLT_SUCCESS == request_scheduler_submit(&alarm, REQUEST_LANE_URGENT, urgent_done, NULL)))
+            {
+                submitted++;
+            }
+        }
+
+        for (uint32_t done = 0; done < submitted; done++)
+        {
+            (void)xSemaphoreTake(bench_semaphore, portMAX_DELAY);
+        }
+        while (!bulk_completed)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        request_scheduler_get_stats(&after);
+        print_results(chunk_sizes[i], REQUEST_SCHEDULER_BENCH_BULK_SIZE, after.preemptions - before.preemptions);
+        printf("\n");
+
+        if ((CY_RSLT_SUCCESS != bulk_result) || (0u != urgent_failed))
+        {
+            ERR_INFO(("The upload returned 0x%08lx, %lu alarms failed.\n", (unsigned long)bulk_result,
+                      (unsigned long)urgent_failed));
+        }
+    }
+
+    vSemaphoreDelete(bench_semaphore);
+    bench_semaphore = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: scheduler_task
+ *******************************************************************************
+ * Summary:
+ *  Sends the selected request, one at a time, and sleeps until a request is
+ *  submitted or a bucket has a token again.
+ *
+ *******************************************************************************/
+static void scheduler_task(void *arg)
+{
+    scheduler_entry_t *entry;
+    scheduler_entry_t finished;
+    https_request_t request;
+    request_job_cb_t job = NULL;
+    void *job_arg = NULL;
+    cy_rslt_t result;
+    uint32_t lane;
+    uint32_t index;
+    uint32_t wait_ms;
+    bool complete;
+
+    (void)arg;
+
+    for (;;)
+    {
+        xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+        entry = select_entry(&scheduler, now_ms(), &lane, &index, &wait_ms);
+        if (NULL != entry)
+        {
+            request = entry->request;
+            job = entry->job;
+            job_arg = entry->job_arg;
+        }
+        xSemaphoreGive(scheduler_mutex);
+
+        if (NULL == entry)
+        {
+            (void)ulTaskNotifyTake(pdTRUE, (NO_WAIT == wait_ms) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms));
+            continue;
+        }
+
+        result = (NULL != job) ? job(job_arg) : https_send_request(&request);
+
+        /* Only this task removes entries, so the index is still valid. */
+        xSemaphoreTake(scheduler_mutex, portMAX_DELAY);
+        complete = finish_entry(&scheduler, lane, index, result, &finished);
+        xSemaphoreGive(scheduler_mutex);
+
+        if (complete && (NULL != finished.done))
+        {
+            finished.done(result, now_ms() - finished.submitted_ms, finished.arg);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: add_entry
+ *******************************************************************************
+ * Summary:
+ *  Appends an entry to a lane.
+ *
+ *******************************************************************************/
+static cy_rslt_t add_entry(scheduler_t *state, request_lane_t lane, const scheduler_entry_t *entry)
+{
+    if ((lane >= REQUEST_LANE_COUNT) || (state->lane_length[lane] >= REQUEST_SCHEDULER_LANE_DEPTH))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    state->lanes[lane][state->lane_length[lane]++] = *entry;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: select_entry
+ *******************************************************************************
+ * Summary:
+ *  Selects the next request: the first urgent one whose destination has a
+ *  token, otherwise the first bulk one. A request whose destination is out
+ *  of tokens does not hold back those of other destinations. Takes the
+ *  token of the selected request.
+ *
+ * Return:
+ *  scheduler_entry_t*: The entry to send, or NULL with wait_ms set to the
+ *  time until a token is available, NO_WAIT if the lanes are empty.
+ *
+ *******************************************************************************/
+static scheduler_entry_t *select_entry(scheduler_t *state, uint32_t now_ms, uint32_t *lane,
+                                       uint32_t *index, uint32_t *wait_ms)
+{
+    token_bucket_t *bucket;
+    uint32_t wait;
+
+    *wait_ms = NO_WAIT;
+
+    for (uint32_t l = 0; l < REQUEST_LANE_COUNT; l++)
+    {
+        for (uint32_t i = 0; i < state->lane_length[l]; i++)
+        {
+            /* Posted work without a path sends no request. */
+            bucket = (NULL != state->lanes[l][i].request.path) ?
+                     find_bucket(state, state->lanes[l][i].request.path, now_ms) : NULL;
+            wait = (NULL != bucket) ? bucket_wait(bucket, now_ms) : 0u;
+            if (0u != wait)
+            {
+                *wait_ms = (wait < *wait_ms) ? wait : *wait_ms;
+                continue;
+            }
+
+            if ((NULL != bucket) && (0u != bucket->rate))
+            {
+                bucket->tokens -= TOKEN_UNIT;
+            }
+
+            if ((REQUEST_LANE_URGENT == l) && (0u != state->lane_length[REQUEST_LANE_BULK]) &&
+                (0u != state->lanes[REQUEST_LANE_BULK][0].chunk))
+            {
+                state->stats.preemptions++;
+            }
+
+            *lane = l;
+            *index = i;
+            if (NULL != bucket)
+            {
+                state->stats.requests[l]++;
+            }
+            return &state->lanes[l][i];
+        }
+    }
+
+    if (NO_WAIT != *wait_ms)
+    {
+        state->stats.throttled++;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: finish_entry
+ *******************************************************************************
+ * Summary:
+ *  Advances a bulk transfer to its next chunk after a successful chunk,
+ *  otherwise removes the entry from its lane.
+ *
+ * Return:
+ *  bool: true if the entry is complete and was copied to finished.
+ *
+ *******************************************************************************/
+static bool finish_entry(scheduler_t *state, uint32_t lane, uint32_t index, cy_rslt_t result,
+                         scheduler_entry_t *finished)
+{
+    scheduler_entry_t *entry = &state->lanes[lane][index];
+
+    if ((NULL != entry->next_chunk) && (CY_RSLT_SUCCESS == result))
+    {
+        entry->chunk++;
+        if (entry->next_chunk(entry->chunk, &entry->request, entry->arg))
+        {
+            return false;
+        }
+        state->stats.transfers++;
+    }
+
+    *finished = *entry;
+    state->lane_length[lane]--;
+    memmove(entry, entry + 1, (state->lane_length[lane] - index) * sizeof(*entry));
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: find_bucket
+ *******************************************************************************
+ * Summary:
+ *  Returns the bucket of the destination of a path, adding one with the
+ *  default limit for a new destination.
+ *
+ *******************************************************************************/
+static token_bucket_t *find_bucket(scheduler_t *state, const char *path, uint32_t now_ms)
+{
+    char destination[REQUEST_SCHEDULER_DESTINATION_LENGTH];
+    token_bucket_t *bucket;
+    size_t length = strcspn(&path[1], "/?") + 1u;
+
+    if (length >= sizeof(destination))
+    {
+        length = sizeof(destination) - 1u;
+    }
+    memcpy(destination, path, length);
+    destination[length] = '\0';
+
+    for (uint32_t i = 0; i < state->bucket_count; i++)
+    {
+        if (0 == strcmp(state->buckets[i].destination, destination))
+        {
+            return &state->buckets[i];
+        }
+    }
+
+    if (state->bucket_count >= REQUEST_SCHEDULER_MAX_DESTINATIONS)
+    {
+        return &state->buckets[REQUEST_SCHEDULER_MAX_DESTINATIONS - 1u];
+    }
+
+    bucket = &state->buckets[state->bucket_count++];
+    memcpy(bucket->destination, destination, length + 1u);
+    bucket->rate = REQUEST_SCHEDULER_DEFAULT_RATE;
+    bucket->burst = REQUEST_SCHEDULER_DEFAULT_BURST;
+    bucket->tokens = REQUEST_SCHEDULER_DEFAULT_BURST * TOKEN_UNIT;
+    bucket->last_ms = now_ms;
+
+    return bucket;
+}
+
+/*******************************************************************************
+ * Function Name: bucket_wait
+ *******************************************************************************
+ * Summary:
+ *  Refills a bucket for the time since it was last used and returns the
+ *  time until it holds a token, 0 if it does.
+ *
+ *******************************************************************************/
+static uint32_t bucket_wait(token_bucket_t *bucket, uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - bucket->last_ms;
+    uint32_t capacity = bucket->burst * TOKEN_UNIT;
+
+    bucket->last_ms = now_ms;
+
+    if (0u == bucket->rate)
+    {
+        return 0;
+    }
+
+    /* One token per ms at most, so a long pause cannot overflow. */
+    if (elapsed_ms > capacity)
+    {
+        elapsed_ms = capacity;
+    }
+    bucket->tokens += elapsed_ms * bucket->rate;
+    if (bucket->tokens > capacity)
+    {
+        bucket->tokens = capacity;
+    }
+
+    if (bucket->tokens >= TOKEN_UNIT)
+    {
+        return 0;
+    }
+
+    return ((TOKEN_UNIT - bucket->tokens) + bucket->rate - 1u) / bucket->rate;
+}
+
+/*******************************************************************************
+ * Function Name: now_ms
+ *******************************************************************************
+ * Summary:
+ *  Returns the time since the scheduler started, in ms.
+ *
+ *******************************************************************************/
+static uint32_t now_ms(void)
+{
+    return (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+/*******************************************************************************
+ * Function Name: next_interval
+ *******************************************************************************
+ * Summary:
+ *  Returns a random interval between half and one and a half times a mean.
+ *
+ *******************************************************************************/
+static uint32_t next_interval(uint32_t mean_ms)
+{
+    return (mean_ms / 2u) + (xorshift_next(&random_state) % (mean_ms + 1u));
+}
+
+/*******************************************************************************
+ * Function Name: simulate
+ *******************************************************************************
+ * Summary:
+ *  Runs the simulation for one chunk size. Each request occupies the link
+ *  for a round trip plus its body and the request overhead at the link
+ *  rate; alarms that arrive meanwhile are queued when it ends.
+ *
+ *******************************************************************************/
+static void simulate(uint32_t chunk_size)
+{
+    static bulk_source_t source;
+    scheduler_entry_t entry;
+    scheduler_entry_t finished;
+    scheduler_entry_t *selected;
+    uint32_t now = 0;
+    uint32_t next_arrival;
+    uint32_t submitted = 0;
+    uint32_t lane;
+    uint32_t index;
+    uint32_t wait_ms;
+    bool arriving;
+
+    memset(&sim_scheduler, 0, sizeof(sim_scheduler));
+    urgent_completed = 0;
+    urgent_failed = 0;
+    bulk_completed = false;
+
+    source.body = NULL;
+    source.size = REQUEST_SCHEDULER_SIM_BULK_SIZE;
+    source.chunk_size = chunk_size;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.next_chunk = bulk_next_chunk;
+    entry.done = bulk_done;
+    entry.arg = &source;
+    (void)bulk_next_chunk(0, &entry.request, &source);
+    (void)add_entry(&sim_scheduler, REQUEST_LANE_BULK, &entry);
+
+    next_arrival = next_interval(REQUEST_SCHEDULER_BENCH_INTERVAL_MS);
+
+    for (;;)
+    {
+        /* Alarms keep arriving until the end of the upload, including those
+         * that arrived during its last request.
+         */
+        arriving = (!bulk_completed || (next_arrival < bulk_latency)) &&
+                   (submitted < REQUEST_SCHEDULER_BENCH_MAX_URGENT);
+        if (!arriving && bulk_completed && (urgent_completed == submitted))
+        {
+            break;
+        }
+
+        while (arriving && (next_arrival <= now))
+        {
+            memset(&entry, 0, sizeof(entry));
+            entry.request.method = CY_HTTP_CLIENT_METHOD_POST;
+            entry.request.path = REQUEST_SCHEDULER_BENCH_URGENT_PATH;
+            entry.request.body_len = sizeof(bench_alarm) - 1u;
+            entry.done = urgent_done;
+            entry.submitted_ms = next_arrival;
+            if (CY_RSLT_SUCCESS == add_entry(&sim_scheduler, REQUEST_LANE_URGENT, &entry))
+            {
+                submitted++;
+            }
+            next_arrival += next_interval(REQUEST_SCHEDULER_BENCH_INTERVAL_MS);
+            arriving = (!bulk_completed || (next_arrival < bulk_latency)) &&
+                       (submitted < REQUEST_SCHEDULER_BENCH_MAX_URGENT);
+        }
+
+        selected = select_entry(&sim_scheduler, now, &lane, &index, &wait_ms);
+        if (NULL == selected)
+        {
+            if (arriving && ((next_arrival - now) < wait_ms))
+            {
+                wait_ms = next_arrival - now;
+            }
+            if (NO_WAIT == wait_ms)
+            {
+                break;
+            }
+            now += (0u == wait_ms) ? 1u : wait_ms;
+            continue;
+        }
+
+        now += REQUEST_SCHEDULER_SIM_RTT_MS +
+               (((selected->request.body_len + TELEMETRY_BATCH_REQUEST_OVERHEAD) * 8u) / REQUEST_SCHEDULER_SIM_LINK_KBPS);
+
+        if (finish_entry(&sim_scheduler, lane, index, CY_RSLT_SUCCESS, &finished))
+        {
+            finished.done(CY_RSLT_SUCCESS, now - finished.submitted_ms, finished.arg);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: bulk_next_chunk
+ *******************************************************************************
+ * Summary:
+ *  Fills the POST request of a chunk of the bulk upload.
+ *
+ *******************************************************************************/
+static bool bulk_next_chunk(uint32_t chunk, https_request_t *request, void *arg)
+{
+    bulk_source_t *source = (bulk_source_t *)arg;
+    uint32_t offset = chunk * source->chunk_size;
+
+    if (offset >= source->size)
+    {
+        return false;
+    }
+
+    memset(request, 0, sizeof(*request));
+    request->method = CY_HTTP_CLIENT_METHOD_POST;
+    request->path = REQUEST_SCHEDULER_BENCH_BULK_PATH;
+    request->content_type = "application/octet-stream";
+    request->body = (NULL == source->body) ? NULL : &source->body[offset];
+    request->body_len = ((source->size - offset) < source->chunk_size) ? (source->size - offset) : source->chunk_size;
+    request->response_cb = ignore_response;
+    request->quiet = true;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: bulk_done
+ *******************************************************************************
+ * Summary:
+ *  Records the end of the bulk upload.
+ *
+ *******************************************************************************/
+static void bulk_done(cy_rslt_t result, uint32_t latency_ms, void *arg)
+{
+    (void)arg;
+
+    bulk_result = result;
+    bulk_latency = latency_ms;
+    bulk_completed = true;
+}
+
+/*******************************************************************************
+ * Function Name: job_done
+ *******************************************************************************
+ * Summary:
+ *  Wakes the caller of request_scheduler_run() with the result of its job.
+ *
+ *******************************************************************************/
+static void job_done(cy_rslt_t result, uint32_t latency_ms, void *arg)
+{
+    job_wait_t *wait = (job_wait_t *)arg;
+
+    (void)latency_ms;
+
+    wait->result = result;
+    xSemaphoreGive(wait->done);
+}
+
+/*******************************************************************************
+ * Function Name: urgent_done
+ *******************************************************************************
+ * Summary:
+ *  Records the latency of an alarm.
+ *
+ *******************************************************************************/
+static void urgent_done(cy_rslt_t result, uint32_t latency_ms, void *arg)
+{
+    (void)arg;
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        urgent_failed++;
+    }
+
+    if (urgent_completed < REQUEST_SCHEDULER_BENCH_MAX_URGENT)
+    {
+        urgent_latency[urgent_completed] = latency_ms;
+    }
+    urgent_completed++;
+
+    if (NULL != bench_semaphore)
+    {
+        xSemaphoreGive(bench_semaphore);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: ignore_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the simulation and benchmark requests, which are
+ *  not printed.
+ *
+ *******************************************************************************/
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    (void)handle;
+    (void)response;
+    (void)arg;
+}
+
+/*******************************************************************************
+ * Function Name: print_results
+ *******************************************************************************
+ * Summary:
+ *  Sorts the alarm latencies and prints the time of the upload and the
+ *  latency percentiles, without ending the line.
+ *
+ *******************************************************************************/
+static void print_results(uint32_t chunk_size, uint32_t bulk_size, uint32_t preemptions)
+{
+    static const uint32_t percentiles[] = { 50u, 90u, 99u, 100u };
+    uint32_t count = (urgent_completed < REQUEST_SCHEDULER_BENCH_MAX_URGENT) ?
+                     urgent_completed : REQUEST_SCHEDULER_BENCH_MAX_URGENT;
+    uint32_t value;
+    uint32_t j;
+
+    /* Insertion sort: there are at most REQUEST_SCHEDULER_BENCH_MAX_URGENT. */
+    for (uint32_t i = 1; i < count; i++)
+    {
+        value = urgent_latency[i];
+        for (j = i; (j > 0u) && (urgent_latency[j - 1u] > value); j--)
+        {
+            urgent_latency[j] = urgent_latency[j - 1u];
+        }
+        urgent_latency[j] = value;
+    }
+
+    printf("  %8lu %8lu %9lu %7lu", (unsigned long)chunk_size, (unsigned long)bulk_latency,
+           (unsigned long)((0u == bulk_latency) ? 0u : (bulk_size / bulk_latency)), (unsigned long)count);
+
+    for (uint32_t i = 0; i < (sizeof(percentiles) / sizeof(percentiles[0])); i++)
+    {
+        value = (0u == count) ? 0u : urgent_latency[(((percentiles[i] * count) + 99u) / 100u) - 1u];
+        printf(" %6lu", (unsigned long)value);
+    }
+
+    printf(" %8lu", (unsigned long)preemptions);
+}
+
+/* [] END OF FILE */
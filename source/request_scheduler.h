@@ -0,0 +1,153 @@
+/******************************************************************************
+* File Name: request_scheduler.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the request scheduler, which sends the HTTPS requests in two
+* priority lanes under per-destination rate limits.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef REQUEST_SCHEDULER_H_
+#define REQUEST_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "secure_http_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Requests and bulk transfers each lane can hold. */
+#define REQUEST_SCHEDULER_LANE_DEPTH             (8)
+
+/* Token buckets. A destination is the first segment of the request path,
+ * for example "/telemetry". When all the buckets are taken, further
+ * destinations share the last one.
+ */
+#define REQUEST_SCHEDULER_MAX_DESTINATIONS       (4)
+#define REQUEST_SCHEDULER_DESTINATION_LENGTH     (24)
+
+/* Limit of a destination until request_scheduler_set_limit() is called:
+ * requests per second, and the burst sent at once after a quiet period.
+ */
+#define REQUEST_SCHEDULER_DEFAULT_RATE           (10u)
+#define REQUEST_SCHEDULER_DEFAULT_BURST          (5u)
+
+/* Scheduler task parameters. The task runs the transfers of the bulk
+ * producers, TLS handshakes of their own connections included.
+ */
+#define REQUEST_SCHEDULER_TASK_STACK_SIZE        (4 * 1024)
+#define REQUEST_SCHEDULER_TASK_PRIORITY          (1)
+
+/* "Request scheduler" menu option: a bulk upload posted whole and then in
+ * chunks, while urgent alarms arrive at random intervals around the mean.
+ */
+#define REQUEST_SCHEDULER_BENCH_BULK_PATH        "/upload"
+#define REQUEST_SCHEDULER_BENCH_BULK_SIZE        (32768u)
+#define REQUEST_SCHEDULER_BENCH_CHUNK_SIZE       (4096u)
+#define REQUEST_SCHEDULER_BENCH_URGENT_PATH      "/alarm"
+#define REQUEST_SCHEDULER_BENCH_INTERVAL_MS      (250u)
+#define REQUEST_SCHEDULER_BENCH_MAX_URGENT       (64)
+
+/* Simulated link of the menu option: the scheduler runs on a virtual clock
+ * and each request takes a round trip plus its bytes at the link rate.
+ */
+#define REQUEST_SCHEDULER_SIM_LINK_KBPS          (2000u)
+#define REQUEST_SCHEDULER_SIM_RTT_MS             (50u)
+#define REQUEST_SCHEDULER_SIM_BULK_SIZE          (262144u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+/* An urgent request is sent before any bulk chunk that is waiting. */
+typedef enum
+{
+    REQUEST_LANE_URGENT = 0,
+    REQUEST_LANE_BULK,
+    REQUEST_LANE_COUNT,
+} request_lane_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Fills the request of a chunk of a bulk transfer, numbered from 0. Returns
+ * false when all the chunks were sent. Called by the scheduler with its lock
+ * held, so it must not submit requests.
+ */
+typedef bool (*request_chunk_cb_t)(uint32_t chunk, https_request_t *request, void *arg);
+
+/* Called when a request or a bulk transfer is complete, with the time since
+ * it was submitted. A bulk transfer stops at its first failed chunk.
+ */
+typedef void (*request_done_cb_t)(cy_rslt_t result, uint32_t latency_ms, void *arg);
+
+/* Transfer run by the scheduler task in place of a request, for producers
+ * that drive their own connection or stream their body. Returns the result
+ * of the transfer.
+ */
+typedef cy_rslt_t (*request_job_cb_t)(void *arg);
+
+/* Counters since the start of the application. */
+typedef struct
+{
+    uint32_t requests[REQUEST_LANE_COUNT];   /* Requests sent, chunks included. */
+    uint32_t transfers;          /* Bulk transfers completed. */
+    uint32_t preemptions;        /* Urgent requests sent between the chunks of a transfer. */
+    uint32_t throttled;          /* Times no request could be sent for lack of tokens. */
+} request_scheduler_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t request_scheduler_init(void);
+cy_rslt_t request_scheduler_set_limit(const char *destination, uint32_t rate, uint32_t burst);
+cy_rslt_t request_scheduler_submit(const https_request_t *request, request_lane_t lane,
+                                   request_done_cb_t done, void *arg);
+cy_rslt_t request_scheduler_submit_bulk(request_chunk_cb_t next_chunk, request_done_cb_t done, void *arg);
+cy_rslt_t request_scheduler_run(const char *path, request_lane_t lane, request_job_cb_t job, void *arg);
+cy_rslt_t request_scheduler_post(const char *path, request_lane_t lane, request_job_cb_t job, void *arg);
+void request_scheduler_get_stats(request_scheduler_stats_t *stats);
+void request_scheduler_simulate(void);
+void request_scheduler_benchmark(void);
+
+#endif /* REQUEST_SCHEDULER_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,986 @@
+/******************************************************************************
+* File Name: response_cache.c
+*
+* Description: This file contains the response cache. GET responses with a
+* validator or a max-age are kept in the external flash, one entry per
+* erase sector, with an index in RAM that is rebuilt at start-up. Fresh
+* entries are served without a request, stale ones are revalidated with
+* If-None-Match or If-Modified-Since, and the least recently used entry is
+* replaced when the cache is full.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_serial_flash_qspi.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "inflater.h"
+#include "xorshift.h"
+#include "response_cache.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CACHE_ENTRY_MAGIC                (0xCAC4E001UL)
+
+/* Scratch buffer used to check and write the entries. It holds the header
+ * and the strings of an entry.
+ */
+#define CACHE_SCRATCH_SIZE               (256)
+
+/* Last-Modified of the simulated resources that never change. */
+#define TRACE_LAST_MODIFIED              "Mon, 01 Jan 2024 00:00:00 GMT"
+
+/* max_age_s of a simulated resource sent with "no-store". */
+#define TRACE_NO_STORE                   (-1)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Header of an entry in the flash. The path, the ETag, the Last-Modified
+ * value, and the body follow it.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t max_age_s;
+    uint16_t path_len;
+    uint16_t etag_len;
+    uint16_t last_modified_len;
+    uint16_t reserved;
+    uint32_t body_len;
+    uint32_t crc;                /* CRC-32 of the entry with crc 0. */
+} cache_entry_header_t;
+
+/* Index of an entry in RAM. The age of an entry is not known after a
+ * restart, as there is no wall clock, so it is revalidated first.
+ */
+typedef struct
+{
+    bool valid;
+    bool age_known;
+    uint32_t seq;
+    uint32_t max_age_s;
+    uint32_t stored_ms;
+    uint32_t last_used;
+    uint32_t body_offset;
+    uint32_t body_len;
+    char path[RESPONSE_CACHE_MAX_PATH_LEN + 1];
+    char etag[RESPONSE_CACHE_MAX_ETAG_LEN + 1];
+    char last_modified[RESPONSE_CACHE_DATE_LEN + 1];
+} cache_slot_t;
+
+/* Resource of the simulated origin. */
+typedef struct
+{
+    const char *path;
+    uint32_t size;
+    int32_t max_age_s;           /* TRACE_NO_STORE, 0 for "no-cache". */
+    uint32_t change_period_s;    /* 0 if it never changes. */
+    bool by_date;                /* Validated with Last-Modified instead of an ETag. */
+    uint32_t weight;             /* Share of the requests. */
+} trace_resource_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static cache_slot_t slots[RESPONSE_CACHE_NUM_SLOTS];
+static uint32_t sector_size;
+static uint32_t next_seq;
+static uint32_t use_clock;
+static response_cache_stats_t cache_stats;
+
+/* Serializes the index and the flash operations on the cache. */
+static SemaphoreHandle_t cache_mutex;
+
+static uint8_t scratch[CACHE_SCRATCH_SIZE];
+
+/* Resources of the replayed trace, modelled on the polling of a device:
+ * configuration and manifests that change every hour or so, static assets,
+ * and uncacheable status resources. There are more than the cache holds.
+ */
+static const trace_resource_t trace_resources[] =
+{
+    { "/trace/config.json",        1200u,  300,             3600u,  false, 30u },
+    { "/trace/manifest.json",       600u,   60,             7200u,  false, 20u },
+    { "/trace/time",                 40u,  TRACE_NO_STORE,     1u,  false, 15u },
+    { "/trace/schedule.json",       900u,    0,             1800u,  false, 10u },
+    { "/trace/alerts.json",         300u,   30,              600u,  false, 10u },
+    { "/trace/logo.svg",           1900u, 86400,               0u,  true,   5u },
+    { "/trace/features.json",       500u,  600,             1800u,  false,  3u },
+    { "/trace/locale/en.json",     1500u, 3600,                0u,  true,   3u },
+    { "/trace/locale/de.json",     1500u, 3600,                0u,  true,   2u },
+    { "/trace/crl.pem",            1800u, 43200,           86400u,  false,  1u },
+    { "/trace/ota/status",          200u,   10,              120u,  false,  1u },
+};
+
+static uint8_t trace_body[RESPONSE_CACHE_MAX_BODY_LEN];
+static uint8_t trace_cached[RESPONSE_CACHE_MAX_BODY_LEN];
+static uint32_t random_state = 0x6C078965u;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void load_slots(void);
+static bool load_slot(uint32_t index);
+static cache_slot_t *find_slot(const char *path);
+static cache_slot_t *victim_slot(void);
+static bool copy_header(char *dest, size_t size, const char *value, size_t length);
+static int32_t parse_max_age(const char *value, size_t length);
+static bool has_directive(const char *value, size_t length, const char *directive);
+static uint32_t slot_address(const cache_slot_t *slot);
+static uint32_t trace_response(const trace_resource_t *resource, uint32_t version,
+                               response_cache_headers_t *headers, char *cache_control, char *etag);
+
+/*******************************************************************************
+ * Function Name: response_cache_init
+ *******************************************************************************
+ * Summary:
+ *  Rebuilds the index of the cache from the entries in the flash. Entries
+ *  that fail their CRC, such as one torn by a power loss, are ignored.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the cache is ready, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t response_cache_init(void)
+{
+    uint32_t entries = 0;
+
+    if (NULL != cache_mutex)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    sector_size = (uint32_t)cy_serial_flash_qspi_get_erase_size(RESPONSE_CACHE_FLASH_ADDRESS);
+    if ((0 == sector_size) ||
+        ((RESPONSE_CACHE_FLASH_ADDRESS + (RESPONSE_CACHE_NUM_SLOTS * sector_size)) >
+         (uint32_t)cy_serial_flash_qspi_get_size()))
+    {
+        ERR_INFO(("The response cache does not fit in the external flash.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    cache_mutex = xSemaphoreCreateMutex();
+    if (NULL == cache_mutex)
+    {
+        ERR_INFO(("Failed to create the response cache mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    load_slots();
+
+    for (uint32_t i = 0; i < RESPONSE_CACHE_NUM_SLOTS; i++)
+    {
+        entries += slots[i].valid ? 1u : 0u;
+    }
+    APP_INFO(("Response cache: %lu entries recovered from flash\n", (unsigned long)entries));
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_lookup
+ *******************************************************************************
+ * Summary:
+ *  Looks a path up in the cache and marks its entry as used.
+ *
+ * Parameters:
+ *  path - Resource path.
+ *  now_ms - Current time, in ms.
+ *  lookup - Filled with the state of the entry and its validators.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void response_cache_lookup(const char *path, uint32_t now_ms, response_cache_lookup_t *lookup)
+{
+    cache_slot_t *slot;
+
+    memset(lookup, 0, sizeof(*lookup));
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+
+    cache_stats.lookups++;
+    slot = find_slot(path);
+
+    if (NULL == slot)
+    {
+        lookup->state = RESPONSE_CACHE_MISS;
+        cache_stats.misses++;
+    }
+    else
+    {
+        slot->last_used = ++use_clock;
+        lookup->slot = (uint32_t)(slot - slots);
+        lookup->seq = slot->seq;
+        lookup->body_len = slot->body_len;
+        memcpy(lookup->etag, slot->etag, sizeof(lookup->etag));
+        memcpy(lookup->last_modified, slot->last_modified, sizeof(lookup->last_modified));
+
+        if (slot->age_known && ((now_ms - slot->stored_ms) < (slot->max_age_s * 1000u)))
+        {
+            lookup->state = RESPONSE_CACHE_FRESH;
+            cache_stats.fresh++;
+            cache_stats.bytes_saved += slot->body_len;
+        }
+        else
+        {
+            lookup->state = RESPONSE_CACHE_STALE;
+        }
+    }
+
+    xSemaphoreGive(cache_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_read
+ *******************************************************************************
+ * Summary:
+ *  Reads the body of the entry found by response_cache_lookup().
+ *
+ * Parameters:
+ *  lookup - Result of the lookup.
+ *  buffer - Filled with the body.
+ *  size - Size of the buffer.
+ *
+ * Return:
+ *  uint32_t: Length of the body, or 0 if the entry was replaced or the
+ *  buffer is too small.
+ *
+ *******************************************************************************/
+uint32_t response_cache_read(const response_cache_lookup_t *lookup, uint8_t *buffer, uint32_t size)
+{
+    cache_slot_t *slot = &slots[lookup->slot];
+    uint32_t length = 0;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+
+    if ((RESPONSE_CACHE_MISS != lookup->state) && slot->valid && (slot->seq == lookup->seq) &&
+        (slot->body_len <= size) &&
+        (CY_RSLT_SUCCESS == cy_serial_flash_qspi_read(slot_address(slot) + slot->body_offset,
+                                                     slot->body_len, buffer)))
+    {
+        length = slot->body_len;
+    }
+
+    xSemaphoreGive(cache_mutex);
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_not_modified
+ *******************************************************************************
+ * Summary:
+ *  Renews the entry of a revalidated lookup after a 304 response, with the
+ *  max-age of the 304 if it has one. The entry is not rewritten.
+ *
+ * Parameters:
+ *  lookup - Result of the lookup.
+ *  now_ms - Current time, in ms.
+ *  headers - Caching headers of the 304 response.
+ *
+ * Return:
+ *  bool: true if the entry can be served, false if it was replaced
+ *  meanwhile.
+ *
+ *******************************************************************************/
+bool response_cache_not_modified(const response_cache_lookup_t *lookup, uint32_t now_ms,
+                                 const response_cache_headers_t *headers)
+{
+    cache_slot_t *slot = &slots[lookup->slot];
+    int32_t max_age = parse_max_age(headers->cache_control, headers->cache_control_len);
+    bool renewed = false;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+
+    if ((RESPONSE_CACHE_STALE == lookup->state) && slot->valid && (slot->seq == lookup->seq))
+    {
+        if (max_age >= 0)
+        {
+            slot->max_age_s = (uint32_t)max_age;
+        }
+        slot->stored_ms = now_ms;
+        slot->age_known = true;
+        cache_stats.not_modified++;
+        cache_stats.bytes_saved += slot->body_len;
+        renewed = true;
+    }
+
+    xSemaphoreGive(cache_mutex);
+
+    return renewed;
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_store
+ *******************************************************************************
+ * Summary:
+ *  Stores a 200 response in the entry of its path, or in the least recently
+ *  used entry. Responses with "no-store", or without a validator or a
+ *  max-age, are not stored.
+ *
+ * Parameters:
+ *  path - Resource path.
+ *  now_ms - Current time, in ms.
+ *  headers - Caching headers of the response.
+ *  body - Complete body of the response.
+ *  body_len - Length of the body.
+ *
+ * Return:
+ *  bool: true if the response was stored.
+ *
+ *******************************************************************************/
+bool response_cache_store(const char *path, uint32_t now_ms, const response_cache_headers_t *headers,
+                          const uint8_t *body, uint32_t body_len)
+{
+    cache_entry_header_t header;
+    cache_slot_t *slot;
+    cache_slot_t entry;
+    int32_t max_age = parse_max_age(headers->cache_control, headers->cache_control_len);
+    uint32_t offset = sizeof(header);
+    uint32_t crc;
+    bool stored = false;
+
+    memset(&entry, 0, sizeof(entry));
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+
+    cache_stats.bytes_fetched += body_len;
+
+    /* The strings and the body of the entry must fit. */
+    if (!has_directive(headers->cache_control, headers->cache_control_len, "no-store") &&
+        copy_header(entry.path, sizeof(entry.path), path, strlen(path)) &&
+             copy_header(entry.etag, sizeof(entry.etag), headers->etag, headers->etag_len) &&
+             copy_header(entry.last_modified, sizeof(entry.last_modified),
+                         headers->last_modified, headers->last_modified_len) &&
+             (body_len <= RESPONSE_CACHE_MAX_BODY_LEN))
+    {
+        entry.valid = ('\0' != entry.etag[0]) || ('\0' != entry.last_modified[0]) || (max_age > 0);
+    }
+
+    if (!entry.valid)
+    {
+        cache_stats.uncacheable++;
+        xSemaphoreGive(cache_mutex);
+
+        /* A stored copy of the resource is out of date now. */
+        response_cache_invalidate(path);
+        return false;
+    }
+
+    slot = find_slot(path);
+    if (NULL == slot)
+    {
+        slot = victim_slot();
+        if (slot->valid)
+        {
+            cache_stats.evicted++;
+        }
+    }
+
+    /* The entry is written in full before the index is updated. */
+    slot->valid = false;
+
+    header.magic = CACHE_ENTRY_MAGIC;
+    header.seq = next_seq++;
+    header.max_age_s = (max_age > 0) ? (uint32_t)max_age : 0u;
+    header.path_len = (uint16_t)strlen(entry.path);
+    header.etag_len = (uint16_t)strlen(entry.etag);
+    header.last_modified_len = (uint16_t)strlen(entry.last_modified);
+    header.reserved = 0;
+    header.body_len = body_len;
+    header.crc = 0;
+
+    memcpy(&scratch[offset], entry.path, header.path_len);
+    offset += header.path_len;
+    memcpy(&scratch[offset], entry.etag, header.etag_len);
+    offset += header.etag_len;
+    memcpy(&scratch[offset], entry.last_modified, header.last_modified_len);
+    offset += header.last_modified_len;
+
+    memcpy(scratch, &header, sizeof(header));
+    crc = inflater_crc32(0, scratch, offset);
+    header.crc = inflater_crc32(crc, body, body_len);
+    memcpy(scratch, &header, sizeof(header));
+
+    if ((CY_RSLT_SUCCESS == cy_serial_flash_qspi_erase(slot_address(slot), sector_size)) &&
+        (CY_RSLT_SUCCESS == cy_serial_flash_qspi_write(slot_address(slot), offset, scratch)) &&
+        ((0u == body_len) ||
+         (CY_RSLT_SUCCESS == cy_serial_flash_qspi_write(slot_address(slot) + offset, body_len, body))))
+    {
+        entry.valid = true;
+        entry.age_known = true;
+        entry.seq = header.seq;
+        entry.max_age_s = header.max_age_s;
+        entry.stored_ms = now_ms;
+        entry.last_used = ++use_clock;
+        entry.body_offset = offset;
+        entry.body_len = body_len;
+        *slot = entry;
+
+        cache_stats.stored++;
+        stored = true;
+    }
+    else
+    {
+        ERR_INFO(("Failed to write the response cache entry of %s.\n", path));
+    }
+
+    xSemaphoreGive(cache_mutex);
+
+    return stored;
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_invalidate
+ *******************************************************************************
+ * Summary:
+ *  Drops the entry of a path after a request that may have changed the
+ *  resource, such as a PUT or a POST (RFC 9111, section 4.4).
+ *
+ * Parameters:
+ *  path - Resource path.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void response_cache_invalidate(const char *path)
+{
+    cache_slot_t *slot;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+
+    slot = find_slot(path);
+    if (NULL != slot)
+    {
+        slot->valid = false;
+        (void)cy_serial_flash_qspi_erase(slot_address(slot), sector_size);
+    }
+
+    xSemaphoreGive(cache_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns a copy of the cache statistics.
+ *
+ * Parameters:
+ *  stats - Filled with the statistics.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void response_cache_get_stats(response_cache_stats_t *stats)
+{
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    *stats = cache_stats;
+    xSemaphoreGive(cache_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: response_cache_replay_trace
+ *******************************************************************************
+ * Summary:
+ *  Replays RESPONSE_CACHE_TRACE_REQUESTS GET requests of the trace
+ *  resources through the cache, on a virtual clock, against a simulated
+ *  origin that answers conditional requests with 304. Half way through, the
+ *  index is rebuilt from the flash as after a reboot. Prints the hit ratio,
+ *  the body bytes saved, and the fresh hits whose resource had changed at
+ *  the origin.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void response_cache_replay_trace(void)
+{
+    response_cache_stats_t before;
+    response_cache_stats_t after;
+    response_cache_lookup_t lookup;
+    response_cache_headers_t headers;
+    const trace_resource_t *resource;
+    char cache_control[24];
+    char etag[RESPONSE_CACHE_MAX_ETAG_LEN + 1];
+    uint32_t total_weight = 0;
+    uint32_t now_ms = 0;
+    uint32_t pick;
+    uint32_t version;
+    uint32_t length;
+    uint32_t requests = 0;
+    uint32_t uncached_bytes = 0;
+    uint32_t outdated = 0;
+    uint32_t errors = 0;
+    uint32_t hits;
+    TickType_t start;
+    bool matches;
+
+    for (uint32_t i = 0; i < (sizeof(trace_resources) / sizeof(trace_resources[0])); i++)
+    {
+        total_weight += trace_resources[i].weight;
+    }
+
+    response_cache_get_stats(&before);
+    start = xTaskGetTickCount();
+
+    for (uint32_t i = 0; i < RESPONSE_CACHE_TRACE_REQUESTS; i++)
+    {
+        if (i == (RESPONSE_CACHE_TRACE_REQUESTS / 2u))
+        {
+            xSemaphoreTake(cache_mutex, portMAX_DELAY);
+            load_slots();
+            xSemaphoreGive(cache_mutex);
+        }
+
+        now_ms += (RESPONSE_CACHE_TRACE_INTERVAL_MS / 2u) +
+                  (xorshift_next(&random_state) % (RESPONSE_CACHE_TRACE_INTERVAL_MS + 1u));
+
+        pick = xorshift_next(&random_state) % total_weight;
+        resource = trace_resources;
+        while (pick >= resource->weight)
+        {
+            pick -= resource->weight;
+            resource++;
+        }
+
+        version = (0u == resource->change_period_s) ? 0u : ((now_ms / 1000u) / resource->change_period_s);
+        length = trace_response(resource, version, &headers, cache_control, etag);
+        uncached_bytes += length;
+
+        response_cache_lookup(resource->path, now_ms, &lookup);
+
+        if (RESPONSE_CACHE_FRESH == lookup.state)
+        {
+            if ((response_cache_read(&lookup, trace_cached, sizeof(trace_cached)) != length) ||
+                (0 != memcmp(trace_cached, trace_body, length)))
+            {
+                outdated++;
+            }
+            continue;
+        }
+
+        requests++;
+        matches = (RESPONSE_CACHE_STALE == lookup.state) &&
+                  (resource->by_date ? (0 == strcmp(lookup.last_modified, TRACE_LAST_MODIFIED))
+                                     : (0 == strcmp(lookup.etag, etag)));
+
+        if (matches && response_cache_not_modified(&lookup, now_ms, &headers))
+        {
+            if ((response_cache_read(&lookup, trace_cached, sizeof(trace_cached)) != length) ||
+                (0 != memcmp(trace_cached, trace_body, length)))
+            {
+                errors++;
+            }
+        }
+        else
+        {
+            (void)response_cache_store(resource->path, now_ms, &headers, trace_body, length);
+        }
+    }
+
+    response_cache_get_stats(&after);
+    hits = (after.fresh - before.fresh) + (after.not_modified - before.not_modified);
+
+    APP_INFO(("Replayed %lu requests over %lu virtual minutes in %lu ms, with a reboot half way\n",
+              (unsigned long)RESPONSE_CACHE_TRACE_REQUESTS, (unsigned long)(now_ms / 60000u),
+              (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS)));
+    printf("  fresh hits         %lu (%lu served after the origin changed)\n",
+           (unsigned long)(after.fresh - before.fresh), (unsigned long)outdated);
+    printf("  304 revalidations  %lu\n", (unsigned long)(after.not_modified - before.not_modified));
+    printf("  misses             %lu\n", (unsigned long)(after.misses - before.misses));
+    printf("  hit ratio          %lu%%\n", (unsigned long)((100u * hits) / RESPONSE_CACHE_TRACE_REQUESTS));
+    printf("  requests sent      %lu of %lu\n", (unsigned long)requests, (unsigned long)RESPONSE_CACHE_TRACE_REQUESTS);
+    printf("  body bytes         %lu fetched, %lu saved of %lu\n",
+           (unsigned long)(after.bytes_fetched - before.bytes_fetched),
+           (unsigned long)(after.bytes_saved - before.bytes_saved), (unsigned long)uncached_bytes);
+    printf("  flash writes       %lu, %lu evictions, %lu uncacheable\n",
+           (unsigned long)(after.stored - before.stored), (unsigned long)(after.evicted - before.evicted),
+           (unsigned long)(after.uncacheable - before.uncacheable));
+
+    if (0u != errors)
+    {
+        ERR_INFO(("%lu revalidated bodies did not match the origin.\n", (unsigned long)errors));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: load_slots
+ *******************************************************************************
+ * Summary:
+ *  Rebuilds the index from the flash. The order of use starts as the order
+ *  in which the entries were written.
+ *
+ *******************************************************************************/
+static void load_slots(void)
+{
+    next_seq = 1;
+
+    for (uint32_t i = 0; i < RESPONSE_CACHE_NUM_SLOTS; i++)
+    {
+        if (load_slot(i) && (slots[i].seq >= next_seq))
+        {
+            next_seq = slots[i].seq + 1u;
+        }
+    }
+
+    use_clock = next_seq;
+}
+
+/*******************************************************************************
+ * Function Name: load_slot
+ *******************************************************************************
+ * Summary:
+ *  Reads and checks the entry of a slot into the index.
+ *
+ * Return:
+ *  bool: true if the slot holds a valid entry.
+ *
+ *******************************************************************************/
+static bool load_slot(uint32_t index)
+{
+    cache_slot_t *slot = &slots[index];
+    cache_entry_header_t header;
+    uint32_t address = RESPONSE_CACHE_FLASH_ADDRESS + (index * sector_size);
+    uint32_t strings;
+    uint32_t crc;
+    uint32_t stored_crc;
+    uint32_t done;
+    uint32_t length;
+    char *text;
+
+    memset(slot, 0, sizeof(*slot));
+
+    if ((CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(address, sizeof(header), (uint8_t *)&header)) ||
+        (CACHE_ENTRY_MAGIC != header.magic) || (header.path_len > RESPONSE_CACHE_MAX_PATH_LEN) ||
+        (header.etag_len > RESPONSE_CACHE_MAX_ETAG_LEN) || (header.last_modified_len > RESPONSE_CACHE_DATE_LEN) ||
+        (header.body_len > RESPONSE_CACHE_MAX_BODY_LEN))
+    {
+        return false;
+    }
+
+    strings = (uint32_t)header.path_len + header.etag_len + header.last_modified_len;
+    if (CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(address + sizeof(header), strings, &scratch[sizeof(header)]))
+    {
+        return false;
+    }
+
+    stored_crc = header.crc;
+    header.crc = 0;
+    memcpy(scratch, &header, sizeof(header));
+    crc = inflater_crc32(0, scratch, sizeof(header) + strings);
+
+    text = (char *)&scratch[sizeof(header)];
+    memcpy(slot->path, text, header.path_len);
+    memcpy(slot->etag, &text[header.path_len], header.etag_len);
+    memcpy(slot->last_modified, &text[header.path_len + header.etag_len], header.last_modified_len);
+
+    /* The body is checked through the scratch buffer. */
+    for (done = 0; done < header.body_len; done += length)
+    {
+        length = header.body_len - done;
+        length = (length > CACHE_SCRATCH_SIZE) ? CACHE_SCRATCH_SIZE : length;
+        if (CY_RSLT_SUCCESS != cy_serial_flash_qspi_read(address + sizeof(header) + strings + done,
+                                                        length, scratch))
+        {
+            memset(slot, 0, sizeof(*slot));
+            return false;
+        }
+        crc = inflater_crc32(crc, scratch, length);
+    }
+
+    if (crc != stored_crc)
+    {
+        memset(slot, 0, sizeof(*slot));
+        return false;
+    }
+
+    slot->valid = true;
+    slot->seq = header.seq;
+    slot->max_age_s = header.max_age_s;
+    slot->last_used = header.seq;
+    slot->body_offset = sizeof(header) + strings;
+    slot->body_len = header.body_len;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: find_slot
+ *******************************************************************************
+ * Summary:
+ *  Returns the valid entry of a path, or NULL.
+ *
+ *******************************************************************************/
+static cache_slot_t *find_slot(const char *path)
+{
+    for (uint32_t i = 0; i < RESPONSE_CACHE_NUM_SLOTS; i++)
+    {
+        if (slots[i].valid && (0 == strcmp(slots[i].path, path)))
+        {
+            return &slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: victim_slot
+ *******************************************************************************
+ * Summary:
+ *  Returns a free slot, or else the least recently used entry.
+ *
+ *******************************************************************************/
+static cache_slot_t *victim_slot(void)
+{
+    cache_slot_t *victim = &slots[0];
+
+    for (uint32_t i = 0; i < RESPONSE_CACHE_NUM_SLOTS; i++)
+    {
+        if (!slots[i].valid)
+        {
+            return &slots[i];
+        }
+        if (slots[i].last_used < victim->last_used)
+        {
+            victim = &slots[i];
+        }
+    }
+
+    return victim;
+}
+
+/*******************************************************************************
+ * Function Name: copy_header
+ *******************************************************************************
+ * Summary:
+ *  Copies a header value as a string. A missing value is an empty string.
+ *
+ * Return:
+ *  bool: false if the value does not fit.
+ *
+ *******************************************************************************/
+static bool copy_header(char *dest, size_t size, const char *value, size_t length)
+{
+    if (NULL == value)
+    {
+        length = 0;
+    }
+
+    if (length >= size)
+    {
+        return false;
+    }
+
+    if (0u != length)
+    {
+        memcpy(dest, value, length);
+    }
+    dest[length] = '\0';
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_max_age
+ *******************************************************************************
+ * Summary:
+ *  Returns the max-age of a Cache-Control header, capped at
+ *  RESPONSE_CACHE_MAX_AGE_LIMIT_S. "no-cache" is a max-age of 0.
+ *
+ * Return:
+ *  int32_t: The max-age in seconds, or -1 if there is none.
+ *
+ *******************************************************************************/
+static int32_t parse_max_age(const char *value, size_t length)
+{
+    static const char directive[] = "max-age=";
+    uint32_t max_age = 0;
+    size_t index;
+    bool found = false;
+
+    if (NULL == value)
+    {
+        return -1;
+    }
+
+    if (has_directive(value, length, "no-cache"))
+    {
+        return 0;
+    }
+
+    for (index = 0; (index + sizeof(directive) - 1u) < length; index++)
+    {
+        /* s-maxage applies to shared caches only. */
+        if ((0 == strncmp(&value[index], directive, sizeof(directive) - 1u)) &&
+            ((0u == index) || ('-' != value[index - 1u])))
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        return -1;
+    }
+
+    for (index += sizeof(directive) - 1u; (index < length) && (value[index] >= '0') && (value[index] <= '9'); index++)
+    {
+        if (max_age < RESPONSE_CACHE_MAX_AGE_LIMIT_S)
+        {
+            max_age = (max_age * 10u) + (uint32_t)(value[index] - '0');
+        }
+    }
+
+    return (int32_t)((max_age > RESPONSE_CACHE_MAX_AGE_LIMIT_S) ? RESPONSE_CACHE_MAX_AGE_LIMIT_S : max_age);
+}
+
+/*******************************************************************************
+ * Function Name: has_directive
+ *******************************************************************************
+ * Summary:
+ *  Tells whether a Cache-Control header, which is not NUL-terminated,
+ *  contains a directive.
+ *
+ *******************************************************************************/
+static bool has_directive(const char *value, size_t length, const char *directive)
+{
+    size_t directive_len = strlen(directive);
+
+    for (size_t index = 0; (NULL != value) && ((index + directive_len) <= length); index++)
+    {
+        if (0 == strncmp(&value[index], directive, directive_len))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: slot_address
+ *******************************************************************************
+ * Summary:
+ *  Returns the flash address of the sector of a slot.
+ *
+ *******************************************************************************/
+static uint32_t slot_address(const cache_slot_t *slot)
+{
+    return RESPONSE_CACHE_FLASH_ADDRESS + ((uint32_t)(slot - slots) * sector_size);
+}
+
+/*******************************************************************************
+ * Function Name: trace_response
+ *******************************************************************************
+ * Summary:
+ *  Builds the 200 response of the simulated origin for a version of a
+ *  resource: the body in trace_body and the caching headers.
+ *
+ * Return:
+ *  uint32_t: Length of the body.
+ *
+ *******************************************************************************/
+static uint32_t trace_response(const trace_resource_t *resource, uint32_t version,
+                               response_cache_headers_t *headers, char *cache_control, char *etag)
+{
+    uint32_t seed = (uint32_t)(resource - trace_resources) * 0x9E3779B9u + version + 1u;
+
+    for (uint32_t i = 0; i < resource->size; i++)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        trace_body[i] = (uint8_t)(seed >> 16);
+    }
+
+    memset(headers, 0, sizeof(*headers));
+
+    if (TRACE_NO_STORE == resource->max_age_s)
+    {
+        strcpy(cache_control, "no-store");
+    }
+    else if (0 == resource->max_age_s)
+    {
+        strcpy(cache_control, "no-cache");
+    }
+    else
+    {
+        sprintf(cache_control, "max-age=%ld", (long)resource->max_age_s);
+    }
+    headers->cache_control = cache_control;
+    headers->cache_control_len = strlen(cache_control);
+
+    if (resource->by_date)
+    {
+        headers->last_modified = TRACE_LAST_MODIFIED;
+        headers->last_modified_len = sizeof(TRACE_LAST_MODIFIED) - 1u;
+        etag[0] = '\0';
+    }
+    else
+    {
+        sprintf(etag, "\"%lu-%lu\"", (unsigned long)(resource - trace_resources), (unsigned long)version);
+        headers->etag = etag;
+        headers->etag_len = strlen(etag);
+    }
+
+    return resource->size;
+}
+
+/* [] END OF FILE */
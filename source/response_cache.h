@@ -0,0 +1,153 @@
+/******************************************************************************
+* File Name: response_cache.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the response cache, which keeps GET responses and their
+* validators in the external flash for conditional requests.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef RESPONSE_CACHE_H_
+#define RESPONSE_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cy_result.h"
+#include "secure_http_client.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Location of the cache in the external flash, after the offline queue.
+ * Each entry takes a whole erase sector, so that replacing it never touches
+ * another entry.
+ */
+#define RESPONSE_CACHE_FLASH_ADDRESS             (0x01200000UL)
+#define RESPONSE_CACHE_NUM_SLOTS                 (8)
+
+/* Largest path, ETag, and body kept. A body must fit in the response buffer
+ * of the HTTP client to be cached, after the head that is rebuilt for it
+ * when it is served: the status line, Content-Length, and the validators.
+ */
+#define RESPONSE_CACHE_MAX_PATH_LEN              (64)
+#define RESPONSE_CACHE_MAX_ETAG_LEN              (48)
+#define RESPONSE_CACHE_DATE_LEN                  (29)
+#define RESPONSE_CACHE_HEAD_ROOM                 (160)
+#define RESPONSE_CACHE_MAX_BODY_LEN              (HTTP_GET_BUFFER_LENGTH - RESPONSE_CACHE_HEAD_ROOM)
+
+/* Longest max-age honoured, so that the age fits in the tick count. */
+#define RESPONSE_CACHE_MAX_AGE_LIMIT_S           (7u * 24u * 3600u)
+
+/* "Response cache" menu option: a trace of GET requests at random intervals
+ * around the mean, replayed against a simulated origin, with a reboot half
+ * way through.
+ */
+#define RESPONSE_CACHE_TRACE_REQUESTS            (400u)
+#define RESPONSE_CACHE_TRACE_INTERVAL_MS         (15000u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    RESPONSE_CACHE_MISS = 0,
+    RESPONSE_CACHE_FRESH,        /* Served without a request. */
+    RESPONSE_CACHE_STALE,        /* Revalidated with a conditional request. */
+} response_cache_state_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Result of response_cache_lookup(). The validators are copies, and seq
+ * tells whether the entry was replaced before the response arrived.
+ */
+typedef struct
+{
+    response_cache_state_t state;
+    uint32_t slot;
+    uint32_t seq;
+    uint32_t body_len;
+    char etag[RESPONSE_CACHE_MAX_ETAG_LEN + 1];              /* Empty if there is none. */
+    char last_modified[RESPONSE_CACHE_DATE_LEN + 1];         /* Empty if there is none. */
+} response_cache_lookup_t;
+
+/* Caching headers of a response. A NULL value is a missing header. */
+typedef struct
+{
+    const char *cache_control;
+    size_t cache_control_len;
+    const char *etag;
+    size_t etag_len;
+    const char *last_modified;
+    size_t last_modified_len;
+} response_cache_headers_t;
+
+/* Counters since the start of the application. */
+typedef struct
+{
+    uint32_t lookups;
+    uint32_t fresh;              /* Served from the cache without a request. */
+    uint32_t not_modified;       /* Served from the cache after a 304. */
+    uint32_t misses;
+    uint32_t stored;             /* Entries written to the flash. */
+    uint32_t evicted;            /* Entries replaced by another resource. */
+    uint32_t uncacheable;        /* Responses that could not be stored. */
+    uint32_t bytes_saved;        /* Body bytes served from the cache. */
+    uint32_t bytes_fetched;      /* Body bytes received with a 200. */
+} response_cache_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t response_cache_init(void);
+void response_cache_lookup(const char *path, uint32_t now_ms, response_cache_lookup_t *lookup);
+uint32_t response_cache_read(const response_cache_lookup_t *lookup, uint8_t *buffer, uint32_t size);
+bool response_cache_not_modified(const response_cache_lookup_t *lookup, uint32_t now_ms,
+                                 const response_cache_headers_t *headers);
+bool response_cache_store(const char *path, uint32_t now_ms, const response_cache_headers_t *headers,
+                          const uint8_t *body, uint32_t body_len);
+void response_cache_invalidate(const char *path);
+void response_cache_get_stats(response_cache_stats_t *stats);
+void response_cache_replay_trace(void);
+
+#endif /* RESPONSE_CACHE_H_ */
+
+
+/* [] END OF FILE */
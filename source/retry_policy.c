@@ -0,0 +1,822 @@
+/******************************************************************************
+* File Name: retry_policy.c
+*
+* Description: This file contains the retry policy of the HTTPS requests:
+* the classification of the failures that can be retried, full-jitter
+* exponential backoff within a budget, and the Retry-After of 429 and 503
+* responses. It also holds the fault injector and the demo of the policy.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "xorshift.h"
+#include "retry_policy.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define SECONDS_PER_DAY                  (86400u)
+
+/* Longest Retry-After in seconds that still fits in ms. */
+#define MAX_RETRY_AFTER_S                (RETRY_AFTER_NONE / 1000u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* A device of the simulated fleet. */
+typedef struct
+{
+    retry_state_t state;
+    uint32_t next_ms;            /* Time of the next attempt. */
+    uint32_t done_ms;            /* Time the request was served, 0 if it was not. */
+    bool finished;
+} sim_device_t;
+
+/* Strategy compared by the simulation. */
+typedef struct
+{
+    const char *name;
+    retry_policy_t policy;
+    bool retry_after;            /* The server sends Retry-After with its 503. */
+} sim_strategy_t;
+
+#if defined(RETRY_FAULT_INJECTION)
+/* Scenario of the demo. */
+typedef struct
+{
+    const char *name;
+    cy_http_client_method_t method;
+    const retry_policy_t *policy;
+    retry_fault_t faults[RETRY_MAX_FAULTS];
+    uint32_t fault_count;
+} demo_scenario_t;
+#endif /* RETRY_FAULT_INJECTION */
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+const retry_policy_t retry_default_policy =
+{
+    .max_attempts = RETRY_DEFAULT_MAX_ATTEMPTS,
+    .base_delay_ms = RETRY_DEFAULT_BASE_DELAY_MS,
+    .max_delay_ms = RETRY_DEFAULT_MAX_DELAY_MS,
+    .budget_ms = RETRY_DEFAULT_BUDGET_MS,
+    .retry_unsafe = false,
+};
+
+/* State of the jitter generator, seeded on first use. Tasks may race on it,
+ * which only makes the delays more random.
+ */
+static uint32_t random_state;
+
+static sim_device_t sim_devices[RETRY_SIM_DEVICES];
+
+#if defined(RETRY_FAULT_INJECTION)
+/* Faults queued by retry_fault_inject(). */
+static retry_fault_t faults[RETRY_MAX_FAULTS];
+static uint32_t fault_count;
+static uint32_t fault_index;
+
+/* Policy of the demo scenarios that opt in to retrying a POST. */
+static const retry_policy_t demo_unsafe_policy =
+{
+    .max_attempts = RETRY_DEFAULT_MAX_ATTEMPTS,
+    .base_delay_ms = RETRY_DEFAULT_BASE_DELAY_MS,
+    .max_delay_ms = RETRY_DEFAULT_MAX_DELAY_MS,
+    .budget_ms = RETRY_DEFAULT_BUDGET_MS,
+    .retry_unsafe = true,
+};
+
+static uint32_t demo_status;
+#endif /* RETRY_FAULT_INJECTION */
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static bool is_transient(uint32_t status);
+static uint32_t backoff_delay(const retry_state_t *state);
+static bool schedule(retry_state_t *state, uint32_t delay_ms);
+static uint32_t next_random(void);
+static bool parse_uint(const char *value, size_t length, uint32_t *number);
+static bool parse_http_date(const char *value, size_t length, uint32_t *seconds);
+static void simulate(const sim_strategy_t *strategy);
+#if defined(RETRY_FAULT_INJECTION)
+static void record_status(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+#endif
+
+/*******************************************************************************
+ * Function Name: retry_state_init
+ *******************************************************************************
+ * Summary:
+ *  Starts the retry state of a request.
+ *
+ * Parameters:
+ *  state - State to initialize.
+ *  policy - Policy of the request, NULL for a single attempt.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void retry_state_init(retry_state_t *state, const retry_policy_t *policy)
+{
+    memset(state, 0, sizeof(*state));
+    state->policy = policy;
+}
+
+/*******************************************************************************
+ * Function Name: retry_check
+ *******************************************************************************
+ * Summary:
+ *  Counts an attempt of a request and decides whether to retry it. Failures
+ *  before the request was sent, 429 responses, which the server did not
+ *  process, and the transient 502, 503, and 504 responses of idempotent
+ *  requests are retried. Other methods are retried after a failure or a
+ *  5xx response only if the policy opts in. The Retry-After of a 429 or 503
+ *  response replaces the backoff, plus a jitter of up to the base delay.
+ *
+ * Parameters:
+ *  state - Retry state of the request.
+ *  method - Method of the request.
+ *  result - Result of the attempt, CY_RSLT_SUCCESS if a response arrived.
+ *  sent - The request may have reached the server.
+ *  status - Status of the response, if there was one.
+ *  retry_after_ms - Retry-After of the response, or RETRY_AFTER_NONE.
+ *
+ * Return:
+ *  bool: true if the request is to be sent again after state->delay_ms.
+ *
+ *******************************************************************************/
+bool retry_check(retry_state_t *state, cy_http_client_method_t method, cy_rslt_t result,
+                 bool sent, uint32_t status, uint32_t retry_after_ms)
+{
+    bool safe = retry_is_idempotent(method) ||
+                ((NULL != state->policy) && state->policy->retry_unsafe);
+    uint32_t delay_ms;
+
+    state->pending = false;
+    state->status = (CY_RSLT_SUCCESS == result) ? status : 0u;
+
+    if (NULL == state->policy)
+    {
+        state->attempts++;
+        return false;
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        if (!is_transient(status) || (!safe && (HTTP_STATUS_TOO_MANY_REQUESTS != status)))
+        {
+            state->attempts++;
+            return false;
+        }
+    }
+    else if (sent && !safe)
+    {
+        state->attempts++;
+        return false;
+    }
+
+    if ((RETRY_AFTER_NONE == retry_after_ms) ||
+        ((HTTP_STATUS_TOO_MANY_REQUESTS != status) && (HTTP_STATUS_SERVICE_UNAVAILABLE != status)))
+    {
+        return retry_next_delay(state);
+    }
+
+    state->attempts++;
+    delay_ms = retry_after_ms;
+    if (0u != state->policy->base_delay_ms)
+    {
+        delay_ms += next_random() % (state->policy->base_delay_ms + 1u);
+    }
+    if (schedule(state, delay_ms))
+    {
+        state->retry_after_count++;
+        return true;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: retry_next_delay
+ *******************************************************************************
+ * Summary:
+ *  Counts a failed attempt of an operation that can always be retried, such
+ *  as joining the AP, and picks the backoff before the next attempt.
+ *
+ * Parameters:
+ *  state - Retry state of the operation.
+ *
+ * Return:
+ *  bool: true if the operation is to be retried after state->delay_ms,
+ *  false if the attempts or the budget of the policy are exhausted.
+ *
+ *******************************************************************************/
+bool retry_next_delay(retry_state_t *state)
+{
+    state->attempts++;
+    state->pending = false;
+
+    if (NULL == state->policy)
+    {
+        return false;
+    }
+
+    return schedule(state, backoff_delay(state));
+}
+
+/*******************************************************************************
+ * Function Name: retry_is_idempotent
+ *******************************************************************************
+ * Summary:
+ *  Tells whether sending a request twice has the same effect as sending it
+ *  once (RFC 9110, section 9.2.2).
+ *
+ * Parameters:
+ *  method - Method of the request.
+ *
+ * Return:
+ *  bool: true for GET, HEAD, PUT, DELETE, OPTIONS, and TRACE.
+ *
+ *******************************************************************************/
+bool retry_is_idempotent(cy_http_client_method_t method)
+{
+    switch (method)
+    {
+        case CY_HTTP_CLIENT_METHOD_GET:
+        case CY_HTTP_CLIENT_METHOD_HEAD:
+        case CY_HTTP_CLIENT_METHOD_PUT:
+        case CY_HTTP_CLIENT_METHOD_DELETE:
+        case CY_HTTP_CLIENT_METHOD_OPTIONS:
+        case CY_HTTP_CLIENT_METHOD_TRACE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: retry_parse_after
+ *******************************************************************************
+ * Summary:
+ *  Parses a Retry-After header, in delay-seconds or as an HTTP-date. The
+ *  device has no wall clock, so a date is taken relative to the Date header
+ *  of the same response.
+ *
+ * Parameters:
+ *  value - Value of the Retry-After header.
+ *  length - Length of the value.
+ *  date - Value of the Date header, NULL if there is none.
+ *  date_length - Length of the Date header.
+ *
+ * Return:
+ *  uint32_t: The delay in ms, or RETRY_AFTER_NONE if it cannot be parsed.
+ *
+ *******************************************************************************/
+uint32_t retry_parse_after(const char *value, size_t length, const char *date, size_t date_length)
+{
+    uint32_t seconds;
+    uint32_t retry_at;
+    uint32_t now;
+
+    if (!parse_uint(value, length, &seconds))
+    {
+        if ((NULL == date) || !parse_http_date(value, length, &retry_at) ||
+            !parse_http_date(date, date_length, &now))
+        {
+            return RETRY_AFTER_NONE;
+        }
+        seconds = (retry_at > now) ? (retry_at - now) : 0u;
+    }
+
+    if (seconds >= MAX_RETRY_AFTER_S)
+    {
+        seconds = MAX_RETRY_AFTER_S - 1u;
+    }
+
+    return seconds * 1000u;
+}
+
+#if defined(RETRY_FAULT_INJECTION)
+/*******************************************************************************
+ * Function Name: retry_fault_inject
+ *******************************************************************************
+ * Summary:
+ *  Queues faults that replace the outcome of the next attempts of
+ *  https_send_request(), in order, whichever task sends them. An attempt
+ *  with RETRY_FAULT_NONE is sent normally.
+ *
+ * Parameters:
+ *  list - Faults to inject, copied.
+ *  count - Number of faults, at most RETRY_MAX_FAULTS. 0 clears the queue.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void retry_fault_inject(const retry_fault_t *list, uint32_t count)
+{
+    taskENTER_CRITICAL();
+
+    fault_count = (count > RETRY_MAX_FAULTS) ? RETRY_MAX_FAULTS : count;
+    fault_index = 0;
+    if (0u != fault_count)
+    {
+        memcpy(faults, list, fault_count * sizeof(faults[0]));
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: retry_fault_take
+ *******************************************************************************
+ * Summary:
+ *  Takes the next queued fault.
+ *
+ * Parameters:
+ *  fault - Filled with the fault.
+ *
+ * Return:
+ *  bool: true if a fault was queued.
+ *
+ *******************************************************************************/
+bool retry_fault_take(retry_fault_t *fault)
+{
+    bool taken = false;
+
+    taskENTER_CRITICAL();
+
+    if (fault_index < fault_count)
+    {
+        *fault = faults[fault_index++];
+        taken = true;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return taken;
+}
+
+#endif /* RETRY_FAULT_INJECTION */
+
+/*******************************************************************************
+ * Function Name: retry_policy_simulate
+ *******************************************************************************
+ * Summary:
+ *  Simulates RETRY_SIM_DEVICES devices that each send one request at a
+ *  random time in the first second, while the server is down for
+ *  RETRY_SIM_OUTAGE_MS and then serves RETRY_SIM_CAPACITY requests per
+ *  RETRY_SIM_SLOT_MS, and prints the load and completion times for
+ *  immediate retries, full-jitter backoff, and full-jitter backoff with
+ *  Retry-After.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void retry_policy_simulate(void)
+{
+    static const sim_strategy_t strategies[] =
+    {
+        { "immediate",   { RETRY_SIM_MAX_ATTEMPTS, 0u, 0u, RETRY_SIM_BUDGET_MS, false }, false },
+        { "full jitter", { RETRY_SIM_MAX_ATTEMPTS, RETRY_DEFAULT_BASE_DELAY_MS, RETRY_DEFAULT_MAX_DELAY_MS,
+                           RETRY_SIM_BUDGET_MS, false }, false },
+        { "retry-after", { RETRY_SIM_MAX_ATTEMPTS, RETRY_DEFAULT_BASE_DELAY_MS, RETRY_DEFAULT_MAX_DELAY_MS,
+                           RETRY_SIM_BUDGET_MS, false }, true },
+    };
+
+    APP_INFO(("%lu devices, server down for %lu ms, then %lu requests per %lu ms, %lu attempts\n",
+              (unsigned long)RETRY_SIM_DEVICES, (unsigned long)RETRY_SIM_OUTAGE_MS,
+              (unsigned long)RETRY_SIM_CAPACITY, (unsigned long)RETRY_SIM_SLOT_MS,
+              (unsigned long)RETRY_SIM_MAX_ATTEMPTS));
+    printf("\n  %-12s %8s %9s %7s %7s %8s %8s\n", "strategy", "attempts", "peak/slot",
+           "served", "gave up", "p50 ms", "last ms");
+
+    for (uint32_t i = 0; i < (sizeof(strategies) / sizeof(strategies[0])); i++)
+    {
+        simulate(&strategies[i]);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: retry_policy_demo
+ *******************************************************************************
+ * Summary:
+ *  Sends requests to RETRY_DEMO_PATH with faults injected in front of the
+ *  server and prints how the policy handled each scenario. Built only
+ *  with RETRY_FAULT_INJECTION.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void retry_policy_demo(void)
+{
+#if defined(RETRY_FAULT_INJECTION)
+    static const demo_scenario_t scenarios[] =
+    {
+        { "GET after 3 faults", CY_HTTP_CLIENT_METHOD_GET, &retry_default_policy,
+          { { RETRY_FAULT_CONNECT, 0u, 0u }, { RETRY_FAULT_RESET, 0u, 0u },
+            { RETRY_FAULT_STATUS, HTTP_STATUS_SERVICE_UNAVAILABLE, 1u } }, 3u },
+        { "GET, 503 for 60 s", CY_HTTP_CLIENT_METHOD_GET, &retry_default_policy,
+          { { RETRY_FAULT_STATUS, HTTP_STATUS_SERVICE_UNAVAILABLE, 60u } }, 1u },
+        { "PUT, server down", CY_HTTP_CLIENT_METHOD_PUT, &retry_default_policy,
+          { { RETRY_FAULT_CONNECT, 0u, 0u }, { RETRY_FAULT_CONNECT, 0u, 0u },
+            { RETRY_FAULT_CONNECT, 0u, 0u }, { RETRY_FAULT_CONNECT, 0u, 0u } }, 4u },
+        { "POST, reset", CY_HTTP_CLIENT_METHOD_POST, &retry_default_policy,
+          { { RETRY_FAULT_RESET, 0u, 0u } }, 1u },
+        { "POST, 429", CY_HTTP_CLIENT_METHOD_POST, &retry_default_policy,
+          { { RETRY_FAULT_STATUS, HTTP_STATUS_TOO_MANY_REQUESTS, 1u } }, 1u },
+        { "POST opt-in, reset", CY_HTTP_CLIENT_METHOD_POST, &demo_unsafe_policy,
+          { { RETRY_FAULT_RESET, 0u, 0u } }, 1u },
+    };
+    https_request_t request = {0};
+    retry_state_t state;
+    cy_rslt_t result;
+    uint32_t start;
+
+    request.path = RETRY_DEMO_PATH;
+    request.body = (const uint8_t *)REQUEST_BODY;
+    request.body_len = REQUEST_BODY_LENGTH;
+    request.response_cb = record_status;
+    request.quiet = true;
+
+    printf("\n  %-20s %8s %9s %10s %6s %10s\n", "scenario", "attempts", "waited ms", "elapsed ms",
+           "status", "result");
+
+    for (uint32_t i = 0; i < (sizeof(scenarios) / sizeof(scenarios[0])); i++)
+    {
+        request.method = scenarios[i].method;
+        request.retry = scenarios[i].policy;
+        demo_status = 0;
+
+        retry_fault_inject(scenarios[i].faults, scenarios[i].fault_count);
+        start = (uint32_t)xTaskGetTickCount();
+        result = https_send_request(&request);
+        start = ((uint32_t)xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        retry_fault_inject(NULL, 0);
+
+        https_last_retry(&state);
+        printf("  %-20s %8lu %9lu %10lu %6lu 0x%08lx\n", scenarios[i].name, (unsigned long)state.attempts,
+               (unsigned long)state.waited_ms, (unsigned long)start, (unsigned long)demo_status,
+               (unsigned long)result);
+    }
+#else
+    APP_INFO(("Injected faults need a build with RETRY_FAULT_INJECTION defined.\n"));
+#endif /* RETRY_FAULT_INJECTION */
+}
+
+/*******************************************************************************
+ * Function Name: is_transient
+ *******************************************************************************
+ * Summary:
+ *  Tells whether a response status may succeed on a later attempt.
+ *
+ *******************************************************************************/
+static bool is_transient(uint32_t status)
+{
+    return (HTTP_STATUS_TOO_MANY_REQUESTS == status) || (HTTP_STATUS_BAD_GATEWAY == status) ||
+           (HTTP_STATUS_SERVICE_UNAVAILABLE == status) || (HTTP_STATUS_GATEWAY_TIMEOUT == status);
+}
+
+/*******************************************************************************
+ * Function Name: backoff_delay
+ *******************************************************************************
+ * Summary:
+ *  Returns a random delay between 0 and the exponential backoff of the
+ *  attempts made so far ("full jitter").
+ *
+ *******************************************************************************/
+static uint32_t backoff_delay(const retry_state_t *state)
+{
+    uint32_t ceiling = state->policy->base_delay_ms;
+
+    for (uint32_t i = 1; (i < state->attempts) && (ceiling < state->policy->max_delay_ms); i++)
+    {
+        ceiling <<= 1;
+    }
+    if (ceiling > state->policy->max_delay_ms)
+    {
+        ceiling = state->policy->max_delay_ms;
+    }
+
+    return (0u == ceiling) ? 0u : (next_random() % (ceiling + 1u));
+}
+
+/*******************************************************************************
+ * Function Name: schedule
+ *******************************************************************************
+ * Summary:
+ *  Schedules the next attempt after a delay if the attempts and the budget
+ *  of the policy allow it.
+ *
+ *******************************************************************************/
+static bool schedule(retry_state_t *state, uint32_t delay_ms)
+{
+    if ((state->attempts >= state->policy->max_attempts) ||
+        (delay_ms > (state->policy->budget_ms - state->waited_ms)))
+    {
+        return false;
+    }
+
+    state->delay_ms = delay_ms;
+    state->waited_ms += delay_ms;
+    state->pending = true;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *  Returns the next value of the jitter generator, seeded on first use.
+ *
+ *******************************************************************************/
+static uint32_t next_random(void)
+{
+    if (0u == random_state)
+    {
+        random_state = xorshift_seed();
+    }
+
+    return xorshift_next(&random_state);
+}
+
+/*******************************************************************************
+ * Function Name: parse_uint
+ *******************************************************************************
+ * Summary:
+ *  Parses a decimal number surrounded by optional whitespace, saturating
+ *  at MAX_RETRY_AFTER_S.
+ *
+ *******************************************************************************/
+static bool parse_uint(const char *value, size_t length, uint32_t *number)
+{
+    size_t index = 0;
+    size_t digits = 0;
+
+    *number = 0;
+
+    while ((index < length) && (' ' == value[index]))
+    {
+        index++;
+    }
+
+    for (; (index < length) && (value[index] >= '0') && (value[index] <= '9'); index++, digits++)
+    {
+        if (*number < MAX_RETRY_AFTER_S)
+        {
+            *number = (*number * 10u) + (uint32_t)(value[index] - '0');
+        }
+    }
+
+    while ((index < length) && (' ' == value[index]))
+    {
+        index++;
+    }
+
+    return (0u != digits) && (index == length);
+}
+
+/*******************************************************************************
+ * Function Name: parse_http_date
+ *******************************************************************************
+ * Summary:
+ *  Parses an IMF-fixdate, such as "Sun, 06 Nov 1994 08:49:37 GMT", into
+ *  seconds since 1970, the only date format servers may send.
+ *
+ *******************************************************************************/
+static bool parse_http_date(const char *value, size_t length, uint32_t *seconds)
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char text[32];
+    char month[4];
+    unsigned int day;
+    unsigned int year;
+    unsigned int hour;
+    unsigned int minute;
+    unsigned int second;
+    const char *found;
+    uint32_t m;
+    uint32_t y;
+    uint32_t era_day;
+
+    if (length >= sizeof(text))
+    {
+        return false;
+    }
+    memcpy(text, value, length);
+    text[length] = '\0';
+
+    if ((6 != sscanf(text, "%*3s, %2u %3s %4u %2u:%2u:%2u GMT", &day, month, &year, &hour, &minute, &second)) ||
+        (year < 1970u) || (day < 1u) || (day > 31u) || (hour > 23u) || (minute > 59u) || (second > 60u))
+    {
+        return false;
+    }
+
+    month[3] = '\0';
+    found = strstr(months, month);
+    if ((NULL == found) || (0 != ((found - months) % 3)))
+    {
+        return false;
+    }
+
+    /* Days since 1970 of the proleptic Gregorian calendar, counting years
+     * from March so that the leap day is last.
+     */
+    m = (uint32_t)((found - months) / 3) + 1u;
+    y = year - ((m <= 2u) ? 1u : 0u);
+    era_day = (365u * y) + (y / 4u) - (y / 100u) + (y / 400u) +
+              (((153u * ((m > 2u) ? (m - 3u) : (m + 9u))) + 2u) / 5u) + day - 1u;
+
+    *seconds = ((era_day - 719468u) * SECONDS_PER_DAY) + (hour * 3600u) + (minute * 60u) + second;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: simulate
+ *******************************************************************************
+ * Summary:
+ *  Runs the fleet for one strategy, one slot at a time. In each slot after
+ *  the outage, the first RETRY_SIM_CAPACITY attempts are served and the
+ *  others get a 503. Its Retry-After, if sent, is the time until the server
+ *  has capacity for the request after those it already rejected.
+ *
+ *******************************************************************************/
+static void simulate(const sim_strategy_t *strategy)
+{
+    uint32_t attempts = 0;
+    uint32_t peak = 0;
+    uint32_t served = 0;
+    uint32_t gave_up = 0;
+    uint32_t remaining = RETRY_SIM_DEVICES;
+    uint32_t booked_ms = 0;
+    uint32_t in_slot;
+    uint32_t retry_after_ms;
+    uint32_t value;
+    uint32_t j;
+    sim_device_t *device;
+    bool progress;
+    bool retry;
+
+    for (uint32_t i = 0; i < RETRY_SIM_DEVICES; i++)
+    {
+        retry_state_init(&sim_devices[i].state, &strategy->policy);
+        sim_devices[i].next_ms = next_random() % 1000u;
+        sim_devices[i].done_ms = 0;
+        sim_devices[i].finished = false;
+    }
+
+    for (uint32_t slot_ms = 0; 0u != remaining; slot_ms += RETRY_SIM_SLOT_MS)
+    {
+        in_slot = 0;
+
+        /* A device that retries within the slot is seen again in the next
+         * pass, so every attempt of the slot counts against the capacity.
+         */
+        do
+        {
+            progress = false;
+
+            for (uint32_t i = 0; i < RETRY_SIM_DEVICES; i++)
+            {
+                device = &sim_devices[i];
+                if (device->finished || (device->next_ms >= (slot_ms + RETRY_SIM_SLOT_MS)))
+                {
+                    continue;
+                }
+
+                progress = true;
+                in_slot++;
+                if (slot_ms < RETRY_SIM_OUTAGE_MS)
+                {
+                    retry = retry_check(&device->state, CY_HTTP_CLIENT_METHOD_PUT, CY_RSLT_TYPE_ERROR,
+                                        false, 0, RETRY_AFTER_NONE);
+                }
+                else if (in_slot <= RETRY_SIM_CAPACITY)
+                {
+                    device->state.attempts++;
+                    device->done_ms = device->next_ms + RETRY_SIM_RTT_MS;
+                    device->finished = true;
+                    served++;
+                    remaining--;
+                    continue;
+                }
+                else
+                {
+                    /* Each rejected request is promised a later place. */
+                    booked_ms = ((booked_ms > slot_ms) ? booked_ms : slot_ms) +
+                                (RETRY_SIM_SLOT_MS / RETRY_SIM_CAPACITY);
+                    retry_after_ms = (((booked_ms - slot_ms) + 999u) / 1000u) * 1000u;
+                    retry = retry_check(&device->state, CY_HTTP_CLIENT_METHOD_PUT, CY_RSLT_SUCCESS, true,
+                                        HTTP_STATUS_SERVICE_UNAVAILABLE,
+                                        strategy->retry_after ? retry_after_ms : RETRY_AFTER_NONE);
+                }
+
+                if (retry)
+                {
+                    device->next_ms += RETRY_SIM_RTT_MS + device->state.delay_ms;
+                }
+                else
+                {
+                    device->finished = true;
+                    gave_up++;
+                    remaining--;
+                }
+            }
+        } while (progress);
+
+        attempts += in_slot;
+        peak = (in_slot > peak) ? in_slot : peak;
+    }
+
+    /* Sort the completion times of the served devices for the median. */
+    for (uint32_t i = 1; i < RETRY_SIM_DEVICES; i++)
+    {
+        value = sim_devices[i].done_ms;
+        for (j = i; (j > 0u) && (sim_devices[j - 1u].done_ms > value); j--)
+        {
+            sim_devices[j].done_ms = sim_devices[j - 1u].done_ms;
+        }
+        sim_devices[j].done_ms = value;
+    }
+
+    printf("  %-12s %8lu %9lu %7lu %7lu %8lu %8lu\n", strategy->name, (unsigned long)attempts,
+           (unsigned long)peak, (unsigned long)served, (unsigned long)gave_up,
+           (unsigned long)((0u == served) ? 0u : sim_devices[RETRY_SIM_DEVICES - served + ((served - 1u) / 2u)].done_ms),
+           (unsigned long)sim_devices[RETRY_SIM_DEVICES - 1u].done_ms);
+}
+
+#if defined(RETRY_FAULT_INJECTION)
+/*******************************************************************************
+ * Function Name: record_status
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the demo requests. Records the status of the
+ *  response that was delivered.
+ *
+ *******************************************************************************/
+static void record_status(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    (void)handle;
+    (void)arg;
+
+    demo_status = response->status_code;
+}
+#endif /* RETRY_FAULT_INJECTION */
+
+/* [] END OF FILE */
@@ -0,0 +1,163 @@
+/******************************************************************************
+* File Name: retry_policy.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the retry policy, which decides whether a failed request is
+* sent again and how long to wait first.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef RETRY_POLICY_H_
+#define RETRY_POLICY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Policy used by http_request(): four attempts, backing off from 250 ms up
+ * to 8 s, within 20 s of waiting in total.
+ */
+#define RETRY_DEFAULT_MAX_ATTEMPTS               (4u)
+#define RETRY_DEFAULT_BASE_DELAY_MS              (250u)
+#define RETRY_DEFAULT_MAX_DELAY_MS               (8000u)
+#define RETRY_DEFAULT_BUDGET_MS                  (20000u)
+
+/* Longest backoff between two attempts to join the AP. */
+#define RETRY_WIFI_MAX_DELAY_MS                  (16000u)
+
+/* Returned by retry_parse_after() when there is no usable Retry-After. */
+#define RETRY_AFTER_NONE                         (0xFFFFFFFFu)
+
+/* Faults that can be queued with retry_fault_inject(). The injection is
+ * test-only and is built only when RETRY_FAULT_INJECTION is defined, see
+ * the Makefile; otherwise the menu demo of injected faults is skipped.
+ */
+#define RETRY_MAX_FAULTS                         (8)
+
+/* "Retry policy" menu option. The simulation runs a fleet of devices whose
+ * requests hit a server that is down for the outage and then answers
+ * 503 to the requests over its capacity in each slot.
+ */
+#define RETRY_DEMO_PATH                          "/"
+#define RETRY_SIM_DEVICES                        (200u)
+#define RETRY_SIM_OUTAGE_MS                      (2000u)
+#define RETRY_SIM_SLOT_MS                        (100u)
+#define RETRY_SIM_CAPACITY                       (5u)
+#define RETRY_SIM_RTT_MS                         (50u)
+#define RETRY_SIM_MAX_ATTEMPTS                   (12u)
+#define RETRY_SIM_BUDGET_MS                      (60000u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+/* Fault injected in place of an attempt of https_send_request(). */
+typedef enum
+{
+    RETRY_FAULT_NONE = 0,
+    RETRY_FAULT_CONNECT,         /* The connection fails before the request is sent. */
+    RETRY_FAULT_RESET,           /* The connection drops after the request is sent. */
+    RETRY_FAULT_STATUS,          /* The response has the status and Retry-After of the fault. */
+} retry_fault_kind_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Retry policy of a request. A failed attempt is retried after a random
+ * delay between 0 and base_delay_ms * 2^(attempt - 1), capped at
+ * max_delay_ms, or after the Retry-After of a 429 or 503 response, as long
+ * as the delays stay within budget_ms in total.
+ */
+typedef struct
+{
+    uint32_t max_attempts;       /* Including the first, 1 for no retry. */
+    uint32_t base_delay_ms;
+    uint32_t max_delay_ms;
+    uint32_t budget_ms;
+    bool retry_unsafe;           /* Also retry POST and PATCH requests that may have been processed. */
+} retry_policy_t;
+
+/* Progress of one request under a policy. */
+typedef struct
+{
+    const retry_policy_t *policy;    /* NULL for a single attempt. */
+    uint32_t attempts;
+    uint32_t waited_ms;          /* Sum of the delays so far. */
+    uint32_t delay_ms;           /* Delay before the next attempt. */
+    uint32_t status;             /* Status of the last response, 0 if there was none. */
+    uint32_t retry_after_count;  /* Attempts delayed by a Retry-After. */
+    bool pending;                /* Another attempt is due after delay_ms. */
+} retry_state_t;
+
+typedef struct
+{
+    retry_fault_kind_t kind;
+    uint16_t status;
+    uint16_t retry_after_s;      /* 0 to omit the Retry-After header. */
+} retry_fault_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern const retry_policy_t retry_default_policy;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void retry_state_init(retry_state_t *state, const retry_policy_t *policy);
+bool retry_check(retry_state_t *state, cy_http_client_method_t method, cy_rslt_t result,
+                 bool sent, uint32_t status, uint32_t retry_after_ms);
+bool retry_next_delay(retry_state_t *state);
+bool retry_is_idempotent(cy_http_client_method_t method);
+uint32_t retry_parse_after(const char *value, size_t length, const char *date, size_t date_length);
+#if defined(RETRY_FAULT_INJECTION)
+void retry_fault_inject(const retry_fault_t *faults, uint32_t count);
+bool retry_fault_take(retry_fault_t *fault);
+#endif /* RETRY_FAULT_INJECTION */
+void retry_policy_simulate(void);
+void retry_policy_demo(void);
+
+#endif /* RETRY_POLICY_H_ */
+
+
+/* [] END OF FILE */
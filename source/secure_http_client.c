@@ -46,6 +46,7 @@
 /* FreeRTOS header file */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <semphr.h>
 
 /* Cypress Secure Sockets header file */
 #include "cy_secure_sockets.h"
@@ -56,14 +57,88 @@
 #include "cy_wcm_error.h"
 
 /* Standard C header file */
+#include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 
 /* HTTPS client task header file. */
 #include "secure_http_client.h"
 #include "cy_http_client_api.h"
 #include "secure_keys.h"
+#include "flash_download.h"
+#include "offline_queue.h"
+#include "telemetry_batch.h"
+#include "payload_codec.h"
+#include "json_stream.h"
+#include "cycle_counter.h"
+#include "inflater.h"
+#include "compressed_upload.h"
+#include "http_pipeline.h"
+#include "websocket.h"
+#include "sse.h"
+#include "mqtt_transport.h"
+#include "coap_client.h"
+#include "http2_client.h"
+#include "request_scheduler.h"
+#include "retry_policy.h"
+#include "response_cache.h"
+#include "delta_sync.h"
+#include "firmware_update.h"
+#include "stream_digest.h"
+#include "body_source.h"
+#include "lwip_profile.h"
+#include "wifi_power.h"
+#include "wlan_offload.h"
+#include "periodic_jobs.h"
 
 #include "lwip/ip_addr.h"
+#include "lwip/stats.h"
+
+/*******************************************************************************
+* Structures
+********************************************************************************/
+/* Parser and counters of a JSON document streamed by stream_json_config(). */
+typedef struct
+{
+    json_stream_t parser;
+    uint32_t bytes;
+    uint32_t chunks;
+    uint32_t cycles;
+} json_feed_t;
+
+/* Receiver of the decoded body of an https_stream_get() transfer. */
+typedef struct
+{
+    https_body_cb_t body_cb;
+    void *arg;
+    https_stream_stats_t *stats;
+    stream_digest_t *digest;     /* Digest of the decoded body, or NULL. */
+} stream_sink_t;
+
+/* State of an https_stream_get() transfer, set from the response as it is
+ * parsed.
+ */
+typedef struct
+{
+    stream_sink_t sink;
+    const char *path;
+    const char *headers;         /* Accept and Accept-Encoding lines. */
+    bool compressed;             /* A compressed body is accepted. */
+    bool encoded;                /* The body is decoded with format. */
+    bool unsupported;            /* The Content-Encoding cannot be decoded. */
+    inflater_format_t format;
+    bool hash_wire;              /* header_sha256 holds a digest header. */
+    bool repr_digest;            /* The digest header is Repr-Digest. */
+    uint8_t header_sha256[STREAM_DIGEST_SHA256_LEN];
+    const uint8_t *expected_sha256;
+    bool hashing;                /* stream_digest was started. */
+    bool started;                /* The status line and headers were handled. */
+    bool complete;
+    bool stopped;                /* The body callback stopped the transfer. */
+    inflater_status_t inflate_status;
+    cy_rslt_t result;
+    TickType_t busy_ticks;       /* Time spent decoding and in the body callback. */
+} stream_transfer_t;
 
 /*******************************************************************************
 * Global Variables
@@ -77,6 +152,18 @@ static cy_wcm_ip_address_t ip_addr;
 /* Secure HTTP client instance. */
 static cy_http_client_t https_client;
 
+/* Set while the HTTP client is connected to the server. */
+static volatile bool https_connected = false;
+
+/* Connections made to the server since the start of the application. */
+static volatile uint32_t https_connections;
+
+/* Serializes the use of the HTTP client and http_get_buffer between tasks. */
+static SemaphoreHandle_t https_client_mutex;
+
+/* Serializes https_stream_get(), which has a connection of its own. */
+static SemaphoreHandle_t stream_mutex;
+
 /* Holds the security configuration such as client certificate,
  * client key, and rootCA.
  */
@@ -85,6 +172,51 @@ cy_awsport_ssl_credentials_t security_config;
 /* Secure HTTP server information. */
 cy_awsport_server_info_t server_info;
 
+/* Length of the headers of the last request sent. */
+static uint32_t last_request_head_len;
+
+/* Send request bodies in the write of their headers, see
+ * HTTPS_COALESCE_REQUESTS. Cleared by the benchmark to compare.
+ */
+static bool coalesce_requests = HTTPS_COALESCE_REQUESTS;
+
+/* Retry state and injected fault of the attempt in progress, and whether
+ * its request was handed to the HTTP client. Used with the HTTP client
+ * mutex held.
+ */
+static retry_state_t *active_retry;
+#if defined(RETRY_FAULT_INJECTION)
+static retry_fault_t active_fault;
+#endif
+static bool request_sent;
+
+/* Cache entry of the GET in progress, NULL if it is not cached. Used with
+ * the HTTP client mutex held.
+ */
+static response_cache_lookup_t *active_lookup;
+
+/* Retry state of the last request sent with https_send_request(). */
+static retry_state_t last_retry;
+
+/* Replay of the offline queue in the bulk lane of the request scheduler.
+ * Only one replay is queued at a time; the others are used by the scheduler
+ * task only.
+ */
+static volatile bool replay_queued;
+static offline_queue_batch_t replay_batch;
+static offline_queue_stats_t replay_stats;
+static bool replay_accepted;
+
+/* Backoff between the attempts to join the AP. */
+static const retry_policy_t wifi_retry_policy =
+{
+    .max_attempts = MAX_WIFI_RETRY_COUNT,
+    .base_delay_ms = WIFI_CONN_RETRY_INTERVAL_MSEC,
+    .max_delay_ms = RETRY_WIFI_MAX_DELAY_MS,
+    .budget_ms = MAX_WIFI_RETRY_COUNT * RETRY_WIFI_MAX_DELAY_MS,
+    .retry_unsafe = false,
+};
+
 /*Buffer to store get response*/
 uint8_t http_get_buffer[HTTP_GET_BUFFER_LENGTH];
 
@@ -94,21 +226,69 @@ cy_http_client_header_t http_header[1];
 /*Holds the fields for response header and body*/
 cy_http_client_response_t http_response;
 
+/* Connection of https_stream_get(), and the decoder and window of its
+ * compressed bodies. Used with the stream mutex held.
+ */
+static http_pipeline_t stream_pipeline;
+static inflater_t stream_inflater;
+
+/* Digest of the https_stream_get() transfer being verified. Used with the
+ * stream mutex held.
+ */
+static stream_digest_t stream_digest;
+static uint8_t inflate_window[HTTPS_INFLATE_WINDOW_SIZE];
+
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 void http_request(void);
+static void download_to_flash(void);
+static void sync_flash_asset(void);
+static void update_firmware(void);
+static void stream_json_config(void);
+static bool feed_json_parser(const uint8_t *data, uint32_t length, void *arg);
+static void compare_compression(void);
+static bool crc_body(const uint8_t *data, uint32_t length, void *arg);
+static void compare_request_coalescing(void);
+static void count_error_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+static cy_rslt_t stream_transfer(void *arg);
+static void stream_header(const char *name, const char *value, void *arg);
+static void stream_response(const http_pipeline_event_t *event, void *arg);
+static cy_rslt_t start_stream(stream_transfer_t *transfer, uint16_t status_code);
+static bool deliver_decoded(const uint8_t *data, size_t length, void *arg);
+static bool header_value_equals(const char *value, size_t length, const char *token);
 void fetch_https_client_method(void);
 void disconnect_callback_handler(cy_http_client_t handle, cy_http_client_disconn_type_t type, void *args);
-cy_rslt_t send_http_request(cy_http_client_t handle,cy_http_client_method_t method,const char * pPath);
+cy_rslt_t send_http_request(cy_http_client_t handle, const https_request_t *req);
 static cy_rslt_t configure_https_client(void);
+static cy_rslt_t connect_to_server(void);
+static cy_rslt_t take_connected_client(void);
+static void give_client(cy_rslt_t result);
+static cy_rslt_t send_attempt(const https_request_t *request, retry_state_t *retry,
+                              response_cache_lookup_t *lookup);
+static bool cache_response(cy_http_client_t handle, cy_http_client_response_t *response,
+                           const https_request_t *req);
+static bool deliver_cached(const https_request_t *req, const response_cache_lookup_t *lookup);
+static void add_request_header(cy_http_client_header_t *header, uint32_t *num_headers,
+                               const char *field, const char *value);
+static bool retry_response(cy_http_client_t handle, cy_http_client_response_t *response,
+                           const https_request_t *req);
+static void replay_offline_queue(void);
+static bool replay_next_batch(uint32_t chunk, https_request_t *request, void *arg);
+static void replay_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+static void replay_done(cy_rslt_t result, uint32_t latency_ms, void *arg);
+static void fetch_cached_config(void);
 
 /********************************************************************************
  * Function Name: wifi_connect
  ********************************************************************************
  * Summary:
  *  The device associates to the Access Point with given SSID, PASSWORD, and SECURITY
- *  type. It retries for MAX_WIFI_RETRY_COUNT times if the Wi-Fi connection fails.
+ *  type. It tries up to MAX_WIFI_RETRY_COUNT times, with a random backoff from
+ *  WIFI_CONN_RETRY_INTERVAL_MSEC between the attempts, if the Wi-Fi connection
+ *  fails.
+ *  The Wi-Fi Connection Manager is initialized on the first call only, so the
+ *  function can be called again to rejoin the AP after an outage.
  *
  * Parameters:
  *  void
@@ -121,11 +301,16 @@ static cy_rslt_t configure_https_client(void);
 cy_rslt_t wifi_connect(void)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
-    uint32_t retry_count = 0;
+    retry_state_t retry;
     cy_wcm_connect_params_t connect_param = {0};
     cy_wcm_config_t wcm_config = {.interface = CY_WCM_INTERFACE_TYPE_STA};
+    static bool wcm_initialized = false;
 
-    result = cy_wcm_init(&wcm_config);
+    if (!wcm_initialized)
+    {
+        result = cy_wcm_init(&wcm_config);
+        wcm_initialized = (CY_RSLT_SUCCESS == result);
+    }
 
     if (CY_RSLT_SUCCESS == result)
     {
@@ -139,7 +324,9 @@ cy_rslt_t wifi_connect(void)
          * Connect to Access Point. It validates the connection parameters
          * and then establishes connection to AP.
          */
-        for (retry_count = 0; retry_count < MAX_WIFI_RETRY_COUNT; retry_count++)
+        retry_state_init(&retry, &wifi_retry_policy);
+
+        for (;;)
         {
              result = cy_wcm_connect_ap(&connect_param, &ip_addr);
 
@@ -159,7 +346,14 @@ cy_rslt_t wifi_connect(void)
                  break;
              }
 
-             ERR_INFO(("Failed to join Wi-Fi network. Retrying...\n"));
+             if (!retry_next_delay(&retry))
+             {
+                 ERR_INFO(("Failed to join Wi-Fi network.\n"));
+                 break;
+             }
+
+             ERR_INFO(("Failed to join Wi-Fi network. Retrying in %lu ms...\n", (unsigned long)retry.delay_ms));
+             vTaskDelay(pdMS_TO_TICKS(retry.delay_ms));
         }
     }
 
@@ -170,7 +364,8 @@ cy_rslt_t wifi_connect(void)
  * Function Name: disconnect_callback
  *******************************************************************************
  * Summary:
- *  Callback function for http disconnect
+ *  Callback function for http disconnect. Marks the client as disconnected so
+ *  that the next request reconnects first.
  *
  * Parameters:
  *  void
@@ -182,27 +377,37 @@ cy_rslt_t wifi_connect(void)
 void disconnect_callback_handler(cy_http_client_t handle, cy_http_client_disconn_type_t type, void *args)
 {
     printf("\nApplication Disconnect callback triggered for handle = %p type=%d\n", handle, type);
+    https_connected = false;
 }
 
 /*******************************************************************************
  * Function Name: send_http_request
  *******************************************************************************
  * Summary:
- *  The function handles an http send operation.
+ *  The function handles an http send operation. The response is passed to
+ *  the response callback of the request, or printed if there is none. A body
+ *  that fits in the request buffer after the headers is copied there and
+ *  sent in the same write, see HTTPS_COALESCE_REQUESTS.
  *
  * Parameters:
- *  void
+ *  handle - Connected HTTP client instance.
+ *  req - Request to send.
  *
  * Return:
  *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the secure HTTP client is configured
  *  successfully, otherwise, it returns CY_RSLT_TYPE_ERROR.
  *
  *******************************************************************************/
-cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t method,
-                               const char * pPath)
+cy_rslt_t send_http_request(cy_http_client_t handle, const https_request_t *req)
 {
     cy_http_client_request_header_t request;
-    cy_http_client_header_t header;
+    cy_http_client_header_t header[HTTP_MAX_REQUEST_HEADERS];
+    uint32_t num_headers = 0;
+    const char *content_type = req->content_type;
+    const uint8_t *body = req->body;
+    uint32_t body_len = req->body_len;
+    char content_length[sizeof("4294967295")];
+    bool coalesce;
 
     cy_http_client_response_t response;
 
@@ -215,36 +420,111 @@ cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t me
     request.buffer_len = HTTP_GET_BUFFER_LENGTH;
 
     request.headers_len = HTTP_REQUEST_HEADER_LEN;
-    request.method = method;
+    request.method = req->method;
     request.range_end = HTTP_REQUEST_RANGE_END;
     request.range_start = HTTP_REQUEST_RANGE_START;
-    request.resource_path = pPath;
+    request.resource_path = req->path;
+
+    if (NULL == content_type)
+    {
+        content_type = HTTP_DEFAULT_CONTENT_TYPE;
+    }
+
+    header[num_headers].field = "Content-Type";
+    header[num_headers].field_len = sizeof("Content-Type")-1;
+    header[num_headers].value = (char *)content_type;
+    header[num_headers].value_len = strlen(content_type);
+    num_headers++;
+
+    if (NULL != req->accept)
+    {
+        header[num_headers].field = "Accept";
+        header[num_headers].field_len = sizeof("Accept")-1;
+        header[num_headers].value = (char *)req->accept;
+        header[num_headers].value_len = strlen(req->accept);
+        num_headers++;
+    }
+
+    if (NULL != req->content_encoding)
+    {
+        header[num_headers].field = "Content-Encoding";
+        header[num_headers].field_len = sizeof("Content-Encoding")-1;
+        header[num_headers].value = (char *)req->content_encoding;
+        header[num_headers].value_len = strlen(req->content_encoding);
+        num_headers++;
+    }
 
-    header.field = "Content-Type";
-    header.field_len = sizeof("Content-Type")-1;
-    header.value = "application/x-www-form-urlencoded";
-    header.value_len = sizeof("application/x-www-form-urlencoded")-1;
+    if ((NULL != active_lookup) && (RESPONSE_CACHE_STALE == active_lookup->state))
+    {
+        add_request_header(header, &num_headers, "If-None-Match", active_lookup->etag);
+        add_request_header(header, &num_headers, "If-Modified-Since", active_lookup->last_modified);
+    }
+
+    /* The HTTP client adds Content-Length only for a body it sends itself. */
+    coalesce = coalesce_requests && (body_len > 0) && (body_len < request.buffer_len);
+    if (coalesce)
+    {
+        snprintf(content_length, sizeof(content_length), "%lu", (unsigned long)body_len);
+        add_request_header(header, &num_headers, "Content-Length", content_length);
+    }
 
-    http_status = cy_http_client_write_header(handle, &request, &header, NUM_HTTP_HEADERS);
+    http_status = cy_http_client_write_header(handle, &request, header, num_headers);
+    if ((CY_RSLT_SUCCESS == http_status) && coalesce && ((request.headers_len + body_len) > request.buffer_len))
+    {
+        /* The body does not fit after these headers, so it is sent apart. */
+        coalesce = false;
+        num_headers--;
+        http_status = cy_http_client_write_header(handle, &request, header, num_headers);
+    }
     if( http_status != CY_RSLT_SUCCESS )
     {
         printf("\nWrite Header ----------- Fail \n");
         return http_status;
     }
-    else
+    else if (!req->quiet)
     {
         printf( "\n Sending Request Headers:\n%.*s\n",( int ) request.headers_len, ( char * ) request.buffer);
     }
 
-    http_status = cy_http_client_send(handle, &request, (uint8_t *)REQUEST_BODY, REQUEST_BODY_LENGTH, &response);
+    last_request_head_len = (uint32_t)request.headers_len;
+
+    if (coalesce)
+    {
+        memcpy(&request.buffer[request.headers_len], body, body_len);
+        request.headers_len += body_len;
+        body = NULL;
+        body_len = 0;
+    }
+
+    request_sent = true;
+    http_status = cy_http_client_send(handle, &request, (uint8_t *)body, body_len, &response);
+#if defined(RETRY_FAULT_INJECTION)
+    if ((CY_RSLT_SUCCESS == http_status) && (RETRY_FAULT_RESET == active_fault.kind))
+    {
+        http_status = CY_RSLT_TYPE_ERROR;
+    }
+#endif
+
     if( http_status != CY_RSLT_SUCCESS )
     {
         printf("\nFailed to send HTTP method=%d\n Error=%ld\r\n",request.method,(unsigned long)http_status);
         return http_status;
     }
+    else if ((NULL != active_retry) && retry_response(handle, &response, req))
+    {
+        /* The request is sent again, so this response is dropped. */
+    }
+    else if ((NULL != active_lookup) && cache_response(handle, &response, req))
+    {
+        /* Not modified, the cached body was delivered instead. */
+    }
+    else if (NULL != req->response_cb)
+    {
+        req->response_cb(handle, &response, req->cb_arg);
+    }
     else
     {
-        if ( CY_HTTP_CLIENT_METHOD_HEAD != method )
+        if ( CY_HTTP_CLIENT_METHOD_HEAD != req->method )
         {
             TEST_INFO(( "Received HTTP response from %.*s%.*s...\n"
                    "Response Headers:\n %.*s\n"
@@ -283,6 +563,21 @@ static cy_rslt_t configure_https_client(void)
     cy_rslt_t result = CY_RSLT_SUCCESS;
     cy_http_disconnect_callback_t http_cb;
 
+    https_client_mutex = xSemaphoreCreateMutex();
+    if (NULL == https_client_mutex)
+    {
+        ERR_INFO(("Failed to create the http client mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    stream_mutex = xSemaphoreCreateMutex();
+    if (NULL == stream_mutex)
+    {
+        ERR_INFO(("Failed to create the stream mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+    http_pipeline_init(&stream_pipeline, 1);
+
     ( void ) memset( &security_config, 0, sizeof( security_config ) );
     ( void ) memset( &server_info, 0, sizeof( server_info ) );
 
@@ -342,9 +637,14 @@ void https_client_task(void *arg)
 
     (void)arg;
 
-    /* Connects to the Wi-Fi Access Point. */
+    /* Connects to the Wi-Fi Access Point. If the AP is not available, the
+     * join is retried before each request and the requests are queued meanwhile.
+     */
     result = wifi_connect();
-    PRINT_AND_ASSERT(result, "Wi-Fi connection failed.\n");
+    if( result != CY_RSLT_SUCCESS )
+    {
+        ERR_INFO(("Wi-Fi connection failed.\n"));
+    }
 
     /* Configure the HTTPS client with all the security parameters and
      * register a default dynamic URL handler.
@@ -352,7 +652,95 @@ void https_client_task(void *arg)
     result = configure_https_client();
     PRINT_AND_ASSERT(result, "Failed to configure the HTTPS client.\n");
 
-    /* Connect the HTTP client to server. */
+    /* Start the flash writer task of the download pipeline. */
+    result = flash_download_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the flash download pipeline.\n");
+
+    /* Recover the requests queued in flash before the last reset. */
+    result = offline_queue_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the offline request queue.\n");
+
+    /* Rebuild the index of the responses cached in flash. */
+    result = response_cache_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the response cache.\n");
+
+    /* Set up the compressor of the request bodies before the batches use it. */
+    result = compressed_upload_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the compressed uploads.\n");
+
+    /* Initialize the MQTT library; the broker is connected on first use. */
+    result = mqtt_transport_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the MQTT transport.\n");
+
+    /* Set up the CoAP client; the DTLS association is made on first use. */
+    result = coap_client_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the CoAP client.\n");
+
+    /* Start the task that sends the requests of the priority lanes. */
+    result = request_scheduler_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the request scheduler.\n");
+
+    /* Start the task that posts the telemetry batches. */
+    result = telemetry_batch_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the telemetry batching.\n");
+
+    /* Let the Wi-Fi firmware answer ARP and keep the connections alive. */
+    result = wlan_offload_init();
+    PRINT_AND_ASSERT(result, "Failed to configure the WLAN offloads.\n");
+
+    /* Keep the radio in power save between the transfers. */
+    result = wifi_power_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the Wi-Fi power policy.\n");
+
+    /* Start the task that runs the periodic jobs in shared wake windows. */
+    result = periodic_jobs_init();
+    PRINT_AND_ASSERT(result, "Failed to initialize the periodic jobs.\n");
+
+    /* Connect the HTTP client to server. When the server is not reachable the
+     * requests are queued in flash and replayed after a later reconnect.
+     */
+    (void)connect_to_server();
+
+    while(true)
+    {
+        /*fetch HTTP client Methods. */
+        fetch_https_client_method();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: connect_to_server
+ *******************************************************************************
+ * Summary:
+ *  Connects the HTTP client to the server, rejoining the Wi-Fi AP first if
+ *  the link was lost. Once connected, the requests queued in flash while
+ *  the server was unreachable are queued for replay.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the client is connected, otherwise,
+ *  it returns a WCM or HTTP client error code.
+ *
+ *******************************************************************************/
+static cy_rslt_t connect_to_server(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (!cy_wcm_is_connected_to_ap())
+    {
+        result = wifi_connect();
+        if( result != CY_RSLT_SUCCESS )
+        {
+            ERR_INFO(("Wi-Fi connection failed.\n"));
+            return result;
+        }
+    }
+
+    /* Release the transport of a connection that was dropped. */
+    (void)cy_http_client_disconnect(https_client);
+
     result = cy_http_client_connect(https_client, TRANSPORT_SEND_RECV_TIMEOUT_MS, TRANSPORT_SEND_RECV_TIMEOUT_MS);
     if( result != CY_RSLT_SUCCESS )
     {
@@ -361,119 +749,1869 @@ void https_client_task(void *arg)
     else
     {
         printf("Successfully connected to http server\r\n");
-        while(true)
-        {
-            /*fetch HTTP client Methods. */
-            fetch_https_client_method();
-        }
+        https_connected = true;
+        https_connections++;
+
+        replay_offline_queue();
     }
+
+    return result;
 }
 
 /*******************************************************************************
- * Function Name: fetch_https_client_method
+ * Function Name: take_connected_client
  *******************************************************************************
  * Summary:
- *  The function handles an http methods.
+ *  Takes the HTTP client for a caller that drives it directly, and connects
+ *  it if the connection was lost. The client must be given back with
+ *  give_client() whatever the result.
+ *
+ *******************************************************************************/
+static cy_rslt_t take_connected_client(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    xSemaphoreTake(https_client_mutex, portMAX_DELAY);
+
+    if (!https_connected)
+    {
+        result = connect_to_server();
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: give_client
+ *******************************************************************************
+ * Summary:
+ *  Gives back the HTTP client taken with take_connected_client(). A failure
+ *  other than CY_RSLT_TYPE_ERROR came from the transport, so the connection
+ *  is marked lost and the next request reconnects.
+ *
+ *******************************************************************************/
+static void give_client(cy_rslt_t result)
+{
+    if ((CY_RSLT_SUCCESS != result) && (CY_RSLT_TYPE_ERROR != result))
+    {
+        https_connected = false;
+    }
+
+    xSemaphoreGive(https_client_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: https_send_request
+ *******************************************************************************
+ * Summary:
+ *  Sends a request over the shared HTTP client and waits for the response.
+ *  The client is reconnected first if the connection was lost. With a retry
+ *  policy, failed attempts and transient responses are retried as the
+ *  policy allows, and only the final response is delivered. A cached GET is
+ *  served from the response cache while it is fresh, and revalidated with a
+ *  conditional request otherwise. Requests with REQUEST_TRANSPORT_COAP are
+ *  sent over CoAP instead. Safe to call from any task.
  *
  * Parameters:
- *  void
+ *  request - Request to send.
  *
  * Return:
- *  None.
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a response is received, otherwise,
+ *  it returns a WCM or HTTP client error code.
  *
  *******************************************************************************/
-void fetch_https_client_method(void)
+cy_rslt_t https_send_request(const https_request_t *request)
 {
+    cy_rslt_t result;
+    retry_state_t retry;
+    response_cache_lookup_t lookup;
+    bool cached = request->cached && (CY_HTTP_CLIENT_METHOD_GET == request->method);
 
-    /* Status variable */
-    uint8_t uart_read_value;
-    uint8_t uart_read_integer;
+    if (REQUEST_TRANSPORT_COAP == request->transport)
+    {
+        wifi_power_begin();
+        result = coap_send_https_request(request);
+        wifi_power_end();
+        return result;
+    }
 
-    /* Options to select the method*/
-    printf("\n===============================================================\n");
-    printf(MENU_HTTPS_METHOD);
-    printf("\n===============================================================\n");
+    if (cached)
+    {
+        response_cache_lookup(request->path, (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS, &lookup);
+        if (RESPONSE_CACHE_FRESH == lookup.state)
+        {
+            xSemaphoreTake(https_client_mutex, portMAX_DELAY);
+            cached = !deliver_cached(request, &lookup);
+            xSemaphoreGive(https_client_mutex);
 
-    /* Reading option number from console */
-    while (cyhal_uart_getc(&cy_retarget_io_uart_obj, &uart_read_value, 1) != CY_RSLT_SUCCESS);
-    /* Converting ASCII character to Integer value */
-    uart_read_integer = uart_read_value - ASCII_INTEGER_DIFFERENCE;
+            if (!cached)
+            {
+                return CY_RSLT_SUCCESS;
+            }
 
-    switch(uart_read_integer)
+            /* The entry was replaced meanwhile. */
+            lookup.state = RESPONSE_CACHE_MISS;
+        }
+    }
+
+    /* Only a request that reaches the network wakes the radio. */
+    wifi_power_begin();
+    retry_state_init(&retry, request->retry);
+
+    for (;;)
     {
-         case HTTPS_GET_METHOD:
-         {
-             printf("\n HTTP GET Request..\n");
-             http_client_method = CY_HTTP_CLIENT_METHOD_GET;
-             break;
-         }
-         case HTTPS_POST_METHOD:
-         {
-             printf("\n HTTP POST Request..\n");
-             http_client_method = CY_HTTP_CLIENT_METHOD_POST;
-             break;
-         }
-         case HTTPS_PUT_METHOD:
-         {
-             printf("\n HTTP PUT Request..\n");
-             http_client_method = CY_HTTP_CLIENT_METHOD_PUT;
-             break;
-         }
-         case HTTPS_GET_METHOD_AFTER_PUT:
-         {
-             printf("\n HTTP GET FOR PUT Request..\n");
-             http_client_method = CY_HTTP_CLIENT_METHOD_GET;
-             get_after_put_flag = true;
-             break;
-         }
-        default:
+        result = send_attempt(request, &retry, cached ? &lookup : NULL);
+        if (!retry.pending)
         {
-            printf("\x1b[2J\x1b[;H");
-            printf("\r\nPlease select from the given valid options\r\n");
+            break;
         }
+
+        /* The client is released while waiting, for the other tasks. */
+        vTaskDelay(pdMS_TO_TICKS(retry.delay_ms));
     }
+    wifi_power_end();
 
-    /* Send the HTTP request and body to the server, and receive the status from it. */
-    http_request();
+    /* A request that may have changed the resource makes its copy stale. */
+    if ((CY_RSLT_SUCCESS == result) && (CY_HTTP_CLIENT_METHOD_GET != request->method) &&
+        (CY_HTTP_CLIENT_METHOD_HEAD != request->method))
+    {
+        response_cache_invalidate(request->path);
+    }
+
+    return result;
 }
 
 /*******************************************************************************
- * Function Name: http_request
+ * Function Name: send_attempt
  *******************************************************************************
  * Summary:
- *  The function handles an http request operation.
- *
- * Parameters:
- *  void
- *
- * Return:
- *  None.
+ *  Makes one attempt of https_send_request(), or fails it with the next
+ *  injected fault in a RETRY_FAULT_INJECTION build, and records whether
+ *  it is to be retried.
  *
  *******************************************************************************/
-void http_request(void)
+static cy_rslt_t send_attempt(const https_request_t *request, retry_state_t *retry,
+                              response_cache_lookup_t *lookup)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t attempts = retry->attempts;
 
-    /* Send the HTTP request and body to the server, and receive the response from it. */
-    if(get_after_put_flag)
+    xSemaphoreTake(https_client_mutex, portMAX_DELAY);
+
+    active_retry = retry;
+    active_lookup = lookup;
+    request_sent = false;
+
+#if defined(RETRY_FAULT_INJECTION)
+    if (!retry_fault_take(&active_fault))
     {
-        get_after_put_flag = false;
-        result = send_http_request(https_client,http_client_method,HTTP_GET_PATH_AFTER_PUT);
+        active_fault.kind = RETRY_FAULT_NONE;
+    }
+
+    if (RETRY_FAULT_CONNECT == active_fault.kind)
+    {
+        ERR_INFO(("Failed to connect to the http server (injected).\n"));
+        result = CY_RSLT_TYPE_ERROR;
     }
     else
+#endif
+    if (!https_connected)
     {
-        result = send_http_request(https_client,http_client_method,HTTP_PATH);
+        result = connect_to_server();
     }
 
-    if( result != CY_RSLT_SUCCESS )
+    if( result == CY_RSLT_SUCCESS )
     {
-        ERR_INFO(("Failed to send the http request.\n"));
+        result = send_http_request(https_client, request);
+        if( result != CY_RSLT_SUCCESS )
+        {
+            https_connected = false;
+        }
+    }
+
+    /* A response was already checked by retry_response(). */
+    if (attempts == retry->attempts)
+    {
+        (void)retry_check(retry, request->method, result, request_sent, 0, RETRY_AFTER_NONE);
+    }
+
+    last_retry = *retry;
+    active_retry = NULL;
+    active_lookup = NULL;
+#if defined(RETRY_FAULT_INJECTION)
+    active_fault.kind = RETRY_FAULT_NONE;
+#endif
+
+    xSemaphoreGive(https_client_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: retry_response
+ *******************************************************************************
+ * Summary:
+ *  Checks a response against the retry policy of its request, reading the
+ *  Retry-After and Date headers of a 429 or 503 response. An injected
+ *  status fault replaces the status of the response in a
+ *  RETRY_FAULT_INJECTION build.
+ *
+ * Return:
+ *  bool: true if the request is to be sent again.
+ *
+ *******************************************************************************/
+static bool retry_response(cy_http_client_t handle, cy_http_client_response_t *response,
+                           const https_request_t *req)
+{
+    static const char *const fields[] = { "Retry-After", "Date" };
+    cy_http_client_header_t header[2];
+    uint32_t retry_after_ms = RETRY_AFTER_NONE;
+
+#if defined(RETRY_FAULT_INJECTION)
+    if (RETRY_FAULT_STATUS == active_fault.kind)
+    {
+        response->status_code = active_fault.status;
+        if (0u != active_fault.retry_after_s)
+        {
+            retry_after_ms = (uint32_t)active_fault.retry_after_s * 1000u;
+        }
     }
     else
+#endif
+    if ((HTTP_STATUS_TOO_MANY_REQUESTS == response->status_code) ||
+             (HTTP_STATUS_SERVICE_UNAVAILABLE == response->status_code))
     {
-        printf("\r\n Successfully sent GET request to http server\r\n");
-        printf("\r\n The http status code is :: %d\r\n",http_response.status_code);
+        for (uint32_t i = 0; i < 2u; i++)
+        {
+            header[i].field = (char *)fields[i];
+            header[i].field_len = strlen(fields[i]);
+            header[i].value = NULL;
+            header[i].value_len = 0;
+            (void)cy_http_client_read_header(handle, response, &header[i], 1);
+        }
+
+        if (NULL != header[0].value)
+        {
+            retry_after_ms = retry_parse_after(header[0].value, header[0].value_len,
+                                               header[1].value, header[1].value_len);
+        }
     }
+
+    return retry_check(active_retry, req->method, CY_RSLT_SUCCESS, true, response->status_code, retry_after_ms);
 }
-/* [] END OF FILE */
 
+/*******************************************************************************
+ * Function Name: cache_response
+ *******************************************************************************
+ * Summary:
+ *  Passes the response of a cached GET to the response cache. A 304 renews
+ *  the entry and its body is delivered in place of the response; a complete
+ *  200 response is stored.
+ *
+ * Return:
+ *  bool: true if the cached body was delivered.
+ *
+ *******************************************************************************/
+static bool cache_response(cy_http_client_t handle, cy_http_client_response_t *response,
+                           const https_request_t *req)
+{
+    static const char *const fields[] = { "Cache-Control", "ETag", "Last-Modified" };
+    cy_http_client_header_t header[3];
+    response_cache_headers_t headers;
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    if ((HTTP_STATUS_NOT_MODIFIED != response->status_code) && (HTTP_STATUS_OK != response->status_code))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < 3u; i++)
+    {
+        header[i].field = (char *)fields[i];
+        header[i].field_len = strlen(fields[i]);
+        header[i].value = NULL;
+        header[i].value_len = 0;
+        (void)cy_http_client_read_header(handle, response, &header[i], 1);
+    }
+
+    headers.cache_control = header[0].value;
+    headers.cache_control_len = header[0].value_len;
+    headers.etag = header[1].value;
+    headers.etag_len = header[1].value_len;
+    headers.last_modified = header[2].value;
+    headers.last_modified_len = header[2].value_len;
+
+    if (HTTP_STATUS_NOT_MODIFIED == response->status_code)
+    {
+        return response_cache_not_modified(active_lookup, now_ms, &headers) &&
+               deliver_cached(req, active_lookup);
+    }
+
+    /* A body cut short by the response buffer is not stored. */
+    if (response->body_len == response->content_len)
+    {
+        (void)response_cache_store(req->path, now_ms, &headers, response->body, (uint32_t)response->body_len);
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: deliver_cached
+ *******************************************************************************
+ * Summary:
+ *  Delivers a cached body as a 200 response, rebuilt in http_get_buffer with
+ *  a status line, Content-Length, and the validators of the entry, so that
+ *  cy_http_client_read_header() works on it as on a response from the
+ *  server. Called with the HTTP client mutex held.
+ *
+ * Return:
+ *  bool: false if the entry was replaced since the lookup.
+ *
+ *******************************************************************************/
+static bool deliver_cached(const https_request_t *req, const response_cache_lookup_t *lookup)
+{
+    static const char status_line[] = "HTTP/1.1 200 OK\r\n";
+    cy_http_client_response_t response;
+    int head_len;
+
+    head_len = snprintf((char *)http_get_buffer, HTTP_GET_BUFFER_LENGTH,
+                        "%sContent-Length: %lu\r\n%s%s%s%s%s%s\r\n", status_line,
+                        (unsigned long)lookup->body_len,
+                        ('\0' != lookup->etag[0]) ? "ETag: " : "", lookup->etag,
+                        ('\0' != lookup->etag[0]) ? "\r\n" : "",
+                        ('\0' != lookup->last_modified[0]) ? "Last-Modified: " : "", lookup->last_modified,
+                        ('\0' != lookup->last_modified[0]) ? "\r\n" : "");
+    if ((head_len < 0) || ((uint32_t)head_len > RESPONSE_CACHE_HEAD_ROOM))
+    {
+        return false;
+    }
+
+    memset(&response, 0, sizeof(response));
+    response.status_code = HTTP_STATUS_OK;
+    response.header = http_get_buffer + (sizeof(status_line) - 1u);
+    response.headers_len = (size_t)head_len - (sizeof(status_line) - 1u);
+    response.header_count = 1u + (('\0' != lookup->etag[0]) ? 1u : 0u) +
+                            (('\0' != lookup->last_modified[0]) ? 1u : 0u);
+    response.body = http_get_buffer + head_len;
+    response.body_len = response_cache_read(lookup, http_get_buffer + head_len,
+                                            HTTP_GET_BUFFER_LENGTH - (uint32_t)head_len);
+    response.content_len = response.body_len;
+    response.buffer = http_get_buffer;
+    response.buffer_len = (size_t)head_len + response.body_len;
+
+    if ((0u == response.body_len) && (0u != lookup->body_len))
+    {
+        return false;
+    }
+
+    if (NULL != req->response_cb)
+    {
+        req->response_cb(https_client, &response, req->cb_arg);
+    }
+    else
+    {
+        TEST_INFO(( "Served %.*s from the response cache...\n"
+               "Response Body   :\n %.*s\n",
+               ( int ) strlen(req->path), req->path,
+               ( int ) response.body_len, response.body ) );
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: add_request_header
+ *******************************************************************************
+ * Summary:
+ *  Appends a header to the request headers, unless its value is empty.
+ *
+ *******************************************************************************/
+static void add_request_header(cy_http_client_header_t *header, uint32_t *num_headers,
+                               const char *field, const char *value)
+{
+    if ('\0' == value[0])
+    {
+        return;
+    }
+
+    header[*num_headers].field = (char *)field;
+    header[*num_headers].field_len = strlen(field);
+    header[*num_headers].value = (char *)value;
+    header[*num_headers].value_len = strlen(value);
+    (*num_headers)++;
+}
+
+/*******************************************************************************
+ * Function Name: https_disconnect
+ *******************************************************************************
+ * Summary:
+ *  Disconnects the HTTP client from the server, so that the next request
+ *  makes a new TCP and TLS connection. Safe to call from any task.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void https_disconnect(void)
+{
+    xSemaphoreTake(https_client_mutex, portMAX_DELAY);
+
+    if (https_connected)
+    {
+        (void)cy_http_client_disconnect(https_client);
+        https_connected = false;
+    }
+
+    xSemaphoreGive(https_client_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: https_get_connection_count
+ *******************************************************************************
+ * Summary:
+ *  Returns the connections the HTTP client has made to the server, so that
+ *  a caller can tell whether a request had to reconnect.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Connections since the start of the application.
+ *
+ *******************************************************************************/
+uint32_t https_get_connection_count(void)
+{
+    return https_connections;
+}
+
+/*******************************************************************************
+ * Function Name: https_stream_get
+ *******************************************************************************
+ * Summary:
+ *  Fetches a resource with a single GET and passes its body to a callback
+ *  as it arrives, so that a resource of any size is received through the
+ *  receive buffer of a pipeline. The body is one response, so it cannot mix
+ *  two versions of a resource that changes during the transfer. With
+ *  compression, gzip and deflate are advertised, and a compressed body is
+ *  decoded before it reaches the callback. The connection is closed after
+ *  the transfer.
+ *
+ *  The transfer runs in the bulk lane of the request scheduler, so it waits
+ *  for the urgent requests queued before it, and the callback is called
+ *  from the scheduler task. It must not send requests through the
+ *  scheduler. Safe to call from any task but the scheduler task.
+ *
+ *  The body is hashed as it arrives. With an expected digest, the SHA-256 of
+ *  the decoded body is checked against it. Otherwise, when the server sends
+ *  a Repr-Digest or Digest header, the received bytes are checked against
+ *  the header. The callback sees the body before it is verified, so it must
+ *  keep the data apart, for example in a staging area, and only commit it
+ *  when this function succeeds.
+ *
+ * Parameters:
+ *  path - Resource path.
+ *  accept - Value of the Accept header, or NULL to omit it.
+ *  compressed - Accept a compressed body.
+ *  expected_sha256 - SHA-256 of the decoded body, for example from a
+ *                    manifest, or NULL.
+ *  body_cb - Called with each piece of the decoded body, in order.
+ *  arg - Argument passed to the callback.
+ *  stats - Filled with the transfer statistics. Can be NULL.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the whole resource was received and
+ *  matches its digest, or if the callback stopped the transfer, otherwise,
+ *  it returns a TLS stream or CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+cy_rslt_t https_stream_get(const char *path, const char *accept, bool compressed,
+                           const uint8_t *expected_sha256, https_body_cb_t body_cb, void *arg,
+                           https_stream_stats_t *stats)
+{
+    cy_rslt_t result;
+    char headers[HTTPS_STREAM_HEADERS_SIZE];
+    https_stream_stats_t local_stats;
+    stream_transfer_t transfer;
+    int length;
+
+    if (NULL == stats)
+    {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->encoding = "identity";
+
+    length = snprintf(headers, sizeof(headers), "%s%s%s%s",
+                      (NULL != accept) ? "Accept: " : "", (NULL != accept) ? accept : "",
+                      (NULL != accept) ? "\r\n" : "",
+                      compressed ? "Accept-Encoding: " HTTPS_ACCEPT_ENCODING "\r\n" : "");
+    if ((length < 0) || ((uint32_t)length >= sizeof(headers)))
+    {
+        ERR_INFO(("The headers of the request for %s do not fit in %u bytes.\n",
+                  path, HTTPS_STREAM_HEADERS_SIZE));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.sink.body_cb = body_cb;
+    transfer.sink.arg = arg;
+    transfer.sink.stats = stats;
+    transfer.path = path;
+    transfer.headers = headers;
+    transfer.compressed = compressed;
+    transfer.expected_sha256 = expected_sha256;
+    transfer.inflate_status = INFLATER_OK;
+
+    xSemaphoreTake(stream_mutex, portMAX_DELAY);
+    result = request_scheduler_run(path, REQUEST_LANE_BULK, stream_transfer, &transfer);
+    xSemaphoreGive(stream_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: stream_transfer
+ *******************************************************************************
+ * Summary:
+ *  Runs an https_stream_get() transfer from the request scheduler task:
+ *  sends the GET over the stream connection, finishes the decoding, and
+ *  checks the digest.
+ *
+ *******************************************************************************/
+static cy_rslt_t stream_transfer(void *arg)
+{
+    stream_transfer_t *transfer = (stream_transfer_t *)arg;
+    https_stream_stats_t *stats = transfer->sink.stats;
+    http_pipeline_request_t request = {0};
+    uint8_t sha256[STREAM_DIGEST_SHA256_LEN];
+    cy_rslt_t result;
+    TickType_t start_ticks;
+
+    request.method = "GET";
+    request.path = transfer->path;
+    request.headers = transfer->headers;
+    request.header_cb = stream_header;
+
+    wifi_power_begin();
+    start_ticks = xTaskGetTickCount();
+
+    result = http_pipeline_request(&stream_pipeline, &request, stream_response, transfer);
+    stats->requests = 1;
+    stats->radio_ms = (uint32_t)(xTaskGetTickCount() - start_ticks - transfer->busy_ticks) * portTICK_PERIOD_MS;
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = transfer->result;
+    }
+    if ((CY_RSLT_SUCCESS == result) && !transfer->complete && !transfer->stopped)
+    {
+        ERR_INFO(("The response for %s ended before its body.\n", transfer->path));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+
+    if ((CY_RSLT_SUCCESS == result) && transfer->encoded && !transfer->stopped)
+    {
+        transfer->inflate_status = inflater_finish(&stream_inflater);
+        if ((INFLATER_DONE != transfer->inflate_status) && (INFLATER_STOPPED != transfer->inflate_status))
+        {
+            ERR_INFO(("Failed to decode the %s body of %s: status %d.\n",
+                      stats->encoding, transfer->path, (int)transfer->inflate_status));
+            result = CY_RSLT_TYPE_ERROR;
+        }
+        transfer->stopped = (INFLATER_STOPPED == transfer->inflate_status);
+    }
+
+    if (transfer->hashing)
+    {
+        stream_digest_finish(&stream_digest, sha256);
+        stats->digest_cycles = stream_digest.cycles;
+
+        /* A transfer stopped by the callback is incomplete and not checked. */
+        if ((CY_RSLT_SUCCESS == result) && !transfer->stopped)
+        {
+            if (0 != memcmp(sha256, transfer->hash_wire ? transfer->header_sha256 : transfer->expected_sha256,
+                            sizeof(sha256)))
+            {
+                ERR_INFO(("SHA-256 of %s does not match its %s digest.\n",
+                          transfer->path, transfer->hash_wire ? "header" : "expected"));
+                result = CY_RSLT_TYPE_ERROR;
+            }
+            else
+            {
+                stats->verified = true;
+            }
+        }
+    }
+
+    /* The connection holds the radio awake, so it is not kept. */
+    http_pipeline_close(&stream_pipeline);
+
+    stats->elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+
+    wifi_power_end();
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_get_range
+ *******************************************************************************
+ * Summary:
+ *  Requests one piece of a resource with an HTTP Range request. The response
+ *  headers and body are received into the given buffer. The caller must own
+ *  the HTTP client.
+ *
+ * Parameters:
+ *  handle - Connected HTTP client instance.
+ *  path - Resource path on the server.
+ *  headers - Additional request headers.
+ *  num_headers - Number of additional request headers.
+ *  buffer - Buffer for the response headers and body.
+ *  buffer_len - Size of the buffer.
+ *  offset - Offset of the first byte of the piece in the resource.
+ *  length - Number of bytes requested.
+ *  response - Filled with the response; the body points into the buffer.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if a 206 response, or a 200 response to
+ *  a request at offset 0, is received, otherwise, it returns an HTTP client
+ *  or CY_RSLT_TYPE_ERROR error code.
+ *
+ *******************************************************************************/
+cy_rslt_t https_get_range(cy_http_client_t handle, const char *path,
+                          cy_http_client_header_t *headers, uint32_t num_headers,
+                          uint8_t *buffer, uint32_t buffer_len, uint32_t offset, uint32_t length,
+                          cy_http_client_response_t *response)
+{
+    cy_rslt_t result;
+    cy_http_client_request_header_t request;
+
+    request.buffer = buffer;
+    request.buffer_len = buffer_len;
+    request.headers_len = HTTP_REQUEST_HEADER_LEN;
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.range_start = (int32_t)offset;
+    request.range_end = (int32_t)(offset + length - 1);
+    request.resource_path = path;
+
+    result = cy_http_client_write_header(handle, &request, headers, num_headers);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to write the Range request header.\n"));
+        return result;
+    }
+
+    result = cy_http_client_send(handle, &request, NULL, 0, response);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to receive %s at offset %lu. Error=%ld\n",
+                  path, (unsigned long)offset, (unsigned long)result));
+        return result;
+    }
+
+    if ((HTTP_STATUS_PARTIAL_CONTENT != response->status_code) &&
+        !((HTTP_STATUS_OK == response->status_code) && (0 == offset)))
+    {
+        ERR_INFO(("Unexpected HTTP status %u at offset %lu.\n",
+                  response->status_code, (unsigned long)offset));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: stream_header
+ *******************************************************************************
+ * Summary:
+ *  Header callback of an https_stream_get() transfer. Reads the
+ *  Content-Encoding of the response and its Repr-Digest header, or its
+ *  legacy Digest header. The digest covers the body as sent, before any
+ *  content decoding.
+ *
+ *******************************************************************************/
+static void stream_header(const char *name, const char *value, void *arg)
+{
+    stream_transfer_t *transfer = (stream_transfer_t *)arg;
+    bool repr_digest = header_value_equals(name, strlen(name), "repr-digest");
+
+    if (transfer->compressed && header_value_equals(name, strlen(name), "content-encoding"))
+    {
+        transfer->encoded = false;
+        transfer->unsupported = false;
+
+        if (header_value_equals(value, strlen(value), "gzip"))
+        {
+            transfer->format = INFLATER_FORMAT_GZIP;
+            transfer->sink.stats->encoding = "gzip";
+            transfer->encoded = true;
+        }
+        else if (header_value_equals(value, strlen(value), "deflate"))
+        {
+            transfer->format = INFLATER_FORMAT_DEFLATE;
+            transfer->sink.stats->encoding = "deflate";
+            transfer->encoded = true;
+        }
+        else if (!header_value_equals(value, strlen(value), "identity"))
+        {
+            ERR_INFO(("Unsupported Content-Encoding %s.\n", value));
+            transfer->unsupported = true;
+        }
+    }
+    else if ((repr_digest || (!transfer->repr_digest && header_value_equals(name, strlen(name), "digest"))) &&
+             stream_digest_parse_header(value, strlen(value), transfer->header_sha256))
+    {
+        transfer->hash_wire = true;
+        transfer->repr_digest = repr_digest;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: stream_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of an https_stream_get() transfer. Hashes the body as
+ *  it arrives and passes it to the body callback, through the decoder if it
+ *  is compressed. The transfer is stopped on the first failure or when the
+ *  body callback stops it.
+ *
+ *******************************************************************************/
+static void stream_response(const http_pipeline_event_t *event, void *arg)
+{
+    stream_transfer_t *transfer = (stream_transfer_t *)arg;
+    https_stream_stats_t *stats = transfer->sink.stats;
+    TickType_t start_ticks = xTaskGetTickCount();
+
+    if (!transfer->started)
+    {
+        transfer->started = true;
+        transfer->result = start_stream(transfer, event->status_code);
+    }
+
+    if (CY_RSLT_SUCCESS != transfer->result)
+    {
+        http_pipeline_stop(&stream_pipeline);
+        return;
+    }
+
+    if (event->complete)
+    {
+        transfer->complete = true;
+        return;
+    }
+
+    stats->wire_bytes += event->length;
+
+    if (transfer->hash_wire)
+    {
+        stream_digest_update(&stream_digest, event->data, event->length);
+    }
+
+    if (transfer->encoded)
+    {
+        /* The decoded data reaches the callback through deliver_decoded(). */
+        transfer->inflate_status = inflater_feed(&stream_inflater, event->data, event->length);
+        if (INFLATER_STOPPED == transfer->inflate_status)
+        {
+            transfer->stopped = true;
+        }
+        else if ((INFLATER_OK != transfer->inflate_status) && (INFLATER_DONE != transfer->inflate_status))
+        {
+            ERR_INFO(("Failed to decode the %s body of %s: status %d.\n",
+                      stats->encoding, transfer->path, (int)transfer->inflate_status));
+            transfer->result = CY_RSLT_TYPE_ERROR;
+        }
+    }
+    else
+    {
+        stats->body_bytes += event->length;
+        if (NULL != transfer->sink.digest)
+        {
+            stream_digest_update(transfer->sink.digest, event->data, event->length);
+        }
+        transfer->stopped = !transfer->sink.body_cb(event->data, event->length, transfer->sink.arg);
+    }
+
+    if (transfer->stopped || (CY_RSLT_SUCCESS != transfer->result))
+    {
+        http_pipeline_stop(&stream_pipeline);
+    }
+
+    transfer->busy_ticks += xTaskGetTickCount() - start_ticks;
+}
+
+/*******************************************************************************
+ * Function Name: start_stream
+ *******************************************************************************
+ * Summary:
+ *  Checks the status of the response of an https_stream_get() transfer,
+ *  once its headers are read, and sets up the decoder and the digest.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, or CY_RSLT_TYPE_ERROR for a status
+ *  other than 200 or a content coding that is not supported.
+ *
+ *******************************************************************************/
+static cy_rslt_t start_stream(stream_transfer_t *transfer, uint16_t status_code)
+{
+    if (HTTP_STATUS_OK != status_code)
+    {
+        ERR_INFO(("Unexpected HTTP status %u for %s.\n", status_code, transfer->path));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (transfer->unsupported)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (transfer->encoded &&
+        (INFLATER_OK != inflater_init(&stream_inflater, transfer->format, inflate_window, sizeof(inflate_window),
+                                      deliver_decoded, &transfer->sink)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    /* A digest header covers the bytes as sent, before decoding. */
+    if (NULL != transfer->expected_sha256)
+    {
+        transfer->hash_wire = false;
+        transfer->sink.digest = &stream_digest;
+    }
+    transfer->hashing = (NULL != transfer->sink.digest) || transfer->hash_wire;
+    if (transfer->hashing)
+    {
+        stream_digest_start(&stream_digest, STREAM_DIGEST_DEFAULT_ENGINE);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: deliver_decoded
+ *******************************************************************************
+ * Summary:
+ *  Output callback of the decoder. Passes decoded data to the body callback
+ *  of the transfer.
+ *
+ *******************************************************************************/
+static bool deliver_decoded(const uint8_t *data, size_t length, void *arg)
+{
+    stream_sink_t *sink = (stream_sink_t *)arg;
+
+    sink->stats->body_bytes += (uint32_t)length;
+    if (NULL != sink->digest)
+    {
+        stream_digest_update(sink->digest, data, (uint32_t)length);
+    }
+
+    return sink->body_cb(data, (uint32_t)length, sink->arg);
+}
+
+/*******************************************************************************
+ * Function Name: header_value_equals
+ *******************************************************************************
+ * Summary:
+ *  Compares a header value with a token, ignoring the case and surrounding
+ *  white space.
+ *
+ *******************************************************************************/
+static bool header_value_equals(const char *value, size_t length, const char *token)
+{
+    size_t token_len = strlen(token);
+    size_t index;
+
+    while ((length > 0) && (' ' == *value))
+    {
+        value++;
+        length--;
+    }
+    while ((length > 0) && (' ' == value[length - 1]))
+    {
+        length--;
+    }
+
+    if (length != token_len)
+    {
+        return false;
+    }
+
+    for (index = 0; index < length; index++)
+    {
+        if (tolower((unsigned char)value[index]) != token[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: https_content_range_total
+ *******************************************************************************
+ * Summary:
+ *  Reads the complete length from a "Content-Range: bytes first-last/total"
+ *  response header.
+ *
+ * Parameters:
+ *  handle - HTTP client instance.
+ *  response - Response of a Range request.
+ *
+ * Return:
+ *  uint32_t: Complete length of the resource, or 0 if the header is missing.
+ *
+ *******************************************************************************/
+uint32_t https_content_range_total(cy_http_client_t handle, cy_http_client_response_t *response)
+{
+    cy_http_client_header_t header;
+    uint32_t total = 0;
+    uint32_t index;
+
+    header.field = "Content-Range";
+    header.field_len = sizeof("Content-Range") - 1;
+    header.value = NULL;
+    header.value_len = 0;
+
+    if ((CY_RSLT_SUCCESS != cy_http_client_read_header(handle, response, &header, 1)) ||
+        (NULL == header.value))
+    {
+        return 0;
+    }
+
+    for (index = 0; (index < header.value_len) && (header.value[index] != '/'); index++)
+    {
+    }
+
+    for (index++; (index < header.value_len) &&
+                  (header.value[index] >= '0') && (header.value[index] <= '9'); index++)
+    {
+        total = (total * 10u) + (uint32_t)(header.value[index] - '0');
+    }
+
+    return total;
+}
+
+/*******************************************************************************
+ * Function Name: https_last_request_head_len
+ *******************************************************************************
+ * Summary:
+ *  Returns the length of the headers of the last request sent with
+ *  https_send_request(), as written by the HTTP client. Used to count the
+ *  bytes of a request when only one task sends requests.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Length of the request line and headers.
+ *
+ *******************************************************************************/
+uint32_t https_last_request_head_len(void)
+{
+    return last_request_head_len;
+}
+
+/*******************************************************************************
+ * Function Name: https_last_retry
+ *******************************************************************************
+ * Summary:
+ *  Returns the retry state of the last request sent with
+ *  https_send_request(), with the attempts it took and the time it waited
+ *  between them.
+ *
+ * Parameters:
+ *  state - Filled with the retry state.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void https_last_retry(retry_state_t *state)
+{
+    xSemaphoreTake(https_client_mutex, portMAX_DELAY);
+    *state = last_retry;
+    xSemaphoreGive(https_client_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: fetch_https_client_method
+ *******************************************************************************
+ * Summary:
+ *  The function handles an http methods.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void fetch_https_client_method(void)
+{
+
+    /* Status variable */
+    uint8_t uart_read_value;
+    uint8_t uart_read_integer;
+
+    /* Options to select the method*/
+    printf("\n===============================================================\n");
+    printf(MENU_HTTPS_METHOD);
+    printf("\n===============================================================\n");
+
+    /* Reading option number from console */
+    while (cyhal_uart_getc(&cy_retarget_io_uart_obj, &uart_read_value, 1) != CY_RSLT_SUCCESS);
+    /* Converting ASCII character to Integer value */
+    if ((uart_read_value >= 'a') && (uart_read_value <= 'z'))
+    {
+        uart_read_integer = (uart_read_value - 'a') + MENU_FIRST_LETTER_OPTION;
+    }
+    else
+    {
+        uart_read_integer = uart_read_value - ASCII_INTEGER_DIFFERENCE;
+    }
+
+    switch(uart_read_integer)
+    {
+         case HTTPS_GET_METHOD:
+         {
+             printf("\n HTTP GET Request..\n");
+             http_client_method = CY_HTTP_CLIENT_METHOD_GET;
+             break;
+         }
+         case HTTPS_POST_METHOD:
+         {
+             printf("\n HTTP POST Request..\n");
+             http_client_method = CY_HTTP_CLIENT_METHOD_POST;
+             break;
+         }
+         case HTTPS_PUT_METHOD:
+         {
+             printf("\n HTTP PUT Request..\n");
+             http_client_method = CY_HTTP_CLIENT_METHOD_PUT;
+             break;
+         }
+         case HTTPS_GET_METHOD_AFTER_PUT:
+         {
+             printf("\n HTTP GET FOR PUT Request..\n");
+             http_client_method = CY_HTTP_CLIENT_METHOD_GET;
+             get_after_put_flag = true;
+             break;
+         }
+         case HTTPS_DOWNLOAD_TO_FLASH:
+         {
+             printf("\n HTTP GET to external flash Request..\n");
+             download_to_flash();
+             return;
+         }
+         case HTTPS_TELEMETRY_BATCH:
+         {
+             printf("\n HTTP POST of batched telemetry..\n");
+             telemetry_batch_demo();
+             return;
+         }
+         case HTTPS_CBOR_REQUEST:
+         {
+             printf("\n HTTP POST of a CBOR sample..\n");
+             payload_codec_benchmark();
+             payload_codec_request();
+             return;
+         }
+         case HTTPS_JSON_STREAM:
+         {
+             printf("\n HTTP GET of a JSON document through the streaming parser..\n");
+             stream_json_config();
+             return;
+         }
+         case HTTPS_COMPRESSION_COMPARE:
+         {
+             printf("\n HTTP GET with and without compression..\n");
+             compare_compression();
+             return;
+         }
+         case HTTPS_COMPRESSED_UPLOAD:
+         {
+             printf("\n HTTP POST of a log with compressed bodies..\n");
+             compressed_upload_demo();
+             return;
+         }
+         case HTTPS_PIPELINE_BENCHMARK:
+         {
+             printf("\n HTTP GET requests with and without pipelining..\n");
+             http_pipeline_benchmark();
+             return;
+         }
+         case HTTPS_WEBSOCKET:
+         {
+             printf("\n WebSocket commands compared with GET polling..\n");
+             websocket_demo();
+             return;
+         }
+         case HTTPS_SERVER_SENT_EVENTS:
+         {
+             printf("\n Server-Sent Events received from a long-lived GET..\n");
+             sse_demo();
+             return;
+         }
+         case HTTPS_MQTT_BENCHMARK:
+         {
+             printf("\n Small messages over MQTT compared with HTTPS POST..\n");
+             mqtt_transport_benchmark();
+             return;
+         }
+         case HTTPS_COAP_DTLS:
+         {
+             printf("\n One report over CoAP/DTLS compared with HTTPS..\n");
+             coap_demo();
+             return;
+         }
+         case HTTPS_HTTP2_BENCHMARK:
+         {
+             printf("\n Concurrent requests over HTTP/2 streams and HTTP/1.1 connections..\n");
+             http2_client_benchmark();
+             return;
+         }
+         case HTTPS_REQUEST_SCHEDULER:
+         {
+             printf("\n Urgent request latency during a bulk upload..\n");
+             request_scheduler_simulate();
+             request_scheduler_benchmark();
+             return;
+         }
+         case HTTPS_RETRY_POLICY:
+         {
+             printf("\n Retries of a fleet after an outage, and of injected faults..\n");
+             retry_policy_simulate();
+             retry_policy_demo();
+             return;
+         }
+         case HTTPS_RESPONSE_CACHE:
+         {
+             printf("\n Cached GET requests replayed from a device trace..\n");
+             response_cache_replay_trace();
+             fetch_cached_config();
+             return;
+         }
+         case HTTPS_DELTA_SYNC:
+         {
+             printf("\n Delta sync of the flash copy of %s..\n", FLASH_DOWNLOAD_PATH);
+             delta_sync_benchmark();
+             sync_flash_asset();
+             return;
+         }
+         case HTTPS_FIRMWARE_UPDATE:
+         {
+             printf("\n Firmware update from a patch of the running image..\n");
+             firmware_update_benchmark();
+             update_firmware();
+             return;
+         }
+         case HTTPS_DIGEST_BENCHMARK:
+         {
+             printf("\n Streaming SHA-256 verification benchmark..\n");
+             stream_digest_benchmark();
+             return;
+         }
+         case HTTPS_REQUEST_COALESCING:
+         {
+             printf("\n Request headers and body in one write or two..\n");
+             compare_request_coalescing();
+             return;
+         }
+         case HTTPS_ZERO_COPY_UPLOAD:
+         {
+             printf("\n Upload of a flash-resident body from RAM copies and in place..\n");
+             body_source_benchmark();
+             return;
+         }
+         case HTTPS_LWIP_PROFILE:
+         {
+             printf("\n Throughput and RAM of the lwIP profile in the build..\n");
+             lwip_profile_benchmark();
+             return;
+         }
+         case HTTPS_WIFI_POWER_SAVE:
+         {
+             printf("\n Latency and radio energy of bursty requests per power-save policy..\n");
+             wifi_power_benchmark();
+             return;
+         }
+         case HTTPS_WLAN_OFFLOAD:
+         {
+             printf("\n Host wakeups and reconnects of an idle connection without and with WLAN offloads..\n");
+             wlan_offload_benchmark();
+             return;
+         }
+         case HTTPS_PERIODIC_JOBS:
+         {
+             printf("\n Wakeups and active time of periodic jobs without and with slack..\n");
+             periodic_jobs_benchmark();
+             return;
+         }
+        default:
+        {
+            printf("\x1b[2J\x1b[;H");
+            printf("\r\nPlease select from the given valid options\r\n");
+        }
+    }
+
+    /* Send the HTTP request and body to the server, and receive the status from it. */
+    http_request();
+}
+
+/*******************************************************************************
+ * Function Name: http_request
+ *******************************************************************************
+ * Summary:
+ *  The function handles an http request operation. A POST or PUT request that
+ *  cannot be delivered is queued in flash, and the queue is replayed as soon
+ *  as a request goes through again.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void http_request(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    const char *path = HTTP_PATH;
+    https_request_t request = {0};
+
+    if(get_after_put_flag)
+    {
+        get_after_put_flag = false;
+        path = HTTP_GET_PATH_AFTER_PUT;
+    }
+
+    request.method = http_client_method;
+    request.path = path;
+    request.body = (const uint8_t *)REQUEST_BODY;
+    request.body_len = REQUEST_BODY_LENGTH;
+    request.retry = &retry_default_policy;
+
+    /* Send the HTTP request and body to the server, and receive the response from it. */
+    result = https_send_request(&request);
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        ERR_INFO(("Failed to send the http request.\n"));
+
+        if ((CY_HTTP_CLIENT_METHOD_POST == http_client_method) || (CY_HTTP_CLIENT_METHOD_PUT == http_client_method))
+        {
+            if (CY_RSLT_SUCCESS == offline_queue_enqueue(http_client_method, path,
+                                                         (const uint8_t *)REQUEST_BODY, REQUEST_BODY_LENGTH))
+            {
+                APP_INFO(("Request queued in flash, %lu pending\n", (unsigned long)offline_queue_pending()));
+            }
+        }
+    }
+    else
+    {
+        printf("\r\n Successfully sent GET request to http server\r\n");
+        printf("\r\n The http status code is :: %d\r\n",http_response.status_code);
+
+        replay_offline_queue();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fetch_cached_config
+ *******************************************************************************
+ * Summary:
+ *  Fetches HTTP_CONFIG_PATH twice through the response cache. The second
+ *  request is served from the flash while the entry is fresh, and is
+ *  revalidated with a conditional request otherwise.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void fetch_cached_config(void)
+{
+    https_request_t request = {0};
+    response_cache_stats_t before;
+    response_cache_stats_t after;
+
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.path = HTTP_CONFIG_PATH;
+    request.retry = &retry_default_policy;
+    request.cached = true;
+
+    response_cache_get_stats(&before);
+
+    for (uint32_t i = 0; i < 2u; i++)
+    {
+        if (CY_RSLT_SUCCESS != https_send_request(&request))
+        {
+            ERR_INFO(("Failed to fetch %s.\n", HTTP_CONFIG_PATH));
+            return;
+        }
+    }
+
+    response_cache_get_stats(&after);
+    APP_INFO(("%s: %lu served fresh, %lu revalidated, %lu fetched\n", HTTP_CONFIG_PATH,
+              (unsigned long)(after.fresh - before.fresh),
+              (unsigned long)(after.not_modified - before.not_modified),
+              (unsigned long)(after.misses - before.misses)));
+}
+
+/*******************************************************************************
+ * Function Name: replay_offline_queue
+ *******************************************************************************
+ * Summary:
+ *  Queues the replay of the requests queued in flash while the server was
+ *  unreachable in the bulk lane of the request scheduler, so that urgent
+ *  requests are not held back. Records posted to the same path are combined
+ *  into batches, see offline_queue_peek_batch(). Returns at once, so it can
+ *  be called with the HTTP client mutex held.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void replay_offline_queue(void)
+{
+    bool queued;
+
+    if (0 == offline_queue_pending())
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    queued = replay_queued;
+    replay_queued = true;
+    taskEXIT_CRITICAL();
+
+    if (queued)
+    {
+        return;
+    }
+
+    APP_INFO(("Replaying %lu queued request(s)\n", (unsigned long)offline_queue_pending()));
+
+    memset(&replay_stats, 0, sizeof(replay_stats));
+    replay_accepted = true;
+
+    if (CY_RSLT_SUCCESS != request_scheduler_submit_bulk(replay_next_batch, replay_done, NULL))
+    {
+        ERR_INFO(("The bulk lane is full, the replay is left for the next connection.\n"));
+        replay_queued = false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: replay_next_batch
+ *******************************************************************************
+ * Summary:
+ *  Removes the batch of the previous chunk from the queue once the server
+ *  accepted it, and fills the request of the next batch. The replay stops at
+ *  the first batch that is not accepted, which stays queued.
+ *
+ *******************************************************************************/
+static bool replay_next_batch(uint32_t chunk, https_request_t *request, void *arg)
+{
+    (void)arg;
+
+    if (0u != chunk)
+    {
+        if (!replay_accepted)
+        {
+            return false;
+        }
+
+        offline_queue_consume_batch(&replay_batch);
+        replay_stats.records += replay_batch.records;
+        replay_stats.requests++;
+        replay_stats.bytes += (uint32_t)strlen(replay_batch.path) + replay_batch.body_len;
+    }
+
+    if ((CY_RSLT_SUCCESS != offline_queue_peek_batch(&replay_batch)) || (0u == replay_batch.records))
+    {
+        return false;
+    }
+
+    memset(request, 0, sizeof(*request));
+    request->method = replay_batch.method;
+    request->path = replay_batch.path;
+    request->body = replay_batch.body;
+    request->body_len = replay_batch.body_len;
+    request->response_cb = replay_response;
+    request->quiet = true;
+    replay_accepted = false;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: replay_response
+ *******************************************************************************
+ * Summary:
+ *  Records whether the server accepted the replayed batch.
+ *
+ *******************************************************************************/
+static void replay_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    (void)handle;
+    (void)arg;
+
+    replay_accepted = (response->status_code >= HTTP_STATUS_OK) &&
+                      (response->status_code < HTTP_STATUS_MULTIPLE_CHOICES);
+    if (!replay_accepted)
+    {
+        ERR_INFO(("The server answered %d to a replayed request.\n", response->status_code));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: replay_done
+ *******************************************************************************
+ * Summary:
+ *  Prints the replay throughput when the replay is complete.
+ *
+ *******************************************************************************/
+static void replay_done(cy_rslt_t result, uint32_t latency_ms, void *arg)
+{
+    (void)arg;
+
+    replay_stats.elapsed_ms = latency_ms;
+    if (latency_ms > 0)
+    {
+        replay_stats.records_per_sec = (replay_stats.records * 1000u) / latency_ms;
+    }
+
+    APP_INFO(("Replayed %lu request(s) in %lu batch(es), %lu bytes in %lu ms (%lu requests/s)\n",
+              (unsigned long)replay_stats.records, (unsigned long)replay_stats.requests,
+              (unsigned long)replay_stats.bytes, (unsigned long)replay_stats.elapsed_ms,
+              (unsigned long)replay_stats.records_per_sec));
+
+    if ((CY_RSLT_SUCCESS != result) || !replay_accepted)
+    {
+        ERR_INFO(("Replay stopped, %lu request(s) still queued.\n", (unsigned long)offline_queue_pending()));
+    }
+
+    replay_queued = false;
+}
+
+/*******************************************************************************
+ * Function Name: download_to_flash
+ *******************************************************************************
+ * Summary:
+ *  Streams FLASH_DOWNLOAD_PATH into the external flash and prints the
+ *  throughput and the overlap of the network receive with the flash writes.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void download_to_flash(void)
+{
+    cy_rslt_t result;
+    flash_download_stats_t stats = {0};
+
+    result = take_connected_client();
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = flash_download(https_client, FLASH_DOWNLOAD_PATH, FLASH_DOWNLOAD_FLASH_ADDRESS, NULL, &stats);
+    }
+    give_client(result);
+    flash_download_print_stats(&stats);
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        ERR_INFO(("Failed to download %s to the external flash, the copy is marked invalid.\n",
+                  FLASH_DOWNLOAD_PATH));
+    }
+    else
+    {
+        printf("\r\n Successfully downloaded %s to the external flash\r\n", FLASH_DOWNLOAD_PATH);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sync_flash_asset
+ *******************************************************************************
+ * Summary:
+ *  Brings the copy of FLASH_DOWNLOAD_PATH stored by download_to_flash() up to
+ *  date with the server, fetching only the blocks that changed according to
+ *  the block-hash manifest of the resource.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void sync_flash_asset(void)
+{
+    cy_rslt_t result;
+    delta_sync_stats_t stats = {0};
+
+    if (!flash_download_is_valid(FLASH_DOWNLOAD_FLASH_ADDRESS, NULL))
+    {
+        APP_INFO(("No valid copy of %s in the external flash, the blocks that differ are fetched.\n",
+                  FLASH_DOWNLOAD_PATH));
+    }
+
+    result = take_connected_client();
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = delta_sync(https_client, FLASH_DOWNLOAD_PATH, FLASH_DOWNLOAD_FLASH_ADDRESS, &stats);
+    }
+    give_client(result);
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        ERR_INFO(("Failed to sync %s in the external flash.\n", FLASH_DOWNLOAD_PATH));
+    }
+    else
+    {
+        delta_sync_print_stats(&stats);
+        printf("\r\n Successfully synced %s in the external flash\r\n", FLASH_DOWNLOAD_PATH);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: update_firmware
+ *******************************************************************************
+ * Summary:
+ *  Applies FIRMWARE_UPDATE_PATCH_PATH to the running image and stages the
+ *  new image in the secondary slot.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void update_firmware(void)
+{
+    cy_rslt_t result;
+    firmware_update_stats_t stats = {0};
+
+    result = firmware_update_apply(FIRMWARE_UPDATE_PATCH_PATH, &stats);
+
+    if( result != CY_RSLT_SUCCESS )
+    {
+        ERR_INFO(("Failed to apply %s to the running image.\n", FIRMWARE_UPDATE_PATCH_PATH));
+    }
+    else
+    {
+        firmware_update_print_stats(&stats);
+        printf("\r\n Successfully staged the new image in the secondary slot\r\n");
+        printf(" Reset the device to install it; the bootloader swaps it in\r\n");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: stream_json_config
+ *******************************************************************************
+ * Summary:
+ *  Streams HTTPS_JSON_STREAM_PATH through the JSON parser, extracts a few
+ *  configuration fields, and prints them with the parser cost per byte.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void stream_json_config(void)
+{
+    cy_rslt_t result;
+    json_stream_status_t status;
+    json_feed_t feed = {0};
+    https_stream_stats_t stats;
+    char device_name[32] = "";
+    char server_host[64] = "";
+    int32_t report_interval_ms = 0;
+    bool telemetry_enabled = false;
+    json_field_t fields[] =
+    {
+        { "device.name",           JSON_FIELD_STRING, device_name,         sizeof(device_name), false },
+        { "servers[0].host",       JSON_FIELD_STRING, server_host,         sizeof(server_host), false },
+        { "telemetry.interval_ms", JSON_FIELD_INT,    &report_interval_ms, 0,                   false },
+        { "telemetry.enabled",     JSON_FIELD_BOOL,   &telemetry_enabled,  0,                   false },
+    };
+    json_extract_t extract = { fields, sizeof(fields) / sizeof(fields[0]), false };
+
+    json_stream_init(&feed.parser, json_extract_cb, &extract);
+    cycle_counter_enable();
+
+    result = https_stream_get(HTTPS_JSON_STREAM_PATH, "application/json", true, NULL, feed_json_parser, &feed,
+                              &stats);
+    status = json_stream_finish(&feed.parser);
+
+    if ((CY_RSLT_SUCCESS != result) || (JSON_STREAM_OK != status))
+    {
+        ERR_INFO(("Failed to parse %s: status %d at byte %lu.\n", HTTPS_JSON_STREAM_PATH,
+                  (int)status, (unsigned long)feed.parser.offset));
+        return;
+    }
+
+    APP_INFO(("device.name           = %s\n", fields[0].found ? device_name : "<missing>"));
+    APP_INFO(("servers[0].host       = %s\n", fields[1].found ? server_host : "<missing>"));
+    APP_INFO(("telemetry.interval_ms = %ld\n", (long)report_interval_ms));
+    APP_INFO(("telemetry.enabled     = %s\n", telemetry_enabled ? "true" : "false"));
+    APP_INFO(("Received %lu %s bytes in %lu ms\n", (unsigned long)stats.wire_bytes, stats.encoding,
+              (unsigned long)stats.elapsed_ms));
+    APP_INFO(("Parsed %lu bytes in %lu chunk(s), %lu cycles/byte, %u bytes of parser state\n",
+              (unsigned long)feed.bytes, (unsigned long)feed.chunks,
+              (unsigned long)((feed.bytes > 0) ? (feed.cycles / feed.bytes) : 0),
+              (unsigned int)sizeof(json_stream_t)));
+}
+
+/*******************************************************************************
+ * Function Name: feed_json_parser
+ *******************************************************************************
+ * Summary:
+ *  Body callback of stream_json_config(). Feeds a body chunk to the parser
+ *  and counts the cycles spent parsing.
+ *
+ * Parameters:
+ *  data - Body chunk.
+ *  length - Length of the chunk.
+ *  arg - json_feed_t of the transfer.
+ *
+ * Return:
+ *  bool: false to stop the transfer once the parser has stopped.
+ *
+ *******************************************************************************/
+static bool feed_json_parser(const uint8_t *data, uint32_t length, void *arg)
+{
+    json_feed_t *feed = (json_feed_t *)arg;
+    json_stream_status_t status;
+    uint32_t start = cycle_counter_get();
+
+    status = json_stream_feed(&feed->parser, data, length);
+
+    feed->cycles += cycle_counter_get() - start;
+    feed->bytes += length;
+    feed->chunks++;
+
+    return (JSON_STREAM_OK == status);
+}
+
+/*******************************************************************************
+ * Function Name: compare_compression
+ *******************************************************************************
+ * Summary:
+ *  Fetches HTTPS_COMPRESSION_TEST_PATH without and with compression and
+ *  prints the bytes on the wire, the download time, and the radio-on time of
+ *  both transfers.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void compare_compression(void)
+{
+    cy_rslt_t result;
+    https_stream_stats_t stats[2];
+    uint32_t crc[2] = { 0, 0 };
+    uint32_t index;
+
+    for (index = 0; index < 2; index++)
+    {
+        result = https_stream_get(HTTPS_COMPRESSION_TEST_PATH, NULL, (1u == index), NULL, crc_body, &crc[index],
+                                  &stats[index]);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to fetch %s.\n", HTTPS_COMPRESSION_TEST_PATH));
+            return;
+        }
+    }
+
+    printf("\n  %-9s %10s %10s %9s %10s %9s\n", "encoding", "wire B", "body B", "requests", "time ms", "radio ms");
+    for (index = 0; index < 2; index++)
+    {
+        printf("  %-9s %10lu %10lu %9lu %10lu %9lu\n", stats[index].encoding,
+               (unsigned long)stats[index].wire_bytes, (unsigned long)stats[index].body_bytes,
+               (unsigned long)stats[index].requests, (unsigned long)stats[index].elapsed_ms,
+               (unsigned long)stats[index].radio_ms);
+    }
+
+    if ((crc[0] != crc[1]) || (stats[0].body_bytes != stats[1].body_bytes))
+    {
+        ERR_INFO(("The decoded body differs from the uncompressed one.\n"));
+    }
+    else if (stats[1].wire_bytes > 0)
+    {
+        APP_INFO(("Compression ratio %lu.%02lu\n",
+                  (unsigned long)(stats[0].wire_bytes / stats[1].wire_bytes),
+                  (unsigned long)(((stats[0].wire_bytes % stats[1].wire_bytes) * 100u) / stats[1].wire_bytes)));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: crc_body
+ *******************************************************************************
+ * Summary:
+ *  Body callback of compare_compression(). Accumulates the CRC-32 of the
+ *  body.
+ *
+ *******************************************************************************/
+static bool crc_body(const uint8_t *data, uint32_t length, void *arg)
+{
+    *(uint32_t *)arg = inflater_crc32(*(uint32_t *)arg, data, length);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: compare_request_coalescing
+ *******************************************************************************
+ * Summary:
+ *  Sends HTTPS_COALESCE_BENCH_REQUESTS POST requests of each body size with
+ *  the body written after the headers and with it in the header write, and
+ *  prints the time per request of both. The TCP segments sent per request,
+ *  acknowledgements included, are read from the lwIP counters in a build
+ *  with WLAN_OFFLOAD_COUNT_FRAMES, and are otherwise estimated from the
+ *  lengths sent with HTTPS_TCP_MSS. The TLS records are one per write, and
+ *  the bytes on the wire add HTTPS_TLS_RECORD_OVERHEAD per record and
+ *  HTTPS_TCP_IP_HEADER_LEN per segment to the lengths sent.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void compare_request_coalescing(void)
+{
+    static const uint32_t body_sizes[] = HTTPS_COALESCE_BENCH_BODY_SIZES;
+    static uint8_t body[HTTP_GET_BUFFER_LENGTH / 2];
+    https_request_t request = {0};
+    uint32_t errors = 0;
+    uint32_t elapsed_ms;
+    uint32_t records;
+    uint32_t segments;
+    uint32_t wire_bytes;
+    uint32_t head_len;
+    TickType_t start_ticks;
+#if TCP_STATS
+    STAT_COUNTER start_segments;
+#endif
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    memset(body, 'x', sizeof(body));
+
+    request.method = CY_HTTP_CLIENT_METHOD_POST;
+    request.path = HTTPS_COALESCE_BENCH_PATH;
+    request.body = body;
+    request.response_cb = count_error_response;
+    request.cb_arg = &errors;
+    request.quiet = true;
+
+#if !TCP_STATS
+    APP_INFO(("Built without WLAN_OFFLOAD_COUNT_FRAMES: segments and wire bytes are estimated.\n"));
+#endif
+    APP_INFO(("%u POST requests to %s per body size and mode\n", HTTPS_COALESCE_BENCH_REQUESTS,
+              HTTPS_COALESCE_BENCH_PATH));
+    printf("\n  %6s %-10s %8s %8s %9s %10s\n", "body B", "mode", "records", "segments", "wire B", "ms/request");
+
+    for (uint32_t size = 0; size < (sizeof(body_sizes) / sizeof(body_sizes[0])); size++)
+    {
+        request.body_len = (body_sizes[size] < sizeof(body)) ? body_sizes[size] : sizeof(body);
+
+        for (uint32_t mode = 0; mode < 2; mode++)
+        {
+            coalesce_requests = (1u == mode);
+
+            /* The first request opens the connection and is not timed. */
+            result = https_send_request(&request);
+            start_ticks = xTaskGetTickCount();
+#if TCP_STATS
+            start_segments = lwip_stats.tcp.xmit;
+#endif
+            for (uint32_t i = 0; (CY_RSLT_SUCCESS == result) && (i < HTTPS_COALESCE_BENCH_REQUESTS); i++)
+            {
+                result = https_send_request(&request);
+            }
+            elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+
+            if (CY_RSLT_SUCCESS != result)
+            {
+                ERR_INFO(("The POST failed: 0x%08lx\n", (unsigned long)result));
+                coalesce_requests = HTTPS_COALESCE_REQUESTS;
+                return;
+            }
+
+            /* The head and the body are one TLS write each unless coalesced. */
+            head_len = https_last_request_head_len();
+            records = coalesce_requests ? 1u : 2u;
+#if TCP_STATS
+            segments = (uint32_t)(STAT_COUNTER)(lwip_stats.tcp.xmit - start_segments) /
+                       HTTPS_COALESCE_BENCH_REQUESTS;
+#else
+            if (coalesce_requests)
+            {
+                segments = (head_len + request.body_len + HTTPS_TLS_RECORD_OVERHEAD + HTTPS_TCP_MSS - 1u) /
+                           HTTPS_TCP_MSS;
+            }
+            else
+            {
+                segments = ((head_len + HTTPS_TLS_RECORD_OVERHEAD + HTTPS_TCP_MSS - 1u) / HTTPS_TCP_MSS) +
+                           ((request.body_len + HTTPS_TLS_RECORD_OVERHEAD + HTTPS_TCP_MSS - 1u) / HTTPS_TCP_MSS);
+            }
+#endif
+            wire_bytes = head_len + request.body_len + (records * HTTPS_TLS_RECORD_OVERHEAD) +
+                         (segments * HTTPS_TCP_IP_HEADER_LEN);
+
+            printf("  %6lu %-10s %8lu %8lu %9lu %10lu\n", (unsigned long)request.body_len,
+                   coalesce_requests ? "coalesced" : "separate", (unsigned long)records,
+                   (unsigned long)segments, (unsigned long)wire_bytes,
+                   (unsigned long)(elapsed_ms / HTTPS_COALESCE_BENCH_REQUESTS));
+        }
+    }
+
+    coalesce_requests = HTTPS_COALESCE_REQUESTS;
+
+    if (0u != errors)
+    {
+        ERR_INFO(("%lu requests had an error status.\n", (unsigned long)errors));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: count_error_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of compare_request_coalescing(). Counts the responses
+ *  with an error status.
+ *
+ *******************************************************************************/
+static void count_error_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+    (void)handle;
+
+    if (response->status_code >= 400u)
+    {
+        (*(uint32_t *)arg)++;
+    }
+}
+
+/* [] END OF FILE */
@@ -52,6 +52,8 @@
 #include "cybsp.h"
 #include "cy_network_mw_core.h"
 #include "cyhal_gpio.h"
+#include "cy_http_client_api.h"
+#include "retry_policy.h"
 
 #define TEST_INFO( x )                        printf x
 
@@ -85,11 +87,75 @@
 #define TRANSPORT_SEND_RECV_TIMEOUT_MS           (5000)
 #define HTTP_GET_BUFFER_LENGTH                   (2048)
 #define ASCII_INTEGER_DIFFERENCE                 (48)
+
+/* Menu options after 9 are selected with the letters from 'a'. */
+#define MENU_FIRST_LETTER_OPTION                 (10)
 #define REQUEST_BODY                             "/myhellomessage=Hello!"
 #define HTTP_PATH                                "/"
 #define HTTP_GET_PATH_AFTER_PUT                  "/myhellomessage"
+/* Device configuration, fetched through the response cache by the
+ * "Response cache" menu option. Only such slowly changing resources opt in
+ * to the cache; the requests of the basic menu options are not cached.
+ */
+#define HTTP_CONFIG_PATH                         "/config.json"
 #define REQUEST_BODY_LENGTH                      ( sizeof( REQUEST_BODY ) - 1U )
 
+/* HTTP status codes checked by the application. */
+#define HTTP_STATUS_OK                           (200u)
+#define HTTP_STATUS_PARTIAL_CONTENT              (206u)
+#define HTTP_STATUS_MULTIPLE_CHOICES             (300u)
+#define HTTP_STATUS_NOT_MODIFIED                 (304u)
+#define HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE       (415u)
+#define HTTP_STATUS_TOO_MANY_REQUESTS            (429u)
+#define HTTP_STATUS_BAD_GATEWAY                  (502u)
+#define HTTP_STATUS_SERVICE_UNAVAILABLE          (503u)
+#define HTTP_STATUS_GATEWAY_TIMEOUT              (504u)
+
+/* Room for the Accept and Accept-Encoding headers of https_stream_get(). */
+#define HTTPS_STREAM_HEADERS_SIZE                (128)
+
+/* Resource streamed through the JSON parser by the "stream JSON" menu option. */
+#define HTTPS_JSON_STREAM_PATH                   "/config.json"
+
+/* Content codings accepted by https_stream_get() for compressed transfers. */
+#define HTTPS_ACCEPT_ENCODING                    "gzip, deflate"
+
+/* Window of the decoder of compressed bodies, a power of two from 4 KB to
+ * 32 KB. It must not be smaller than the window the server compresses with,
+ * which is 32 KB with the default settings of zlib.
+ */
+#define HTTPS_INFLATE_WINDOW_SIZE                (32 * 1024)
+
+/* Compressible resource fetched with and without compression by the
+ * "compression comparison" menu option.
+ */
+#define HTTPS_COMPRESSION_TEST_PATH              "/compressible.txt"
+
+/* Write the body of a request in the same buffer as its headers when both
+ * fit in http_get_buffer, so that the request leaves in one TLS record and,
+ * up to the MSS, one TCP segment. A separate body write costs another record
+ * and, on a socket with Nagle's algorithm, waits for the ACK of the headers.
+ */
+#define HTTPS_COALESCE_REQUESTS                  (true)
+
+/* "Request coalescing" menu option: POST requests of each body size sent
+ * with the body written separately and with it coalesced.
+ */
+#define HTTPS_COALESCE_BENCH_PATH                "/telemetry"
+#define HTTPS_COALESCE_BENCH_REQUESTS            (20u)
+#define HTTPS_COALESCE_BENCH_BODY_SIZES          { 32u, 256u, 1024u }
+
+/* Wire model of the option: TLS record overhead of AES-GCM (header, explicit
+ * nonce, and tag), TCP/IP headers, and the MSS of the lwIP configuration,
+ * which estimates the segments when lwIP does not count them.
+ */
+#define HTTPS_TLS_RECORD_OVERHEAD                (29u)
+#define HTTPS_TCP_IP_HEADER_LEN                  (40u)
+#define HTTPS_TCP_MSS                            (1460u)
+
+/* Media type of the request bodies unless the caller specifies another one. */
+#define HTTP_DEFAULT_CONTENT_TYPE                "application/x-www-form-urlencoded"
+
 /* Wi-Fi re-connection time interval in milliseconds */
 #define WIFI_CONN_RETRY_INTERVAL_MSEC            (1000u)
 
@@ -103,6 +169,11 @@
 /*Number of headers in the header list*/
 #define NUM_HTTP_HEADERS                         (1)
 
+/* Maximum number of headers written for a request: Content-Type, Accept,
+ * Content-Encoding, If-None-Match, If-Modified-Since, and Content-Length.
+ */
+#define HTTP_MAX_REQUEST_HEADERS                 (6)
+
 /*Length of the request header.*/
 #define HTTP_REQUEST_HEADER_LEN                  (0)
 
@@ -115,6 +186,30 @@
         "2. HTTPS_POST_METHOD\n"                                                    \
         "3. HTTPS_PUT_METHOD\n"                                                     \
         "4. HTTPS_GET_METHOD_AFTER_PUT\n"                                           \
+        "5. HTTPS_DOWNLOAD_TO_FLASH\n"                                             \
+        "6. HTTPS_TELEMETRY_BATCH\n"                                               \
+        "7. HTTPS_CBOR_REQUEST\n"                                                  \
+        "8. HTTPS_JSON_STREAM\n"                                                   \
+        "9. HTTPS_COMPRESSION_COMPARE\n"                                           \
+        "a. HTTPS_COMPRESSED_UPLOAD\n"                                             \
+        "b. HTTPS_PIPELINE_BENCHMARK\n"                                            \
+        "c. HTTPS_WEBSOCKET\n"                                                     \
+        "d. HTTPS_SERVER_SENT_EVENTS\n"                                            \
+        "e. HTTPS_MQTT_BENCHMARK\n"                                                \
+        "f. HTTPS_COAP_DTLS\n"                                                     \
+        "g. HTTPS_HTTP2_BENCHMARK\n"                                               \
+        "h. HTTPS_REQUEST_SCHEDULER\n"                                             \
+        "i. HTTPS_RETRY_POLICY\n"                                                  \
+        "j. HTTPS_RESPONSE_CACHE\n"                                                \
+        "k. HTTPS_DELTA_SYNC\n"                                                    \
+        "l. HTTPS_FIRMWARE_UPDATE\n"                                               \
+        "m. HTTPS_DIGEST_BENCHMARK\n"                                              \
+        "n. HTTPS_REQUEST_COALESCING\n"                                            \
+        "o. HTTPS_ZERO_COPY_UPLOAD\n"                                              \
+        "p. HTTPS_LWIP_PROFILE\n"                                                  \
+        "q. HTTPS_WIFI_POWER_SAVE\n"                                               \
+        "r. HTTPS_WLAN_OFFLOAD\n"                                                  \
+        "s. HTTPS_PERIODIC_JOBS\n"                                                 \
 
 /******************************************************
  *                   Enumerations
@@ -126,13 +221,107 @@ typedef enum
     HTTPS_POST_METHOD,
     HTTPS_PUT_METHOD,
     HTTPS_GET_METHOD_AFTER_PUT,
+    HTTPS_DOWNLOAD_TO_FLASH,
+    HTTPS_TELEMETRY_BATCH,
+    HTTPS_CBOR_REQUEST,
+    HTTPS_JSON_STREAM,
+    HTTPS_COMPRESSION_COMPARE,
+    HTTPS_COMPRESSED_UPLOAD,
+    HTTPS_PIPELINE_BENCHMARK,
+    HTTPS_WEBSOCKET,
+    HTTPS_SERVER_SENT_EVENTS,
+    HTTPS_MQTT_BENCHMARK,
+    HTTPS_COAP_DTLS,
+    HTTPS_HTTP2_BENCHMARK,
+    HTTPS_REQUEST_SCHEDULER,
+    HTTPS_RETRY_POLICY,
+    HTTPS_RESPONSE_CACHE,
+    HTTPS_DELTA_SYNC,
+    HTTPS_FIRMWARE_UPDATE,
+    HTTPS_DIGEST_BENCHMARK,
+    HTTPS_REQUEST_COALESCING,
+    HTTPS_ZERO_COPY_UPLOAD,
+    HTTPS_LWIP_PROFILE,
+    HTTPS_WIFI_POWER_SAVE,
+    HTTPS_WLAN_OFFLOAD,
+    HTTPS_PERIODIC_JOBS,
 } https_menu_t;
 
+/* Transport of a request sent with https_send_request(). */
+typedef enum
+{
+    REQUEST_TRANSPORT_HTTPS = 0,
+    REQUEST_TRANSPORT_COAP,         /* CoAP over DTLS, see coap_send_https_request(). */
+} request_transport_t;
+
+/******************************************************
+ *                 Type Definitions
+ ******************************************************/
+/* Called with the response of a request while the HTTP client is still owned
+ * by the caller, so the response buffer and headers are valid.
+ */
+typedef void (*https_response_cb_t)(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+
+/* Called with each body chunk of https_stream_get(). Returning false stops
+ * the transfer.
+ */
+typedef bool (*https_body_cb_t)(const uint8_t *data, uint32_t length, void *arg);
+
+/* Statistics of one https_stream_get() transfer. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t requests;           /* Requests sent, one per transfer. */
+    uint32_t wire_bytes;         /* Body bytes received from the server. */
+    uint32_t body_bytes;         /* Body bytes passed to the callback, after decoding. */
+    uint32_t radio_ms;           /* Time spent waiting for the response. */
+    uint32_t elapsed_ms;         /* Time of the whole transfer. */
+    const char *encoding;        /* Content coding of the response. */
+    bool verified;               /* The body matched its digest. */
+    uint32_t digest_cycles;      /* CPU cycles spent hashing the body. */
+} https_stream_stats_t;
+
+/* Request sent with https_send_request(). */
+typedef struct
+{
+    cy_http_client_method_t method;
+    const char *path;
+    const char *content_type;       /* Media type of the body, NULL for HTTP_DEFAULT_CONTENT_TYPE. */
+    const char *accept;             /* Accepted response media types, NULL to omit the header. */
+    const char *content_encoding;   /* Content coding of the body, NULL if not encoded. */
+    const uint8_t *body;
+    uint32_t body_len;
+    https_response_cb_t response_cb;  /* NULL to print the response. */
+    void *cb_arg;
+    bool quiet;                     /* Do not print the request headers. */
+    request_transport_t transport;
+    const retry_policy_t *retry;    /* NULL to send the request once. */
+    bool cached;                    /* GET through the response cache. */
+} https_request_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Credentials of the HTTPS client, also used by the MQTT transport. */
+extern cy_awsport_ssl_credentials_t security_config;
+
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
 void https_client_task(void *arg);
 cy_rslt_t wifi_connect(void);
+cy_rslt_t https_send_request(const https_request_t *request);
+void https_disconnect(void);
+uint32_t https_get_connection_count(void);
+void https_last_retry(retry_state_t *state);
+cy_rslt_t https_stream_get(const char *path, const char *accept, bool compressed,
+                           const uint8_t *expected_sha256, https_body_cb_t body_cb, void *arg,
+                           https_stream_stats_t *stats);
+cy_rslt_t https_get_range(cy_http_client_t handle, const char *path,
+                          cy_http_client_header_t *headers, uint32_t num_headers,
+                          uint8_t *buffer, uint32_t buffer_len, uint32_t offset, uint32_t length,
+                          cy_http_client_response_t *response);
+uint32_t https_content_range_total(cy_http_client_t handle, cy_http_client_response_t *response);
+uint32_t https_last_request_head_len(void);
 #endif /* SECURE_HTTP_CLIENT_H_ */
 
 
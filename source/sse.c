@@ -0,0 +1,851 @@
+/******************************************************************************
+* File Name: sse.c
+*
+* Description: This file contains the Server-Sent Events client. A GET
+* request is held open on a TLS stream and its text/event-stream body is
+* parsed as it arrives, so each event is dispatched as soon as its closing
+* blank line is received. The stream is reopened with Last-Event-ID when it
+* ends or dies.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "secure_http_client.h"
+#include "cycle_counter.h"
+#include "sse.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Response states. The pipeline parses the head and the framing. */
+#define S_HEAD                           (0u)
+#define S_STREAM                         (1u)
+#define S_REJECTED                       (2u)
+#define S_ENDED                          (3u)
+
+/* Event stream line states. */
+#define F_NAME                           (0u)
+#define F_VALUE_START                    (1u)
+#define F_VALUE                          (2u)
+#define F_SKIP                           (3u)
+
+/* Fields of the event stream, set when the colon of a line is reached. */
+#define FIELD_OTHER                      (0u)
+#define FIELD_DATA                       (1u)
+#define FIELD_EVENT                      (2u)
+#define FIELD_ID                         (3u)
+#define FIELD_RETRY                      (4u)
+
+#define HTTP_STATUS_OK                   (200u)
+#define HTTP_STATUS_NO_CONTENT           (204u)
+#define HTTP_STATUS_SERVER_ERROR         (500u)
+
+#define SSE_REQUEST_SIZE                 (384u)
+
+/* Consecutive failed connections after which the delay stops doubling. */
+#define MAX_BACKOFF_SHIFT                (5u)
+
+/* Characters of the data printed by the demo. */
+#define DEMO_PRINT_DATA                  (48)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Totals of the demo events. */
+typedef struct
+{
+    uint32_t events;
+    uint32_t truncated;
+} demo_counts_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static sse_client_t demo_client;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t open_stream(sse_client_t *client);
+static uint32_t reconnect_delay(const sse_client_t *client, uint32_t failures);
+static void handle_header(const char *name, const char *value, void *arg);
+static void handle_response(const http_pipeline_event_t *event, void *arg);
+static bool accept_response(sse_client_t *client, uint16_t status);
+static void parse_events(sse_client_t *client, const uint8_t *data, uint32_t length);
+static void start_value(sse_client_t *client);
+static void append_value(sse_client_t *client, const uint8_t *data, uint32_t length);
+static void end_of_line(sse_client_t *client);
+static void dispatch_event(sse_client_t *client);
+static void start_line(sse_client_t *client);
+static bool demo_callback(const sse_event_t *event, void *arg);
+
+/*******************************************************************************
+ * Function Name: sse_init
+ *******************************************************************************
+ * Summary:
+ *  Prepares a client for an event stream. The last event ID starts empty.
+ *
+ * Parameters:
+ *  client - Client.
+ *  path - Path of the event stream on the HTTPS server.
+ *  callback - Called with each event.
+ *  arg - Argument passed to the callback.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void sse_init(sse_client_t *client, const char *path, sse_cb_t callback, void *arg)
+{
+    memset(client, 0, sizeof(*client));
+    http_pipeline_init(&client->pipeline, 1);
+    client->path = path;
+    client->callback = callback;
+    client->callback_arg = arg;
+    client->retry_ms = SSE_DEFAULT_RETRY_MS;
+}
+
+/*******************************************************************************
+ * Function Name: sse_run
+ *******************************************************************************
+ * Summary:
+ *  Receives the event stream and dispatches its events until the callback
+ *  returns false or the duration ends. When the stream ends or dies it is
+ *  reopened after the reconnection delay, sending the ID of the last event
+ *  received so that the server can resume after it. The stream is closed
+ *  on return.
+ *
+ * Parameters:
+ *  client - Client initialized with sse_init().
+ *  duration_ms - Longest time to run, 0 to run until the callback stops it.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, or CY_RSLT_TYPE_ERROR if the server
+ *  answered with an error or with something other than an event stream.
+ *
+ *******************************************************************************/
+cy_rslt_t sse_run(sse_client_t *client, uint32_t duration_ms)
+{
+    cy_rslt_t result;
+    TickType_t start_ticks = xTaskGetTickCount();
+    uint32_t elapsed_ms = 0;
+    uint32_t delay_ms = 0;
+    uint32_t failures = 0;
+    uint32_t received;
+
+    memset(&client->stats, 0, sizeof(client->stats));
+    client->stop = false;
+    client->refused = false;
+    cycle_counter_enable();
+
+    while (!client->stop)
+    {
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+        if ((0u != duration_ms) && (elapsed_ms >= duration_ms))
+        {
+            break;
+        }
+
+        if (!client->pipeline.stream.connected)
+        {
+            if (0u != delay_ms)
+            {
+                if ((0u != duration_ms) && (delay_ms > (duration_ms - elapsed_ms)))
+                {
+                    delay_ms = duration_ms - elapsed_ms;
+                }
+                vTaskDelay(pdMS_TO_TICKS(delay_ms));
+                delay_ms = 0;
+                continue;
+            }
+
+            if (CY_RSLT_SUCCESS != open_stream(client))
+            {
+                delay_ms = reconnect_delay(client, ++failures);
+                continue;
+            }
+        }
+
+        result = tls_stream_recv(&client->pipeline.stream, client->pipeline.rx_buffer,
+                                 sizeof(client->pipeline.rx_buffer), &received);
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            client->last_rx_ticks = xTaskGetTickCount();
+            client->rx_cycles = cycle_counter_get();
+            client->stats.bytes_received += received;
+
+            if (!http_pipeline_parse(&client->pipeline, client->pipeline.rx_buffer, received) ||
+                (S_REJECTED == client->state))
+            {
+                http_pipeline_close(&client->pipeline);
+                delay_ms = reconnect_delay(client, ++failures);
+            }
+            else if (S_ENDED == client->state)
+            {
+                /* The server ended the response; the stream continues on a new one. */
+                http_pipeline_close(&client->pipeline);
+                failures = 0;
+                delay_ms = client->retry_ms;
+            }
+            continue;
+        }
+
+        if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == result)
+        {
+            if ((uint32_t)(xTaskGetTickCount() - client->last_rx_ticks) * portTICK_PERIOD_MS >= SSE_IDLE_TIMEOUT_MS)
+            {
+                ERR_INFO(("Nothing received on the event stream for %u ms, reopening it.\n",
+                          (unsigned int)SSE_IDLE_TIMEOUT_MS));
+                http_pipeline_close(&client->pipeline);
+            }
+            continue;
+        }
+
+        /* The connection closed. A stream that was open is resumed after the
+         * delay set by the server, and a failed one is retried with backoff.
+         */
+        http_pipeline_close(&client->pipeline);
+        if (S_STREAM == client->state)
+        {
+            failures = 0;
+            delay_ms = client->retry_ms;
+        }
+        else
+        {
+            delay_ms = reconnect_delay(client, ++failures);
+        }
+    }
+
+    http_pipeline_close(&client->pipeline);
+
+    return client->refused ? CY_RSLT_TYPE_ERROR : CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: sse_close
+ *******************************************************************************
+ * Summary:
+ *  Closes the stream of a client. The last event ID is kept.
+ *
+ * Parameters:
+ *  client - Client.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void sse_close(sse_client_t *client)
+{
+    http_pipeline_close(&client->pipeline);
+}
+
+/*******************************************************************************
+ * Function Name: sse_demo
+ *******************************************************************************
+ * Summary:
+ *  Receives the events of SSE_PATH for SSE_DEMO_DURATION_MS and prints them,
+ *  followed by the time to open the stream and the device share of the push
+ *  latency: the time from the receive of an event to its callback. The rest
+ *  of the push latency is the network one-way delay. It is compared with the
+ *  average wait of polling every SSE_DEMO_POLL_INTERVAL_MS.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void sse_demo(void)
+{
+    demo_counts_t counts;
+    uint32_t cpu_mhz = SystemCoreClock / 1000000u;
+    cy_rslt_t result;
+
+    memset(&counts, 0, sizeof(counts));
+    sse_init(&demo_client, SSE_PATH, demo_callback, &counts);
+
+    APP_INFO(("Receiving the events of %s for %lu s\n", SSE_PATH, (unsigned long)(SSE_DEMO_DURATION_MS / 1000u)));
+
+    result = sse_run(&demo_client, SSE_DEMO_DURATION_MS);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("The server did not provide the event stream %s.\n", SSE_PATH));
+        return;
+    }
+
+    if (0u == cpu_mhz)
+    {
+        cpu_mhz = 1;
+    }
+
+    APP_INFO(("%lu events, %lu heartbeats, %lu bytes, %lu connections, %lu truncated\n",
+              (unsigned long)counts.events, (unsigned long)demo_client.stats.comments,
+              (unsigned long)demo_client.stats.bytes_received, (unsigned long)demo_client.stats.connections,
+              (unsigned long)counts.truncated));
+    printf("  Stream open        : %lu ms\n", (unsigned long)demo_client.stats.open_ms);
+    printf("  Receive to callback: max %lu us\n",
+           (unsigned long)(demo_client.stats.max_dispatch_cycles / cpu_mhz));
+    printf("  Push latency       : one-way network delay + the above, polling every %lu ms ~%lu ms\n",
+           (unsigned long)SSE_DEMO_POLL_INTERVAL_MS, (unsigned long)(SSE_DEMO_POLL_INTERVAL_MS / 2u));
+    if ('\0' != demo_client.last_event_id[0])
+    {
+        printf("  Last event ID      : %s\n", demo_client.last_event_id);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: open_stream
+ *******************************************************************************
+ * Summary:
+ *  Connects and sends the GET request of the stream, with the last event ID
+ *  if one was received, and prepares the pipeline for its response.
+ *
+ *******************************************************************************/
+static cy_rslt_t open_stream(sse_client_t *client)
+{
+    char request[SSE_REQUEST_SIZE];
+    cy_rslt_t result;
+    int length;
+
+    client->connect_ticks = xTaskGetTickCount();
+
+    length = snprintf(request, sizeof(request),
+                      "GET %s HTTP/1.1\r\n"
+                      "Host: %s:%u\r\n"
+                      "Accept: text/event-stream\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "%s%s%s"
+                      "\r\n",
+                      client->path, HTTPS_SERVER_HOST, HTTPS_PORT,
+                      ('\0' != client->last_event_id[0]) ? "Last-Event-ID: " : "",
+                      client->last_event_id,
+                      ('\0' != client->last_event_id[0]) ? "\r\n" : "");
+    if ((length < 0) || ((uint32_t)length >= sizeof(request)))
+    {
+        ERR_INFO(("The request for %s does not fit in %u bytes.\n", client->path, SSE_REQUEST_SIZE));
+        client->refused = true;
+        client->stop = true;
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    result = tls_stream_connect(&client->pipeline.stream, HTTPS_SERVER_HOST, HTTPS_PORT,
+                                TRANSPORT_SEND_RECV_TIMEOUT_MS);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = tls_stream_send(&client->pipeline.stream, request, (uint32_t)length);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = tls_stream_set_timeout(&client->pipeline.stream, SSE_RECEIVE_TIMEOUT_MS);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to open the event stream: 0x%08lx\n", (unsigned long)result));
+        http_pipeline_close(&client->pipeline);
+        return result;
+    }
+
+    client->stats.connections++;
+    client->last_rx_ticks = xTaskGetTickCount();
+    client->state = S_HEAD;
+    client->event_stream = false;
+    http_pipeline_expect_response(&client->pipeline, handle_response, handle_header, client);
+    start_line(client);
+
+    /* An event cut by the end of the previous stream is discarded. */
+    client->data_length = 0;
+    client->truncated = false;
+    client->type[0] = '\0';
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: reconnect_delay
+ *******************************************************************************
+ * Summary:
+ *  Returns the delay before the next connection after a number of
+ *  consecutive failures: the reconnection time doubled for each failure
+ *  after the first.
+ *
+ *******************************************************************************/
+static uint32_t reconnect_delay(const sse_client_t *client, uint32_t failures)
+{
+    uint32_t shift = failures - 1u;
+    uint32_t delay_ms;
+
+    if (shift > MAX_BACKOFF_SHIFT)
+    {
+        shift = MAX_BACKOFF_SHIFT;
+    }
+
+    delay_ms = client->retry_ms << shift;
+
+    return (delay_ms > SSE_MAX_RETRY_MS) ? SSE_MAX_RETRY_MS : delay_ms;
+}
+
+/*******************************************************************************
+ * Function Name: handle_header
+ *******************************************************************************
+ * Summary:
+ *  Header callback of the pipeline. Reads Content-Type; the pipeline reads
+ *  the headers that frame the body.
+ *
+ *******************************************************************************/
+static void handle_header(const char *name, const char *value, void *arg)
+{
+    sse_client_t *client = (sse_client_t *)arg;
+
+    if (http_pipeline_equals_token(name, strlen(name), "content-type"))
+    {
+        client->event_stream = http_pipeline_equals_token(value, strcspn(value, " \t;"), "text/event-stream");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: handle_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the pipeline. The first call, made for the first
+ *  body bytes or the end of the response, decides whether the response is
+ *  an event stream; the body of one is passed to the event parser without
+ *  its chunk framing.
+ *
+ *******************************************************************************/
+static void handle_response(const http_pipeline_event_t *event, void *arg)
+{
+    sse_client_t *client = (sse_client_t *)arg;
+
+    if (S_HEAD == client->state)
+    {
+        if (!accept_response(client, event->status_code))
+        {
+            client->state = S_REJECTED;
+            http_pipeline_stop(&client->pipeline);
+            return;
+        }
+        client->state = S_STREAM;
+    }
+
+    parse_events(client, event->data, event->length);
+
+    if (event->complete)
+    {
+        client->state = S_ENDED;
+    }
+
+    if (client->stop)
+    {
+        http_pipeline_stop(&client->pipeline);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: accept_response
+ *******************************************************************************
+ * Summary:
+ *  Accepts a 200 text/event-stream response. 204 tells the client to stop,
+ *  and a server error is retried. Any other response stops the client, as
+ *  the stream will not become available by reconnecting.
+ *
+ *******************************************************************************/
+static bool accept_response(sse_client_t *client, uint16_t status)
+{
+    if (0u == client->stats.open_ms)
+    {
+        client->stats.open_ms = (uint32_t)(xTaskGetTickCount() - client->connect_ticks) * portTICK_PERIOD_MS;
+    }
+
+    if ((HTTP_STATUS_OK == status) && client->event_stream)
+    {
+        return true;
+    }
+
+    if (HTTP_STATUS_NO_CONTENT == status)
+    {
+        APP_INFO(("The server ended the event stream %s.\n", client->path));
+        client->stop = true;
+    }
+    else if (status >= HTTP_STATUS_SERVER_ERROR)
+    {
+        ERR_INFO(("The event stream %s returned %u, retrying.\n", client->path, status));
+    }
+    else
+    {
+        ERR_INFO(("The event stream %s returned %u%s.\n", client->path, status,
+                  client->event_stream ? "" : " without text/event-stream"));
+        client->refused = true;
+        client->stop = true;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: parse_events
+ *******************************************************************************
+ * Summary:
+ *  Parses bytes of the event stream (HTML Living Standard, 9.2.6). Lines
+ *  end with CR LF, LF, or CR, and may be split anywhere between receives.
+ *  Field values are copied to their destination in runs, without going
+ *  through a line buffer.
+ *
+ *******************************************************************************/
+static void parse_events(sse_client_t *client, const uint8_t *data, uint32_t length)
+{
+    uint32_t span;
+    char c;
+
+    while (length > 0u)
+    {
+        c = (char)*data;
+
+        if (client->last_cr)
+        {
+            client->last_cr = false;
+            if ('\n' == c)
+            {
+                data++;
+                length--;
+                continue;
+            }
+        }
+
+        if (('\r' == c) || ('\n' == c))
+        {
+            end_of_line(client);
+            client->last_cr = ('\r' == c);
+            data++;
+            length--;
+            continue;
+        }
+
+        switch (client->field_state)
+        {
+            case F_NAME:
+                if (':' == c)
+                {
+                    /* A line starting with a colon is a comment. */
+                    if (0u == client->field_length)
+                    {
+                        client->stats.comments++;
+                        client->field_state = F_SKIP;
+                    }
+                    else
+                    {
+                        start_value(client);
+                    }
+                }
+                else if (client->field_length < (sizeof(client->field) - 1u))
+                {
+                    client->field[client->field_length++] = c;
+                }
+                else
+                {
+                    /* Longer than any known field. */
+                    client->field_state = F_SKIP;
+                }
+                data++;
+                length--;
+                break;
+
+            case F_VALUE_START:
+                /* One space after the colon is not part of the value. */
+                client->field_state = F_VALUE;
+                if (' ' == c)
+                {
+                    data++;
+                    length--;
+                }
+                break;
+
+            default:
+                for (span = 0; (span < length) && ('\r' != data[span]) && ('\n' != data[span]); span++)
+                {
+                }
+                if (F_VALUE == client->field_state)
+                {
+                    append_value(client, data, span);
+                }
+                data += span;
+                length -= span;
+                break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: start_value
+ *******************************************************************************
+ * Summary:
+ *  Identifies the field whose name was just read, and starts its value.
+ *
+ *******************************************************************************/
+static void start_value(sse_client_t *client)
+{
+    client->field[client->field_length] = '\0';
+    client->value_length = 0;
+    client->field_state = F_VALUE_START;
+
+    if (0 == strcmp(client->field, "data"))
+    {
+        client->field_id = FIELD_DATA;
+    }
+    else if (0 == strcmp(client->field, "event"))
+    {
+        client->field_id = FIELD_EVENT;
+    }
+    else if (0 == strcmp(client->field, "id"))
+    {
+        client->field_id = FIELD_ID;
+    }
+    else if (0 == strcmp(client->field, "retry"))
+    {
+        client->field_id = FIELD_RETRY;
+    }
+    else
+    {
+        client->field_id = FIELD_OTHER;
+        client->field_state = F_SKIP;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: append_value
+ *******************************************************************************
+ * Summary:
+ *  Adds bytes to the value of the current field. Data goes straight to the
+ *  data of the event; other values are collected until the end of the line.
+ *
+ *******************************************************************************/
+static void append_value(sse_client_t *client, const uint8_t *data, uint32_t length)
+{
+    uint32_t room;
+
+    if (FIELD_DATA == client->field_id)
+    {
+        room = SSE_MAX_DATA - client->data_length;
+        if (length > room)
+        {
+            length = room;
+            client->truncated = true;
+        }
+        memcpy(&client->data[client->data_length], data, length);
+        client->data_length += length;
+    }
+    else
+    {
+        room = SSE_MAX_ID - client->value_length;
+        length = (length > room) ? room : length;
+        memcpy(&client->value[client->value_length], data, length);
+        client->value_length += length;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: end_of_line
+ *******************************************************************************
+ * Summary:
+ *  Applies the field of a complete line. An empty line dispatches the
+ *  event. A field name without a colon has an empty value.
+ *
+ *******************************************************************************/
+static void end_of_line(sse_client_t *client)
+{
+    uint32_t length;
+
+    if (F_NAME == client->field_state)
+    {
+        if (0u == client->field_length)
+        {
+            dispatch_event(client);
+            start_line(client);
+            return;
+        }
+        start_value(client);
+    }
+
+    if (F_SKIP != client->field_state)
+    {
+        client->value[client->value_length] = '\0';
+
+        switch (client->field_id)
+        {
+            case FIELD_DATA:
+                if (client->data_length < SSE_MAX_DATA)
+                {
+                    client->data[client->data_length++] = '\n';
+                }
+                else
+                {
+                    client->truncated = true;
+                }
+                break;
+
+            case FIELD_EVENT:
+                length = (client->value_length < SSE_MAX_TYPE) ? client->value_length : SSE_MAX_TYPE;
+                memcpy(client->type, client->value, length);
+                client->type[length] = '\0';
+                break;
+
+            case FIELD_ID:
+                /* IDs containing a NUL byte are ignored. */
+                if (strlen(client->value) == client->value_length)
+                {
+                    memcpy(client->id, client->value, client->value_length + 1u);
+                }
+                break;
+
+            case FIELD_RETRY:
+                if ((client->value_length > 0u) && (strspn(client->value, "0123456789") == client->value_length))
+                {
+                    client->retry_ms = (uint32_t)strtoul(client->value, NULL, 10);
+                    if (client->retry_ms > SSE_MAX_RETRY_MS)
+                    {
+                        client->retry_ms = SSE_MAX_RETRY_MS;
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    start_line(client);
+}
+
+/*******************************************************************************
+ * Function Name: dispatch_event
+ *******************************************************************************
+ * Summary:
+ *  Passes the collected event to the callback and starts the next one. The
+ *  ID becomes the last event ID even if there is no data to dispatch.
+ *
+ *******************************************************************************/
+static void dispatch_event(sse_client_t *client)
+{
+    sse_event_t event;
+    uint32_t cycles;
+
+    memcpy(client->last_event_id, client->id, sizeof(client->last_event_id));
+
+    if (0u != client->data_length)
+    {
+        /* The data of each line ends with a newline; the last one is removed. */
+        if ('\n' == client->data[client->data_length - 1u])
+        {
+            client->data_length--;
+        }
+        client->data[client->data_length] = '\0';
+
+        event.type = ('\0' != client->type[0]) ? client->type : "message";
+        event.id = client->last_event_id;
+        event.data = client->data;
+        event.data_length = client->data_length;
+        event.truncated = client->truncated;
+
+        cycles = cycle_counter_get() - client->rx_cycles;
+        if (cycles > client->stats.max_dispatch_cycles)
+        {
+            client->stats.max_dispatch_cycles = cycles;
+        }
+        client->stats.events++;
+
+        if (!client->callback(&event, client->callback_arg))
+        {
+            client->stop = true;
+        }
+    }
+
+    client->data_length = 0;
+    client->truncated = false;
+    client->type[0] = '\0';
+}
+
+/*******************************************************************************
+ * Function Name: start_line
+ *******************************************************************************
+ * Summary:
+ *  Resets the event stream parser for the next line.
+ *
+ *******************************************************************************/
+static void start_line(sse_client_t *client)
+{
+    client->field_state = F_NAME;
+    client->field_length = 0;
+    client->field_id = FIELD_OTHER;
+    client->value_length = 0;
+}
+
+/*******************************************************************************
+ * Function Name: demo_callback
+ *******************************************************************************
+ * Summary:
+ *  Prints an event of the demo.
+ *
+ *******************************************************************************/
+static bool demo_callback(const sse_event_t *event, void *arg)
+{
+    demo_counts_t *counts = (demo_counts_t *)arg;
+
+    counts->events++;
+    if (event->truncated)
+    {
+        counts->truncated++;
+    }
+
+    printf("  [%s] id=%s %.*s%s\n", event->type, event->id, DEMO_PRINT_DATA, event->data,
+           (event->data_length > DEMO_PRINT_DATA) ? "..." : "");
+
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,168 @@
+/******************************************************************************
+* File Name: sse.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the Server-Sent Events client.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef SSE_H_
+#define SSE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "FreeRTOS.h"
+#include "http_pipeline.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Event stream of the "Server-Sent Events" menu option. */
+#define SSE_PATH                                 "/events"
+
+/* Data of one event. Longer data is cut and the event marked truncated. */
+#define SSE_MAX_DATA                             (512)
+
+/* Longest event type and event ID. Longer values are cut. */
+#define SSE_MAX_TYPE                             (32)
+#define SSE_MAX_ID                               (64)
+
+/* Reconnection delay until the server sets one with a retry field. It is
+ * doubled after each failed connection, up to SSE_MAX_RETRY_MS.
+ */
+#define SSE_DEFAULT_RETRY_MS                     (3000u)
+#define SSE_MAX_RETRY_MS                         (60000u)
+
+/* The stream is considered dead and reopened when nothing, not even a
+ * comment, has been received for this long. Servers send comments as
+ * heartbeats more often than this.
+ */
+#define SSE_IDLE_TIMEOUT_MS                      (60000u)
+
+/* Longest wait in a receive. Events are dispatched as soon as they arrive;
+ * this only bounds how late sse_run() notices the end of its duration.
+ */
+#define SSE_RECEIVE_TIMEOUT_MS                   (1000u)
+
+/* Duration of the "Server-Sent Events" menu option, and the polling interval
+ * its push latency is compared with.
+ */
+#define SSE_DEMO_DURATION_MS                     (60000u)
+#define SSE_DEMO_POLL_INTERVAL_MS                (5000u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* A dispatched event. The strings are valid only during the callback. */
+typedef struct
+{
+    const char *type;            /* "message" unless set by an event field. */
+    const char *id;              /* Last event ID, "" if none. */
+    const char *data;            /* Data lines joined with '\n'. */
+    uint32_t data_length;
+    bool truncated;              /* The data was longer than SSE_MAX_DATA. */
+} sse_event_t;
+
+/* Returns false to stop sse_run(). */
+typedef bool (*sse_cb_t)(const sse_event_t *event, void *arg);
+
+/* Counters of an sse_run() call. */
+typedef struct
+{
+    uint32_t events;
+    uint32_t comments;
+    uint32_t connections;
+    uint32_t bytes_received;
+    uint32_t max_dispatch_cycles; /* From the receive of its bytes to the callback. */
+    uint32_t open_ms;            /* Connect to the first body bytes of the first stream. */
+} sse_stats_t;
+
+/* The response head and its chunk framing are parsed by an HTTP pipeline,
+ * whose stream and receive buffer the client uses.
+ */
+typedef struct
+{
+    http_pipeline_t pipeline;
+    const char *path;
+    sse_cb_t callback;
+    void *callback_arg;
+    bool stop;
+    bool refused;                /* The server answered with an error or no stream. */
+
+    TickType_t connect_ticks;
+    TickType_t last_rx_ticks;
+    uint32_t rx_cycles;
+
+    /* HTTP response. */
+    uint32_t state;
+    bool event_stream;           /* Content-Type is text/event-stream. */
+
+    /* Event stream line being parsed. */
+    uint32_t field_state;
+    char field[8];
+    uint32_t field_length;
+    uint32_t field_id;
+    char value[SSE_MAX_ID + 1];
+    uint32_t value_length;
+    bool last_cr;
+
+    /* Event being collected. */
+    char data[SSE_MAX_DATA + 1];
+    uint32_t data_length;
+    bool truncated;
+    char type[SSE_MAX_TYPE + 1];
+    char id[SSE_MAX_ID + 1];
+    char last_event_id[SSE_MAX_ID + 1];
+    uint32_t retry_ms;
+
+    sse_stats_t stats;
+} sse_client_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void sse_init(sse_client_t *client, const char *path, sse_cb_t callback, void *arg);
+cy_rslt_t sse_run(sse_client_t *client, uint32_t duration_ms);
+void sse_close(sse_client_t *client);
+void sse_demo(void);
+
+#endif /* SSE_H_ */
+
+
+/* [] END OF FILE */
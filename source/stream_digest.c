@@ -0,0 +1,474 @@
+/******************************************************************************
+* File Name: stream_digest.c
+*
+* Description: This file contains the stream digest. Each piece of a body is
+* added to the SHA-256 digest as it is received, so a body of any size is
+* verified without storing it or reading it again. The crypto block computes
+* the digest when it is free, and mbedTLS otherwise.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* mbedTLS header file for the Base64 decoder */
+#include "mbedtls/base64.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "secure_http_client.h"
+#include "cycle_counter.h"
+#include "stream_digest.h"
+
+#if STREAM_DIGEST_HW_SUPPORTED
+#include "cyhal_crypto_common.h"
+#endif
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Longest Base64 value of a SHA-256 digest, with padding. */
+#define DIGEST_BASE64_MAX_LEN            (44u)
+
+/* Memory hashed by the engine benchmark: the start of the internal flash. */
+#define BENCH_SOURCE                     ((const uint8_t *)CY_FLASH_BASE)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static stream_digest_t bench_digest;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool token_equals(const char *value, size_t length, const char *token);
+static bool count_body(const uint8_t *data, uint32_t length, void *arg);
+static bool hash_body(const uint8_t *data, uint32_t length, void *arg);
+
+/*******************************************************************************
+ * Function Name: stream_digest_start
+ *******************************************************************************
+ * Summary:
+ *  Starts a SHA-256 digest. The hardware engine falls back to mbedTLS when
+ *  the device has no crypto block or when the block is reserved, for example
+ *  by the TLS layer.
+ *
+ * Parameters:
+ *  digest - Digest to start.
+ *  engine - Preferred engine.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void stream_digest_start(stream_digest_t *digest, stream_digest_engine_t engine)
+{
+    memset(digest, 0, sizeof(*digest));
+    digest->engine = STREAM_DIGEST_SOFTWARE;
+    cycle_counter_enable();
+
+#if STREAM_DIGEST_HW_SUPPORTED
+    if ((STREAM_DIGEST_HARDWARE == engine) &&
+        (CY_RSLT_SUCCESS == cyhal_crypto_reserve(&digest->base, &digest->resource, CYHAL_CRYPTO_COMMON)))
+    {
+        if ((CY_CRYPTO_SUCCESS == Cy_Crypto_Core_Sha_Init(digest->base, &digest->hw_state, CY_CRYPTO_MODE_SHA256,
+                                                          &digest->hw_buffers)) &&
+            (CY_CRYPTO_SUCCESS == Cy_Crypto_Core_Sha_Start(digest->base, &digest->hw_state)))
+        {
+            digest->engine = STREAM_DIGEST_HARDWARE;
+            return;
+        }
+
+        cyhal_crypto_free(digest->base, &digest->resource, CYHAL_CRYPTO_COMMON);
+    }
+#endif
+
+    mbedtls_sha256_init(&digest->sw_ctx);
+    mbedtls_sha256_starts_ret(&digest->sw_ctx, 0);
+}
+
+/*******************************************************************************
+ * Function Name: stream_digest_update
+ *******************************************************************************
+ * Summary:
+ *  Adds a piece of the body to the digest.
+ *
+ * Parameters:
+ *  digest - Started digest.
+ *  data - Piece of the body.
+ *  length - Length of the piece.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void stream_digest_update(stream_digest_t *digest, const uint8_t *data, uint32_t length)
+{
+    uint32_t start = cycle_counter_get();
+
+#if STREAM_DIGEST_HW_SUPPORTED
+    if (STREAM_DIGEST_HARDWARE == digest->engine)
+    {
+        (void)Cy_Crypto_Core_Sha_Update(digest->base, &digest->hw_state, data, length);
+    }
+    else
+#endif
+    {
+        mbedtls_sha256_update_ret(&digest->sw_ctx, data, length);
+    }
+
+    digest->cycles += cycle_counter_get() - start;
+    digest->bytes += length;
+}
+
+/*******************************************************************************
+ * Function Name: stream_digest_finish
+ *******************************************************************************
+ * Summary:
+ *  Completes the digest and releases the engine.
+ *
+ * Parameters:
+ *  digest - Started digest.
+ *  sha256 - Filled with the STREAM_DIGEST_SHA256_LEN bytes of the digest.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void stream_digest_finish(stream_digest_t *digest, uint8_t *sha256)
+{
+    uint32_t start = cycle_counter_get();
+
+#if STREAM_DIGEST_HW_SUPPORTED
+    if (STREAM_DIGEST_HARDWARE == digest->engine)
+    {
+        (void)Cy_Crypto_Core_Sha_Finish(digest->base, &digest->hw_state, sha256);
+        (void)Cy_Crypto_Core_Sha_Free(digest->base, &digest->hw_state);
+        cyhal_crypto_free(digest->base, &digest->resource, CYHAL_CRYPTO_COMMON);
+    }
+    else
+#endif
+    {
+        mbedtls_sha256_finish_ret(&digest->sw_ctx, sha256);
+        mbedtls_sha256_free(&digest->sw_ctx);
+    }
+
+    digest->cycles += cycle_counter_get() - start;
+}
+
+/*******************************************************************************
+ * Function Name: stream_digest_parse_header
+ *******************************************************************************
+ * Summary:
+ *  Reads the SHA-256 digest from the value of a Repr-Digest header
+ *  ("sha-256=:Base64:", RFC 9530) or of a Digest header ("SHA-256=Base64",
+ *  RFC 3230). Digests of other algorithms in the value are skipped.
+ *
+ * Parameters:
+ *  value - Header value, not NUL-terminated.
+ *  length - Length of the value.
+ *  sha256 - Filled with the digest if one is found.
+ *
+ * Return:
+ *  bool: true if the value holds a valid SHA-256 digest.
+ *
+ *******************************************************************************/
+bool stream_digest_parse_header(const char *value, size_t length, uint8_t *sha256)
+{
+    uint8_t decoded[DIGEST_BASE64_MAX_LEN];
+    size_t decoded_len;
+    size_t member_len;
+    size_t key_len;
+    const char *digest;
+    size_t digest_len;
+
+    while (length > 0)
+    {
+        for (member_len = 0; (member_len < length) && (',' != value[member_len]); member_len++)
+        {
+        }
+
+        for (key_len = 0; (key_len < member_len) && ('=' != value[key_len]); key_len++)
+        {
+        }
+
+        if ((key_len < member_len) && token_equals(value, key_len, "sha-256"))
+        {
+            digest = &value[key_len + 1u];
+            digest_len = member_len - key_len - 1u;
+
+            /* Parameters of the member are ignored. */
+            for (size_t i = 0; i < digest_len; i++)
+            {
+                if (';' == digest[i])
+                {
+                    digest_len = i;
+                }
+            }
+
+            while ((digest_len > 0) && (' ' == digest[0]))
+            {
+                digest++;
+                digest_len--;
+            }
+            while ((digest_len > 0) && (' ' == digest[digest_len - 1u]))
+            {
+                digest_len--;
+            }
+
+            /* A structured field byte sequence is wrapped in colons. */
+            if ((digest_len >= 2u) && (':' == digest[0]) && (':' == digest[digest_len - 1u]))
+            {
+                digest++;
+                digest_len -= 2u;
+            }
+
+            if ((digest_len <= DIGEST_BASE64_MAX_LEN) &&
+                (0 == mbedtls_base64_decode(decoded, sizeof(decoded), &decoded_len,
+                                            (const unsigned char *)digest, digest_len)) &&
+                (STREAM_DIGEST_SHA256_LEN == decoded_len))
+            {
+                memcpy(sha256, decoded, STREAM_DIGEST_SHA256_LEN);
+                return true;
+            }
+        }
+
+        member_len = (member_len < length) ? (member_len + 1u) : member_len;
+        value += member_len;
+        length -= member_len;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: stream_digest_read_header
+ *******************************************************************************
+ * Summary:
+ *  Reads the SHA-256 digest of the representation from the Repr-Digest
+ *  header of a response, or from its legacy Digest header. The digest covers
+ *  the body as sent, before any content decoding.
+ *
+ * Parameters:
+ *  handle - HTTP client instance that received the response.
+ *  response - Response to read.
+ *  sha256 - Filled with the digest if one is found.
+ *
+ * Return:
+ *  bool: true if the response carries a SHA-256 digest.
+ *
+ *******************************************************************************/
+bool stream_digest_read_header(cy_http_client_t handle, cy_http_client_response_t *response, uint8_t *sha256)
+{
+    static const char *const fields[] = { "Repr-Digest", "Digest" };
+    cy_http_client_header_t header;
+
+    for (uint32_t index = 0; index < (sizeof(fields) / sizeof(fields[0])); index++)
+    {
+        header.field = (char *)fields[index];
+        header.field_len = strlen(fields[index]);
+        header.value = NULL;
+        header.value_len = 0;
+
+        if ((CY_RSLT_SUCCESS == cy_http_client_read_header(handle, response, &header, 1)) &&
+            (NULL != header.value) && stream_digest_parse_header(header.value, header.value_len, sha256))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: stream_digest_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Prints the cycles per kilobyte of each engine for the piece sizes of
+ *  STREAM_DIGEST_BENCH_PIECES. Then fetches STREAM_DIGEST_BENCH_PATH with
+ *  https_stream_get() without verification and with it, prints the time of
+ *  both transfers, and checks that a wrong digest rejects the transfer.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void stream_digest_benchmark(void)
+{
+    static const uint32_t pieces[] = STREAM_DIGEST_BENCH_PIECES;
+    static const stream_digest_engine_t engines[] = { STREAM_DIGEST_SOFTWARE, STREAM_DIGEST_HARDWARE };
+    https_stream_stats_t plain;
+    https_stream_stats_t verified;
+    uint8_t expected[STREAM_DIGEST_SHA256_LEN];
+    uint32_t cycles_per_kb[2];
+    uint32_t bytes = 0;
+    uint32_t cpu_mhz = SystemCoreClock / 1000000u;
+    cy_rslt_t result;
+
+    APP_INFO(("SHA-256 cycles per KB of %lu KB hashed in pieces\n",
+              (unsigned long)(STREAM_DIGEST_BENCH_BYTES / 1024u)));
+    printf("  piece   software   hardware\n");
+
+    for (uint32_t i = 0; i < (sizeof(pieces) / sizeof(pieces[0])); i++)
+    {
+        for (uint32_t e = 0; e < (sizeof(engines) / sizeof(engines[0])); e++)
+        {
+            stream_digest_start(&bench_digest, engines[e]);
+            for (uint32_t done = 0; done < STREAM_DIGEST_BENCH_BYTES; done += pieces[i])
+            {
+                stream_digest_update(&bench_digest, &BENCH_SOURCE[done], pieces[i]);
+            }
+            stream_digest_finish(&bench_digest, expected);
+
+            cycles_per_kb[e] = (bench_digest.engine == engines[e]) ?
+                               (uint32_t)(((uint64_t)bench_digest.cycles * 1024u) / bench_digest.bytes) : 0u;
+        }
+
+        printf("  %5lu   %8lu   ", (unsigned long)pieces[i], (unsigned long)cycles_per_kb[0]);
+        if (0u != cycles_per_kb[1])
+        {
+            printf("%8lu\n", (unsigned long)cycles_per_kb[1]);
+        }
+        else
+        {
+            printf("     n/a\n");
+        }
+    }
+
+    /* The example server sends no digest header, so the digest to check
+     * against is computed from a first transfer, as a manifest would give it.
+     */
+    result = https_stream_get(STREAM_DIGEST_BENCH_PATH, NULL, false, NULL, count_body, &bytes, &plain);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        stream_digest_start(&bench_digest, STREAM_DIGEST_SOFTWARE);
+        result = https_stream_get(STREAM_DIGEST_BENCH_PATH, NULL, false, NULL, hash_body, &bench_digest, NULL);
+        stream_digest_finish(&bench_digest, expected);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = https_stream_get(STREAM_DIGEST_BENCH_PATH, NULL, false, expected, count_body, &bytes, &verified);
+    }
+    if ((CY_RSLT_SUCCESS != result) || !verified.verified)
+    {
+        ERR_INFO(("Failed to fetch %s for the digest benchmark.\n", STREAM_DIGEST_BENCH_PATH));
+        return;
+    }
+
+    APP_INFO(("%s, %lu bytes in %lu requests\n", STREAM_DIGEST_BENCH_PATH,
+              (unsigned long)plain.body_bytes, (unsigned long)plain.requests));
+    printf("  unverified   %6lu ms\n", (unsigned long)plain.elapsed_ms);
+    printf("  verified     %6lu ms, %lu us of them hashing\n", (unsigned long)verified.elapsed_ms,
+           (unsigned long)(verified.digest_cycles / ((0u != cpu_mhz) ? cpu_mhz : 1u)));
+
+    expected[0] ^= 0x01u;
+    result = https_stream_get(STREAM_DIGEST_BENCH_PATH, NULL, false, expected, count_body, &bytes, NULL);
+    printf("  wrong digest %s\n", (CY_RSLT_SUCCESS != result) ? "rejected" : "NOT rejected");
+}
+
+/*******************************************************************************
+ * Function Name: token_equals
+ *******************************************************************************
+ * Summary:
+ *  Compares a token with a lowercase one, ignoring the case and surrounding
+ *  white space.
+ *
+ *******************************************************************************/
+static bool token_equals(const char *value, size_t length, const char *token)
+{
+    size_t token_len = strlen(token);
+
+    while ((length > 0) && (' ' == *value))
+    {
+        value++;
+        length--;
+    }
+    while ((length > 0) && (' ' == value[length - 1u]))
+    {
+        length--;
+    }
+
+    if (length != token_len)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower((unsigned char)value[i]) != token[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: count_body
+ *******************************************************************************
+ * Summary:
+ *  Body callback of the benchmark that only counts the bytes.
+ *
+ *******************************************************************************/
+static bool count_body(const uint8_t *data, uint32_t length, void *arg)
+{
+    *(uint32_t *)arg += length;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: hash_body
+ *******************************************************************************
+ * Summary:
+ *  Body callback of the benchmark that adds the body to a digest.
+ *
+ *******************************************************************************/
+static bool hash_body(const uint8_t *data, uint32_t length, void *arg)
+{
+    stream_digest_update((stream_digest_t *)arg, data, length);
+
+    return true;
+}
+
+/* [] END OF FILE */
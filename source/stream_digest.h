@@ -0,0 +1,133 @@
+/******************************************************************************
+* File Name: stream_digest.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the stream digest, which computes the SHA-256 digest of a
+* body piece by piece as it is received, in software or on the crypto block.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef STREAM_DIGEST_H_
+#define STREAM_DIGEST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cyhal.h"
+#include "cy_result.h"
+#include "cy_http_client_api.h"
+
+/* mbedTLS header file for the SHA-256 digest */
+#include "mbedtls/sha256.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Set when the device has a crypto block with the SHA-256 engine. */
+#if defined(CY_IP_MXCRYPTO) && defined(CPUSS_CRYPTO_SHA256) && (CPUSS_CRYPTO_SHA256 == 1)
+#define STREAM_DIGEST_HW_SUPPORTED               (1)
+#else
+#define STREAM_DIGEST_HW_SUPPORTED               (0)
+#endif
+
+#if STREAM_DIGEST_HW_SUPPORTED
+#include "cy_crypto_core_sha.h"
+#endif
+
+/* Length of a SHA-256 digest in bytes. */
+#define STREAM_DIGEST_SHA256_LEN                 (32)
+
+/* Engine of the transfers that verify their body. The crypto block is used
+ * when it is free, and mbedTLS otherwise.
+ */
+#define STREAM_DIGEST_DEFAULT_ENGINE             (STREAM_DIGEST_HW_SUPPORTED ? STREAM_DIGEST_HARDWARE : \
+                                                                              STREAM_DIGEST_SOFTWARE)
+
+/* "Digest benchmark" menu option: bytes hashed by each engine in pieces of
+ * each size, and the resource fetched with and without verification.
+ */
+#define STREAM_DIGEST_BENCH_BYTES                (64u * 1024u)
+#define STREAM_DIGEST_BENCH_PIECES               { 64u, 1024u, 16384u }
+#define STREAM_DIGEST_BENCH_PATH                 "/compressible.txt"
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    STREAM_DIGEST_SOFTWARE = 0,     /* mbedTLS. */
+    STREAM_DIGEST_HARDWARE,         /* Crypto block of the device. */
+} stream_digest_engine_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Digest being computed. */
+typedef struct
+{
+    stream_digest_engine_t engine;  /* Engine in use, after any fallback. */
+    mbedtls_sha256_context sw_ctx;
+#if STREAM_DIGEST_HW_SUPPORTED
+    CRYPTO_Type *base;
+    cyhal_resource_inst_t resource;
+    cy_stc_crypto_sha_state_t hw_state;
+    union
+    {
+        cy_stc_crypto_v1_sha256_buffers_t v1;
+        cy_stc_crypto_v2_sha256_buffers_t v2;
+    } hw_buffers;
+#endif
+    uint32_t bytes;                 /* Bytes hashed. */
+    uint32_t cycles;                /* CPU cycles spent hashing them. */
+} stream_digest_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void stream_digest_start(stream_digest_t *digest, stream_digest_engine_t engine);
+void stream_digest_update(stream_digest_t *digest, const uint8_t *data, uint32_t length);
+void stream_digest_finish(stream_digest_t *digest, uint8_t *sha256);
+bool stream_digest_parse_header(const char *value, size_t length, uint8_t *sha256);
+bool stream_digest_read_header(cy_http_client_t handle, cy_http_client_response_t *response, uint8_t *sha256);
+void stream_digest_benchmark(void);
+
+#endif /* STREAM_DIGEST_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,668 @@
+/******************************************************************************
+* File Name: telemetry_batch.c
+*
+* Description: This file contains the telemetry batching layer. Producers add
+* small records from any task; the records are appended to a batch that is
+* posted as one newline-delimited request when it is big enough, when its
+* oldest record is TELEMETRY_BATCH_MAX_AGE_MS old, or when an urgent record is
+* added. Each producer is told when its own record was delivered.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <timers.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "telemetry_batch.h"
+#include "compressed_upload.h"
+#include "offline_queue.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TELEMETRY_DEMO_RECORD_LENGTH     (48)
+
+/* Every this many records the demo raises an alarm with urgent priority. */
+#define TELEMETRY_DEMO_URGENT_INTERVAL   (25)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* A batch being filled by the producers or being posted by the batch task. */
+typedef struct
+{
+    uint8_t body[TELEMETRY_BATCH_BUFFER_SIZE];
+    uint32_t length;
+    uint32_t count;
+    uint32_t payload_bytes;
+    bool urgent;                 /* Holds an urgent record, posted in the urgent lane. */
+    telemetry_done_cb_t done[TELEMETRY_BATCH_MAX_RECORDS];
+    void *done_arg[TELEMETRY_BATCH_MAX_RECORDS];
+} telemetry_batch_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Two batches: the producers fill one while the other is posted. */
+static telemetry_batch_t batch[2];
+static telemetry_batch_t *filling_batch = &batch[0];
+
+/* Protects filling_batch, the waiter count, and the statistics. */
+static SemaphoreHandle_t batch_mutex;
+
+/* Producers that found no room wait on this semaphore for the next swap. */
+static SemaphoreHandle_t room_semaphore;
+static uint32_t room_waiters;
+
+/* Fires when the oldest record of the filling batch reaches the age limit. */
+static TimerHandle_t age_timer;
+
+static TaskHandle_t telemetry_batch_task_handle;
+
+static telemetry_batch_stats_t batch_stats;
+static TickType_t first_record_ticks;
+
+/* Completions counted by the demo. */
+static SemaphoreHandle_t demo_done_semaphore;
+static volatile uint32_t demo_failures;
+static volatile uint32_t demo_queued;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void telemetry_batch_task(void *arg);
+static void age_timer_callback(TimerHandle_t timer);
+static void post_batch(telemetry_batch_t *sending);
+static size_t read_batch(uint32_t offset, uint8_t *buffer, size_t size, void *arg);
+static uint32_t queue_batch(const telemetry_batch_t *sending, cy_rslt_t *results);
+static void demo_done_callback(cy_rslt_t result, void *arg);
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the batch task, its age timer, and the synchronization objects.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the batching layer is ready,
+ *  otherwise, it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t telemetry_batch_init(void)
+{
+    if (NULL != telemetry_batch_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    batch_mutex = xSemaphoreCreateMutex();
+    room_semaphore = xSemaphoreCreateCounting(TELEMETRY_BATCH_MAX_RECORDS, 0);
+    age_timer = xTimerCreate("Telemetry Age", pdMS_TO_TICKS(TELEMETRY_BATCH_MAX_AGE_MS),
+                             pdFALSE, NULL, age_timer_callback);
+
+    if ((NULL == batch_mutex) || (NULL == room_semaphore) || (NULL == age_timer))
+    {
+        ERR_INFO(("Failed to create the telemetry batch objects.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (pdPASS != xTaskCreate(telemetry_batch_task, "Telemetry Batch", TELEMETRY_BATCH_TASK_STACK_SIZE,
+                              NULL, TELEMETRY_BATCH_TASK_PRIORITY, &telemetry_batch_task_handle))
+    {
+        ERR_INFO(("Failed to create the telemetry batch task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_add
+ *******************************************************************************
+ * Summary:
+ *  Adds a record to the filling batch. The call returns as soon as the record
+ *  is copied; it blocks only if the batch is full and the previous batch is
+ *  still being posted.
+ *
+ * Parameters:
+ *  record - Record text. Must not contain a newline.
+ *  length - Length of the record.
+ *  priority - TELEMETRY_PRIORITY_URGENT posts the batch immediately, in the
+ *  urgent lane.
+ *  done - Called when the record was posted. Can be NULL.
+ *  arg - Argument passed to the done callback.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the record is batched, otherwise, it
+ *  returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t telemetry_batch_add(const char *record, uint32_t length, telemetry_priority_t priority,
+                              telemetry_done_cb_t done, void *arg)
+{
+    telemetry_batch_t *target;
+    bool flush;
+
+    if ((NULL == telemetry_batch_task_handle) || (NULL == record) || (0 == length) ||
+        ((length + 1u) > TELEMETRY_BATCH_BUFFER_SIZE) || (NULL != memchr(record, '\n', length)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    xSemaphoreTake(batch_mutex, portMAX_DELAY);
+
+    while (((filling_batch->length + length + 1u) > TELEMETRY_BATCH_BUFFER_SIZE) ||
+           (filling_batch->count >= TELEMETRY_BATCH_MAX_RECORDS))
+    {
+        /* Wait for the batch task to swap in the empty batch. */
+        room_waiters++;
+        xSemaphoreGive(batch_mutex);
+        xTaskNotifyGive(telemetry_batch_task_handle);
+
+        if (pdTRUE != xSemaphoreTake(room_semaphore, pdMS_TO_TICKS(TELEMETRY_BATCH_ADD_TIMEOUT_MS)))
+        {
+            xSemaphoreTake(batch_mutex, portMAX_DELAY);
+            room_waiters = (room_waiters > 0) ? (room_waiters - 1) : 0;
+            xSemaphoreGive(batch_mutex);
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        xSemaphoreTake(batch_mutex, portMAX_DELAY);
+    }
+
+    target = filling_batch;
+
+    if (0 == target->count)
+    {
+        xTimerReset(age_timer, 0);
+    }
+
+    if (0 == batch_stats.records + batch_stats.batches + target->count)
+    {
+        first_record_ticks = xTaskGetTickCount();
+    }
+
+    memcpy(&target->body[target->length], record, length);
+    target->length += length;
+    target->body[target->length++] = '\n';
+    target->payload_bytes += length;
+    target->done[target->count] = done;
+    target->done_arg[target->count] = arg;
+    target->count++;
+    if (TELEMETRY_PRIORITY_URGENT == priority)
+    {
+        target->urgent = true;
+    }
+
+    flush = (TELEMETRY_PRIORITY_URGENT == priority) ||
+            (target->length >= TELEMETRY_BATCH_FLUSH_BYTES) ||
+            (target->count >= TELEMETRY_BATCH_MAX_RECORDS);
+
+    xSemaphoreGive(batch_mutex);
+
+    if (flush)
+    {
+        xTaskNotifyGive(telemetry_batch_task_handle);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns a copy of the batching statistics.
+ *
+ * Parameters:
+ *  stats - Filled with the statistics.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void telemetry_batch_get_stats(telemetry_batch_stats_t *stats)
+{
+    xSemaphoreTake(batch_mutex, portMAX_DELAY);
+    *stats = batch_stats;
+    stats->elapsed_ms = (uint32_t)(xTaskGetTickCount() - first_record_ticks) * portTICK_PERIOD_MS;
+    xSemaphoreGive(batch_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the requests, the bytes on air, and the radio-on time of the posted
+ *  batches next to the estimate for sending every record in its own request.
+ *  The batched bytes are those of the requests and responses as written to
+ *  and read from the connection, plus TELEMETRY_BATCH_HANDSHAKE_BYTES per
+ *  handshake. The unbatched estimate sends each delivered record with the
+ *  headers and framing measured per batch, on a connection kept as warm as
+ *  the batches' one. The unbatched radio time assumes each request takes as
+ *  long as an average batch, which holds while the bodies are small
+ *  compared to a round trip.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void telemetry_batch_print_stats(void)
+{
+    telemetry_batch_stats_t stats;
+    uint32_t handshake_bytes;
+    uint32_t request_overhead;
+    uint32_t batched_bytes;
+    uint32_t unbatched_bytes;
+    uint32_t unbatched_ms = 0;
+
+    telemetry_batch_get_stats(&stats);
+
+    if ((0 == stats.batches) || (0 == stats.elapsed_ms))
+    {
+        APP_INFO(("No telemetry batch posted yet\n"));
+        return;
+    }
+
+    handshake_bytes = stats.handshakes * TELEMETRY_BATCH_HANDSHAKE_BYTES;
+    batched_bytes = stats.tx_bytes + stats.rx_bytes + handshake_bytes;
+    request_overhead = ((stats.tx_bytes + stats.rx_bytes) > stats.wire_bytes) ?
+                       ((stats.tx_bytes + stats.rx_bytes - stats.wire_bytes) / stats.batches) : 0u;
+    unbatched_bytes = stats.payload_bytes + (stats.records * request_overhead) + handshake_bytes;
+    unbatched_ms = (stats.radio_ms / stats.batches) * stats.records;
+
+    APP_INFO(("Telemetry: %lu records in %lu batches (%lu urgent, %lu failed, %lu records queued) over %lu ms\n",
+              (unsigned long)stats.records, (unsigned long)stats.batches, (unsigned long)stats.urgent_batches,
+              (unsigned long)stats.failed_batches, (unsigned long)stats.queued_records,
+              (unsigned long)stats.elapsed_ms));
+    APP_INFO(("Requests/min : batched %lu, unbatched %lu\n",
+              (unsigned long)((stats.batches * 60000u) / stats.elapsed_ms),
+              (unsigned long)((stats.records * 60000u) / stats.elapsed_ms)));
+    APP_INFO(("Bytes on air : batched %lu, unbatched (est.) %lu, saved %ld%%\n",
+              (unsigned long)batched_bytes, (unsigned long)unbatched_bytes,
+              (long)100 - (long)((batched_bytes * 100ull) / ((0u != unbatched_bytes) ? unbatched_bytes : 1u))));
+    APP_INFO(("Per request  : %lu bytes of headers, framing, and response; %lu handshakes of ~%u bytes\n",
+              (unsigned long)request_overhead, (unsigned long)stats.handshakes,
+              (unsigned int)TELEMETRY_BATCH_HANDSHAKE_BYTES));
+    APP_INFO(("Batch bodies : %lu bytes delivered, %lu bytes sent\n",
+              (unsigned long)stats.body_bytes, (unsigned long)stats.wire_bytes));
+    APP_INFO(("Radio-on time: batched %lu ms, unbatched (est.) %lu ms\n",
+              (unsigned long)stats.radio_ms, (unsigned long)unbatched_ms));
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_demo
+ *******************************************************************************
+ * Summary:
+ *  Simulates a sensor that reports every TELEMETRY_DEMO_INTERVAL_MS, with an
+ *  urgent alarm now and then, waits until every record is delivered, and
+ *  prints the batching statistics.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void telemetry_batch_demo(void)
+{
+    char record[TELEMETRY_DEMO_RECORD_LENGTH];
+    telemetry_priority_t priority;
+    uint32_t index;
+    uint32_t pending = 0;
+    int length;
+
+    if (NULL == demo_done_semaphore)
+    {
+        demo_done_semaphore = xSemaphoreCreateCounting(TELEMETRY_DEMO_RECORDS, 0);
+        if (NULL == demo_done_semaphore)
+        {
+            return;
+        }
+    }
+    demo_failures = 0;
+    demo_queued = 0;
+
+    for (index = 0; index < TELEMETRY_DEMO_RECORDS; index++)
+    {
+        priority = ((index % TELEMETRY_DEMO_URGENT_INTERVAL) == (TELEMETRY_DEMO_URGENT_INTERVAL - 1)) ?
+                   TELEMETRY_PRIORITY_URGENT : TELEMETRY_PRIORITY_NORMAL;
+
+        length = snprintf(record, sizeof(record), "{\"seq\":%lu,\"t\":%lu,\"temp\":%lu,\"alarm\":%d}",
+                          (unsigned long)index, (unsigned long)xTaskGetTickCount(),
+                          (unsigned long)(200u + (index % 50u)),
+                          (TELEMETRY_PRIORITY_URGENT == priority) ? 1 : 0);
+
+        if (CY_RSLT_SUCCESS == telemetry_batch_add(record, (uint32_t)length, priority,
+                                                   demo_done_callback, NULL))
+        {
+            pending++;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(TELEMETRY_DEMO_INTERVAL_MS));
+    }
+
+    while ((pending > 0) &&
+           (pdTRUE == xSemaphoreTake(demo_done_semaphore, pdMS_TO_TICKS(2 * TELEMETRY_BATCH_MAX_AGE_MS))))
+    {
+        pending--;
+    }
+
+    APP_INFO(("Telemetry demo: %lu records not confirmed, %lu queued for replay, %lu failed\n",
+              (unsigned long)pending, (unsigned long)demo_queued, (unsigned long)demo_failures));
+    telemetry_batch_print_stats();
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_batch_task
+ *******************************************************************************
+ * Summary:
+ *  Waits for a flush request, swaps the batches, and posts the filled one.
+ *  The swap wakes the producers that were waiting for room.
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void telemetry_batch_task(void *arg)
+{
+    telemetry_batch_t *sending;
+
+    (void)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(batch_mutex, portMAX_DELAY);
+
+        if (0 == filling_batch->count)
+        {
+            xSemaphoreGive(batch_mutex);
+            continue;
+        }
+
+        sending = filling_batch;
+        filling_batch = (filling_batch == &batch[0]) ? &batch[1] : &batch[0];
+        xTimerStop(age_timer, 0);
+
+        while (room_waiters > 0)
+        {
+            room_waiters--;
+            xSemaphoreGive(room_semaphore);
+        }
+
+        xSemaphoreGive(batch_mutex);
+
+        post_batch(sending);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: post_batch
+ *******************************************************************************
+ * Summary:
+ *  Posts a batch, compressed as TELEMETRY_BATCH_UPLOAD_POLICY selects, in
+ *  the urgent lane if it holds an urgent record, reports the result to the
+ *  producer of every record, and empties the batch. Only a 2xx response
+ *  delivers the batch; otherwise its records are handed to the offline
+ *  queue.
+ *
+ * Parameters:
+ *  sending - Batch to post.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void post_batch(telemetry_batch_t *sending)
+{
+    cy_rslt_t result;
+    cy_rslt_t results[TELEMETRY_BATCH_MAX_RECORDS];
+    uint32_t index;
+    uint32_t queued = 0;
+    compressed_upload_stats_t upload;
+
+    result = compressed_upload_send(CY_HTTP_CLIENT_METHOD_POST, TELEMETRY_BATCH_PATH,
+                                    TELEMETRY_BATCH_CONTENT_TYPE, read_batch, sending,
+                                    TELEMETRY_BATCH_UPLOAD_POLICY,
+                                    sending->urgent ? REQUEST_LANE_URGENT : REQUEST_LANE_BULK, &upload);
+    if ((CY_RSLT_SUCCESS == result) &&
+        ((upload.status_code < HTTP_STATUS_OK) || (upload.status_code >= HTTP_STATUS_MULTIPLE_CHOICES)))
+    {
+        ERR_INFO(("The server answered a telemetry batch with status %lu.\n", (unsigned long)upload.status_code));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+
+    for (index = 0; index < sending->count; index++)
+    {
+        results[index] = result;
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        queued = queue_batch(sending, results);
+    }
+
+    xSemaphoreTake(batch_mutex, portMAX_DELAY);
+    batch_stats.radio_ms += upload.send_ms;
+    batch_stats.batches++;
+    batch_stats.urgent_batches += sending->urgent ? 1u : 0u;
+    batch_stats.wire_bytes += upload.wire_bytes;
+    batch_stats.tx_bytes += upload.tx_bytes;
+    batch_stats.rx_bytes += upload.rx_bytes;
+    batch_stats.handshakes += upload.connections;
+    if (CY_RSLT_SUCCESS == result)
+    {
+        batch_stats.records += sending->count;
+        batch_stats.payload_bytes += sending->payload_bytes;
+        batch_stats.body_bytes += sending->length;
+    }
+    else
+    {
+        batch_stats.failed_batches++;
+        batch_stats.queued_records += queued;
+        ERR_INFO(("Failed to post a telemetry batch of %lu records, %lu queued for replay.\n",
+                  (unsigned long)sending->count, (unsigned long)queued));
+    }
+    xSemaphoreGive(batch_mutex);
+
+    for (index = 0; index < sending->count; index++)
+    {
+        if (NULL != sending->done[index])
+        {
+            sending->done[index](results[index], sending->done_arg[index]);
+        }
+    }
+
+    sending->length = 0;
+    sending->count = 0;
+    sending->payload_bytes = 0;
+    sending->urgent = false;
+}
+
+/*******************************************************************************
+ * Function Name: read_batch
+ *******************************************************************************
+ * Summary:
+ *  Upload source that reads the body of a batch.
+ *
+ * Parameters:
+ *  offset - Offset in the body.
+ *  buffer - Destination.
+ *  size - Size of the destination.
+ *  arg - Batch being posted.
+ *
+ * Return:
+ *  size_t: Number of bytes copied, 0 at the end of the body.
+ *
+ *******************************************************************************/
+static size_t read_batch(uint32_t offset, uint8_t *buffer, size_t size, void *arg)
+{
+    const telemetry_batch_t *sending = (const telemetry_batch_t *)arg;
+    size_t length = 0;
+
+    if (offset < sending->length)
+    {
+        length = sending->length - offset;
+        if (length > size)
+        {
+            length = size;
+        }
+        memcpy(buffer, &sending->body[offset], length);
+    }
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: queue_batch
+ *******************************************************************************
+ * Summary:
+ *  Hands the records of a batch that was not delivered to the offline
+ *  queue, one record per request with its newline, so that the replay can
+ *  combine them into batches again.
+ *
+ * Parameters:
+ *  sending - Batch that was not delivered.
+ *  results - Results of the records, set to TELEMETRY_BATCH_RSLT_QUEUED for
+ *  each record queued.
+ *
+ * Return:
+ *  uint32_t: Number of records queued.
+ *
+ *******************************************************************************/
+static uint32_t queue_batch(const telemetry_batch_t *sending, cy_rslt_t *results)
+{
+    const uint8_t *record = sending->body;
+    const uint8_t *end = &sending->body[sending->length];
+    const uint8_t *newline;
+    uint32_t index = 0;
+    uint32_t queued = 0;
+
+    while (record < end)
+    {
+        newline = memchr(record, '\n', (size_t)(end - record));
+        if (NULL == newline)
+        {
+            break;
+        }
+
+        if (CY_RSLT_SUCCESS == offline_queue_enqueue(CY_HTTP_CLIENT_METHOD_POST, TELEMETRY_BATCH_PATH, record,
+                                                     (uint32_t)(newline - record) + 1u))
+        {
+            results[index] = TELEMETRY_BATCH_RSLT_QUEUED;
+            queued++;
+        }
+        index++;
+        record = newline + 1;
+    }
+
+    return queued;
+}
+
+/*******************************************************************************
+ * Function Name: age_timer_callback
+ *******************************************************************************
+ * Summary:
+ *  Requests a flush when the oldest record of the batch reached its age limit.
+ *
+ * Parameters:
+ *  timer - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void age_timer_callback(TimerHandle_t timer)
+{
+    (void)timer;
+
+    xTaskNotifyGive(telemetry_batch_task_handle);
+}
+
+/*******************************************************************************
+ * Function Name: demo_done_callback
+ *******************************************************************************
+ * Summary:
+ *  Counts the completion of a record posted by the demo, telling the records
+ *  left to the offline queue from the lost ones.
+ *
+ * Parameters:
+ *  result - Result of the post that carried the record.
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void demo_done_callback(cy_rslt_t result, void *arg)
+{
+    (void)arg;
+
+    if (TELEMETRY_BATCH_RSLT_QUEUED == result)
+    {
+        demo_queued++;
+    }
+    else if (CY_RSLT_SUCCESS != result)
+    {
+        demo_failures++;
+    }
+
+    xSemaphoreGive(demo_done_semaphore);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,164 @@
+/******************************************************************************
+* File Name: telemetry_batch.h
+*
+* Description: This file contains the configuration parameters and the API of
+* the telemetry batching layer that coalesces records from many producers into
+* a single HTTP POST.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TELEMETRY_BATCH_H_
+#define TELEMETRY_BATCH_H_
+
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Resource the batches are posted to. The body holds one record per line. */
+#define TELEMETRY_BATCH_PATH                     "/telemetry"
+#define TELEMETRY_BATCH_CONTENT_TYPE             "application/x-ndjson"
+
+/* Compression policy of the batch bodies, see compressed_upload.h.
+ * UPLOAD_POLICY_NONE posts them uncompressed.
+ */
+#define TELEMETRY_BATCH_UPLOAD_POLICY            UPLOAD_POLICY_BALANCED
+
+/* Capacity of a batch. A batch is posted as soon as it holds
+ * TELEMETRY_BATCH_FLUSH_BYTES or TELEMETRY_BATCH_MAX_RECORDS records.
+ */
+#define TELEMETRY_BATCH_BUFFER_SIZE              (1024)
+#define TELEMETRY_BATCH_FLUSH_BYTES              (768)
+#define TELEMETRY_BATCH_MAX_RECORDS              (32)
+
+/* Longest time a record waits in a batch before the batch is posted. It is
+ * shorter than COMPRESSED_UPLOAD_IDLE_CLOSE_MS, so that a steady trickle of
+ * records keeps the connection of the uploads warm and only the first batch
+ * pays a TLS handshake.
+ */
+#define TELEMETRY_BATCH_MAX_AGE_MS               (5000)
+
+/* Longest time a producer waits for room in a batch. */
+#define TELEMETRY_BATCH_ADD_TIMEOUT_MS           (10000)
+
+/* Bytes that one HTTP request costs on air beyond its body: request line,
+ * headers, response, and TLS, TCP, and IP framing in both directions.
+ * Measured from the request and response headers printed for a POST to
+ * HTTP_PATH. Used by the scheduler simulation, which sends no requests; the
+ * statistics of the batches count the bytes of the real requests.
+ */
+#define TELEMETRY_BATCH_REQUEST_OVERHEAD         (420)
+
+/* Bytes of a TLS handshake with mutual authentication, both directions,
+ * with one certificate each way. The secure sockets layer does not report
+ * the handshake bytes, so the statistics count the handshakes and add this
+ * for each. Adjust it for longer certificate chains.
+ */
+#define TELEMETRY_BATCH_HANDSHAKE_BYTES          (3500)
+
+/* Result passed to the done callback of a record that was not delivered
+ * but handed to the offline queue, which will send it again. The producer
+ * must not send such a record itself.
+ */
+#define TELEMETRY_BATCH_RSLT_QUEUED              CY_RSLT_CREATE(CY_RSLT_TYPE_INFO, CY_RSLT_MODULE_MIDDLEWARE_BASE, 1u)
+
+/* Batch task parameters. */
+#define TELEMETRY_BATCH_TASK_STACK_SIZE          (2 * 1024)
+#define TELEMETRY_BATCH_TASK_PRIORITY            (1)
+
+/* Simulated sensor used by the "telemetry batching" menu option. */
+#define TELEMETRY_DEMO_RECORDS                   (60)
+#define TELEMETRY_DEMO_INTERVAL_MS               (200)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+/* Urgent records are posted immediately together with the pending ones, in
+ * the urgent lane of the request scheduler.
+ */
+typedef enum
+{
+    TELEMETRY_PRIORITY_NORMAL,
+    TELEMETRY_PRIORITY_URGENT,
+} telemetry_priority_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Called once per record when the batch that holds it has been posted.
+ * result is CY_RSLT_SUCCESS if the server has accepted the record with a 2xx
+ * status. A record that was not accepted is handed to the offline queue,
+ * when it fits there, to be sent again once the server is reachable; result
+ * is then TELEMETRY_BATCH_RSLT_QUEUED. Any other result means the record is
+ * lost unless the producer sends it again.
+ */
+typedef void (*telemetry_done_cb_t)(cy_rslt_t result, void *arg);
+
+/* Counters since the start of the application. Times are in milliseconds. */
+typedef struct
+{
+    uint32_t records;            /* Records accepted by the server. */
+    uint32_t batches;            /* POST requests sent. */
+    uint32_t urgent_batches;     /* Batches flushed by an urgent record. */
+    uint32_t failed_batches;     /* POST requests that failed or were not accepted. */
+    uint32_t queued_records;     /* Records of failed batches put in the offline queue. */
+    uint32_t payload_bytes;      /* Record bytes of the delivered batches, without separators. */
+    uint32_t body_bytes;         /* Body bytes of the delivered batches. */
+    uint32_t wire_bytes;         /* Body bytes sent, after compression, of all the batches. */
+    uint32_t tx_bytes;           /* Bytes of the requests, headers and framing included. */
+    uint32_t rx_bytes;           /* Bytes of the responses. */
+    uint32_t handshakes;         /* TLS handshakes of the connections the batches opened. */
+    uint32_t radio_ms;           /* Time spent in the POST requests. */
+    uint32_t elapsed_ms;         /* Time since the first record. */
+} telemetry_batch_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t telemetry_batch_init(void);
+cy_rslt_t telemetry_batch_add(const char *record, uint32_t length, telemetry_priority_t priority,
+                              telemetry_done_cb_t done, void *arg);
+void telemetry_batch_get_stats(telemetry_batch_stats_t *stats);
+void telemetry_batch_print_stats(void);
+void telemetry_batch_demo(void);
+
+#endif /* TELEMETRY_BATCH_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,363 @@
+/******************************************************************************
+* File Name: tls_stream.c
+*
+* Description: This file contains the TLS byte stream to the HTTPS server.
+* It opens a secure socket with the client identity and root CA of
+* secure_keys.h and exposes blocking send and receive calls.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "cy_secure_sockets.h"
+#include "cy_tls.h"
+
+#include "secure_http_client.h"
+#include "secure_keys.h"
+#include "tls_stream.h"
+#include "wifi_power.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Time given to the TLS close notification when the stream is closed. */
+#define TLS_STREAM_DISCONNECT_TIMEOUT_MS (100u)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char client_certificate[] = keyCLIENT_CERTIFICATE_PEM;
+static const char client_private_key[] = keyCLIENT_PRIVATE_KEY_PEM;
+static const char server_root_ca[] = keySERVER_ROOTCA_PEM;
+
+/*******************************************************************************
+ * Function Name: tls_stream_connect
+ *******************************************************************************
+ * Summary:
+ *  Resolves the server, opens a TLS connection to it, and completes the
+ *  handshake. The server certificate is verified against the root CA. The
+ *  radio is kept awake until the stream is closed.
+ *
+ * Parameters:
+ *  stream - Stream to open.
+ *  host - Host name or address of the server.
+ *  port - TCP port of the server.
+ *  timeout_ms - Send and receive timeout of the socket.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the stream is connected,
+ *  otherwise, the error of the secure sockets library.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_stream_connect(tls_stream_t *stream, const char *host, uint16_t port, uint32_t timeout_ms)
+{
+    return tls_stream_connect_alpn(stream, host, port, timeout_ms, NULL);
+}
+
+/*******************************************************************************
+ * Function Name: tls_stream_connect_alpn
+ *******************************************************************************
+ * Summary:
+ *  Opens a TLS connection like tls_stream_connect(), offering application
+ *  protocols with ALPN in the handshake.
+ *
+ * Parameters:
+ *  stream - Stream to open.
+ *  host - Host name or address of the server.
+ *  port - TCP port of the server.
+ *  timeout_ms - Send and receive timeout of the socket.
+ *  protocols - Comma-separated protocols to offer, for example "h2", or NULL
+ *  to offer none.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the stream is connected,
+ *  otherwise, the error of the secure sockets library.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_stream_connect_alpn(tls_stream_t *stream, const char *host, uint16_t port, uint32_t timeout_ms,
+                                  const char *protocols)
+{
+    cy_rslt_t result;
+    cy_socket_sockaddr_t address;
+    int auth_mode = CY_SOCKET_TLS_VERIFY_REQUIRED;
+    int nodelay = 1;
+
+    memset(stream, 0, sizeof(*stream));
+    memset(&address, 0, sizeof(address));
+
+    wifi_power_begin();
+    stream->powered = true;
+
+    result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to resolve %s: 0x%08lx\n", host, (unsigned long)result));
+        tls_stream_close(stream);
+        return result;
+    }
+    address.port = port;
+
+    result = cy_tls_create_identity(client_certificate, sizeof(client_certificate),
+                                    client_private_key, sizeof(client_private_key), &stream->identity);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to create the TLS identity: 0x%08lx\n", (unsigned long)result));
+        stream->identity = NULL;
+        tls_stream_close(stream);
+        return result;
+    }
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TLS,
+                              &stream->socket);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to create a TLS socket: 0x%08lx\n", (unsigned long)result));
+        stream->socket = NULL;
+        tls_stream_close(stream);
+        return result;
+    }
+
+    result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_IDENTITY,
+                                  stream->identity, sizeof(stream->identity));
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TRUSTED_ROOTCA_CERTIFICATE,
+                                      server_root_ca, sizeof(server_root_ca));
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_AUTH_MODE,
+                                      &auth_mode, sizeof(auth_mode));
+    }
+    if ((CY_RSLT_SUCCESS == result) && (NULL != protocols))
+    {
+        result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_ALPN_PROTOCOLS,
+                                      protocols, (uint32_t)strlen(protocols));
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        /* Requests are written whole, so waiting to coalesce them only adds latency. */
+        result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_TCP, CY_SOCKET_SO_TCP_NODELAY,
+                                      &nodelay, sizeof(nodelay));
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = tls_stream_set_timeout(stream, timeout_ms);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_socket_connect(stream->socket, &address, sizeof(address));
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to connect the TLS stream to %s:%u: 0x%08lx\n", host, port, (unsigned long)result));
+        tls_stream_close(stream);
+        return result;
+    }
+
+    stream->connected = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_stream_send
+ *******************************************************************************
+ * Summary:
+ *  Sends all the data, blocking until it has been passed to the TCP stack.
+ *
+ * Parameters:
+ *  stream - Connected stream.
+ *  data - Data to send.
+ *  length - Number of bytes.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if all the data was sent, otherwise,
+ *  the error of the secure sockets library. The stream is closed on error.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_stream_send(tls_stream_t *stream, const void *data, uint32_t length)
+{
+    const uint8_t *next = (const uint8_t *)data;
+    uint32_t sent;
+    cy_rslt_t result;
+
+    if (!stream->connected)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    while (length > 0u)
+    {
+        sent = 0;
+        result = cy_socket_send(stream->socket, next, length, CY_SOCKET_FLAGS_NONE, &sent);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            tls_stream_close(stream);
+            return result;
+        }
+
+        next += sent;
+        length -= sent;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_stream_recv
+ *******************************************************************************
+ * Summary:
+ *  Receives the data that has arrived, waiting up to the socket timeout for
+ *  at least one byte.
+ *
+ * Parameters:
+ *  stream - Connected stream.
+ *  buffer - Destination.
+ *  size - Size of the destination.
+ *  received - Set to the number of bytes received.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if data was received,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT if none arrived, otherwise, the
+ *  error of the secure sockets library. The stream is closed on errors other
+ *  than the timeout.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_stream_recv(tls_stream_t *stream, void *buffer, uint32_t size, uint32_t *received)
+{
+    cy_rslt_t result;
+
+    *received = 0;
+
+    if (!stream->connected)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    result = cy_socket_recv(stream->socket, buffer, size, CY_SOCKET_FLAGS_NONE, received);
+    if ((CY_RSLT_SUCCESS == result) && (0u == *received))
+    {
+        result = CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    if ((CY_RSLT_SUCCESS != result) && (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT != result))
+    {
+        tls_stream_close(stream);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tls_stream_set_timeout
+ *******************************************************************************
+ * Summary:
+ *  Sets the send and receive timeout of the stream.
+ *
+ * Parameters:
+ *  stream - Stream.
+ *  timeout_ms - Timeout in milliseconds.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS, or the error of the secure sockets
+ *  library.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_stream_set_timeout(tls_stream_t *stream, uint32_t timeout_ms)
+{
+    cy_rslt_t result;
+
+    result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO,
+                                  &timeout_ms, sizeof(timeout_ms));
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_socket_setsockopt(stream->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO,
+                                      &timeout_ms, sizeof(timeout_ms));
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tls_stream_close
+ *******************************************************************************
+ * Summary:
+ *  Closes the connection, frees the socket and the TLS identity, and lets
+ *  the radio save power again. Can be called on a stream that is already
+ *  closed.
+ *
+ * Parameters:
+ *  stream - Stream to close.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void tls_stream_close(tls_stream_t *stream)
+{
+    if (NULL != stream->socket)
+    {
+        if (stream->connected)
+        {
+            (void)cy_socket_disconnect(stream->socket, TLS_STREAM_DISCONNECT_TIMEOUT_MS);
+        }
+        (void)cy_socket_delete(stream->socket);
+        stream->socket = NULL;
+    }
+
+    if (NULL != stream->identity)
+    {
+        (void)cy_tls_delete_identity(stream->identity);
+        stream->identity = NULL;
+    }
+
+    stream->connected = false;
+
+    if (stream->powered)
+    {
+        stream->powered = false;
+        wifi_power_end();
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name: tls_stream.h
+*
+* Description: This file contains the structures and function prototypes of
+* the TLS byte stream to the HTTPS server, used by the protocols that need
+* the connection itself rather than one request and one response.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TLS_STREAM_H_
+#define TLS_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "cy_secure_sockets.h"
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* One TLS connection. Authenticated with the keys in secure_keys.h, like the
+ * HTTP client. The stream holds a Wi-Fi power reference from
+ * tls_stream_connect() to tls_stream_close().
+ */
+typedef struct
+{
+    cy_socket_t socket;
+    void *identity;
+    bool connected;
+    bool powered;
+} tls_stream_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t tls_stream_connect(tls_stream_t *stream, const char *host, uint16_t port, uint32_t timeout_ms);
+cy_rslt_t tls_stream_connect_alpn(tls_stream_t *stream, const char *host, uint16_t port, uint32_t timeout_ms,
+                                  const char *protocols);
+cy_rslt_t tls_stream_send(tls_stream_t *stream, const void *data, uint32_t length);
+cy_rslt_t tls_stream_recv(tls_stream_t *stream, void *buffer, uint32_t size, uint32_t *received);
+cy_rslt_t tls_stream_set_timeout(tls_stream_t *stream, uint32_t timeout_ms);
+void tls_stream_close(tls_stream_t *stream);
+
+#endif /* TLS_STREAM_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1128 @@
+/******************************************************************************
+* File Name: websocket.c
+*
+* Description: This file contains the WebSocket client (RFC 6455). The
+* connection is made with the TLS stream and upgraded with the HTTP/1.1
+* handshake. Outgoing frames are masked and long messages fragmented;
+* incoming frames are parsed in place and their payloads passed to a
+* callback straight from the receive buffer. Pings are answered, and a ping
+* is sent on an idle connection to detect that it has died.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+
+#include "secure_http_client.h"
+#include "http_pipeline.h"
+#include "websocket.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define WEBSOCKET_GUID                   "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WEBSOCKET_KEY_SIZE               (16u)
+#define WEBSOCKET_KEY_BASE64_SIZE        (25u)
+#define WEBSOCKET_ACCEPT_BASE64_SIZE     (29u)
+#define SHA1_SIZE                        (20u)
+#define WEBSOCKET_DRBG_PERSONALIZATION   "websocket"
+
+#define FRAME_FIN                        (0x80u)
+#define FRAME_RSV                        (0x70u)
+#define FRAME_OPCODE                     (0x0Fu)
+#define FRAME_MASK                       (0x80u)
+#define FRAME_LENGTH                     (0x7Fu)
+#define FRAME_LENGTH_16                  (126u)
+#define FRAME_LENGTH_64                  (127u)
+#define FRAME_MAX_HEADER                 (14u)
+#define MAX_CONTROL_PAYLOAD              (125u)
+
+#define HTTP_STATUS_SWITCHING_PROTOCOLS  (101u)
+
+/* Largest echo message of the demo. */
+#define DEMO_MESSAGE_SIZE                (32u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* State of the demo shared with its callback. */
+typedef struct
+{
+    uint32_t echoed_seq;
+    bool echoed;
+    uint32_t commands;
+    char message[DEMO_MESSAGE_SIZE + 1];
+    uint32_t message_length;
+} demo_state_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static websocket_t demo_ws;
+static http_pipeline_t demo_poll_pipeline;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t send_handshake(websocket_t *ws, const char *path, char *accept);
+static cy_rslt_t read_handshake(websocket_t *ws, const char *accept, uint32_t *leftover_start,
+                                uint32_t *leftover_end);
+static bool find_header(const char *headers, const char *name, const char **value, size_t *length);
+static cy_rslt_t send_frame(websocket_t *ws, uint8_t opcode, bool fin, const uint8_t *data, uint32_t length);
+static bool process_input(websocket_t *ws, const uint8_t *data, uint32_t length);
+static bool parse_frame_header(websocket_t *ws);
+static void deliver_payload(websocket_t *ws, const uint8_t *data, uint32_t length);
+static bool complete_frame(websocket_t *ws);
+static void fail_connection(websocket_t *ws, uint16_t code);
+static cy_rslt_t check_keepalive(websocket_t *ws);
+static cy_rslt_t seed_random(websocket_t *ws);
+static void free_random(websocket_t *ws);
+static void demo_callback(websocket_t *ws, const websocket_event_t *event, void *arg);
+static void demo_poll_callback(const http_pipeline_event_t *event, void *arg);
+
+/*******************************************************************************
+ * Function Name: websocket_connect
+ *******************************************************************************
+ * Summary:
+ *  Opens a TLS connection to the HTTPS server and upgrades it to a
+ *  WebSocket. The server's Sec-WebSocket-Accept is verified.
+ *
+ * Parameters:
+ *  ws - Client to connect.
+ *  path - Resource to upgrade.
+ *  callback - Called with the parts of the received messages.
+ *  arg - Argument passed to the callback.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the WebSocket is open, otherwise,
+ *  the error of the TLS stream or CY_RSLT_TYPE_ERROR if the server refused
+ *  the upgrade.
+ *
+ *******************************************************************************/
+cy_rslt_t websocket_connect(websocket_t *ws, const char *path, websocket_cb_t callback, void *arg)
+{
+    cy_rslt_t result;
+    char accept[WEBSOCKET_ACCEPT_BASE64_SIZE];
+    uint32_t leftover_start;
+    uint32_t leftover_end;
+
+    memset(ws, 0, sizeof(*ws));
+    ws->callback = callback;
+    ws->callback_arg = arg;
+    ws->header_needed = 2u;
+    ws->timeout_ms = TRANSPORT_SEND_RECV_TIMEOUT_MS;
+
+    result = seed_random(ws);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    result = tls_stream_connect(&ws->stream, HTTPS_SERVER_HOST, HTTPS_PORT, ws->timeout_ms);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        free_random(ws);
+        return result;
+    }
+
+    result = send_handshake(ws, path, accept);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = read_handshake(ws, accept, &leftover_start, &leftover_end);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        tls_stream_close(&ws->stream);
+        free_random(ws);
+        return result;
+    }
+
+    ws->open = true;
+    ws->last_rx_ticks = xTaskGetTickCount();
+
+    /* Frames sent right after the handshake response. */
+    if ((leftover_end > leftover_start) &&
+        !process_input(ws, &ws->rx_buffer[leftover_start], leftover_end - leftover_start))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: websocket_send
+ *******************************************************************************
+ * Summary:
+ *  Sends a message. Messages longer than WEBSOCKET_FRAGMENT_SIZE are split
+ *  into a first frame and continuation frames. Must be called from the task
+ *  that polls the WebSocket, which includes its callback.
+ *
+ * Parameters:
+ *  ws - Open WebSocket.
+ *  opcode - WEBSOCKET_OPCODE_TEXT or WEBSOCKET_OPCODE_BINARY.
+ *  data - Message.
+ *  length - Length of the message.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the message was sent, otherwise,
+ *  the error of the TLS stream.
+ *
+ *******************************************************************************/
+cy_rslt_t websocket_send(websocket_t *ws, websocket_opcode_t opcode, const uint8_t *data, uint32_t length)
+{
+    cy_rslt_t result;
+    uint32_t fragment;
+    uint8_t frame_opcode = (uint8_t)opcode;
+
+    if (!ws->open)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    do
+    {
+        fragment = (length > WEBSOCKET_FRAGMENT_SIZE) ? WEBSOCKET_FRAGMENT_SIZE : length;
+
+        result = send_frame(ws, frame_opcode, fragment == length, data, fragment);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        frame_opcode = WEBSOCKET_OPCODE_CONTINUATION;
+        data += fragment;
+        length -= fragment;
+    } while (length > 0u);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: websocket_poll
+ *******************************************************************************
+ * Summary:
+ *  Waits up to a timeout for data, processes the frames that arrived, and
+ *  runs the keepalive. Call it at least every WEBSOCKET_PONG_TIMEOUT_MS.
+ *
+ * Parameters:
+ *  ws - Open WebSocket.
+ *  timeout_ms - Longest time to wait for data.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the WebSocket is still open,
+ *  otherwise, the reason it was closed.
+ *
+ *******************************************************************************/
+cy_rslt_t websocket_poll(websocket_t *ws, uint32_t timeout_ms)
+{
+    cy_rslt_t result;
+    uint32_t received;
+
+    if (!ws->open)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    if (timeout_ms != ws->timeout_ms)
+    {
+        (void)tls_stream_set_timeout(&ws->stream, timeout_ms);
+        ws->timeout_ms = timeout_ms;
+    }
+
+    result = tls_stream_recv(&ws->stream, ws->rx_buffer, sizeof(ws->rx_buffer), &received);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        ws->last_rx_ticks = xTaskGetTickCount();
+        ws->stats.bytes_received += received;
+
+        if (!process_input(ws, ws->rx_buffer, received))
+        {
+            return CY_RSLT_TYPE_ERROR;
+        }
+    }
+    else if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT != result)
+    {
+        ws->open = false;
+        return result;
+    }
+
+    if (!ws->open)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    return check_keepalive(ws);
+}
+
+/*******************************************************************************
+ * Function Name: websocket_close
+ *******************************************************************************
+ * Summary:
+ *  Sends a close frame, waits briefly for the server's close frame, and
+ *  closes the connection.
+ *
+ * Parameters:
+ *  ws - WebSocket.
+ *  code - Close status code.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void websocket_close(websocket_t *ws, uint16_t code)
+{
+    uint8_t payload[2];
+
+    if (ws->open)
+    {
+        payload[0] = (uint8_t)(code >> 8);
+        payload[1] = (uint8_t)code;
+
+        if (CY_RSLT_SUCCESS == send_frame(ws, WEBSOCKET_OPCODE_CLOSE, true, payload, sizeof(payload)))
+        {
+            /* The server answers with its own close frame, which clears open. */
+            (void)websocket_poll(ws, WEBSOCKET_PONG_TIMEOUT_MS);
+        }
+    }
+
+    ws->open = false;
+    tls_stream_close(&ws->stream);
+    free_random(ws);
+}
+
+/*******************************************************************************
+ * Function Name: websocket_demo
+ *******************************************************************************
+ * Summary:
+ *  Compares a WebSocket with periodic GET polling as the channel for
+ *  server-to-device commands:
+ *  - Latency: measures echo round trips on the WebSocket and GET round trips
+ *    on a keep-alive connection. A command waits half a round trip on the
+ *    WebSocket, and on average half the polling interval plus a round trip
+ *    with polling.
+ *  - Idle cost: stays idle on the WebSocket for WEBSOCKET_DEMO_IDLE_MS,
+ *    answering any commands, and counts the exchanges and bytes it took.
+ *    These are compared with the polls of the same period. Radio wake-ups
+ *    and bytes on air are what the idle current of the Wi-Fi link scales
+ *    with.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void websocket_demo(void)
+{
+    static demo_state_t state;
+    const char *poll_path = HTTP_PATH;
+    http_pipeline_stats_t poll_stats;
+    uint32_t poll_bytes = 0;
+    uint32_t total_ms = 0;
+    uint32_t min_ms = UINT32_MAX;
+    uint32_t max_ms = 0;
+    uint32_t elapsed_ms;
+    uint32_t poll_ms = 0;
+    uint32_t polls;
+    uint32_t idle_frames;
+    uint32_t idle_bytes;
+    TickType_t start_ticks;
+    cy_rslt_t result;
+    char message[DEMO_MESSAGE_SIZE];
+    int length;
+
+    memset(&state, 0, sizeof(state));
+
+    result = websocket_connect(&demo_ws, WEBSOCKET_PATH, demo_callback, &state);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to open the WebSocket %s: 0x%08lx\n", WEBSOCKET_PATH, (unsigned long)result));
+        return;
+    }
+    APP_INFO(("WebSocket %s open\n", WEBSOCKET_PATH));
+
+    for (uint32_t seq = 0; seq < WEBSOCKET_DEMO_ECHOES; seq++)
+    {
+        length = snprintf(message, sizeof(message), "echo %lu", (unsigned long)seq);
+        state.echoed = false;
+        start_ticks = xTaskGetTickCount();
+
+        result = websocket_send(&demo_ws, WEBSOCKET_OPCODE_TEXT, (const uint8_t *)message, (uint32_t)length);
+        while ((CY_RSLT_SUCCESS == result) && !(state.echoed && (state.echoed_seq == seq)))
+        {
+            if ((uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS > TRANSPORT_SEND_RECV_TIMEOUT_MS)
+            {
+                result = CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+                break;
+            }
+            result = websocket_poll(&demo_ws, TRANSPORT_SEND_RECV_TIMEOUT_MS);
+        }
+
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Echo %lu failed: 0x%08lx\n", (unsigned long)seq, (unsigned long)result));
+            websocket_close(&demo_ws, WEBSOCKET_CLOSE_NORMAL);
+            return;
+        }
+
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+        total_ms += elapsed_ms;
+        min_ms = (elapsed_ms < min_ms) ? elapsed_ms : min_ms;
+        max_ms = (elapsed_ms > max_ms) ? elapsed_ms : max_ms;
+    }
+
+    /* The polling request, on a connection opened beforehand like the WebSocket. */
+    http_pipeline_init(&demo_poll_pipeline, 1);
+    result = http_pipeline_get(&demo_poll_pipeline, &poll_path, 1, demo_poll_callback, &poll_bytes, NULL);
+    for (uint32_t i = 0; (CY_RSLT_SUCCESS == result) && (i < WEBSOCKET_DEMO_ECHOES); i++)
+    {
+        result = http_pipeline_get(&demo_poll_pipeline, &poll_path, 1, demo_poll_callback, &poll_bytes, &poll_stats);
+        poll_ms += poll_stats.elapsed_ms;
+    }
+    http_pipeline_close(&demo_poll_pipeline);
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("The polling GET failed: 0x%08lx\n", (unsigned long)result));
+        websocket_close(&demo_ws, WEBSOCKET_CLOSE_NORMAL);
+        return;
+    }
+
+    APP_INFO(("Round trips over %u exchanges:\n", WEBSOCKET_DEMO_ECHOES));
+    printf("  WebSocket echo : avg %lu ms, min %lu ms, max %lu ms\n", (unsigned long)(total_ms / WEBSOCKET_DEMO_ECHOES),
+           (unsigned long)min_ms, (unsigned long)max_ms);
+    printf("  GET poll       : avg %lu ms\n", (unsigned long)(poll_ms / WEBSOCKET_DEMO_ECHOES));
+    printf("  Command latency: WebSocket ~%lu ms, polling every %lu ms ~%lu ms\n",
+           (unsigned long)(total_ms / (2u * WEBSOCKET_DEMO_ECHOES)), (unsigned long)WEBSOCKET_DEMO_POLL_INTERVAL_MS,
+           (unsigned long)((WEBSOCKET_DEMO_POLL_INTERVAL_MS / 2u) + (poll_ms / WEBSOCKET_DEMO_ECHOES)));
+
+    APP_INFO(("Idling on the WebSocket for %lu s; commands from the server are acknowledged\n",
+              (unsigned long)(WEBSOCKET_DEMO_IDLE_MS / 1000u)));
+
+    idle_frames = demo_ws.stats.frames_sent + demo_ws.stats.frames_received;
+    idle_bytes = demo_ws.stats.bytes_sent + demo_ws.stats.bytes_received;
+    start_ticks = xTaskGetTickCount();
+
+    while ((CY_RSLT_SUCCESS == result) &&
+           ((uint32_t)(xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS < WEBSOCKET_DEMO_IDLE_MS))
+    {
+        result = websocket_poll(&demo_ws, WEBSOCKET_PONG_TIMEOUT_MS / 2u);
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("The WebSocket closed while idle: 0x%08lx\n", (unsigned long)result));
+    }
+
+    idle_frames = demo_ws.stats.frames_sent + demo_ws.stats.frames_received - idle_frames;
+    idle_bytes = demo_ws.stats.bytes_sent + demo_ws.stats.bytes_received - idle_bytes;
+    polls = WEBSOCKET_DEMO_IDLE_MS / WEBSOCKET_DEMO_POLL_INTERVAL_MS;
+
+    printf("  Idle %lu s     : WebSocket %lu frames, %lu bytes, %lu pings (last RTT %lu ms), %lu commands\n",
+           (unsigned long)(WEBSOCKET_DEMO_IDLE_MS / 1000u), (unsigned long)idle_frames, (unsigned long)idle_bytes,
+           (unsigned long)demo_ws.stats.pings_sent, (unsigned long)demo_ws.stats.ping_rtt_ms,
+           (unsigned long)state.commands);
+    printf("                   polling %lu requests, %lu body bytes, %lu ms of requests\n",
+           (unsigned long)polls, (unsigned long)((poll_bytes / (WEBSOCKET_DEMO_ECHOES + 1u)) * polls),
+           (unsigned long)((poll_ms / WEBSOCKET_DEMO_ECHOES) * polls));
+
+    websocket_close(&demo_ws, WEBSOCKET_CLOSE_NORMAL);
+}
+
+/*******************************************************************************
+ * Function Name: send_handshake
+ *******************************************************************************
+ * Summary:
+ *  Sends the upgrade request with a random key and computes the
+ *  Sec-WebSocket-Accept value the server must answer with.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_handshake(websocket_t *ws, const char *path, char *accept)
+{
+    uint8_t key[WEBSOCKET_KEY_SIZE];
+    char key_base64[WEBSOCKET_KEY_BASE64_SIZE];
+    char concatenated[WEBSOCKET_KEY_BASE64_SIZE + sizeof(WEBSOCKET_GUID)];
+    uint8_t digest[SHA1_SIZE];
+    size_t olen;
+    int length;
+
+    if ((0 != mbedtls_ctr_drbg_random(&ws->drbg, key, sizeof(key))) ||
+        (0 != mbedtls_base64_encode((unsigned char *)key_base64, sizeof(key_base64), &olen, key, sizeof(key))) ||
+        (0 > snprintf(concatenated, sizeof(concatenated), "%s%s", key_base64, WEBSOCKET_GUID)) ||
+        (0 != mbedtls_sha1_ret((const unsigned char *)concatenated, strlen(concatenated), digest)) ||
+        (0 != mbedtls_base64_encode((unsigned char *)accept, WEBSOCKET_ACCEPT_BASE64_SIZE, &olen,
+                                    digest, sizeof(digest))))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    length = snprintf((char *)ws->tx_buffer, sizeof(ws->tx_buffer),
+                      "GET %s HTTP/1.1\r\n"
+                      "Host: %s:%u\r\n"
+                      "Upgrade: websocket\r\n"
+                      "Connection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: %s\r\n"
+                      "Sec-WebSocket-Version: 13\r\n"
+                      "\r\n",
+                      path, HTTPS_SERVER_HOST, HTTPS_PORT, key_base64);
+    if ((length < 0) || ((uint32_t)length >= sizeof(ws->tx_buffer)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return tls_stream_send(&ws->stream, ws->tx_buffer, (uint32_t)length);
+}
+
+/*******************************************************************************
+ * Function Name: read_handshake
+ *******************************************************************************
+ * Summary:
+ *  Receives the response to the upgrade request and checks that it is 101
+ *  Switching Protocols with the expected Sec-WebSocket-Accept. Bytes after
+ *  the response are the first frames; their position in the receive buffer
+ *  is returned.
+ *
+ *******************************************************************************/
+static cy_rslt_t read_handshake(websocket_t *ws, const char *accept, uint32_t *leftover_start,
+                                uint32_t *leftover_end)
+{
+    char *headers = (char *)ws->rx_buffer;
+    char *end = NULL;
+    const char *value;
+    size_t value_length;
+    uint32_t length = 0;
+    uint32_t received;
+    cy_rslt_t result;
+
+    while (NULL == end)
+    {
+        if (length >= (sizeof(ws->rx_buffer) - 1u))
+        {
+            ERR_INFO(("The WebSocket handshake response is longer than %u bytes.\n", WEBSOCKET_RX_BUFFER_SIZE));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        result = tls_stream_recv(&ws->stream, &ws->rx_buffer[length], sizeof(ws->rx_buffer) - 1u - length, &received);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        length += received;
+        ws->rx_buffer[length] = '\0';
+        end = strstr(headers, "\r\n\r\n");
+    }
+
+    *leftover_start = (uint32_t)(end - headers) + 4u;
+    *leftover_end = length;
+    end[2] = '\0';
+
+    if ((0 != strncmp(headers, "HTTP/1.1 ", 9)) || (HTTP_STATUS_SWITCHING_PROTOCOLS != strtoul(&headers[9], NULL, 10)))
+    {
+        ERR_INFO(("The server refused the WebSocket upgrade: %.*s\n", (int)strcspn(headers, "\r"), headers));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (!find_header(headers, "sec-websocket-accept", &value, &value_length) ||
+        (value_length != strlen(accept)) || (0 != strncmp(value, accept, value_length)))
+    {
+        ERR_INFO(("The WebSocket handshake has a wrong Sec-WebSocket-Accept.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: find_header
+ *******************************************************************************
+ * Summary:
+ *  Finds a header in a response head by its lowercase name.
+ *
+ * Return:
+ *  bool: true if found, with the trimmed value and its length.
+ *
+ *******************************************************************************/
+static bool find_header(const char *headers, const char *name, const char **value, size_t *length)
+{
+    size_t name_length = strlen(name);
+    const char *line = strstr(headers, "\r\n");
+    size_t index;
+
+    while ((NULL != line) && ('\0' != line[2]))
+    {
+        line += 2;
+
+        for (index = 0; index < name_length; index++)
+        {
+            if (tolower((unsigned char)line[index]) != name[index])
+            {
+                break;
+            }
+        }
+
+        if ((index == name_length) && (':' == line[index]))
+        {
+            line += index + 1u;
+            while ((' ' == *line) || ('\t' == *line))
+            {
+                line++;
+            }
+            *value = line;
+            *length = strcspn(line, "\r");
+            while ((*length > 0u) && ((' ' == line[*length - 1u]) || ('\t' == line[*length - 1u])))
+            {
+                (*length)--;
+            }
+            return true;
+        }
+
+        line = strstr(line, "\r\n");
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: send_frame
+ *******************************************************************************
+ * Summary:
+ *  Sends one frame. The payload is masked into the transmit buffer behind
+ *  the header, and sent one buffer at a time.
+ *
+ *******************************************************************************/
+static cy_rslt_t send_frame(websocket_t *ws, uint8_t opcode, bool fin, const uint8_t *data, uint32_t length)
+{
+    cy_rslt_t result;
+    uint8_t *tx = ws->tx_buffer;
+    uint32_t used = 0;
+    uint8_t mask_key[4];
+    uint32_t offset = 0;
+
+    /* RFC 6455 5.3: every mask must be unpredictable from the earlier ones. */
+    if (0 != mbedtls_ctr_drbg_random(&ws->drbg, mask_key, sizeof(mask_key)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    tx[used++] = (uint8_t)((fin ? FRAME_FIN : 0u) | opcode);
+    if (length < FRAME_LENGTH_16)
+    {
+        tx[used++] = (uint8_t)(FRAME_MASK | length);
+    }
+    else if (length <= 0xFFFFu)
+    {
+        tx[used++] = FRAME_MASK | FRAME_LENGTH_16;
+        tx[used++] = (uint8_t)(length >> 8);
+        tx[used++] = (uint8_t)length;
+    }
+    else
+    {
+        tx[used++] = FRAME_MASK | FRAME_LENGTH_64;
+        memset(&tx[used], 0, 4);
+        used += 4u;
+        tx[used++] = (uint8_t)(length >> 24);
+        tx[used++] = (uint8_t)(length >> 16);
+        tx[used++] = (uint8_t)(length >> 8);
+        tx[used++] = (uint8_t)length;
+    }
+    memcpy(&tx[used], mask_key, sizeof(mask_key));
+    used += sizeof(mask_key);
+
+    ws->stats.frames_sent++;
+    ws->stats.bytes_sent += used + length;
+
+    do
+    {
+        while ((used < sizeof(ws->tx_buffer)) && (offset < length))
+        {
+            tx[used++] = data[offset] ^ mask_key[offset & 3u];
+            offset++;
+        }
+
+        result = tls_stream_send(&ws->stream, tx, used);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ws->open = false;
+            return result;
+        }
+        used = 0;
+    } while (offset < length);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: process_input
+ *******************************************************************************
+ * Summary:
+ *  Parses received bytes, which can hold any number of frames and parts of
+ *  frames. Frame headers are collected across calls; payloads are passed on
+ *  as they arrive.
+ *
+ * Return:
+ *  bool: false if the connection was failed because of a protocol error.
+ *
+ *******************************************************************************/
+static bool process_input(websocket_t *ws, const uint8_t *data, uint32_t length)
+{
+    uint32_t used;
+
+    while ((length > 0u) && ws->open)
+    {
+        if (!ws->in_payload)
+        {
+            ws->header[ws->header_length++] = *data++;
+            length--;
+
+            if (ws->header_length < ws->header_needed)
+            {
+                continue;
+            }
+
+            if (2u == ws->header_length)
+            {
+                /* The second byte tells the size of the rest of the header. */
+                ws->header_needed = 2u + (((ws->header[1] & FRAME_MASK) != 0u) ? 4u : 0u);
+                if (FRAME_LENGTH_16 == (ws->header[1] & FRAME_LENGTH))
+                {
+                    ws->header_needed += 2u;
+                }
+                else if (FRAME_LENGTH_64 == (ws->header[1] & FRAME_LENGTH))
+                {
+                    ws->header_needed += 8u;
+                }
+
+                if (ws->header_length < ws->header_needed)
+                {
+                    continue;
+                }
+            }
+
+            if (!parse_frame_header(ws))
+            {
+                return false;
+            }
+
+            if ((0u == ws->remaining) && !complete_frame(ws))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        used = (length < ws->remaining) ? length : ws->remaining;
+        deliver_payload(ws, data, used);
+        data += used;
+        length -= used;
+        ws->remaining -= used;
+
+        if ((0u == ws->remaining) && !complete_frame(ws))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_frame_header
+ *******************************************************************************
+ * Summary:
+ *  Checks a complete frame header against the rules of RFC 6455, 5.2 to 5.5.
+ *
+ * Return:
+ *  bool: false if the connection was failed.
+ *
+ *******************************************************************************/
+static bool parse_frame_header(websocket_t *ws)
+{
+    const uint8_t *header = ws->header;
+    uint32_t length = header[1] & FRAME_LENGTH;
+    bool control;
+
+    ws->fin = (0u != (header[0] & FRAME_FIN));
+    ws->opcode = header[0] & FRAME_OPCODE;
+    control = (0u != (ws->opcode & 0x08u));
+
+    if (FRAME_LENGTH_16 == length)
+    {
+        length = ((uint32_t)header[2] << 8) | header[3];
+    }
+    else if (FRAME_LENGTH_64 == length)
+    {
+        if ((0u != header[2]) || (0u != header[3]) || (0u != header[4]) || (0u != header[5]))
+        {
+            fail_connection(ws, WEBSOCKET_CLOSE_TOO_BIG);
+            return false;
+        }
+        length = ((uint32_t)header[6] << 24) | ((uint32_t)header[7] << 16) | ((uint32_t)header[8] << 8) | header[9];
+    }
+
+    /* No extensions are negotiated, and frames from the server are not masked. */
+    if ((0u != (header[0] & FRAME_RSV)) || (0u != (header[1] & FRAME_MASK)))
+    {
+        fail_connection(ws, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+
+    if (control)
+    {
+        if (!ws->fin || (length > MAX_CONTROL_PAYLOAD) || (ws->opcode > WEBSOCKET_OPCODE_PONG))
+        {
+            fail_connection(ws, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+        ws->control_length = 0;
+    }
+    else if (WEBSOCKET_OPCODE_CONTINUATION == ws->opcode)
+    {
+        if (!ws->in_message)
+        {
+            fail_connection(ws, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+    }
+    else if ((WEBSOCKET_OPCODE_TEXT == ws->opcode) || (WEBSOCKET_OPCODE_BINARY == ws->opcode))
+    {
+        if (ws->in_message)
+        {
+            fail_connection(ws, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+        ws->in_message = true;
+        ws->message_opcode = ws->opcode;
+        ws->message_offset = 0;
+    }
+    else
+    {
+        fail_connection(ws, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+
+    ws->frame_length = length;
+    ws->remaining = length;
+    ws->in_payload = true;
+    ws->stats.frames_received++;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: deliver_payload
+ *******************************************************************************
+ * Summary:
+ *  Passes payload bytes of a data frame to the callback, or collects the
+ *  payload of a control frame.
+ *
+ *******************************************************************************/
+static void deliver_payload(websocket_t *ws, const uint8_t *data, uint32_t length)
+{
+    websocket_event_t event;
+
+    if (0u != (ws->opcode & 0x08u))
+    {
+        memcpy(&ws->control[ws->control_length], data, length);
+        ws->control_length += length;
+        return;
+    }
+
+    event.opcode = (websocket_opcode_t)ws->message_opcode;
+    event.data = data;
+    event.length = length;
+    event.offset = ws->message_offset;
+    event.final = ws->fin && (length == ws->remaining);
+
+    ws->message_offset += length;
+
+    if (NULL != ws->callback)
+    {
+        ws->callback(ws, &event, ws->callback_arg);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: complete_frame
+ *******************************************************************************
+ * Summary:
+ *  Ends the current frame. Pings are answered with a pong carrying the same
+ *  payload, pongs end the keepalive wait, and a close frame is echoed before
+ *  the connection is closed.
+ *
+ * Return:
+ *  bool: false if the connection was failed.
+ *
+ *******************************************************************************/
+static bool complete_frame(websocket_t *ws)
+{
+    websocket_event_t event;
+    uint16_t code = WEBSOCKET_CLOSE_NORMAL;
+
+    ws->in_payload = false;
+    ws->header_length = 0;
+    ws->header_needed = 2u;
+
+    switch (ws->opcode)
+    {
+        case WEBSOCKET_OPCODE_PING:
+            (void)send_frame(ws, WEBSOCKET_OPCODE_PONG, true, ws->control, ws->control_length);
+            break;
+
+        case WEBSOCKET_OPCODE_PONG:
+            if (ws->ping_outstanding)
+            {
+                ws->ping_outstanding = false;
+                ws->stats.pongs_received++;
+                ws->stats.ping_rtt_ms = (uint32_t)(xTaskGetTickCount() - ws->ping_ticks) * portTICK_PERIOD_MS;
+            }
+            break;
+
+        case WEBSOCKET_OPCODE_CLOSE:
+            if (ws->control_length >= 2u)
+            {
+                code = (uint16_t)(((uint16_t)ws->control[0] << 8) | ws->control[1]);
+            }
+            APP_INFO(("The server closed the WebSocket with code %u\n", code));
+            (void)send_frame(ws, WEBSOCKET_OPCODE_CLOSE, true, ws->control, (ws->control_length >= 2u) ? 2u : 0u);
+            ws->open = false;
+            tls_stream_close(&ws->stream);
+            break;
+
+        default:
+            /* An empty final frame still has to end the message. */
+            if (ws->fin && (0u == ws->frame_length) && (NULL != ws->callback))
+            {
+                event.opcode = (websocket_opcode_t)ws->message_opcode;
+                event.data = NULL;
+                event.length = 0;
+                event.offset = ws->message_offset;
+                event.final = true;
+                ws->callback(ws, &event, ws->callback_arg);
+            }
+            if (ws->fin)
+            {
+                ws->in_message = false;
+            }
+            break;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: fail_connection
+ *******************************************************************************
+ * Summary:
+ *  Closes the connection after a protocol error, telling the server why.
+ *
+ *******************************************************************************/
+static void fail_connection(websocket_t *ws, uint16_t code)
+{
+    uint8_t payload[2];
+
+    ERR_INFO(("WebSocket protocol error, closing with code %u.\n", code));
+
+    payload[0] = (uint8_t)(code >> 8);
+    payload[1] = (uint8_t)code;
+    (void)send_frame(ws, WEBSOCKET_OPCODE_CLOSE, true, payload, sizeof(payload));
+
+    ws->open = false;
+    tls_stream_close(&ws->stream);
+}
+
+/*******************************************************************************
+ * Function Name: check_keepalive
+ *******************************************************************************
+ * Summary:
+ *  Sends a ping when nothing was received for WEBSOCKET_PING_INTERVAL_MS and
+ *  closes the connection when its pong is late.
+ *
+ *******************************************************************************/
+static cy_rslt_t check_keepalive(websocket_t *ws)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint8_t payload[4];
+
+    if (ws->ping_outstanding)
+    {
+        if ((uint32_t)(now - ws->ping_ticks) * portTICK_PERIOD_MS >= WEBSOCKET_PONG_TIMEOUT_MS)
+        {
+            ERR_INFO(("No pong within %u ms, closing the WebSocket.\n", (unsigned int)WEBSOCKET_PONG_TIMEOUT_MS));
+            ws->open = false;
+            tls_stream_close(&ws->stream);
+            return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+        }
+    }
+    else if ((uint32_t)(now - ws->last_rx_ticks) * portTICK_PERIOD_MS >= WEBSOCKET_PING_INTERVAL_MS)
+    {
+        payload[0] = (uint8_t)(now >> 24);
+        payload[1] = (uint8_t)(now >> 16);
+        payload[2] = (uint8_t)(now >> 8);
+        payload[3] = (uint8_t)now;
+
+        ws->ping_outstanding = true;
+        ws->ping_ticks = now;
+        ws->stats.pings_sent++;
+
+        return send_frame(ws, WEBSOCKET_OPCODE_PING, true, payload, sizeof(payload));
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: seed_random
+ *******************************************************************************
+ * Summary:
+ *  Seeds the DRBG of the masking keys and the handshake key from the
+ *  entropy sources of mbedtls, which include the TRNG.
+ *
+ *******************************************************************************/
+static cy_rslt_t seed_random(websocket_t *ws)
+{
+    int ret;
+
+    mbedtls_ctr_drbg_init(&ws->drbg);
+    mbedtls_entropy_init(&ws->entropy);
+
+    ret = mbedtls_ctr_drbg_seed(&ws->drbg, mbedtls_entropy_func, &ws->entropy,
+                                (const unsigned char *)WEBSOCKET_DRBG_PERSONALIZATION,
+                                sizeof(WEBSOCKET_DRBG_PERSONALIZATION) - 1u);
+    if (0 != ret)
+    {
+        ERR_INFO(("Failed to seed the WebSocket DRBG: -0x%04x\n", (unsigned int)-ret));
+        free_random(ws);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: free_random
+ *******************************************************************************
+ * Summary:
+ *  Frees the DRBG seeded by seed_random().
+ *
+ *******************************************************************************/
+static void free_random(websocket_t *ws)
+{
+    mbedtls_ctr_drbg_free(&ws->drbg);
+    mbedtls_entropy_free(&ws->entropy);
+}
+
+/*******************************************************************************
+ * Function Name: demo_callback
+ *******************************************************************************
+ * Summary:
+ *  Collects the text messages of the demo. "echo <n>" ends an echo round
+ *  trip; any other message is a command and is acknowledged.
+ *
+ *******************************************************************************/
+static void demo_callback(websocket_t *ws, const websocket_event_t *event, void *arg)
+{
+    demo_state_t *state = (demo_state_t *)arg;
+    uint32_t copy;
+    char reply[DEMO_MESSAGE_SIZE + 8u];
+    int length;
+
+    if (0u == event->offset)
+    {
+        state->message_length = 0;
+    }
+
+    copy = DEMO_MESSAGE_SIZE - state->message_length;
+    copy = (event->length < copy) ? event->length : copy;
+    memcpy(&state->message[state->message_length], event->data, copy);
+    state->message_length += copy;
+
+    if (!event->final)
+    {
+        return;
+    }
+
+    state->message[state->message_length] = '\0';
+
+    if (0 == strncmp(state->message, "echo ", 5))
+    {
+        state->echoed_seq = strtoul(&state->message[5], NULL, 10);
+        state->echoed = true;
+        return;
+    }
+
+    state->commands++;
+    APP_INFO(("Command: %s\n", state->message));
+
+    length = snprintf(reply, sizeof(reply), "ack %s", state->message);
+    if (length > 0)
+    {
+        (void)websocket_send(ws, WEBSOCKET_OPCODE_TEXT, (const uint8_t *)reply,
+                             ((uint32_t)length < sizeof(reply)) ? (uint32_t)length : (sizeof(reply) - 1u));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: demo_poll_callback
+ *******************************************************************************
+ * Summary:
+ *  Counts the body bytes of the polling requests.
+ *
+ *******************************************************************************/
+static void demo_poll_callback(const http_pipeline_event_t *event, void *arg)
+{
+    *(uint32_t *)arg += event->length;
+}
+
+/* [] END OF FILE */
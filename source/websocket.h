@@ -0,0 +1,191 @@
+/******************************************************************************
+* File Name: websocket.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the WebSocket client (RFC 6455).
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WEBSOCKET_H_
+#define WEBSOCKET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "FreeRTOS.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "tls_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Resource upgraded to a WebSocket by the "WebSocket" menu option. */
+#define WEBSOCKET_PATH                           "/ws"
+
+/* Receive buffer. Incoming payloads are passed to the callback straight from
+ * this buffer, so it bounds the size of each part of a message, not the size
+ * of a message.
+ */
+#define WEBSOCKET_RX_BUFFER_SIZE                 (1024)
+
+/* Transmit buffer. Payloads are masked into it and sent one buffer at a
+ * time.
+ */
+#define WEBSOCKET_TX_BUFFER_SIZE                 (512)
+
+/* Messages longer than this are sent as several frames. */
+#define WEBSOCKET_FRAGMENT_SIZE                  (1024)
+
+/* A ping is sent when nothing has been received for this long. The
+ * connection is closed when the pong does not arrive in time.
+ */
+#define WEBSOCKET_PING_INTERVAL_MS               (30000u)
+#define WEBSOCKET_PONG_TIMEOUT_MS                (10000u)
+
+/* Close status codes (RFC 6455, 7.4.1). */
+#define WEBSOCKET_CLOSE_NORMAL                   (1000u)
+#define WEBSOCKET_CLOSE_PROTOCOL_ERROR           (1002u)
+#define WEBSOCKET_CLOSE_TOO_BIG                  (1009u)
+
+/* "WebSocket" menu option: echo round trips, the polling interval it is
+ * compared with, and the time spent idle on the connection.
+ */
+#define WEBSOCKET_DEMO_ECHOES                    (20)
+#define WEBSOCKET_DEMO_POLL_INTERVAL_MS          (5000u)
+#define WEBSOCKET_DEMO_IDLE_MS                   (65000u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    WEBSOCKET_OPCODE_CONTINUATION = 0x0,
+    WEBSOCKET_OPCODE_TEXT = 0x1,
+    WEBSOCKET_OPCODE_BINARY = 0x2,
+    WEBSOCKET_OPCODE_CLOSE = 0x8,
+    WEBSOCKET_OPCODE_PING = 0x9,
+    WEBSOCKET_OPCODE_PONG = 0xA,
+} websocket_opcode_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Part of a received message. data points into the receive buffer and is
+ * valid only during the callback. A message arrives in one or more parts, in
+ * order; the last one has final set.
+ */
+typedef struct
+{
+    websocket_opcode_t opcode;   /* WEBSOCKET_OPCODE_TEXT or WEBSOCKET_OPCODE_BINARY. */
+    const uint8_t *data;
+    uint32_t length;
+    uint32_t offset;             /* Offset of data in the message. */
+    bool final;
+} websocket_event_t;
+
+struct websocket;
+typedef void (*websocket_cb_t)(struct websocket *ws, const websocket_event_t *event, void *arg);
+
+/* Counters of a connection. Bytes include the frame headers. */
+typedef struct
+{
+    uint32_t frames_sent;
+    uint32_t frames_received;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t pings_sent;
+    uint32_t pongs_received;
+    uint32_t ping_rtt_ms;        /* Round trip of the last ping. */
+} websocket_stats_t;
+
+typedef struct websocket
+{
+    tls_stream_t stream;
+    bool open;
+    websocket_cb_t callback;
+    void *callback_arg;
+    uint32_t timeout_ms;
+
+    /* Frame being received. */
+    uint8_t header[14];
+    uint32_t header_length;
+    uint32_t header_needed;
+    bool in_payload;
+    bool fin;
+    uint8_t opcode;
+    uint32_t frame_length;
+    uint32_t remaining;
+
+    /* Message being received. */
+    bool in_message;
+    uint8_t message_opcode;
+    uint32_t message_offset;
+
+    /* Payload of the control frame being received. */
+    uint8_t control[125];
+    uint32_t control_length;
+
+    /* Keepalive. */
+    TickType_t last_rx_ticks;
+    TickType_t ping_ticks;
+    bool ping_outstanding;
+
+    /* Source of the handshake key and the frame masks. */
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_entropy_context entropy;
+    websocket_stats_t stats;
+
+    uint8_t rx_buffer[WEBSOCKET_RX_BUFFER_SIZE];
+    uint8_t tx_buffer[WEBSOCKET_TX_BUFFER_SIZE];
+} websocket_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t websocket_connect(websocket_t *ws, const char *path, websocket_cb_t callback, void *arg);
+cy_rslt_t websocket_send(websocket_t *ws, websocket_opcode_t opcode, const uint8_t *data, uint32_t length);
+cy_rslt_t websocket_poll(websocket_t *ws, uint32_t timeout_ms);
+void websocket_close(websocket_t *ws, uint16_t code);
+void websocket_demo(void);
+
+#endif /* WEBSOCKET_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,509 @@
+/******************************************************************************
+* File Name: wifi_power.c
+*
+* Description: This file contains the Wi-Fi power-save policy. The request
+* functions of the application mark the start and the end of each transfer.
+* The radio leaves power save at the start of the first, and a task puts it
+* back WIFI_POWER_IDLE_HYSTERESIS_MS after the end of the last.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Wi-Fi connection manager and WHD header files */
+#include "cy_wcm.h"
+#include "whd_wifi_api.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "wifi_power.h"
+#include "wlan_offload.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TICKS_TO_MS(ticks)               ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static TaskHandle_t wifi_power_task_handle;
+
+/* Protects the state below. Held while the mode is changed, so that a
+ * transfer starts only once the radio is awake.
+ */
+static SemaphoreHandle_t power_mutex;
+
+static wifi_power_policy_t policy = WIFI_POWER_POLICY_ADAPTIVE;
+static bool radio_active = true;
+static uint32_t transfers;
+static TickType_t last_end_ticks;
+
+/* Statistics, with the time of the current mode counted from mode_ticks. */
+static wifi_power_stats_t power_stats;
+static TickType_t mode_ticks;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void wifi_power_task(void *arg);
+static void set_radio_active(bool active);
+static void account_mode_time(void);
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+
+/*******************************************************************************
+ * Function Name: wifi_power_init
+ *******************************************************************************
+ * Summary:
+ *  Creates the power-save task and puts the radio in power save. Called once
+ *  the device has joined the AP.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the policy is running, otherwise,
+ *  it returns CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t wifi_power_init(void)
+{
+    if (NULL != wifi_power_task_handle)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    power_mutex = xSemaphoreCreateMutex();
+    if (NULL == power_mutex)
+    {
+        ERR_INFO(("Failed to create the Wi-Fi power mutex.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mode_ticks = xTaskGetTickCount();
+    last_end_ticks = mode_ticks;
+
+    if (pdPASS != xTaskCreate(wifi_power_task, "Wi-Fi Power", WIFI_POWER_TASK_STACK_SIZE, NULL,
+                              WIFI_POWER_TASK_PRIORITY, &wifi_power_task_handle))
+    {
+        ERR_INFO(("Failed to create the Wi-Fi power task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_set_policy
+ *******************************************************************************
+ * Summary:
+ *  Selects the policy and applies it at once, unless a transfer is running.
+ *
+ * Parameters:
+ *  new_policy - Policy to apply.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_set_policy(wifi_power_policy_t new_policy)
+{
+    if (NULL == wifi_power_task_handle)
+    {
+        return;
+    }
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    policy = new_policy;
+    if (0u == transfers)
+    {
+        set_radio_active(WIFI_POWER_POLICY_ALWAYS_ACTIVE == policy);
+    }
+    last_end_ticks = xTaskGetTickCount();
+    xSemaphoreGive(power_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_begin
+ *******************************************************************************
+ * Summary:
+ *  Marks the start of a transfer and wakes the radio unless it is already
+ *  awake. Each call is paired with a call to wifi_power_end(). Safe to call
+ *  from any task, and a no-op before wifi_power_init().
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_begin(void)
+{
+    if (NULL == wifi_power_task_handle)
+    {
+        return;
+    }
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    transfers++;
+    if (WIFI_POWER_POLICY_ALWAYS_SAVE != policy)
+    {
+        set_radio_active(true);
+    }
+    xSemaphoreGive(power_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_end
+ *******************************************************************************
+ * Summary:
+ *  Marks the end of a transfer. The radio returns to power save after
+ *  WIFI_POWER_IDLE_HYSTERESIS_MS without transfers.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_end(void)
+{
+    if (NULL == wifi_power_task_handle)
+    {
+        return;
+    }
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    if (transfers > 0u)
+    {
+        transfers--;
+    }
+    last_end_ticks = xTaskGetTickCount();
+    xSemaphoreGive(power_mutex);
+
+    xTaskNotifyGive(wifi_power_task_handle);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns the time spent in each mode and the energy of the radio estimated
+ *  from it.
+ *
+ * Parameters:
+ *  stats - Filled with the statistics.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_get_stats(wifi_power_stats_t *stats)
+{
+    if (NULL == wifi_power_task_handle)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    account_mode_time();
+    *stats = power_stats;
+    xSemaphoreGive(power_mutex);
+
+    stats->energy_uj = (uint32_t)((((uint64_t)stats->active_ms * WIFI_POWER_ACTIVE_CURRENT_UA) +
+                                   ((uint64_t)stats->save_ms * WIFI_POWER_SAVE_CURRENT_UA)) *
+                                  WIFI_POWER_SUPPLY_MV / 1000000u);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_reset_stats
+ *******************************************************************************
+ * Summary:
+ *  Clears the statistics.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_reset_stats(void)
+{
+    if (NULL == wifi_power_task_handle)
+    {
+        return;
+    }
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    memset(&power_stats, 0, sizeof(power_stats));
+    mode_ticks = xTaskGetTickCount();
+    xSemaphoreGive(power_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Sends WIFI_POWER_BENCH_BURSTS bursts of WIFI_POWER_BENCH_REQUESTS GET
+ *  requests, WIFI_POWER_BENCH_GAP_MS apart, under each policy, and prints
+ *  the mean and the worst request latency, the time in each mode, and the
+ *  energy of the radio from the model.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wifi_power_benchmark(void)
+{
+    static const wifi_power_policy_t policies[] =
+    {
+        WIFI_POWER_POLICY_ALWAYS_SAVE, WIFI_POWER_POLICY_ALWAYS_ACTIVE, WIFI_POWER_POLICY_ADAPTIVE
+    };
+    static const char *const names[] = { "always save", "always active", "adaptive" };
+    https_request_t request = {0};
+    wifi_power_stats_t stats;
+    TickType_t start_ticks;
+    uint32_t latency_ms;
+    uint32_t total_ms;
+    uint32_t max_ms;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (NULL == wifi_power_task_handle)
+    {
+        ERR_INFO(("The Wi-Fi power policy is not running.\n"));
+        return;
+    }
+
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.path = WIFI_POWER_BENCH_PATH;
+    request.response_cb = ignore_response;
+    request.quiet = true;
+
+    /* The first request opens the connection and is not measured. */
+    (void)https_send_request(&request);
+
+    APP_INFO(("%u bursts of %u requests, %u ms apart, per policy\n", WIFI_POWER_BENCH_BURSTS,
+              WIFI_POWER_BENCH_REQUESTS, WIFI_POWER_BENCH_GAP_MS));
+    printf("\n  %-14s %8s %8s %10s %9s %8s %9s\n", "policy", "mean ms", "max ms", "active ms", "save ms",
+           "switches", "energy mJ");
+
+    for (uint32_t p = 0; p < (sizeof(policies) / sizeof(policies[0])); p++)
+    {
+        wifi_power_set_policy(policies[p]);
+        vTaskDelay(pdMS_TO_TICKS(WIFI_POWER_BENCH_GAP_MS));
+        wifi_power_reset_stats();
+        total_ms = 0;
+        max_ms = 0;
+
+        for (uint32_t burst = 0; (CY_RSLT_SUCCESS == result) && (burst < WIFI_POWER_BENCH_BURSTS); burst++)
+        {
+            for (uint32_t i = 0; (CY_RSLT_SUCCESS == result) && (i < WIFI_POWER_BENCH_REQUESTS); i++)
+            {
+                start_ticks = xTaskGetTickCount();
+                result = https_send_request(&request);
+                latency_ms = TICKS_TO_MS(xTaskGetTickCount() - start_ticks);
+                total_ms += latency_ms;
+                max_ms = (latency_ms > max_ms) ? latency_ms : max_ms;
+            }
+
+            vTaskDelay(pdMS_TO_TICKS(WIFI_POWER_BENCH_GAP_MS));
+        }
+
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("The GET failed: 0x%08lx\n", (unsigned long)result));
+            break;
+        }
+
+        wifi_power_get_stats(&stats);
+        printf("  %-14s %8lu %8lu %10lu %9lu %8lu %5lu.%03lu\n", names[p],
+               (unsigned long)(total_ms / (WIFI_POWER_BENCH_BURSTS * WIFI_POWER_BENCH_REQUESTS)),
+               (unsigned long)max_ms, (unsigned long)stats.active_ms, (unsigned long)stats.save_ms,
+               (unsigned long)stats.switches, (unsigned long)(stats.energy_uj / 1000u),
+               (unsigned long)(stats.energy_uj % 1000u));
+    }
+
+    wifi_power_set_policy(WIFI_POWER_POLICY_ADAPTIVE);
+}
+
+/*******************************************************************************
+ * Function Name: wifi_power_task
+ *******************************************************************************
+ * Summary:
+ *  Puts the radio in power save once no transfer has run for
+ *  WIFI_POWER_IDLE_HYSTERESIS_MS. Woken by wifi_power_end().
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void wifi_power_task(void *arg)
+{
+    TickType_t wait = 0;
+    uint32_t idle_ms;
+
+    (void)arg;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, wait);
+
+        xSemaphoreTake(power_mutex, portMAX_DELAY);
+        wait = portMAX_DELAY;
+        if ((WIFI_POWER_POLICY_ALWAYS_ACTIVE != policy) && (0u == transfers) && radio_active)
+        {
+            idle_ms = TICKS_TO_MS(xTaskGetTickCount() - last_end_ticks);
+            if (idle_ms >= WIFI_POWER_IDLE_HYSTERESIS_MS)
+            {
+                set_radio_active(false);
+            }
+
+            /* Check again later if the switch failed, for example while
+             * the device is not joined to the AP.
+             */
+            if (radio_active)
+            {
+                wait = pdMS_TO_TICKS((idle_ms >= WIFI_POWER_IDLE_HYSTERESIS_MS) ?
+                                     WIFI_POWER_IDLE_HYSTERESIS_MS : (WIFI_POWER_IDLE_HYSTERESIS_MS - idle_ms));
+            }
+        }
+        xSemaphoreGive(power_mutex);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: set_radio_active
+ *******************************************************************************
+ * Summary:
+ *  Switches the radio to WIFI_POWER_ACTIVE_MODE or to WIFI_POWER_SAVE_MODE
+ *  with the long listen interval, and hands the idle connections to the
+ *  WLAN offloads for the time in power save. The mode is left as it is if
+ *  the switch fails. Called with the power mutex held.
+ *
+ *******************************************************************************/
+static void set_radio_active(bool active)
+{
+    whd_interface_t interface = NULL;
+
+    if (active == radio_active)
+    {
+        return;
+    }
+
+    if (!active)
+    {
+        wlan_offload_suspend();
+
+        if (CY_RSLT_SUCCESS == cy_wcm_get_whd_interface(CY_WCM_INTERFACE_TYPE_STA, &interface))
+        {
+            (void)whd_wifi_set_listen_interval(interface, WIFI_POWER_LISTEN_INTERVAL,
+                                               WHD_LISTEN_INTERVAL_TIME_UNIT_BEACON);
+        }
+    }
+
+    if (CY_RSLT_SUCCESS != cy_wcm_allow_low_power_mode(active ? WIFI_POWER_ACTIVE_MODE : WIFI_POWER_SAVE_MODE))
+    {
+        if (!active)
+        {
+            wlan_offload_resume();
+        }
+        return;
+    }
+
+    if (active)
+    {
+        wlan_offload_resume();
+    }
+
+    account_mode_time();
+    radio_active = active;
+    power_stats.switches++;
+}
+
+/*******************************************************************************
+ * Function Name: account_mode_time
+ *******************************************************************************
+ * Summary:
+ *  Adds the time since mode_ticks to the current mode. Called with the
+ *  power mutex held.
+ *
+ *******************************************************************************/
+static void account_mode_time(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (radio_active)
+    {
+        power_stats.active_ms += TICKS_TO_MS(now - mode_ticks);
+    }
+    else
+    {
+        power_stats.save_ms += TICKS_TO_MS(now - mode_ticks);
+    }
+    mode_ticks = now;
+}
+
+/*******************************************************************************
+ * Function Name: ignore_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the benchmark requests.
+ *
+ *******************************************************************************/
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,131 @@
+/******************************************************************************
+* File Name: wifi_power.h
+*
+* Description: This file contains the macros, enumerations, structures, and
+* function prototypes of the Wi-Fi power-save policy, which keeps the radio
+* awake during transfers and in deep power save between them.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WIFI_POWER_H_
+#define WIFI_POWER_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+#include "cy_wcm.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Mode during transfers. Without power save, a response is received as soon
+ * as the AP sends it instead of after the next beacon.
+ */
+#define WIFI_POWER_ACTIVE_MODE                   CY_WCM_NO_POWERSAVE_MODE
+
+/* Mode between transfers: PS-Poll, waking for every
+ * WIFI_POWER_LISTEN_INTERVAL beacons. Frames that arrive meanwhile, such as
+ * ARP requests, wait at the AP up to that long.
+ */
+#define WIFI_POWER_SAVE_MODE                     CY_WCM_PM1
+#define WIFI_POWER_LISTEN_INTERVAL               (10u)
+
+/* Idle time after the last transfer before the radio returns to power save.
+ * Requests that follow each other closer than this stay in the active mode.
+ */
+#define WIFI_POWER_IDLE_HYSTERESIS_MS            (500u)
+
+/* Power-save task parameters. */
+#define WIFI_POWER_TASK_STACK_SIZE               (1024)
+#define WIFI_POWER_TASK_PRIORITY                 (1)
+
+/* Energy model: average current of the radio in each mode and the supply
+ * voltage. Set them from a measurement of the board; the power-save figure
+ * depends on the beacon interval of the AP and on the listen interval.
+ */
+#define WIFI_POWER_ACTIVE_CURRENT_UA             (20000u)
+#define WIFI_POWER_SAVE_CURRENT_UA               (250u)
+#define WIFI_POWER_SUPPLY_MV                     (3300u)
+
+/* "Wi-Fi power save" menu option: bursts of GET requests separated by idle
+ * gaps, sent under each policy.
+ */
+#define WIFI_POWER_BENCH_PATH                    "/"
+#define WIFI_POWER_BENCH_BURSTS                  (4u)
+#define WIFI_POWER_BENCH_REQUESTS                (5u)
+#define WIFI_POWER_BENCH_GAP_MS                  (3000u)
+
+/*******************************************************************************
+* Enumerations
+*******************************************************************************/
+typedef enum
+{
+    WIFI_POWER_POLICY_ADAPTIVE = 0,  /* Active during transfers, power save when idle. */
+    WIFI_POWER_POLICY_ALWAYS_ACTIVE,
+    WIFI_POWER_POLICY_ALWAYS_SAVE,
+} wifi_power_policy_t;
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Time in each mode since the last wifi_power_reset_stats(). Times are in
+ * milliseconds.
+ */
+typedef struct
+{
+    uint32_t active_ms;
+    uint32_t save_ms;
+    uint32_t switches;           /* Mode changes. */
+    uint32_t energy_uj;          /* Radio energy from the model, in microjoules. */
+} wifi_power_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t wifi_power_init(void);
+void wifi_power_set_policy(wifi_power_policy_t policy);
+void wifi_power_begin(void);
+void wifi_power_end(void);
+void wifi_power_get_stats(wifi_power_stats_t *stats);
+void wifi_power_reset_stats(void);
+void wifi_power_benchmark(void);
+
+#endif /* WIFI_POWER_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,882 @@
+/******************************************************************************
+* File Name: wlan_offload.c
+*
+* Description: This file contains the WLAN offloads. While the radio is in
+* power save, the firmware answers ARP (and IPv6 neighbor solicitations),
+* sends the TCP keepalives of the idle connections to the HTTPS server, and
+* drops the frames that are not for them, so the host is not woken.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Wi-Fi connection manager and WHD header files */
+#include "cy_wcm.h"
+#include "whd_wifi_api.h"
+#include "whd_wlioctl.h"
+
+/* lwIP header files */
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "lwip/stats.h"
+#include "lwip/priv/tcp_priv.h"
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+
+#include "secure_http_client.h"
+#include "wifi_power.h"
+#include "wlan_offload.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define IPV4_HEADER_LEN                  (20u)
+#define TCP_HEADER_LEN                   (20u)
+#define KEEPALIVE_PACKET_LEN             (IPV4_HEADER_LEN + TCP_HEADER_LEN)
+#define TCP_FLAG_ACK                     (0x10u)
+
+/* Offsets in an Ethernet frame carrying IPv4 without options. */
+#define FRAME_ETHERTYPE_OFFSET           (12u)
+#define FRAME_IP_PROTOCOL_OFFSET         (23u)
+#define FRAME_SOURCE_PORT_OFFSET         (34u)
+#define FRAME_DEST_PORT_OFFSET           (36u)
+#define FRAME_FILTER_LEN                 (FRAME_DEST_PORT_OFFSET + 2u - FRAME_ETHERTYPE_OFFSET)
+
+#define IP_PROTOCOL_TCP                  (6u)
+#define IP_PROTOCOL_UDP                  (17u)
+#define DHCP_CLIENT_PORT                 (68u)
+
+#if LWIP_WND_SCALE
+#define SND_WINDOW(pcb)                  ((uint16_t)((pcb)->snd_wnd >> (pcb)->snd_scale))
+#else
+#define SND_WINDOW(pcb)                  ((uint16_t)(pcb)->snd_wnd)
+#endif
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* State of an idle connection, read from lwIP. Addresses are in network
+ * order, as lwIP keeps them.
+ */
+typedef struct
+{
+    uint32_t local_ip;
+    uint32_t remote_ip;
+    uint16_t local_port;
+    uint16_t remote_port;
+    uint32_t snd_nxt;
+    uint32_t rcv_nxt;
+    uint16_t rcv_wnd;
+    uint16_t snd_wnd;
+} tcp_connection_t;
+
+/* Frames forwarded by one packet filter: IPv4 frames of a protocol with a
+ * port at port_offset in the frame.
+ */
+typedef struct
+{
+    uint8_t protocol;
+    uint16_t port_offset;
+    uint16_t port;
+} port_filter_t;
+
+/* Run by tcpip_api_call() in the lwIP thread. */
+typedef struct
+{
+    struct tcpip_api_call_data call;
+    uint32_t count;
+    tcp_connection_t connections[WLAN_OFFLOAD_MAX_CONNECTIONS];
+    uint32_t filter_count;
+    port_filter_t filters[WLAN_OFFLOAD_MAX_FILTERS];
+} connection_snapshot_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static whd_interface_t wlan_interface;
+static bool offload_enabled = true;
+static bool suspended;
+static uint8_t max_connections;
+static uint32_t offloaded_connections;
+static uint32_t installed_filters;
+
+static wlan_offload_stats_t offload_stats;
+static uint32_t host_frames_base;
+
+/* Request of the "tko" connect subcommand: the header, the connection, the
+ * two addresses, and the keepalive and its expected reply.
+ */
+static uint32_t tko_buffer[(sizeof(wl_tko_t) + sizeof(wl_tko_connect_t) + (2 * sizeof(uint32_t)) +
+                            (2 * KEEPALIVE_PACKET_LEN) + 3u) / 4u];
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void configure_arp(void);
+static void install_filters(const connection_snapshot_t *snapshot);
+static void remove_filters(void);
+static void add_filter(uint8_t id, const port_filter_t *port_filter);
+static void add_port_filter(connection_snapshot_t *snapshot, uint8_t protocol, uint16_t port_offset, uint16_t port);
+static void read_filter_stats(wlan_offload_stats_t *stats);
+static cy_rslt_t offload_keepalive(uint8_t index, const tcp_connection_t *connection);
+static void build_segment(uint8_t *packet, uint32_t source_ip, uint32_t dest_ip, uint16_t source_port,
+                          uint16_t dest_port, uint32_t seq, uint32_t ack, uint16_t window);
+static uint32_t checksum_add(uint32_t sum, const uint8_t *data, uint32_t length);
+static uint16_t checksum_fold(uint32_t sum);
+static err_t snapshot_connections(struct tcpip_api_call_data *call);
+static uint32_t host_frames(void);
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg);
+
+/*******************************************************************************
+ * Function Name: wlan_offload_init
+ *******************************************************************************
+ * Summary:
+ *  Enables ARP offload and checks for TCP keepalive offload. The packet
+ *  filters are installed when the host sleeps. Called once the device has
+ *  joined the AP, before the Wi-Fi power policy starts.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the offloads are configured,
+ *  otherwise, it returns a WCM error code or CY_RSLT_TYPE_ERROR.
+ *
+ *******************************************************************************/
+cy_rslt_t wlan_offload_init(void)
+{
+    whd_tko_retry_t retry;
+    cy_rslt_t result;
+
+    if (NULL != wlan_interface)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = cy_wcm_get_whd_interface(CY_WCM_INTERFACE_TYPE_STA, &wlan_interface);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to get the WLAN interface.\n"));
+        return result;
+    }
+
+    configure_arp();
+
+    /* Firmware without TCP keepalive offload still runs the other offloads. */
+    retry.tko_interval = WLAN_OFFLOAD_KEEPALIVE_INTERVAL_S;
+    retry.tko_retry_count = WLAN_OFFLOAD_KEEPALIVE_RETRY_COUNT;
+    retry.tko_retry_interval = WLAN_OFFLOAD_KEEPALIVE_RETRY_INTERVAL_S;
+    if ((WHD_SUCCESS != whd_tko_max_assoc(wlan_interface, &max_connections)) ||
+        (WHD_SUCCESS != whd_tko_param(wlan_interface, &retry, 1)))
+    {
+        APP_INFO(("The Wi-Fi firmware has no TCP keepalive offload.\n"));
+        max_connections = 0;
+    }
+    max_connections = (max_connections < WLAN_OFFLOAD_MAX_CONNECTIONS) ? max_connections : WLAN_OFFLOAD_MAX_CONNECTIONS;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_set_enabled
+ *******************************************************************************
+ * Summary:
+ *  Turns the offloads on or off from the next suspend.
+ *
+ * Parameters:
+ *  enabled - true to apply the offloads while the host sleeps.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_set_enabled(bool enabled)
+{
+    offload_enabled = enabled;
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_suspend
+ *******************************************************************************
+ * Summary:
+ *  Hands the idle connections to the HTTPS server to the firmware and
+ *  installs the packet filters of the open sockets. Called by the Wi-Fi
+ *  power policy before the radio enters power save. A connection with data
+ *  in flight is left to the host.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_suspend(void)
+{
+    connection_snapshot_t snapshot;
+
+    if ((NULL == wlan_interface) || suspended)
+    {
+        return;
+    }
+
+    /* The address may have changed since the last suspend. */
+    configure_arp();
+
+    suspended = true;
+    offload_stats.suspends++;
+
+    if (!offload_enabled)
+    {
+        return;
+    }
+
+    offloaded_connections = 0;
+    snapshot.count = 0;
+    snapshot.filter_count = 0;
+
+    /* DHCP replies are forwarded even before the client has a socket. */
+    add_port_filter(&snapshot, IP_PROTOCOL_UDP, FRAME_DEST_PORT_OFFSET, DHCP_CLIENT_PORT);
+
+    if (ERR_OK != tcpip_api_call(snapshot_connections, &snapshot.call))
+    {
+        snapshot.count = 0;
+    }
+
+    for (uint32_t i = 0; i < snapshot.count; i++)
+    {
+        if (CY_RSLT_SUCCESS == offload_keepalive((uint8_t)offloaded_connections, &snapshot.connections[i]))
+        {
+            offloaded_connections++;
+        }
+    }
+
+    if ((offloaded_connections > 0u) && (WHD_SUCCESS != whd_tko_toggle(wlan_interface, WHD_TRUE)))
+    {
+        offloaded_connections = 0;
+    }
+    offload_stats.keepalives += offloaded_connections;
+
+    install_filters(&snapshot);
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_resume
+ *******************************************************************************
+ * Summary:
+ *  Takes the connections back from the firmware and removes the packet
+ *  filters. Called by the Wi-Fi power policy when the radio leaves power
+ *  save. A connection reported lost fails on its next request, which
+ *  reconnects.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_resume(void)
+{
+    uint32_t status_buffer[(sizeof(wl_tko_status_t) + WLAN_OFFLOAD_MAX_CONNECTIONS + 3u) / 4u];
+    wl_tko_status_t *status = (wl_tko_status_t *)status_buffer;
+
+    if ((NULL == wlan_interface) || !suspended)
+    {
+        return;
+    }
+
+    suspended = false;
+
+    if (offloaded_connections > 0u)
+    {
+        memset(status_buffer, 0, sizeof(status_buffer));
+        if (WHD_SUCCESS == whd_tko_get_status(wlan_interface, status))
+        {
+            for (uint32_t i = 0; (i < status->count) && (i < offloaded_connections); i++)
+            {
+                if (TKO_STATUS_NORMAL != status->status[i])
+                {
+                    offload_stats.keepalives_lost++;
+                }
+            }
+        }
+
+        (void)whd_tko_toggle(wlan_interface, WHD_FALSE);
+        offloaded_connections = 0;
+    }
+
+    remove_filters();
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Returns the counters of the host and those kept by the firmware.
+ *
+ * Parameters:
+ *  stats - Filled with the counters.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_get_stats(wlan_offload_stats_t *stats)
+{
+    whd_arp_stats_t arp_stats;
+
+    *stats = offload_stats;
+    stats->host_frames = host_frames() - host_frames_base;
+
+    if (NULL == wlan_interface)
+    {
+        return;
+    }
+
+    if (WHD_SUCCESS == whd_arp_stats_get(wlan_interface, &arp_stats))
+    {
+        stats->arp_replies = arp_stats.peer_service;
+    }
+
+    /* The counters of the filters removed so far are in offload_stats. */
+    read_filter_stats(stats);
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_reset_stats
+ *******************************************************************************
+ * Summary:
+ *  Clears the counters of the host and of the firmware.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_reset_stats(void)
+{
+    memset(&offload_stats, 0, sizeof(offload_stats));
+
+    /* The frame counter of lwIP is not cleared; its value now is the base. */
+    host_frames_base = host_frames();
+
+    if (NULL != wlan_interface)
+    {
+        (void)whd_arp_stats_clear(wlan_interface);
+        for (uint32_t i = 0; i < installed_filters; i++)
+        {
+            (void)whd_wifi_clear_packet_filter_stats(wlan_interface, (uint32_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i));
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: wlan_offload_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Sends a request, leaves the connection idle for WLAN_OFFLOAD_BENCH_IDLE_S
+ *  with the offloads off and then on, and sends a request again. Prints the
+ *  frames that woke the host per hour, the work done by the firmware, and
+ *  whether the second request had to reconnect.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void wlan_offload_benchmark(void)
+{
+    https_request_t request = {0};
+    wlan_offload_stats_t stats;
+    uint32_t connections;
+    cy_rslt_t result;
+
+    if (NULL == wlan_interface)
+    {
+        ERR_INFO(("The WLAN offloads are not configured.\n"));
+        return;
+    }
+
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.path = WLAN_OFFLOAD_BENCH_PATH;
+    request.response_cb = ignore_response;
+    request.quiet = true;
+
+#if !LINK_STATS
+    APP_INFO(("Built without WLAN_OFFLOAD_COUNT_FRAMES: host frames are not counted.\n"));
+#endif
+    APP_INFO(("%u s idle per run, %u keepalive connections in the firmware\n", WLAN_OFFLOAD_BENCH_IDLE_S,
+              max_connections));
+    printf("\n  %-9s %14s %9s %10s %10s %10s %9s\n", "offloads", "host frames/h", "ARP by FW", "keepalives",
+           "FW dropped", "forwarded", "reconnect");
+
+    for (uint32_t run = 0; run < 2u; run++)
+    {
+        wlan_offload_set_enabled(1u == run);
+
+        result = https_send_request(&request);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("The GET failed: 0x%08lx\n", (unsigned long)result));
+            break;
+        }
+
+        /* Let the radio enter power save before the idle time is counted. */
+        vTaskDelay(pdMS_TO_TICKS(2u * WIFI_POWER_IDLE_HYSTERESIS_MS));
+        wlan_offload_reset_stats();
+        connections = https_get_connection_count();
+
+        vTaskDelay(pdMS_TO_TICKS(WLAN_OFFLOAD_BENCH_IDLE_S * 1000u));
+        wlan_offload_get_stats(&stats);
+
+        result = https_send_request(&request);
+        printf("  %-9s %14lu %9lu %7lu/%-2lu %10lu %10lu %9s\n", (1u == run) ? "on" : "off",
+               (unsigned long)((stats.host_frames * 3600u) / WLAN_OFFLOAD_BENCH_IDLE_S),
+               (unsigned long)stats.arp_replies, (unsigned long)(stats.keepalives - stats.keepalives_lost),
+               (unsigned long)stats.keepalives, (unsigned long)stats.frames_dropped,
+               (unsigned long)stats.frames_forwarded,
+               (CY_RSLT_SUCCESS != result) ? "failed" :
+               ((connections == https_get_connection_count()) ? "no" : "yes"));
+    }
+
+    wlan_offload_set_enabled(true);
+}
+
+/*******************************************************************************
+ * Function Name: configure_arp
+ *******************************************************************************
+ * Summary:
+ *  Enables the ARP agent of the firmware with the current address of the
+ *  host, and IPv6 neighbor discovery offload with its link-local address.
+ *
+ *******************************************************************************/
+static void configure_arp(void)
+{
+    cy_wcm_ip_address_t address;
+
+    if (CY_RSLT_SUCCESS != cy_wcm_get_ip_addr(CY_WCM_INTERFACE_TYPE_STA, &address))
+    {
+        return;
+    }
+
+    (void)whd_arp_arpoe_set(wlan_interface, offload_enabled ? 1u : 0u);
+    (void)whd_arp_features_set(wlan_interface, ARP_OL_AGENT | ARP_OL_SNOOP | ARP_OL_HOST_AUTO_REPLY |
+                                               ARP_OL_PEER_AUTO_REPLY);
+    (void)whd_arp_peerage_set(wlan_interface, WLAN_OFFLOAD_ARP_PEER_AGE_S);
+    (void)whd_arp_hostip_list_clear(wlan_interface);
+    (void)whd_arp_hostip_list_add(wlan_interface, &address.ip.v4, 1);
+
+#if LWIP_IPV6
+    if (CY_RSLT_SUCCESS == cy_wcm_get_ipv6_addr(CY_WCM_INTERFACE_TYPE_STA, CY_WCM_IPV6_LINK_LOCAL, &address))
+    {
+        (void)whd_wifi_set_iovar_value(wlan_interface, "ndoe", offload_enabled ? 1u : 0u);
+        (void)whd_wifi_set_iovar_buffer(wlan_interface, "nd_hostip", address.ip.v6, sizeof(address.ip.v6));
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: install_filters
+ *******************************************************************************
+ * Summary:
+ *  Installs and enables a packet filter for each port of the snapshot.
+ *
+ *******************************************************************************/
+static void install_filters(const connection_snapshot_t *snapshot)
+{
+    for (uint32_t i = 0; i < snapshot->filter_count; i++)
+    {
+        add_filter((uint8_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i), &snapshot->filters[i]);
+        (void)whd_pf_enable_packet_filter(wlan_interface, (uint8_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i));
+    }
+
+    installed_filters = snapshot->filter_count;
+}
+
+/*******************************************************************************
+ * Function Name: remove_filters
+ *******************************************************************************
+ * Summary:
+ *  Adds the counters of the installed packet filters to offload_stats and
+ *  removes the filters.
+ *
+ *******************************************************************************/
+static void remove_filters(void)
+{
+    read_filter_stats(&offload_stats);
+
+    for (uint32_t i = 0; i < installed_filters; i++)
+    {
+        (void)whd_pf_disable_packet_filter(wlan_interface, (uint8_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i));
+        (void)whd_pf_remove_packet_filter(wlan_interface, (uint8_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i));
+    }
+
+    installed_filters = 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_filter_stats
+ *******************************************************************************
+ * Summary:
+ *  Adds the counters of the installed packet filters to the statistics.
+ *
+ *******************************************************************************/
+static void read_filter_stats(wlan_offload_stats_t *stats)
+{
+    whd_pkt_filter_stats_t filter_stats;
+
+    for (uint32_t i = 0; i < installed_filters; i++)
+    {
+        if (WHD_SUCCESS == whd_pf_get_packet_filter_stats(wlan_interface, (uint8_t)(WLAN_OFFLOAD_FILTER_ID_BASE + i),
+                                                          &filter_stats))
+        {
+            stats->frames_forwarded += filter_stats.num_pkts_forwarded;
+            stats->frames_dropped += filter_stats.num_pkts_discarded;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: add_port_filter
+ *******************************************************************************
+ * Summary:
+ *  Adds a port to the filters of the snapshot unless it is already there.
+ *  Ports beyond WLAN_OFFLOAD_MAX_FILTERS are not forwarded.
+ *
+ *******************************************************************************/
+static void add_port_filter(connection_snapshot_t *snapshot, uint8_t protocol, uint16_t port_offset, uint16_t port)
+{
+    port_filter_t *filter;
+
+    for (uint32_t i = 0; i < snapshot->filter_count; i++)
+    {
+        filter = &snapshot->filters[i];
+        if ((protocol == filter->protocol) && (port_offset == filter->port_offset) && (port == filter->port))
+        {
+            return;
+        }
+    }
+
+    if (snapshot->filter_count < WLAN_OFFLOAD_MAX_FILTERS)
+    {
+        filter = &snapshot->filters[snapshot->filter_count++];
+        filter->protocol = protocol;
+        filter->port_offset = port_offset;
+        filter->port = port;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: add_filter
+ *******************************************************************************
+ * Summary:
+ *  Installs a disabled filter that forwards the IPv4 frames of a protocol
+ *  with a port at port_offset in the frame.
+ *
+ *******************************************************************************/
+static void add_filter(uint8_t id, const port_filter_t *port_filter)
+{
+    whd_packet_filter_t filter;
+    static uint8_t masks[WLAN_OFFLOAD_MAX_FILTERS][FRAME_FILTER_LEN];
+    static uint8_t patterns[WLAN_OFFLOAD_MAX_FILTERS][FRAME_FILTER_LEN];
+    uint8_t *mask = masks[id - WLAN_OFFLOAD_FILTER_ID_BASE];
+    uint8_t *pattern = patterns[id - WLAN_OFFLOAD_FILTER_ID_BASE];
+    uint16_t port_index = port_filter->port_offset - FRAME_ETHERTYPE_OFFSET;
+
+    memset(mask, 0, FRAME_FILTER_LEN);
+    memset(pattern, 0, FRAME_FILTER_LEN);
+
+    /* EtherType IPv4, the protocol, and the port. */
+    mask[0] = 0xFF;
+    mask[1] = 0xFF;
+    pattern[0] = 0x08;
+    pattern[1] = 0x00;
+    mask[FRAME_IP_PROTOCOL_OFFSET - FRAME_ETHERTYPE_OFFSET] = 0xFF;
+    pattern[FRAME_IP_PROTOCOL_OFFSET - FRAME_ETHERTYPE_OFFSET] = port_filter->protocol;
+    mask[port_index] = 0xFF;
+    mask[port_index + 1u] = 0xFF;
+    pattern[port_index] = (uint8_t)(port_filter->port >> 8);
+    pattern[port_index + 1u] = (uint8_t)port_filter->port;
+
+    filter.id = id;
+    filter.enable = WHD_FALSE;
+    filter.offset = FRAME_ETHERTYPE_OFFSET;
+    filter.mask_size = FRAME_FILTER_LEN;
+    filter.mask = mask;
+    filter.pattern = pattern;
+    filter.rule = WHD_PACKET_FILTER_RULE_POSITIVE_MATCHING;
+
+    (void)whd_pf_remove_packet_filter(wlan_interface, id);
+    if (WHD_SUCCESS != whd_pf_add_packet_filter(wlan_interface, &filter))
+    {
+        ERR_INFO(("Failed to add packet filter %u.\n", id));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: offload_keepalive
+ *******************************************************************************
+ * Summary:
+ *  Hands a connection to the firmware with the keepalive it sends, an ACK
+ *  one byte before the next sequence number, and the ACK expected back.
+ *
+ *******************************************************************************/
+static cy_rslt_t offload_keepalive(uint8_t index, const tcp_connection_t *connection)
+{
+    wl_tko_t *tko = (wl_tko_t *)tko_buffer;
+    wl_tko_connect_t *connect = (wl_tko_connect_t *)tko->data;
+    uint8_t *data = connect->data;
+
+    memset(tko_buffer, 0, sizeof(tko_buffer));
+
+    connect->index = index;
+    connect->ip_addr_type = 0;
+    connect->local_port = connection->local_port;
+    connect->remote_port = connection->remote_port;
+    connect->local_seq = connection->snd_nxt;
+    connect->remote_seq = connection->rcv_nxt;
+    connect->request_len = KEEPALIVE_PACKET_LEN;
+    connect->response_len = KEEPALIVE_PACKET_LEN;
+
+    memcpy(data, &connection->local_ip, sizeof(uint32_t));
+    data += sizeof(uint32_t);
+    memcpy(data, &connection->remote_ip, sizeof(uint32_t));
+    data += sizeof(uint32_t);
+
+    build_segment(data, connection->local_ip, connection->remote_ip, connection->local_port,
+                  connection->remote_port, connection->snd_nxt - 1u, connection->rcv_nxt, connection->rcv_wnd);
+    data += KEEPALIVE_PACKET_LEN;
+    build_segment(data, connection->remote_ip, connection->local_ip, connection->remote_port,
+                  connection->local_port, connection->rcv_nxt, connection->snd_nxt, connection->snd_wnd);
+    data += KEEPALIVE_PACKET_LEN;
+
+    tko->subcmd_id = WL_TKO_SUBCMD_CONNECT;
+    tko->len = (uint8_t)(data - tko->data);
+
+    if (WHD_SUCCESS != whd_wifi_set_iovar_buffer(wlan_interface, "tko", tko,
+                                                 (uint16_t)(data - (uint8_t *)tko_buffer)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: build_segment
+ *******************************************************************************
+ * Summary:
+ *  Writes an IPv4 packet with a TCP ACK and no data, checksums included.
+ *  Addresses are in network order.
+ *
+ *******************************************************************************/
+static void build_segment(uint8_t *packet, uint32_t source_ip, uint32_t dest_ip, uint16_t source_port,
+                          uint16_t dest_port, uint32_t seq, uint32_t ack, uint16_t window)
+{
+    uint8_t *ip = packet;
+    uint8_t *tcp = packet + IPV4_HEADER_LEN;
+    uint32_t sum;
+    uint16_t checksum;
+
+    memset(packet, 0, KEEPALIVE_PACKET_LEN);
+
+    ip[0] = 0x45;
+    ip[3] = KEEPALIVE_PACKET_LEN;
+    ip[6] = 0x40;                    /* Don't fragment. */
+    ip[8] = TCP_TTL;
+    ip[9] = IP_PROTOCOL_TCP;
+    memcpy(&ip[12], &source_ip, sizeof(uint32_t));
+    memcpy(&ip[16], &dest_ip, sizeof(uint32_t));
+    checksum = checksum_fold(checksum_add(0, ip, IPV4_HEADER_LEN));
+    ip[10] = (uint8_t)(checksum >> 8);
+    ip[11] = (uint8_t)checksum;
+
+    tcp[0] = (uint8_t)(source_port >> 8);
+    tcp[1] = (uint8_t)source_port;
+    tcp[2] = (uint8_t)(dest_port >> 8);
+    tcp[3] = (uint8_t)dest_port;
+    tcp[4] = (uint8_t)(seq >> 24);
+    tcp[5] = (uint8_t)(seq >> 16);
+    tcp[6] = (uint8_t)(seq >> 8);
+    tcp[7] = (uint8_t)seq;
+    tcp[8] = (uint8_t)(ack >> 24);
+    tcp[9] = (uint8_t)(ack >> 16);
+    tcp[10] = (uint8_t)(ack >> 8);
+    tcp[11] = (uint8_t)ack;
+    tcp[12] = (TCP_HEADER_LEN / 4u) << 4;
+    tcp[13] = TCP_FLAG_ACK;
+    tcp[14] = (uint8_t)(window >> 8);
+    tcp[15] = (uint8_t)window;
+
+    /* Pseudo-header: the addresses, the protocol, and the TCP length. */
+    sum = checksum_add(0, &ip[12], 2u * sizeof(uint32_t));
+    sum += IP_PROTOCOL_TCP + TCP_HEADER_LEN;
+    checksum = checksum_fold(checksum_add(sum, tcp, TCP_HEADER_LEN));
+    tcp[16] = (uint8_t)(checksum >> 8);
+    tcp[17] = (uint8_t)checksum;
+}
+
+/*******************************************************************************
+ * Function Name: checksum_add
+ *******************************************************************************
+ * Summary:
+ *  Adds big-endian 16-bit words to an Internet checksum. The length is even.
+ *
+ *******************************************************************************/
+static uint32_t checksum_add(uint32_t sum, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i += 2u)
+    {
+        sum += ((uint32_t)data[i] << 8) | data[i + 1u];
+    }
+
+    return sum;
+}
+
+/*******************************************************************************
+ * Function Name: checksum_fold
+ *******************************************************************************
+ * Summary:
+ *  Folds the carries of an Internet checksum and returns its complement.
+ *
+ *******************************************************************************/
+static uint16_t checksum_fold(uint32_t sum)
+{
+    while (sum > 0xFFFFu)
+    {
+        sum = (sum & 0xFFFFu) + (sum >> 16);
+    }
+
+    return (uint16_t)~sum;
+}
+
+/*******************************************************************************
+ * Function Name: snapshot_connections
+ *******************************************************************************
+ * Summary:
+ *  Copies the state of the established IPv4 connections to the HTTPS server
+ *  port that have no data in flight, and adds the ports of the open TCP
+ *  connections and UDP sockets to the filters. Runs in the lwIP thread.
+ *
+ *******************************************************************************/
+static err_t snapshot_connections(struct tcpip_api_call_data *call)
+{
+    connection_snapshot_t *snapshot = (connection_snapshot_t *)call;
+    tcp_connection_t *connection;
+
+    for (struct tcp_pcb *pcb = tcp_active_pcbs; NULL != pcb; pcb = pcb->next)
+    {
+        if (!IP_IS_V4(&pcb->remote_ip))
+        {
+            continue;
+        }
+
+        add_port_filter(snapshot, IP_PROTOCOL_TCP, FRAME_SOURCE_PORT_OFFSET, pcb->remote_port);
+
+        if ((snapshot->count >= max_connections) || (ESTABLISHED != pcb->state) ||
+            (HTTPS_PORT != pcb->remote_port) || (NULL != pcb->unsent) || (NULL != pcb->unacked))
+        {
+            continue;
+        }
+
+        connection = &snapshot->connections[snapshot->count++];
+        connection->local_ip = ip_2_ip4(&pcb->local_ip)->addr;
+        connection->remote_ip = ip_2_ip4(&pcb->remote_ip)->addr;
+        connection->local_port = pcb->local_port;
+        connection->remote_port = pcb->remote_port;
+        connection->snd_nxt = pcb->snd_nxt;
+        connection->rcv_nxt = pcb->rcv_nxt;
+        connection->rcv_wnd = (uint16_t)RCV_WND_SCALE(pcb, pcb->rcv_ann_wnd);
+        connection->snd_wnd = SND_WINDOW(pcb);
+    }
+
+    /* A UDP socket, such as the one of the CoAP association, may receive
+     * from any peer, so its datagrams are matched on the local port.
+     */
+    for (struct udp_pcb *pcb = udp_pcbs; NULL != pcb; pcb = pcb->next)
+    {
+        if (0u != pcb->local_port)
+        {
+            add_port_filter(snapshot, IP_PROTOCOL_UDP, FRAME_DEST_PORT_OFFSET, pcb->local_port);
+        }
+    }
+
+    return ERR_OK;
+}
+
+/*******************************************************************************
+ * Function Name: host_frames
+ *******************************************************************************
+ * Summary:
+ *  Returns the frames lwIP has received from the WLAN. Each one woke the
+ *  host if it was asleep.
+ *
+ *******************************************************************************/
+static uint32_t host_frames(void)
+{
+#if LINK_STATS
+    return (uint32_t)lwip_stats.link.recv;
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: ignore_response
+ *******************************************************************************
+ * Summary:
+ *  Response callback of the benchmark requests.
+ *
+ *******************************************************************************/
+static void ignore_response(cy_http_client_t handle, cy_http_client_response_t *response, void *arg)
+{
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,117 @@
+/******************************************************************************
+* File Name: wlan_offload.h
+*
+* Description: This file contains the macros, structures, and function
+* prototypes of the WLAN offloads, which let the Wi-Fi firmware answer ARP and
+* keep the connections to the HTTPS server alive while the host sleeps.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WLAN_OFFLOAD_H_
+#define WLAN_OFFLOAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* TCP keepalive sent by the firmware on each idle connection to the server,
+ * in seconds. The connection is reported lost after the retries go
+ * unanswered.
+ */
+#define WLAN_OFFLOAD_KEEPALIVE_INTERVAL_S        (20u)
+#define WLAN_OFFLOAD_KEEPALIVE_RETRY_INTERVAL_S  (3u)
+#define WLAN_OFFLOAD_KEEPALIVE_RETRY_COUNT       (3u)
+
+/* Connections handed to the firmware at most. The firmware may take fewer. */
+#define WLAN_OFFLOAD_MAX_CONNECTIONS             (4)
+
+/* Lifetime of the peer entries in the ARP table of the firmware, in
+ * seconds.
+ */
+#define WLAN_OFFLOAD_ARP_PEER_AGE_S              (1200u)
+
+/* Packet filters applied while the host sleeps, built from the sockets
+ * open at suspend. They forward the segments from the remote port of every
+ * TCP connection, such as those to the HTTPS server and the MQTT broker,
+ * and the datagrams to the local port of every UDP socket, such as the CoAP
+ * association, plus the DHCP replies. Other frames are dropped by the
+ * firmware without waking the host.
+ */
+#define WLAN_OFFLOAD_FILTER_ID_BASE              (200u)
+#define WLAN_OFFLOAD_MAX_FILTERS                 (8u)
+
+/* "WLAN offload" menu option: the idle time after a request, measured with
+ * the offloads off and on.
+ */
+#define WLAN_OFFLOAD_BENCH_PATH                  "/"
+#define WLAN_OFFLOAD_BENCH_IDLE_S                (120u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Counters since the last wlan_offload_reset_stats(). */
+typedef struct
+{
+    uint32_t suspends;           /* Times the offloads were applied. */
+    uint32_t keepalives;         /* Connections kept alive by the firmware. */
+    uint32_t keepalives_lost;    /* Connections the firmware reported lost. */
+    uint32_t arp_replies;        /* ARP requests answered by the firmware. */
+    uint32_t frames_forwarded;   /* Frames passed to the host by the filters. */
+    uint32_t frames_dropped;     /* Frames dropped by the filters. */
+    uint32_t host_frames;        /* Frames received by the host, 0 without LINK_STATS. */
+} wlan_offload_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t wlan_offload_init(void);
+void wlan_offload_set_enabled(bool enabled);
+void wlan_offload_suspend(void);
+void wlan_offload_resume(void);
+void wlan_offload_get_stats(wlan_offload_stats_t *stats);
+void wlan_offload_reset_stats(void);
+void wlan_offload_benchmark(void);
+
+#endif /* WLAN_OFFLOAD_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name: xorshift.h
+*
+* Description: This file contains the xorshift32 generator shared by the
+* modules that need cheap random values: retry jitter, the arrival times
+* of the scheduler benchmark, and the workloads of the other benchmarks. It
+* is not for key material or for values a peer must not predict, such as
+* WebSocket masks.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef XORSHIFT_H_
+#define XORSHIFT_H_
+
+#include <stdint.h>
+#include "cyhal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cycle_counter.h"
+
+/*******************************************************************************
+ * Function Name: xorshift_seed
+ *******************************************************************************
+ * Summary:
+ *  Returns a non-zero seed from the TRNG, or from the cycle counter if the
+ *  TRNG is not available. The TRNG is released right away because it shares
+ *  the crypto block with mbedtls.
+ *
+ *******************************************************************************/
+__STATIC_INLINE uint32_t xorshift_seed(void)
+{
+    uint32_t seed;
+    cyhal_trng_t trng;
+
+    if (CY_RSLT_SUCCESS == cyhal_trng_init(&trng))
+    {
+        seed = cyhal_trng_generate(&trng);
+        cyhal_trng_free(&trng);
+    }
+    else
+    {
+        cycle_counter_enable();
+        seed = cycle_counter_get() ^ (uint32_t)xTaskGetTickCount();
+    }
+
+    return (0u == seed) ? 0x9E3779B9u : seed;
+}
+
+/*******************************************************************************
+ * Function Name: xorshift_next
+ *******************************************************************************
+ * Summary:
+ *  Advances a xorshift32 state and returns its new value. The state must not
+ *  be zero; a fixed seed gives a repeatable sequence.
+ *
+ *******************************************************************************/
+__STATIC_INLINE uint32_t xorshift_next(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+#endif /* XORSHIFT_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,214 @@
+/******************************************************************************
+* File Name: json_stream_bench.c
+*
+* Description: This file contains the host benchmark of the streaming JSON
+* parser. It reports the throughput for the piece sizes a TLS record or a
+* decoder hands to the parser, with and without field extraction.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "json_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Size of the generated document. */
+#define BENCH_DOCUMENT_SIZE              (256 * 1024)
+
+/* Pieces the document is fed in, from a byte at a time to a TLS record. */
+#define BENCH_PIECES                     { 1, 16, 64, 256, 1024, 1460, 16384 }
+
+/* Times the document is parsed for each measurement. */
+#define BENCH_ROUNDS                     (20)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static char document[BENCH_DOCUMENT_SIZE + 256];
+static size_t document_length;
+static uint32_t values;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void build_document(void);
+static bool count_value(json_event_t event, const char *path, const char *value, size_t length, void *arg);
+static double parse_ns(size_t piece, json_stream_cb_t callback, void *arg);
+
+/*******************************************************************************
+ * Function Name: build_document
+ *******************************************************************************
+ * Summary:
+ *  Generates a configuration-like document: an array of device records with
+ *  strings, escapes, numbers, literals, and nested objects.
+ *
+ *******************************************************************************/
+static void build_document(void)
+{
+    uint32_t index = 0;
+
+    document_length = (size_t)sprintf(document, "{\"version\":3,\"devices\":[");
+    while (document_length < BENCH_DOCUMENT_SIZE)
+    {
+        document_length += (size_t)sprintf(&document[document_length],
+            "%s{\"id\":%u,\"name\":\"sensor \\\"%u\\\" \\u00b0C\",\"enabled\":%s,\"offset\":-%u.%02ue-2,"
+            "\"limits\":{\"low\":%u,\"high\":%u},\"tags\":[\"lab\",\"floor-%u\",null]}",
+            (0u == index) ? "" : ",", (unsigned)index, (unsigned)index, (0u == (index % 3u)) ? "true" : "false",
+            (unsigned)(index % 50u), (unsigned)(index % 100u), (unsigned)(index % 17u),
+            (unsigned)(100u + (index % 900u)), (unsigned)(index % 9u));
+        index++;
+    }
+    document_length += (size_t)sprintf(&document[document_length], "]}");
+}
+
+/*******************************************************************************
+ * Function Name: count_value
+ *******************************************************************************
+ * Summary:
+ *  Parser callback that only counts the values.
+ *
+ *******************************************************************************/
+static bool count_value(json_event_t event, const char *path, const char *value, size_t length, void *arg)
+{
+    (void)event;
+    (void)path;
+    (void)value;
+    (void)length;
+    (void)arg;
+
+    values++;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_ns
+ *******************************************************************************
+ * Summary:
+ *  Parses the document BENCH_ROUNDS times in pieces of the given size.
+ *
+ * Return:
+ *  double: Nanoseconds per byte of the fastest round.
+ *
+ *******************************************************************************/
+static double parse_ns(size_t piece, json_stream_cb_t callback, void *arg)
+{
+    double best = 0.0;
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        struct timespec start;
+        struct timespec end;
+        json_stream_t parser;
+        json_stream_status_t status = JSON_STREAM_OK;
+        double ns;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        json_stream_init(&parser, callback, arg);
+        for (size_t done = 0; (done < document_length) && (JSON_STREAM_OK == status); done += piece)
+        {
+            size_t length = ((document_length - done) < piece) ? (document_length - done) : piece;
+
+            status = json_stream_feed(&parser, (const uint8_t *)&document[done], length);
+        }
+        if (JSON_STREAM_OK == status)
+        {
+            status = json_stream_finish(&parser);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if ((JSON_STREAM_OK != status) && (JSON_STREAM_STOPPED != status))
+        {
+            printf("The benchmark document failed to parse: status %d.\n", (int)status);
+            exit(EXIT_FAILURE);
+        }
+
+        ns = (((double)(end.tv_sec - start.tv_sec) * 1e9) + (double)(end.tv_nsec - start.tv_nsec)) /
+             (double)document_length;
+        best = ((0u == round) || (ns < best)) ? ns : best;
+    }
+
+    return best;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Prints the nanoseconds per byte and the throughput of the parser for each
+ *  piece size, counting every value and extracting two fields.
+ *
+ *******************************************************************************/
+int main(void)
+{
+    static const size_t pieces[] = BENCH_PIECES;
+    json_field_t fields[2];
+    json_extract_t extract;
+    char name[32];
+    int32_t high = 0;
+
+    build_document();
+
+    /* The last device is matched, so extraction walks the whole document. */
+    fields[0] = (json_field_t){ "devices[*].name", JSON_FIELD_STRING, name, sizeof(name), false };
+    fields[1] = (json_field_t){ "devices[*].limits.high", JSON_FIELD_INT, &high, sizeof(high), false };
+    extract = (json_extract_t){ fields, 2, false };
+
+    printf("json_stream: %lu byte document\n", (unsigned long)document_length);
+    printf("  piece    count ns/B   MB/s   extract ns/B   MB/s\n");
+
+    for (size_t index = 0; index < (sizeof(pieces) / sizeof(pieces[0])); index++)
+    {
+        double count_ns = parse_ns(pieces[index], count_value, NULL);
+        double extract_ns = parse_ns(pieces[index], json_extract_cb, &extract);
+
+        printf("  %5lu    %10.2f %6.1f   %12.2f %6.1f\n", (unsigned long)pieces[index],
+               count_ns, 1e3 / count_ns, extract_ns, 1e3 / extract_ns);
+    }
+
+    printf("  %lu values per parse\n", (unsigned long)(values / (BENCH_ROUNDS * (sizeof(pieces) / sizeof(pieces[0])))));
+
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
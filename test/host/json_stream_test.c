@@ -0,0 +1,446 @@
+/******************************************************************************
+* File Name: json_stream_test.c
+*
+* Description: This file contains the host tests of the streaming JSON parser:
+* fixed documents, and a differential fuzzer that checks that any split of
+* the input gives the events and status of the input fed at once.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_stream.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Space for the events of one document, one line per event. */
+#define EVENT_LOG_SIZE                   (64 * 1024)
+
+/* Longest input generated by the fuzzer. */
+#define FUZZ_MAX_INPUT                   (512)
+
+/* Splits of each input compared with the input fed at once. */
+#define FUZZ_SPLITS                      (4)
+
+/* Iterations of the fuzzer when none is given on the command line. */
+#define FUZZ_DEFAULT_ITERATIONS          (100000)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Events of one parse, and when to stop the parser. */
+typedef struct
+{
+    char text[EVENT_LOG_SIZE];
+    size_t length;
+    uint32_t events;
+    uint32_t stop_after;             /* Events before stopping, 0 to never stop. */
+} event_log_t;
+
+/* Document with the status it must give, and its events if checked. */
+typedef struct
+{
+    const char *text;
+    json_stream_status_t status;
+    const char *events;              /* NULL to check the status only. */
+} fixture_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static const fixture_t fixtures[] =
+{
+    { "42", JSON_STREAM_OK, "5  42\n" },
+    { " [ ] ", JSON_STREAM_OK, "2  \n3  \n" },
+    { "{\"a\":1,\"b\":[true,null]}", JSON_STREAM_OK,
+      "0  \n5 a 1\n2 b \n6 b[0] true\n8 b[1] null\n3 b \n1  \n" },
+    { "{\"s\":\"x\\u00e9\\ud83d\\ude00\\n\"}", JSON_STREAM_OK,
+      "0  \n4 s x\xc3\xa9\xf0\x9f\x98\x80\n\n1  \n" },
+    { "{\"d\":{\"e\":-1.5e+3}}", JSON_STREAM_OK, "0  \n0 d \n5 d.e -1.5e+3\n1 d \n1  \n" },
+    { "{\"k\":[[[[[[[1]]]]]]]}", JSON_STREAM_OK, NULL },
+    { "{\"k\":[[[[[[[[[1]]]]]]]]]}", JSON_STREAM_ERR_DEPTH, NULL },
+    { "{\"a\":01}", JSON_STREAM_ERR_SYNTAX, NULL },
+    { "[1,]", JSON_STREAM_ERR_SYNTAX, NULL },
+    { "{\"a\" 1}", JSON_STREAM_ERR_SYNTAX, NULL },
+    { "[1 2]", JSON_STREAM_ERR_SYNTAX, NULL },
+    { "[1] 2", JSON_STREAM_ERR_SYNTAX, NULL },
+    /* RFC 8259 leaves lone surrogates to the parser; this one accepts them. */
+    { "\"\\ud83d\"", JSON_STREAM_OK, NULL },
+    { "\"abc", JSON_STREAM_ERR_INCOMPLETE, NULL },
+    { "tru", JSON_STREAM_ERR_INCOMPLETE, NULL },
+    { "", JSON_STREAM_ERR_INCOMPLETE, NULL },
+};
+
+/* Seeds of the fuzzer, mutated and spliced together. */
+static const char *const corpus[] =
+{
+    "{\"wifi\":{\"ssid\":\"lab\",\"retries\":3},\"servers\":[{\"host\":\"a\",\"port\":443}]}",
+    "[true,false,null,-0.5e-7,\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\"]",
+    "{\"k\":[[[[[[[1]]]]]]],\"s\":\"\\ud83d\\ude00\"}",
+    "{\"a\":{\"b\":{\"c\":{\"d\":[1,2,3]}}},\"e\":\"\"}",
+    "  123.456E+12  ",
+};
+
+static event_log_t once_log;
+static event_log_t split_log;
+static uint32_t failures;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool log_event(json_event_t event, const char *path, const char *value, size_t length, void *arg);
+static json_stream_status_t parse(const uint8_t *data, size_t length, const size_t *cuts, uint32_t num_cuts,
+                                  event_log_t *log);
+static void check_split(const uint8_t *data, size_t length, const size_t *cuts, uint32_t num_cuts,
+                        uint32_t stop_after);
+static void test_fixtures(void);
+static void test_extract(void);
+static size_t mutate(uint8_t *data, size_t length);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/*******************************************************************************
+ * Function Name: log_event
+ *******************************************************************************
+ * Summary:
+ *  Parser callback. Appends the event to the log, and stops the parser after
+ *  stop_after events.
+ *
+ *******************************************************************************/
+static bool log_event(json_event_t event, const char *path, const char *value, size_t length, void *arg)
+{
+    event_log_t *log = (event_log_t *)arg;
+    int used;
+
+    used = snprintf(&log->text[log->length], sizeof(log->text) - log->length, "%d %s %.*s\n",
+                    (int)event, path, (int)length, (NULL != value) ? value : "");
+    if ((used > 0) && ((log->length + (size_t)used) < sizeof(log->text)))
+    {
+        log->length += (size_t)used;
+    }
+    log->events++;
+
+    return (0u == log->stop_after) || (log->events < log->stop_after);
+}
+
+/*******************************************************************************
+ * Function Name: parse
+ *******************************************************************************
+ * Summary:
+ *  Parses a document fed in pieces that end at the given cuts, and returns
+ *  the status of json_stream_finish().
+ *
+ *******************************************************************************/
+static json_stream_status_t parse(const uint8_t *data, size_t length, const size_t *cuts, uint32_t num_cuts,
+                                  event_log_t *log)
+{
+    json_stream_t parser;
+    size_t start = 0;
+
+    log->length = 0;
+    log->text[0] = '\0';
+    log->events = 0;
+    json_stream_init(&parser, log_event, log);
+
+    for (uint32_t index = 0; index <= num_cuts; index++)
+    {
+        size_t end = (index < num_cuts) ? cuts[index] : length;
+
+        (void)json_stream_feed(&parser, &data[start], end - start);
+        start = end;
+    }
+
+    return json_stream_finish(&parser);
+}
+
+/*******************************************************************************
+ * Function Name: check_split
+ *******************************************************************************
+ * Summary:
+ *  Checks that a document split at the cuts gives the same events and status
+ *  as the document fed at once.
+ *
+ *******************************************************************************/
+static void check_split(const uint8_t *data, size_t length, const size_t *cuts, uint32_t num_cuts,
+                        uint32_t stop_after)
+{
+    json_stream_status_t once;
+    json_stream_status_t split;
+
+    once_log.stop_after = stop_after;
+    split_log.stop_after = stop_after;
+    once = parse(data, length, NULL, 0, &once_log);
+    split = parse(data, length, cuts, num_cuts, &split_log);
+
+    if ((once != split) || (once_log.length != split_log.length) ||
+        (0 != memcmp(once_log.text, split_log.text, once_log.length)))
+    {
+        printf("FAIL split of %u bytes at %u cuts: status %d/%d\n  input: %.*s\n",
+               (unsigned)length, (unsigned)num_cuts, (int)once, (int)split, (int)length, (const char *)data);
+        failures++;
+        abort();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_fixtures
+ *******************************************************************************
+ * Summary:
+ *  Checks the status and events of the fixed documents, fed at once and one
+ *  byte at a time.
+ *
+ *******************************************************************************/
+static void test_fixtures(void)
+{
+    static size_t cuts[FUZZ_MAX_INPUT];
+
+    for (uint32_t index = 0; index < (sizeof(fixtures) / sizeof(fixtures[0])); index++)
+    {
+        const fixture_t *fixture = &fixtures[index];
+        size_t length = strlen(fixture->text);
+        json_stream_status_t status;
+
+        status = parse((const uint8_t *)fixture->text, length, NULL, 0, &once_log);
+        if ((status != fixture->status) ||
+            ((NULL != fixture->events) && (0 != strcmp(once_log.text, fixture->events))))
+        {
+            printf("FAIL fixture %u %s: status %d, expected %d\n%s", (unsigned)index, fixture->text,
+                   (int)status, (int)fixture->status, once_log.text);
+            failures++;
+        }
+
+        for (size_t cut = 1; cut < length; cut++)
+        {
+            cuts[cut - 1] = cut;
+        }
+        check_split((const uint8_t *)fixture->text, length, cuts, (length > 0) ? (uint32_t)(length - 1) : 0, 0);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_extract
+ *******************************************************************************
+ * Summary:
+ *  Checks json_extract_cb() with wildcard paths, a truncated string, and
+ *  stopping once every field is found.
+ *
+ *******************************************************************************/
+static void test_extract(void)
+{
+    static const char document[] = "{\"b\":[true,{\"c\":\"hello world\"}],\"d\":{\"x\":-77},\"z\":[}";
+    json_field_t fields[3];
+    json_extract_t extract;
+    json_stream_t parser;
+    json_stream_status_t status;
+    char text[8];
+    int32_t number = 0;
+    bool flag = false;
+
+    fields[0] = (json_field_t){ "b[*].c", JSON_FIELD_STRING, text, sizeof(text), false };
+    fields[1] = (json_field_t){ "d.x", JSON_FIELD_INT, &number, sizeof(number), false };
+    fields[2] = (json_field_t){ "b[0]", JSON_FIELD_BOOL, &flag, sizeof(flag), false };
+    extract = (json_extract_t){ fields, 3, true };
+
+    json_stream_init(&parser, json_extract_cb, &extract);
+    status = json_stream_feed(&parser, (const uint8_t *)document, sizeof(document) - 1);
+
+    /* The parser stops at "d.x", before the syntax error at the end. */
+    if ((JSON_STREAM_STOPPED != status) || !fields[0].found || !fields[1].found || !fields[2].found ||
+        (0 != strcmp(text, "hello w")) || (-77 != number) || !flag)
+    {
+        printf("FAIL extract: status %d, \"%s\", %d, %d\n", (int)status, text, (int)number, (int)flag);
+        failures++;
+    }
+
+    if (!json_path_matches("a[*].b", "a[12].b") || json_path_matches("a[*].b", "a.b") ||
+        json_path_matches("a", "ab"))
+    {
+        printf("FAIL json_path_matches\n");
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mutate
+ *******************************************************************************
+ * Summary:
+ *  Applies a few random edits to an input: byte flips, insertions of JSON
+ *  punctuation, deletions, and splices of a seed.
+ *
+ * Return:
+ *  size_t: New length of the input.
+ *
+ *******************************************************************************/
+static size_t mutate(uint8_t *data, size_t length)
+{
+    static const char tokens[] = "{}[]:,\"\\u0123456789abcdefABCDEFeE+-.tfnrl \t\n";
+    uint32_t edits = 1u + ((uint32_t)rand() % 4u);
+
+    while (edits-- > 0u)
+    {
+        size_t at = (length > 0u) ? ((size_t)rand() % (length + 1u)) : 0u;
+
+        switch (rand() % 4)
+        {
+            case 0:
+            {
+                if (at < length)
+                {
+                    data[at] = (uint8_t)rand();
+                }
+                break;
+            }
+
+            case 1:
+            {
+                if (length < FUZZ_MAX_INPUT)
+                {
+                    memmove(&data[at + 1u], &data[at], length - at);
+                    data[at] = (uint8_t)tokens[(size_t)rand() % (sizeof(tokens) - 1u)];
+                    length++;
+                }
+                break;
+            }
+
+            case 2:
+            {
+                if (at < length)
+                {
+                    memmove(&data[at], &data[at + 1u], length - at - 1u);
+                    length--;
+                }
+                break;
+            }
+
+            default:
+            {
+                const char *seed = corpus[(size_t)rand() % (sizeof(corpus) / sizeof(corpus[0]))];
+                size_t from = (size_t)rand() % strlen(seed);
+                size_t count = strlen(seed) - from;
+
+                count = (count > (FUZZ_MAX_INPUT - at)) ? (FUZZ_MAX_INPUT - at) : count;
+                memcpy(&data[at], &seed[from], count);
+                length = ((at + count) > length) ? (at + count) : length;
+                break;
+            }
+        }
+    }
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: LLVMFuzzerTestOneInput
+ *******************************************************************************
+ * Summary:
+ *  Fuzz target, also usable with libFuzzer. Parses the input at once and
+ *  split at pseudo-random points derived from its length, with and without
+ *  the callback stopping the parser, and checks that the results agree.
+ *
+ *******************************************************************************/
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    size_t cuts[FUZZ_SPLITS];
+    uint32_t seed = (uint32_t)size * 2654435761u;
+
+    for (uint32_t split = 0; split < FUZZ_SPLITS; split++)
+    {
+        uint32_t num_cuts = 0;
+        size_t cut = 0;
+
+        while ((num_cuts < FUZZ_SPLITS) && (size > 0u))
+        {
+            seed = (seed * 1103515245u) + 12345u;
+            cut += 1u + ((seed >> 16) % (1u + (size / 2u)));
+            if (cut >= size)
+            {
+                break;
+            }
+            cuts[num_cuts++] = cut;
+        }
+
+        check_split(data, size, cuts, num_cuts, split);
+    }
+
+    return 0;
+}
+
+#if !defined(JSON_STREAM_LIBFUZZER)
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Runs the fixed tests, then the fuzz target on mutated seeds for the
+ *  number of iterations given as the first argument. The second argument
+ *  seeds the mutations.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static uint8_t input[FUZZ_MAX_INPUT];
+    unsigned long iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : FUZZ_DEFAULT_ITERATIONS;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 0) : 1u;
+    size_t length = 0;
+
+    test_fixtures();
+    test_extract();
+
+    srand(seed);
+    for (unsigned long iteration = 0; iteration < iterations; iteration++)
+    {
+        if (0u == (iteration % 64u))
+        {
+            const char *start = corpus[iteration % (sizeof(corpus) / sizeof(corpus[0]))];
+
+            length = strlen(start);
+            memcpy(input, start, length);
+        }
+
+        length = mutate(input, length);
+        (void)LLVMFuzzerTestOneInput(input, length);
+    }
+
+    printf("json_stream: %lu fuzz iterations, seed %u, %u failures\n", iterations, seed, (unsigned)failures);
+
+    return (0u == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif /* !JSON_STREAM_LIBFUZZER */
+
+/* [] END OF FILE */